@@ -0,0 +1,65 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include "WBenchmark.h"
+
+WBenchmark::WBenchmark( std::string name ):
+    m_name( name ),
+    m_sink( 0.0 )
+{
+    // initialize
+}
+
+WBenchmark::~WBenchmark()
+{
+    // cleanup
+}
+
+const std::string& WBenchmark::getName() const
+{
+    return m_name;
+}
+
+const std::vector< size_t >& WBenchmark::getSizes() const
+{
+    return m_sizes;
+}
+
+void WBenchmark::tearDown()
+{
+    // nothing to do by default
+}
+
+void WBenchmark::addSize( size_t size )
+{
+    m_sizes.push_back( size );
+}
+
+void WBenchmark::consume( double value )
+{
+    m_sink = m_sink + value;
+}
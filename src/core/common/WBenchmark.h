@@ -0,0 +1,129 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WBENCHMARK_H
+#define WBENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+/**
+ * Base class for all benchmarks. A benchmark measures a hot path of OpenWalnut with synthetic data of several problem sizes. The data is
+ * created in \ref setUp, which is not measured. Only \ref run gets measured. Create the synthetic data deterministically (fixed seeds) to get
+ * comparable results between runs. Register your benchmark using \ref W_REGISTER_BENCHMARK and place it in a "benchmark" directory next to the
+ * code it measures.
+ */
+class WBenchmark
+{
+public:
+    /**
+     * Convenience typedef for a boost::shared_ptr< WBenchmark >.
+     */
+    typedef boost::shared_ptr< WBenchmark > SPtr;
+
+    /**
+     * Convenience typedef for a boost::shared_ptr< const WBenchmark >.
+     */
+    typedef boost::shared_ptr< const WBenchmark > ConstSPtr;
+
+    /**
+     * Constructor.
+     *
+     * \param name the unique name of the benchmark.
+     */
+    explicit WBenchmark( std::string name );
+
+    /**
+     * Destructor.
+     */
+    virtual ~WBenchmark();
+
+    /**
+     * The name of the benchmark.
+     *
+     * \return the name
+     */
+    const std::string& getName() const;
+
+    /**
+     * The problem sizes this benchmark is run with. The meaning depends on the benchmark, like voxels per dimension or number of fibers.
+     *
+     * \return the sizes
+     */
+    const std::vector< size_t >& getSizes() const;
+
+    /**
+     * Creates the synthetic data for the given problem size. This is not measured.
+     *
+     * \param size the problem size
+     */
+    virtual void setUp( size_t size ) = 0;
+
+    /**
+     * Runs the measured code once.
+     *
+     * \return the number of processed items, like voxels or fibers. Used to calculate the throughput.
+     */
+    virtual size_t run() = 0;
+
+    /**
+     * Frees the data created by \ref setUp. Default implementation does nothing.
+     */
+    virtual void tearDown();
+
+protected:
+    /**
+     * Adds a problem size. Call this in your constructor.
+     *
+     * \param size the size
+     */
+    void addSize( size_t size );
+
+    /**
+     * Use this to consume results of the measured code. This avoids that the compiler optimizes away computations whose results are unused.
+     *
+     * \param value the value to consume
+     */
+    void consume( double value );
+
+private:
+    /**
+     * The name.
+     */
+    std::string m_name;
+
+    /**
+     * The problem sizes.
+     */
+    std::vector< size_t > m_sizes;
+
+    /**
+     * Sink for consumed values.
+     */
+    volatile double m_sink;
+};
+
+#endif  // WBENCHMARK_H
@@ -0,0 +1,205 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "WRealtimeTimer.h"
+#include "WStringUtils.h"
+
+#include "WBenchmarkRunner.h"
+
+namespace
+{
+    /**
+     * Orders results by name and size.
+     *
+     * \param a first result
+     * \param b second result
+     *
+     * \return true if a < b
+     */
+    bool resultLess( const WBenchmarkRunner::Result& a, const WBenchmarkRunner::Result& b )
+    {
+        return ( a.m_name < b.m_name ) || ( ( a.m_name == b.m_name ) && ( a.m_size < b.m_size ) );
+    }
+}
+
+WBenchmarkRunner::WBenchmarkRunner()
+{
+    // initialize
+}
+
+WBenchmarkRunner* WBenchmarkRunner::getBenchmarkRunner()
+{
+    static WBenchmarkRunner runner;
+    return &runner;
+}
+
+void WBenchmarkRunner::add( WBenchmark::SPtr benchmark )
+{
+    m_benchmarks.push_back( benchmark );
+}
+
+std::vector< WBenchmarkRunner::Result > WBenchmarkRunner::run( const std::string& filter, size_t repeats ) const
+{
+    std::vector< Result > results;
+    WRealtimeTimer timer;
+    for( std::vector< WBenchmark::SPtr >::const_iterator iter = m_benchmarks.begin(); iter != m_benchmarks.end(); ++iter )
+    {
+        WBenchmark::SPtr benchmark = *iter;
+        if( !filter.empty() && ( benchmark->getName().find( filter ) == std::string::npos ) )
+        {
+            continue;
+        }
+
+        for( std::vector< size_t >::const_iterator size = benchmark->getSizes().begin(); size != benchmark->getSizes().end(); ++size )
+        {
+            std::cerr << "Running " << benchmark->getName() << " (" << *size << ")" << std::endl;
+
+            Result result;
+            result.m_name = benchmark->getName();
+            result.m_size = *size;
+
+            benchmark->setUp( *size );
+
+            // warm up caches and lazily initialized data
+            result.m_items = benchmark->run();
+            for( size_t i = 0; i < repeats; ++i )
+            {
+                timer.reset();
+                benchmark->run();
+                result.m_times.push_back( timer.elapsed() );
+            }
+
+            benchmark->tearDown();
+            results.push_back( result );
+        }
+    }
+
+    std::sort( results.begin(), results.end(), resultLess );
+    return results;
+}
+
+void WBenchmarkRunner::write( std::ostream& out, const std::vector< Result >& results ) // NOLINT: yes, it is an intended non-const ref
+{
+    out << std::setprecision( 6 );
+    out << "{" << std::endl;
+    out << "  \"benchmarks\": [";
+    for( size_t r = 0; r < results.size(); ++r )
+    {
+        std::vector< double > times = results[ r ].m_times;
+        std::sort( times.begin(), times.end() );
+
+        double mean = 0.0;
+        for( size_t i = 0; i < times.size(); ++i )
+        {
+            mean += times[ i ] / static_cast< double >( times.size() );
+        }
+        double median = times.empty() ? 0.0 : times[ times.size() / 2 ];
+        double min = times.empty() ? 0.0 : times.front();
+
+        out << ( r ? "," : "" ) << std::endl;
+        out << "    { \"name\": \"" << results[ r ].m_name << "\""
+            << ", \"size\": " << results[ r ].m_size
+            << ", \"items\": " << results[ r ].m_items
+            << ", \"repeats\": " << times.size()
+            << ", \"minTime\": " << min
+            << ", \"medianTime\": " << median
+            << ", \"meanTime\": " << mean
+            << ", \"itemsPerSecond\": " << ( median > 0.0 ? static_cast< double >( results[ r ].m_items ) / median : 0.0 )
+            << " }";
+    }
+    out << ( results.empty() ? "" : "\n  " ) << "]" << std::endl;
+    out << "}" << std::endl;
+}
+
+int WBenchmarkRunner::main( int argc, char** argv )
+{
+    std::string filter;
+    std::string output;
+    size_t repeats = 5;
+    bool list = false;
+
+    for( int i = 1; i < argc; ++i )
+    {
+        std::string arg( argv[ i ] );
+        if( ( arg == "--filter" ) && ( i + 1 < argc ) )
+        {
+            filter = argv[ ++i ];
+        }
+        else if( ( arg == "--repeat" ) && ( i + 1 < argc ) )
+        {
+            repeats = string_utils::fromString< size_t >( argv[ ++i ] );
+        }
+        else if( ( arg == "--output" ) && ( i + 1 < argc ) )
+        {
+            output = argv[ ++i ];
+        }
+        else if( arg == "--list" )
+        {
+            list = true;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[ 0 ] << " [--filter NAME] [--repeat N] [--output FILE] [--list]" << std::endl;
+            return 1;
+        }
+    }
+
+    if( list )
+    {
+        for( std::vector< WBenchmark::SPtr >::const_iterator iter = m_benchmarks.begin(); iter != m_benchmarks.end(); ++iter )
+        {
+            std::cout << ( *iter )->getName() << ":";
+            for( size_t s = 0; s < ( *iter )->getSizes().size(); ++s )
+            {
+                std::cout << " " << ( *iter )->getSizes()[ s ];
+            }
+            std::cout << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector< Result > results = run( filter, repeats );
+
+    if( output.empty() )
+    {
+        write( std::cout, results );
+        return 0;
+    }
+
+    std::ofstream out( output.c_str() );
+    if( !out.is_open() )
+    {
+        std::cerr << "Could not open \"" << output << "\" for writing." << std::endl;
+        return 1;
+    }
+    write( out, results );
+    return 0;
+}
@@ -0,0 +1,151 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WBENCHMARKRUNNER_H
+#define WBENCHMARKRUNNER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "WBenchmark.h"
+
+/**
+ * Registry of all benchmarks of an executable. It runs them and writes the results as JSON. The JSON output is sorted by benchmark name and
+ * problem size to allow diffing results of different runs. Use the generated benchmark executables (see OW_COMPILE_BENCHMARKS) or the
+ * "benchmark" target to run them.
+ */
+class WBenchmarkRunner
+{
+public:
+    /**
+     * Helper to register a benchmark during static initialization. Use \ref W_REGISTER_BENCHMARK instead of using this directly.
+     *
+     * \tparam BenchmarkType the benchmark class. Needs to be default constructible.
+     */
+    template< typename BenchmarkType >
+    class Registrar
+    {
+    public:
+        /**
+         * Creates an instance of the benchmark and registers it.
+         */
+        Registrar()
+        {
+            WBenchmarkRunner::getBenchmarkRunner()->add( WBenchmark::SPtr( new BenchmarkType() ) );
+        }
+    };
+
+    /**
+     * Returns the runner instance.
+     *
+     * \return the runner
+     */
+    static WBenchmarkRunner* getBenchmarkRunner();
+
+    /**
+     * Registers a benchmark.
+     *
+     * \param benchmark the benchmark
+     */
+    void add( WBenchmark::SPtr benchmark );
+
+    /**
+     * Parses the command line, runs the benchmarks and writes the results. Supported arguments are:
+     *  - --filter NAME: only run benchmarks whose name contains NAME
+     *  - --repeat N: measure each benchmark N times (default 5)
+     *  - --output FILE: write the JSON results to FILE instead of stdout
+     *  - --list: only list the benchmarks and their sizes
+     *
+     * \param argc number of arguments
+     * \param argv the arguments
+     *
+     * \return 0 on success
+     */
+    int main( int argc, char** argv );
+
+    /**
+     * The result of a benchmark for one problem size.
+     */
+    struct Result
+    {
+        /**
+         * Name of the benchmark.
+         */
+        std::string m_name;
+
+        /**
+         * Problem size.
+         */
+        size_t m_size;
+
+        /**
+         * Items processed per run.
+         */
+        size_t m_items;
+
+        /**
+         * Wall times of each run in seconds.
+         */
+        std::vector< double > m_times;
+    };
+
+    /**
+     * Runs all benchmarks whose name contains the filter.
+     *
+     * \param filter the name filter. Empty to run all.
+     * \param repeats how often each benchmark is measured. A warm-up run is done before.
+     *
+     * \return the results, sorted by name and size
+     */
+    std::vector< Result > run( const std::string& filter, size_t repeats ) const;
+
+    /**
+     * Writes the results as JSON.
+     *
+     * \param out the stream to write to
+     * \param results the results to write
+     */
+    static void write( std::ostream& out, const std::vector< Result >& results ); // NOLINT: yes, it is an intended non-const ref
+
+private:
+    /**
+     * Constructor. Use \ref getBenchmarkRunner.
+     */
+    WBenchmarkRunner();
+
+    /**
+     * The registered benchmarks.
+     */
+    std::vector< WBenchmark::SPtr > m_benchmarks;
+};
+
+/**
+ * Registers the given benchmark class to the benchmark runner of the executable. Use this in the benchmark's implementation file.
+ */
+#define W_REGISTER_BENCHMARK( BenchmarkType ) static WBenchmarkRunner::Registrar< BenchmarkType > s_benchmarkRegistrar ## BenchmarkType;
+
+#endif  // WBENCHMARKRUNNER_H
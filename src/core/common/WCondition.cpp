@@ -23,6 +23,7 @@
 //---------------------------------------------------------------------------
 
 #include "WCondition.h"
+#include "WTraceScope.h"
 
 WCondition::WCondition()
 {
@@ -36,6 +37,8 @@ WCondition::~WCondition()
 
 void WCondition::wait() const
 {
+    WTRACE_SCOPE( "wait", "WCondition::wait" );
+
     // since Boost 1.54, we need to explicitly lock the mutex prior to wait.
     boost::unique_lock<boost::shared_mutex> lock( m_mutex );
     m_condition.wait( m_mutex );
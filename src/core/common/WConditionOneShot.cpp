@@ -23,6 +23,7 @@
 //---------------------------------------------------------------------------
 
 #include "WConditionOneShot.h"
+#include "WTraceScope.h"
 
 WConditionOneShot::WConditionOneShot()
     : WCondition()
@@ -46,6 +47,8 @@ WConditionOneShot::~WConditionOneShot()
 
 void WConditionOneShot::wait() const
 {
+    WTRACE_SCOPE( "wait", "WConditionOneShot::wait" );
+
     // now we wait until the write lock is released and we can get a read lock
     boost::shared_lock<boost::shared_mutex> slock = boost::shared_lock<boost::shared_mutex>( m_mutex );
     slock.unlock();
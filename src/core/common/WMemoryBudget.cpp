@@ -0,0 +1,153 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "exceptions/WOutOfMemoryBudget.h"
+#include "WLogger.h"
+#include "WMemoryBudget.h"
+
+namespace
+{
+    /**
+     * Formats a number of bytes as MB for messages.
+     *
+     * \param bytes the bytes
+     *
+     * \return the formatted string
+     */
+    std::string toMB( size_t bytes )
+    {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision( 1 ) << bytes / ( 1024.0 * 1024.0 ) << " MB";
+        return out.str();
+    }
+}
+
+WMemoryBudget::WMemoryBudget():
+    m_budget( 0 ),
+    m_usage( 0 )
+{
+    // initialize members
+}
+
+WMemoryBudget::~WMemoryBudget()
+{
+    // cleanup
+}
+
+WMemoryBudget::SPtr WMemoryBudget::getMemoryBudget()
+{
+    // thread-safe since C++11. Reservations are done by module threads.
+    static SPtr instance( new WMemoryBudget() );
+    return instance;
+}
+
+void WMemoryBudget::setBudget( size_t bytes )
+{
+    m_budget = bytes;
+}
+
+size_t WMemoryBudget::getBudget() const
+{
+    return m_budget;
+}
+
+size_t WMemoryBudget::getUsage() const
+{
+    return m_usage;
+}
+
+void WMemoryBudget::reserve( size_t bytes, const std::string& what, bool mayRefuse )
+{
+    size_t budget = m_budget;
+    if( !budget )
+    {
+        m_usage += bytes;
+        return;
+    }
+    if( tryReserve( bytes, budget ) )
+    {
+        return;
+    }
+
+    {
+        boost::lock_guard< boost::recursive_mutex > lock( m_evictionMutex );
+        // another thread might have evicted in the meantime
+        if( tryReserve( bytes, budget ) )
+        {
+            return;
+        }
+        size_t usage = m_usage;
+        wlog::info( "WMemoryBudget" ) << "Reserving " << toMB( bytes ) << " for " << what << " exceeds the budget of " << toMB( budget )
+                                      << ". Evicting caches.";
+        m_evictionSignal( usage + bytes > budget ? usage + bytes - budget : bytes );
+    }
+
+    if( tryReserve( bytes, budget ) )
+    {
+        return;
+    }
+    if( !mayRefuse )
+    {
+        wlog::warn( "WMemoryBudget" ) << "Reserving " << toMB( bytes ) << " for " << what << " exceeds the budget of " << toMB( budget ) << ".";
+        m_usage += bytes;
+        return;
+    }
+    size_t usage = m_usage;
+    throw WOutOfMemoryBudget( "Refused to reserve " + toMB( bytes ) + " for " + what + ". " + toMB( usage ) + " of the budget of " +
+                              toMB( budget ) + " are in use." );
+}
+
+void WMemoryBudget::release( size_t bytes )
+{
+    m_usage -= bytes;
+}
+
+boost::signals2::connection WMemoryBudget::subscribeEviction( EvictionFunction evict )
+{
+    return m_evictionSignal.connect( evict );
+}
+
+void WMemoryBudget::unsubscribeEviction( boost::signals2::connection connection )
+{
+    boost::lock_guard< boost::recursive_mutex > lock( m_evictionMutex );
+    connection.disconnect();
+}
+
+bool WMemoryBudget::tryReserve( size_t bytes, size_t budget )
+{
+    size_t usage = m_usage;
+    do
+    {
+        if( usage + bytes > budget )
+        {
+            return false;
+        }
+    }
+    while( !m_usage.compare_exchange_weak( usage, usage + bytes ) );
+    return true;
+}
@@ -0,0 +1,167 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMEMORYBUDGET_H
+#define WMEMORYBUDGET_H
+
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/signals2/signal.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+/**
+ * Accounts the main memory held by large data objects, like value sets, fibers and triangle meshes, and enforces a global budget. Data
+ * objects reserve their memory using \ref WMemoryReservation. If a reservation would exceed the budget, caches subscribed using \ref
+ * subscribeEviction are asked to free memory first. If this does not help, the reservation is refused by throwing WOutOfMemoryBudget, which
+ * lets the module creating the data fail gracefully instead of the whole application running out of memory.
+ *
+ * Caches which are built on demand, like the fiber LOD levels, the fiber direction arrays and the segment index, reserve their memory without
+ * being refused, as the thread needing them cannot handle a failure. They evict other caches if needed though, and release their memory on
+ * eviction themselves.
+ */
+class WMemoryBudget
+{
+public:
+    /**
+     * Convenience typedef for a boost::shared_ptr< WMemoryBudget >.
+     */
+    typedef boost::shared_ptr< WMemoryBudget > SPtr;
+
+    /**
+     * Function called to free memory. The parameter is the number of bytes missing.
+     */
+    typedef boost::function< void ( size_t ) > EvictionFunction;
+
+    /**
+     * Returns the global budget instance.
+     *
+     * \return the instance
+     */
+    static SPtr getMemoryBudget();
+
+    /**
+     * Destructor.
+     */
+    ~WMemoryBudget();
+
+    /**
+     * Sets the budget.
+     *
+     * \param bytes the budget in bytes. 0 disables the budget, which is the default.
+     */
+    void setBudget( size_t bytes );
+
+    /**
+     * The budget.
+     *
+     * \return the budget in bytes, 0 if disabled.
+     */
+    size_t getBudget() const;
+
+    /**
+     * The memory currently reserved by all data objects.
+     *
+     * \return the reserved memory in bytes
+     */
+    size_t getUsage() const;
+
+    /**
+     * Reserves the given amount of memory. Prefer \ref WMemoryReservation, which releases the memory automatically.
+     *
+     * \param bytes the number of bytes
+     * \param what description of the data, used in the error message
+     * \param mayRefuse if false, caches are evicted if needed but the reservation is never refused, even if it exceeds the budget
+     *
+     * \throw WOutOfMemoryBudget if the reservation would exceed the budget even after evicting caches.
+     */
+    void reserve( size_t bytes, const std::string& what, bool mayRefuse = true );
+
+    /**
+     * Releases memory reserved by \ref reserve.
+     *
+     * \param bytes the number of bytes
+     */
+    void release( size_t bytes );
+
+    /**
+     * Subscribes a cache to be asked for freeing memory if the budget is exceeded. The function is called in the thread doing the reservation.
+     * It should release its reservations and must not reserve memory. To avoid deadlocks, it must not block on locks held while reserving
+     * memory, so it should skip a cache that is in use.
+     *
+     * \param evict the function
+     *
+     * \return the connection. Disconnect it using \ref unsubscribeEviction before destroying the cache.
+     */
+    boost::signals2::connection subscribeEviction( EvictionFunction evict );
+
+    /**
+     * Disconnects a cache subscribed by \ref subscribeEviction. Waits for a running eviction, so the function is not called anymore when
+     * this returns. It can be called during an eviction by the evicting thread.
+     *
+     * \param connection the connection
+     */
+    void unsubscribeEviction( boost::signals2::connection connection );
+
+private:
+    /**
+     * Singleton. Use \ref getMemoryBudget.
+     */
+    WMemoryBudget();
+
+    /**
+     * Adds the bytes to the usage if that does not exceed the budget. The check and the addition are one atomic step.
+     *
+     * \param bytes the number of bytes
+     * \param budget the budget
+     *
+     * \return true if the bytes were added
+     */
+    bool tryReserve( size_t bytes, size_t budget );
+
+    /**
+     * The budget in bytes. 0 if disabled.
+     */
+    boost::atomic< size_t > m_budget;
+
+    /**
+     * The reserved bytes.
+     */
+    boost::atomic< size_t > m_usage;
+
+    /**
+     * Caches to ask for memory.
+     */
+    boost::signals2::signal< void( size_t ) > m_evictionSignal;
+
+    /**
+     * Serializes evictions and disconnecting caches. This avoids several threads evicting the same caches at once. It is recursive, as
+     * evicting a cache may destroy other caches.
+     */
+    boost::recursive_mutex m_evictionMutex;
+};
+
+#endif  // WMEMORYBUDGET_H
@@ -0,0 +1,93 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMEMORYRESERVATION_H
+#define WMEMORYRESERVATION_H
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include "WMemoryBudget.h"
+
+/**
+ * Reserves memory in the global WMemoryBudget for the lifetime of the instance. Data objects keep one of these for the memory they hold.
+ * Non-copyable, share it using \ref SPtr if the memory is shared.
+ */
+class WMemoryReservation
+{
+public:
+    /**
+     * Convenience typedef for a boost::shared_ptr< WMemoryReservation >.
+     */
+    typedef boost::shared_ptr< WMemoryReservation > SPtr;
+
+    /**
+     * Reserves the memory.
+     *
+     * \param bytes the number of bytes
+     * \param what description of the data, used in the error message
+     * \param mayRefuse if false, the reservation is never refused. Used for caches, see \ref WMemoryBudget::reserve.
+     *
+     * \throw WOutOfMemoryBudget if the budget is exceeded.
+     */
+    WMemoryReservation( size_t bytes, const std::string& what, bool mayRefuse = true );
+
+    /**
+     * Releases the memory.
+     */
+    ~WMemoryReservation();
+
+    /**
+     * The reserved memory.
+     *
+     * \return the size in bytes
+     */
+    size_t getSize() const;
+
+private:
+    /**
+     * Non-copyable.
+     */
+    WMemoryReservation( const WMemoryReservation& ); // NOLINT
+
+    /**
+     * Non-copyable.
+     *
+     * \return this
+     */
+    WMemoryReservation& operator=( const WMemoryReservation& );
+
+    /**
+     * The budget. Kept to release the memory even during static destruction.
+     */
+    WMemoryBudget::SPtr m_budget;
+
+    /**
+     * The reserved bytes.
+     */
+    size_t m_bytes;
+};
+
+#endif  // WMEMORYRESERVATION_H
@@ -29,13 +29,15 @@
 #include "../common/WCondition.h"
 
 #include "WProgress.h"
+#include "WTrace.h"
 
 WProgress::WProgress( std::string name, size_t count )
     : m_name( name ),
       m_max( count - 1 ),
       m_count( 0 ),
       m_pending( true ),
-     m_determined( true )
+     m_determined( true ),
+      m_traceStart( WTRACE_NOW() )
 {
     if( count == 0 )
     {
@@ -56,6 +58,10 @@ void WProgress::update()
 
 void WProgress::finish()
 {
+    if( m_pending )
+    {
+        WTRACE_RECORD( "progress", m_name.c_str(), m_traceStart );
+    }
     m_pending = false;
     m_count = m_max;
 }
@@ -159,6 +159,11 @@ protected:
      */
     bool m_determined;
 
+    /**
+     * Time of construction in the trace clock. Used to record the progress as span in \ref WTrace when finished.
+     */
+    double m_traceStart;
+
 private:
 };
 
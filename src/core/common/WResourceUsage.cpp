@@ -0,0 +1,114 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#if defined( __linux__ ) || defined( __APPLE__ )
+#include <pthread.h>
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+#include "WResourceUsage.h"
+
+#if defined( __linux__ ) || defined( __APPLE__ )
+namespace
+{
+    /**
+     * Queries the specified POSIX clock.
+     *
+     * \param clock the clock to query
+     *
+     * \return the time in seconds or 0 if the clock is not available.
+     */
+    double getClockTime( clockid_t clock )
+    {
+        timespec t;
+        if( clock_gettime( clock, &t ) != 0 )
+        {
+            return 0.0;
+        }
+        return static_cast< double >( t.tv_sec ) + static_cast< double >( t.tv_nsec ) * 1e-9;
+    }
+}
+#endif
+
+double getThreadCPUTime()
+{
+#if defined( __linux__ ) || defined( __APPLE__ )
+    return getClockTime( CLOCK_THREAD_CPUTIME_ID );
+#else
+    return 0.0;
+#endif
+}
+
+double getProcessCPUTime()
+{
+#if defined( __linux__ ) || defined( __APPLE__ )
+    return getClockTime( CLOCK_PROCESS_CPUTIME_ID );
+#else
+    return 0.0;
+#endif
+}
+
+size_t getPeakMemoryUsage()
+{
+#if defined( __linux__ ) || defined( __APPLE__ )
+    rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    // bytes on OS X
+    return static_cast< size_t >( usage.ru_maxrss );
+#else
+    // kilobytes on Linux
+    return static_cast< size_t >( usage.ru_maxrss ) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+WThreadCPUClock::WThreadCPUClock():
+    m_thread( boost::this_thread::get_id() )
+{
+#ifdef __linux__
+    m_valid = ( pthread_getcpuclockid( pthread_self(), &m_clock ) == 0 );
+#endif
+}
+
+double WThreadCPUClock::getTime() const
+{
+#ifdef __linux__
+    if( m_valid )
+    {
+        return getClockTime( m_clock );
+    }
+#endif
+    if( m_thread == boost::this_thread::get_id() )
+    {
+        return getThreadCPUTime();
+    }
+    return -1.0;
+}
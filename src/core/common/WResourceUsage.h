@@ -0,0 +1,104 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WRESOURCEUSAGE_H
+#define WRESOURCEUSAGE_H
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+#include <cstddef>
+
+#include <boost/thread.hpp>
+
+/**
+ * Returns the CPU time consumed by the calling thread.
+ *
+ * \note returns 0 on platforms where this is not supported.
+ *
+ * \return the CPU time in seconds.
+ */
+double getThreadCPUTime();
+
+/**
+ * Returns the CPU time consumed by all threads of this process.
+ *
+ * \note returns 0 on platforms where this is not supported.
+ *
+ * \return the CPU time in seconds.
+ */
+double getProcessCPUTime();
+
+/**
+ * Returns the peak resident set size of this process since its start. There is no per-thread equivalent, as all threads share the memory
+ * of the process.
+ *
+ * \note returns 0 on platforms where this is not supported.
+ *
+ * \return the peak memory usage in bytes.
+ */
+size_t getPeakMemoryUsage();
+
+/**
+ * The CPU time clock of a thread. Unlike \ref getThreadCPUTime, it can be read by other threads as long as the thread is alive.
+ */
+class WThreadCPUClock
+{
+public:
+    /**
+     * Constructor. Refers to the clock of the calling thread.
+     */
+    WThreadCPUClock();
+
+    /**
+     * Returns the CPU time consumed by the thread of this clock.
+     *
+     * \note Only Linux supports reading the clock of another thread. On other platforms, this returns a negative value if called by
+     * another thread and 0 if CPU time is not supported at all.
+     *
+     * \return the CPU time in seconds.
+     */
+    double getTime() const;
+
+private:
+    /**
+     * The thread of this clock.
+     */
+    boost::thread::id m_thread;
+
+#ifdef __linux__
+    /**
+     * The POSIX clock of the thread.
+     */
+    clockid_t m_clock;
+
+    /**
+     * True if m_clock could be retrieved.
+     */
+    bool m_valid;
+#endif
+};
+
+#endif  // WRESOURCEUSAGE_H
@@ -0,0 +1,400 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSHAREDOBJECTRCU_H
+#define WSHAREDOBJECTRCU_H
+
+#include <map>
+#include <set>
+
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "WCondition.h"
+#include "WSharedObjectRCUTicketRead.h"
+#include "WSharedObjectRCUTicketWrite.h"
+
+/**
+ * Read-copy-update variant of \ref WSharedObject for read-mostly data. It provides the same ticket API but readers never write to memory
+ * shared with other threads. Each thread caches a snapshot of the current version and only refreshes it if a writer published a newer one.
+ * Only this refresh briefly locks against writers publishing at the same time, all other reads are lock-free. Writers copy the current
+ * version, modify the copy and publish it when the ticket is released.
+ *
+ * Use this for data that is read very often from many threads but changes rarely, like the module prototypes, the ROI branches or the
+ * colormapped textures. For frequently modified data, use \ref WSharedObject, as each write ticket copies the whole object.
+ *
+ * \note Readers may see an outdated version while a writer is active. A thread holding a read ticket keeps seeing the snapshot of this ticket
+ * for all nested read tickets, even if a newer version has been published meanwhile.
+ * \note Every thread keeps its last snapshot alive until it reads again, the thread exits or this object gets destroyed. Read tickets keep
+ * their snapshot alive on their own, so they may outlive both the thread and this object.
+ */
+template < typename T >
+class WSharedObjectRCU
+{
+/**
+ * The write ticket needs access to the current version and to publish.
+ */
+friend class WSharedObjectRCUTicketWrite< T >;
+public:
+    /**
+     * Default constructor.
+     */
+    WSharedObjectRCU();
+
+    /**
+     * Constructor. Initializes the protected object with the specified value.
+     *
+     * \param value the initial value
+     */
+    explicit WSharedObjectRCU( const T& value );
+
+    /**
+     * Destructor.
+     */
+    virtual ~WSharedObjectRCU();
+
+    /**
+     * The type protected by this shared object class
+     */
+    typedef T ValueT;
+
+    /**
+     * Type for read tickets.
+     */
+    typedef boost::shared_ptr< WSharedObjectRCUTicketRead< T > > ReadTicket;
+
+    /**
+     * Type for write tickets.
+     */
+    typedef boost::shared_ptr< WSharedObjectRCUTicketWrite< T > > WriteTicket;
+
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WSharedObjectRCU< T > > SPtr;
+
+    /**
+     * Const shared ptr abbreviation.
+     */
+    typedef boost::shared_ptr< const WSharedObjectRCU< T > > ConstSPtr;
+
+    /**
+     * Returns a ticket to get read access to the contained data. This only blocks if the calling thread refreshes its snapshot while a writer
+     * publishes a new version. After the ticket is freed, the calling thread may refresh its snapshot again.
+     *
+     * \return the read ticket
+     */
+    ReadTicket getReadTicket() const;
+
+    /**
+     * Returns a ticket to get write access to a copy of the contained data. Writers are serialized. After the ticket is freed, the copy gets
+     * published.
+     *
+     * \param suppressNotify true if no notification should be send after unlocking.
+     *
+     * \return the ticket
+     */
+    WriteTicket getWriteTicket( bool suppressNotify = false ) const;
+
+    /**
+     * This condition fires whenever the encapsulated object changed. This is fired automatically when a write ticket gets released.
+     *
+     * \return the condition
+     */
+    boost::shared_ptr< WCondition > getChangeCondition() const;
+
+protected:
+    struct ReaderSlot;
+
+    /**
+     * The reader slots of all threads which have read an object. Shared with the slots, so a slot can unregister itself on thread exit
+     * as long as the object exists.
+     */
+    struct SlotRegistry
+    {
+        /**
+         * Protects m_slots and the snapshots of the slots against concurrent release.
+         */
+        boost::mutex m_lock;
+
+        /**
+         * The registered slots.
+         */
+        std::set< ReaderSlot* > m_slots;
+    };
+
+    /**
+     * The snapshot a thread uses for reading.
+     */
+    struct ReaderSlot
+    {
+        /**
+         * Constructor. Creates an empty slot which gets refreshed upon first read.
+         *
+         * \param registry the registry of the object this slot belongs to
+         */
+        explicit ReaderSlot( boost::shared_ptr< SlotRegistry > registry ):
+            m_version( 0 ),
+            m_registry( registry )
+        {
+        }
+
+        /**
+         * Destructor. Called on thread exit. Unregisters the slot if the object still exists.
+         */
+        ~ReaderSlot()
+        {
+            boost::shared_ptr< SlotRegistry > registry = m_registry.lock();
+            if( registry )
+            {
+                boost::lock_guard< boost::mutex > lock( registry->m_lock );
+                registry->m_slots.erase( this );
+            }
+        }
+
+        /**
+         * The snapshot. It uses a reference count of its own, private to the thread, so copying it into read tickets does not write to
+         * memory shared with other threads. A count above one means that read tickets of the thread use the snapshot.
+         */
+        boost::shared_ptr< const T > m_snapshot;
+
+        /**
+         * The version of the snapshot.
+         */
+        size_t m_version;
+
+        /**
+         * The registry of the object. Expires when the object gets destroyed.
+         */
+        boost::weak_ptr< SlotRegistry > m_registry;
+
+        /**
+         * Avoids that the slots of different threads share a cache line.
+         */
+        char m_padding[ 64 ];
+    };
+
+    /**
+     * Maps the instance ID of a shared object to the reader slot of the current thread. The slots are owned by the thread and get freed
+     * on thread exit together with their snapshots.
+     */
+    typedef std::map< size_t, boost::shared_ptr< ReaderSlot > > SlotMap;
+
+    /**
+     * Publishes a new version of the object.
+     *
+     * \param object the new version
+     */
+    void publish( boost::shared_ptr< const T > object ) const;
+
+    /**
+     * Returns the slot of the calling thread. Creates one if the thread has not read this object before.
+     *
+     * \return the slot
+     */
+    ReaderSlot* getReaderSlot() const;
+
+    /**
+     * The current version. Only modified by \ref publish. Readers copy it while holding m_publishLock.
+     */
+    mutable boost::shared_ptr< const T > m_current;
+
+    /**
+     * Incremented each time a new version is published. Readers compare it against the version of their snapshot. This is the only shared
+     * data touched by readers in the common case and it is never written by them.
+     */
+    mutable boost::atomic< size_t > m_version;
+
+    /**
+     * Protects m_current. Readers only lock it if they need to refresh their snapshot.
+     */
+    mutable boost::mutex m_publishLock;
+
+    /**
+     * Serializes writers.
+     */
+    mutable boost::mutex m_writeLock;
+
+    /**
+     * The reader slots of all threads which have read this object and have not exited yet. Used to free all snapshots on destruction.
+     */
+    boost::shared_ptr< SlotRegistry > m_registry;
+
+    /**
+     * The unique ID of this instance. Used as key in the thread-local slot map. Instance addresses cannot be used, as they might get re-used
+     * after destruction.
+     */
+    size_t m_instanceID;
+
+    /**
+     * Counter to create the instance IDs.
+     */
+    static boost::atomic< size_t > s_instanceCounter;
+
+    /**
+     * The per-thread map of reader slots.
+     */
+    static boost::thread_specific_ptr< SlotMap > s_threadSlots;
+
+    /**
+     * This condition set fires whenever the contained object changes. This corresponds to the Observable pattern.
+     */
+    boost::shared_ptr< WCondition > m_changeCondition;
+
+private:
+};
+
+template < typename T >
+boost::atomic< size_t > WSharedObjectRCU< T >::s_instanceCounter( 0 );
+
+template < typename T >
+boost::thread_specific_ptr< typename WSharedObjectRCU< T >::SlotMap > WSharedObjectRCU< T >::s_threadSlots;
+
+template < typename T >
+WSharedObjectRCU< T >::WSharedObjectRCU():
+    m_current( new T() ),
+    m_version( 1 ),
+    m_registry( new SlotRegistry() ),
+    m_instanceID( ++s_instanceCounter ),
+    m_changeCondition( new WCondition() )
+{
+    // init members
+}
+
+template < typename T >
+WSharedObjectRCU< T >::WSharedObjectRCU( const T& value ):
+    m_current( new T( value ) ),
+    m_version( 1 ),
+    m_registry( new SlotRegistry() ),
+    m_instanceID( ++s_instanceCounter ),
+    m_changeCondition( new WCondition() )
+{
+    // init members
+}
+
+template < typename T >
+WSharedObjectRCU< T >::~WSharedObjectRCU()
+{
+    // NOTE: the entries in the thread-local maps of other threads cannot be removed here. They are never accessed again as the ID is unique
+    // and get freed on thread exit. Release their snapshots now.
+    {
+        boost::lock_guard< boost::mutex > lock( m_registry->m_lock );
+        for( typename std::set< ReaderSlot* >::const_iterator it = m_registry->m_slots.begin(); it != m_registry->m_slots.end(); ++it )
+        {
+            ( *it )->m_snapshot.reset();
+        }
+        m_registry->m_slots.clear();
+    }
+
+    SlotMap* slots = s_threadSlots.get();
+    if( slots )
+    {
+        slots->erase( m_instanceID );
+    }
+}
+
+template < typename T >
+boost::shared_ptr< WCondition > WSharedObjectRCU< T >::getChangeCondition() const
+{
+    return m_changeCondition;
+}
+
+template < typename T >
+typename WSharedObjectRCU< T >::ReaderSlot* WSharedObjectRCU< T >::getReaderSlot() const
+{
+    SlotMap* slots = s_threadSlots.get();
+    if( !slots )
+    {
+        slots = new SlotMap();
+        s_threadSlots.reset( slots );
+    }
+
+    typename SlotMap::const_iterator it = slots->find( m_instanceID );
+    if( it != slots->end() )
+    {
+        return it->second.get();
+    }
+
+    // first read of this thread
+    boost::shared_ptr< ReaderSlot > slot( new ReaderSlot( m_registry ) );
+    {
+        boost::lock_guard< boost::mutex > lock( m_registry->m_lock );
+        m_registry->m_slots.insert( slot.get() );
+    }
+    ( *slots )[ m_instanceID ] = slot;
+    return slot.get();
+}
+
+template < typename T >
+typename WSharedObjectRCU< T >::ReadTicket WSharedObjectRCU< T >::getReadTicket() const
+{
+    ReaderSlot* slot = getReaderSlot();
+
+    // only refresh if no ticket of this thread uses the snapshot anymore
+    if( ( slot->m_snapshot.use_count() <= 1 ) && ( slot->m_version != m_version.load( boost::memory_order_acquire ) ) )
+    {
+        boost::shared_ptr< boost::shared_ptr< const T > > holder( new boost::shared_ptr< const T >() );
+        {
+            boost::lock_guard< boost::mutex > lock( m_publishLock );
+            *holder = m_current;
+            slot->m_version = m_version.load( boost::memory_order_relaxed );
+        }
+        // alias the version with the thread-private reference count of the holder
+        slot->m_snapshot = boost::shared_ptr< const T >( holder, holder->get() );
+    }
+
+    return boost::shared_ptr< WSharedObjectRCUTicketRead< T > >( new WSharedObjectRCUTicketRead< T >( slot->m_snapshot ) );
+}
+
+template < typename T >
+typename WSharedObjectRCU< T >::WriteTicket WSharedObjectRCU< T >::getWriteTicket( bool suppressNotify ) const
+{
+    if( suppressNotify )
+    {
+        return boost::shared_ptr< WSharedObjectRCUTicketWrite< T > >(
+                new WSharedObjectRCUTicketWrite< T >( *this, m_writeLock, boost::shared_ptr< WCondition >() )
+        );
+    }
+    else
+    {
+        return boost::shared_ptr< WSharedObjectRCUTicketWrite< T > >(
+                new WSharedObjectRCUTicketWrite< T >( *this, m_writeLock, m_changeCondition )
+        );
+    }
+}
+
+template < typename T >
+void WSharedObjectRCU< T >::publish( boost::shared_ptr< const T > object ) const
+{
+    boost::unique_lock< boost::mutex > lock( m_publishLock );
+    m_current.swap( object );
+    m_version.fetch_add( 1, boost::memory_order_release );
+    lock.unlock();
+
+    // NOTE: object now holds the previous version. It gets freed here, outside the lock, if no reader uses it anymore.
+}
+
+#endif  // WSHAREDOBJECTRCU_H
@@ -0,0 +1,85 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSHAREDOBJECTRCUTICKETREAD_H
+#define WSHAREDOBJECTRCUTICKETREAD_H
+
+#include <boost/shared_ptr.hpp>
+
+// The shared object class
+template < typename T >
+class WSharedObjectRCU;
+
+/**
+ * Read access to a snapshot of an object protected by \ref WSharedObjectRCU. Unlike \ref WSharedObjectTicketRead, this ticket does not hold
+ * any lock. It shares ownership of the snapshot cached by the calling thread instead, so the snapshot stays valid as long as the ticket
+ * exists, even if the shared object gets destroyed or the thread exits. While the ticket is alive, the thread will not replace its snapshot
+ * with a newer version.
+ */
+template < typename Data >
+class WSharedObjectRCUTicketRead
+{
+/**
+ * The shared object class needs protected access to create new instances.
+ */
+friend class WSharedObjectRCU< Data >;
+public:
+    /**
+     * Destroys the ticket and releases the snapshot.
+     */
+    virtual ~WSharedObjectRCUTicketRead()
+    {
+    };
+
+    /**
+     * Returns the protected data. As long as you own the ticket, you are allowed to use it. Writers never modify this instance. They publish
+     * a new one.
+     *
+     * \return the data (const!)
+     */
+    const Data& get() const
+    {
+        return *m_data;
+    };
+
+protected:
+    /**
+     * Create a new instance. It is protected to avoid someone to create them.
+     *
+     * \param data the snapshot to grant access to
+     */
+    explicit WSharedObjectRCUTicketRead( boost::shared_ptr< const Data > data ):
+        m_data( data )
+    {
+    };
+
+    /**
+     * The snapshot to which access is allowed by the ticket.
+     */
+    boost::shared_ptr< const Data > m_data;
+
+private:
+};
+
+#endif  // WSHAREDOBJECTRCUTICKETREAD_H
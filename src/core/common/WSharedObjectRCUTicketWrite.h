@@ -0,0 +1,125 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSHAREDOBJECTRCUTICKETWRITE_H
+#define WSHAREDOBJECTRCUTICKETWRITE_H
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "WCondition.h"
+
+// The shared object class
+template < typename T >
+class WSharedObjectRCU;
+
+/**
+ * Write access to an object protected by \ref WSharedObjectRCU. The ticket works on a private copy of the current version. Writers are
+ * serialized among each other but never block readers. The copy gets published when the ticket is destroyed. Readers acquiring a ticket
+ * afterwards will see the new version.
+ */
+template < typename Data >
+class WSharedObjectRCUTicketWrite
+{
+/**
+ * The shared object class needs protected access to create new instances.
+ */
+friend class WSharedObjectRCU< Data >;
+public:
+    /**
+     * Destroys the ticket, publishes the modified copy and releases the writer lock.
+     */
+    virtual ~WSharedObjectRCUTicketWrite()
+    {
+        m_owner.publish( m_copy );
+
+        // explicitly unlock to ensure the condition gets notified AFTER the lock has been released
+        m_lock.unlock();
+        if( m_condition )
+        {
+            m_condition->notify();
+        }
+    };
+
+    /**
+     * Returns the private copy of the data. As long as you own the ticket, you are allowed to use it.
+     *
+     * \return the data
+     */
+    Data& get() const
+    {
+        return *m_copy;
+    };
+
+    /**
+     * If called, the unlock will NOT fire the condition. This is useful in some situations if you find out "hey there actually was nothing
+     * changed".
+     */
+    void suppressUnlockCondition()
+    {
+        m_condition = boost::shared_ptr< WCondition >();
+    }
+
+protected:
+    /**
+     * Create a new instance. It is protected to avoid someone to create them. It locks the writer mutex and copies the current version.
+     *
+     * \param owner the shared object to which the copy gets published
+     * \param mutex the mutex used to serialize writers
+     * \param current the current version of the data
+     * \param condition a condition that should be fired upon unlock. Can be NULL.
+     */
+    WSharedObjectRCUTicketWrite( const WSharedObjectRCU< Data >& owner, boost::mutex& mutex, // NOLINT
+                                 boost::shared_ptr< WCondition > condition ):
+        m_owner( owner ),
+        m_lock( mutex ),
+        m_copy( new Data( *owner.m_current ) ),
+        m_condition( condition )
+    {
+    };
+
+    /**
+     * The shared object owning the data.
+     */
+    const WSharedObjectRCU< Data >& m_owner;
+
+    /**
+     * The writer lock.
+     */
+    boost::unique_lock< boost::mutex > m_lock;
+
+    /**
+     * The private copy which gets published on destruction.
+     */
+    boost::shared_ptr< Data > m_copy;
+
+    /**
+     * A condition which gets notified after unlocking. Especially useful to notify waiting threads about a change in the object.
+     */
+    boost::shared_ptr< WCondition > m_condition;
+
+private:
+};
+
+#endif  // WSHAREDOBJECTRCUTICKETWRITE_H
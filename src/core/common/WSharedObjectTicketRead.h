@@ -29,6 +29,7 @@
 
 #include "WCondition.h"
 #include "WSharedObjectTicket.h"
+#include "WTraceScope.h"
 
 /**
  * Class which represents granted access to a locked object. It contains a reference to the object and a lock. The lock is freed after the ticket
@@ -73,8 +74,14 @@ protected:
      */
     WSharedObjectTicketRead( Data& data, boost::shared_ptr< boost::shared_mutex > mutex, boost::shared_ptr< WCondition > condition ): // NOLINT
         WSharedObjectTicket< Data >( data, mutex, condition ),
-        m_lock( boost::shared_lock< boost::shared_mutex >( *mutex ) )
+        m_lock( *mutex, boost::defer_lock )
     {
+        // only contended locks get traced
+        if( !m_lock.try_lock() )
+        {
+            WTRACE_SCOPE( "lock", "WSharedObject::getReadTicket" );
+            m_lock.lock();
+        }
     };
 
     /**
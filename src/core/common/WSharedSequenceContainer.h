@@ -34,9 +34,11 @@
 /**
  * This class provides a common interface for thread-safe access to sequence containers (list, vector, dequeue ).
  * \param S the sequence container to use. Everything is allowed here which provides push_back and pop_back as well as size functionality.
+ * \param Base the shared object protecting the container. Use WSharedObjectRCU< S > for containers which are read often but modified rarely.
+ * The methods returning non-const references or iterators can only be used with WSharedObject< S >.
  */
-template < typename S >
-class WSharedSequenceContainer: public WSharedObject< S >
+template < typename S, typename Base = WSharedObject< S > >
+class WSharedSequenceContainer: public Base
 {
 public:
     // Some helpful typedefs
@@ -176,7 +178,7 @@ public:
      *
      * \return A random access iterator pointing to the new location of the element that followed the last element erased by the function call.
      */
-    typename WSharedSequenceContainer< S >::Iterator erase( typename WSharedSequenceContainer< S >::Iterator position );
+    typename WSharedSequenceContainer< S, Base >::Iterator erase( typename WSharedSequenceContainer< S, Base >::Iterator position );
 
     /**
      * Erase the specified range of elements. Read your STL reference for more details.
@@ -186,8 +188,8 @@ public:
      *
      * \return A random access iterator pointing to the new location of the element that followed the last element erased by the function call.
      */
-    typename WSharedSequenceContainer< S >::Iterator erase( typename WSharedSequenceContainer< S >::Iterator first,
-                                                            typename WSharedSequenceContainer< S >::Iterator last );
+    typename WSharedSequenceContainer< S, Base >::Iterator erase( typename WSharedSequenceContainer< S, Base >::Iterator first,
+                                                            typename WSharedSequenceContainer< S, Base >::Iterator last );
 
     /**
      * Replaces the specified old value by a new one. If the old one does not exist, nothing happens. This is a comfortable forwarder for
@@ -225,7 +227,8 @@ public:
      * \param comp the comparator
      */
     template < typename Comparator >
-    void sort( typename WSharedSequenceContainer< S >::Iterator first, typename WSharedSequenceContainer< S >::Iterator last, Comparator comp );
+    void sort( typename WSharedSequenceContainer< S, Base >::Iterator first, typename WSharedSequenceContainer< S, Base >::Iterator last,
+               Comparator comp );
 
     /**
      * Resorts the container using the specified comparator from its begin to its end. Uses stable sort algorithm.
@@ -245,7 +248,8 @@ public:
      * \param comp the comparator
      */
     template < typename Comparator >
-    void stableSort( typename WSharedSequenceContainer< S >::Iterator first, typename WSharedSequenceContainer< S >::Iterator last, Comparator comp );
+    void stableSort( typename WSharedSequenceContainer< S, Base >::Iterator first, typename WSharedSequenceContainer< S, Base >::Iterator last,
+                     Comparator comp );
 
     /**
      * Searches the specified value in the range [first,last).
@@ -256,8 +260,8 @@ public:
      *
      * \return the iterator pointing to the found element.
      */
-    typename WSharedSequenceContainer< S >::Iterator find( typename WSharedSequenceContainer< S >::Iterator first,
-                                                           typename WSharedSequenceContainer< S >::Iterator last,
+    typename WSharedSequenceContainer< S, Base >::Iterator find( typename WSharedSequenceContainer< S, Base >::Iterator first,
+                                                           typename WSharedSequenceContainer< S, Base >::Iterator last,
                                                            const typename S::value_type& value );
 
     /**
@@ -267,46 +271,46 @@ public:
      *
      * \return the iterator pointing to the found element.
      */
-    typename WSharedSequenceContainer< S >::ConstIterator find( const typename S::value_type& value );
+    typename WSharedSequenceContainer< S, Base >::ConstIterator find( const typename S::value_type& value );
 
 protected:
 private:
 };
 
-template < typename S >
-WSharedSequenceContainer< S >::WSharedSequenceContainer():
-    WSharedObject< S >()
+template < typename S, typename Base >
+WSharedSequenceContainer< S, Base >::WSharedSequenceContainer():
+    Base()
 {
     // init members
 }
 
-template < typename S >
-WSharedSequenceContainer< S >::~WSharedSequenceContainer()
+template < typename S, typename Base >
+WSharedSequenceContainer< S, Base >::~WSharedSequenceContainer()
 {
     // clean up
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::push_back( const typename S::value_type& x )
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::push_back( const typename S::value_type& x )
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     a->get().push_back( x );
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::push_front( const typename S::value_type& x )
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::push_front( const typename S::value_type& x )
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     a->get().insert( a->get().begin(), x );
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::unique_push_back( const typename S::value_type& x )
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::unique_push_back( const typename S::value_type& x )
 {
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
-    WSharedSequenceContainer< S >::Iterator it = std::find( a->get().begin(), a->get().end(), x );
+    typename Base::WriteTicket a = Base::getWriteTicket();
+    WSharedSequenceContainer< S, Base >::Iterator it = std::find( a->get().begin(), a->get().end(), x );
     if( it == a->get().end() )
     {
         // not found -> add
@@ -314,11 +318,11 @@ void WSharedSequenceContainer< S >::unique_push_back( const typename S::value_ty
     }
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::unique_push_front( const typename S::value_type& x )
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::unique_push_front( const typename S::value_type& x )
 {
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
-    WSharedSequenceContainer< S >::Iterator it = std::find( a->get().begin(), a->get().end(), x );
+    typename Base::WriteTicket a = Base::getWriteTicket();
+    WSharedSequenceContainer< S, Base >::Iterator it = std::find( a->get().begin(), a->get().end(), x );
     if( it == a->get().end() )
     {
         // not found -> add
@@ -326,148 +330,149 @@ void WSharedSequenceContainer< S >::unique_push_front( const typename S::value_t
     }
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::pop_back()
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::pop_back()
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     a->get().pop_back();
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::clear()
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::clear()
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     a->get().clear();
 }
 
-template < typename S >
-size_t WSharedSequenceContainer< S >::size() const
+template < typename S, typename Base >
+size_t WSharedSequenceContainer< S, Base >::size() const
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     size_t size = a->get().size();
     return size;
 }
 
-template < typename S >
-typename S::value_type& WSharedSequenceContainer< S >::operator[]( size_t n )
+template < typename S, typename Base >
+typename S::value_type& WSharedSequenceContainer< S, Base >::operator[]( size_t n )
 {
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     return const_cast< S& >( a->get() ).operator[]( n );    // read tickets return the handled object const. This is bad here although in most cases
     // it is useful and needed.
 }
 
-template < typename S >
-const typename S::value_type& WSharedSequenceContainer< S >::operator[]( size_t n ) const
+template < typename S, typename Base >
+const typename S::value_type& WSharedSequenceContainer< S, Base >::operator[]( size_t n ) const
 {
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     return a->get().operator[]( n );
 }
 
-template < typename S >
-typename S::value_type& WSharedSequenceContainer< S >::at( size_t n )
+template < typename S, typename Base >
+typename S::value_type& WSharedSequenceContainer< S, Base >::at( size_t n )
 {
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     return const_cast< S& >( a->get() ).at( n );    // read tickets return the handled object const. This is bad here although in most cases it
     // is useful and needed.
 }
 
-template < typename S >
-const typename S::value_type& WSharedSequenceContainer< S >::at( size_t n ) const
+template < typename S, typename Base >
+const typename S::value_type& WSharedSequenceContainer< S, Base >::at( size_t n ) const
 {
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     return a->get().at( n );
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::remove( const typename S::value_type& element )
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::remove( const typename S::value_type& element )
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     a->get().erase( std::remove( a->get().begin(), a->get().end(), element ), a->get().end() );
 }
 
-template < typename S >
-typename WSharedSequenceContainer< S >::Iterator WSharedSequenceContainer< S >::erase( typename WSharedSequenceContainer< S >::Iterator position )
+template < typename S, typename Base >
+typename WSharedSequenceContainer< S, Base >::Iterator WSharedSequenceContainer< S, Base >::erase(
+        typename WSharedSequenceContainer< S, Base >::Iterator position )
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     return a->get().erase( position );
 }
 
-template < typename S >
-typename WSharedSequenceContainer< S >::Iterator WSharedSequenceContainer< S >::erase(
-        typename WSharedSequenceContainer< S >::Iterator first,
-        typename WSharedSequenceContainer< S >::Iterator last )
+template < typename S, typename Base >
+typename WSharedSequenceContainer< S, Base >::Iterator WSharedSequenceContainer< S, Base >::erase(
+        typename WSharedSequenceContainer< S, Base >::Iterator first,
+        typename WSharedSequenceContainer< S, Base >::Iterator last )
 {
     // Lock, if "a" looses focus -> look is freed
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     return a->get().erase( first, last );
 }
 
-template < typename S >
-void WSharedSequenceContainer< S >::replace( const typename S::value_type& oldValue, const typename S::value_type& newValue )
+template < typename S, typename Base >
+void WSharedSequenceContainer< S, Base >::replace( const typename S::value_type& oldValue, const typename S::value_type& newValue )
 {
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     std::replace( a->get().begin(), a->get().end(), oldValue, newValue );
 }
 
-template < typename S >
-size_t WSharedSequenceContainer< S >::count( const value_type& value )
+template < typename S, typename Base >
+size_t WSharedSequenceContainer< S, Base >::count( const value_type& value )
 {
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     return std::count( a->get().begin(), a->get().end(), value );
 }
 
-template < typename S >
+template < typename S, typename Base >
 template < typename Comparator >
-void WSharedSequenceContainer< S >::sort( Comparator comp )
+void WSharedSequenceContainer< S, Base >::sort( Comparator comp )
 {
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     return std::sort( a->get().begin(), a->get().end(), comp );
 }
 
-template < typename S >
+template < typename S, typename Base >
 template < typename Comparator >
-void WSharedSequenceContainer< S >::sort( typename WSharedSequenceContainer< S >::Iterator first,
-                                          typename WSharedSequenceContainer< S >::Iterator last,
+void WSharedSequenceContainer< S, Base >::sort( typename WSharedSequenceContainer< S, Base >::Iterator first,
+                                          typename WSharedSequenceContainer< S, Base >::Iterator last,
                                           Comparator comp )
 {
     return std::sort( first, last, comp );
 }
 
-template < typename S >
+template < typename S, typename Base >
 template < typename Comparator >
-void WSharedSequenceContainer< S >::stableSort( Comparator comp )
+void WSharedSequenceContainer< S, Base >::stableSort( Comparator comp )
 {
-    typename WSharedObject< S >::WriteTicket a = WSharedObject< S >::getWriteTicket();
+    typename Base::WriteTicket a = Base::getWriteTicket();
     return std::stable_sort( a->get().begin(), a->get().end(), comp );
 }
 
-template < typename S >
+template < typename S, typename Base >
 template < typename Comparator >
-void WSharedSequenceContainer< S >::stableSort( typename WSharedSequenceContainer< S >::Iterator first,
-                                                typename WSharedSequenceContainer< S >::Iterator last,
+void WSharedSequenceContainer< S, Base >::stableSort( typename WSharedSequenceContainer< S, Base >::Iterator first,
+                                                typename WSharedSequenceContainer< S, Base >::Iterator last,
                                                 Comparator comp )
 {
     return std::stable_sort( first, last, comp );
 }
 
-template < typename S >
-typename WSharedSequenceContainer< S >::Iterator WSharedSequenceContainer< S >::find(
-        typename WSharedSequenceContainer< S >::Iterator first,
-        typename WSharedSequenceContainer< S >::Iterator last,
+template < typename S, typename Base >
+typename WSharedSequenceContainer< S, Base >::Iterator WSharedSequenceContainer< S, Base >::find(
+        typename WSharedSequenceContainer< S, Base >::Iterator first,
+        typename WSharedSequenceContainer< S, Base >::Iterator last,
         const typename S::value_type& value )
 {
     return std::find( first, last, value );
 }
 
-template < typename S >
-typename WSharedSequenceContainer< S >::ConstIterator WSharedSequenceContainer< S >::find( const typename S::value_type& value )
+template < typename S, typename Base >
+typename WSharedSequenceContainer< S, Base >::ConstIterator WSharedSequenceContainer< S, Base >::find( const typename S::value_type& value )
 {
-    typename WSharedObject< S >::ReadTicket a = WSharedObject< S >::getReadTicket();
+    typename Base::ReadTicket a = Base::getReadTicket();
     return std::find( a->get().begin(), a->get().end(), value );
 }
 
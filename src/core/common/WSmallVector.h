@@ -0,0 +1,396 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSMALLVECTOR_H
+#define WSMALLVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+/**
+ * A dynamically sized array that stores up to N elements inside the object itself and only allocates memory on the
+ * heap for more elements. Short-lived objects of typical sizes, like temporaries in per-voxel computations, therefore
+ * never touch the allocator.
+ *
+ * Unlike std::vector, the interface is limited to what dense math needs. The elements are value-initialized, i.e.
+ * numbers are zero. Moving a vector with heap storage transfers the storage; moving one with inline storage copies the
+ * elements.
+ *
+ * \tparam T the element type, must be default constructible and assignable
+ * \tparam N the number of elements stored inline
+ */
+template< typename T, std::size_t N >
+class WSmallVector
+{
+public:
+    /**
+     * The type of the elements.
+     */
+    typedef T value_type;
+
+    /**
+     * Iterator type.
+     */
+    typedef T* iterator;
+
+    /**
+     * Const iterator type.
+     */
+    typedef T const* const_iterator;
+
+    /**
+     * The number of elements stored inline.
+     */
+    static const std::size_t InlineCapacity = N;
+
+    /**
+     * Constructs a vector with the given number of value-initialized elements.
+     *
+     * \param size the number of elements
+     */
+    explicit WSmallVector( std::size_t size = 0 );
+
+    /**
+     * Copy constructor.
+     *
+     * \param other the vector to copy
+     */
+    WSmallVector( WSmallVector const& other ); // NOLINT copy constructor is implicit on purpose
+
+    /**
+     * Move constructor. Takes over the heap storage of other, if any. Other is empty afterwards.
+     *
+     * \param other the vector to move
+     */
+    WSmallVector( WSmallVector&& other );
+
+    /**
+     * Destructor.
+     */
+    ~WSmallVector();
+
+    /**
+     * Copy assignment. Reuses the current storage if it is large enough.
+     *
+     * \param other the vector to copy
+     *
+     * \return this vector
+     */
+    WSmallVector& operator=( WSmallVector const& other );
+
+    /**
+     * Move assignment. Takes over the heap storage of other, if any. Other is empty afterwards.
+     *
+     * \param other the vector to move
+     *
+     * \return this vector
+     */
+    WSmallVector& operator=( WSmallVector&& other );
+
+    /**
+     * The number of elements.
+     *
+     * \return the number of elements
+     */
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Whether there are no elements.
+     *
+     * \return true if the vector is empty
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * The number of elements that fit into the current storage.
+     *
+     * \return the capacity
+     */
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /**
+     * Whether the elements are stored inside the object.
+     *
+     * \return true if no heap memory is used
+     */
+    bool isInline() const
+    {
+        return m_data == m_inline;
+    }
+
+    /**
+     * Changes the number of elements. New elements are value-initialized. The storage only grows.
+     *
+     * \param size the new number of elements
+     */
+    void resize( std::size_t size );
+
+    /**
+     * Access an element.
+     *
+     * \param i the index
+     *
+     * \return the element
+     */
+    T& operator[]( std::size_t i )
+    {
+        return m_data[ i ];
+    }
+
+    /**
+     * Access an element.
+     *
+     * \param i the index
+     *
+     * \return the element
+     */
+    T const& operator[]( std::size_t i ) const
+    {
+        return m_data[ i ];
+    }
+
+    /**
+     * The elements.
+     *
+     * \return pointer to the first element
+     */
+    T* data()
+    {
+        return m_data;
+    }
+
+    /**
+     * The elements.
+     *
+     * \return pointer to the first element
+     */
+    T const* data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Iterator to the first element.
+     *
+     * \return the iterator
+     */
+    iterator begin()
+    {
+        return m_data;
+    }
+
+    /**
+     * Iterator behind the last element.
+     *
+     * \return the iterator
+     */
+    iterator end()
+    {
+        return m_data + m_size;
+    }
+
+    /**
+     * Iterator to the first element.
+     *
+     * \return the iterator
+     */
+    const_iterator begin() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Iterator behind the last element.
+     *
+     * \return the iterator
+     */
+    const_iterator end() const
+    {
+        return m_data + m_size;
+    }
+
+    /**
+     * Compares the elements.
+     *
+     * \param other the other vector
+     *
+     * \return true if both have the same elements
+     */
+    bool operator==( WSmallVector const& other ) const
+    {
+        return m_size == other.m_size && std::equal( begin(), end(), other.begin() );
+    }
+
+    /**
+     * Compares the elements.
+     *
+     * \param other the other vector
+     *
+     * \return true if the elements differ
+     */
+    bool operator!=( WSmallVector const& other ) const
+    {
+        return !( *this == other );
+    }
+
+private:
+    /**
+     * Frees the heap storage, if any, and switches back to the inline storage.
+     */
+    void release();
+
+    /**
+     * The inline storage.
+     */
+    T m_inline[ N ];
+
+    /**
+     * The elements, either m_inline or heap memory.
+     */
+    T* m_data;
+
+    /**
+     * The number of elements.
+     */
+    std::size_t m_size;
+
+    /**
+     * The number of elements that fit into m_data.
+     */
+    std::size_t m_capacity;
+};
+
+template< typename T, std::size_t N >
+const std::size_t WSmallVector< T, N >::InlineCapacity;
+
+template< typename T, std::size_t N >
+WSmallVector< T, N >::WSmallVector( std::size_t size ):
+    m_data( m_inline ),
+    m_size( 0 ),
+    m_capacity( N )
+{
+    resize( size );
+}
+
+template< typename T, std::size_t N >
+WSmallVector< T, N >::WSmallVector( WSmallVector const& other ):
+    m_data( m_inline ),
+    m_size( 0 ),
+    m_capacity( N )
+{
+    *this = other;
+}
+
+template< typename T, std::size_t N >
+WSmallVector< T, N >::WSmallVector( WSmallVector&& other ):
+    m_data( m_inline ),
+    m_size( 0 ),
+    m_capacity( N )
+{
+    *this = std::move( other );
+}
+
+template< typename T, std::size_t N >
+WSmallVector< T, N >::~WSmallVector()
+{
+    release();
+}
+
+template< typename T, std::size_t N >
+WSmallVector< T, N >& WSmallVector< T, N >::operator=( WSmallVector const& other )
+{
+    if( this != &other )
+    {
+        if( other.m_size > m_capacity )
+        {
+            release();
+            m_data = new T[ other.m_size ];
+            m_capacity = other.m_size;
+        }
+        std::copy( other.begin(), other.end(), m_data );
+        m_size = other.m_size;
+    }
+    return *this;
+}
+
+template< typename T, std::size_t N >
+WSmallVector< T, N >& WSmallVector< T, N >::operator=( WSmallVector&& other )
+{
+    if( this != &other )
+    {
+        if( other.isInline() )
+        {
+            *this = other;
+        }
+        else
+        {
+            release();
+            m_data = other.m_data;
+            m_capacity = other.m_capacity;
+            m_size = other.m_size;
+            other.m_data = other.m_inline;
+            other.m_capacity = N;
+        }
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+template< typename T, std::size_t N >
+void WSmallVector< T, N >::resize( std::size_t size )
+{
+    if( size > m_capacity )
+    {
+        T* data = new T[ size ];
+        std::copy( begin(), end(), data );
+        release();
+        m_data = data;
+        m_capacity = size;
+    }
+    std::fill( m_data + std::min( m_size, size ), m_data + size, T() );
+    m_size = size;
+}
+
+template< typename T, std::size_t N >
+void WSmallVector< T, N >::release()
+{
+    if( !isInline() )
+    {
+        delete[] m_data;
+        m_data = m_inline;
+        m_capacity = N;
+    }
+}
+
+#endif  // WSMALLVECTOR_H
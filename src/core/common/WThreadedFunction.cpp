@@ -22,8 +22,95 @@
 //
 //---------------------------------------------------------------------------
 
+#include <exception>
+#include <string>
+#include <utility>
+
 #include "WThreadedFunction.h"
 
+namespace
+{
+    /**
+     * Calls a range function for the part of the indices of one thread, to be run by a WThreadedFunction. The first
+     * exception thrown by the function is kept, so the caller can rethrow it unchanged.
+     */
+    class RangeFunction
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * \param size the number of indices
+         * \param function the function to call for each range
+         */
+        RangeFunction( std::size_t size, boost::function< void( std::size_t, std::size_t ) > const& function ):
+            m_size( size ),
+            m_function( function ),
+            m_exception()
+        {
+        }
+
+        /**
+         * Calls the function for this thread's range.
+         *
+         * \param id the thread id
+         * \param numThreads the number of threads
+         * \param shutdown not used, the ranges are always completed
+         */
+        void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& /* shutdown */ )
+        {
+            std::pair< std::size_t, std::size_t > const range = getThreadRange( m_size, id, numThreads );
+            if( range.first < range.second )
+            {
+                try
+                {
+                    m_function( range.first, range.second );
+                }
+                catch( ... )
+                {
+                    boost::lock_guard< boost::mutex > lock( m_exceptionMutex );
+                    if( !m_exception )
+                    {
+                        m_exception = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        /**
+         * Rethrows the first exception thrown by the function, if any.
+         */
+        void rethrowException() const
+        {
+            if( m_exception )
+            {
+                std::rethrow_exception( m_exception );
+            }
+        }
+
+    private:
+        /**
+         * The number of indices.
+         */
+        std::size_t m_size;
+
+        /**
+         * The function to call for each range.
+         */
+        boost::function< void( std::size_t, std::size_t ) > m_function;
+
+        /**
+         * The first exception thrown by the function.
+         */
+        std::exception_ptr m_exception;
+
+        /**
+         * Protects the exception.
+         */
+        boost::mutex m_exceptionMutex;
+    };
+}
+
 WThreadedFunctionBase::WThreadedFunctionBase()
     : m_doneCondition( new WCondition ),
       m_exceptionSignal(),
@@ -55,3 +142,33 @@ void WThreadedFunctionBase::subscribeExceptionSignal( ExceptionFunction func )
         m_exceptionSignal.connect( func );
     }
 }
+
+std::pair< std::size_t, std::size_t > getThreadRange( std::size_t size, std::size_t id, std::size_t numThreads )
+{
+    WAssert( id < numThreads, "The thread id is out of range." );
+    return std::make_pair( size * id / numThreads, size * ( id + 1 ) / numThreads );
+}
+
+void runThreadedRanges( std::size_t size, std::size_t numThreads, boost::function< void( std::size_t, std::size_t ) > const& function )
+{
+    if( size == 0 )
+    {
+        return;
+    }
+    if( numThreads == 1 )
+    {
+        function( 0, size );
+        return;
+    }
+
+    boost::shared_ptr< RangeFunction > ranges( new RangeFunction( size, function ) );
+    WThreadedFunction< RangeFunction > pool( numThreads, ranges );
+    pool.run();
+    pool.wait();
+
+    ranges->rethrowException();
+    if( pool.status() != W_THREADS_FINISHED )
+    {
+        throw WException( std::string( "The threads were aborted before all ranges were done." ) );
+    }
+}
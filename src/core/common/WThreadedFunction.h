@@ -29,7 +29,9 @@
 #include <iostream>
 
 #include <string>
+#include <utility>
 #include <vector>
+#include <boost/function.hpp>
 #include <boost/thread.hpp>
 
 #include "WAssert.h"
@@ -385,4 +387,30 @@ void WThreadedFunction< Function_T >::handleThreadException( WException const& e
     m_exceptionSignal( e );
 }
 
+/**
+ * Splits the indices 0 to size - 1 into numThreads contiguous ranges whose lengths differ by at most one, as processed
+ * by the threads of a WThreadedFunction.
+ *
+ * \param size the number of indices
+ * \param id the id of the thread, from 0 to numThreads - 1
+ * \param numThreads the number of threads
+ *
+ * \return the first index of the range of thread id and the index behind its last one
+ */
+std::pair< std::size_t, std::size_t > getThreadRange( std::size_t size, std::size_t id, std::size_t numThreads );
+
+/**
+ * Calls a function for contiguous ranges of the indices 0 to size - 1, one range per thread of a WThreadedFunction, and
+ * waits for all of them. With a single thread, the function is called once for all indices in the calling thread, so
+ * small problems do not pay for starting threads.
+ *
+ * \param size the number of indices
+ * \param numThreads the number of threads, W_AUTOMATIC_NB_THREADS to choose automatically
+ * \param function called with the first index of a range and the index behind its last one
+ *
+ * \note If the function throws, the remaining ranges are still completed and the first exception is rethrown
+ * unchanged afterwards, so callers see the same exception for any number of threads.
+ */
+void runThreadedRanges( std::size_t size, std::size_t numThreads, boost::function< void( std::size_t, std::size_t ) > const& function );
+
 #endif  // WTHREADEDFUNCTION_H
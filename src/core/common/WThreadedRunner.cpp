@@ -35,6 +35,7 @@
 #include "WException.h"
 #include "WLogger.h"
 #include "WThreadedRunner.h"
+#include "WTraceScope.h"
 
 WThreadedRunner::WThreadedRunner():
     m_shutdownFlag( new WConditionOneShot(), false ),
@@ -108,9 +109,11 @@ void WThreadedRunner::waitForStop()
 void WThreadedRunner::threadMainSave()
 {
     WThreadedRunner::setThisThreadName( getThreadName() );
+    WTRACE_THREAD_NAME( getThreadName() );
 
     try
     {
+        WTRACE_SCOPE( "thread", getThreadName() );
         threadMain();
     }
     catch( const WException& e )
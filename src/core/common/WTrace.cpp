@@ -0,0 +1,483 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <osg/Timer>
+
+#include "WException.h"
+#include "WTrace.h"
+
+namespace
+{
+    /**
+     * A recorded span.
+     */
+    struct Span
+    {
+        /**
+         * The category.
+         */
+        const char* m_category;
+
+        /**
+         * The name.
+         */
+        char m_name[ WTrace::MaxNameLength + 1 ];
+
+        /**
+         * Start in microseconds.
+         */
+        double m_start;
+
+        /**
+         * Duration in microseconds.
+         */
+        double m_duration;
+    };
+
+    /**
+     * A ring buffer keeping the last items pushed. The memory is allocated as items arrive, so rarely used buffers stay small.
+     */
+    template< typename T >
+    struct Ring
+    {
+        /**
+         * Creates an empty ring.
+         *
+         * \param capacity the maximum number of items
+         */
+        explicit Ring( size_t capacity ):
+            m_capacity( capacity ),
+            m_next( 0 )
+        {
+        }
+
+        /**
+         * Adds an item and drops the oldest one if the ring is full.
+         *
+         * \param item the item
+         */
+        void push( const T& item )
+        {
+            if( m_items.size() < m_capacity )
+            {
+                m_items.push_back( item );
+            }
+            else
+            {
+                m_items[ m_next ] = item;
+            }
+            m_next = ( m_next + 1 ) % m_capacity;
+        }
+
+        /**
+         * The number of items.
+         *
+         * \return the size
+         */
+        size_t size() const
+        {
+            return m_items.size();
+        }
+
+        /**
+         * Access to the items, the oldest first.
+         *
+         * \param i the index
+         *
+         * \return the item
+         */
+        const T& operator[]( size_t i ) const
+        {
+            return m_items[ m_items.size() < m_capacity ? i : ( m_next + i ) % m_capacity ];
+        }
+
+        /**
+         * Removes all items and frees their memory.
+         */
+        void clear()
+        {
+            std::vector< T >().swap( m_items );
+            m_next = 0;
+        }
+
+        /**
+         * The maximum number of items.
+         */
+        size_t m_capacity;
+
+        /**
+         * The items.
+         */
+        std::vector< T > m_items;
+
+        /**
+         * Index of the next item to overwrite once the ring is full.
+         */
+        size_t m_next;
+    };
+
+    /**
+     * The spans of a running thread. Only the owning thread writes to it, the mutex is needed for exporting while threads are running and
+     * thus is uncontended most of the time.
+     */
+    struct ThreadBuffer
+    {
+        /**
+         * Creates an empty buffer.
+         *
+         * \param id the thread id in the trace
+         */
+        explicit ThreadBuffer( size_t id ):
+            m_id( id ),
+            m_spans( WTrace::BufferSize )
+        {
+        }
+
+        /**
+         * The thread id in the trace.
+         */
+        size_t m_id;
+
+        /**
+         * The thread name.
+         */
+        std::string m_name;
+
+        /**
+         * The spans.
+         */
+        Ring< Span > m_spans;
+
+        /**
+         * Protects the buffer during export.
+         */
+        boost::mutex m_mutex;
+    };
+
+    /**
+     * A span or the name of a thread which has exited. Names are stored as spans without category.
+     */
+    struct FinishedSpan
+    {
+        /**
+         * The thread id in the trace.
+         */
+        size_t m_id;
+
+        /**
+         * The span.
+         */
+        Span m_span;
+    };
+
+    /**
+     * Set once the registry has been destroyed, to ignore threads exiting afterwards.
+     */
+    bool registryDestroyed = false;
+
+    /**
+     * Moves the spans of an exiting thread to the registry. Called on thread exit.
+     *
+     * \param buffer the buffer of the thread
+     */
+    void releaseThreadBuffer( boost::shared_ptr< ThreadBuffer >* buffer );
+
+    /**
+     * The buffers of the running threads and the spans of the exited ones.
+     */
+    struct Registry
+    {
+        /**
+         * Constructor.
+         */
+        Registry():
+            m_nextID( 1 ),
+            m_finished( WTrace::FinishedBufferSize ),
+            m_current( &releaseThreadBuffer )
+        {
+        }
+
+        /**
+         * Destructor.
+         */
+        ~Registry()
+        {
+            // releases the buffer of the calling thread while the other members still exist
+            m_current.reset();
+            registryDestroyed = true;
+        }
+
+        /**
+         * Protects the list of buffers and the finished spans.
+         */
+        boost::mutex m_mutex;
+
+        /**
+         * The id of the next thread.
+         */
+        size_t m_nextID;
+
+        /**
+         * The buffers of all running threads that recorded something.
+         */
+        std::vector< boost::shared_ptr< ThreadBuffer > > m_buffers;
+
+        /**
+         * The last spans of the exited threads.
+         */
+        Ring< FinishedSpan > m_finished;
+
+        /**
+         * The buffer of the calling thread.
+         */
+        boost::thread_specific_ptr< boost::shared_ptr< ThreadBuffer > > m_current;
+    };
+
+    /**
+     * The registry. Created on first use to avoid static initialization order problems.
+     *
+     * \return the registry
+     */
+    Registry& getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    void releaseThreadBuffer( boost::shared_ptr< ThreadBuffer >* buffer )
+    {
+        if( !registryDestroyed )
+        {
+            Registry& registry = getRegistry();
+            boost::lock_guard< boost::mutex > registryLock( registry.m_mutex );
+            boost::lock_guard< boost::mutex > lock( ( *buffer )->m_mutex );
+
+            if( ( *buffer )->m_spans.size() )
+            {
+                FinishedSpan name = FinishedSpan();
+                name.m_id = ( *buffer )->m_id;
+                std::strncpy( name.m_span.m_name, ( *buffer )->m_name.c_str(), WTrace::MaxNameLength );
+                registry.m_finished.push( name );
+            }
+            for( size_t i = 0; i < ( *buffer )->m_spans.size(); ++i )
+            {
+                FinishedSpan span;
+                span.m_id = ( *buffer )->m_id;
+                span.m_span = ( *buffer )->m_spans[ i ];
+                registry.m_finished.push( span );
+            }
+            registry.m_buffers.erase( std::remove( registry.m_buffers.begin(), registry.m_buffers.end(), *buffer ), registry.m_buffers.end() );
+        }
+        delete buffer;
+    }
+
+    /**
+     * The buffer of the calling thread. Creates it if needed.
+     *
+     * \return the buffer
+     */
+    ThreadBuffer& getThreadBuffer()
+    {
+        Registry& registry = getRegistry();
+        if( !registry.m_current.get() )
+        {
+            boost::lock_guard< boost::mutex > lock( registry.m_mutex );
+            boost::shared_ptr< ThreadBuffer > buffer( new ThreadBuffer( registry.m_nextID++ ) );
+            registry.m_buffers.push_back( buffer );
+            registry.m_current.reset( new boost::shared_ptr< ThreadBuffer >( buffer ) );
+        }
+        return **registry.m_current;
+    }
+
+    /**
+     * Writes a string as quoted and escaped JSON string.
+     *
+     * \param out the stream
+     * \param s the string
+     */
+    void writeString( std::ostream& out, const char* s ) // NOLINT: yes, it is an intended non-const ref
+    {
+        out << "\"";
+        for( ; *s; ++s )
+        {
+            if( *s == '"' || *s == '\\' )
+            {
+                out << '\\' << *s;
+            }
+            else if( static_cast< unsigned char >( *s ) >= 0x20 )
+            {
+                out << *s;
+            }
+        }
+        out << "\"";
+    }
+
+    /**
+     * Writes the thread name metadata event.
+     *
+     * \param out the stream
+     * \param id the thread id in the trace
+     * \param name the thread name
+     */
+    void writeThreadName( std::ostream& out, size_t id, const std::string& name ) // NOLINT: yes, it is an intended non-const ref
+    {
+        out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id << ",\"args\":{\"name\":";
+        writeString( out, name.empty() ? "unnamed" : name.c_str() );
+        out << "}}";
+    }
+
+    /**
+     * Writes a span as complete event.
+     *
+     * \param out the stream
+     * \param id the thread id in the trace
+     * \param span the span
+     */
+    void writeSpan( std::ostream& out, size_t id, const Span& span ) // NOLINT: yes, it is an intended non-const ref
+    {
+        out << "\n{\"name\":";
+        writeString( out, span.m_name );
+        out << ",\"cat\":";
+        writeString( out, span.m_category );
+        out << std::fixed << ",\"ph\":\"X\",\"ts\":" << span.m_start << ",\"dur\":" << span.m_duration << ",\"pid\":1,\"tid\":" << id << "}";
+    }
+}
+
+const size_t WTrace::BufferSize;
+
+const size_t WTrace::FinishedBufferSize;
+
+const size_t WTrace::MaxNameLength;
+
+double WTrace::now()
+{
+    return osg::Timer::instance()->time_u();
+}
+
+void WTrace::record( const char* category, const char* name, double start, double duration )
+{
+    Span span;
+    span.m_category = category;
+    std::strncpy( span.m_name, name, MaxNameLength );
+    span.m_name[ MaxNameLength ] = '\0';
+    span.m_start = start;
+    span.m_duration = duration;
+
+    ThreadBuffer& buffer = getThreadBuffer();
+    boost::lock_guard< boost::mutex > lock( buffer.m_mutex );
+    buffer.m_spans.push( span );
+}
+
+void WTrace::setThreadName( const std::string& name )
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    boost::lock_guard< boost::mutex > lock( buffer.m_mutex );
+    buffer.m_name = name;
+}
+
+void WTrace::write( std::ostream& out ) // NOLINT: yes, it is an intended non-const ref
+{
+    Registry& registry = getRegistry();
+    std::vector< boost::shared_ptr< ThreadBuffer > > buffers;
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    {
+        // the spans of exited threads
+        boost::lock_guard< boost::mutex > lock( registry.m_mutex );
+        buffers = registry.m_buffers;
+        for( size_t i = 0; i < registry.m_finished.size(); ++i )
+        {
+            const FinishedSpan& span = registry.m_finished[ i ];
+            out << ( first ? "" : "," );
+            if( span.m_span.m_category )
+            {
+                writeSpan( out, span.m_id, span.m_span );
+            }
+            else
+            {
+                writeThreadName( out, span.m_id, span.m_span.m_name );
+            }
+            first = false;
+        }
+    }
+
+    for( size_t i = 0; i < buffers.size(); ++i )
+    {
+        ThreadBuffer& buffer = *buffers[ i ];
+        boost::lock_guard< boost::mutex > lock( buffer.m_mutex );
+
+        out << ( first ? "" : "," );
+        writeThreadName( out, buffer.m_id, buffer.m_name );
+        first = false;
+
+        for( size_t j = 0; j < buffer.m_spans.size(); ++j )
+        {
+            out << ",";
+            writeSpan( out, buffer.m_id, buffer.m_spans[ j ] );
+        }
+    }
+    out << "\n]}\n";
+}
+
+void WTrace::write( const std::string& filename )
+{
+    std::ofstream out( filename.c_str() );
+    if( !out )
+    {
+        throw WException( "Could not open \"" + filename + "\" for writing the trace." );
+    }
+    write( out );
+}
+
+void WTrace::clear()
+{
+    Registry& registry = getRegistry();
+    boost::lock_guard< boost::mutex > registryLock( registry.m_mutex );
+    registry.m_finished.clear();
+    for( size_t i = 0; i < registry.m_buffers.size(); ++i )
+    {
+        boost::lock_guard< boost::mutex > lock( registry.m_buffers[ i ]->m_mutex );
+        registry.m_buffers[ i ]->m_spans.clear();
+    }
+}
+
+bool WTrace::isEnabled()
+{
+#ifdef OW_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
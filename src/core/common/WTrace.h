@@ -0,0 +1,138 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTRACE_H
+#define WTRACE_H
+
+#include <ostream>
+#include <string>
+
+/**
+ * Collects timed spans of hot paths, like module main loops, progress stages, threaded jobs and waits for conditions and locks. Each thread
+ * records into its own ring buffer, which keeps the last \ref BufferSize spans and grows as spans arrive. When a thread exits, its spans
+ * move to a shared ring buffer keeping the last \ref FinishedBufferSize spans of all exited threads and its buffer is freed. The spans can be
+ * exported as Chrome trace-event JSON, which can be viewed with chrome://tracing or Perfetto.
+ *
+ * Tracing is compiled in only if OW_TRACING is defined (CMake option OW_TRACING). Use the macros \ref WTRACE_SCOPE, \ref WTRACE_NOW and
+ * \ref WTRACE_RECORD to instrument code. They expand to nothing otherwise.
+ */
+class WTrace
+{
+public:
+    /**
+     * The number of spans kept per thread.
+     */
+    static const size_t BufferSize = 8192;
+
+    /**
+     * The number of spans kept of all exited threads together.
+     */
+    static const size_t FinishedBufferSize = 4 * BufferSize;
+
+    /**
+     * Maximum length of a span name. Longer names get truncated.
+     */
+    static const size_t MaxNameLength = 63;
+
+    /**
+     * Current time of the trace clock.
+     *
+     * \return the time in microseconds
+     */
+    static double now();
+
+    /**
+     * Records a span for the calling thread.
+     *
+     * \param category the category. Needs to be a string literal or live as long as the trace.
+     * \param name the name of the span. It is copied.
+     * \param start the start time as returned by \ref now
+     * \param duration the duration in microseconds
+     */
+    static void record( const char* category, const char* name, double start, double duration );
+
+    /**
+     * Sets the name of the calling thread as shown in the trace.
+     *
+     * \param name the name
+     */
+    static void setThreadName( const std::string& name );
+
+    /**
+     * Writes all recorded spans as Chrome trace-event JSON.
+     *
+     * \param out the stream to write to
+     */
+    static void write( std::ostream& out ); // NOLINT: yes, it is an intended non-const ref
+
+    /**
+     * Writes all recorded spans as Chrome trace-event JSON to the specified file.
+     *
+     * \param filename the file
+     *
+     * \throw WException if the file could not be written
+     */
+    static void write( const std::string& filename );
+
+    /**
+     * Removes all recorded spans.
+     */
+    static void clear();
+
+    /**
+     * Is tracing compiled in?
+     *
+     * \return true if OW_TRACING was defined while compiling the core.
+     */
+    static bool isEnabled();
+
+private:
+    /**
+     * Not constructible.
+     */
+    WTrace();
+};
+
+#ifdef OW_TRACING
+    /**
+     * Current time of the trace clock, or 0 if tracing is disabled.
+     */
+    #define WTRACE_NOW() WTrace::now()
+
+    /**
+     * Records a span which started at start (see \ref WTRACE_NOW) and ends now.
+     */
+    #define WTRACE_RECORD( category, name, start ) WTrace::record( category, name, start, WTrace::now() - ( start ) )
+
+    /**
+     * Sets the name of the calling thread in the trace.
+     */
+    #define WTRACE_THREAD_NAME( name ) WTrace::setThreadName( name )
+#else
+    #define WTRACE_NOW() 0.0
+    #define WTRACE_RECORD( category, name, start )
+    #define WTRACE_THREAD_NAME( name )
+#endif
+
+#endif  // WTRACE_H
@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTRACESCOPE_H
+#define WTRACESCOPE_H
+
+#include <string>
+
+#include "WTrace.h"
+
+/**
+ * Records a span in \ref WTrace which lasts as long as the instance lives. Use \ref WTRACE_SCOPE instead of using this directly, which allows
+ * disabling the tracing at compile time.
+ */
+class WTraceScope
+{
+public:
+    /**
+     * Starts the span.
+     *
+     * \param category the category. Needs to be a string literal.
+     * \param name the name of the span
+     */
+    WTraceScope( const char* category, const std::string& name );
+
+    /**
+     * Starts the span.
+     *
+     * \param category the category. Needs to be a string literal.
+     * \param name the name of the span
+     */
+    WTraceScope( const char* category, const char* name );
+
+    /**
+     * Ends the span and records it.
+     */
+    ~WTraceScope();
+
+private:
+    /**
+     * The category.
+     */
+    const char* m_category;
+
+    /**
+     * The name. Copied to avoid allocations.
+     */
+    char m_name[ WTrace::MaxNameLength + 1 ];
+
+    /**
+     * The start time.
+     */
+    double m_start;
+};
+
+#ifdef OW_TRACING
+    /**
+     * Records a span from here to the end of the current scope.
+     */
+    #define WTRACE_SCOPE( category, name ) WTraceScope wTraceScope( category, name )
+#else
+    #define WTRACE_SCOPE( category, name )
+#endif
+
+#endif  // WTRACESCOPE_H
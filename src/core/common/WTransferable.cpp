@@ -37,3 +37,8 @@ WTransferable::~WTransferable()
     // cleanup
 }
 
+size_t WTransferable::getMemoryUsage() const
+{
+    return 0;
+}
+
@@ -25,6 +25,8 @@
 #ifndef WTRANSFERABLE_H
 #define WTRANSFERABLE_H
 
+#include <cstddef>
+
 #include "../common/WPrototyped.h"
 
 
@@ -47,6 +49,14 @@ public:
      */
     virtual ~WTransferable();
 
+    /**
+     * The main memory held by this object. Used to account the memory per module. The default implementation returns 0, override it for
+     * objects holding large amounts of data.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const;
+
 protected:
 private:
 };
@@ -0,0 +1,115 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../WBenchmark.h"
+#include "../../WBenchmarkRunner.h"
+#include "../../WProgressCombiner.h"
+#include "../WMarchingCubesAlgorithm.h"
+
+/**
+ * Measures the extraction of an isosurface from a size^3 distance field of a sphere.
+ */
+class WMarchingCubesAlgorithmBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WMarchingCubesAlgorithmBenchmark():
+        WBenchmark( "WMarchingCubesAlgorithm::generateSurface" ),
+        m_size( 0 )
+    {
+        addSize( 64 );
+        addSize( 128 );
+        addSize( 256 );
+    }
+
+    /**
+     * Creates the distance field.
+     *
+     * \param size voxels per dimension
+     */
+    virtual void setUp( size_t size )
+    {
+        m_size = size;
+        m_values.resize( size * size * size );
+        double center = 0.5 * ( size - 1 );
+        for( size_t z = 0; z < size; ++z )
+        {
+            for( size_t y = 0; y < size; ++y )
+            {
+                for( size_t x = 0; x < size; ++x )
+                {
+                    double dx = x - center;
+                    double dy = y - center;
+                    double dz = z - center;
+                    m_values[ x + size * ( y + size * z ) ] = static_cast< float >( std::sqrt( dx * dx + dy * dy + dz * dz ) );
+                }
+            }
+        }
+    }
+
+    /**
+     * Extracts the surface at 0.4 * size.
+     *
+     * \return number of voxels
+     */
+    virtual size_t run()
+    {
+        WMatrix< double > mat( 4, 4 );
+        mat.makeIdentity();
+
+        WMarchingCubesAlgorithm mc;
+        boost::shared_ptr< WTriangleMesh > mesh = mc.generateSurface( m_size, m_size, m_size, mat, &m_values, 0.4 * m_size,
+                                                                      boost::shared_ptr< WProgressCombiner >( new WProgressCombiner() ) );
+        consume( static_cast< double >( mesh->triangleSize() ) );
+        return m_values.size();
+    }
+
+    /**
+     * Frees the field.
+     */
+    virtual void tearDown()
+    {
+        m_values.clear();
+    }
+
+private:
+    /**
+     * Voxels per dimension.
+     */
+    size_t m_size;
+
+    /**
+     * The distance field.
+     */
+    std::vector< float > m_values;
+};
+
+W_REGISTER_BENCHMARK( WMarchingCubesAlgorithmBenchmark )
@@ -0,0 +1,454 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../WException.h"
+#include "WDiffusionTensorFit.h"
+#include "WLinearAlgebraFunctions.h"
+#include "WValue.h"
+
+const std::size_t WDiffusionTensorFit::NumParameters;
+
+const double WDiffusionTensorFit::MinSignalRatio = 1.0e-6;
+
+namespace
+{
+    //! the normal matrices of the per-voxel fits
+    typedef WMatrixFixed< double, WDiffusionTensorFit::NumParameters, WDiffusionTensorFit::NumParameters > NormalMatrix;
+
+    //! number of measurements for which the logarithms are kept on the stack
+    const std::size_t StackMeasurements = 256;
+
+    /**
+     * Solves a x = b for a symmetric positive definite a by Cholesky decomposition. Only the lower triangle of a is used.
+     *
+     * \param a the matrix
+     * \param b the right hand side
+     * \param x the solution will be stored here
+     *
+     * \return false if a is not positive definite
+     */
+    bool solveCholesky( NormalMatrix const& a, WDiffusionTensorFit::ParameterVector const& b, WDiffusionTensorFit::ParameterVector* x )
+    {
+        std::size_t const n = WDiffusionTensorFit::NumParameters;
+        NormalMatrix l;
+        for( std::size_t j = 0; j < n; ++j )
+        {
+            double d = a( j, j );
+            for( std::size_t k = 0; k < j; ++k )
+            {
+                d -= l( j, k ) * l( j, k );
+            }
+            if( !( d > 0.0 ) )
+            {
+                return false;
+            }
+            l( j, j ) = std::sqrt( d );
+            for( std::size_t i = j + 1; i < n; ++i )
+            {
+                double s = a( i, j );
+                for( std::size_t k = 0; k < j; ++k )
+                {
+                    s -= l( i, k ) * l( j, k );
+                }
+                l( i, j ) = s / l( j, j );
+            }
+        }
+
+        WDiffusionTensorFit::ParameterVector& y = *x;
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            double s = b[ i ];
+            for( std::size_t k = 0; k < i; ++k )
+            {
+                s -= l( i, k ) * y[ k ];
+            }
+            y[ i ] = s / l( i, i );
+        }
+        for( std::size_t i = n; i-- > 0; )
+        {
+            double s = y[ i ];
+            for( std::size_t k = i + 1; k < n; ++k )
+            {
+                s -= l( k, i ) * y[ k ];
+            }
+            y[ i ] = s / l( i, i );
+        }
+        return true;
+    }
+
+    /**
+     * Adds w * v * v^T to the lower triangle of a.
+     *
+     * \param v the vector
+     * \param w the weight
+     * \param a the matrix
+     */
+    void addOuterProduct( WDiffusionTensorFit::ParameterVector const& v, double w, NormalMatrix* a )
+    {
+        for( std::size_t i = 0; i < WDiffusionTensorFit::NumParameters; ++i )
+        {
+            double const wv = w * v[ i ];
+            for( std::size_t j = 0; j <= i; ++j )
+            {
+                ( *a )( i, j ) += wv * v[ j ];
+            }
+        }
+    }
+
+    /**
+     * Computes the tensor components from the Cholesky factor ( l0, 0, 0; l1, l3, 0; l2, l4, l5 ).
+     *
+     * \param theta the Cholesky factor in the first six components and ln( S_0 )
+     * \param parameters the tensor components in the first six components and ln( S_0 )
+     */
+    void tensorFromCholesky( WDiffusionTensorFit::ParameterVector const& theta, WDiffusionTensorFit::ParameterVector* parameters )
+    {
+        WDiffusionTensorFit::ParameterVector& p = *parameters;
+        p[ 0 ] = theta[ 0 ] * theta[ 0 ];
+        p[ 1 ] = theta[ 0 ] * theta[ 1 ];
+        p[ 2 ] = theta[ 0 ] * theta[ 2 ];
+        p[ 3 ] = theta[ 1 ] * theta[ 1 ] + theta[ 3 ] * theta[ 3 ];
+        p[ 4 ] = theta[ 1 ] * theta[ 2 ] + theta[ 3 ] * theta[ 4 ];
+        p[ 5 ] = theta[ 2 ] * theta[ 2 ] + theta[ 4 ] * theta[ 4 ] + theta[ 5 ] * theta[ 5 ];
+        p[ 6 ] = theta[ 6 ];
+    }
+}
+
+WDiffusionTensorFit::WDiffusionTensorFit( std::vector< WVector3d > const& gradients, std::vector< double > const& bValues,
+                                          FitMethod method, std::size_t maxIterations ):
+    m_design( gradients.size() ),
+    m_pseudoInverse( gradients.size() ),
+    m_method( method ),
+    m_maxIterations( maxIterations ),
+    m_maxBValue( 0.0 )
+{
+    if( bValues.size() != 1 && bValues.size() != gradients.size() )
+    {
+        throw WException( std::string( "The number of b-values does not match the number of gradients." ) );
+    }
+
+    std::size_t const numMeasurements = gradients.size();
+    WMatrix< double > design( numMeasurements, NumParameters );
+    for( std::size_t i = 0; i < numMeasurements; ++i )
+    {
+        double const len = length( gradients[ i ] );
+        double const b = ( len > 0.0 ) ? bValues[ bValues.size() == 1 ? 0 : i ] : 0.0;
+        WVector3d const g = ( len > 0.0 ) ? WVector3d( gradients[ i ] / len ) : WVector3d();
+
+        ParameterVector& row = m_design[ i ];
+        row[ 0 ] = -b * g[ 0 ] * g[ 0 ];
+        row[ 1 ] = -2.0 * b * g[ 0 ] * g[ 1 ];
+        row[ 2 ] = -2.0 * b * g[ 0 ] * g[ 2 ];
+        row[ 3 ] = -b * g[ 1 ] * g[ 1 ];
+        row[ 4 ] = -2.0 * b * g[ 1 ] * g[ 2 ];
+        row[ 5 ] = -b * g[ 2 ] * g[ 2 ];
+        row[ 6 ] = 1.0;
+        for( std::size_t k = 0; k < NumParameters; ++k )
+        {
+            design( i, k ) = row[ k ];
+        }
+        m_maxBValue = std::max( m_maxBValue, b );
+    }
+
+    if( numMeasurements < NumParameters )
+    {
+        throw WException( std::string( "The gradient scheme needs at least seven measurements to fit a tensor." ) );
+    }
+
+    // the singular values tell whether the scheme determines all parameters
+    WMatrix< double > u( numMeasurements, numMeasurements );
+    WMatrix< double > v( NumParameters, NumParameters );
+    WValue< double > s( NumParameters );
+    computeSVD( design, u, v, s );
+    double const smax = *std::max_element( &s[ 0 ], &s[ 0 ] + NumParameters );
+    double const smin = *std::min_element( &s[ 0 ], &s[ 0 ] + NumParameters );
+    if( !( smin > 1.0e-10 * smax ) )
+    {
+        throw WException( std::string( "The gradient scheme does not determine the diffusion tensor." ) );
+    }
+
+    // pseudo-inverse V * S^-1 * U^T, only the first NumParameters columns of U contribute
+    for( std::size_t i = 0; i < numMeasurements; ++i )
+    {
+        for( std::size_t k = 0; k < NumParameters; ++k )
+        {
+            double sum = 0.0;
+            for( std::size_t j = 0; j < NumParameters; ++j )
+            {
+                sum += v( k, j ) / s[ j ] * u( i, j );
+            }
+            m_pseudoInverse[ i ][ k ] = sum;
+        }
+    }
+}
+
+WDiffusionTensorFit::~WDiffusionTensorFit()
+{
+}
+
+std::size_t WDiffusionTensorFit::getNumMeasurements() const
+{
+    return m_design.size();
+}
+
+WDiffusionTensorFit::FitMethod WDiffusionTensorFit::getMethod() const
+{
+    return m_method;
+}
+
+WMatrix< double > WDiffusionTensorFit::getDesignMatrix() const
+{
+    WMatrix< double > result( m_design.size(), NumParameters );
+    for( std::size_t i = 0; i < m_design.size(); ++i )
+    {
+        for( std::size_t k = 0; k < NumParameters; ++k )
+        {
+            result( i, k ) = m_design[ i ][ k ];
+        }
+    }
+    return result;
+}
+
+WMatrix< double > WDiffusionTensorFit::getPseudoInverse() const
+{
+    WMatrix< double > result( NumParameters, m_pseudoInverse.size() );
+    for( std::size_t i = 0; i < m_pseudoInverse.size(); ++i )
+    {
+        for( std::size_t k = 0; k < NumParameters; ++k )
+        {
+            result( k, i ) = m_pseudoInverse[ i ][ k ];
+        }
+    }
+    return result;
+}
+
+void WDiffusionTensorFit::fit( double const* signal, ParameterVector* parameters ) const
+{
+    std::size_t const numMeasurements = m_design.size();
+    double maxSignal = 0.0;
+    for( std::size_t i = 0; i < numMeasurements; ++i )
+    {
+        maxSignal = std::max( maxSignal, signal[ i ] );
+    }
+    if( !( maxSignal > 0.0 ) )
+    {
+        *parameters = ParameterVector();
+        return;
+    }
+
+    // the logarithms are needed twice by the weighted fit, keep them on the stack for all common schemes
+    double stackBuffer[ StackMeasurements ];
+    std::vector< double > heapBuffer;
+    double* logSignal = stackBuffer;
+    if( numMeasurements > StackMeasurements )
+    {
+        heapBuffer.resize( numMeasurements );
+        logSignal = &heapBuffer[ 0 ];
+    }
+    double const minSignal = MinSignalRatio * maxSignal;
+    for( std::size_t i = 0; i < numMeasurements; ++i )
+    {
+        logSignal[ i ] = std::log( std::max( signal[ i ], minSignal ) );
+    }
+
+    fitLogLinear( logSignal, parameters );
+    if( m_method == WEIGHTED_LINEAR || m_method == CONSTRAINED_NONLINEAR )
+    {
+        fitWeightedLinear( logSignal, parameters );
+    }
+    if( m_method == CONSTRAINED_NONLINEAR )
+    {
+        fitConstrainedNonlinear( signal, parameters );
+    }
+}
+
+void WDiffusionTensorFit::fit( double const* signal, double* tensor ) const
+{
+    ParameterVector parameters;
+    fit( signal, &parameters );
+    for( std::size_t k = 0; k < 6; ++k )
+    {
+        tensor[ k ] = parameters[ k ];
+    }
+}
+
+void WDiffusionTensorFit::fitLogLinear( double const* logSignal, ParameterVector* parameters ) const
+{
+    ParameterVector& x = *parameters;
+    x = ParameterVector();
+    for( std::size_t i = 0; i < m_pseudoInverse.size(); ++i )
+    {
+        ParameterVector const& p = m_pseudoInverse[ i ];
+        for( std::size_t k = 0; k < NumParameters; ++k )
+        {
+            x[ k ] += p[ k ] * logSignal[ i ];
+        }
+    }
+}
+
+void WDiffusionTensorFit::fitWeightedLinear( double const* logSignal, ParameterVector* parameters ) const
+{
+    // weights relative to the unweighted signal, the scale does not change the solution but keeps the system well scaled
+    ParameterVector const& x0 = *parameters;
+    NormalMatrix a;
+    ParameterVector b;
+    for( std::size_t i = 0; i < m_design.size(); ++i )
+    {
+        ParameterVector const& row = m_design[ i ];
+        double predicted = 0.0;
+        for( std::size_t k = 0; k < NumParameters - 1; ++k )
+        {
+            predicted += row[ k ] * x0[ k ];
+        }
+        double const w = std::exp( 2.0 * predicted );
+        addOuterProduct( row, w, &a );
+        for( std::size_t k = 0; k < NumParameters; ++k )
+        {
+            b[ k ] += w * logSignal[ i ] * row[ k ];
+        }
+    }
+
+    ParameterVector x;
+    if( solveCholesky( a, b, &x ) )
+    {
+        *parameters = x;
+    }
+}
+
+void WDiffusionTensorFit::fitConstrainedNonlinear( double const* signal, ParameterVector* parameters ) const
+{
+    ParameterVector const& p = *parameters;
+
+    // start at the Cholesky factor of the linear fit, or at an isotropic tensor if that is not positive definite
+    ParameterVector theta;
+    double const trace = p[ 0 ] + p[ 3 ] + p[ 5 ];
+    double const eps = 1.0e-6 * std::max( trace, 0.0 );
+    double const l0s = p[ 0 ];
+    double const l3s = l0s > eps ? p[ 3 ] - p[ 1 ] * p[ 1 ] / l0s : 0.0;
+    if( l0s > eps && l3s > eps )
+    {
+        theta[ 0 ] = std::sqrt( l0s );
+        theta[ 1 ] = p[ 1 ] / theta[ 0 ];
+        theta[ 2 ] = p[ 2 ] / theta[ 0 ];
+        theta[ 3 ] = std::sqrt( l3s );
+        theta[ 4 ] = ( p[ 4 ] - theta[ 1 ] * theta[ 2 ] ) / theta[ 3 ];
+        double const l5s = p[ 5 ] - theta[ 2 ] * theta[ 2 ] - theta[ 4 ] * theta[ 4 ];
+        theta[ 5 ] = std::sqrt( std::max( l5s, eps ) );
+    }
+    else
+    {
+        double const meanDiffusivity = trace > 0.0 ? trace / 3.0 : 0.1 / std::max( m_maxBValue, 1.0 );
+        theta[ 0 ] = theta[ 3 ] = theta[ 5 ] = std::sqrt( meanDiffusivity );
+    }
+    theta[ 6 ] = p[ 6 ];
+
+    // Levenberg-Marquardt on the residuals of the signal
+    std::size_t const numMeasurements = m_design.size();
+    ParameterVector tensor;
+    tensorFromCholesky( theta, &tensor );
+    double cost = 0.0;
+    for( std::size_t i = 0; i < numMeasurements; ++i )
+    {
+        double const r = signal[ i ] - std::exp( dot( m_design[ i ], tensor ) );
+        cost += r * r;
+    }
+
+    double lambda = 1.0e-3;
+    for( std::size_t iteration = 0; iteration < m_maxIterations; ++iteration )
+    {
+        NormalMatrix jtj;
+        ParameterVector jtr;
+        for( std::size_t i = 0; i < numMeasurements; ++i )
+        {
+            ParameterVector const& a = m_design[ i ];
+            double const s = std::exp( dot( a, tensor ) );
+            ParameterVector j;
+            j[ 0 ] = s * ( 2.0 * theta[ 0 ] * a[ 0 ] + theta[ 1 ] * a[ 1 ] + theta[ 2 ] * a[ 2 ] );
+            j[ 1 ] = s * ( theta[ 0 ] * a[ 1 ] + 2.0 * theta[ 1 ] * a[ 3 ] + theta[ 2 ] * a[ 4 ] );
+            j[ 2 ] = s * ( theta[ 0 ] * a[ 2 ] + theta[ 1 ] * a[ 4 ] + 2.0 * theta[ 2 ] * a[ 5 ] );
+            j[ 3 ] = s * ( 2.0 * theta[ 3 ] * a[ 3 ] + theta[ 4 ] * a[ 4 ] );
+            j[ 4 ] = s * ( theta[ 3 ] * a[ 4 ] + 2.0 * theta[ 4 ] * a[ 5 ] );
+            j[ 5 ] = s * ( 2.0 * theta[ 5 ] * a[ 5 ] );
+            j[ 6 ] = s;
+            addOuterProduct( j, 1.0, &jtj );
+            double const r = signal[ i ] - s;
+            for( std::size_t k = 0; k < NumParameters; ++k )
+            {
+                jtr[ k ] += j[ k ] * r;
+            }
+        }
+
+        // increase the damping until the step reduces the cost
+        bool improved = false;
+        double newCost = cost;
+        while( lambda < 1.0e10 )
+        {
+            NormalMatrix damped = jtj;
+            for( std::size_t k = 0; k < NumParameters; ++k )
+            {
+                damped( k, k ) += lambda * jtj( k, k ) + 1.0e-12;
+            }
+            ParameterVector step;
+            if( solveCholesky( damped, jtr, &step ) )
+            {
+                ParameterVector candidate = theta + step;
+                ParameterVector candidateTensor;
+                tensorFromCholesky( candidate, &candidateTensor );
+                newCost = 0.0;
+                for( std::size_t i = 0; i < numMeasurements; ++i )
+                {
+                    double const r = signal[ i ] - std::exp( dot( m_design[ i ], candidateTensor ) );
+                    newCost += r * r;
+                }
+                if( newCost < cost )
+                {
+                    theta = candidate;
+                    tensor = candidateTensor;
+                    improved = true;
+                    lambda = std::max( lambda * 0.1, 1.0e-12 );
+                    break;
+                }
+            }
+            lambda *= 10.0;
+        }
+
+        if( !improved )
+        {
+            break;
+        }
+        double const decrease = cost - newCost;
+        cost = newCost;
+        if( decrease <= 1.0e-12 * cost )
+        {
+            break;
+        }
+    }
+
+    *parameters = tensor;
+}
@@ -0,0 +1,196 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WDIFFUSIONTENSORFIT_H
+#define WDIFFUSIONTENSORFIT_H
+
+#include <cstddef>
+#include <vector>
+
+#include "linearAlgebra/WMatrixFixed.h"
+#include "linearAlgebra/WVectorFixed.h"
+#include "WMatrix.h"
+
+/**
+ * Fits diffusion tensors to diffusion weighted measurements using the Stejskal-Tanner equation
+ * S_i = S_0 * exp( -b_i * g_i^T * D * g_i ).
+ *
+ * Everything that only depends on the gradient scheme, i.e. the design matrix of the log-linear problem and its
+ * pseudo-inverse, is computed once in the constructor. The per-voxel fits only use fixed-size matrices on the stack,
+ * so one instance can be shared by any number of threads.
+ *
+ * Three fitting methods are available:
+ *  - LOG_LINEAR: ordinary least squares fit of the logarithm of the signal, a single matrix-vector product.
+ *  - WEIGHTED_LINEAR: weighted least squares fit of the logarithm of the signal. The weights are the squared signals
+ *    predicted by the log-linear fit, which compensates the noise amplification of the logarithm.
+ *  - CONSTRAINED_NONLINEAR: least squares fit of the signal itself, solved with Levenberg-Marquardt iterations
+ *    started at the weighted fit. The tensor is parameterized by its Cholesky factor, so the result is always
+ *    positive semi-definite.
+ *
+ * The parameters are stored as xx, xy, xz, yy, yz, zz, ln( S_0 ).
+ */
+class WDiffusionTensorFit // NOLINT
+{
+public:
+    /**
+     * The fitting methods.
+     */
+    enum FitMethod
+    {
+        LOG_LINEAR,
+        WEIGHTED_LINEAR,
+        CONSTRAINED_NONLINEAR
+    };
+
+    /**
+     * The number of parameters, the six tensor components and the logarithm of the unweighted signal.
+     */
+    static const std::size_t NumParameters = 7;
+
+    /**
+     * A parameter vector, also the type of a row of the design matrix.
+     */
+    typedef WMatrixFixed< double, NumParameters, 1 > ParameterVector;
+
+    /**
+     * Signals are clamped to this fraction of the largest signal of the voxel before taking the logarithm.
+     */
+    static const double MinSignalRatio;
+
+    /**
+     * Constructor. Gradients of zero length denote unweighted measurements. The scheme needs at least seven
+     * measurements that determine the tensor and the unweighted signal, e.g. six non-collinear gradients and one
+     * unweighted measurement.
+     *
+     * \param gradients the gradient directions, one per measurement
+     * \param bValues the b-values, either one for all gradients or one per measurement
+     * \param method the fitting method
+     * \param maxIterations the maximum number of iterations of the nonlinear fit
+     *
+     * \throws WException if the scheme does not determine the tensor
+     */
+    WDiffusionTensorFit( std::vector< WVector3d > const& gradients, std::vector< double > const& bValues,
+                         FitMethod method = LOG_LINEAR, std::size_t maxIterations = 20 );
+
+    /**
+     * Destructor.
+     */
+    ~WDiffusionTensorFit();
+
+    /**
+     * The number of measurements per voxel.
+     *
+     * \return the number of measurements
+     */
+    std::size_t getNumMeasurements() const;
+
+    /**
+     * The fitting method.
+     *
+     * \return the fitting method
+     */
+    FitMethod getMethod() const;
+
+    /**
+     * The design matrix of the log-linear problem, one row per measurement.
+     *
+     * \return the design matrix
+     */
+    WMatrix< double > getDesignMatrix() const;
+
+    /**
+     * The pseudo-inverse of the design matrix.
+     *
+     * \return the pseudo-inverse
+     */
+    WMatrix< double > getPseudoInverse() const;
+
+    /**
+     * Fits the parameters to the signal of a voxel. Voxels without any positive signal yield a zero tensor.
+     *
+     * \param signal the getNumMeasurements() measurements of the voxel
+     * \param parameters the fitted parameters will be stored here
+     */
+    void fit( double const* signal, ParameterVector* parameters ) const;
+
+    /**
+     * Fits a tensor to the signal of a voxel.
+     *
+     * \param signal the getNumMeasurements() measurements of the voxel
+     * \param tensor the six tensor components xx, xy, xz, yy, yz, zz will be stored here
+     */
+    void fit( double const* signal, double* tensor ) const;
+
+private:
+    /**
+     * Ordinary least squares fit of the logarithms.
+     *
+     * \param logSignal the logarithm of the clamped signal
+     * \param parameters the result
+     */
+    void fitLogLinear( double const* logSignal, ParameterVector* parameters ) const;
+
+    /**
+     * Weighted least squares fit of the logarithms.
+     *
+     * \param logSignal the logarithm of the clamped signal
+     * \param parameters the initial log-linear fit, will be replaced by the weighted fit
+     */
+    void fitWeightedLinear( double const* logSignal, ParameterVector* parameters ) const;
+
+    /**
+     * Nonlinear least squares fit of the signal with a positive semi-definite tensor.
+     *
+     * \param signal the signal
+     * \param parameters the initial fit, will be replaced by the nonlinear fit
+     */
+    void fitConstrainedNonlinear( double const* signal, ParameterVector* parameters ) const;
+
+    /**
+     * The rows of the design matrix.
+     */
+    std::vector< ParameterVector > m_design;
+
+    /**
+     * The columns of the pseudo-inverse of the design matrix.
+     */
+    std::vector< ParameterVector > m_pseudoInverse;
+
+    /**
+     * The fitting method.
+     */
+    FitMethod m_method;
+
+    /**
+     * The maximum number of Levenberg-Marquardt iterations.
+     */
+    std::size_t m_maxIterations;
+
+    /**
+     * The largest b-value of the scheme.
+     */
+    double m_maxBValue;
+};
+
+#endif  // WDIFFUSIONTENSORFIT_H
@@ -0,0 +1,276 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "WEigenSystemBatch.h"
+
+namespace
+{
+    /**
+     * Tensors whose cross products are smaller than this, relative to the squared Frobenius norm of the tensor,
+     * have (nearly) coinciding eigenvalues and are passed to the fallback.
+     */
+    const double degeneracyTolerance = 1e-8;
+
+    /**
+     * The eigenvectors of the closed form must be orthogonal up to this tolerance.
+     */
+    const double orthogonalityTolerance = 1e-6;
+}
+
+const std::size_t WEigenSystemBatch::BlockSize;
+
+WEigenSystemBatch::WEigenSystemBatch( std::size_t size ):
+    m_size( 0 ),
+    m_numFallbacks( 0 )
+{
+    resize( size );
+}
+
+WEigenSystemBatch::~WEigenSystemBatch()
+{
+}
+
+std::size_t WEigenSystemBatch::size() const
+{
+    return m_size;
+}
+
+void WEigenSystemBatch::resize( std::size_t size )
+{
+    m_size = size;
+    std::size_t padded = ( size + BlockSize - 1 ) / BlockSize * BlockSize;
+    for( std::size_t c = 0; c < 6; ++c )
+    {
+        m_tensors[ c ].assign( padded, 0.0 );
+    }
+    for( std::size_t k = 0; k < 3; ++k )
+    {
+        m_eigenvalues[ k ].assign( padded, 0.0 );
+    }
+    for( std::size_t c = 0; c < 9; ++c )
+    {
+        m_eigenvectors[ c ].assign( padded, 0.0 );
+    }
+    m_numFallbacks = 0;
+}
+
+void WEigenSystemBatch::setTensor( std::size_t i, double xx, double xy, double xz, double yy, double yz, double zz )
+{
+    WAssert( i < m_size, "Index out of bounds." );
+    m_tensors[ 0 ][ i ] = xx;
+    m_tensors[ 1 ][ i ] = xy;
+    m_tensors[ 2 ][ i ] = xz;
+    m_tensors[ 3 ][ i ] = yy;
+    m_tensors[ 4 ][ i ] = yz;
+    m_tensors[ 5 ][ i ] = zz;
+}
+
+void WEigenSystemBatch::setTensor( std::size_t i, WTensorSym< 2, 3, double > const& tensor )
+{
+    setTensor( i, tensor( 0, 0 ), tensor( 0, 1 ), tensor( 0, 2 ), tensor( 1, 1 ), tensor( 1, 2 ), tensor( 2, 2 ) );
+}
+
+void WEigenSystemBatch::compute()
+{
+    m_numFallbacks = 0;
+    for( std::size_t first = 0; first < m_size; first += BlockSize )
+    {
+        computeBlock( first );
+    }
+}
+
+void WEigenSystemBatch::computeBlock( std::size_t first )
+{
+    double const* xx = &m_tensors[ 0 ][ first ];
+    double const* xy = &m_tensors[ 1 ][ first ];
+    double const* xz = &m_tensors[ 2 ][ first ];
+    double const* yy = &m_tensors[ 3 ][ first ];
+    double const* yz = &m_tensors[ 4 ][ first ];
+    double const* zz = &m_tensors[ 5 ][ first ];
+
+    double* ev[ 3 ];
+    for( std::size_t k = 0; k < 3; ++k )
+    {
+        ev[ k ] = &m_eigenvalues[ k ][ first ];
+    }
+    double* v[ 9 ];
+    for( std::size_t c = 0; c < 9; ++c )
+    {
+        v[ c ] = &m_eigenvectors[ c ][ first ];
+    }
+
+    double norm2[ BlockSize ];
+    int valid[ BlockSize ];
+
+    // eigenvalues
+    for( std::size_t l = 0; l < BlockSize; ++l )
+    {
+        calcEigenvaluesCardano( xx[ l ], xy[ l ], xz[ l ], yy[ l ], yz[ l ], zz[ l ], &ev[ 2 ][ l ], &ev[ 1 ][ l ], &ev[ 0 ][ l ] );
+        norm2[ l ] = xx[ l ] * xx[ l ] + yy[ l ] * yy[ l ] + zz[ l ] * zz[ l ]
+                   + 2.0 * ( xy[ l ] * xy[ l ] + xz[ l ] * xz[ l ] + yz[ l ] * yz[ l ] );
+        valid[ l ] = 1;
+    }
+
+    // eigenvectors of the smallest and the largest eigenvalue: for a simple eigenvalue, ( T - lambda * I ) has rank two
+    // and the cross product of any two linearly independent rows spans its null space. The largest of the three cross
+    // products is the most accurate one.
+    for( std::size_t k = 0; k < 3; k += 2 )
+    {
+        for( std::size_t l = 0; l < BlockSize; ++l )
+        {
+            double const lambda = ev[ k ][ l ];
+            double const r0x = xx[ l ] - lambda, r0y = xy[ l ], r0z = xz[ l ];
+            double const r1x = xy[ l ], r1y = yy[ l ] - lambda, r1z = yz[ l ];
+            double const r2x = xz[ l ], r2y = yz[ l ], r2z = zz[ l ] - lambda;
+
+            double cx = r0y * r1z - r0z * r1y;
+            double cy = r0z * r1x - r0x * r1z;
+            double cz = r0x * r1y - r0y * r1x;
+            double n = cx * cx + cy * cy + cz * cz;
+
+            double const dx = r0y * r2z - r0z * r2y;
+            double const dy = r0z * r2x - r0x * r2z;
+            double const dz = r0x * r2y - r0y * r2x;
+            double const m = dx * dx + dy * dy + dz * dz;
+            bool const takeD = m > n;
+            cx = takeD ? dx : cx;
+            cy = takeD ? dy : cy;
+            cz = takeD ? dz : cz;
+            n = takeD ? m : n;
+
+            double const ex = r1y * r2z - r1z * r2y;
+            double const ey = r1z * r2x - r1x * r2z;
+            double const ez = r1x * r2y - r1y * r2x;
+            double const o = ex * ex + ey * ey + ez * ez;
+            bool const takeE = o > n;
+            cx = takeE ? ex : cx;
+            cy = takeE ? ey : cy;
+            cz = takeE ? ez : cz;
+            n = takeE ? o : n;
+
+            valid[ l ] &= ( n > degeneracyTolerance * norm2[ l ] * norm2[ l ] );
+            double const inv = n > 0.0 ? 1.0 / std::sqrt( n ) : 0.0;
+            v[ 3 * k ][ l ] = cx * inv;
+            v[ 3 * k + 1 ][ l ] = cy * inv;
+            v[ 3 * k + 2 ][ l ] = cz * inv;
+        }
+    }
+
+    // the middle eigenvector completes the right-handed orthonormal basis
+    for( std::size_t l = 0; l < BlockSize; ++l )
+    {
+        double const ax = v[ 0 ][ l ], ay = v[ 1 ][ l ], az = v[ 2 ][ l ];
+        double const bx = v[ 6 ][ l ], by = v[ 7 ][ l ], bz = v[ 8 ][ l ];
+        v[ 3 ][ l ] = by * az - bz * ay;
+        v[ 4 ][ l ] = bz * ax - bx * az;
+        v[ 5 ][ l ] = bx * ay - by * ax;
+        valid[ l ] &= ( std::fabs( ax * bx + ay * by + az * bz ) < orthogonalityTolerance );
+
+        // a zero tensor has the coordinate axes as eigenvectors
+        bool const zero = norm2[ l ] == 0.0;
+        valid[ l ] |= zero;
+        for( std::size_t c = 0; c < 9; ++c )
+        {
+            v[ c ][ l ] = zero ? ( c % 4 == 0 ? 1.0 : 0.0 ) : v[ c ][ l ];
+        }
+    }
+
+    std::size_t const end = first + BlockSize < m_size ? first + BlockSize : m_size;
+    for( std::size_t i = first; i < end; ++i )
+    {
+        if( !valid[ i - first ] )
+        {
+            computeFallback( i );
+            ++m_numFallbacks;
+        }
+    }
+}
+
+void WEigenSystemBatch::computeFallback( std::size_t i )
+{
+    WTensorSym< 2, 3, double > t;
+    t( 0, 0 ) = m_tensors[ 0 ][ i ];
+    t( 0, 1 ) = m_tensors[ 1 ][ i ];
+    t( 0, 2 ) = m_tensors[ 2 ][ i ];
+    t( 1, 1 ) = m_tensors[ 3 ][ i ];
+    t( 1, 2 ) = m_tensors[ 4 ][ i ];
+    t( 2, 2 ) = m_tensors[ 5 ][ i ];
+
+    RealEigenSystem es;
+    jacobiEigenvector3D( t, &es );
+    sortRealEigenSystem( &es );
+    for( std::size_t k = 0; k < 3; ++k )
+    {
+        m_eigenvalues[ k ][ i ] = es[ k ].first;
+        for( std::size_t j = 0; j < 3; ++j )
+        {
+            m_eigenvectors[ 3 * k + j ][ i ] = es[ k ].second[ j ];
+        }
+    }
+}
+
+double WEigenSystemBatch::getEigenvalue( std::size_t i, std::size_t k ) const
+{
+    WAssert( i < m_size && k < 3, "Index out of bounds." );
+    return m_eigenvalues[ k ][ i ];
+}
+
+WVector3d WEigenSystemBatch::getEigenvector( std::size_t i, std::size_t k ) const
+{
+    WAssert( i < m_size && k < 3, "Index out of bounds." );
+    return WVector3d( m_eigenvectors[ 3 * k ][ i ], m_eigenvectors[ 3 * k + 1 ][ i ], m_eigenvectors[ 3 * k + 2 ][ i ] );
+}
+
+void WEigenSystemBatch::getEigenSystem( std::size_t i, RealEigenSystem* es ) const
+{
+    for( std::size_t k = 0; k < 3; ++k )
+    {
+        ( *es )[ k ].first = getEigenvalue( i, k );
+        ( *es )[ k ].second = getEigenvector( i, k );
+    }
+}
+
+double WEigenSystemBatch::getFA( std::size_t i ) const
+{
+    WAssert( i < m_size, "Index out of bounds." );
+    double const l0 = m_eigenvalues[ 0 ][ i ];
+    double const l1 = m_eigenvalues[ 1 ][ i ];
+    double const l2 = m_eigenvalues[ 2 ][ i ];
+    double const d = l0 * l0 + l1 * l1 + l2 * l2;
+    if( d == 0.0 )
+    {
+        return 0.0;
+    }
+    double const mean = ( l0 + l1 + l2 ) / 3.0;
+    return std::sqrt( 1.5 * ( ( l0 - mean ) * ( l0 - mean ) + ( l1 - mean ) * ( l1 - mean ) + ( l2 - mean ) * ( l2 - mean ) ) / d );
+}
+
+std::size_t WEigenSystemBatch::getNumFallbacks() const
+{
+    return m_numFallbacks;
+}
@@ -0,0 +1,222 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WEIGENSYSTEMBATCH_H
+#define WEIGENSYSTEMBATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "linearAlgebra/WVectorFixed.h"
+#include "WTensorFunctions.h"
+#include "WTensorSym.h"
+
+/**
+ * Computes the eigen systems of many symmetric 3x3 tensors at once, as needed for whole DTI tensor fields.
+ *
+ * The tensors and the results are stored as structure of arrays, i.e. one array per tensor component, eigenvalue and
+ * eigenvector component. The tensors are processed in blocks of BlockSize. Within a block, the eigenvalues are
+ * calculated analytically with Cardano's formula (see calcEigenvaluesCardano()) and the eigenvectors of the largest
+ * and the smallest eigenvalue as cross products of the rows of ( T - lambda * I ). The middle eigenvector completes
+ * the orthonormal basis. These loops run over contiguous arrays without data dependent branches, so the compiler
+ * can keep a whole block in vector registers.
+ *
+ * The closed form gets inaccurate if eigenvalues (nearly) coincide. Such tensors are detected by the magnitude of
+ * the cross products and recomputed with jacobiEigenvector3D(). Tensors that are exactly zero, like the background of
+ * most datasets, are handled directly and yield zero eigenvalues and the coordinate axes as eigenvectors.
+ *
+ * The eigenvalues of each tensor are sorted ascending, like done by sortRealEigenSystem().
+ */
+class WEigenSystemBatch // NOLINT
+{
+public:
+    /**
+     * Number of tensors processed together.
+     */
+    static const std::size_t BlockSize = 8;
+
+    /**
+     * Constructor.
+     *
+     * \param size the number of tensors
+     */
+    explicit WEigenSystemBatch( std::size_t size = 0 );
+
+    /**
+     * Destructor.
+     */
+    ~WEigenSystemBatch();
+
+    /**
+     * The number of tensors.
+     *
+     * \return the number of tensors
+     */
+    std::size_t size() const;
+
+    /**
+     * Changes the number of tensors. The tensors are set to zero.
+     *
+     * \param size the new number of tensors
+     */
+    void resize( std::size_t size );
+
+    /**
+     * Sets a tensor.
+     *
+     * \param i the index of the tensor
+     * \param xx component (0,0)
+     * \param xy component (0,1)
+     * \param xz component (0,2)
+     * \param yy component (1,1)
+     * \param yz component (1,2)
+     * \param zz component (2,2)
+     */
+    void setTensor( std::size_t i, double xx, double xy, double xz, double yy, double yz, double zz );
+
+    /**
+     * Sets a tensor.
+     *
+     * \param i the index of the tensor
+     * \param tensor the tensor
+     */
+    void setTensor( std::size_t i, WTensorSym< 2, 3, double > const& tensor );
+
+    /**
+     * Sets consecutive tensors from interleaved data with six components per tensor in the order xx, xy, xz, yy, yz, zz,
+     * like stored by WDataSetDTI.
+     *
+     * \tparam T the component type
+     * \param first index of the first tensor to set
+     * \param data the interleaved components
+     * \param count the number of tensors
+     */
+    template< typename T >
+    void setTensors( std::size_t first, T const* data, std::size_t count );
+
+    /**
+     * Computes the eigen systems of all tensors.
+     */
+    void compute();
+
+    /**
+     * Returns an eigenvalue. Only valid after compute().
+     *
+     * \param i the index of the tensor
+     * \param k which eigenvalue, 0 is the smallest
+     *
+     * \return the eigenvalue
+     */
+    double getEigenvalue( std::size_t i, std::size_t k ) const;
+
+    /**
+     * Returns a normalized eigenvector. Only valid after compute().
+     *
+     * \param i the index of the tensor
+     * \param k which eigenvector, 0 belongs to the smallest eigenvalue
+     *
+     * \return the eigenvector
+     */
+    WVector3d getEigenvector( std::size_t i, std::size_t k ) const;
+
+    /**
+     * Returns the complete eigen system of a tensor. Only valid after compute().
+     *
+     * \param i the index of the tensor
+     * \param es the eigen system, sorted ascending
+     */
+    void getEigenSystem( std::size_t i, RealEigenSystem* es ) const;
+
+    /**
+     * Calculates the fractional anisotropy from the eigenvalues. Only valid after compute().
+     *
+     * \param i the index of the tensor
+     *
+     * \return the FA, 0 for a zero tensor
+     */
+    double getFA( std::size_t i ) const;
+
+    /**
+     * The number of tensors the last compute() had to pass to the iterative fallback.
+     *
+     * \return the number of fallbacks
+     */
+    std::size_t getNumFallbacks() const;
+
+private:
+    /**
+     * Computes the eigen systems of one block and collects the tensors that need the fallback.
+     *
+     * \param first index of the first tensor of the block, a multiple of BlockSize
+     */
+    void computeBlock( std::size_t first );
+
+    /**
+     * Computes the eigen system of a single tensor with jacobiEigenvector3D().
+     *
+     * \param i the index of the tensor
+     */
+    void computeFallback( std::size_t i );
+
+    /**
+     * The number of tensors.
+     */
+    std::size_t m_size;
+
+    /**
+     * The tensor components xx, xy, xz, yy, yz, zz, each padded to a multiple of BlockSize.
+     */
+    std::vector< double > m_tensors[ 6 ];
+
+    /**
+     * The eigenvalues, ascending.
+     */
+    std::vector< double > m_eigenvalues[ 3 ];
+
+    /**
+     * The eigenvectors, component j of eigenvector k is stored in m_eigenvectors[ 3 * k + j ].
+     */
+    std::vector< double > m_eigenvectors[ 9 ];
+
+    /**
+     * The number of fallbacks of the last compute().
+     */
+    std::size_t m_numFallbacks;
+};
+
+template< typename T >
+void WEigenSystemBatch::setTensors( std::size_t first, T const* data, std::size_t count )
+{
+    WAssert( first + count <= m_size, "Too many tensors." );
+    for( std::size_t c = 0; c < 6; ++c )
+    {
+        double* target = &m_tensors[ c ][ first ];
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            target[ i ] = static_cast< double >( data[ 6 * i + c ] );
+        }
+    }
+}
+
+#endif  // WEIGENSYSTEMBATCH_H
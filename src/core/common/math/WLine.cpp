@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <complex>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -77,48 +78,14 @@ double pathLength( const WLine& line )
 
 void WLine::resampleByNumberOfPoints( size_t numPoints )
 {
-    WLine newLine;
-    newLine.reserve( numPoints );
-    if( size() != numPoints && size() > 1 && numPoints > 0 )
-    {
-        const double pathL = pathLength( *this );
-        double newSegmentLength = pathL / ( numPoints - 1 );
-        const double delta = newSegmentLength * 1.0e-10; // 1.0e-10 which represents the precision is choosen by intuition
-        double remainingLength = 0.0;
-        newLine.push_back( front() );
-        for( size_t i = 0; i < ( size() - 1 ); ++i )
-        {
-            remainingLength += length( at( i ) - at( i + 1 ) );
-            while( ( remainingLength > newSegmentLength ) || std::abs( remainingLength - newSegmentLength ) < delta )
-            {
-                remainingLength -= newSegmentLength;
-                // TODO(math): fix numerical issuses: newSegmentLength may be wrong => great offset by many intraSegment sample points
-                //                                    remainingLength may be wrong => ...
-                //                                    Take a look at the unit test testNumericalStabilityOfResampling
-                WPosition newPoint = at( i + 1 ) + remainingLength * normalize( at( i ) - at( i + 1 ) );
-                newLine.push_back( newPoint );
-                // std::cout << "line size so far" << newLine.size() << " lenght so far: " << newLine.pathLength() << std::endl;
-                // std::cout << numPoints - newLine.size() << std::endl;
-            }
-        }
-        // using string_utils::operator<<;
-        // std::cout << "this: " << *this << std::endl << "new:  " << newLine << std::endl;
-        // std::cout << "|remL - newSegL|: " << std::abs( remainingLength - newSegmentLength ) << std::endl;
-        // std::cout << std::setprecision( 35 ) << "remainingLength: " << remainingLength << " newSegmentLength: " << newSegmentLength << std::endl;
-        // std::cout << "this size: " << size() << " new size: " << newLine.size() << std::endl;
-    }
-    else if( size() == 1 && size() < numPoints )
-    {
-        for( size_t i = 0; i < numPoints; ++i )
-        {
-            newLine.push_back( front() );
-        }
-    }
+    // Note if the size() == 0, then the resampled tract is also of length 0
     if( size() != numPoints )
     {
+        WLine newLine;
+        newLine.reserve( numPoints );
+        resampleLineByNumberOfPoints( begin(), end(), numPoints, std::back_inserter( newLine ) );
         this->WMixinVector< WPosition >::operator=( newLine );
     }
-    // Note if the size() == 0, then the resampled tract is also of length 0
 }
 
 void WLine::removeAdjacentDuplicates()
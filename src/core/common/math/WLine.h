@@ -25,6 +25,8 @@
 #ifndef WLINE_H
 #define WLINE_H
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "../WBoundingBox.h"
@@ -165,9 +167,67 @@ double maxSegmentLength( const WLine& line );
  */
 bool hasMorePointsThen( const WLine& first, const WLine& second );
 
+/**
+ * Resamples the polyline given by a range of points to the given number of points, with equal distances along its path.
+ * This is the algorithm of WLine::resampleByNumberOfPoints(), for points that are not stored in a WLine. Due to
+ * rounding, the last point may be missing.
+ *
+ * \tparam RandomAccessIterator iterator over the WPositions of the line
+ * \tparam OutputIterator output iterator for WPositions
+ * \param begin the first point
+ * \param end behind the last point
+ * \param numPoints the number of points after resampling
+ * \param out the new points are written here
+ *
+ * \return the output iterator behind the last written point
+ */
+template< typename RandomAccessIterator, typename OutputIterator >
+OutputIterator resampleLineByNumberOfPoints( RandomAccessIterator begin, RandomAccessIterator end, size_t numPoints, OutputIterator out );
+
 inline bool hasMorePointsThen( const WLine& first, const WLine& second )
 {
     return first.size() > second.size();
 }
 
+template< typename RandomAccessIterator, typename OutputIterator >
+OutputIterator resampleLineByNumberOfPoints( RandomAccessIterator begin, RandomAccessIterator end, size_t numPoints, OutputIterator out )
+{
+    size_t const size = end - begin;
+    if( size == numPoints )
+    {
+        return std::copy( begin, end, out );
+    }
+    if( size == 1 )
+    {
+        return std::fill_n( out, numPoints, *begin );
+    }
+    if( size == 0 || numPoints == 0 )
+    {
+        return out;
+    }
+
+    double pathL = 0.0;
+    for( size_t i = 1; i < size; ++i )
+    {
+        pathL += length( begin[ i - 1 ] - begin[ i ] );
+    }
+    double newSegmentLength = pathL / ( numPoints - 1 );
+    const double delta = newSegmentLength * 1.0e-10; // 1.0e-10 which represents the precision is choosen by intuition
+    double remainingLength = 0.0;
+    *out++ = *begin;
+    for( size_t i = 0; i < ( size - 1 ); ++i )
+    {
+        remainingLength += length( begin[ i ] - begin[ i + 1 ] );
+        while( ( remainingLength > newSegmentLength ) || std::abs( remainingLength - newSegmentLength ) < delta )
+        {
+            remainingLength -= newSegmentLength;
+            // TODO(math): fix numerical issuses: newSegmentLength may be wrong => great offset by many intraSegment sample points
+            //                                    remainingLength may be wrong => ...
+            //                                    Take a look at the unit test testNumericalStabilityOfResampling
+            *out++ = begin[ i + 1 ] + remainingLength * normalize( begin[ i ] - begin[ i + 1 ] );
+        }
+    }
+    return out;
+}
+
 #endif  // WLINE_H
@@ -26,6 +26,7 @@
 #define WMATRIX_H
 
 #include <iostream>
+#include <utility>
 
 #include <osg/Matrix>
 
@@ -66,6 +67,12 @@ public:
      */
     WMatrix( const WMatrix& newMatrix );
 
+    /**
+     * Produces a matrix by taking over the components of the one given as parameter.
+     * \param newMatrix The matrix to be moved, it is empty and has no columns afterwards.
+     */
+    WMatrix( WMatrix&& newMatrix );
+
     /**
      * Copies the specified 4x4 matrix.
      *
@@ -175,6 +182,13 @@ public:
      */
     WMatrix& operator=( const WMatrix& rhs );
 
+    /**
+     * Takes over the components of the argument WMatrix.
+     * \param rhs The right hand side of the assignment, it is empty and has no columns afterwards.
+     * \return A reference to the left hand side of the assignment (i.e. the current object).
+     */
+    WMatrix& operator=( WMatrix&& rhs );
+
     /**
      * Multiplication of the current matrix with andother matrix.
      * \param rhs The right hand side of the multiplication
@@ -261,6 +275,14 @@ template< typename T > WMatrix< T >::WMatrix( const WMatrix& newMatrix )
     m_nbCols = newMatrix.m_nbCols;
 }
 
+template< typename T > WMatrix< T >::WMatrix( WMatrix&& newMatrix )
+    : WValue< T >( 0 )
+{
+    m_nbCols = newMatrix.m_nbCols;
+    WValue< T >::operator=( std::move( newMatrix ) );
+    newMatrix.m_nbCols = 0;
+}
+
 template< typename T > WMatrix< T >::WMatrix( const WMatrix4d& newMatrix )
     : WValue< T >( 4 * 4 )
 {
@@ -374,7 +396,7 @@ template< typename T > WMatrix< T >& WMatrix< T >::makeIdentity()
  */
 template< typename T > size_t WMatrix< T >::getNbRows() const
 {
-    return this->size() / m_nbCols;
+    return m_nbCols == 0 ? 0 : this->size() / m_nbCols;
 }
 
 /**
@@ -438,6 +460,17 @@ template< typename T > WMatrix< T >& WMatrix< T >::operator=( const WMatrix& rhs
     return *this;
 }
 
+template< typename T > WMatrix< T >& WMatrix< T >::operator=( WMatrix&& rhs )
+{
+    if( this != &rhs )
+    {
+        m_nbCols = rhs.m_nbCols;
+        WValue< T >::operator=( std::move( rhs ) );
+        rhs.m_nbCols = 0;
+    }
+    return *this;
+}
+
 /**
  * Returns the transposed matrix.
  */
@@ -0,0 +1,429 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSPHERICALHARMONICSBASIS_H
+#define WSPHERICALHARMONICSBASIS_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../WAssert.h"
+#include "WMath.h"
+#include "WMatrix.h"
+#include "WUnitSphereCoordinates.h"
+#include "WValue.h"
+
+/**
+ * Evaluates the real, symmetric spherical harmonics basis used by WSymmetricSphericalHarmonic (index scheme as
+ * in the Descoteaux paper "Regularized, Fast, and Robust Analytical Q-Ball Imaging").
+ *
+ * Instead of calling boost::math::spherical_harmonic_r/_i for every single coefficient, the normalized associated
+ * Legendre functions of all degrees are computed with the standard three-term recurrences. The recurrence
+ * coefficients, including the normalization, are precomputed once per basis up to the maximum order. The sines and
+ * cosines of m * phi are obtained by successive rotations. This turns the evaluation of a complete basis into
+ * O( order^2 ) multiplications without any further calls to transcendental functions besides a single sin/cos of
+ * theta and phi each. The results equal those of boost::math up to rounding.
+ *
+ * For a fixed set of directions, calcBaseMatrix() builds the basis matrix once. Evaluating an SH on these directions
+ * then is a dense matrix-vector product, see evaluate( const WMatrix< T >&, const WValue< T >&, std::vector< T >* ).
+ *
+ * An instance is immutable after construction and thus may be shared between threads.
+ */
+template< typename T > class WSphericalHarmonicsBasis // NOLINT
+{
+public:
+    /**
+     * Maximum order of the basis returned by getDefault().
+     */
+    static const std::size_t DefaultMaxOrder = 32;
+
+    /**
+     * Constructor. Precomputes the recurrence tables.
+     *
+     * \param maxOrder the maximum order this basis can evaluate.
+     */
+    explicit WSphericalHarmonicsBasis( std::size_t maxOrder );
+
+    /**
+     * Returns a shared basis able to evaluate orders up to DefaultMaxOrder.
+     *
+     * \return the basis
+     */
+    static const WSphericalHarmonicsBasis< T >& getDefault();
+
+    /**
+     * Returns the maximum order this basis can evaluate.
+     *
+     * \return the maximum order
+     */
+    std::size_t getMaxOrder() const;
+
+    /**
+     * Calculates the number of coefficients of a symmetric SH of the given order.
+     *
+     * \param order the order, must be even
+     *
+     * \return ( order + 1 ) * ( order + 2 ) / 2
+     */
+    static std::size_t getNumCoefficients( std::size_t order );
+
+    /**
+     * Evaluates all basis functions up to the given order in one direction.
+     *
+     * \param order the order, must be even and not larger than getMaxOrder()
+     * \param theta angle for the position on the unit sphere
+     * \param phi angle for the position on the unit sphere
+     * \param values getNumCoefficients( order ) values are written here
+     */
+    void evaluateBasis( std::size_t order, T theta, T phi, T* values ) const;
+
+    /**
+     * Evaluates an SH in one direction without storing the basis values.
+     *
+     * \param coefficients the SH coefficients, at least getNumCoefficients( order ) of them
+     * \param order the order of the SH, must be even and not larger than getMaxOrder()
+     * \param theta angle for the position on the unit sphere
+     * \param phi angle for the position on the unit sphere
+     *
+     * \return the value on the sphere
+     */
+    T evaluate( const WValue< T >& coefficients, std::size_t order, T theta, T phi ) const;
+
+    /**
+     * Evaluates an SH in a set of directions.
+     *
+     * \param coefficients the SH coefficients, at least getNumCoefficients( order ) of them
+     * \param order the order of the SH, must be even and not larger than getMaxOrder()
+     * \param directions the directions
+     * \param values the values, resized to the number of directions
+     */
+    void evaluate( const WValue< T >& coefficients, std::size_t order,
+                   const std::vector< WUnitSphereCoordinates< T > >& directions, std::vector< T >* values ) const;
+
+    /**
+     * Calculates the basis matrix, one row per direction and one column per coefficient.
+     *
+     * \param directions the directions
+     * \param order the order, must be even and not larger than getMaxOrder()
+     *
+     * \return the basis matrix
+     */
+    WMatrix< T > calcBaseMatrix( const std::vector< WUnitSphereCoordinates< T > >& directions, std::size_t order ) const;
+
+    /**
+     * Evaluates an SH on the directions of a precomputed basis matrix, see calcBaseMatrix(). This is a plain
+     * matrix-vector product.
+     *
+     * \param baseMatrix the basis matrix
+     * \param coefficients the SH coefficients, one per column of the basis matrix
+     * \param values the values, resized to the number of rows of the basis matrix
+     */
+    static void evaluate( const WMatrix< T >& baseMatrix, const WValue< T >& coefficients, std::vector< T >* values );
+
+private:
+    /**
+     * Index of the recurrence table entries for degree l and m <= l.
+     *
+     * \param l the degree
+     * \param m the absolute value of the phase factor
+     *
+     * \return the index
+     */
+    static std::size_t tableIndex( std::size_t l, std::size_t m );
+
+    /**
+     * Runs the recurrences and passes every basis function of even degree up to the given order to the visitor.
+     * The visitor is called as visitor( index, value ) with the coefficient index of the Descoteaux scheme.
+     *
+     * \param order the order
+     * \param theta angle for the position on the unit sphere
+     * \param phi angle for the position on the unit sphere
+     * \param visitor the visitor
+     */
+    template< typename Visitor >
+    void visit( std::size_t order, T theta, T phi, Visitor& visitor ) const; // NOLINT: yes, it is an intended non-const ref
+
+    /**
+     * Stores the basis values in an array.
+     */
+    struct StoreVisitor
+    {
+        /**
+         * Stores a value.
+         *
+         * \param index the coefficient index
+         * \param value the basis value
+         */
+        void operator()( std::size_t index, T value )
+        {
+            m_values[ index ] = value;
+        }
+
+        /**
+         * The target array.
+         */
+        T* m_values;
+    };
+
+    /**
+     * Sums up the basis values weighted with the coefficients.
+     */
+    struct SumVisitor
+    {
+        /**
+         * Adds a weighted value.
+         *
+         * \param index the coefficient index
+         * \param value the basis value
+         */
+        void operator()( std::size_t index, T value )
+        {
+            m_sum += ( *m_coefficients )[ index ] * value;
+        }
+
+        /**
+         * The coefficients.
+         */
+        const WValue< T >* m_coefficients;
+
+        /**
+         * The weighted sum.
+         */
+        T m_sum;
+    };
+
+    /**
+     * The maximum order.
+     */
+    std::size_t m_maxOrder;
+
+    /**
+     * Factors of the recurrence P(l,m) = a(l,m) * ( x * P(l-1,m) - b(l,m) * P(l-2,m) ), indexed by tableIndex().
+     */
+    std::vector< T > m_a;
+
+    /**
+     * See m_a.
+     */
+    std::vector< T > m_b;
+
+    /**
+     * Factors of the diagonal recurrence P(m,m) = d(m) * sin( theta ) * P(m-1,m-1), including the Condon-Shortley phase.
+     */
+    std::vector< T > m_diagonal;
+};
+
+template< typename T >
+WSphericalHarmonicsBasis< T >::WSphericalHarmonicsBasis( std::size_t maxOrder ):
+    m_maxOrder( maxOrder ),
+    m_a( tableIndex( maxOrder + 1, 0 ) ),
+    m_b( tableIndex( maxOrder + 1, 0 ) ),
+    m_diagonal( maxOrder + 1 )
+{
+    // the functions are normalized to be orthonormal on the sphere, i.e. they already contain the factor
+    // sqrt( ( 2l + 1 ) / ( 4 pi ) * ( l - m )! / ( l + m )! )
+    m_diagonal[ 0 ] = 1.0 / std::sqrt( 4.0 * pi() );
+    for( std::size_t m = 1; m <= maxOrder; ++m )
+    {
+        m_diagonal[ m ] = -std::sqrt( static_cast< T >( 2 * m + 1 ) / static_cast< T >( 2 * m ) );
+    }
+    for( std::size_t l = 2; l <= maxOrder; ++l )
+    {
+        for( std::size_t m = 0; m + 2 <= l; ++m )
+        {
+            T const l2 = static_cast< T >( l * l );
+            T const lm2 = static_cast< T >( ( l - 1 ) * ( l - 1 ) );
+            T const m2 = static_cast< T >( m * m );
+            m_a[ tableIndex( l, m ) ] = std::sqrt( ( 4.0 * l2 - 1.0 ) / ( l2 - m2 ) );
+            m_b[ tableIndex( l, m ) ] = std::sqrt( ( lm2 - m2 ) / ( 4.0 * lm2 - 1.0 ) );
+        }
+    }
+}
+
+template< typename T >
+const WSphericalHarmonicsBasis< T >& WSphericalHarmonicsBasis< T >::getDefault()
+{
+    static const WSphericalHarmonicsBasis< T > basis( DefaultMaxOrder );
+    return basis;
+}
+
+template< typename T >
+std::size_t WSphericalHarmonicsBasis< T >::getMaxOrder() const
+{
+    return m_maxOrder;
+}
+
+template< typename T >
+std::size_t WSphericalHarmonicsBasis< T >::getNumCoefficients( std::size_t order )
+{
+    return ( order + 1 ) * ( order + 2 ) / 2;
+}
+
+template< typename T >
+std::size_t WSphericalHarmonicsBasis< T >::tableIndex( std::size_t l, std::size_t m )
+{
+    return l * ( l + 1 ) / 2 + m;
+}
+
+template< typename T >
+template< typename Visitor >
+void WSphericalHarmonicsBasis< T >::visit( std::size_t order, T theta, T phi, Visitor& visitor ) const // NOLINT: yes, it is an intended non-const ref
+{
+    WAssert( order <= m_maxOrder, "The order exceeds the maximum order of this basis." );
+    WAssert( order % 2 == 0, "Only symmetric spherical harmonics of even order are supported." );
+
+    const T rootOf2 = std::sqrt( 2.0 );
+    const T x = std::cos( theta );
+    // using the signed sine matches boost's phase handling for theta outside [0, pi]
+    const T s = std::sin( theta );
+    const T cosPhi = std::cos( phi );
+    const T sinPhi = std::sin( phi );
+
+    T pmm = m_diagonal[ 0 ];
+    T cosMPhi = 1.0;
+    T sinMPhi = 0.0;
+    for( std::size_t m = 0; m <= order; ++m )
+    {
+        if( m > 0 )
+        {
+            pmm *= m_diagonal[ m ] * s;
+            T const c = cosMPhi * cosPhi - sinMPhi * sinPhi;
+            sinMPhi = sinMPhi * cosPhi + cosMPhi * sinPhi;
+            cosMPhi = c;
+        }
+        // the Descoteaux basis uses sqrt( 2 ) * ( -1 )^( m + 1 ) * Im( Y(l,m) ) for positive and
+        // sqrt( 2 ) * Re( Y(l,|m|) ) for negative phase factors
+        T const sinFactor = ( m % 2 == 1 ? rootOf2 : -rootOf2 ) * sinMPhi;
+        T const cosFactor = rootOf2 * cosMPhi;
+
+        T p2 = 0.0;
+        T p1 = pmm;
+        for( std::size_t l = m; l <= order; ++l )
+        {
+            T p;
+            if( l == m )
+            {
+                p = pmm;
+            }
+            else if( l == m + 1 )
+            {
+                p = std::sqrt( static_cast< T >( 2 * m + 3 ) ) * x * pmm;
+            }
+            else
+            {
+                std::size_t const idx = tableIndex( l, m );
+                p = m_a[ idx ] * ( x * p1 - m_b[ idx ] * p2 );
+            }
+            if( l > m )
+            {
+                p2 = p1;
+                p1 = p;
+            }
+
+            if( l % 2 == 0 )
+            {
+                std::size_t const center = tableIndex( l, 0 );
+                if( m == 0 )
+                {
+                    visitor( center, p );
+                }
+                else
+                {
+                    visitor( center + m, sinFactor * p );
+                    visitor( center - m, cosFactor * p );
+                }
+            }
+        }
+    }
+}
+
+template< typename T >
+void WSphericalHarmonicsBasis< T >::evaluateBasis( std::size_t order, T theta, T phi, T* values ) const
+{
+    StoreVisitor visitor;
+    visitor.m_values = values;
+    visit( order, theta, phi, visitor );
+}
+
+template< typename T >
+T WSphericalHarmonicsBasis< T >::evaluate( const WValue< T >& coefficients, std::size_t order, T theta, T phi ) const
+{
+    WAssert( coefficients.size() >= getNumCoefficients( order ), "Too few coefficients for the given order." );
+    SumVisitor visitor;
+    visitor.m_coefficients = &coefficients;
+    visitor.m_sum = 0.0;
+    visit( order, theta, phi, visitor );
+    return visitor.m_sum;
+}
+
+template< typename T >
+void WSphericalHarmonicsBasis< T >::evaluate( const WValue< T >& coefficients, std::size_t order,
+                                              const std::vector< WUnitSphereCoordinates< T > >& directions,
+                                              std::vector< T >* values ) const
+{
+    values->resize( directions.size() );
+    for( std::size_t i = 0; i < directions.size(); ++i )
+    {
+        ( *values )[ i ] = evaluate( coefficients, order, directions[ i ].getTheta(), directions[ i ].getPhi() );
+    }
+}
+
+template< typename T >
+WMatrix< T > WSphericalHarmonicsBasis< T >::calcBaseMatrix( const std::vector< WUnitSphereCoordinates< T > >& directions,
+                                                            std::size_t order ) const
+{
+    std::size_t const numCoefficients = getNumCoefficients( order );
+    WMatrix< T > base( directions.size(), numCoefficients );
+    std::vector< T > row( numCoefficients );
+    for( std::size_t i = 0; i < directions.size(); ++i )
+    {
+        evaluateBasis( order, directions[ i ].getTheta(), directions[ i ].getPhi(), &row[ 0 ] );
+        for( std::size_t j = 0; j < numCoefficients; ++j )
+        {
+            base( i, j ) = row[ j ];
+        }
+    }
+    return base;
+}
+
+template< typename T >
+void WSphericalHarmonicsBasis< T >::evaluate( const WMatrix< T >& baseMatrix, const WValue< T >& coefficients, std::vector< T >* values )
+{
+    WAssert( baseMatrix.getNbCols() == coefficients.size(), "The number of coefficients does not match the basis matrix." );
+    std::size_t const rows = baseMatrix.getNbRows();
+    std::size_t const cols = baseMatrix.getNbCols();
+    values->resize( rows );
+    for( std::size_t i = 0; i < rows; ++i )
+    {
+        T sum = 0.0;
+        for( std::size_t j = 0; j < cols; ++j )
+        {
+            sum += baseMatrix( i, j ) * coefficients[ j ];
+        }
+        ( *values )[ i ] = sum;
+    }
+}
+
+#endif  // WSPHERICALHARMONICSBASIS_H
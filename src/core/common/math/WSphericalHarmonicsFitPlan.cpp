@@ -0,0 +1,403 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../exceptions/WPreconditionNotMet.h"
+#include "WLinearAlgebraFunctions.h"
+#include "WMath.h"
+#include "WSphericalHarmonicsBasis.h"
+#include "WSphericalHarmonicsFitPlan.h"
+#include "WSymmetricSphericalHarmonic.h"
+#include "WUnitSphereCoordinates.h"
+
+// The static members need definitions, as they are used by reference.
+const std::size_t WSphericalHarmonicsFitPlan::BlockSize;
+const std::size_t WSphericalHarmonicsFitPlan::MaxCachedPlans;
+const std::size_t WSphericalHarmonicsFitPlan::MaxCachedGradientTables;
+
+namespace
+{
+    /**
+     * The measurements per block of the matrix products. Together with the coefficients this determines the part of
+     * the fitting matrix that has to stay in the cache.
+     */
+    const std::size_t MeasurementBlockSize = 64;
+
+    /**
+     * The basis matrix of a gradient table for the highest order requested so far.
+     */
+    struct GradientTable
+    {
+        /**
+         * Constructor.
+         */
+        GradientTable()
+            : m_hash( 0 ),
+              m_order( 0 ),
+              m_basis( 0, 0 ),
+              m_gram( 0, 0 )
+        {
+        }
+
+        std::vector< WVector3d > m_gradients;   //!< the gradients
+        std::size_t m_hash;                     //!< hash of the gradients
+        int m_order;                            //!< the order of the basis matrix
+        WMatrix< double > m_basis;              //!< the basis matrix
+        WMatrix< double > m_gram;               //!< basis^T * basis
+    };
+
+    /**
+     * A cached plan and its parameters.
+     */
+    struct CachedPlan
+    {
+        std::size_t m_hash;                                             //!< hash of the gradients
+        std::vector< WVector3d > m_gradients;                           //!< the gradients
+        int m_order;                                                    //!< the order
+        double m_lambda;                                                //!< the regularization factor
+        WSphericalHarmonicsFitPlan::FitType m_type;                     //!< the kind of fit
+        boost::shared_ptr< WSphericalHarmonicsFitPlan const > m_plan;   //!< the plan
+    };
+
+    /**
+     * The cache of get(). The most recently used entries are at the front of the lists.
+     */
+    struct PlanCache
+    {
+        boost::mutex m_mutex;                                       //!< protects the lists
+        std::list< boost::shared_ptr< GradientTable > > m_tables;   //!< the gradient tables
+        std::list< CachedPlan > m_plans;                            //!< the plans
+    };
+
+    /**
+     * Returns the process-wide cache.
+     *
+     * \return the cache
+     */
+    PlanCache& getCache()
+    {
+        static PlanCache cache;
+        return cache;
+    }
+
+    /**
+     * Hashes a gradient table.
+     *
+     * \param gradients the gradients
+     *
+     * \return the hash
+     */
+    std::size_t hashGradients( std::vector< WVector3d > const& gradients )
+    {
+        std::size_t seed = gradients.size();
+        for( std::size_t i = 0; i < gradients.size(); ++i )
+        {
+            for( std::size_t k = 0; k < 3; ++k )
+            {
+                boost::hash_combine( seed, gradients[ i ][ k ] );
+            }
+        }
+        return seed;
+    }
+
+    /**
+     * Computes the basis matrix of a gradient table.
+     *
+     * \param gradients the gradients
+     * \param order the order
+     *
+     * \return the basis matrix
+     */
+    WMatrix< double > calcBasis( std::vector< WVector3d > const& gradients, int order )
+    {
+        std::vector< WUnitSphereCoordinates< double > > directions;
+        directions.reserve( gradients.size() );
+        for( std::size_t i = 0; i < gradients.size(); ++i )
+        {
+            directions.push_back( WUnitSphereCoordinates< double >( gradients[ i ] ) );
+        }
+        return WSymmetricSphericalHarmonic< double >::calcBaseMatrix( directions, order );
+    }
+
+    /**
+     * Checks the order and the gradients.
+     *
+     * \param gradients the gradients
+     * \param order the order
+     */
+    void checkParameters( std::vector< WVector3d > const& gradients, int order )
+    {
+        if( order < 0 || order % 2 != 0 )
+        {
+            throw WPreconditionNotMet( std::string( "The order of a symmetric spherical harmonic must be even and non-negative." ) );
+        }
+        if( gradients.empty() )
+        {
+            throw WPreconditionNotMet( std::string( "Cannot fit spherical harmonics without gradients." ) );
+        }
+    }
+}
+
+WSphericalHarmonicsFitPlan::WSphericalHarmonicsFitPlan( std::vector< WVector3d > const& gradients, int order, double lambda, FitType type )
+    : m_order( order ),
+      m_numCoefficients( 0 ),
+      m_numMeasurements( gradients.size() ),
+      m_fittingMatrix( 0, 0 ),
+      m_baseMatrix( 0, 0 )
+{
+    checkParameters( gradients, order );
+    WMatrix< double > basis( calcBasis( gradients, order ) );
+    WMatrix< double > gram( basis.transposed() * basis );
+    build( basis, gram, lambda, type );
+}
+
+WSphericalHarmonicsFitPlan::WSphericalHarmonicsFitPlan( WMatrix< double > const& basis, WMatrix< double > const& gram, int order, double lambda,
+                                                        FitType type )
+    : m_order( order ),
+      m_numCoefficients( 0 ),
+      m_numMeasurements( basis.getNbRows() ),
+      m_fittingMatrix( 0, 0 ),
+      m_baseMatrix( 0, 0 )
+{
+    build( basis, gram, lambda, type );
+}
+
+void WSphericalHarmonicsFitPlan::build( WMatrix< double > const& basis, WMatrix< double > const& gram, double lambda, FitType type )
+{
+    std::size_t const R = WSphericalHarmonicsBasis< double >::getNumCoefficients( m_order );
+    std::size_t const N = m_numMeasurements;
+    m_numCoefficients = R;
+
+    // the coefficients of lower orders are the leading columns of the basis
+    m_baseMatrix = WMatrix< double >( N, R );
+    for( std::size_t i = 0; i < N; ++i )
+    {
+        for( std::size_t j = 0; j < R; ++j )
+        {
+            m_baseMatrix( i, j ) = basis( i, j );
+        }
+    }
+    WMatrix< double > normal( R, R );
+    for( std::size_t i = 0; i < R; ++i )
+    {
+        for( std::size_t j = 0; j < R; ++j )
+        {
+            normal( i, j ) = gram( i, j );
+        }
+    }
+    if( lambda != 0.0 )
+    {
+        normal += lambda * WSymmetricSphericalHarmonic< double >::calcSmoothingMatrix( m_order );
+    }
+
+    WMatrix< double > result( pseudoInverse( normal ) * m_baseMatrix.transposed() );
+    if( type == FUNK_RADON )
+    {
+        result = WSymmetricSphericalHarmonic< double >::calcFRTMatrix( m_order ) * result;
+    }
+    else if( type == CONSTANT_SOLID_ANGLE )
+    {
+        result = WSymmetricSphericalHarmonic< double >::calcMatrixWithEigenvalues( m_order ) * result;
+        result = WSymmetricSphericalHarmonic< double >::calcFRTMatrix( m_order ) * result;
+        result *= 1.0 / ( 16.0 * std::pow( pi(), 2 ) );
+    }
+    m_fittingMatrix = result;
+
+    m_transposedFit.resize( N * R );
+    m_basisRows.resize( N * R );
+    for( std::size_t i = 0; i < N; ++i )
+    {
+        for( std::size_t j = 0; j < R; ++j )
+        {
+            m_transposedFit[ i * R + j ] = m_fittingMatrix( j, i );
+            m_basisRows[ i * R + j ] = m_baseMatrix( i, j );
+        }
+    }
+}
+
+boost::shared_ptr< WSphericalHarmonicsFitPlan const > WSphericalHarmonicsFitPlan::get( std::vector< WVector3d > const& gradients, int order,
+                                                                                        double lambda, FitType type )
+{
+    checkParameters( gradients, order );
+    std::size_t const hash = hashGradients( gradients );
+
+    PlanCache& cache = getCache();
+    boost::lock_guard< boost::mutex > lock( cache.m_mutex );
+
+    for( std::list< CachedPlan >::iterator it = cache.m_plans.begin(); it != cache.m_plans.end(); ++it )
+    {
+        if( it->m_hash == hash && it->m_order == order && it->m_lambda == lambda && it->m_type == type && it->m_gradients == gradients )
+        {
+            cache.m_plans.splice( cache.m_plans.begin(), cache.m_plans, it );
+            return cache.m_plans.front().m_plan;
+        }
+    }
+
+    // find the basis of the gradient table, recompute it if a higher order is needed
+    boost::shared_ptr< GradientTable > table;
+    for( std::list< boost::shared_ptr< GradientTable > >::iterator it = cache.m_tables.begin(); it != cache.m_tables.end(); ++it )
+    {
+        if( ( *it )->m_hash == hash && ( *it )->m_gradients == gradients )
+        {
+            table = *it;
+            cache.m_tables.erase( it );
+            break;
+        }
+    }
+    if( !table || table->m_order < order )
+    {
+        table.reset( new GradientTable );
+        table->m_gradients = gradients;
+        table->m_hash = hash;
+        table->m_order = order;
+        table->m_basis = calcBasis( gradients, order );
+        table->m_gram = table->m_basis.transposed() * table->m_basis;
+    }
+    cache.m_tables.push_front( table );
+    if( cache.m_tables.size() > MaxCachedGradientTables )
+    {
+        cache.m_tables.pop_back();
+    }
+
+    CachedPlan entry;
+    entry.m_hash = hash;
+    entry.m_gradients = gradients;
+    entry.m_order = order;
+    entry.m_lambda = lambda;
+    entry.m_type = type;
+    entry.m_plan.reset( new WSphericalHarmonicsFitPlan( table->m_basis, table->m_gram, order, lambda, type ) );
+    cache.m_plans.push_front( entry );
+    if( cache.m_plans.size() > MaxCachedPlans )
+    {
+        cache.m_plans.pop_back();
+    }
+    return entry.m_plan;
+}
+
+void WSphericalHarmonicsFitPlan::clearCache()
+{
+    PlanCache& cache = getCache();
+    boost::lock_guard< boost::mutex > lock( cache.m_mutex );
+    cache.m_plans.clear();
+    cache.m_tables.clear();
+}
+
+std::size_t WSphericalHarmonicsFitPlan::getNumCachedPlans()
+{
+    PlanCache& cache = getCache();
+    boost::lock_guard< boost::mutex > lock( cache.m_mutex );
+    return cache.m_plans.size();
+}
+
+int WSphericalHarmonicsFitPlan::getOrder() const
+{
+    return m_order;
+}
+
+std::size_t WSphericalHarmonicsFitPlan::getNumCoefficients() const
+{
+    return m_numCoefficients;
+}
+
+std::size_t WSphericalHarmonicsFitPlan::getNumMeasurements() const
+{
+    return m_numMeasurements;
+}
+
+WMatrix< double > const& WSphericalHarmonicsFitPlan::getFittingMatrix() const
+{
+    return m_fittingMatrix;
+}
+
+WMatrix< double > const& WSphericalHarmonicsFitPlan::getBaseMatrix() const
+{
+    return m_baseMatrix;
+}
+
+void WSphericalHarmonicsFitPlan::fit( double const* measurements, std::size_t numVoxels, double* coefficients ) const
+{
+    std::size_t const R = m_numCoefficients;
+    std::size_t const N = m_numMeasurements;
+    std::fill( coefficients, coefficients + numVoxels * R, 0.0 );
+
+    // coefficients = measurements * fit^T, one block of voxels and measurements at a time, so the used rows of the
+    // transposed fitting matrix stay in the cache for the whole block of voxels
+    for( std::size_t voxelBegin = 0; voxelBegin < numVoxels; voxelBegin += BlockSize )
+    {
+        std::size_t const voxelEnd = std::min( voxelBegin + BlockSize, numVoxels );
+        for( std::size_t measurementBegin = 0; measurementBegin < N; measurementBegin += MeasurementBlockSize )
+        {
+            std::size_t const measurementEnd = std::min( measurementBegin + MeasurementBlockSize, N );
+            for( std::size_t v = voxelBegin; v < voxelEnd; ++v )
+            {
+                double const* x = measurements + v * N;
+                double* c = coefficients + v * R;
+                for( std::size_t i = measurementBegin; i < measurementEnd; ++i )
+                {
+                    double const xi = x[ i ];
+                    double const* row = &m_transposedFit[ i * R ];
+                    for( std::size_t j = 0; j < R; ++j )
+                    {
+                        c[ j ] += xi * row[ j ];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void WSphericalHarmonicsFitPlan::reproject( double const* coefficients, std::size_t numVoxels, double* measurements ) const
+{
+    std::size_t const R = m_numCoefficients;
+    std::size_t const N = m_numMeasurements;
+
+    for( std::size_t measurementBegin = 0; measurementBegin < N; measurementBegin += MeasurementBlockSize )
+    {
+        std::size_t const measurementEnd = std::min( measurementBegin + MeasurementBlockSize, N );
+        for( std::size_t v = 0; v < numVoxels; ++v )
+        {
+            double const* c = coefficients + v * R;
+            double* x = measurements + v * N;
+            for( std::size_t i = measurementBegin; i < measurementEnd; ++i )
+            {
+                double const* row = &m_basisRows[ i * R ];
+                double sum = 0.0;
+                for( std::size_t j = 0; j < R; ++j )
+                {
+                    sum += row[ j ] * c[ j ];
+                }
+                x[ i ] = sum;
+            }
+        }
+    }
+}
@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSPHERICALHARMONICSFITPLAN_H
+#define WSPHERICALHARMONICSFITPLAN_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "linearAlgebra/WVectorFixed.h"
+#include "WMatrix.h"
+
+/**
+ * Everything needed to fit symmetric spherical harmonics to measurements on a fixed set of gradient directions, see
+ * WSymmetricSphericalHarmonic::getSHFittingMatrix() and getSHFittingMatrixForConstantSolidAngle().
+ *
+ * Plans are usually obtained from get(), which caches them by gradient table, order, regularization factor and fit
+ * type. The basis matrix B and B^T * B of a gradient table are cached separately at the highest order requested so
+ * far. Since the coefficients of lower orders form the leading columns of B, a plan for another order or another
+ * regularization factor only needs the inversion of a small ( R x R ) matrix, with R the number of coefficients.
+ *
+ * fit() then computes the coefficients of many voxels at once as a blocked matrix product, which keeps the fitting
+ * matrix in the cache instead of streaming it once per voxel.
+ *
+ * A plan is immutable after construction and may be shared between threads.
+ */
+class WSphericalHarmonicsFitPlan // NOLINT
+{
+public:
+    /**
+     * The kinds of fits.
+     */
+    enum FitType
+    {
+        DEFAULT,                //!< Regularized least squares fit, see getSHFittingMatrix() without FRT.
+        FUNK_RADON,             //!< As DEFAULT, followed by the Funk-Radon-transformation.
+        CONSTANT_SOLID_ANGLE    //!< Constant solid angle reconstruction, see getSHFittingMatrixForConstantSolidAngle().
+    };
+
+    /**
+     * The number of voxels fitted together by fit() and reproject().
+     */
+    static const std::size_t BlockSize = 32;
+
+    /**
+     * The maximum number of plans kept by get().
+     */
+    static const std::size_t MaxCachedPlans = 16;
+
+    /**
+     * The maximum number of gradient tables whose basis matrices are kept by get().
+     */
+    static const std::size_t MaxCachedGradientTables = 4;
+
+    /**
+     * Constructor. Builds a plan without using the cache.
+     *
+     * \param gradients the gradient directions of the measurements to fit
+     * \param order the order of the SH, must be even
+     * \param lambda the regularization factor
+     * \param type the kind of fit
+     */
+    WSphericalHarmonicsFitPlan( std::vector< WVector3d > const& gradients, int order, double lambda, FitType type );
+
+    /**
+     * Returns a plan for the given parameters. The plan is taken from the cache if possible. This function is
+     * thread-safe.
+     *
+     * \param gradients the gradient directions of the measurements to fit
+     * \param order the order of the SH, must be even
+     * \param lambda the regularization factor
+     * \param type the kind of fit
+     *
+     * \return the plan
+     */
+    static boost::shared_ptr< WSphericalHarmonicsFitPlan const > get( std::vector< WVector3d > const& gradients, int order,
+                                                                      double lambda, FitType type );
+
+    /**
+     * Removes all plans and gradient tables from the cache.
+     */
+    static void clearCache();
+
+    /**
+     * Returns the number of plans currently in the cache.
+     *
+     * \return the number of cached plans
+     */
+    static std::size_t getNumCachedPlans();
+
+    /**
+     * Returns the order of the SH.
+     *
+     * \return the order
+     */
+    int getOrder() const;
+
+    /**
+     * Returns the number of SH coefficients per voxel.
+     *
+     * \return the number of coefficients
+     */
+    std::size_t getNumCoefficients() const;
+
+    /**
+     * Returns the number of measurements per voxel.
+     *
+     * \return the number of measurements
+     */
+    std::size_t getNumMeasurements() const;
+
+    /**
+     * Returns the fitting matrix, one row per coefficient and one column per measurement.
+     *
+     * \return the fitting matrix
+     */
+    WMatrix< double > const& getFittingMatrix() const;
+
+    /**
+     * Returns the basis matrix, one row per measurement and one column per coefficient.
+     *
+     * \return the basis matrix
+     */
+    WMatrix< double > const& getBaseMatrix() const;
+
+    /**
+     * Fits the SH coefficients of many voxels.
+     *
+     * \param measurements getNumMeasurements() values per voxel, stored voxel after voxel
+     * \param numVoxels the number of voxels
+     * \param coefficients getNumCoefficients() values per voxel are written here, voxel after voxel
+     */
+    void fit( double const* measurements, std::size_t numVoxels, double* coefficients ) const;
+
+    /**
+     * Evaluates the SH of many voxels in the gradient directions, which yields the fitted measurements.
+     *
+     * \param coefficients getNumCoefficients() values per voxel, stored voxel after voxel
+     * \param numVoxels the number of voxels
+     * \param measurements getNumMeasurements() values per voxel are written here, voxel after voxel
+     */
+    void reproject( double const* coefficients, std::size_t numVoxels, double* measurements ) const;
+
+private:
+    /**
+     * Constructor. Builds a plan from a basis matrix that may have been computed for a higher order.
+     *
+     * \param basis the basis matrix with at least getNumCoefficients() columns
+     * \param gram the matrix basis^T * basis
+     * \param order the order of the SH, must be even
+     * \param lambda the regularization factor
+     * \param type the kind of fit
+     */
+    WSphericalHarmonicsFitPlan( WMatrix< double > const& basis, WMatrix< double > const& gram, int order, double lambda, FitType type );
+
+    /**
+     * Computes the fitting matrix. Called by the constructors.
+     *
+     * \param basis the basis matrix with at least getNumCoefficients() columns
+     * \param gram the matrix basis^T * basis
+     * \param lambda the regularization factor
+     * \param type the kind of fit
+     */
+    void build( WMatrix< double > const& basis, WMatrix< double > const& gram, double lambda, FitType type );
+
+    /**
+     * The order of the SH.
+     */
+    int m_order;
+
+    /**
+     * The number of coefficients.
+     */
+    std::size_t m_numCoefficients;
+
+    /**
+     * The number of measurements.
+     */
+    std::size_t m_numMeasurements;
+
+    /**
+     * The fitting matrix.
+     */
+    WMatrix< double > m_fittingMatrix;
+
+    /**
+     * The basis matrix.
+     */
+    WMatrix< double > m_baseMatrix;
+
+    /**
+     * The transposed fitting matrix, stored row by row, so fit() runs over contiguous memory.
+     */
+    std::vector< double > m_transposedFit;
+
+    /**
+     * The basis matrix, stored row by row.
+     */
+    std::vector< double > m_basisRows;
+};
+
+#endif  // WSPHERICALHARMONICSFITPLAN_H
@@ -0,0 +1,312 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../exceptions/WPreconditionNotMet.h"
+#include "WGeometryFunctions.h"
+#include "WSphericalHarmonicsPeakFinder.h"
+#include "WUnitSphereCoordinates.h"
+
+// The static members need definitions, as they are used by reference.
+const std::size_t WSphericalHarmonicsPeakFinder::ValuesPerPeak;
+const std::size_t WSphericalHarmonicsPeakFinder::BlockSize;
+
+namespace
+{
+    /**
+     * The number of parabolic refinement steps per peak. The step width is halved after every step.
+     */
+    const std::size_t RefinementSteps = 6;
+}
+
+bool WSphericalHarmonicsPeakFinder::Peak::operator<( Peak const& other ) const
+{
+    return m_value > other.m_value;
+}
+
+WSphericalHarmonicsPeakFinder::WSphericalHarmonicsPeakFinder( std::size_t order, std::size_t maxPeaks, double relativeThreshold,
+                                                              double minSeparationAngle, unsigned int tesselationLevel )
+    : m_order( order ),
+      m_numCoefficients( WSphericalHarmonicsBasis< double >::getNumCoefficients( order ) ),
+      m_maxPeaks( maxPeaks ),
+      m_relativeThreshold( relativeThreshold ),
+      m_minSeparationCosine( std::cos( minSeparationAngle ) ),
+      m_initialStep( 0.0 ),
+      m_basis( order )
+{
+    if( order % 2 != 0 )
+    {
+        throw WPreconditionNotMet( std::string( "The order of a symmetric spherical harmonic must be even." ) );
+    }
+    if( maxPeaks == 0 )
+    {
+        throw WPreconditionNotMet( std::string( "At least one peak per voxel is needed." ) );
+    }
+
+    std::vector< WVector3d > vertices;
+    std::vector< unsigned int > triangles;
+    tesselateIcosahedron( &vertices, &triangles, tesselationLevel );
+
+    // the tessellation is symmetric, keep the first vertex of every antipodal pair
+    std::vector< std::size_t > representative( vertices.size(), vertices.size() );
+    for( std::size_t i = 0; i < vertices.size(); ++i )
+    {
+        if( representative[ i ] != vertices.size() )
+        {
+            continue;
+        }
+        std::size_t antipode = i;
+        double best = 2.0;
+        for( std::size_t j = i + 1; j < vertices.size(); ++j )
+        {
+            double const distance = length( vertices[ i ] + vertices[ j ] );
+            if( distance < best )
+            {
+                best = distance;
+                antipode = j;
+            }
+        }
+        representative[ i ] = m_directions.size();
+        representative[ antipode ] = m_directions.size();
+        m_directions.push_back( vertices[ i ] );
+    }
+
+    // neighbors of a direction are the neighbors of both vertices of the antipodal pair
+    std::vector< std::vector< std::size_t > > neighbors( m_directions.size() );
+    double edgeAngles = 0.0;
+    for( std::size_t t = 0; t < triangles.size(); t += 3 )
+    {
+        for( std::size_t k = 0; k < 3; ++k )
+        {
+            std::size_t const a = triangles[ t + k ];
+            std::size_t const b = triangles[ t + ( k + 1 ) % 3 ];
+            neighbors[ representative[ a ] ].push_back( representative[ b ] );
+            neighbors[ representative[ b ] ].push_back( representative[ a ] );
+            edgeAngles += std::acos( std::min( 1.0, dot( vertices[ a ], vertices[ b ] ) ) );
+        }
+    }
+    m_initialStep = 0.5 * edgeAngles / static_cast< double >( triangles.size() );
+
+    m_neighborOffsets.push_back( 0 );
+    for( std::size_t i = 0; i < neighbors.size(); ++i )
+    {
+        std::sort( neighbors[ i ].begin(), neighbors[ i ].end() );
+        neighbors[ i ].erase( std::unique( neighbors[ i ].begin(), neighbors[ i ].end() ), neighbors[ i ].end() );
+        m_neighbors.insert( m_neighbors.end(), neighbors[ i ].begin(), neighbors[ i ].end() );
+        m_neighborOffsets.push_back( m_neighbors.size() );
+    }
+
+    m_basisRows.resize( m_directions.size() * m_numCoefficients );
+    for( std::size_t i = 0; i < m_directions.size(); ++i )
+    {
+        WUnitSphereCoordinates< double > coords( m_directions[ i ] );
+        m_basis.evaluateBasis( m_order, coords.getTheta(), coords.getPhi(), &m_basisRows[ i * m_numCoefficients ] );
+    }
+}
+
+std::size_t WSphericalHarmonicsPeakFinder::getOrder() const
+{
+    return m_order;
+}
+
+std::size_t WSphericalHarmonicsPeakFinder::getNumCoefficients() const
+{
+    return m_numCoefficients;
+}
+
+std::size_t WSphericalHarmonicsPeakFinder::getMaxPeaks() const
+{
+    return m_maxPeaks;
+}
+
+std::vector< WVector3d > const& WSphericalHarmonicsPeakFinder::getDirections() const
+{
+    return m_directions;
+}
+
+void WSphericalHarmonicsPeakFinder::evaluate( double const* coefficients, std::size_t numVoxels, double* values ) const
+{
+    std::size_t const R = m_numCoefficients;
+    std::size_t const D = m_directions.size();
+
+    // one direction after the other, so every basis row is used for all voxels while it is in the cache
+    for( std::size_t i = 0; i < D; ++i )
+    {
+        double const* row = &m_basisRows[ i * R ];
+        for( std::size_t v = 0; v < numVoxels; ++v )
+        {
+            double const* c = coefficients + v * R;
+            double sum = 0.0;
+            for( std::size_t j = 0; j < R; ++j )
+            {
+                sum += row[ j ] * c[ j ];
+            }
+            values[ v * D + i ] = sum;
+        }
+    }
+}
+
+void WSphericalHarmonicsPeakFinder::findPeaks( double const* coefficients, std::size_t numVoxels, float* peaks ) const
+{
+    std::size_t const R = m_numCoefficients;
+    std::size_t const D = m_directions.size();
+    std::size_t const peakValues = m_maxPeaks * ValuesPerPeak;
+
+    std::vector< double > values( BlockSize * D );
+    std::vector< double > basis( R );
+    std::vector< Peak > candidates;
+    std::vector< Peak > accepted;
+
+    for( std::size_t blockBegin = 0; blockBegin < numVoxels; blockBegin += BlockSize )
+    {
+        std::size_t const blockVoxels = std::min( BlockSize, numVoxels - blockBegin );
+        evaluate( coefficients + blockBegin * R, blockVoxels, &values[ 0 ] );
+
+        for( std::size_t v = 0; v < blockVoxels; ++v )
+        {
+            double const* c = coefficients + ( blockBegin + v ) * R;
+            double const* f = &values[ v * D ];
+
+            // seeds are the directions larger than all their neighbors, ties go to the lower index
+            candidates.clear();
+            for( std::size_t i = 0; i < D; ++i )
+            {
+                if( f[ i ] <= 0.0 )
+                {
+                    continue;
+                }
+                bool isMaximum = true;
+                for( std::size_t n = m_neighborOffsets[ i ]; n < m_neighborOffsets[ i + 1 ] && isMaximum; ++n )
+                {
+                    std::size_t const j = m_neighbors[ n ];
+                    isMaximum = f[ j ] < f[ i ] || ( f[ j ] == f[ i ] && i < j );
+                }
+                if( isMaximum )
+                {
+                    candidates.push_back( refine( c, m_directions[ i ], &basis[ 0 ] ) );
+                }
+            }
+            std::sort( candidates.begin(), candidates.end() );
+
+            accepted.clear();
+            for( std::size_t k = 0; k < candidates.size() && accepted.size() < m_maxPeaks; ++k )
+            {
+                if( candidates[ k ].m_value < m_relativeThreshold * candidates[ 0 ].m_value )
+                {
+                    break;
+                }
+                bool separated = true;
+                for( std::size_t a = 0; a < accepted.size() && separated; ++a )
+                {
+                    separated = std::fabs( dot( candidates[ k ].m_direction, accepted[ a ].m_direction ) ) <= m_minSeparationCosine;
+                }
+                if( separated )
+                {
+                    accepted.push_back( candidates[ k ] );
+                }
+            }
+
+            float* out = peaks + ( blockBegin + v ) * peakValues;
+            std::fill( out, out + peakValues, 0.0f );
+            for( std::size_t a = 0; a < accepted.size(); ++a )
+            {
+                for( std::size_t k = 0; k < 3; ++k )
+                {
+                    out[ a * ValuesPerPeak + k ] = static_cast< float >( accepted[ a ].m_direction[ k ] );
+                }
+                out[ a * ValuesPerPeak + 3 ] = static_cast< float >( accepted[ a ].m_value );
+            }
+        }
+    }
+}
+
+double WSphericalHarmonicsPeakFinder::evaluate( double const* coefficients, WVector3d const& direction, double* basis ) const
+{
+    WUnitSphereCoordinates< double > coords( direction );
+    m_basis.evaluateBasis( m_order, coords.getTheta(), coords.getPhi(), basis );
+    double sum = 0.0;
+    for( std::size_t j = 0; j < m_numCoefficients; ++j )
+    {
+        sum += basis[ j ] * coefficients[ j ];
+    }
+    return sum;
+}
+
+WSphericalHarmonicsPeakFinder::Peak WSphericalHarmonicsPeakFinder::refine( double const* coefficients, WVector3d const& seed,
+                                                                           double* basis ) const
+{
+    Peak peak;
+    peak.m_direction = seed;
+    peak.m_value = evaluate( coefficients, seed, basis );
+
+    double step = m_initialStep;
+    for( std::size_t s = 0; s < RefinementSteps; ++s )
+    {
+        // an orthonormal basis of the tangent plane
+        WVector3d const& d = peak.m_direction;
+        WVector3d axis( 1.0, 0.0, 0.0 );
+        if( std::fabs( d[ 0 ] ) > 0.5 )
+        {
+            axis = WVector3d( 0.0, 1.0, 0.0 );
+        }
+        WVector3d const e1 = normalize( cross( d, axis ) );
+        WVector3d const e2 = cross( d, e1 );
+
+        // fit a parabola along both tangent directions and move to the vertex, but not farther than one step
+        double const cosStep = std::cos( step );
+        double const sinStep = std::sin( step );
+        WVector3d offset( 0.0, 0.0, 0.0 );
+        WVector3d const tangents[ 2 ] = { e1, e2 }; // NOLINT
+        for( std::size_t k = 0; k < 2; ++k )
+        {
+            double const plus = evaluate( coefficients, cosStep * d + sinStep * tangents[ k ], basis );
+            double const minus = evaluate( coefficients, cosStep * d - sinStep * tangents[ k ], basis );
+            double const curvature = plus + minus - 2.0 * peak.m_value;
+            double t = 0.0;
+            if( curvature < 0.0 )
+            {
+                t = std::max( -1.0, std::min( 1.0, 0.5 * ( minus - plus ) / curvature ) );
+            }
+            else if( plus > peak.m_value || minus > peak.m_value )
+            {
+                t = plus > minus ? 1.0 : -1.0;
+            }
+            offset += ( t * std::tan( step ) ) * tangents[ k ];
+        }
+
+        WVector3d const candidate = normalize( d + offset );
+        double const value = evaluate( coefficients, candidate, basis );
+        if( value > peak.m_value )
+        {
+            peak.m_direction = candidate;
+            peak.m_value = value;
+        }
+        step *= 0.5;
+    }
+    return peak;
+}
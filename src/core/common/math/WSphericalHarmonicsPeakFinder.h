@@ -0,0 +1,217 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSPHERICALHARMONICSPEAKFINDER_H
+#define WSPHERICALHARMONICSPEAKFINDER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "linearAlgebra/WVectorFixed.h"
+#include "WSphericalHarmonicsBasis.h"
+
+/**
+ * Finds the maxima (peaks) of antipodally symmetric spherical functions given as symmetric spherical harmonics, e.g.
+ * ODFs, for many voxels at once.
+ *
+ * The constructor tessellates the sphere with an icosahedron, keeps one direction of every antipodal pair and
+ * evaluates the SH basis in these directions. findPeaks() evaluates the functions of a block of voxels on all
+ * directions with one matrix product, takes the directions whose value exceeds those of all neighboring directions
+ * as seeds and refines every seed with a few parabolic steps in the tangent plane. Unlike
+ * findSymmetricSphericalFunctionMaxima(), no gradient ascent from many starting points is needed.
+ *
+ * The peaks of a voxel are stored as getMaxPeaks() groups of ValuesPerPeak values: the unit direction followed by the
+ * value of the function in that direction. They are sorted by decreasing value, unused groups are zero.
+ *
+ * An instance is immutable after construction and may be shared between threads.
+ */
+class WSphericalHarmonicsPeakFinder // NOLINT
+{
+public:
+    /**
+     * The number of values stored per peak, the direction and the value of the function.
+     */
+    static const std::size_t ValuesPerPeak = 4;
+
+    /**
+     * The number of voxels evaluated together by findPeaks().
+     */
+    static const std::size_t BlockSize = 32;
+
+    /**
+     * Constructor.
+     *
+     * \param order the order of the SH, must be even
+     * \param maxPeaks the maximum number of peaks per voxel
+     * \param relativeThreshold peaks with a value below this fraction of the largest peak of the voxel are dropped
+     * \param minSeparationAngle peaks closer than this angle (in radians) to a larger peak are dropped
+     * \param tesselationLevel the refinement level of the icosahedron providing the seed directions
+     */
+    WSphericalHarmonicsPeakFinder( std::size_t order, std::size_t maxPeaks, double relativeThreshold = 0.5,
+                                   double minSeparationAngle = 0.35, unsigned int tesselationLevel = 3 );
+
+    /**
+     * Returns the order of the SH.
+     *
+     * \return the order
+     */
+    std::size_t getOrder() const;
+
+    /**
+     * Returns the number of SH coefficients per voxel.
+     *
+     * \return the number of coefficients
+     */
+    std::size_t getNumCoefficients() const;
+
+    /**
+     * Returns the maximum number of peaks per voxel.
+     *
+     * \return the maximum number of peaks
+     */
+    std::size_t getMaxPeaks() const;
+
+    /**
+     * Returns the seed directions, one of each antipodal pair of the tessellation.
+     *
+     * \return the directions
+     */
+    std::vector< WVector3d > const& getDirections() const;
+
+    /**
+     * Evaluates the functions of many voxels in all seed directions.
+     *
+     * \param coefficients getNumCoefficients() values per voxel, stored voxel after voxel
+     * \param numVoxels the number of voxels
+     * \param values getDirections().size() values per voxel are written here, voxel after voxel
+     */
+    void evaluate( double const* coefficients, std::size_t numVoxels, double* values ) const;
+
+    /**
+     * Finds the peaks of many voxels.
+     *
+     * \param coefficients getNumCoefficients() values per voxel, stored voxel after voxel
+     * \param numVoxels the number of voxels
+     * \param peaks getMaxPeaks() * ValuesPerPeak values per voxel are written here, voxel after voxel
+     */
+    void findPeaks( double const* coefficients, std::size_t numVoxels, float* peaks ) const;
+
+private:
+    /**
+     * A peak candidate.
+     */
+    struct Peak
+    {
+        /**
+         * Sorts by decreasing value.
+         *
+         * \param other the other peak
+         *
+         * \return true if this peak is larger
+         */
+        bool operator<( Peak const& other ) const;
+
+        WVector3d m_direction;  //!< the direction
+        double m_value;         //!< the value of the function
+    };
+
+    /**
+     * Evaluates a function in one direction.
+     *
+     * \param coefficients the SH coefficients
+     * \param direction the direction
+     * \param basis getNumCoefficients() values of scratch space
+     *
+     * \return the value
+     */
+    double evaluate( double const* coefficients, WVector3d const& direction, double* basis ) const;
+
+    /**
+     * Refines a seed direction by parabolic steps in the tangent plane.
+     *
+     * \param coefficients the SH coefficients
+     * \param seed the seed direction
+     * \param basis getNumCoefficients() values of scratch space
+     *
+     * \return the refined peak
+     */
+    Peak refine( double const* coefficients, WVector3d const& seed, double* basis ) const;
+
+    /**
+     * The order of the SH.
+     */
+    std::size_t m_order;
+
+    /**
+     * The number of coefficients.
+     */
+    std::size_t m_numCoefficients;
+
+    /**
+     * The maximum number of peaks per voxel.
+     */
+    std::size_t m_maxPeaks;
+
+    /**
+     * Fraction of the largest peak below which peaks are dropped.
+     */
+    double m_relativeThreshold;
+
+    /**
+     * Cosine of the minimum angle between peaks.
+     */
+    double m_minSeparationCosine;
+
+    /**
+     * The initial angular step of the refinement, half the angle between neighboring seed directions.
+     */
+    double m_initialStep;
+
+    /**
+     * The basis used for the refinement.
+     */
+    WSphericalHarmonicsBasis< double > m_basis;
+
+    /**
+     * The seed directions.
+     */
+    std::vector< WVector3d > m_directions;
+
+    /**
+     * The neighbors of every seed direction, stored as offsets into m_neighbors.
+     */
+    std::vector< std::size_t > m_neighborOffsets;
+
+    /**
+     * The indices of the neighbors of all seed directions.
+     */
+    std::vector< std::size_t > m_neighbors;
+
+    /**
+     * The basis values in the seed directions, one row of getNumCoefficients() values per direction.
+     */
+    std::vector< double > m_basisRows;
+};
+
+#endif  // WSPHERICALHARMONICSPEAKFINDER_H
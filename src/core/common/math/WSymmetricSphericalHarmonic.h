@@ -39,6 +39,7 @@
 #include "WLinearAlgebraFunctions.h"
 #include "WMath.h"
 #include "WMatrix.h"
+#include "WSphericalHarmonicsBasis.h"
 #include "WTensorSym.h"
 #include "WUnitSphereCoordinates.h"
 #include "WValue.h"
@@ -308,28 +309,11 @@ WSymmetricSphericalHarmonic< T >::~WSymmetricSphericalHarmonic()
 template< typename T >
 T WSymmetricSphericalHarmonic< T >::getValue( T theta, T phi ) const
 {
-  T result = 0.0;
-  int j = 0;
-  const T rootOf2 = std::sqrt( 2.0 );
-  for( int k = 0; k <= static_cast<int>( m_order ); k+=2 )
+  if( m_order <= WSphericalHarmonicsBasis< T >::DefaultMaxOrder )
   {
-    // m = 1 .. k
-    for( int m = 1; m <= k; m++ )
-    {
-      j = ( k*k+k+2 ) / 2 + m;
-      result += m_SHCoefficients[ j-1 ] * rootOf2 *
-                  static_cast< T >( std::pow( -1.0, m+1 ) ) * boost::math::spherical_harmonic_i( k, m, theta, phi );
-    }
-    // m = 0
-    result += m_SHCoefficients[ ( k*k+k+2 ) / 2 - 1 ] * boost::math::spherical_harmonic_r( k, 0, theta, phi );
-    // m = -k .. -1
-    for( int m = -k; m < 0; m++ )
-    {
-      j = ( k*k+k+2 ) / 2 + m;
-      result += m_SHCoefficients[ j-1 ] * rootOf2 * boost::math::spherical_harmonic_r( k, -m, theta, phi );
-    }
+    return WSphericalHarmonicsBasis< T >::getDefault().evaluate( m_SHCoefficients, m_order, theta, phi );
   }
-  return result;
+  return WSphericalHarmonicsBasis< T >( m_order ).evaluate( m_SHCoefficients, m_order, theta, phi );
 }
 
 template< typename T >
@@ -453,11 +437,18 @@ T WSymmetricSphericalHarmonic< T >::calcGFA( std::vector< WUnitSphereCoordinates
     T d = 0.0;
     T gfa = 0.0;
     T mean = 0.0;
-    std::vector< T > v( orientations.size() );
+    std::vector< T > v;
+    if( m_order <= WSphericalHarmonicsBasis< T >::DefaultMaxOrder )
+    {
+        WSphericalHarmonicsBasis< T >::getDefault().evaluate( m_SHCoefficients, m_order, orientations, &v );
+    }
+    else
+    {
+        WSphericalHarmonicsBasis< T >( m_order ).evaluate( m_SHCoefficients, m_order, orientations, &v );
+    }
 
     for( std::size_t i = 0; i < orientations.size(); ++i )
     {
-        v[ i ] = getValue( orientations[ i ] );
         mean += v[ i ];
     }
     mean /= n;
@@ -656,35 +647,12 @@ template< typename T >
 WMatrix< T > WSymmetricSphericalHarmonic< T >::calcBaseMatrix( const std::vector< WUnitSphereCoordinates< T > >& orientations,
                                                                     int order )
 {
-  WMatrix< T > B( orientations.size(), ( ( order + 1 ) * ( order + 2 ) ) / 2 );
-
   // calc B Matrix like in the 2007 Descoteaux paper ("Regularized, Fast, and Robust Analytical Q-Ball Imaging")
-  int j = 0;
-  const T rootOf2 = std::sqrt( 2.0 );
-  for(uint32_t row = 0; row < orientations.size(); row++ )
+  if( order <= static_cast< int >( WSphericalHarmonicsBasis< T >::DefaultMaxOrder ) )
   {
-    const T theta = orientations[row].getTheta();
-    const T phi = orientations[row].getPhi();
-    for( int k = 0; k <= order; k+=2 )
-    {
-      // m = 1 .. k
-      for( int m = 1; m <= k; m++ )
-      {
-        j = ( k * k + k + 2 ) / 2 + m;
-        B( row, j-1 ) = rootOf2 * static_cast< T >( std::pow( static_cast< T >( -1 ), m + 1 ) )
-                        * boost::math::spherical_harmonic_i( k, m, theta, phi );
-      }
-      // m = 0
-      B( row, ( k * k + k + 2 ) / 2 - 1 ) = boost::math::spherical_harmonic_r( k, 0, theta, phi );
-      // m = -k .. -1
-      for( int m = -k; m < 0; m++ )
-      {
-        j = ( k * k + k + 2 ) / 2 + m;
-        B( row, j-1 ) = rootOf2*boost::math::spherical_harmonic_r( k, -m, theta, phi );
-      }
-    }
+    return WSphericalHarmonicsBasis< T >::getDefault().calcBaseMatrix( orientations, order );
   }
-  return B;
+  return WSphericalHarmonicsBasis< T >( order ).calcBaseMatrix( orientations, order );
 }
 
 template< typename T >
@@ -221,6 +221,53 @@ void eigenEigenvector3D( WTensorSym< 2, 3, Data_T > const& mat, RealEigenSystem*
     }
 }
 
+/**
+ * Calculate the eigenvalues of a symmetric 3x3 matrix via the characteristic polynomial and Cardano's formula.
+ * This is the scalar kernel of getEigenvaluesCardano(), usable without building a tensor. It contains no branches
+ * and is inlined, so loops over many matrices can be unrolled and vectorized by the compiler.
+ *
+ * \param xx matrix element (0,0)
+ * \param xy matrix element (0,1)
+ * \param xz matrix element (0,2)
+ * \param yy matrix element (1,1)
+ * \param yz matrix element (1,2)
+ * \param zz matrix element (2,2)
+ * \param w0 the largest eigenvalue
+ * \param w1 the middle eigenvalue
+ * \param w2 the smallest eigenvalue
+ */
+inline void calcEigenvaluesCardano( double xx, double xy, double xz, double yy, double yz, double zz,
+                                    double* w0, double* w1, double* w2 )
+{
+    // this is copied from the gpu glyph shader
+    // src/graphicsEngine/shaders/tensorTools.fs
+    // originally implemented by Mario Hlawitschka
+    const double sqrt3 = 1.73205080756887729352744634151;
+    double de = yz * xy;
+    double dd = yz * yz;
+    double ee = xy * xy;
+    double ff = xz * xz;
+    double m0 = xx + yy + zz;
+    double c1 = xx * yy + xx * zz + yy * zz - ( dd + ee + ff );
+    // c0 = -det( m )
+    double c0 = xx * dd + zz * ee + yy * ff - xx * yy * zz - 2. * xz * de;
+
+    double p = m0 * m0 - 3. * c1;
+    double q = m0 * ( p - ( 3. / 2. ) * c1 ) - ( 27. / 2. ) * c0;
+    double sqrtP = std::sqrt( std::fabs( p ) );
+
+    double phi = 27. * ( 0.25 * c1 * c1 * ( p - c1 ) + c0 * ( q + 27. / 4. * c0 ) );
+    phi = ( 1. / 3. ) * std::atan2( std::sqrt( std::fabs( phi ) ), q );
+
+    double c = sqrtP * std::cos( phi );
+    double s = ( 1. / sqrt3 ) * sqrtP * std::sin( phi );
+
+    double w = ( 1. / 3. ) * ( m0 - c );
+    *w0 = w + c;
+    *w1 = w + s;
+    *w2 = w - s;
+}
+
 /**
  * Calculate eigenvectors via the characteristic polynomial. This is essentially the same
  * function as in the GPU glyph shaders. This is for 3 dimensions only.
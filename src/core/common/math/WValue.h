@@ -27,15 +27,22 @@
 
 #include <algorithm>
 #include <cmath>
+#include <utility>
 #include <vector>
 
 #include <Eigen/Core>
 
 #include "../WAssert.h"
+#include "../WSmallVector.h"
 #include "../WStringUtils.h"
 
 /**
  * Base class for all higher level values like tensors, vectors, matrices and so on.
+ *
+ * Up to InlineCapacity components are stored inside the object, so the temporaries of per-voxel computations with
+ * spherical harmonics up to order 8 or matrices up to 6x6 do not allocate memory. Temporaries are moved instead of
+ * copied and the arithmetic operators reuse the storage of temporary operands, so chains like a + b - c only create
+ * one value.
  */
 template< typename T > class WValue
 {
@@ -47,6 +54,13 @@ template< typename U > friend std::ostream& operator<<( std::ostream& os, const
 template< typename U > friend std::istream& operator>>( std::istream& in, WValue< U >& rhs );
 // \endcond
 public:
+    /**
+     * The number of components stored without heap allocation. This covers the 45 coefficients of symmetric spherical
+     * harmonics of order 8 and 6x6 matrices. Every value has this size, so values are meant for temporaries and not
+     * for storing many small vectors. Use WMatrixFixed or value sets for that.
+     */
+    static const size_t InlineCapacity = 45;
+
     /**
      * Create a WValue with the given number of components.
      * The components will be set to zero if T is a type representing numbers.
@@ -66,6 +80,15 @@ public:
     {
     }
 
+    /**
+     * Create a WValue by taking over the components of the one given as parameter.
+     * \param newValue The WValue to be moved, it is empty afterwards.
+     */
+    WValue( WValue&& newValue )
+        : m_components( std::move( newValue.m_components ) )
+    {
+    }
+
     /**
      * Create a WValue as copy of the one given as parameter but with another template type.
      * \param newValue The WValue to be copied.
@@ -173,6 +196,17 @@ public:
         return *this;
     }
 
+    /**
+     * Takes over the contents of its argument.
+     * \param rhs The right hand side of the assignment, it is empty afterwards.
+     * \return A reference to the left hand side of the assignment (i.e. the current object).
+     */
+    WValue& operator=( WValue&& rhs )
+    {
+        m_components = std::move( rhs.m_components );
+        return *this;
+    }
+
     /**
      * Adds a the argument component-wise to the components of this WValue
      * \param rhs The right hand side of the assignment
@@ -243,7 +277,7 @@ public:
      * \param summand2 The right hand side of the summation
      * \result The sum of the WValues.
      */
-    const WValue operator+( const WValue& summand2 ) const
+    WValue operator+( const WValue& summand2 ) const
     {
         WAssert( m_components.size() == summand2.m_components.size(), "Incompatible sizes of summands." );
         WValue result( *this );
@@ -256,7 +290,7 @@ public:
      * \param subtrahend The right hand side of the subtraction
      * \result The difference of the WValues.
      */
-    const WValue operator-( const WValue& subtrahend ) const
+    WValue operator-( const WValue& subtrahend ) const
     {
         WAssert( m_components.size() == subtrahend.m_components.size(), "Incompatible sizes of subtrahend and minuend." );
         WValue result( *this );
@@ -269,7 +303,7 @@ public:
      * \param factor2 The right hand side of the product
      * \return The vector of the product of the components.
      */
-    const WValue operator*( const WValue& factor2 ) const
+    WValue operator*( const WValue& factor2 ) const
     {
         WAssert( m_components.size() == factor2.m_components.size(), "Incompatible sizes of factors." );
         WValue result( *this );
@@ -343,7 +377,7 @@ public:
     {
         WAssert( !m_components.empty(), "WValue has no entries." );
         T sum = 0;
-        for( typename std::vector< T >::const_iterator it = m_components.begin(); it != m_components.end(); it++  )
+        for( typename ComponentStorage::const_iterator it = m_components.begin(); it != m_components.end(); it++  )
         {
             sum += ( *it );
         }
@@ -357,7 +391,7 @@ public:
     T median() const
     {
         WAssert( !m_components.empty(), "WValue has no entries. " );
-        std::vector< T > components( m_components );
+        std::vector< T > components( m_components.begin(), m_components.end() );
         std::sort( components.begin(), components.end() );
         return components[ components.size() / 2 ];
     }
@@ -373,6 +407,11 @@ public:
 
 protected:
 private:
+    /**
+     * The storage of the components.
+     */
+    typedef WSmallVector< T, InlineCapacity > ComponentStorage;
+
     /**
      * This function is used by the constructors that have the different Eigen::MatrixX types as parameter.
      * \tparam EigenDataType The data type which is used by the Eigen::VectorX.
@@ -390,48 +429,123 @@ private:
    /**
      * The components the value is composed of. This contains the actual data
      */
-    std::vector< T > m_components;
+    ComponentStorage m_components;
 };
 
+template< typename T >
+const size_t WValue< T >::InlineCapacity;
+
 /**
  * Multiplies a WValue with a scalar
  * \param lhs left hand side of product
  * \param rhs right hand side of product
  * \return product of WValue with scalar
  */
-template< typename T > inline const WValue< T > operator*( const WValue< T >& lhs, double rhs )
+template< typename T > inline WValue< T > operator*( const WValue< T >& lhs, double rhs )
 {
     WValue< T > result( lhs );
     result *= rhs;
     return result;
 }
 
+/**
+ * Multiplies a temporary WValue with a scalar, reusing its storage.
+ * \param lhs left hand side of product
+ * \param rhs right hand side of product
+ * \return product of WValue with scalar
+ */
+template< typename T > inline WValue< T > operator*( WValue< T >&& lhs, double rhs )
+{
+    lhs *= rhs;
+    return std::move( lhs );
+}
+
 /**
  * This functions only exists to make scalar multiplication commutative
  * \param lhs left hand side of product
  * \param rhs right hand side of product
  * \return product of WValue with scalar
  */
-template< typename T > inline const WValue< T > operator*( double lhs, const WValue< T >& rhs )
+template< typename T > inline WValue< T > operator*( double lhs, const WValue< T >& rhs )
 {
     WValue< T > result( rhs );
     result *= lhs;
     return result;
 }
 
+/**
+ * This functions only exists to make scalar multiplication commutative, reusing the storage of the temporary.
+ * \param lhs left hand side of product
+ * \param rhs right hand side of product
+ * \return product of WValue with scalar
+ */
+template< typename T > inline WValue< T > operator*( double lhs, WValue< T >&& rhs )
+{
+    rhs *= lhs;
+    return std::move( rhs );
+}
+
 /**
  * Divides a WValue by a scalar
  * \param lhs left hand side of division
  * \param rhs right hand side of division
  * \return Quotien of WValue with scalar
  */
-template< typename T > inline const WValue< T > operator/( const WValue< T >& lhs, double rhs )
+template< typename T > inline WValue< T > operator/( const WValue< T >& lhs, double rhs )
 {
     WValue< T > result( lhs );
     result /= rhs;
     return result;
 }
 
+/**
+ * Divides a temporary WValue by a scalar, reusing its storage.
+ * \param lhs left hand side of division
+ * \param rhs right hand side of division
+ * \return Quotien of WValue with scalar
+ */
+template< typename T > inline WValue< T > operator/( WValue< T >&& lhs, double rhs )
+{
+    lhs /= rhs;
+    return std::move( lhs );
+}
+
+/**
+ * Component-wise addition to a temporary WValue, reusing its storage.
+ * \param lhs left hand side of the summation
+ * \param rhs right hand side of the summation
+ * \return The sum of the WValues.
+ */
+template< typename T > inline WValue< T > operator+( WValue< T >&& lhs, const WValue< T >& rhs )
+{
+    lhs += rhs;
+    return std::move( lhs );
+}
+
+/**
+ * Component-wise subtraction from a temporary WValue, reusing its storage.
+ * \param lhs left hand side of the subtraction
+ * \param rhs right hand side of the subtraction
+ * \return The difference of the WValues.
+ */
+template< typename T > inline WValue< T > operator-( WValue< T >&& lhs, const WValue< T >& rhs )
+{
+    lhs -= rhs;
+    return std::move( lhs );
+}
+
+/**
+ * Component-wise multiplication of a temporary WValue, reusing its storage.
+ * \param lhs left hand side of the product
+ * \param rhs right hand side of the product
+ * \return The vector of the product of the components.
+ */
+template< typename T > inline WValue< T > operator*( WValue< T >&& lhs, const WValue< T >& rhs )
+{
+    lhs *= rhs;
+    return std::move( lhs );
+}
+
 /**
  * Writes a meaningful representation of that object to the given stream.
  *
@@ -442,7 +556,7 @@ template< typename T > inline const WValue< T > operator/( const WValue< T >& lh
  */
 template< typename U > inline std::ostream& operator<<( std::ostream& os, const WValue< U > &rhs )
 {
-    return string_utils::operator<<( os, rhs.m_components );
+    return string_utils::operator<<( os, std::vector< U >( rhs.m_components.begin(), rhs.m_components.end() ) );
 }
 
 /**
@@ -455,7 +569,11 @@ template< typename U > inline std::ostream& operator<<( std::ostream& os, const
  */
 template< typename U > inline std::istream& operator>>( std::istream& in, WValue< U >& rhs )
 {
-    return string_utils::operator>>( in, rhs.m_components );
+    std::vector< U > components;
+    string_utils::operator>>( in, components );
+    rhs.m_components.resize( components.size() );
+    std::copy( components.begin(), components.end(), rhs.m_components.begin() );
+    return in;
 }
 
 #endif  // WVALUE_H
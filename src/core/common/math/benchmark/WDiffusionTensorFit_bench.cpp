@@ -0,0 +1,190 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../WBenchmark.h"
+#include "../../WBenchmarkRunner.h"
+#include "../WDiffusionTensorFit.h"
+#include "../WMath.h"
+
+/**
+ * Measures the per-voxel fitting of diffusion tensors to 60 weighted and one unweighted measurements with the
+ * given method. The voxel counts match WSymmetricSphericalHarmonicFitBenchmark, which measures the tensors derived
+ * from a spherical harmonics fit.
+ */
+class WDiffusionTensorFitBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param name the name of the benchmark
+     * \param method the fitting method
+     */
+    WDiffusionTensorFitBenchmark( std::string const& name, WDiffusionTensorFit::FitMethod method ):
+        WBenchmark( name ),
+        m_method( method )
+    {
+        addSize( 10000 );
+        addSize( 100000 );
+    }
+
+    /**
+     * Sets up the fit and simulates noisy measurements of random tensors.
+     *
+     * \param size number of voxels
+     */
+    virtual void setUp( size_t size )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> cosTheta( -1.0, 1.0 );
+        boost::random::uniform_real_distribution<> phi( 0.0, 2.0 * pi() );
+        std::vector< WVector3d > gradients( 1, WVector3d( 0.0, 0.0, 0.0 ) );
+        for( size_t i = 0; i < 60; ++i )
+        {
+            double const z = cosTheta( rng );
+            double const r = std::sqrt( 1.0 - z * z );
+            double const p = phi( rng );
+            gradients.push_back( WVector3d( r * std::cos( p ), r * std::sin( p ), z ) );
+        }
+        m_fit.reset( new WDiffusionTensorFit( gradients, std::vector< double >( 1, 1000.0 ), m_method ) );
+
+        boost::random::uniform_real_distribution<> diagonal( 0.2e-3, 2.0e-3 );
+        boost::random::uniform_real_distribution<> offDiagonal( -0.1e-3, 0.1e-3 );
+        boost::random::normal_distribution<> noise( 0.0, 10.0 );
+        m_measurements.resize( size * gradients.size() );
+        for( size_t voxel = 0; voxel < size; ++voxel )
+        {
+            double const t[ 6 ] = { diagonal( rng ), offDiagonal( rng ), offDiagonal( rng ), diagonal( rng ), offDiagonal( rng ), // NOLINT
+                                    diagonal( rng ) };
+            for( size_t i = 0; i < gradients.size(); ++i )
+            {
+                WVector3d const& g = gradients[ i ];
+                double const adc = t[ 0 ] * g[ 0 ] * g[ 0 ] + 2.0 * t[ 1 ] * g[ 0 ] * g[ 1 ] + 2.0 * t[ 2 ] * g[ 0 ] * g[ 2 ]
+                                 + t[ 3 ] * g[ 1 ] * g[ 1 ] + 2.0 * t[ 4 ] * g[ 1 ] * g[ 2 ] + t[ 5 ] * g[ 2 ] * g[ 2 ];
+                m_measurements[ voxel * gradients.size() + i ] = std::fabs( 1000.0 * std::exp( -1000.0 * adc ) + noise( rng ) );
+            }
+        }
+    }
+
+    /**
+     * Fits all voxels.
+     *
+     * \return number of voxels
+     */
+    virtual size_t run()
+    {
+        size_t const numMeasurements = m_fit->getNumMeasurements();
+        size_t const numVoxels = m_measurements.size() / numMeasurements;
+        double tensor[ 6 ];
+        double sum = 0.0;
+        for( size_t voxel = 0; voxel < numVoxels; ++voxel )
+        {
+            m_fit->fit( &m_measurements[ voxel * numMeasurements ], tensor );
+            sum += tensor[ 0 ];
+        }
+        consume( sum );
+        return numVoxels;
+    }
+
+    /**
+     * Frees the measurements.
+     */
+    virtual void tearDown()
+    {
+        m_measurements.clear();
+        m_fit.reset();
+    }
+
+private:
+    /**
+     * The fitting method.
+     */
+    WDiffusionTensorFit::FitMethod m_method;
+
+    /**
+     * The fit for the gradient scheme.
+     */
+    boost::shared_ptr< WDiffusionTensorFit > m_fit;
+
+    /**
+     * The measurements of all voxels.
+     */
+    std::vector< double > m_measurements;
+};
+
+/**
+ * The log-linear fit.
+ */
+class WDiffusionTensorFitLogLinearBenchmark: public WDiffusionTensorFitBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WDiffusionTensorFitLogLinearBenchmark():
+        WDiffusionTensorFitBenchmark( "WDiffusionTensorFit::fit (log-linear)", WDiffusionTensorFit::LOG_LINEAR )
+    {
+    }
+};
+
+/**
+ * The weighted linear fit.
+ */
+class WDiffusionTensorFitWeightedBenchmark: public WDiffusionTensorFitBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WDiffusionTensorFitWeightedBenchmark():
+        WDiffusionTensorFitBenchmark( "WDiffusionTensorFit::fit (weighted linear)", WDiffusionTensorFit::WEIGHTED_LINEAR )
+    {
+    }
+};
+
+/**
+ * The constrained nonlinear fit.
+ */
+class WDiffusionTensorFitNonlinearBenchmark: public WDiffusionTensorFitBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WDiffusionTensorFitNonlinearBenchmark():
+        WDiffusionTensorFitBenchmark( "WDiffusionTensorFit::fit (constrained nonlinear)", WDiffusionTensorFit::CONSTRAINED_NONLINEAR )
+    {
+    }
+};
+
+W_REGISTER_BENCHMARK( WDiffusionTensorFitLogLinearBenchmark )
+W_REGISTER_BENCHMARK( WDiffusionTensorFitWeightedBenchmark )
+W_REGISTER_BENCHMARK( WDiffusionTensorFitNonlinearBenchmark )
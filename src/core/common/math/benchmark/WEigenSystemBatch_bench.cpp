@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/random.hpp>
+
+#include "../../WBenchmark.h"
+#include "../../WBenchmarkRunner.h"
+#include "../WEigenSystemBatch.h"
+#include "../WTensorFunctions.h"
+#include "../WTensorSym.h"
+
+namespace
+{
+    /**
+     * Creates random positive definite tensors, stored as xx, xy, xz, yy, yz, zz per tensor like in DTI datasets.
+     *
+     * \param count number of tensors
+     * \param tensors the tensors will be stored here
+     */
+    void randomTensors( size_t count, std::vector< double >* tensors )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> offDiagonal( -0.2, 0.2 );
+        boost::random::uniform_real_distribution<> diagonal( 0.5, 2.0 );
+        tensors->resize( 6 * count );
+        for( size_t i = 0; i < count; ++i )
+        {
+            double* t = &( *tensors )[ 6 * i ];
+            t[ 0 ] = diagonal( rng );
+            t[ 1 ] = offDiagonal( rng );
+            t[ 2 ] = offDiagonal( rng );
+            t[ 3 ] = diagonal( rng );
+            t[ 4 ] = offDiagonal( rng );
+            t[ 5 ] = diagonal( rng );
+        }
+    }
+}
+
+/**
+ * Measures the eigen decomposition of a tensor field voxel by voxel using the Jacobi method, like done by WMDeterministicFTMori.
+ */
+class WJacobiEigenSystemBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WJacobiEigenSystemBenchmark():
+        WBenchmark( "jacobiEigenvector3D" )
+    {
+        addSize( 100000 );
+        addSize( 1000000 );
+    }
+
+    /**
+     * Creates the tensors.
+     *
+     * \param size number of tensors
+     */
+    virtual void setUp( size_t size )
+    {
+        randomTensors( size, &m_tensors );
+    }
+
+    /**
+     * Decomposes all tensors.
+     *
+     * \return number of tensors
+     */
+    virtual size_t run()
+    {
+        size_t const count = m_tensors.size() / 6;
+        WTensorSym< 2, 3, double > m;
+        RealEigenSystem sys;
+        double sum = 0.0;
+        for( size_t i = 0; i < count; ++i )
+        {
+            double const* t = &m_tensors[ 6 * i ];
+            m( 0, 0 ) = t[ 0 ];
+            m( 0, 1 ) = t[ 1 ];
+            m( 0, 2 ) = t[ 2 ];
+            m( 1, 1 ) = t[ 3 ];
+            m( 1, 2 ) = t[ 4 ];
+            m( 2, 2 ) = t[ 5 ];
+            jacobiEigenvector3D( m, &sys );
+            sum += sys[ 0 ].first + sys[ 0 ].second[ 0 ];
+        }
+        consume( sum );
+        return count;
+    }
+
+    /**
+     * Frees the tensors.
+     */
+    virtual void tearDown()
+    {
+        m_tensors.clear();
+    }
+
+private:
+    /**
+     * The tensors.
+     */
+    std::vector< double > m_tensors;
+};
+
+/**
+ * Measures the eigen decomposition of the same tensors using WEigenSystemBatch in blocks of 4096 tensors, like done by WThreadedEigenSystems.
+ */
+class WEigenSystemBatchBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WEigenSystemBatchBenchmark():
+        WBenchmark( "WEigenSystemBatch::compute" )
+    {
+        addSize( 100000 );
+        addSize( 1000000 );
+    }
+
+    /**
+     * Creates the tensors.
+     *
+     * \param size number of tensors
+     */
+    virtual void setUp( size_t size )
+    {
+        randomTensors( size, &m_tensors );
+    }
+
+    /**
+     * Decomposes all tensors.
+     *
+     * \return number of tensors
+     */
+    virtual size_t run()
+    {
+        size_t const count = m_tensors.size() / 6;
+        size_t const chunkSize = 4096;
+        WEigenSystemBatch batch( chunkSize );
+        double sum = 0.0;
+        for( size_t first = 0; first < count; first += chunkSize )
+        {
+            size_t const n = std::min( chunkSize, count - first );
+            if( n != batch.size() )
+            {
+                batch.resize( n );
+            }
+            batch.setTensors( 0, &m_tensors[ 6 * first ], n );
+            batch.compute();
+            for( size_t i = 0; i < n; ++i )
+            {
+                sum += batch.getEigenvalue( i, 0 ) + batch.getEigenvector( i, 0 )[ 0 ];
+            }
+        }
+        consume( sum );
+        return count;
+    }
+
+    /**
+     * Frees the tensors.
+     */
+    virtual void tearDown()
+    {
+        m_tensors.clear();
+    }
+
+private:
+    /**
+     * The tensors.
+     */
+    std::vector< double > m_tensors;
+};
+
+W_REGISTER_BENCHMARK( WJacobiEigenSystemBenchmark )
+W_REGISTER_BENCHMARK( WEigenSystemBatchBenchmark )
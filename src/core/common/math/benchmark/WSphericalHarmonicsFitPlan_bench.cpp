@@ -0,0 +1,312 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../WBenchmark.h"
+#include "../../WBenchmarkRunner.h"
+#include "../WMath.h"
+#include "../WSphericalHarmonicsFitPlan.h"
+
+namespace
+{
+    /**
+     * Creates random gradient directions.
+     *
+     * \param count the number of directions
+     *
+     * \return the directions
+     */
+    std::vector< WVector3d > createGradients( size_t count )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> cosTheta( -1.0, 1.0 );
+        boost::random::uniform_real_distribution<> phi( 0.0, 2.0 * pi() );
+        std::vector< WVector3d > gradients;
+        for( size_t i = 0; i < count; ++i )
+        {
+            double const z = cosTheta( rng );
+            double const r = std::sqrt( 1.0 - z * z );
+            double const p = phi( rng );
+            gradients.push_back( WVector3d( r * std::cos( p ), r * std::sin( p ), z ) );
+        }
+        return gradients;
+    }
+}
+
+/**
+ * Fits order 8 spherical harmonics to 90 measurements per voxel, either one matrix-vector product per voxel or with
+ * the blocked products of WSphericalHarmonicsFitPlan::fit().
+ */
+class WSphericalHarmonicsFitBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param name the name of the benchmark
+     * \param blocked whether to use the blocked fit
+     */
+    WSphericalHarmonicsFitBenchmark( std::string const& name, bool blocked ):
+        WBenchmark( name ),
+        m_blocked( blocked )
+    {
+        addSize( 10000 );
+        addSize( 100000 );
+    }
+
+    /**
+     * Sets up the plan and random measurements.
+     *
+     * \param size number of voxels
+     */
+    virtual void setUp( size_t size )
+    {
+        m_plan.reset( new WSphericalHarmonicsFitPlan( createGradients( 90 ), 8, 0.006, WSphericalHarmonicsFitPlan::DEFAULT ) );
+        boost::random::mt19937 rng( 7 );
+        boost::random::uniform_real_distribution<> signal( 0.1, 1.0 );
+        m_measurements.resize( size * m_plan->getNumMeasurements() );
+        for( size_t i = 0; i < m_measurements.size(); ++i )
+        {
+            m_measurements[ i ] = signal( rng );
+        }
+        m_coefficients.resize( size * m_plan->getNumCoefficients() );
+    }
+
+    /**
+     * Fits all voxels.
+     *
+     * \return number of voxels
+     */
+    virtual size_t run()
+    {
+        size_t const N = m_plan->getNumMeasurements();
+        size_t const R = m_plan->getNumCoefficients();
+        size_t const numVoxels = m_measurements.size() / N;
+        if( m_blocked )
+        {
+            m_plan->fit( &m_measurements[ 0 ], numVoxels, &m_coefficients[ 0 ] );
+        }
+        else
+        {
+            WValue< double > measures( N );
+            for( size_t voxel = 0; voxel < numVoxels; ++voxel )
+            {
+                for( size_t i = 0; i < N; ++i )
+                {
+                    measures[ i ] = m_measurements[ voxel * N + i ];
+                }
+                WValue< double > coefficients( m_plan->getFittingMatrix() * measures );
+                for( size_t j = 0; j < R; ++j )
+                {
+                    m_coefficients[ voxel * R + j ] = coefficients[ j ];
+                }
+            }
+        }
+        consume( m_coefficients[ m_coefficients.size() / 2 ] );
+        return numVoxels;
+    }
+
+    /**
+     * Frees the measurements.
+     */
+    virtual void tearDown()
+    {
+        m_measurements.clear();
+        m_coefficients.clear();
+        m_plan.reset();
+    }
+
+private:
+    /**
+     * Whether to use the blocked fit.
+     */
+    bool m_blocked;
+
+    /**
+     * The plan.
+     */
+    boost::shared_ptr< WSphericalHarmonicsFitPlan > m_plan;
+
+    /**
+     * The measurements of all voxels.
+     */
+    std::vector< double > m_measurements;
+
+    /**
+     * The coefficients of all voxels.
+     */
+    std::vector< double > m_coefficients;
+};
+
+/**
+ * One matrix-vector product per voxel.
+ */
+class WSphericalHarmonicsFitPerVoxelBenchmark: public WSphericalHarmonicsFitBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSphericalHarmonicsFitPerVoxelBenchmark():
+        WSphericalHarmonicsFitBenchmark( "WMatrix * WValue (per voxel SH fit)", false )
+    {
+    }
+};
+
+/**
+ * The blocked fit.
+ */
+class WSphericalHarmonicsFitBlockedBenchmark: public WSphericalHarmonicsFitBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSphericalHarmonicsFitBlockedBenchmark():
+        WSphericalHarmonicsFitBenchmark( "WSphericalHarmonicsFitPlan::fit", true )
+    {
+    }
+};
+
+/**
+ * Builds plans for a sequence of regularization factors, as after changes of lambda in the GUI, either from scratch
+ * or through the cache, which keeps the basis of the gradients.
+ */
+class WSphericalHarmonicsFitPlanBuildBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param name the name of the benchmark
+     * \param cached whether to use WSphericalHarmonicsFitPlan::get()
+     */
+    WSphericalHarmonicsFitPlanBuildBenchmark( std::string const& name, bool cached ):
+        WBenchmark( name ),
+        m_cached( cached )
+    {
+        addSize( 100 );
+    }
+
+    /**
+     * Creates the gradients.
+     *
+     * \param size number of plans
+     */
+    virtual void setUp( size_t size )
+    {
+        m_gradients = createGradients( 90 );
+        m_numPlans = size;
+        WSphericalHarmonicsFitPlan::clearCache();
+    }
+
+    /**
+     * Builds the plans.
+     *
+     * \return number of plans
+     */
+    virtual size_t run()
+    {
+        double sum = 0.0;
+        for( size_t i = 0; i < m_numPlans; ++i )
+        {
+            double const lambda = 0.001 * static_cast< double >( i + 1 );
+            if( m_cached )
+            {
+                sum += WSphericalHarmonicsFitPlan::get( m_gradients, 8, lambda, WSphericalHarmonicsFitPlan::DEFAULT )->getFittingMatrix()( 0, 0 );
+            }
+            else
+            {
+                sum += WSphericalHarmonicsFitPlan( m_gradients, 8, lambda, WSphericalHarmonicsFitPlan::DEFAULT ).getFittingMatrix()( 0, 0 );
+            }
+        }
+        consume( sum );
+        return m_numPlans;
+    }
+
+    /**
+     * Clears the cache.
+     */
+    virtual void tearDown()
+    {
+        WSphericalHarmonicsFitPlan::clearCache();
+    }
+
+private:
+    /**
+     * Whether to use the cache.
+     */
+    bool m_cached;
+
+    /**
+     * The number of plans to build.
+     */
+    size_t m_numPlans;
+
+    /**
+     * The gradients.
+     */
+    std::vector< WVector3d > m_gradients;
+};
+
+/**
+ * Plans built from scratch.
+ */
+class WSphericalHarmonicsFitPlanUncachedBenchmark: public WSphericalHarmonicsFitPlanBuildBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSphericalHarmonicsFitPlanUncachedBenchmark():
+        WSphericalHarmonicsFitPlanBuildBenchmark( "WSphericalHarmonicsFitPlan (uncached, new lambda)", false )
+    {
+    }
+};
+
+/**
+ * Plans built from the cached basis.
+ */
+class WSphericalHarmonicsFitPlanCachedBenchmark: public WSphericalHarmonicsFitPlanBuildBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSphericalHarmonicsFitPlanCachedBenchmark():
+        WSphericalHarmonicsFitPlanBuildBenchmark( "WSphericalHarmonicsFitPlan::get (cached basis, new lambda)", true )
+    {
+    }
+};
+
+W_REGISTER_BENCHMARK( WSphericalHarmonicsFitPerVoxelBenchmark )
+W_REGISTER_BENCHMARK( WSphericalHarmonicsFitBlockedBenchmark )
+W_REGISTER_BENCHMARK( WSphericalHarmonicsFitPlanUncachedBenchmark )
+W_REGISTER_BENCHMARK( WSphericalHarmonicsFitPlanCachedBenchmark )
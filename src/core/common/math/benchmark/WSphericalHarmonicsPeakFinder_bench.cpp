@@ -0,0 +1,243 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <boost/random.hpp>
+
+#include "../../WBenchmark.h"
+#include "../../WBenchmarkRunner.h"
+#include "../WGeometryFunctions.h"
+#include "../WMath.h"
+#include "../WSphericalHarmonicsFitPlan.h"
+#include "../WSphericalHarmonicsPeakFinder.h"
+#include "../WTensorFunctions.h"
+#include "../WTensorSym.h"
+
+namespace
+{
+    /**
+     * Creates random ODFs of two crossing fibers each, as order 4 tensors sum( w * u^4 ) and as the equal order 4 SH.
+     *
+     * \param count number of voxels
+     * \param tensors the tensors will be stored here
+     * \param coefficients the SH coefficients will be stored here, voxel after voxel
+     */
+    void randomODFs( size_t count, std::vector< WTensorSym< 4, 3, double > >* tensors, std::vector< double >* coefficients )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> cosTheta( -1.0, 1.0 );
+        boost::random::uniform_real_distribution<> phi( 0.0, 2.0 * pi() );
+        boost::random::uniform_real_distribution<> weight( 0.5, 1.0 );
+
+        // the tensors are polynomials of degree 4 on the sphere, so the SH of order 4 fitted to them is exact
+        std::vector< WVector3d > samples;
+        std::vector< unsigned int > triangles;
+        tesselateIcosahedron( &samples, &triangles, 2 );
+        WSphericalHarmonicsFitPlan plan( samples, 4, 0.0, WSphericalHarmonicsFitPlan::DEFAULT );
+        std::vector< double > values( samples.size() );
+
+        tensors->resize( count );
+        coefficients->resize( count * plan.getNumCoefficients() );
+        for( size_t v = 0; v < count; ++v )
+        {
+            WTensorSym< 4, 3, double >& t = ( *tensors )[ v ];
+            for( size_t f = 0; f < 2; ++f )
+            {
+                double const z = cosTheta( rng );
+                double const r = std::sqrt( 1.0 - z * z );
+                double const p = phi( rng );
+                WVector3d const u( r * std::cos( p ), r * std::sin( p ), z );
+                double const w = weight( rng );
+                for( size_t i = 0; i < 3; ++i )
+                {
+                    for( size_t j = i; j < 3; ++j )
+                    {
+                        for( size_t k = j; k < 3; ++k )
+                        {
+                            for( size_t l = k; l < 3; ++l )
+                            {
+                                t( i, j, k, l ) += w * u[ i ] * u[ j ] * u[ k ] * u[ l ];
+                            }
+                        }
+                    }
+                }
+            }
+            for( size_t i = 0; i < samples.size(); ++i )
+            {
+                values[ i ] = t.evaluateSphericalFunction( samples[ i ] );
+            }
+            plan.fit( &values[ 0 ], 1, &( *coefficients )[ v * plan.getNumCoefficients() ] );
+        }
+    }
+}
+
+/**
+ * Finds the maxima of order 4 tensor ODFs voxel by voxel with findSymmetricSphericalFunctionMaxima(), seeded from a
+ * level 1 tessellation.
+ */
+class WTensorMaximaBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WTensorMaximaBenchmark():
+        WBenchmark( "findSymmetricSphericalFunctionMaxima" )
+    {
+        addSize( 10000 );
+    }
+
+    /**
+     * Creates the ODFs and seeds.
+     *
+     * \param size number of voxels
+     */
+    virtual void setUp( size_t size )
+    {
+        randomODFs( size, &m_tensors, &m_coefficients );
+        std::vector< unsigned int > triangles;
+        tesselateIcosahedron( &m_seeds, &triangles, 1 );
+    }
+
+    /**
+     * Finds the maxima of all voxels.
+     *
+     * \return number of voxels
+     */
+    virtual size_t run()
+    {
+        std::vector< WVector3d > maxima;
+        size_t found = 0;
+        for( size_t v = 0; v < m_tensors.size(); ++v )
+        {
+            maxima.clear();
+            findSymmetricSphericalFunctionMaxima( m_tensors[ v ], 0.5, std::cos( 0.35 ), 0.1, m_seeds, maxima );
+            found += maxima.size();
+        }
+        consume( static_cast< double >( found ) );
+        return m_tensors.size();
+    }
+
+    /**
+     * Frees the ODFs.
+     */
+    virtual void tearDown()
+    {
+        m_tensors.clear();
+        m_coefficients.clear();
+    }
+
+private:
+    /**
+     * The tensors.
+     */
+    std::vector< WTensorSym< 4, 3, double > > m_tensors;
+
+    /**
+     * The SH coefficients, unused.
+     */
+    std::vector< double > m_coefficients;
+
+    /**
+     * The starting points of the gradient ascent.
+     */
+    std::vector< WVector3d > m_seeds;
+};
+
+/**
+ * Finds the peaks of the same ODFs as WTensorMaximaBenchmark with WSphericalHarmonicsPeakFinder.
+ */
+class WSphericalHarmonicsPeakFinderBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSphericalHarmonicsPeakFinderBenchmark():
+        WBenchmark( "WSphericalHarmonicsPeakFinder::findPeaks" ),
+        m_finder( 4, 3 )
+    {
+        addSize( 10000 );
+    }
+
+    /**
+     * Creates the ODFs.
+     *
+     * \param size number of voxels
+     */
+    virtual void setUp( size_t size )
+    {
+        randomODFs( size, &m_tensors, &m_coefficients );
+        m_peaks.resize( size * m_finder.getMaxPeaks() * WSphericalHarmonicsPeakFinder::ValuesPerPeak );
+    }
+
+    /**
+     * Finds the peaks of all voxels.
+     *
+     * \return number of voxels
+     */
+    virtual size_t run()
+    {
+        m_finder.findPeaks( &m_coefficients[ 0 ], m_tensors.size(), &m_peaks[ 0 ] );
+        consume( m_peaks[ m_peaks.size() / 2 ] );
+        return m_tensors.size();
+    }
+
+    /**
+     * Frees the ODFs.
+     */
+    virtual void tearDown()
+    {
+        m_tensors.clear();
+        m_coefficients.clear();
+        m_peaks.clear();
+    }
+
+private:
+    /**
+     * The peak finder.
+     */
+    WSphericalHarmonicsPeakFinder m_finder;
+
+    /**
+     * The tensors, unused.
+     */
+    std::vector< WTensorSym< 4, 3, double > > m_tensors;
+
+    /**
+     * The SH coefficients.
+     */
+    std::vector< double > m_coefficients;
+
+    /**
+     * The peaks.
+     */
+    std::vector< float > m_peaks;
+};
+
+W_REGISTER_BENCHMARK( WTensorMaximaBenchmark )
+W_REGISTER_BENCHMARK( WSphericalHarmonicsPeakFinderBenchmark )
@@ -0,0 +1,321 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <vector>
+
+#include <boost/random.hpp>
+
+#include "../../WBenchmark.h"
+#include "../../WBenchmarkRunner.h"
+#include "../WMath.h"
+#include "../WMatrix.h"
+#include "../WSphericalHarmonicsBasis.h"
+#include "../WSymmetricSphericalHarmonic.h"
+#include "../WUnitSphereCoordinates.h"
+#include "../WValue.h"
+
+namespace
+{
+    /**
+     * Creates random directions on the unit sphere.
+     *
+     * \param count number of directions
+     * \param seed the seed of the random generator
+     *
+     * \return the directions
+     */
+    std::vector< WUnitSphereCoordinates< double > > randomDirections( size_t count, unsigned int seed )
+    {
+        boost::random::mt19937 rng( seed );
+        boost::random::uniform_real_distribution<> cosTheta( -1.0, 1.0 );
+        boost::random::uniform_real_distribution<> phi( 0.0, 2.0 * pi() );
+        std::vector< WUnitSphereCoordinates< double > > directions;
+        for( size_t i = 0; i < count; ++i )
+        {
+            directions.push_back( WUnitSphereCoordinates< double >( std::acos( cosTheta( rng ) ), phi( rng ) ) );
+        }
+        return directions;
+    }
+}
+
+/**
+ * Measures the evaluation of spherical harmonics of order size, like done for ODF glyphs and peak finding. 1000 functions are evaluated at 100
+ * directions each.
+ */
+class WSymmetricSphericalHarmonicEvalBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSymmetricSphericalHarmonicEvalBenchmark():
+        WBenchmark( "WSymmetricSphericalHarmonic::getValue" )
+    {
+        addSize( 4 );
+        addSize( 8 );
+    }
+
+    /**
+     * Creates random coefficients and directions.
+     *
+     * \param size the order
+     */
+    virtual void setUp( size_t size )
+    {
+        size_t numCoeffs = ( size + 1 ) * ( size + 2 ) / 2;
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> coeff( -1.0, 1.0 );
+        m_functions.clear();
+        for( size_t i = 0; i < 1000; ++i )
+        {
+            WValue< double > coeffs( numCoeffs );
+            for( size_t k = 0; k < numCoeffs; ++k )
+            {
+                coeffs[ k ] = coeff( rng );
+            }
+            m_functions.push_back( WSymmetricSphericalHarmonic< double >( coeffs ) );
+        }
+        m_directions = randomDirections( 100, 23 );
+    }
+
+    /**
+     * Evaluates all functions at all directions.
+     *
+     * \return number of evaluations
+     */
+    virtual size_t run()
+    {
+        double sum = 0.0;
+        for( size_t i = 0; i < m_functions.size(); ++i )
+        {
+            for( size_t j = 0; j < m_directions.size(); ++j )
+            {
+                sum += m_functions[ i ].getValue( m_directions[ j ] );
+            }
+        }
+        consume( sum );
+        return m_functions.size() * m_directions.size();
+    }
+
+    /**
+     * Frees the data.
+     */
+    virtual void tearDown()
+    {
+        m_functions.clear();
+        m_directions.clear();
+    }
+
+private:
+    /**
+     * The functions.
+     */
+    std::vector< WSymmetricSphericalHarmonic< double > > m_functions;
+
+    /**
+     * The directions.
+     */
+    std::vector< WUnitSphereCoordinates< double > > m_directions;
+};
+
+/**
+ * Like WSymmetricSphericalHarmonicEvalBenchmark, but the basis is evaluated once for the fixed set of directions and every function is then
+ * evaluated by a matrix-vector product.
+ */
+class WSphericalHarmonicsBasisPrecomputedBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSphericalHarmonicsBasisPrecomputedBenchmark():
+        WBenchmark( "WSphericalHarmonicsBasis::evaluate (precomputed)" ),
+        m_baseMatrix( 0, 0 )
+    {
+        addSize( 4 );
+        addSize( 8 );
+    }
+
+    /**
+     * Creates random coefficients and directions and the basis matrix.
+     *
+     * \param size the order
+     */
+    virtual void setUp( size_t size )
+    {
+        size_t numCoeffs = WSphericalHarmonicsBasis< double >::getNumCoefficients( size );
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> coeff( -1.0, 1.0 );
+        m_coefficients.clear();
+        for( size_t i = 0; i < 1000; ++i )
+        {
+            WValue< double > coeffs( numCoeffs );
+            for( size_t k = 0; k < numCoeffs; ++k )
+            {
+                coeffs[ k ] = coeff( rng );
+            }
+            m_coefficients.push_back( coeffs );
+        }
+        m_baseMatrix = WSphericalHarmonicsBasis< double >::getDefault().calcBaseMatrix( randomDirections( 100, 23 ), size );
+    }
+
+    /**
+     * Evaluates all functions at all directions.
+     *
+     * \return number of evaluations
+     */
+    virtual size_t run()
+    {
+        double sum = 0.0;
+        std::vector< double > values;
+        for( size_t i = 0; i < m_coefficients.size(); ++i )
+        {
+            WSphericalHarmonicsBasis< double >::evaluate( m_baseMatrix, m_coefficients[ i ], &values );
+            for( size_t j = 0; j < values.size(); ++j )
+            {
+                sum += values[ j ];
+            }
+        }
+        consume( sum );
+        return m_coefficients.size() * m_baseMatrix.getNbRows();
+    }
+
+    /**
+     * Frees the data.
+     */
+    virtual void tearDown()
+    {
+        m_coefficients.clear();
+    }
+
+private:
+    /**
+     * The coefficients of the functions.
+     */
+    std::vector< WValue< double > > m_coefficients;
+
+    /**
+     * The basis evaluated at the directions.
+     */
+    WMatrix< double > m_baseMatrix;
+};
+
+/**
+ * Measures the per-voxel fitting of HARDI measurements with 60 gradients to order 4 spherical harmonics and the conversion of the order 2 part
+ * to a diffusion tensor, like done by the SH reconstruction and WMCalculateTensors.
+ */
+class WSymmetricSphericalHarmonicFitBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSymmetricSphericalHarmonicFitBenchmark():
+        WBenchmark( "WSymmetricSphericalHarmonic::fitTensor" ),
+        m_fittingMatrix( 1, 1 ),
+        m_toTensorMatrix( 1, 1 )
+    {
+        addSize( 10000 );
+        addSize( 100000 );
+    }
+
+    /**
+     * Creates the fitting matrices and size random measurements.
+     *
+     * \param size number of voxels
+     */
+    virtual void setUp( size_t size )
+    {
+        std::vector< WUnitSphereCoordinates< double > > gradients = randomDirections( 60, 42 );
+        m_fittingMatrix = WSymmetricSphericalHarmonic< double >::getSHFittingMatrix( gradients, 4, 0.006, false );
+        m_toTensorMatrix = WSymmetricSphericalHarmonic< double >::calcSHToTensorSymMatrix( 2 );
+
+        boost::random::mt19937 rng( 23 );
+        boost::random::uniform_real_distribution<> signal( 0.1, 1.0 );
+        m_measurements.resize( size * gradients.size() );
+        for( size_t i = 0; i < m_measurements.size(); ++i )
+        {
+            m_measurements[ i ] = signal( rng );
+        }
+    }
+
+    /**
+     * Fits all voxels.
+     *
+     * \return number of voxels
+     */
+    virtual size_t run()
+    {
+        size_t numGradients = m_fittingMatrix.getNbCols();
+        size_t numVoxels = m_measurements.size() / numGradients;
+        WValue< double > measurement( numGradients );
+        WValue< double > order2( 6 );
+        double sum = 0.0;
+        for( size_t voxel = 0; voxel < numVoxels; ++voxel )
+        {
+            for( size_t k = 0; k < numGradients; ++k )
+            {
+                measurement[ k ] = m_measurements[ voxel * numGradients + k ];
+            }
+            WValue< double > coeffs = m_fittingMatrix * measurement;
+            for( size_t k = 0; k < 6; ++k )
+            {
+                order2[ k ] = coeffs[ k ];
+            }
+            WValue< double > tensor = m_toTensorMatrix * order2;
+            sum += tensor[ 0 ];
+        }
+        consume( sum );
+        return numVoxels;
+    }
+
+    /**
+     * Frees the measurements.
+     */
+    virtual void tearDown()
+    {
+        m_measurements.clear();
+    }
+
+private:
+    /**
+     * Maps measurements to SH coefficients.
+     */
+    WMatrix< double > m_fittingMatrix;
+
+    /**
+     * Maps order 2 SH coefficients to the tensor.
+     */
+    WMatrix< double > m_toTensorMatrix;
+
+    /**
+     * The measurements of all voxels.
+     */
+    std::vector< double > m_measurements;
+};
+
+W_REGISTER_BENCHMARK( WSymmetricSphericalHarmonicEvalBenchmark )
+W_REGISTER_BENCHMARK( WSphericalHarmonicsBasisPrecomputedBenchmark )
+W_REGISTER_BENCHMARK( WSymmetricSphericalHarmonicFitBenchmark )
@@ -0,0 +1,234 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WDIFFUSIONTENSORFIT_TEST_H
+#define WDIFFUSIONTENSORFIT_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <boost/random.hpp>
+
+#include <Eigen/Dense>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../WException.h"
+#include "../WDiffusionTensorFit.h"
+
+/**
+ * Testsuite for WDiffusionTensorFit.
+ */
+class WDiffusionTensorFitTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Noise-free measurements must be reproduced exactly by all methods.
+     */
+    void testExactMeasurements( void )
+    {
+        std::vector< WVector3d > gradients = createGradients( 30 );
+        double const tensor[ 6 ] = { 1.7e-3, 0.1e-3, -0.05e-3, 0.4e-3, 0.02e-3, 0.3e-3 }; // NOLINT
+        std::vector< double > signal = simulate( gradients, 1000.0, tensor, 800.0 );
+
+        WDiffusionTensorFit::FitMethod const methods[ 3 ] = { WDiffusionTensorFit::LOG_LINEAR, WDiffusionTensorFit::WEIGHTED_LINEAR, // NOLINT
+                                                              WDiffusionTensorFit::CONSTRAINED_NONLINEAR };
+        for( std::size_t m = 0; m < 3; ++m )
+        {
+            WDiffusionTensorFit fit( gradients, std::vector< double >( 1, 1000.0 ), methods[ m ] );
+            TS_ASSERT_EQUALS( fit.getNumMeasurements(), gradients.size() );
+            WDiffusionTensorFit::ParameterVector parameters;
+            fit.fit( &signal[ 0 ], &parameters );
+            for( std::size_t k = 0; k < 6; ++k )
+            {
+                TS_ASSERT_DELTA( parameters[ k ], tensor[ k ], 1e-9 );
+            }
+            TS_ASSERT_DELTA( std::exp( parameters[ 6 ] ), 800.0, 1e-6 );
+        }
+    }
+
+    /**
+     * The pseudo-inverse must invert the design matrix from the left.
+     */
+    void testPseudoInverse( void )
+    {
+        WDiffusionTensorFit fit( createGradients( 20 ), std::vector< double >( 1, 1000.0 ) );
+        WMatrix< double > product = fit.getPseudoInverse() * fit.getDesignMatrix();
+        for( std::size_t r = 0; r < WDiffusionTensorFit::NumParameters; ++r )
+        {
+            for( std::size_t c = 0; c < WDiffusionTensorFit::NumParameters; ++c )
+            {
+                TS_ASSERT_DELTA( product( r, c ), r == c ? 1.0 : 0.0, 1e-9 );
+            }
+        }
+    }
+
+    /**
+     * With noise, the weighted fit must be closer to the true tensor than the log-linear fit on average and the
+     * constrained fit must always yield positive semi-definite tensors, even for tensors with a zero eigenvalue.
+     */
+    void testNoisyMeasurements( void )
+    {
+        std::vector< WVector3d > gradients = createGradients( 30 );
+        double const tensor[ 6 ] = { 2.0e-3, 0.0, 0.0, 0.0, 0.0, 0.0 }; // NOLINT
+        std::vector< double > const exact = simulate( gradients, 1000.0, tensor, 100.0 );
+        WDiffusionTensorFit ols( gradients, std::vector< double >( 1, 1000.0 ), WDiffusionTensorFit::LOG_LINEAR );
+        WDiffusionTensorFit wls( gradients, std::vector< double >( 1, 1000.0 ), WDiffusionTensorFit::WEIGHTED_LINEAR );
+        WDiffusionTensorFit nlls( gradients, std::vector< double >( 1, 1000.0 ), WDiffusionTensorFit::CONSTRAINED_NONLINEAR );
+
+        boost::random::mt19937 rng( 5 );
+        boost::random::normal_distribution<> noise( 0.0, 2.0 );
+        double errorOLS = 0.0;
+        double errorWLS = 0.0;
+        std::size_t numNegative = 0;
+        for( std::size_t trial = 0; trial < 200; ++trial )
+        {
+            std::vector< double > signal( exact );
+            for( std::size_t i = 0; i < signal.size(); ++i )
+            {
+                double const re = signal[ i ] + noise( rng );
+                double const im = noise( rng );
+                signal[ i ] = std::sqrt( re * re + im * im );
+            }
+            double fitted[ 3 ][ 6 ];
+            ols.fit( &signal[ 0 ], fitted[ 0 ] );
+            wls.fit( &signal[ 0 ], fitted[ 1 ] );
+            nlls.fit( &signal[ 0 ], fitted[ 2 ] );
+            for( std::size_t k = 0; k < 6; ++k )
+            {
+                errorOLS += ( fitted[ 0 ][ k ] - tensor[ k ] ) * ( fitted[ 0 ][ k ] - tensor[ k ] );
+                errorWLS += ( fitted[ 1 ][ k ] - tensor[ k ] ) * ( fitted[ 1 ][ k ] - tensor[ k ] );
+            }
+            numNegative += smallestEigenvalue( fitted[ 1 ] ) < 0.0 ? 1 : 0;
+            TS_ASSERT_LESS_THAN_EQUALS( -1e-15, smallestEigenvalue( fitted[ 2 ] ) );
+        }
+        TS_ASSERT_LESS_THAN( errorWLS, errorOLS );
+
+        // make sure the constraint was actually needed
+        TS_ASSERT_LESS_THAN( 0u, numNegative );
+    }
+
+    /**
+     * Voxels without signal yield zero tensors.
+     */
+    void testZeroSignal( void )
+    {
+        std::vector< WVector3d > gradients = createGradients( 12 );
+        std::vector< double > signal( gradients.size(), 0.0 );
+        WDiffusionTensorFit fit( gradients, std::vector< double >( 1, 1000.0 ), WDiffusionTensorFit::CONSTRAINED_NONLINEAR );
+        double tensor[ 6 ] = { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 }; // NOLINT
+        fit.fit( &signal[ 0 ], tensor );
+        for( std::size_t k = 0; k < 6; ++k )
+        {
+            TS_ASSERT_EQUALS( tensor[ k ], 0.0 );
+        }
+    }
+
+    /**
+     * Gradient schemes that do not determine the tensor must be rejected.
+     */
+    void testInvalidSchemes( void )
+    {
+        // too few measurements
+        TS_ASSERT_THROWS( WDiffusionTensorFit( createGradients( 5 ), std::vector< double >( 1, 1000.0 ) ), WException );
+
+        // no unweighted measurement and a single shell
+        std::vector< WVector3d > gradients = createGradients( 30 );
+        gradients.erase( gradients.begin() );
+        TS_ASSERT_THROWS( WDiffusionTensorFit( gradients, std::vector< double >( 1, 1000.0 ) ), WException );
+
+        // a second shell determines the unweighted signal, too
+        std::vector< double > bValues( gradients.size(), 1000.0 );
+        for( std::size_t i = 0; i < bValues.size(); i += 2 )
+        {
+            bValues[ i ] = 2000.0;
+        }
+        TS_ASSERT_THROWS_NOTHING( WDiffusionTensorFit( gradients, bValues ) );
+
+        // wrong number of b-values
+        TS_ASSERT_THROWS( WDiffusionTensorFit( gradients, std::vector< double >( 2, 1000.0 ) ), WException );
+    }
+
+private:
+    /**
+     * Creates an unweighted measurement followed by directions spread over the hemisphere.
+     *
+     * \param count the number of weighted measurements
+     *
+     * \return the gradients
+     */
+    std::vector< WVector3d > createGradients( std::size_t count )
+    {
+        std::vector< WVector3d > gradients( 1, WVector3d( 0.0, 0.0, 0.0 ) );
+        double const goldenAngle = 3.14159265358979323846 * ( 3.0 - std::sqrt( 5.0 ) );
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            double const z = 1.0 - ( i + 0.5 ) / count;
+            double const r = std::sqrt( 1.0 - z * z );
+            gradients.push_back( WVector3d( r * std::cos( goldenAngle * i ), r * std::sin( goldenAngle * i ), z ) );
+        }
+        return gradients;
+    }
+
+    /**
+     * Computes the signal of a tensor.
+     *
+     * \param gradients the gradients
+     * \param b the b-value
+     * \param tensor the tensor components xx, xy, xz, yy, yz, zz
+     * \param s0 the unweighted signal
+     *
+     * \return the signal
+     */
+    std::vector< double > simulate( std::vector< WVector3d > const& gradients, double b, double const* tensor, double s0 )
+    {
+        std::vector< double > signal;
+        for( std::size_t i = 0; i < gradients.size(); ++i )
+        {
+            WVector3d const& g = gradients[ i ];
+            double const adc = tensor[ 0 ] * g[ 0 ] * g[ 0 ] + 2.0 * tensor[ 1 ] * g[ 0 ] * g[ 1 ] + 2.0 * tensor[ 2 ] * g[ 0 ] * g[ 2 ]
+                             + tensor[ 3 ] * g[ 1 ] * g[ 1 ] + 2.0 * tensor[ 4 ] * g[ 1 ] * g[ 2 ] + tensor[ 5 ] * g[ 2 ] * g[ 2 ];
+            signal.push_back( s0 * std::exp( -b * adc ) );
+        }
+        return signal;
+    }
+
+    /**
+     * Computes the smallest eigenvalue of a tensor.
+     *
+     * \param tensor the tensor components xx, xy, xz, yy, yz, zz
+     *
+     * \return the smallest eigenvalue
+     */
+    double smallestEigenvalue( double const* tensor )
+    {
+        Eigen::Matrix3d m;
+        m << tensor[ 0 ], tensor[ 1 ], tensor[ 2 ],
+             tensor[ 1 ], tensor[ 3 ], tensor[ 4 ],
+             tensor[ 2 ], tensor[ 4 ], tensor[ 5 ];
+        return Eigen::SelfAdjointEigenSolver< Eigen::Matrix3d >( m ).eigenvalues()( 0 );
+    }
+};
+
+#endif  // WDIFFUSIONTENSORFIT_TEST_H
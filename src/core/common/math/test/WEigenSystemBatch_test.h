@@ -0,0 +1,148 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WEIGENSYSTEMBATCH_TEST_H
+#define WEIGENSYSTEMBATCH_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/random.hpp>
+
+#include <Eigen/Dense>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WEigenSystemBatch.h"
+#include "../WTensorSym.h"
+
+/**
+ * Testsuite for WEigenSystemBatch.
+ */
+class WEigenSystemBatchTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Random tensors must be decomposed like libEigen does it, including the ones in the last, partial block.
+     */
+    void testRandomTensors( void )
+    {
+        boost::random::mt19937 rng( 17 );
+        boost::random::uniform_real_distribution<> dist( -1.0, 1.0 );
+        std::vector< WTensorSym< 2, 3, double > > tensors( 1003 );
+        WEigenSystemBatch batch( tensors.size() );
+        for( std::size_t i = 0; i < tensors.size(); ++i )
+        {
+            for( std::size_t r = 0; r < 3; ++r )
+            {
+                for( std::size_t c = r; c < 3; ++c )
+                {
+                    tensors[ i ]( r, c ) = dist( rng );
+                }
+            }
+            batch.setTensor( i, tensors[ i ] );
+        }
+        batch.compute();
+
+        for( std::size_t i = 0; i < tensors.size(); ++i )
+        {
+            checkEigenSystem( batch, i, tensors[ i ] );
+        }
+    }
+
+    /**
+     * Tensors with (nearly) coinciding eigenvalues and zero tensors must be handled, too.
+     */
+    void testDegenerateTensors( void )
+    {
+        std::vector< double > data;
+        // zero
+        double const zero[] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        // isotropic
+        double const isotropic[] = { 2.0, 0.0, 0.0, 2.0, 0.0, 2.0 };
+        // two equal eigenvalues, rotated
+        double const oblate[] = { 1.5, 0.5, 0.0, 1.5, 0.0, 3.0 };
+        // nearly equal eigenvalues, typical DTI magnitude
+        double const prolate[] = { 1.7e-3, 1e-9, 2e-9, 3.0e-4, 1e-12, 3.0e-4 };
+        data.insert( data.end(), zero, zero + 6 );
+        data.insert( data.end(), isotropic, isotropic + 6 );
+        data.insert( data.end(), oblate, oblate + 6 );
+        data.insert( data.end(), prolate, prolate + 6 );
+
+        WEigenSystemBatch batch( 4 );
+        batch.setTensors( 0, &data[ 0 ], 4 );
+        batch.compute();
+        TS_ASSERT( batch.getNumFallbacks() >= 2 );
+
+        for( std::size_t i = 0; i < 4; ++i )
+        {
+            WTensorSym< 2, 3, double > t;
+            t( 0, 0 ) = data[ 6 * i ];
+            t( 0, 1 ) = data[ 6 * i + 1 ];
+            t( 0, 2 ) = data[ 6 * i + 2 ];
+            t( 1, 1 ) = data[ 6 * i + 3 ];
+            t( 1, 2 ) = data[ 6 * i + 4 ];
+            t( 2, 2 ) = data[ 6 * i + 5 ];
+            checkEigenSystem( batch, i, t );
+        }
+        TS_ASSERT_DELTA( batch.getFA( 0 ), 0.0, 1e-12 );
+        TS_ASSERT_DELTA( batch.getFA( 1 ), 0.0, 1e-12 );
+        TS_ASSERT_DELTA( batch.getEigenvector( 0, 2 )[ 2 ], 1.0, 1e-12 );
+    }
+
+private:
+    /**
+     * Compares the eigen system of a tensor with libEigen's result. Eigenvectors are checked via T v = lambda v and
+     * orthonormality, as they are not unique for coinciding eigenvalues.
+     *
+     * \param batch the computed batch
+     * \param i the index of the tensor
+     * \param t the tensor
+     */
+    void checkEigenSystem( WEigenSystemBatch const& batch, std::size_t i, WTensorSym< 2, 3, double > const& t ) const
+    {
+        Eigen::Matrix3d m;
+        m << t( 0, 0 ), t( 0, 1 ), t( 0, 2 ),
+             t( 1, 0 ), t( 1, 1 ), t( 1, 2 ),
+             t( 2, 0 ), t( 2, 1 ), t( 2, 2 );
+        Eigen::SelfAdjointEigenSolver< Eigen::Matrix3d > solver( m );
+        double const scale = std::max( 1.0, m.norm() ) * ( m.norm() > 0.0 ? m.norm() : 1.0 );
+        for( std::size_t k = 0; k < 3; ++k )
+        {
+            TS_ASSERT_DELTA( batch.getEigenvalue( i, k ), solver.eigenvalues()( k ), 1e-9 * scale );
+            WVector3d v = batch.getEigenvector( i, k );
+            Eigen::Vector3d ev( v[ 0 ], v[ 1 ], v[ 2 ] );
+            TS_ASSERT_DELTA( ev.norm(), 1.0, 1e-9 );
+            TS_ASSERT_LESS_THAN( ( m * ev - batch.getEigenvalue( i, k ) * ev ).norm(), 1e-6 * scale );
+            for( std::size_t j = 0; j < k; ++j )
+            {
+                WVector3d w = batch.getEigenvector( i, j );
+                TS_ASSERT_DELTA( v[ 0 ] * w[ 0 ] + v[ 1 ] * w[ 1 ] + v[ 2 ] * w[ 2 ], 0.0, 1e-6 );
+            }
+        }
+    }
+};
+
+#endif  // WEIGENSYSTEMBATCH_TEST_H
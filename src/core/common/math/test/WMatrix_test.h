@@ -25,6 +25,8 @@
 #ifndef WMATRIX_TEST_H
 #define WMATRIX_TEST_H
 
+#include <utility>
+
 #include <cxxtest/TestSuite.h>
 
 #include "../WMatrix.h"
@@ -224,6 +226,31 @@ public:
         TS_ASSERT_EQUALS( matrix3 == matrix4, true );
     }
 
+    /**
+     * Moving a matrix takes over its components and columns and leaves an empty matrix without columns.
+     */
+    void testMove( void )
+    {
+        WMatrix< double > matrix( 3, 2 );
+        matrix( 2, 1 ) = 4.5;
+        WMatrix< double > original( matrix );
+
+        WMatrix< double > moved( std::move( matrix ) );
+        TS_ASSERT_EQUALS( moved, original );
+        TS_ASSERT_EQUALS( moved.getNbRows(), 3 );
+        TS_ASSERT_EQUALS( moved.getNbCols(), 2 );
+        TS_ASSERT_EQUALS( matrix.size(), 0 );
+        TS_ASSERT_EQUALS( matrix.getNbCols(), 0 );
+        TS_ASSERT_EQUALS( matrix.getNbRows(), 0 );
+
+        WMatrix< double > assigned( 1, 1 );
+        assigned = std::move( moved );
+        TS_ASSERT_EQUALS( assigned, original );
+        TS_ASSERT_EQUALS( moved.size(), 0 );
+        TS_ASSERT_EQUALS( moved.getNbCols(), 0 );
+        TS_ASSERT_EQUALS( moved.getNbRows(), 0 );
+    }
+
     /**
      * Test transposed method of WMatrix
      */
@@ -0,0 +1,144 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSPHERICALHARMONICSBASIS_TEST_H
+#define WSPHERICALHARMONICSBASIS_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <boost/math/special_functions/spherical_harmonic.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WMatrix.h"
+#include "../WSphericalHarmonicsBasis.h"
+#include "../WSymmetricSphericalHarmonic.h"
+#include "../WUnitSphereCoordinates.h"
+#include "../WValue.h"
+
+/**
+ * Testsuite for WSphericalHarmonicsBasis.
+ */
+class WSphericalHarmonicsBasisTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * The basis values must match the ones calculated with boost::math, also for angles outside [0, pi] and for
+     * higher orders.
+     */
+    void testBasisMatchesBoost( void )
+    {
+        WSphericalHarmonicsBasis< double > basis( 16 );
+        for( int order = 0; order <= 16; order += 2 )
+        {
+            std::vector< double > values( WSphericalHarmonicsBasis< double >::getNumCoefficients( order ) );
+            for( double theta = -3.5; theta < 7.0; theta += 0.37 )
+            {
+                for( double phi = -1.0; phi < 7.0; phi += 0.53 )
+                {
+                    basis.evaluateBasis( order, theta, phi, &values[ 0 ] );
+                    std::vector< double > reference = referenceBasis( order, theta, phi );
+                    for( std::size_t j = 0; j < values.size(); ++j )
+                    {
+                        TS_ASSERT_DELTA( values[ j ], reference[ j ], 1e-9 );
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Evaluating an SH directly, in batches and via a precomputed basis matrix must give the same values.
+     */
+    void testEvaluate( void )
+    {
+        std::size_t const order = 6;
+        WValue< double > coefficients( WSphericalHarmonicsBasis< double >::getNumCoefficients( order ) );
+        for( std::size_t j = 0; j < coefficients.size(); ++j )
+        {
+            coefficients[ j ] = std::sin( 1.0 + j );
+        }
+
+        std::vector< WUnitSphereCoordinates< double > > directions;
+        for( double theta = 0.0; theta <= 3.2; theta += 0.4 )
+        {
+            for( double phi = 0.0; phi < 6.3; phi += 0.7 )
+            {
+                directions.push_back( WUnitSphereCoordinates< double >( theta, phi ) );
+            }
+        }
+
+        WSphericalHarmonicsBasis< double > const& basis = WSphericalHarmonicsBasis< double >::getDefault();
+        std::vector< double > batch;
+        basis.evaluate( coefficients, order, directions, &batch );
+        std::vector< double > precomputed;
+        WSphericalHarmonicsBasis< double >::evaluate( basis.calcBaseMatrix( directions, order ), coefficients, &precomputed );
+
+        TS_ASSERT_EQUALS( batch.size(), directions.size() );
+        TS_ASSERT_EQUALS( precomputed.size(), directions.size() );
+        WSymmetricSphericalHarmonic< double > sh( coefficients );
+        for( std::size_t i = 0; i < directions.size(); ++i )
+        {
+            std::vector< double > reference = referenceBasis( order, directions[ i ].getTheta(), directions[ i ].getPhi() );
+            double expected = 0.0;
+            for( std::size_t j = 0; j < reference.size(); ++j )
+            {
+                expected += coefficients[ j ] * reference[ j ];
+            }
+            TS_ASSERT_DELTA( batch[ i ], expected, 1e-9 );
+            TS_ASSERT_DELTA( precomputed[ i ], expected, 1e-9 );
+            TS_ASSERT_DELTA( sh.getValue( directions[ i ] ), expected, 1e-9 );
+        }
+    }
+
+private:
+    /**
+     * Calculates the basis values with boost::math like WSymmetricSphericalHarmonic used to.
+     *
+     * \param order the order
+     * \param theta angle for the position on the unit sphere
+     * \param phi angle for the position on the unit sphere
+     *
+     * \return the basis values
+     */
+    std::vector< double > referenceBasis( int order, double theta, double phi ) const
+    {
+        std::vector< double > result( ( order + 1 ) * ( order + 2 ) / 2 );
+        const double rootOf2 = std::sqrt( 2.0 );
+        for( int k = 0; k <= order; k += 2 )
+        {
+            int const center = ( k * k + k + 2 ) / 2 - 1;
+            for( int m = 1; m <= k; m++ )
+            {
+                result[ center + m ] = rootOf2 * std::pow( -1.0, m + 1 ) * boost::math::spherical_harmonic_i( k, m, theta, phi );
+                result[ center - m ] = rootOf2 * boost::math::spherical_harmonic_r( k, m, theta, phi );
+            }
+            result[ center ] = boost::math::spherical_harmonic_r( k, 0, theta, phi );
+        }
+        return result;
+    }
+};
+
+#endif  // WSPHERICALHARMONICSBASIS_TEST_H
@@ -0,0 +1,215 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSPHERICALHARMONICSFITPLAN_TEST_H
+#define WSPHERICALHARMONICSFITPLAN_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../exceptions/WPreconditionNotMet.h"
+#include "../../WLogger.h"
+#include "../WSphericalHarmonicsFitPlan.h"
+#include "../WSymmetricSphericalHarmonic.h"
+
+/**
+ * Testsuite for WSphericalHarmonicsFitPlan.
+ */
+class WSphericalHarmonicsFitPlanTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Setup logger for each test.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * The fitting matrices must equal those of WSymmetricSphericalHarmonic.
+     */
+    void testFittingMatrices( void )
+    {
+        std::vector< WVector3d > gradients = createGradients( 60 );
+
+        WSphericalHarmonicsFitPlan plan( gradients, 6, 0.006, WSphericalHarmonicsFitPlan::DEFAULT );
+        assertMatrixEquals( plan.getFittingMatrix(), WSymmetricSphericalHarmonic< double >::getSHFittingMatrix( gradients, 6, 0.006, false ) );
+
+        WSphericalHarmonicsFitPlan frt( gradients, 4, 0.1, WSphericalHarmonicsFitPlan::FUNK_RADON );
+        assertMatrixEquals( frt.getFittingMatrix(), WSymmetricSphericalHarmonic< double >::getSHFittingMatrix( gradients, 4, 0.1, true ) );
+
+        WSphericalHarmonicsFitPlan csa( gradients, 4, 0.006, WSphericalHarmonicsFitPlan::CONSTANT_SOLID_ANGLE );
+        assertMatrixEquals( csa.getFittingMatrix(),
+                            WSymmetricSphericalHarmonic< double >::getSHFittingMatrixForConstantSolidAngle( gradients, 4, 0.006 ) );
+
+        TS_ASSERT_EQUALS( plan.getNumCoefficients(), 28 );
+        TS_ASSERT_EQUALS( plan.getNumMeasurements(), 60 );
+        TS_ASSERT_EQUALS( plan.getOrder(), 6 );
+    }
+
+    /**
+     * Plans of lower orders derived from a cached basis of a higher order must equal directly built plans.
+     */
+    void testLowerOrderFromCache( void )
+    {
+        WSphericalHarmonicsFitPlan::clearCache();
+        std::vector< WVector3d > gradients = createGradients( 45 );
+
+        WSphericalHarmonicsFitPlan::get( gradients, 8, 0.0, WSphericalHarmonicsFitPlan::DEFAULT );
+        boost::shared_ptr< WSphericalHarmonicsFitPlan const > cached = WSphericalHarmonicsFitPlan::get( gradients, 4, 0.5,
+                                                                                                        WSphericalHarmonicsFitPlan::FUNK_RADON );
+        WSphericalHarmonicsFitPlan direct( gradients, 4, 0.5, WSphericalHarmonicsFitPlan::FUNK_RADON );
+        assertMatrixEquals( cached->getFittingMatrix(), direct.getFittingMatrix() );
+        assertMatrixEquals( cached->getBaseMatrix(), direct.getBaseMatrix() );
+    }
+
+    /**
+     * Equal parameters must yield the same plan, different parameters a new one.
+     */
+    void testCache( void )
+    {
+        WSphericalHarmonicsFitPlan::clearCache();
+        TS_ASSERT_EQUALS( WSphericalHarmonicsFitPlan::getNumCachedPlans(), 0 );
+
+        std::vector< WVector3d > gradients = createGradients( 30 );
+        boost::shared_ptr< WSphericalHarmonicsFitPlan const > a = WSphericalHarmonicsFitPlan::get( gradients, 4, 0.1,
+                                                                                                   WSphericalHarmonicsFitPlan::DEFAULT );
+        TS_ASSERT_EQUALS( a, WSphericalHarmonicsFitPlan::get( gradients, 4, 0.1, WSphericalHarmonicsFitPlan::DEFAULT ) );
+        TS_ASSERT_DIFFERS( a, WSphericalHarmonicsFitPlan::get( gradients, 4, 0.2, WSphericalHarmonicsFitPlan::DEFAULT ) );
+        TS_ASSERT_DIFFERS( a, WSphericalHarmonicsFitPlan::get( gradients, 4, 0.1, WSphericalHarmonicsFitPlan::FUNK_RADON ) );
+
+        gradients[ 3 ][ 0 ] += 1e-3;
+        TS_ASSERT_DIFFERS( a, WSphericalHarmonicsFitPlan::get( gradients, 4, 0.1, WSphericalHarmonicsFitPlan::DEFAULT ) );
+        TS_ASSERT_EQUALS( WSphericalHarmonicsFitPlan::getNumCachedPlans(), 4 );
+
+        for( std::size_t i = 0; i < 2 * WSphericalHarmonicsFitPlan::MaxCachedPlans; ++i )
+        {
+            WSphericalHarmonicsFitPlan::get( gradients, 2, static_cast< double >( i ), WSphericalHarmonicsFitPlan::DEFAULT );
+        }
+        TS_ASSERT_EQUALS( WSphericalHarmonicsFitPlan::getNumCachedPlans(), WSphericalHarmonicsFitPlan::MaxCachedPlans );
+
+        WSphericalHarmonicsFitPlan::clearCache();
+        TS_ASSERT_EQUALS( WSphericalHarmonicsFitPlan::getNumCachedPlans(), 0 );
+    }
+
+    /**
+     * The blocked products must equal the matrix-vector products for every voxel.
+     */
+    void testFitAndReproject( void )
+    {
+        std::vector< WVector3d > gradients = createGradients( 70 );
+        WSphericalHarmonicsFitPlan plan( gradients, 6, 0.01, WSphericalHarmonicsFitPlan::DEFAULT );
+        std::size_t const N = plan.getNumMeasurements();
+        std::size_t const R = plan.getNumCoefficients();
+
+        // not a multiple of the block size
+        std::size_t const numVoxels = 2 * WSphericalHarmonicsFitPlan::BlockSize + 5;
+        std::vector< double > measurements( numVoxels * N );
+        for( std::size_t i = 0; i < measurements.size(); ++i )
+        {
+            measurements[ i ] = std::sin( 0.37 * static_cast< double >( i ) ) + 1.5;
+        }
+        std::vector< double > coefficients( numVoxels * R );
+        plan.fit( &measurements[ 0 ], numVoxels, &coefficients[ 0 ] );
+        std::vector< double > fitted( numVoxels * N );
+        plan.reproject( &coefficients[ 0 ], numVoxels, &fitted[ 0 ] );
+
+        for( std::size_t v = 0; v < numVoxels; ++v )
+        {
+            WValue< double > x( N );
+            for( std::size_t i = 0; i < N; ++i )
+            {
+                x[ i ] = measurements[ v * N + i ];
+            }
+            WValue< double > c = plan.getFittingMatrix() * x;
+            WValue< double > y = plan.getBaseMatrix() * c;
+            for( std::size_t j = 0; j < R; ++j )
+            {
+                TS_ASSERT_DELTA( coefficients[ v * R + j ], c[ j ], 1e-12 );
+            }
+            for( std::size_t i = 0; i < N; ++i )
+            {
+                TS_ASSERT_DELTA( fitted[ v * N + i ], y[ i ], 1e-12 );
+            }
+        }
+    }
+
+    /**
+     * Odd or negative orders and empty gradient tables are rejected.
+     */
+    void testInvalidParameters( void )
+    {
+        std::vector< WVector3d > gradients = createGradients( 30 );
+        TS_ASSERT_THROWS( WSphericalHarmonicsFitPlan( gradients, 3, 0.0, WSphericalHarmonicsFitPlan::DEFAULT ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( WSphericalHarmonicsFitPlan::get( gradients, -2, 0.0, WSphericalHarmonicsFitPlan::DEFAULT ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( WSphericalHarmonicsFitPlan::get( std::vector< WVector3d >(), 2, 0.0, WSphericalHarmonicsFitPlan::DEFAULT ),
+                          WPreconditionNotMet );
+    }
+
+private:
+    /**
+     * Creates evenly spread directions on a hemisphere.
+     *
+     * \param count the number of directions
+     *
+     * \return the directions
+     */
+    std::vector< WVector3d > createGradients( std::size_t count )
+    {
+        std::vector< WVector3d > gradients;
+        double const golden = 3.14159265358979323846 * ( 3.0 - std::sqrt( 5.0 ) );
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            double const z = 1.0 - ( static_cast< double >( i ) + 0.5 ) / static_cast< double >( count );
+            double const r = std::sqrt( 1.0 - z * z );
+            double const phi = golden * static_cast< double >( i );
+            gradients.push_back( WVector3d( r * std::cos( phi ), r * std::sin( phi ), z ) );
+        }
+        return gradients;
+    }
+
+    /**
+     * Compares two matrices.
+     *
+     * \param a the first matrix
+     * \param b the second matrix
+     */
+    void assertMatrixEquals( WMatrix< double > const& a, WMatrix< double > const& b )
+    {
+        TS_ASSERT_EQUALS( a.getNbRows(), b.getNbRows() );
+        TS_ASSERT_EQUALS( a.getNbCols(), b.getNbCols() );
+        for( std::size_t i = 0; i < a.getNbRows() && i < b.getNbRows(); ++i )
+        {
+            for( std::size_t j = 0; j < a.getNbCols() && j < b.getNbCols(); ++j )
+            {
+                TS_ASSERT_DELTA( a( i, j ), b( i, j ), 1e-9 * ( 1.0 + std::fabs( b( i, j ) ) ) );
+            }
+        }
+    }
+};
+
+#endif  // WSPHERICALHARMONICSFITPLAN_TEST_H
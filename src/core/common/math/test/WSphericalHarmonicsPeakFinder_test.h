@@ -0,0 +1,231 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSPHERICALHARMONICSPEAKFINDER_TEST_H
+#define WSPHERICALHARMONICSPEAKFINDER_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../exceptions/WPreconditionNotMet.h"
+#include "../WSphericalHarmonicsFitPlan.h"
+#include "../WSphericalHarmonicsPeakFinder.h"
+#include "../WSymmetricSphericalHarmonic.h"
+
+/**
+ * Testsuite for WSphericalHarmonicsPeakFinder.
+ */
+class WSphericalHarmonicsPeakFinderTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * The seed directions are one hemisphere of the tessellation.
+     */
+    void testDirections( void )
+    {
+        WSphericalHarmonicsPeakFinder finder( 4, 3, 0.5, 0.35, 2 );
+        TS_ASSERT_EQUALS( finder.getDirections().size(), 81 );
+        for( std::size_t i = 0; i < finder.getDirections().size(); ++i )
+        {
+            TS_ASSERT_DELTA( length( finder.getDirections()[ i ] ), 1.0, 1e-12 );
+            for( std::size_t j = 0; j < i; ++j )
+            {
+                TS_ASSERT_LESS_THAN( dot( finder.getDirections()[ i ], finder.getDirections()[ j ] ), 0.999 );
+                TS_ASSERT_LESS_THAN( -0.999, dot( finder.getDirections()[ i ], finder.getDirections()[ j ] ) );
+            }
+        }
+        TS_ASSERT_EQUALS( WSphericalHarmonicsPeakFinder( 8, 3 ).getDirections().size(), 321 );
+    }
+
+    /**
+     * Crossing fibers yield one peak per fiber, ordered by their weight.
+     */
+    void testCrossingFibers( void )
+    {
+        WVector3d const u = normalize( WVector3d( 1.0, 0.2, 0.1 ) );
+        WVector3d const w = normalize( cross( u, WVector3d( 0.0, 0.3, 1.0 ) ) );
+        std::vector< WVector3d > fibers;
+        fibers.push_back( u );
+        fibers.push_back( w );
+        std::vector< double > weights;
+        weights.push_back( 0.8 );
+        weights.push_back( 1.0 );
+        std::vector< double > coefficients = createODF( fibers, weights, 8 );
+
+        WSphericalHarmonicsPeakFinder finder( 8, 3 );
+        std::vector< float > peaks( 3 * WSphericalHarmonicsPeakFinder::ValuesPerPeak );
+        finder.findPeaks( &coefficients[ 0 ], 1, &peaks[ 0 ] );
+
+        // the larger fiber comes first
+        TS_ASSERT_LESS_THAN( std::cos( 2.0 * 3.14159265358979 / 180.0 ), std::fabs( dot( peakDirection( peaks, 0 ), w ) ) );
+        TS_ASSERT_LESS_THAN( std::cos( 2.0 * 3.14159265358979 / 180.0 ), std::fabs( dot( peakDirection( peaks, 1 ), u ) ) );
+        TS_ASSERT_LESS_THAN( peaks[ 7 ], peaks[ 3 ] );
+        TS_ASSERT_LESS_THAN( 0.0f, peaks[ 7 ] );
+
+        // no third peak
+        for( std::size_t k = 8; k < 12; ++k )
+        {
+            TS_ASSERT_EQUALS( peaks[ k ], 0.0f );
+        }
+    }
+
+    /**
+     * The refined peaks are maxima of the function, the values are the function values.
+     */
+    void testRefinement( void )
+    {
+        std::vector< WVector3d > fibers( 1, normalize( WVector3d( 0.3, -0.5, 0.8 ) ) );
+        std::vector< double > coefficients = createODF( fibers, std::vector< double >( 1, 1.0 ), 6 );
+
+        WSphericalHarmonicsPeakFinder finder( 6, 2 );
+        std::vector< float > peaks( 2 * WSphericalHarmonicsPeakFinder::ValuesPerPeak );
+        finder.findPeaks( &coefficients[ 0 ], 1, &peaks[ 0 ] );
+        WVector3d const peak = peakDirection( peaks, 0 );
+        TS_ASSERT_LESS_THAN( std::cos( 1.0 * 3.14159265358979 / 180.0 ), std::fabs( dot( peak, fibers[ 0 ] ) ) );
+        TS_ASSERT_EQUALS( peaks[ 7 ], 0.0f );
+
+        WSymmetricSphericalHarmonic< double > sh( toWValue( coefficients ) );
+        double const value = sh.getValue( WUnitSphereCoordinates< double >( peak ) );
+        TS_ASSERT_DELTA( peaks[ 3 ], value, 1e-5 * std::fabs( value ) );
+        for( double angle = -0.02; angle <= 0.02; angle += 0.01 )
+        {
+            WVector3d const moved = normalize( peak + angle * normalize( cross( peak, WVector3d( 0.0, 0.0, 1.0 ) ) ) );
+            TS_ASSERT_LESS_THAN_EQUALS( sh.getValue( WUnitSphereCoordinates< double >( moved ) ), value + 1e-9 );
+        }
+    }
+
+    /**
+     * Many voxels at once give the same results as one voxel at a time, and maxPeaks limits the number of peaks.
+     */
+    void testBatch( void )
+    {
+        std::size_t const numVoxels = WSphericalHarmonicsPeakFinder::BlockSize + 3;
+        std::vector< double > coefficients;
+        for( std::size_t v = 0; v < numVoxels; ++v )
+        {
+            double const a = 0.1 * static_cast< double >( v );
+            std::vector< WVector3d > fibers;
+            fibers.push_back( normalize( WVector3d( std::cos( a ), std::sin( a ), 0.3 ) ) );
+            fibers.push_back( normalize( WVector3d( -std::sin( a ), std::cos( a ), 0.1 ) ) );
+            std::vector< double > weights;
+            weights.push_back( 1.0 );
+            weights.push_back( 0.7 + 0.005 * static_cast< double >( v ) );
+            std::vector< double > c = createODF( fibers, weights, 8 );
+            coefficients.insert( coefficients.end(), c.begin(), c.end() );
+        }
+
+        WSphericalHarmonicsPeakFinder finder( 8, 1 );
+        std::vector< float > peaks( numVoxels * WSphericalHarmonicsPeakFinder::ValuesPerPeak );
+        finder.findPeaks( &coefficients[ 0 ], numVoxels, &peaks[ 0 ] );
+        for( std::size_t v = 0; v < numVoxels; ++v )
+        {
+            std::vector< float > single( WSphericalHarmonicsPeakFinder::ValuesPerPeak );
+            finder.findPeaks( &coefficients[ v * finder.getNumCoefficients() ], 1, &single[ 0 ] );
+            for( std::size_t k = 0; k < WSphericalHarmonicsPeakFinder::ValuesPerPeak; ++k )
+            {
+                TS_ASSERT_EQUALS( peaks[ v * WSphericalHarmonicsPeakFinder::ValuesPerPeak + k ], single[ k ] );
+            }
+            TS_ASSERT_LESS_THAN( 0.0f, single[ 3 ] );
+        }
+    }
+
+    /**
+     * Odd orders and zero peaks are rejected.
+     */
+    void testInvalidParameters( void )
+    {
+        TS_ASSERT_THROWS( WSphericalHarmonicsPeakFinder( 3, 2 ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( WSphericalHarmonicsPeakFinder( 4, 0 ), WPreconditionNotMet );
+    }
+
+private:
+    /**
+     * Fits an SH to a sum of sharp lobes.
+     *
+     * \param fibers the directions of the lobes
+     * \param weights the heights of the lobes
+     * \param order the order of the SH
+     *
+     * \return the coefficients
+     */
+    std::vector< double > createODF( std::vector< WVector3d > const& fibers, std::vector< double > const& weights, int order )
+    {
+        std::vector< WVector3d > samples;
+        std::vector< double > values;
+        std::size_t const count = 400;
+        double const golden = 3.14159265358979323846 * ( 3.0 - std::sqrt( 5.0 ) );
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            double const z = 1.0 - ( static_cast< double >( i ) + 0.5 ) / static_cast< double >( count );
+            double const r = std::sqrt( 1.0 - z * z );
+            double const phi = golden * static_cast< double >( i );
+            samples.push_back( WVector3d( r * std::cos( phi ), r * std::sin( phi ), z ) );
+            double value = 0.0;
+            for( std::size_t f = 0; f < fibers.size(); ++f )
+            {
+                value += weights[ f ] * std::pow( dot( samples.back(), fibers[ f ] ), 8 );
+            }
+            values.push_back( value );
+        }
+        WSphericalHarmonicsFitPlan plan( samples, order, 0.0, WSphericalHarmonicsFitPlan::DEFAULT );
+        std::vector< double > coefficients( plan.getNumCoefficients() );
+        plan.fit( &values[ 0 ], 1, &coefficients[ 0 ] );
+        return coefficients;
+    }
+
+    /**
+     * Extracts the direction of a peak.
+     *
+     * \param peaks the peaks of a voxel
+     * \param k the index of the peak
+     *
+     * \return the direction
+     */
+    WVector3d peakDirection( std::vector< float > const& peaks, std::size_t k )
+    {
+        std::size_t const i = k * WSphericalHarmonicsPeakFinder::ValuesPerPeak;
+        return WVector3d( peaks[ i ], peaks[ i + 1 ], peaks[ i + 2 ] );
+    }
+
+    /**
+     * Copies coefficients into a WValue.
+     *
+     * \param coefficients the coefficients
+     *
+     * \return the WValue
+     */
+    WValue< double > toWValue( std::vector< double > const& coefficients )
+    {
+        WValue< double > result( coefficients.size() );
+        for( std::size_t i = 0; i < coefficients.size(); ++i )
+        {
+            result[ i ] = coefficients[ i ];
+        }
+        return result;
+    }
+};
+
+#endif  // WSPHERICALHARMONICSPEAKFINDER_TEST_H
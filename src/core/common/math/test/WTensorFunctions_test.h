@@ -431,22 +431,22 @@ public:
         TS_ASSERT_DELTA( d[ 1 ], 2.0, 1e-6 );
         TS_ASSERT_DELTA( d[ 2 ], 1.0, 1e-6 );
 
-        // the eigenvalues calculated for this test are a bit off
-        //t = WTensorSym< 2, 3 >();
-        //t( 0, 0 ) = 2;
-        //t( 1, 1 ) = 1;
-        //t( 2, 2 ) = 3;
-
-        //t = similarity_rotate_givens( t, 0, 2, 2.79 );
-        //t = similarity_rotate_givens( t, 1, 2, -3.44 );
-        //t = similarity_rotate_givens( t, 1, 0, -0.46 );
-        //t = similarity_rotate_givens( t, 2, 1, 5.98 );
-
-        //d = getEigenvaluesCardano( t );
-
-        //TS_ASSERT_DELTA( d[ 0 ], 3.0, 1e-6 );
-        //TS_ASSERT_DELTA( d[ 1 ], 2.0, 1e-6 );
-        //TS_ASSERT_DELTA( d[ 2 ], 1.0, 1e-6 );
+        // rotations around several axes, this needs the correct determinant
+        t = WTensorSym< 2, 3 >();
+        t( 0, 0 ) = 2;
+        t( 1, 1 ) = 1;
+        t( 2, 2 ) = 3;
+
+        t = similarity_rotate_givens( t, 0, 2, 2.79 );
+        t = similarity_rotate_givens( t, 1, 2, -3.44 );
+        t = similarity_rotate_givens( t, 1, 0, -0.46 );
+        t = similarity_rotate_givens( t, 2, 1, 5.98 );
+
+        d = getEigenvaluesCardano( t );
+
+        TS_ASSERT_DELTA( d[ 0 ], 3.0, 1e-6 );
+        TS_ASSERT_DELTA( d[ 1 ], 2.0, 1e-6 );
+        TS_ASSERT_DELTA( d[ 2 ], 1.0, 1e-6 );
 
         t = WTensorSym< 2, 3 >();
         t( 0, 0 ) = 2;
@@ -26,6 +26,7 @@
 #define WVALUE_TEST_H
 
 #include <string>
+#include <utility>
 
 #include <cxxtest/TestSuite.h>
 
@@ -666,6 +667,72 @@ public:
         val[2] = 3.0;
         TS_ASSERT_EQUALS( val.mean(), 2.0 );
     }
+
+    /**
+     * The coefficients of spherical harmonics of order 8 and 6x6 matrices are stored inside the value.
+     */
+    void testInlineStorage( void )
+    {
+        WValue< double > coefficients( 45 );
+        char const* begin = reinterpret_cast< char const* >( &coefficients );
+        char const* storage = reinterpret_cast< char const* >( &coefficients[ 0 ] );
+        TS_ASSERT( storage >= begin && storage < begin + sizeof( coefficients ) );
+
+        WValue< double > matrix( 36 );
+        begin = reinterpret_cast< char const* >( &matrix );
+        storage = reinterpret_cast< char const* >( &matrix[ 0 ] );
+        TS_ASSERT( storage >= begin && storage < begin + sizeof( matrix ) );
+    }
+
+    /**
+     * Values larger than the inline capacity must behave the same and moving them must keep their storage.
+     */
+    void testLargeValues( void )
+    {
+        const size_t size = WValue< double >::InlineCapacity + 10;
+        WValue< double > a( size );
+        for( size_t i = 0; i < size; ++i )
+        {
+            a[ i ] = static_cast< double >( i );
+        }
+        WValue< double > b( a );
+        TS_ASSERT_EQUALS( a, b );
+        b[ size - 1 ] = 0.0;
+        TS_ASSERT_DIFFERS( a, b );
+        TS_ASSERT_EQUALS( a[ size - 1 ], static_cast< double >( size - 1 ) );
+
+        double const* storage = &a[ 0 ];
+        WValue< double > c( std::move( a ) );
+        TS_ASSERT_EQUALS( &c[ 0 ], storage );
+        TS_ASSERT_EQUALS( c.size(), size );
+        TS_ASSERT_EQUALS( a.size(), 0 );
+    }
+
+    /**
+     * Chains of operators must give the same results when they reuse temporaries.
+     */
+    void testOperatorChains( void )
+    {
+        const size_t size = WValue< double >::InlineCapacity + 1;
+        WValue< double > a( size );
+        WValue< double > b( size );
+        WValue< double > c( size );
+        for( size_t i = 0; i < size; ++i )
+        {
+            a[ i ] = 1.0 * i;
+            b[ i ] = 2.0;
+            c[ i ] = 0.5 * i;
+        }
+        WValue< double > result = ( a + b - c ) * 2.0 / 4.0;
+        WValue< double > product = ( a + b ) * c;
+        for( size_t i = 0; i < size; ++i )
+        {
+            TS_ASSERT_DELTA( result[ i ], ( 1.0 * i + 2.0 - 0.5 * i ) * 0.5, delta );
+            TS_ASSERT_DELTA( product[ i ], ( 1.0 * i + 2.0 ) * 0.5 * i, delta );
+        }
+        TS_ASSERT_EQUALS( a[ 1 ], 1.0 );
+        TS_ASSERT_EQUALS( b[ 1 ], 2.0 );
+    }
 };
 
 #endif  // WVALUE_TEST_H
@@ -0,0 +1,204 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMEMORYBUDGET_TEST_H
+#define WMEMORYBUDGET_TEST_H
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../exceptions/WOutOfMemoryBudget.h"
+#include "../WLogger.h"
+#include "../WMemoryBudget.h"
+#include "../WMemoryReservation.h"
+
+/**
+ * Tests the memory budget and reservations.
+ */
+class WMemoryBudgetTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Starts the logger, which is used while evicting.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * Disables the budget after each test.
+     */
+    void tearDown()
+    {
+        WMemoryBudget::getMemoryBudget()->setBudget( 0 );
+    }
+
+    /**
+     * Reservations are accounted and released.
+     */
+    void testReservation()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        size_t usage = budget->getUsage();
+        {
+            WMemoryReservation reservation( 1000, "test" );
+            TS_ASSERT_EQUALS( reservation.getSize(), 1000 );
+            TS_ASSERT_EQUALS( budget->getUsage(), usage + 1000 );
+        }
+        TS_ASSERT_EQUALS( budget->getUsage(), usage );
+    }
+
+    /**
+     * Without budget, everything can be reserved. With budget, reservations exceeding it are refused.
+     */
+    void testBudget()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        size_t usage = budget->getUsage();
+        TS_ASSERT_THROWS_NOTHING( WMemoryReservation( 1024 * 1024 * 1024, "test" ) );
+
+        budget->setBudget( usage + 1000 );
+        WMemoryReservation reservation( 600, "test" );
+        TS_ASSERT_THROWS( WMemoryReservation( 600, "test" ), WOutOfMemoryBudget );
+        TS_ASSERT_EQUALS( budget->getUsage(), usage + 600 );
+        TS_ASSERT_THROWS_NOTHING( WMemoryReservation( 400, "test" ) );
+    }
+
+    /**
+     * Caches get asked to free memory before a reservation is refused.
+     */
+    void testEviction()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        budget->setBudget( budget->getUsage() + 1000 );
+
+        m_cache = WMemoryReservation::SPtr( new WMemoryReservation( 800, "cache" ) );
+        m_missing = 0;
+        boost::signals2::connection c = budget->subscribeEviction( boost::bind( &WMemoryBudgetTest::evict, this, _1 ) );
+
+        TS_ASSERT_THROWS_NOTHING( WMemoryReservation( 500, "test" ) );
+        TS_ASSERT_EQUALS( m_missing, 300 );
+        TS_ASSERT( !m_cache );
+
+        budget->unsubscribeEviction( c );
+    }
+
+    /**
+     * Cache reservations evict other caches but are never refused.
+     */
+    void testCacheReservation()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        size_t usage = budget->getUsage();
+        budget->setBudget( usage + 1000 );
+
+        m_cache = WMemoryReservation::SPtr( new WMemoryReservation( 800, "cache" ) );
+        boost::signals2::connection c = budget->subscribeEviction( boost::bind( &WMemoryBudgetTest::evict, this, _1 ) );
+        {
+            WMemoryReservation reservation( 1500, "cache", false );
+            TS_ASSERT( !m_cache );
+            TS_ASSERT_EQUALS( budget->getUsage(), usage + 1500 );
+        }
+        budget->unsubscribeEviction( c );
+        TS_ASSERT_EQUALS( budget->getUsage(), usage );
+    }
+
+    /**
+     * Concurrent reservations never exceed the budget together.
+     */
+    void testConcurrentReservations()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        size_t usage = budget->getUsage();
+        budget->setBudget( usage + 1000 );
+
+        m_numReserved = 0;
+        boost::barrier start( 8 );
+        boost::barrier done( 8 );
+        boost::thread_group threads;
+        for( size_t i = 0; i < 8; ++i )
+        {
+            threads.create_thread( boost::bind( &WMemoryBudgetTest::reserveConcurrently, this, &start, &done ) );
+        }
+        threads.join_all();
+
+        TS_ASSERT_EQUALS( m_numReserved, 3 );
+        TS_ASSERT_EQUALS( budget->getUsage(), usage );
+    }
+
+private:
+    /**
+     * Tries to reserve 300 bytes once all threads are ready and keeps the reservation until all are done.
+     *
+     * \param start passed when all threads are ready
+     * \param done passed when all threads have tried
+     */
+    void reserveConcurrently( boost::barrier* start, boost::barrier* done )
+    {
+        start->wait();
+        try
+        {
+            WMemoryReservation reservation( 300, "test" );
+            ++m_numReserved;
+            done->wait();
+        }
+        catch( const WOutOfMemoryBudget& )
+        {
+            done->wait();
+        }
+    }
+
+    /**
+     * Eviction function freeing the cache.
+     *
+     * \param missing number of bytes missing
+     */
+    void evict( size_t missing )
+    {
+        m_missing = missing;
+        m_cache.reset();
+    }
+
+    /**
+     * A cache reservation.
+     */
+    WMemoryReservation::SPtr m_cache;
+
+    /**
+     * Bytes missing when evicting.
+     */
+    size_t m_missing;
+
+    /**
+     * The number of successful concurrent reservations.
+     */
+    boost::atomic< size_t > m_numReserved;
+};
+
+#endif  // WMEMORYBUDGET_TEST_H
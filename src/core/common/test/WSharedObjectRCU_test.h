@@ -0,0 +1,311 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSHAREDOBJECTRCU_TEST_H
+#define WSHAREDOBJECTRCU_TEST_H
+
+#include <functional>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/weak_ptr.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "../WSharedObjectRCU.h"
+#include "../WSharedSequenceContainer.h"
+
+/**
+ * Test WSharedObjectRCU
+ */
+class WSharedObjectRCUTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * An instantiation should never throw an exception, as well as tear down.
+     */
+    void testInstantiation( void )
+    {
+        WSharedObjectRCU< std::vector< int > >* obj = 0;
+
+        TS_ASSERT_THROWS_NOTHING( obj = new WSharedObjectRCU< std::vector< int > >() );
+        TS_ASSERT_THROWS_NOTHING( delete obj );
+    }
+
+    /**
+     * Writes need to be visible to readers after the write ticket has been released.
+     */
+    void testPublish()
+    {
+        WSharedObjectRCU< std::vector< int > > obj;
+        TS_ASSERT( obj.getReadTicket()->get().empty() );
+
+        {
+            WSharedObjectRCU< std::vector< int > >::WriteTicket w = obj.getWriteTicket();
+            w->get().push_back( 1 );
+            w->get().push_back( 2 );
+
+            // still unpublished
+            TS_ASSERT( obj.getReadTicket()->get().empty() );
+        }
+
+        WSharedObjectRCU< std::vector< int > >::ReadTicket r = obj.getReadTicket();
+        TS_ASSERT_EQUALS( r->get().size(), 2 );
+        TS_ASSERT_EQUALS( r->get()[ 1 ], 2 );
+    }
+
+    /**
+     * A pinned snapshot must not change, even if a newer version is published meanwhile.
+     */
+    void testSnapshotStability()
+    {
+        WSharedObjectRCU< std::vector< int > > obj( std::vector< int >( 3, 1 ) );
+
+        WSharedObjectRCU< std::vector< int > >::ReadTicket r = obj.getReadTicket();
+        obj.getWriteTicket()->get().push_back( 5 );
+
+        // the outer ticket and nested tickets still see the old version
+        TS_ASSERT_EQUALS( r->get().size(), 3 );
+        TS_ASSERT_EQUALS( obj.getReadTicket()->get().size(), 3 );
+
+        // after releasing all tickets, the new version is visible
+        r.reset();
+        TS_ASSERT_EQUALS( obj.getReadTicket()->get().size(), 4 );
+    }
+
+    /**
+     * The change condition fires on write unless suppressed.
+     */
+    void testChangeCondition()
+    {
+        m_notified = false;
+        WSharedObjectRCU< int > obj;
+        obj.getChangeCondition()->subscribeSignal( boost::bind( &WSharedObjectRCUTest::notified, this ) );
+
+        obj.getWriteTicket( true )->get() = 1;
+        TS_ASSERT( !m_notified );
+        TS_ASSERT_EQUALS( obj.getReadTicket()->get(), 1 );
+
+        obj.getWriteTicket()->get() = 2;
+        TS_ASSERT( m_notified );
+        TS_ASSERT_EQUALS( obj.getReadTicket()->get(), 2 );
+    }
+
+    /**
+     * Concurrent readers always see a consistent version while a writer keeps publishing.
+     */
+    void testConcurrentAccess()
+    {
+        WSharedObjectRCU< std::vector< int > > obj;
+        m_consistent = true;
+
+        boost::thread_group readers;
+        for( size_t i = 0; i < 4; ++i )
+        {
+            readers.create_thread( boost::bind( &WSharedObjectRCUTest::read, this, &obj ) );
+        }
+
+        for( int i = 1; i <= 100; ++i )
+        {
+            WSharedObjectRCU< std::vector< int > >::WriteTicket w = obj.getWriteTicket();
+            w->get().assign( i, i );
+        }
+
+        readers.join_all();
+        TS_ASSERT( m_consistent );
+        TS_ASSERT_EQUALS( obj.getReadTicket()->get().size(), 100 );
+    }
+
+    /**
+     * A thread that exits releases its snapshot, so old versions do not stay alive after all their readers are gone.
+     */
+    void testThreadExitReleasesSnapshot()
+    {
+        boost::shared_ptr< int > first( new int( 1 ) );
+        boost::weak_ptr< int > firstRef( first );
+        WSharedObjectRCU< boost::shared_ptr< int > > obj( first );
+        first.reset();
+
+        boost::thread reader( boost::bind( &WSharedObjectRCUTest::readOnce, this, &obj ) );
+        reader.join();
+
+        obj.getWriteTicket()->get().reset( new int( 2 ) );
+        TS_ASSERT( firstRef.expired() );
+        TS_ASSERT_EQUALS( *obj.getReadTicket()->get(), 2 );
+    }
+
+    /**
+     * Destroying the object releases the snapshots of threads which are still running.
+     */
+    void testDestructionReleasesSnapshots()
+    {
+        boost::shared_ptr< int > value( new int( 1 ) );
+        boost::weak_ptr< int > valueRef( value );
+        WSharedObjectRCU< boost::shared_ptr< int > >* obj = new WSharedObjectRCU< boost::shared_ptr< int > >( value );
+        value.reset();
+
+        boost::barrier read( 2 );
+        boost::barrier destroyed( 2 );
+        boost::thread reader( boost::bind( &WSharedObjectRCUTest::readAndWait, this, obj, &read, &destroyed ) );
+
+        read.wait();
+        delete obj;
+        TS_ASSERT( valueRef.expired() );
+        destroyed.wait();
+        reader.join();
+    }
+
+    /**
+     * A read ticket stays valid after the object has been destroyed.
+     */
+    void testTicketOutlivesObject()
+    {
+        WSharedObjectRCU< std::vector< int > >* obj = new WSharedObjectRCU< std::vector< int > >( std::vector< int >( 3, 7 ) );
+        WSharedObjectRCU< std::vector< int > >::ReadTicket r = obj->getReadTicket();
+        delete obj;
+        TS_ASSERT_EQUALS( r->get().size(), 3 );
+        TS_ASSERT_EQUALS( r->get()[ 2 ], 7 );
+    }
+
+    /**
+     * A read ticket stays valid after the thread which acquired it has exited.
+     */
+    void testTicketOutlivesThread()
+    {
+        WSharedObjectRCU< std::vector< int > > obj( std::vector< int >( 3, 7 ) );
+        WSharedObjectRCU< std::vector< int > >::ReadTicket r;
+        boost::thread reader( boost::bind( &WSharedObjectRCUTest::acquire, this, &obj, &r ) );
+        reader.join();
+
+        obj.getWriteTicket()->get().clear();
+        TS_ASSERT_EQUALS( r->get().size(), 3 );
+        TS_ASSERT_EQUALS( r->get()[ 2 ], 7 );
+        TS_ASSERT( obj.getReadTicket()->get().empty() );
+    }
+
+    /**
+     * The sequence container works on top of the RCU object and keeps snapshots of old read tickets.
+     */
+    void testSequenceContainer()
+    {
+        WSharedSequenceContainer< std::vector< int >, WSharedObjectRCU< std::vector< int > > > container;
+        container.push_back( 2 );
+        container.push_front( 1 );
+        container.unique_push_back( 2 );
+        container.push_back( 3 );
+        TS_ASSERT_EQUALS( container.size(), 3 );
+        TS_ASSERT_EQUALS( container.count( 2 ), 1 );
+
+        WSharedSequenceContainer< std::vector< int >, WSharedObjectRCU< std::vector< int > > >::ReadTicket r = container.getReadTicket();
+        container.remove( 1 );
+        container.replace( 3, 0 );
+        container.sort( std::less< int >() );
+        TS_ASSERT_EQUALS( r->get().size(), 3 );
+        TS_ASSERT_EQUALS( r->get()[ 0 ], 1 );
+        r.reset();
+
+        r = container.getReadTicket();
+        TS_ASSERT_EQUALS( r->get().size(), 2 );
+        TS_ASSERT_EQUALS( r->get()[ 0 ], 0 );
+        TS_ASSERT_EQUALS( r->get()[ 1 ], 2 );
+    }
+
+private:
+    /**
+     * Acquires a read ticket and hands it out.
+     *
+     * \param obj the object to read
+     * \param ticket the ticket is stored here
+     */
+    void acquire( WSharedObjectRCU< std::vector< int > >* obj, WSharedObjectRCU< std::vector< int > >::ReadTicket* ticket )
+    {
+        *ticket = obj->getReadTicket();
+    }
+
+    /**
+     * Reads an object once and returns.
+     *
+     * \param obj the object to read
+     */
+    void readOnce( WSharedObjectRCU< boost::shared_ptr< int > >* obj )
+    {
+        obj->getReadTicket();
+    }
+
+    /**
+     * Reads an object once and keeps the thread alive until the object has been destroyed.
+     *
+     * \param obj the object to read
+     * \param read passed after reading
+     * \param destroyed passed after the object has been destroyed
+     */
+    void readAndWait( WSharedObjectRCU< boost::shared_ptr< int > >* obj, boost::barrier* read, boost::barrier* destroyed )
+    {
+        obj->getReadTicket();
+        read->wait();
+        destroyed->wait();
+    }
+
+    /**
+     * Reader thread function. Each version consists of i elements of value i.
+     *
+     * \param obj the object to read
+     */
+    void read( WSharedObjectRCU< std::vector< int > >* obj )
+    {
+        for( size_t i = 0; i < 1000; ++i )
+        {
+            WSharedObjectRCU< std::vector< int > >::ReadTicket r = obj->getReadTicket();
+            const std::vector< int >& v = r->get();
+            for( size_t j = 0; j < v.size(); ++j )
+            {
+                if( v[ j ] != static_cast< int >( v.size() ) )
+                {
+                    m_consistent = false;
+                }
+            }
+        }
+    }
+
+    /**
+     * Callback for the change condition.
+     */
+    void notified()
+    {
+        m_notified = true;
+    }
+
+    /**
+     * True if the change condition fired.
+     */
+    bool m_notified;
+
+    /**
+     * False if any reader saw an inconsistent version.
+     */
+    bool m_consistent;
+};
+
+#endif  // WSHAREDOBJECTRCU_TEST_H
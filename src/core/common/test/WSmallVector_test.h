@@ -0,0 +1,118 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WSMALLVECTOR_TEST_H
+#define WSMALLVECTOR_TEST_H
+
+#include <utility>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WSmallVector.h"
+
+/**
+ * Testsuite for WSmallVector.
+ */
+class WSmallVectorTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Small vectors are stored inline, larger ones on the heap. The elements are zero in both cases.
+     */
+    void testStorage( void )
+    {
+        WSmallVector< double, 4 > small( 4 );
+        TS_ASSERT( small.isInline() );
+        TS_ASSERT_EQUALS( small.size(), 4 );
+        TS_ASSERT_EQUALS( small[ 3 ], 0.0 );
+
+        WSmallVector< double, 4 > large( 5 );
+        TS_ASSERT( !large.isInline() );
+        TS_ASSERT_EQUALS( large.size(), 5 );
+        TS_ASSERT_EQUALS( large[ 4 ], 0.0 );
+    }
+
+    /**
+     * Resizing keeps the elements and initializes new ones, also when switching to the heap.
+     */
+    void testResize( void )
+    {
+        WSmallVector< int, 2 > v( 2 );
+        v[ 0 ] = 1;
+        v[ 1 ] = 2;
+        v.resize( 1 );
+        v.resize( 2 );
+        TS_ASSERT_EQUALS( v[ 0 ], 1 );
+        TS_ASSERT_EQUALS( v[ 1 ], 0 );
+
+        v[ 1 ] = 2;
+        v.resize( 3 );
+        TS_ASSERT( !v.isInline() );
+        TS_ASSERT_EQUALS( v[ 0 ], 1 );
+        TS_ASSERT_EQUALS( v[ 1 ], 2 );
+        TS_ASSERT_EQUALS( v[ 2 ], 0 );
+    }
+
+    /**
+     * Copies are independent of the original.
+     */
+    void testCopy( void )
+    {
+        WSmallVector< int, 2 > a( 3 );
+        a[ 2 ] = 7;
+        WSmallVector< int, 2 > b( a );
+        TS_ASSERT( b == a );
+        b[ 2 ] = 8;
+        TS_ASSERT( b != a );
+        TS_ASSERT_EQUALS( a[ 2 ], 7 );
+
+        WSmallVector< int, 2 > c( 1 );
+        c = a;
+        TS_ASSERT( c == a );
+    }
+
+    /**
+     * Moving takes over the heap storage and leaves an empty vector. Inline elements are copied.
+     */
+    void testMove( void )
+    {
+        WSmallVector< int, 2 > a( 3 );
+        a[ 2 ] = 7;
+        int const* storage = a.data();
+        WSmallVector< int, 2 > b( std::move( a ) );
+        TS_ASSERT_EQUALS( b.data(), storage );
+        TS_ASSERT_EQUALS( b[ 2 ], 7 );
+        TS_ASSERT( a.empty() );
+        TS_ASSERT( a.isInline() );
+
+        WSmallVector< int, 2 > c( 1 );
+        c[ 0 ] = 3;
+        b = std::move( c );
+        TS_ASSERT_EQUALS( b.size(), 1 );
+        TS_ASSERT_EQUALS( b[ 0 ], 3 );
+        TS_ASSERT( c.empty() );
+    }
+};
+
+#endif  // WSMALLVECTOR_TEST_H
@@ -25,7 +25,11 @@
 #ifndef WTHREADEDFUNCTION_TEST_H
 #define WTHREADEDFUNCTION_TEST_H
 
+#include <algorithm>
+#include <new>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <cxxtest/TestSuite.h>
 
@@ -254,7 +258,105 @@ public:
         TS_ASSERT_EQUALS( m_exceptionCounter.getReadTicket()->get(), 7 );
     }
 
+    /**
+     * The thread ranges are contiguous, cover every index and differ in length by at most one.
+     */
+    void testThreadRange()
+    {
+        std::size_t const sizes[] = { 0, 1, 5, 7, 1000, 1001 };
+        for( std::size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++s )
+        {
+            for( std::size_t numThreads = 1; numThreads < 10; ++numThreads )
+            {
+                std::size_t expectedBegin = 0;
+                for( std::size_t id = 0; id < numThreads; ++id )
+                {
+                    std::pair< std::size_t, std::size_t > const range = getThreadRange( sizes[ s ], id, numThreads );
+                    TS_ASSERT_EQUALS( range.first, expectedBegin );
+                    TS_ASSERT_LESS_THAN_EQUALS( range.first, range.second );
+                    TS_ASSERT_LESS_THAN_EQUALS( range.second - range.first, sizes[ s ] / numThreads + 1 );
+                    TS_ASSERT_LESS_THAN_EQUALS( sizes[ s ] / numThreads, range.second - range.first );
+                    expectedBegin = range.second;
+                }
+                TS_ASSERT_EQUALS( expectedBegin, sizes[ s ] );
+            }
+        }
+    }
+
+    /**
+     * The ranges of runThreadedRanges() cover every index exactly once. A single thread gets all indices in one call.
+     */
+    void testThreadedRanges()
+    {
+        std::vector< int > visits( 1000, 0 );
+        m_rangeCounter.getWriteTicket()->get() = 0;
+        runThreadedRanges( visits.size(), 6, boost::bind( &WThreadedFunctionTest::visitRange, this, &visits, _1, _2 ) );
+        TS_ASSERT_EQUALS( m_rangeCounter.getReadTicket()->get(), 6 );
+        TS_ASSERT_EQUALS( std::count( visits.begin(), visits.end(), 1 ), 1000 );
+
+        m_rangeCounter.getWriteTicket()->get() = 0;
+        runThreadedRanges( visits.size(), 1, boost::bind( &WThreadedFunctionTest::visitRange, this, &visits, _1, _2 ) );
+        TS_ASSERT_EQUALS( m_rangeCounter.getReadTicket()->get(), 1 );
+        TS_ASSERT_EQUALS( std::count( visits.begin(), visits.end(), 2 ), 1000 );
+
+        // more threads than indices do not produce empty ranges
+        m_rangeCounter.getWriteTicket()->get() = 0;
+        runThreadedRanges( 3, 8, boost::bind( &WThreadedFunctionTest::visitRange, this, &visits, _1, _2 ) );
+        TS_ASSERT_EQUALS( m_rangeCounter.getReadTicket()->get(), 3 );
+    }
+
+    /**
+     * An exception thrown for one range reaches the caller of runThreadedRanges() unchanged, for any number of
+     * threads, and the other ranges are still completed.
+     */
+    void testThreadedRangesException()
+    {
+        for( std::size_t numThreads = 1; numThreads < 5; ++numThreads )
+        {
+            std::vector< int > visits( 1000, 0 );
+            m_rangeCounter.getWriteTicket()->get() = 0;
+            TS_ASSERT_THROWS( runThreadedRanges( visits.size(), numThreads,
+                                                 boost::bind( &WThreadedFunctionTest::visitRangeOrThrow, this, &visits, 0, _1, _2 ) ),
+                              std::bad_alloc& );
+            TS_ASSERT_EQUALS( m_rangeCounter.getReadTicket()->get(), static_cast< int >( numThreads ) - 1 );
+            TS_ASSERT_EQUALS( std::count( visits.begin(), visits.end(), 1 ), 1000 - static_cast< int >( 1000 / numThreads ) );
+        }
+    }
+
 private:
+    /**
+     * Counts the visits of a range of indices.
+     *
+     * \param visits the visits of every index
+     * \param begin the first index
+     * \param end behind the last index
+     */
+    void visitRange( std::vector< int >* visits, std::size_t begin, std::size_t end )
+    {
+        for( std::size_t i = begin; i < end; ++i )
+        {
+            ++( *visits )[ i ];
+        }
+        ++m_rangeCounter.getWriteTicket()->get();
+    }
+
+    /**
+     * Counts the visits of a range of indices, but throws for the range that contains a given index.
+     *
+     * \param visits the visits of every index
+     * \param failing the index whose range throws
+     * \param begin the first index
+     * \param end behind the last index
+     */
+    void visitRangeOrThrow( std::vector< int >* visits, std::size_t failing, std::size_t begin, std::size_t end )
+    {
+        if( begin <= failing && failing < end )
+        {
+            throw std::bad_alloc();
+        }
+        visitRange( visits, begin, end );
+    }
+
     /**
      * Exception callback.
      */
@@ -265,6 +367,9 @@ private:
 
     //! a counter
     WSharedObject< int > m_exceptionCounter;
+
+    //! the number of visited ranges
+    WSharedObject< int > m_rangeCounter;
 };
 
 #endif  // WTHREADEDFUNCTION_TEST_H
@@ -0,0 +1,164 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTRACE_TEST_H
+#define WTRACE_TEST_H
+
+#include <sstream>
+#include <string>
+
+#include <boost/thread.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WTrace.h"
+#include "../WTraceScope.h"
+
+/**
+ * Tests the trace recording and export.
+ */
+class WTraceTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Clears the trace before each test.
+     */
+    void setUp()
+    {
+        WTrace::clear();
+    }
+
+    /**
+     * Recorded spans and thread names need to show up in the exported JSON.
+     */
+    void testWrite()
+    {
+        WTrace::setThreadName( "testThread" );
+        {
+            WTraceScope scope( "test", "testScope" );
+        }
+        WTrace::record( "test", "test\"Quoted", WTrace::now(), 1.0 );
+
+        std::ostringstream out;
+        WTrace::write( out );
+        std::string json = out.str();
+
+        TS_ASSERT( json.find( "\"traceEvents\"" ) != std::string::npos );
+        TS_ASSERT( json.find( "\"testThread\"" ) != std::string::npos );
+        TS_ASSERT( json.find( "\"name\":\"testScope\",\"cat\":\"test\",\"ph\":\"X\"" ) != std::string::npos );
+        TS_ASSERT( json.find( "test\\\"Quoted" ) != std::string::npos );
+    }
+
+    /**
+     * Each thread gets its own buffer and thread id.
+     */
+    void testThreads()
+    {
+        WTrace::record( "test", "mainThread", WTrace::now(), 1.0 );
+        boost::thread t( &WTraceTest::recordInThread );
+        t.join();
+
+        std::ostringstream out;
+        WTrace::write( out );
+        std::string json = out.str();
+
+        std::string::size_type main = json.find( "\"mainThread\"" );
+        std::string::size_type other = json.find( "\"otherThread\"" );
+        TS_ASSERT( main != std::string::npos );
+        TS_ASSERT( other != std::string::npos );
+
+        // the tid follows the name
+        TS_ASSERT_DIFFERS( json.substr( json.find( "\"tid\":", main ), 10 ), json.substr( json.find( "\"tid\":", other ), 10 ) );
+    }
+
+    /**
+     * The ring buffer keeps the last spans only.
+     */
+    void testRingBuffer()
+    {
+        for( size_t i = 0; i < WTrace::BufferSize + 10; ++i )
+        {
+            std::ostringstream name;
+            name << "span" << i;
+            WTrace::record( "test", name.str().c_str(), static_cast< double >( i ), 1.0 );
+        }
+
+        std::ostringstream out;
+        WTrace::write( out );
+        std::string json = out.str();
+
+        TS_ASSERT( json.find( "\"span9\"" ) == std::string::npos );
+        TS_ASSERT( json.find( "\"span10\"" ) != std::string::npos );
+        TS_ASSERT( json.find( "\"span10\"" ) < json.find( "\"span11\"" ) );
+    }
+
+    /**
+     * The spans of exited threads are kept in a bounded buffer.
+     */
+    void testExitedThreads()
+    {
+        size_t const numThreads = 2 * WTrace::FinishedBufferSize / WTrace::BufferSize;
+        for( size_t i = 0; i < numThreads; ++i )
+        {
+            boost::thread t( &WTraceTest::recordManyInThread );
+            t.join();
+        }
+
+        std::ostringstream out;
+        WTrace::write( out );
+        std::string json = out.str();
+
+        size_t count = 0;
+        for( std::string::size_type pos = json.find( "\"ph\":\"X\"" ); pos != std::string::npos; pos = json.find( "\"ph\":\"X\"", pos + 1 ) )
+        {
+            ++count;
+        }
+        TS_ASSERT( count > 0 );
+        TS_ASSERT( count <= WTrace::FinishedBufferSize );
+        TS_ASSERT( json.find( "\"manyThread\"" ) != std::string::npos );
+    }
+
+private:
+    /**
+     * Records a full buffer of spans in another thread.
+     */
+    static void recordManyInThread()
+    {
+        WTrace::setThreadName( "manyThread" );
+        for( size_t i = 0; i < WTrace::BufferSize; ++i )
+        {
+            WTrace::record( "test", "many", WTrace::now(), 1.0 );
+        }
+    }
+
+    /**
+     * Records a span in another thread.
+     */
+    static void recordInThread()
+    {
+        WTrace::record( "test", "otherThread", WTrace::now(), 1.0 );
+    }
+};
+
+#endif  // WTRACE_TEST_H
@@ -26,7 +26,10 @@
 #include <algorithm>
 #include <vector>
 
+#include <boost/bind.hpp>
+
 #include "../common/WLogger.h"
+#include "../common/WThreadedFunction.h"
 #include "../common/datastructures/WFiber.h"
 #include "WDataSet.h"
 #include "WDataSetFiberVector.h"
@@ -34,6 +37,66 @@
 // prototype instance as singleton
 boost::shared_ptr< WPrototyped > WDataSetFiberVector::m_prototype = boost::shared_ptr< WPrototyped >();
 
+namespace
+{
+    /**
+     * Datasets with less vertices are converted in the calling thread.
+     */
+    const size_t ParallelVertices = 1 << 16;
+
+    /**
+     * Copies the vertices of a range of fibers into already created fibers. Each fiber allocates its points once.
+     *
+     * \param fiberDS the dataset
+     * \param fibers the fibers
+     * \param begin the first fiber
+     * \param end behind the last fiber
+     */
+    void readFibers( WDataSetFibers const* fiberDS, WDataSetFiberVector* fibers, size_t begin, size_t end )
+    {
+        const std::vector< float >& vertices = *fiberDS->getVertices();
+        const std::vector< size_t >& lineStarts = *fiberDS->getLineStartIndexes();
+        const std::vector< size_t >& lineLengths = *fiberDS->getLineLengths();
+        for( size_t fiberID = begin; fiberID < end; ++fiberID )
+        {
+            WFiber& fib = ( *fibers )[ fiberID ];
+            fib.resize( lineLengths[ fiberID ] );
+            const float* vertex = &vertices[ 3 * lineStarts[ fiberID ] ];
+            for( size_t i = 0; i < fib.size(); ++i, vertex += 3 )
+            {
+                fib[ i ] = WPosition( vertex[ 0 ], vertex[ 1 ], vertex[ 2 ] );
+            }
+        }
+    }
+
+    /**
+     * Copies the points of a range of fibers into already sized vertex arrays.
+     *
+     * \param fibers the fibers
+     * \param fiberStartIndices the index of the first vertex of every fiber
+     * \param points the vertices
+     * \param pointFiberMapping the fiber of every vertex
+     * \param begin the first fiber
+     * \param end behind the last fiber
+     */
+    void writeFibers( const WDataSetFiberVector* fibers, const std::vector< size_t >* fiberStartIndices, std::vector< float >* points,
+                      std::vector< size_t >* pointFiberMapping, size_t begin, size_t end )
+    {
+        for( size_t fiberID = begin; fiberID < end; ++fiberID )
+        {
+            const WFiber& fib = ( *fibers )[ fiberID ];
+            size_t index = ( *fiberStartIndices )[ fiberID ];
+            for( WFiber::const_iterator fit = fib.begin(); fit != fib.end(); ++fit, ++index )
+            {
+                ( *points )[ 3 * index ] = ( *fit )[0];
+                ( *points )[ 3 * index + 1 ] = ( *fit )[1];
+                ( *points )[ 3 * index + 2 ] = ( *fit )[2];
+                ( *pointFiberMapping )[ index ] = fiberID;
+            }
+        }
+    }
+}
+
 WDataSetFiberVector::WDataSetFiberVector()
     : WMixinVector< WFiber >(),
       WDataSet()
@@ -46,7 +109,7 @@ WDataSetFiberVector::WDataSetFiberVector( boost::shared_ptr< std::vector< WFiber
 {
 }
 
-WDataSetFiberVector::WDataSetFiberVector( boost::shared_ptr< const WDataSetFibers > fiberDS )
+WDataSetFiberVector::WDataSetFiberVector( boost::shared_ptr< const WDataSetFibers > fiberDS, size_t numThreads )
     : WMixinVector< WFiber >(),
       WDataSet()
 {
@@ -61,18 +124,10 @@ WDataSetFiberVector::WDataSetFiberVector( boost::shared_ptr< const WDataSetFiber
         setFilename( fiberDS->getFilename() );
     }
     size_t numLines = fiberDS->size();
-    const std::vector< size_t >& lineLengths = *fiberDS->getLineLengths();
-    reserve( numLines );
+    size_t numVertices = fiberDS->getVertices()->size() / 3;
+    resize( numLines );
 
-    while( size() < numLines )
-    {
-        WFiber fib;
-        for( size_t i = 0; i < lineLengths[ size() ]; ++i )
-        {
-            fib.push_back( fiberDS->getPosition( size(), i ) );
-        }
-        push_back( fib );
-    }
+    runThreadedRanges( numLines, numVertices < ParallelVertices ? 1 : numThreads, boost::bind( &readFibers, fiberDS.get(), this, _1, _2 ) );
 }
 
 WDataSetFiberVector::WDataSetFiberVector( const WDataSetFiberVector& other )
@@ -140,33 +195,26 @@ boost::shared_ptr< WPrototyped > WDataSetFiberVector::getPrototype()
     return m_prototype;
 }
 
-boost::shared_ptr< WDataSetFibers > WDataSetFiberVector::toWDataSetFibers() const
+boost::shared_ptr< WDataSetFibers > WDataSetFiberVector::toWDataSetFibers( size_t numThreads ) const
 {
-    boost::shared_ptr< std::vector< float > > points( new std::vector< float > );
     boost::shared_ptr< std::vector< size_t > > fiberStartIndices( new std::vector< size_t > );
     boost::shared_ptr< std::vector< size_t > > fiberLengths( new std::vector< size_t > );
-    boost::shared_ptr< std::vector< size_t > > pointFiberMapping( new std::vector< size_t > );
 
     fiberStartIndices->reserve( size() );
     fiberLengths->reserve( size() );
-    // other reserving for points and pointFiberMapping is not possible here without cycling through the whole data
-
-    size_t fiberID = 0;
-    for( const_iterator cit = begin(); cit != end(); ++cit, ++fiberID )
+    size_t numPoints = 0;
+    for( const_iterator cit = begin(); cit != end(); ++cit )
     {
-        const WFiber& fib = *cit;
-        // the division by 3 is necessary since it carries the point numbers not the number of the i'th component
-        fiberStartIndices->push_back( points->size() / 3 );
-        fiberLengths->push_back( fib.size() );
-        for( WFiber::const_iterator fit = fib.begin(); fit != fib.end(); ++fit )
-        {
-            points->push_back( ( *fit )[0] );
-            points->push_back( ( *fit )[1] );
-            points->push_back( ( *fit )[2] );
-            pointFiberMapping->push_back( fiberID );
-        }
+        fiberStartIndices->push_back( numPoints );
+        fiberLengths->push_back( cit->size() );
+        numPoints += cit->size();
     }
 
+    boost::shared_ptr< std::vector< float > > points( new std::vector< float >( 3 * numPoints ) );
+    boost::shared_ptr< std::vector< size_t > > pointFiberMapping( new std::vector< size_t >( numPoints ) );
+    runThreadedRanges( size(), numPoints < ParallelVertices ? 1 : numThreads,
+                       boost::bind( &writeFibers, this, fiberStartIndices.get(), points.get(), pointFiberMapping.get(), _1, _2 ) );
+
     return boost::shared_ptr< WDataSetFibers >( new WDataSetFibers( points, fiberStartIndices, fiberLengths, pointFiberMapping ) );
 }
 
@@ -59,11 +59,12 @@ public:
     explicit WDataSetFiberVector( boost::shared_ptr< std::vector< WFiber > > fibs );
 
     /**
-     * Convert a WDataSetFibers into a fiber vector dataset.
+     * Convert a WDataSetFibers into a fiber vector dataset. Large datasets are converted in parallel.
      *
      * \param fiberDS Dataset which has to be converted
+     * \param numThreads the number of threads, 0 to choose automatically
      */
-    explicit WDataSetFiberVector( boost::shared_ptr< const WDataSetFibers > fiberDS );
+    explicit WDataSetFiberVector( boost::shared_ptr< const WDataSetFibers > fiberDS, size_t numThreads = 0 );
 
     /**
      * Copy constructor for fibers
@@ -130,11 +131,14 @@ public:
     static boost::shared_ptr< WPrototyped > getPrototype();
 
     /**
-     * Convert this dataset into WDataSetFibers format for other purposes if needed. (e.g. display)
+     * Convert this dataset into WDataSetFibers format for other purposes if needed. (e.g. display) Large datasets are
+     * converted in parallel.
+     *
+     * \param numThreads the number of threads, 0 to choose automatically
      *
      * \return Reference to the dataset in WDataSetFibers format
      */
-    boost::shared_ptr< WDataSetFibers > toWDataSetFibers() const;
+    boost::shared_ptr< WDataSetFibers > toWDataSetFibers( size_t numThreads = 0 ) const;
 
 protected:
     /**
@@ -27,6 +27,8 @@
 #include <utility>
 #include <vector>
 
+#include <boost/bind.hpp>
+
 #include "../common/datastructures/WFiber.h"
 #include "../common/WBoundingBox.h"
 #include "../common/WColor.h"
@@ -35,10 +37,25 @@
 #include "../common/WPropertyHelper.h"
 #include "../graphicsEngine/WGEUtils.h"
 #include "exceptions/WDHNoSuchDataSet.h"
-#include "WCreateColorArraysThread.h"
 #include "WDataSet.h"
 #include "WDataSetFibers.h"
 
+namespace
+{
+    /**
+     * The main memory held by an array.
+     *
+     * \param array the array, can be NULL
+     *
+     * \return the memory in bytes
+     */
+    template< typename T >
+    size_t getArrayMemoryUsage( const boost::shared_ptr< std::vector< T > >& array )
+    {
+        return array ? array->capacity() * sizeof( T ) : 0;
+    }
+}
+
 // prototype instance as singleton
 boost::shared_ptr< WPrototyped > WDataSetFibers::m_prototype = boost::shared_ptr< WPrototyped >();
 
@@ -126,55 +143,28 @@ WDataSetFibers::WDataSetFibers( WDataSetFibers::VertexArray vertices,
 
 void WDataSetFibers::init()
 {
-    size_t size = m_vertices->size();
-    m_tangents = boost::shared_ptr< std::vector< float > >( new std::vector<float>( size ) );
-
-    boost::shared_ptr< std::vector< float > > globalColors( new std::vector<float>( size ) );
-    boost::shared_ptr< std::vector< float > > localColors( new std::vector<float>( size ) );
-    boost::shared_ptr< std::vector< float > > customColors( new std::vector<float>( size ) );
-
-    // TODO(all): use the new WThreadedJobs functionality
-    WCreateColorArraysThread* t1 = new WCreateColorArraysThread( 0, m_lineLengths->size()/4, m_vertices,
-            m_lineLengths, globalColors, localColors, m_tangents );
-    WCreateColorArraysThread* t2 = new WCreateColorArraysThread( m_lineLengths->size()/4+1, m_lineLengths->size()/2, m_vertices,
-            m_lineLengths, globalColors, localColors, m_tangents );
-    WCreateColorArraysThread* t3 = new WCreateColorArraysThread( m_lineLengths->size()/2+1, m_lineLengths->size()/4*3, m_vertices,
-            m_lineLengths, globalColors, localColors, m_tangents );
-    WCreateColorArraysThread* t4 = new WCreateColorArraysThread( m_lineLengths->size()/4*3+1, m_lineLengths->size()-1, m_vertices,
-            m_lineLengths, globalColors, localColors, m_tangents );
-    t1->run();
-    t2->run();
-    t3->run();
-    t4->run();
-
-    t1->wait();
-    t2->wait();
-    t3->wait();
-    t4->wait();
-
-    delete t1;
-    delete t2;
-    delete t3;
-    delete t4;
-
-    // add both arrays to m_colors
+    // the given arrays, the tangents and colors reserve their own memory right away but are computed on first use
+    m_reservation = WMemoryReservation::SPtr( new WMemoryReservation( m_vertices->size() * sizeof( float ) +
+        ( m_lineStartIndexes->size() + m_lineLengths->size() + m_verticesReverse->size() ) * sizeof( size_t ), "fibers" ) );
+
+    m_directionArrays = WFiberDirectionArrays::SPtr( new WFiberDirectionArrays( m_vertices, m_lineStartIndexes, m_lineLengths ) );
+    m_segmentIndex = WFiberSegmentIndex::SPtr( new WFiberSegmentIndex( m_vertices, m_lineStartIndexes, m_lineLengths, m_verticesReverse ) );
+
+    // add the lazily computed arrays to m_colors
     m_colors = boost::shared_ptr< WItemSelection >( new WItemSelection() );
     m_colors->push_back( boost::shared_ptr< WItemSelectionItem >(
-            new ColorScheme( "Global Color", "Colors direction by using start and end vertex per fiber.", NULL, globalColors, ColorScheme::RGB )
+            new ColorScheme( "Global Color", "Colors direction by using start and end vertex per fiber.", NULL,
+                    boost::bind( &WFiberDirectionArrays::getGlobalColors, m_directionArrays ), ColorScheme::RGB )
         )
     );
     m_colors->push_back( boost::shared_ptr< WItemSelectionItem >(
-            new ColorScheme( "Local Color", "Colors direction by using start and end vertex per segment.", NULL, localColors, ColorScheme::RGB )
+            new ColorScheme( "Local Color", "Colors direction by using start and end vertex per segment.", NULL,
+                    boost::bind( &WFiberDirectionArrays::getLocalColors, m_directionArrays ), ColorScheme::RGB )
         )
     );
-
-    for( size_t i = 0; i < size; ++i )
-    {
-        ( *customColors )[i] = ( *globalColors )[i];
-    }
     m_colors->push_back( boost::shared_ptr< WItemSelectionItem >(
-            new ColorScheme( "Custom Color", "Colors copied from the global colors, will be used for bundle coloring.",
-                    NULL, customColors, ColorScheme::RGB )
+            new ColorScheme( "Custom Color", "Colors copied from the global colors, will be used for bundle coloring.", NULL,
+                    boost::bind( &WFiberDirectionArrays::getCustomColors, m_directionArrays ), ColorScheme::RGB )
         )
     );
 
@@ -238,7 +228,12 @@ WDataSetFibers::IndexArray WDataSetFibers::getVerticesReverse() const
 
 WDataSetFibers::TangentArray WDataSetFibers::getTangents() const
 {
-    return m_tangents;
+    return m_directionArrays->getTangents();
+}
+
+WFiberSegmentIndex::SPtr WDataSetFibers::getSegmentIndex() const
+{
+    return m_segmentIndex;
 }
 
 void WDataSetFibers::addColorScheme( WDataSetFibers::ColorArray colors, std::string name, std::string description )
@@ -403,6 +398,42 @@ WBoundingBox WDataSetFibers::getBoundingBox() const
     return m_bb;
 }
 
+size_t WDataSetFibers::getMemoryUsage() const
+{
+    size_t usage = getArrayMemoryUsage( m_vertices ) + getArrayMemoryUsage( m_lineStartIndexes ) +
+                   getArrayMemoryUsage( m_lineLengths ) + getArrayMemoryUsage( m_verticesReverse );
+    if( m_directionArrays )
+    {
+        usage += m_directionArrays->getMemoryUsage();
+    }
+    if( m_segmentIndex )
+    {
+        usage += m_segmentIndex->getMemoryUsage();
+    }
+    for( size_t i = 0; i < m_vertexParameters.size(); ++i )
+    {
+        usage += getArrayMemoryUsage( m_vertexParameters[ i ] );
+    }
+    for( size_t i = 0; i < m_lineParameters.size(); ++i )
+    {
+        usage += getArrayMemoryUsage( m_lineParameters[ i ] );
+    }
+    if( m_colors )
+    {
+        WItemSelection::ReadTicket l = m_colors->getReadTicket();
+        for( WItemSelection::ConstIterator i = l->get().begin(); i != l->get().end(); ++i )
+        {
+            // the lazily created arrays are counted above, asking for them here would compute them
+            boost::shared_ptr< const ColorScheme > scheme = boost::static_pointer_cast< const ColorScheme >( *i );
+            if( !scheme->m_colorFunction )
+            {
+                usage += getArrayMemoryUsage( scheme->getColor() );
+            }
+        }
+    }
+    return usage;
+}
+
 WFiber WDataSetFibers::operator[]( size_t numTract ) const
 {
     WAssert( numTract < m_lineLengths->size(), "WDataSetFibers: out of bounds - invalid tract number requested." );
@@ -778,29 +809,30 @@ WPosition WFiberPointsIterator::getTangent() const
 WColor WFiberPointsIterator::getColor( const boost::shared_ptr< WDataSetFibers::ColorScheme > scheme ) const
 {
     std::size_t v = getBaseIndex();
+    WDataSetFibers::ColorArray colors = scheme->getColor();
     WColor ret;
     switch( scheme->getMode() )
     {
         case WDataSetFibers::ColorScheme::GRAY:
             {
-                double r = scheme->getColor()->operator[]( 1 * v + 0 );
+                double r = colors->operator[]( 1 * v + 0 );
                 ret.set( r, r, r, 1.0 );
             }
             break;
         case WDataSetFibers::ColorScheme::RGB:
             {
-                double r = scheme->getColor()->operator[]( 3 * v + 0 );
-                double g = scheme->getColor()->operator[]( 3 * v + 1 );
-                double b = scheme->getColor()->operator[]( 3 * v + 2 );
+                double r = colors->operator[]( 3 * v + 0 );
+                double g = colors->operator[]( 3 * v + 1 );
+                double b = colors->operator[]( 3 * v + 2 );
                 ret.set( r, g, b, 1.0 );
             }
             break;
         case WDataSetFibers::ColorScheme::RGBA:
             {
-                double r = scheme->getColor()->operator[]( 4 * v + 0 );
-                double g = scheme->getColor()->operator[]( 4 * v + 1 );
-                double b = scheme->getColor()->operator[]( 4 * v + 2 );
-                double a = scheme->getColor()->operator[]( 4 * v + 3 );
+                double r = colors->operator[]( 4 * v + 0 );
+                double g = colors->operator[]( 4 * v + 1 );
+                double b = colors->operator[]( 4 * v + 2 );
+                double a = colors->operator[]( 4 * v + 3 );
                 ret.set( r, g, b, a );
             }
             break;
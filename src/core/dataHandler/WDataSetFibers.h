@@ -29,17 +29,21 @@
 #include <utility>
 #include <vector>
 
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 
 #include "../common/math/linearAlgebra/WPosition.h"
 #include "../common/WBoundingBox.h"
+#include "../common/WMemoryReservation.h"
 #include "../common/WProperties.h"
 
 #include "../common/WDefines.h"  // for deprecated
 
 #include "WIteratorRange.h"
 #include "WDataSet.h"
+#include "WFiberDirectionArrays.h"
+#include "WFiberSegmentIndex.h"
 
 
 // forward declarations
@@ -148,6 +152,23 @@ public:
         {
         };
 
+        /**
+         * Constructor. Creates new item whose color array is created by the given function on the first call of getColor().
+         *
+         * \param name name, name of item.
+         * \param description description of item. Can be empty.
+         * \param icon icon, can be NULL
+         * \param colorFunction returns the color array of this item. Called on every getColor(), so it should cache the array.
+         * \param mode the mode of the color array. This defines whether the colors are luminance, RGB or RGBA
+         */
+        ColorScheme( std::string name, std::string description, const char** icon, boost::function< ColorArray() > colorFunction,
+                     ColorMode mode = RGB ):
+            WItemSelectionItem( name, description, icon ),
+            m_colorFunction( colorFunction ),
+            m_mode( mode )
+        {
+        };
+
         /**
          * Get the color.
          *
@@ -155,7 +176,7 @@ public:
          */
         ColorArray getColor() const
         {
-            return m_color;
+            return m_colorFunction ? m_colorFunction() : m_color;
         };
 
         /**
@@ -177,6 +198,7 @@ public:
          */
         void setColor( ColorArray color, ColorMode mode = RGB )
         {
+            m_colorFunction.clear();
             m_color = color;
             m_mode = mode;
         };
@@ -187,6 +209,11 @@ public:
          */
         ColorArray m_color;
 
+        /**
+         * If set, creates the color array instead of m_color.
+         */
+        boost::function< ColorArray() > m_colorFunction;
+
         /**
          * Coloring mode.
          */
@@ -322,6 +349,14 @@ public:
      */
     TangentArray getTangents() const;
 
+    /**
+     * Returns the spatial index of the fiber segments, to find the fibers in a region without iterating all fibers. The
+     * index is built on the first query.
+     *
+     * \return the index
+     */
+    WFiberSegmentIndex::SPtr getSegmentIndex() const;
+
     /**
      * Get the parameter values for each vertex. Same indexing as vertices. Used to store additional scalar values for each vertex.
      *
@@ -474,6 +509,13 @@ public:
      */
     WBoundingBox getBoundingBox() const;
 
+    /**
+     * The main memory held by the vertex, index, tangent, color and parameter arrays.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const;
+
     /**
      * Constructs a WFiber out of the given tract number.
      *
@@ -526,9 +568,14 @@ private:
     VertexArray m_vertices;
 
     /**
-     * Point vector for tangents at each vertex, used for fake tubes
+     * The tangents at each vertex, used for fake tubes, and the direction color arrays. Computed on first use.
+     */
+    WFiberDirectionArrays::SPtr m_directionArrays;
+
+    /**
+     * The spatial index of the segments. Built on first use.
      */
-    TangentArray m_tangents;
+    WFiberSegmentIndex::SPtr m_segmentIndex;
 
     /**
      * An array of color arrays. The first two elements are: 0: global color, 1: local color
@@ -571,6 +618,11 @@ private:
      * Parameter array. Used to store additional scalar values for each line. Multiple parameter arrays allowed.
      */
     std::vector< LineParemeterArray > m_lineParameters;
+
+    /**
+     * The memory of the arrays reserved in the global memory budget.
+     */
+    WMemoryReservation::SPtr m_reservation;
 };
 
 /**
@@ -0,0 +1,125 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <string>
+
+#include "../common/WAssert.h"
+#include "WDataSetODFPeaks.h"
+
+// The static members need definitions, as they are used by reference.
+const std::size_t WDataSetODFPeaks::ValuesPerPeak;
+
+// prototype instance as singleton
+boost::shared_ptr< WPrototyped > WDataSetODFPeaks::m_prototype = boost::shared_ptr< WPrototyped >();
+
+WDataSetODFPeaks::WDataSetODFPeaks()
+    : WDataSetSingle()
+{
+    // default constructor used by the prototype mechanism
+}
+
+WDataSetODFPeaks::WDataSetODFPeaks( boost::shared_ptr< WValueSetBase > newValueSet, boost::shared_ptr< WGrid > newGrid )
+    : WDataSetSingle( newValueSet, newGrid ),
+      m_peaks( boost::dynamic_pointer_cast< WValueSet< float > >( newValueSet ) )
+{
+    WAssert( newValueSet, "No value set given." );
+    WAssert( newGrid, "No grid given." );
+    WAssert( m_peaks, "The value set of a WDataSetODFPeaks must be a WValueSet< float >." );
+    WAssert( newValueSet->size() == newGrid->size(), "Number of values unequal number of positions in grid." );
+    WAssert( newValueSet->order() == 1, "The value set does not contain vectors." );
+    WAssert( newValueSet->dimension() > 0 && newValueSet->dimension() % ValuesPerPeak == 0,
+             "The size of the vectors must be a multiple of the values per peak." );
+}
+
+WDataSetODFPeaks::~WDataSetODFPeaks()
+{
+}
+
+WDataSetSingle::SPtr WDataSetODFPeaks::clone( boost::shared_ptr< WValueSetBase > newValueSet, boost::shared_ptr< WGrid > newGrid ) const
+{
+    return WDataSetSingle::SPtr( new WDataSetODFPeaks( newValueSet, newGrid ) );
+}
+
+WDataSetSingle::SPtr WDataSetODFPeaks::clone( boost::shared_ptr< WValueSetBase > newValueSet ) const
+{
+    return WDataSetSingle::SPtr( new WDataSetODFPeaks( newValueSet, getGrid() ) );
+}
+
+WDataSetSingle::SPtr WDataSetODFPeaks::clone( boost::shared_ptr< WGrid > newGrid ) const
+{
+    return WDataSetSingle::SPtr( new WDataSetODFPeaks( getValueSet(), newGrid ) );
+}
+
+WDataSetSingle::SPtr WDataSetODFPeaks::clone() const
+{
+    return WDataSetSingle::SPtr( new WDataSetODFPeaks( getValueSet(), getGrid() ) );
+}
+
+boost::shared_ptr< WPrototyped > WDataSetODFPeaks::getPrototype()
+{
+    if( !m_prototype )
+    {
+        m_prototype = boost::shared_ptr< WPrototyped >( new WDataSetODFPeaks() );
+    }
+
+    return m_prototype;
+}
+
+std::size_t WDataSetODFPeaks::getMaxPeaks() const
+{
+    return m_peaks->dimension() / ValuesPerPeak;
+}
+
+std::size_t WDataSetODFPeaks::getNumPeaks( std::size_t index ) const
+{
+    std::size_t count = 0;
+    while( count < getMaxPeaks() && getPeakValue( index, count ) > 0.0 )
+    {
+        ++count;
+    }
+    return count;
+}
+
+WVector3d WDataSetODFPeaks::getPeakDirection( std::size_t index, std::size_t peak ) const
+{
+    WAssert( peak < getMaxPeaks(), "Invalid peak index." );
+    float const* p = m_peaks->rawData() + index * m_peaks->dimension() + peak * ValuesPerPeak;
+    return WVector3d( p[ 0 ], p[ 1 ], p[ 2 ] );
+}
+
+double WDataSetODFPeaks::getPeakValue( std::size_t index, std::size_t peak ) const
+{
+    WAssert( peak < getMaxPeaks(), "Invalid peak index." );
+    return m_peaks->rawData()[ index * m_peaks->dimension() + peak * ValuesPerPeak + 3 ];
+}
+
+const std::string WDataSetODFPeaks::getName() const
+{
+    return "WDataSetODFPeaks";
+}
+
+const std::string WDataSetODFPeaks::getDescription() const
+{
+    return "Contains the peak directions and values of orientation distribution functions.";
+}
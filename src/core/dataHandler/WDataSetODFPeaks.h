@@ -0,0 +1,188 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WDATASETODFPEAKS_H
+#define WDATASETODFPEAKS_H
+
+#include <string>
+
+#include "../common/math/linearAlgebra/WVectorFixed.h"
+#include "WDataSetSingle.h"
+#include "WValueSet.h"
+
+/**
+ * The peaks (maxima) of the orientation distribution functions of a volume, as found by
+ * WSphericalHarmonicsPeakFinder. Every voxel stores up to getMaxPeaks() peaks as four floats each, the unit direction
+ * followed by the value of the function in that direction. The peaks are sorted by decreasing value, unused peaks
+ * have the value zero.
+ *
+ * Tracking and glyph modules can use these directions without evaluating the ODFs again.
+ * \ingroup dataHandler
+ */
+class WDataSetODFPeaks : public WDataSetSingle // NOLINT
+{
+public:
+    /**
+     * Convenience typedef for a boost::shared_ptr
+     */
+    typedef boost::shared_ptr< WDataSetODFPeaks > SPtr;
+
+    /**
+     * Convenience typedef for a boost::shared_ptr; const
+     */
+    typedef boost::shared_ptr< const WDataSetODFPeaks > ConstSPtr;
+
+    /**
+     * The number of values per peak.
+     */
+    static const std::size_t ValuesPerPeak = 4;
+
+    /**
+     * Constructs an instance out of an appropriate value set and a grid.
+     *
+     * \param newValueSet a WValueSet< float > of vectors with a multiple of ValuesPerPeak components
+     * \param newGrid the grid which maps world space to the value set
+     */
+    WDataSetODFPeaks( boost::shared_ptr< WValueSetBase > newValueSet, boost::shared_ptr< WGrid > newGrid );
+
+    /**
+     * Construct an empty and unusable instance. This is needed for the prototype mechanism.
+     */
+    WDataSetODFPeaks();
+
+    /**
+     * Destroys this DataSet instance
+     */
+    virtual ~WDataSetODFPeaks();
+
+    /**
+     * Creates a copy (clone) of this instance but allows one to change the valueset. Unlike copy construction, this is a very useful function if you
+     * want to keep the dynamic type of your dataset.
+     *
+     * \param newValueSet the new valueset.
+     * \param newGrid the new grid.
+     *
+     * \return the clone
+     */
+    virtual WDataSetSingle::SPtr clone( boost::shared_ptr< WValueSetBase > newValueSet, boost::shared_ptr< WGrid > newGrid ) const;
+
+    /**
+     * Creates a copy (clone) of this instance but allows one to change the valueset. Unlike copy construction, this is a very useful function if you
+     * want to keep the dynamic type of your dataset even if you just have a WDataSetSingle.
+     *
+     * \param newValueSet the new valueset.
+     *
+     * \return the clone
+     */
+    virtual WDataSetSingle::SPtr clone( boost::shared_ptr< WValueSetBase > newValueSet ) const;
+
+    /**
+     * Creates a copy (clone) of this instance but allows one to change the grid. Unlike copy construction, this is a very useful function if you
+     * want to keep the dynamic type of your dataset even if you just have a WDataSetSingle.
+     *
+     * \param newGrid the new grid.
+     *
+     * \return the clone
+     */
+    virtual WDataSetSingle::SPtr clone( boost::shared_ptr< WGrid > newGrid ) const;
+
+    /**
+     * Creates a copy (clone) of this instance. Unlike copy construction, this is a very useful function if you
+     * want to keep the dynamic type of your dataset even if you just have a WDataSetSingle.
+     *
+     * \return the clone
+     */
+    virtual WDataSetSingle::SPtr clone() const;
+
+    /**
+     * Returns a prototype instantiated with the true type of the deriving class.
+     *
+     * \return the prototype.
+     */
+    static boost::shared_ptr< WPrototyped > getPrototype();
+
+    /**
+     * Returns the maximum number of peaks per voxel.
+     *
+     * \return the maximum number of peaks
+     */
+    std::size_t getMaxPeaks() const;
+
+    /**
+     * Returns the number of peaks of a voxel.
+     *
+     * \param index the index of the voxel
+     *
+     * \return the number of peaks with a value larger than zero
+     */
+    std::size_t getNumPeaks( std::size_t index ) const;
+
+    /**
+     * Returns the direction of a peak.
+     *
+     * \param index the index of the voxel
+     * \param peak the number of the peak, less than getMaxPeaks()
+     *
+     * \return the unit direction, or zero if the voxel has less peaks
+     */
+    WVector3d getPeakDirection( std::size_t index, std::size_t peak ) const;
+
+    /**
+     * Returns the value of the ODF in the direction of a peak.
+     *
+     * \param index the index of the voxel
+     * \param peak the number of the peak, less than getMaxPeaks()
+     *
+     * \return the value, or zero if the voxel has less peaks
+     */
+    double getPeakValue( std::size_t index, std::size_t peak ) const;
+
+    /**
+     * Gets the name of this prototype.
+     *
+     * \return the name.
+     */
+    virtual const std::string getName() const;
+
+    /**
+     * Gets the description for this prototype.
+     *
+     * \return the description
+     */
+    virtual const std::string getDescription() const;
+
+protected:
+    /**
+     * The prototype as singleton.
+     */
+    static boost::shared_ptr< WPrototyped > m_prototype;
+
+private:
+    /**
+     * The peaks.
+     */
+    boost::shared_ptr< WValueSet< float > > m_peaks;
+};
+
+#endif  // WDATASETODFPEAKS_H
@@ -115,6 +115,16 @@ osg::ref_ptr< WDataTexture3D > WDataSetSingle::getTexture() const
     return m_texture;
 }
 
+size_t WDataSetSingle::getMemoryUsage() const
+{
+    size_t usage = m_valueSet ? m_valueSet->getMemoryUsage() : 0;
+    if( m_texture && m_texture->getImage() )
+    {
+        usage += m_texture->getImage()->getTotalSizeInBytes();
+    }
+    return usage;
+}
+
 const std::string WDataSetSingle::getName() const
 {
     return "WDataSetSingle";
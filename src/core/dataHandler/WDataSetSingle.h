@@ -176,6 +176,13 @@ public:
      */
     virtual osg::ref_ptr< WDataTexture3D > getTexture() const;
 
+    /**
+     * The main memory held by the values and, if already created, the texture image.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const;
+
     /**
      * Gets the name of this prototype.
      *
@@ -0,0 +1,580 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../common/datastructures/WFiber.h"
+#include "../common/WAssert.h"
+#include "../common/WThreadedFunction.h"
+#include "WFiberAgglomerativeClustering.h"
+
+namespace
+{
+    /**
+     * The number of coordinates a nearest neighbor query has to visit before it is split over the workers. Smaller
+     * queries are not worth waking them.
+     */
+    const std::size_t ParallelWork = 1 << 18;
+
+    /**
+     * A merge of two clusters found by the nearest-neighbor chain.
+     */
+    struct Merge
+    {
+        std::size_t m_first; //!< the first cluster, a fiber or n plus the index of its merge
+        std::size_t m_second; //!< the second cluster, a fiber or n plus the index of its merge
+        float m_distance; //!< the merge distance
+    };
+
+    /**
+     * Orders merges by their distance.
+     */
+    struct MergeOrder
+    {
+        /**
+         * Compares two merges by distance.
+         *
+         * \param a the index of the first merge
+         * \param b the index of the second merge
+         *
+         * \return true if a was merged at a smaller distance than b
+         */
+        bool operator()( std::size_t a, std::size_t b ) const
+        {
+            return ( *m_merges )[ a ].m_distance < ( *m_merges )[ b ].m_distance;
+        }
+
+        std::vector< Merge > const* m_merges; //!< the merges
+    };
+}
+
+/**
+ * The clusters during the agglomeration. Clusters live in the slot of one of their fibers. A merged cluster takes the
+ * slot of its first part, the slot of the second part becomes inactive.
+ */
+struct WFiberAgglomerativeClustering::State
+{
+    std::vector< float > m_centroids; //!< the centroids of the clusters, m_dimension coordinates per slot
+    std::vector< float > m_sizes; //!< the number of fibers of the cluster in every slot
+    std::vector< std::size_t > m_active; //!< the slots of the active clusters, in no particular order
+    std::vector< std::size_t > m_positions; //!< the position of every active slot in m_active
+};
+
+/**
+ * The workers searching nearest neighbors during a clustering, to be run by a WThreadedFunction. The threads are started
+ * once per clustering and wait for the queries, as a single query is too short to start threads for it. Each thread
+ * searches an equal part of the active clusters, the results are combined so that ties are resolved in favor of the
+ * first active cluster, like in a serial search.
+ */
+class WFiberAgglomerativeClustering::NeighborSearch // NOLINT
+{
+public:
+    /**
+     * Prepares the workers.
+     *
+     * \param clustering the clustering
+     * \param state the clusters, only changed between the queries
+     */
+    NeighborSearch( WFiberAgglomerativeClustering const& clustering, State const& state ):
+        m_clustering( clustering ),
+        m_state( state ),
+        m_numThreads( 0 ),
+        m_generation( 0 ),
+        m_done( 0 ),
+        m_finished( false ),
+        m_query( 0 ),
+        m_distance( std::numeric_limits< float >::infinity() ),
+        m_neighbor( 0 ),
+        m_position( 0 )
+    {
+    }
+
+    /**
+     * Searches this thread's part of the active clusters for every query until finish() is called.
+     *
+     * \param id the id of the thread
+     * \param numThreads the number of threads
+     */
+    void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& /* shutdown */ )
+    {
+        std::size_t generation = 0;
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        m_numThreads = numThreads;
+        while( true )
+        {
+            while( !m_finished && m_generation == generation )
+            {
+                m_queryPosted.wait( lock );
+            }
+            if( m_finished )
+            {
+                return;
+            }
+            generation = m_generation;
+            std::size_t const query = m_query;
+            lock.unlock();
+
+            std::pair< std::size_t, std::size_t > const range = getThreadRange( m_state.m_active.size(), id, numThreads );
+            float distance;
+            std::size_t neighbor;
+            m_clustering.nearest( m_state, query, range.first, range.second, &distance, &neighbor );
+
+            lock.lock();
+            if( neighbor != query )
+            {
+                std::size_t const position = m_state.m_positions[ neighbor ];
+                if( distance < m_distance || ( distance == m_distance && position < m_position ) )
+                {
+                    m_distance = distance;
+                    m_neighbor = neighbor;
+                    m_position = position;
+                }
+            }
+            if( ++m_done == numThreads )
+            {
+                m_queryDone.notify_one();
+            }
+        }
+    }
+
+    /**
+     * Lets the workers search the nearest neighbor of a cluster and waits for them.
+     *
+     * \param query the cluster
+     * \param distance receives the linkage of the nearest neighbor
+     * \param neighbor receives the nearest neighbor
+     */
+    void search( std::size_t query, float* distance, std::size_t* neighbor )
+    {
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        m_query = query;
+        m_distance = std::numeric_limits< float >::infinity();
+        m_neighbor = query;
+        m_position = m_state.m_active.size();
+        m_done = 0;
+        ++m_generation;
+        m_queryPosted.notify_all();
+
+        // workers which did not start yet pick up the query when they do
+        while( m_numThreads == 0 || m_done < m_numThreads )
+        {
+            m_queryDone.wait( lock );
+        }
+        *distance = m_distance;
+        *neighbor = m_neighbor;
+    }
+
+    /**
+     * Lets the workers return.
+     */
+    void finish()
+    {
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        m_finished = true;
+        m_queryPosted.notify_all();
+    }
+
+private:
+    /**
+     * The clustering.
+     */
+    WFiberAgglomerativeClustering const& m_clustering;
+
+    /**
+     * The clusters.
+     */
+    State const& m_state;
+
+    /**
+     * Protects the members below.
+     */
+    boost::mutex m_mutex;
+
+    /**
+     * Notified when a query is posted or the workers should return.
+     */
+    boost::condition_variable m_queryPosted;
+
+    /**
+     * Notified when all workers finished the current query.
+     */
+    boost::condition_variable m_queryDone;
+
+    /**
+     * The number of workers, 0 until the first one started.
+     */
+    std::size_t m_numThreads;
+
+    /**
+     * Counts the queries, so every worker handles each of them once.
+     */
+    std::size_t m_generation;
+
+    /**
+     * The number of workers that finished the current query.
+     */
+    std::size_t m_done;
+
+    /**
+     * Whether the workers should return.
+     */
+    bool m_finished;
+
+    /**
+     * The cluster whose neighbor is searched.
+     */
+    std::size_t m_query;
+
+    /**
+     * The linkage of the nearest neighbor found so far.
+     */
+    float m_distance;
+
+    /**
+     * The nearest neighbor found so far.
+     */
+    std::size_t m_neighbor;
+
+    /**
+     * The position of the nearest neighbor in the active clusters.
+     */
+    std::size_t m_position;
+};
+
+WFiberAgglomerativeClustering::WFiberAgglomerativeClustering( WDataSetFibers::ConstSPtr fibers, std::size_t numPoints, std::size_t numThreads ):
+    m_dimension( 3 * numPoints ),
+    m_numThreads( numThreads )
+{
+    WAssert( numPoints > 0, "Fibers need at least one point." );
+
+    std::vector< float > const& vertices = *fibers->getVertices();
+    std::vector< std::size_t > const& starts = *fibers->getLineStartIndexes();
+    std::vector< std::size_t > const& lengths = *fibers->getLineLengths();
+
+    m_points.reserve( m_dimension * starts.size() );
+    WFiber fiber;
+    for( std::size_t fidx = 0; fidx < starts.size(); ++fidx )
+    {
+        fiber.clear();
+        for( std::size_t k = 0; k < lengths[ fidx ]; ++k )
+        {
+            std::size_t const v = 3 * ( starts[ fidx ] + k );
+            fiber.push_back( WPosition( vertices[ v ], vertices[ v + 1 ], vertices[ v + 2 ] ) );
+        }
+        if( fiber.empty() )
+        {
+            fiber.push_back( WPosition() );
+        }
+        fiber.resampleByNumberOfPoints( numPoints );
+        // the resampling may miss the last point due to rounding
+        WPosition const last = fiber.back();
+        fiber.resize( numPoints, last );
+
+        // fibers have no direction, so both ends are ordered along the axis in which they differ most
+        WPosition const span = fiber.back() - fiber.front();
+        std::size_t axis = 0;
+        for( std::size_t c = 1; c < 3; ++c )
+        {
+            if( std::abs( span[ c ] ) > std::abs( span[ axis ] ) )
+            {
+                axis = c;
+            }
+        }
+        if( span[ axis ] < 0.0 )
+        {
+            std::reverse( fiber.begin(), fiber.end() );
+        }
+
+        for( std::size_t k = 0; k < numPoints; ++k )
+        {
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                m_points.push_back( static_cast< float >( fiber[ k ][ c ] ) );
+            }
+        }
+    }
+}
+
+std::size_t WFiberAgglomerativeClustering::size() const
+{
+    return m_points.size() / m_dimension;
+}
+
+boost::shared_ptr< WHierarchicalTreeFibers > WFiberAgglomerativeClustering::compute( WBoolFlag const& shutdown, WProgress::SPtr progress ) const
+{
+    std::size_t const n = size();
+
+    State state;
+    state.m_centroids = m_points;
+    state.m_sizes.assign( n, 1.0f );
+    state.m_active.resize( n );
+    state.m_positions.resize( n );
+    for( std::size_t slot = 0; slot < n; ++slot )
+    {
+        state.m_active[ slot ] = slot;
+        state.m_positions[ slot ] = slot;
+    }
+
+    // the cluster in every slot, numbered like in Merge
+    std::vector< std::size_t > clusters( state.m_active );
+    std::vector< Merge > merges;
+    merges.reserve( n );
+
+    // every cluster of the chain is the nearest neighbor of its predecessor, so the last two are reciprocal nearest
+    // neighbors as soon as the search returns to the predecessor, and merging them is what Ward's linkage would do next
+    std::vector< std::size_t > chain;
+
+    // the workers are started once for all queries
+    boost::shared_ptr< NeighborSearch > search;
+    boost::shared_ptr< WThreadedFunction< NeighborSearch > > pool;
+    if( m_numThreads != 1 && n * m_dimension >= ParallelWork )
+    {
+        search.reset( new NeighborSearch( *this, state ) );
+        pool.reset( new WThreadedFunction< NeighborSearch >( m_numThreads, search ) );
+        pool->run();
+    }
+
+    while( state.m_active.size() > 1 && !shutdown() )
+    {
+        if( chain.empty() )
+        {
+            chain.push_back( state.m_active.front() );
+        }
+        std::size_t const a = chain.back();
+
+        float distance;
+        std::size_t b;
+        nearest( state, search.get(), a, &distance, &b );
+        if( chain.size() > 1 )
+        {
+            // prefer the predecessor on ties, otherwise the chain could cycle
+            std::size_t const predecessor = chain[ chain.size() - 2 ];
+            float const predecessorDistance = linkage( state, a, predecessor );
+            if( predecessorDistance <= distance )
+            {
+                chain.pop_back();
+                chain.pop_back();
+
+                Merge const merge = { clusters[ predecessor ], clusters[ a ], predecessorDistance }; // NOLINT
+                merges.push_back( merge );
+                clusters[ predecessor ] = n + merges.size() - 1;
+
+                // the merged cluster takes the slot of the predecessor
+                float const sizeA = state.m_sizes[ a ];
+                float const sizeP = state.m_sizes[ predecessor ];
+                float* centroidP = &state.m_centroids[ m_dimension * predecessor ];
+                float const* centroidA = &state.m_centroids[ m_dimension * a ];
+                for( std::size_t c = 0; c < m_dimension; ++c )
+                {
+                    centroidP[ c ] = ( sizeP * centroidP[ c ] + sizeA * centroidA[ c ] ) / ( sizeP + sizeA );
+                }
+                state.m_sizes[ predecessor ] = sizeP + sizeA;
+
+                std::size_t const position = state.m_positions[ a ];
+                state.m_active[ position ] = state.m_active.back();
+                state.m_positions[ state.m_active[ position ] ] = position;
+                state.m_active.pop_back();
+
+                if( progress )
+                {
+                    ++*progress;
+                }
+                continue;
+            }
+        }
+        chain.push_back( b );
+    }
+
+    if( pool )
+    {
+        search->finish();
+        pool->wait();
+    }
+    if( state.m_active.size() > 1 )
+    {
+        return boost::shared_ptr< WHierarchicalTreeFibers >();
+    }
+
+    // Ward's linkage never merges at a smaller distance than that of the parts, up to rounding, so sorting the merges
+    // by distance keeps the parts in front of the clusters they are merged into
+    for( std::size_t k = 0; k < merges.size(); ++k )
+    {
+        Merge& merge = merges[ k ];
+        std::size_t const parts[] = { merge.m_first, merge.m_second }; // NOLINT
+        for( std::size_t i = 0; i < 2; ++i )
+        {
+            if( parts[ i ] >= n )
+            {
+                merge.m_distance = std::max( merge.m_distance, merges[ parts[ i ] - n ].m_distance );
+            }
+        }
+    }
+    std::vector< std::size_t > order( merges.size() );
+    for( std::size_t k = 0; k < order.size(); ++k )
+    {
+        order[ k ] = k;
+    }
+    MergeOrder const mergeOrder = { &merges }; // NOLINT
+    std::stable_sort( order.begin(), order.end(), mergeOrder );
+
+    // the tree numbers the merged clusters in the sorted order
+    std::vector< std::size_t > ids( n + merges.size() );
+    for( std::size_t k = 0; k < n; ++k )
+    {
+        ids[ k ] = k;
+    }
+    for( std::size_t k = 0; k < order.size(); ++k )
+    {
+        ids[ n + order[ k ] ] = n + k;
+    }
+
+    // the squared distances of all points add up, the distance of the tree is the root mean square point distance of
+    // two merged fibers
+    float const scale = 2.0f / static_cast< float >( m_dimension / 3 );
+
+    boost::shared_ptr< WHierarchicalTreeFibers > tree( new WHierarchicalTreeFibers() );
+    for( std::size_t k = 0; k < n; ++k )
+    {
+        tree->addLeaf();
+    }
+    for( std::size_t k = 0; k < order.size(); ++k )
+    {
+        Merge const& merge = merges[ order[ k ] ];
+        std::size_t const first = ids[ merge.m_first ];
+        std::size_t const second = ids[ merge.m_second ];
+        std::vector< std::size_t > leafs = tree->getLeafesForCluster( first );
+        std::vector< std::size_t > const secondLeafs = tree->getLeafesForCluster( second );
+        leafs.insert( leafs.end(), secondLeafs.begin(), secondLeafs.end() );
+        tree->addCluster( first, second, std::max( tree->getLevel( first ), tree->getLevel( second ) ) + 1, leafs,
+                          std::sqrt( scale * merge.m_distance ) );
+    }
+    return tree;
+}
+
+WDataSetFiberClustering::SPtr WFiberAgglomerativeClustering::cut( WHierarchicalTreeFibers const& tree, std::size_t numClusters )
+{
+    std::size_t const numLeafs = tree.getLeafCount();
+    numClusters = std::max< std::size_t >( 1, std::min( numClusters, numLeafs ) );
+
+    // the clusters are numbered in the order of the merges, so undoing the last merges leaves the clusters up to the
+    // last kept merge, and the roots among them are the clusters of the cut
+    std::size_t const kept = 2 * numLeafs - numClusters;
+    std::vector< std::size_t > roots( kept );
+    for( std::size_t cluster = 0; cluster < kept; ++cluster )
+    {
+        roots[ cluster ] = cluster;
+    }
+    for( std::size_t cluster = kept; cluster-- > numLeafs; )
+    {
+        std::pair< std::size_t, std::size_t > const children = tree.getChildren( cluster );
+        roots[ children.first ] = roots[ cluster ];
+        roots[ children.second ] = roots[ cluster ];
+    }
+
+    std::map< std::size_t, WFiberCluster::IndexList > indices;
+    std::vector< std::size_t > ids( kept, numClusters );
+    for( std::size_t leaf = 0; leaf < numLeafs; ++leaf )
+    {
+        std::size_t& id = ids[ roots[ leaf ] ];
+        if( id == numClusters )
+        {
+            id = indices.size();
+        }
+        indices[ id ].push_back( leaf );
+    }
+
+    WDataSetFiberClustering::ClusterMap clusters;
+    for( std::map< std::size_t, WFiberCluster::IndexList >::const_iterator it = indices.begin(); it != indices.end(); ++it )
+    {
+        clusters[ it->first ] = WFiberCluster::SPtr( new WFiberCluster( it->second ) );
+    }
+    return WDataSetFiberClustering::SPtr( new WDataSetFiberClustering( clusters ) );
+}
+
+float WFiberAgglomerativeClustering::linkage( State const& state, std::size_t a, std::size_t b ) const
+{
+    float const* p = &state.m_centroids[ m_dimension * a ];
+    float const* q = &state.m_centroids[ m_dimension * b ];
+    float const sizeA = state.m_sizes[ a ];
+    float const sizeB = state.m_sizes[ b ];
+
+    // independent partial sums, so the compiler can keep several additions in flight
+    float sums[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f }; // NOLINT
+    std::size_t c = 0;
+    for( ; c + 4 <= m_dimension; c += 4 )
+    {
+        for( std::size_t lane = 0; lane < 4; ++lane )
+        {
+            float const d = p[ c + lane ] - q[ c + lane ];
+            sums[ lane ] += d * d;
+        }
+    }
+    for( ; c < m_dimension; ++c )
+    {
+        float const d = p[ c ] - q[ c ];
+        sums[ 0 ] += d * d;
+    }
+    return sizeA * sizeB / ( sizeA + sizeB ) * ( ( sums[ 0 ] + sums[ 1 ] ) + ( sums[ 2 ] + sums[ 3 ] ) );
+}
+
+void WFiberAgglomerativeClustering::nearest( State const& state, std::size_t query, std::size_t begin, std::size_t end,
+                                             float* distance, std::size_t* neighbor ) const
+{
+    *distance = std::numeric_limits< float >::infinity();
+    *neighbor = query;
+    for( std::size_t position = begin; position < end; ++position )
+    {
+        std::size_t const slot = state.m_active[ position ];
+        if( slot == query )
+        {
+            continue;
+        }
+        float const d = linkage( state, query, slot );
+        if( d < *distance || *neighbor == query )
+        {
+            *distance = d;
+            *neighbor = slot;
+        }
+    }
+}
+
+void WFiberAgglomerativeClustering::nearest( State const& state, NeighborSearch* search, std::size_t query, float* distance,
+                                             std::size_t* neighbor ) const
+{
+    if( !search || state.m_active.size() * m_dimension < ParallelWork )
+    {
+        nearest( state, query, 0, state.m_active.size(), distance, neighbor );
+        return;
+    }
+    search->search( query, distance, neighbor );
+}
@@ -0,0 +1,174 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WFIBERAGGLOMERATIVECLUSTERING_H
+#define WFIBERAGGLOMERATIVECLUSTERING_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../common/WFlag.h"
+#include "../common/WHierarchicalTreeFibers.h"
+#include "../common/WProgress.h"
+#include "WDataSetFiberClustering.h"
+#include "WDataSetFibers.h"
+
+/**
+ * Builds a hierarchical clustering of the fibers of a dataset with Ward's linkage, as a tree that WMClusterDisplay can
+ * show and browse.
+ *
+ * Every fiber is resampled to the same number of points and oriented canonically, so it is a point in a vector space
+ * of three times that dimension. Clusters are represented by their centroid and size, which is all Ward's linkage
+ * needs, so the memory stays linear in the number of fibers. The merges are found with the nearest-neighbor chain
+ * algorithm, which is exact for Ward's linkage and only needs nearest neighbor queries. Large queries are split over
+ * several threads.
+ */
+class WFiberAgglomerativeClustering // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFiberAgglomerativeClustering > SPtr;
+
+    /**
+     * Resamples and orients the fibers.
+     *
+     * \param fibers the fibers
+     * \param numPoints the number of points every fiber is resampled to, at least 1
+     * \param numThreads the number of threads, 0 to choose automatically
+     */
+    WFiberAgglomerativeClustering( WDataSetFibers::ConstSPtr fibers, std::size_t numPoints = 20, std::size_t numThreads = 0 );
+
+    /**
+     * The number of fibers, i.e. leafs of the tree.
+     *
+     * \return the number of fibers
+     */
+    std::size_t size() const;
+
+    /**
+     * Clusters the fibers. The leafs of the tree are the fibers, the inner clusters are sorted by their merge distance,
+     * so the root is the last cluster. The custom data of a cluster is its merge distance, scaled so that two single fibers
+     * are merged at the root mean square distance of their points.
+     *
+     * \param shutdown stops the clustering when set
+     * \param progress if given, incremented by the number of merges
+     *
+     * \return the tree, or NULL if the clustering was stopped
+     */
+    boost::shared_ptr< WHierarchicalTreeFibers > compute( WBoolFlag const& shutdown, WProgress::SPtr progress = WProgress::SPtr() ) const;
+
+    /**
+     * Cuts a tree built by compute() into a flat clustering by undoing the last merges.
+     *
+     * \param tree the tree
+     * \param numClusters the number of clusters, clamped to the number of leafs
+     *
+     * \return the clustering, with the clusters numbered by their smallest fiber
+     */
+    static WDataSetFiberClustering::SPtr cut( WHierarchicalTreeFibers const& tree, std::size_t numClusters );
+
+private:
+    /**
+     * The clusters during the agglomeration.
+     */
+    struct State;
+
+    /**
+     * The workers searching nearest neighbors during a clustering, to be run by a WThreadedFunction.
+     */
+    class NeighborSearch;
+
+    /**
+     * Disallow copy.
+     *
+     * \param other the other instance
+     */
+    explicit WFiberAgglomerativeClustering( WFiberAgglomerativeClustering const& other );
+
+    /**
+     * Disallow copy.
+     *
+     * \param other the other instance
+     *
+     * \return this
+     */
+    WFiberAgglomerativeClustering& operator=( WFiberAgglomerativeClustering const& other );
+
+    /**
+     * Ward's linkage of two clusters, i.e. the increase of the sum of squared distances to the centroids when merging them.
+     *
+     * \param state the clusters
+     * \param a the first cluster
+     * \param b the second cluster
+     *
+     * \return the linkage
+     */
+    float linkage( State const& state, std::size_t a, std::size_t b ) const;
+
+    /**
+     * Searches the nearest neighbor of a cluster among some of the active clusters. Ties are resolved in favor of the
+     * first cluster.
+     *
+     * \param state the clusters
+     * \param query the cluster
+     * \param begin the position of the first active cluster to check
+     * \param end the position behind the last active cluster to check
+     * \param distance receives the linkage of the nearest neighbor, infinity if there is none
+     * \param neighbor receives the nearest neighbor
+     */
+    void nearest( State const& state, std::size_t query, std::size_t begin, std::size_t end, float* distance, std::size_t* neighbor ) const;
+
+    /**
+     * Searches the nearest neighbor of a cluster among all active clusters, in parallel if there are many.
+     *
+     * \param state the clusters
+     * \param search the workers, NULL to always search serially
+     * \param query the cluster
+     * \param distance receives the linkage of the nearest neighbor
+     * \param neighbor receives the nearest neighbor
+     */
+    void nearest( State const& state, NeighborSearch* search, std::size_t query, float* distance, std::size_t* neighbor ) const;
+
+    /**
+     * The number of coordinates of a resampled fiber.
+     */
+    std::size_t m_dimension;
+
+    /**
+     * The number of threads, 0 for automatic.
+     */
+    std::size_t m_numThreads;
+
+    /**
+     * The coordinates of the resampled fibers, m_dimension per fiber.
+     */
+    std::vector< float > m_points;
+};
+
+#endif  // WFIBERAGGLOMERATIVECLUSTERING_H
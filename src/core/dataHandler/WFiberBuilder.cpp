@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <vector>
+
+#include "WFiberBuilder.h"
+
+WFiberBuilder::Buffer::Buffer( WFiberBuilder::SPtr builder, size_t expectedFiberLength, size_t fibersPerBatch )
+    : m_builder( builder ),
+      m_expectedFiberLength( expectedFiberLength ),
+      m_fibersPerBatch( std::max< size_t >( fibersPerBatch, 1 ) ),
+      m_batch( NULL )
+{
+}
+
+WFiberBuilder::Buffer::~Buffer()
+{
+    flush();
+}
+
+void WFiberBuilder::Buffer::add( std::vector< WVector3d > const& fiber )
+{
+    if( fiber.empty() )
+    {
+        return;
+    }
+    if( !m_batch )
+    {
+        m_batch = new Batch();
+        m_batch->m_vertices.reserve( 3 * m_fibersPerBatch * m_expectedFiberLength );
+        m_batch->m_lengths.reserve( m_fibersPerBatch );
+        m_batch->m_next = NULL;
+    }
+
+    std::vector< float >& vertices = m_batch->m_vertices;
+    for( size_t k = 0; k < fiber.size(); ++k )
+    {
+        float x = static_cast< float >( fiber[ k ][ 0 ] );
+        float y = static_cast< float >( fiber[ k ][ 1 ] );
+        float z = static_cast< float >( fiber[ k ][ 2 ] );
+        vertices.push_back( x );
+        vertices.push_back( y );
+        vertices.push_back( z );
+        m_batch->m_bb.expandBy( x, y, z );
+    }
+    m_batch->m_lengths.push_back( fiber.size() );
+
+    if( m_batch->m_lengths.size() >= m_fibersPerBatch )
+    {
+        flush();
+    }
+}
+
+void WFiberBuilder::Buffer::flush()
+{
+    if( m_batch )
+    {
+        m_builder->append( m_batch );
+        m_batch = NULL;
+    }
+}
+
+WFiberBuilder::WFiberBuilder( size_t notifyInterval )
+    : m_head( NULL ),
+      m_numFibers( 0 ),
+      m_numVertices( 0 ),
+      m_notifyInterval( notifyInterval ),
+      m_changeCondition( new WCondition() )
+{
+}
+
+WFiberBuilder::~WFiberBuilder()
+{
+    clear();
+}
+
+size_t WFiberBuilder::getNumFibers() const
+{
+    return m_numFibers.load( boost::memory_order_relaxed );
+}
+
+size_t WFiberBuilder::getNumVertices() const
+{
+    return m_numVertices.load( boost::memory_order_relaxed );
+}
+
+void WFiberBuilder::append( Batch* batch )
+{
+    Batch* head = m_head.load( boost::memory_order_relaxed );
+    do
+    {
+        batch->m_next = head;
+    }
+    while( !m_head.compare_exchange_weak( head, batch, boost::memory_order_release, boost::memory_order_relaxed ) );
+
+    m_numVertices.fetch_add( batch->m_vertices.size() / 3, boost::memory_order_relaxed );
+    size_t before = m_numFibers.fetch_add( batch->m_lengths.size(), boost::memory_order_relaxed );
+    if( m_notifyInterval > 0 && before / m_notifyInterval != ( before + batch->m_lengths.size() ) / m_notifyInterval )
+    {
+        m_changeCondition->notify();
+    }
+}
+
+boost::shared_ptr< WDataSetFibers > WFiberBuilder::buildDataSet() const
+{
+    // batches never change after they were appended, so a consistent snapshot is everything behind the current head
+    std::vector< Batch const* > batches;
+    size_t numVertices = 0;
+    size_t numFibers = 0;
+    for( Batch const* b = m_head.load( boost::memory_order_acquire ); b; b = b->m_next )
+    {
+        batches.push_back( b );
+        numVertices += b->m_vertices.size() / 3;
+        numFibers += b->m_lengths.size();
+    }
+
+    WDataSetFibers::VertexArray vertices( new std::vector< float >() );
+    WDataSetFibers::IndexArray startIndexes( new std::vector< size_t >() );
+    WDataSetFibers::LengthArray lengths( new std::vector< size_t >() );
+    WDataSetFibers::IndexArray verticesReverse( new std::vector< size_t >() );
+    vertices->reserve( 3 * numVertices );
+    startIndexes->reserve( numFibers );
+    lengths->reserve( numFibers );
+    verticesReverse->reserve( numVertices );
+    WBoundingBox bb;
+
+    // in the order of appending
+    for( std::vector< Batch const* >::const_reverse_iterator it = batches.rbegin(); it != batches.rend(); ++it )
+    {
+        Batch const& b = **it;
+        vertices->insert( vertices->end(), b.m_vertices.begin(), b.m_vertices.end() );
+        for( size_t k = 0; k < b.m_lengths.size(); ++k )
+        {
+            startIndexes->push_back( verticesReverse->size() );
+            lengths->push_back( b.m_lengths[ k ] );
+            verticesReverse->insert( verticesReverse->end(), b.m_lengths[ k ], lengths->size() - 1 );
+        }
+        bb.expandBy( b.m_bb );
+    }
+
+    return boost::shared_ptr< WDataSetFibers >( new WDataSetFibers( vertices, startIndexes, lengths, verticesReverse, bb ) );
+}
+
+void WFiberBuilder::clear()
+{
+    Batch* b = m_head.exchange( NULL, boost::memory_order_acquire );
+    while( b )
+    {
+        Batch* next = b->m_next;
+        delete b;
+        b = next;
+    }
+    m_numFibers.store( 0 );
+    m_numVertices.store( 0 );
+}
+
+boost::shared_ptr< WCondition > WFiberBuilder::getChangeCondition() const
+{
+    return m_changeCondition;
+}
@@ -0,0 +1,247 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERBUILDER_H
+#define WFIBERBUILDER_H
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../common/math/linearAlgebra/WVectorFixed.h"
+#include "../common/WBoundingBox.h"
+#include "../common/WCondition.h"
+#include "WDataSetFibers.h"
+
+/**
+ * Collects fibers computed by several threads and builds a WDataSetFibers from them. Every thread fills its own
+ * Buffer in single precision, which hands its fibers to the builder in batches. Appending a batch is lock-free, and a
+ * dataset of all fibers appended so far can be built at any time, so partial results can be shown while the fibers
+ * are still being computed.
+ */
+class WFiberBuilder
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFiberBuilder > SPtr;
+
+private:
+    /**
+     * A block of fibers appended at once. Batches are immutable once they were appended.
+     */
+    struct Batch
+    {
+        /**
+         * The vertices of the fibers, x1, y1, z1, x2, ...
+         */
+        std::vector< float > m_vertices;
+
+        /**
+         * The number of vertices of each fiber.
+         */
+        std::vector< size_t > m_lengths;
+
+        /**
+         * The bounding box of the vertices.
+         */
+        WBoundingBox m_bb;
+
+        /**
+         * The batch appended before this one.
+         */
+        Batch* m_next;
+    };
+
+public:
+    /**
+     * A per-thread buffer for fibers. It passes its fibers to the builder whenever a batch is full and on destruction.
+     */
+    class Buffer
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * \param builder The builder that receives the fibers.
+         * \param expectedFiberLength The expected number of vertices per fiber, used to reserve memory.
+         * \param fibersPerBatch The number of fibers passed to the builder at once.
+         */
+        explicit Buffer( WFiberBuilder::SPtr builder, size_t expectedFiberLength = 64, size_t fibersPerBatch = 256 );
+
+        /**
+         * Destructor. Passes the remaining fibers to the builder.
+         */
+        ~Buffer();
+
+        /**
+         * Adds a fiber. Empty fibers are ignored.
+         *
+         * \param fiber The vertices of the fiber.
+         */
+        void add( std::vector< WVector3d > const& fiber );
+
+        /**
+         * Passes all fibers added so far to the builder.
+         */
+        void flush();
+
+    private:
+        /**
+         * Not copyable.
+         *
+         * \param other the buffer
+         */
+        explicit Buffer( Buffer const& other );
+
+        /**
+         * Not copyable.
+         *
+         * \param other the buffer
+         *
+         * \return this buffer
+         */
+        Buffer& operator=( Buffer const& other );
+
+        /**
+         * The builder.
+         */
+        WFiberBuilder::SPtr m_builder;
+
+        /**
+         * The expected number of vertices per fiber.
+         */
+        size_t m_expectedFiberLength;
+
+        /**
+         * The number of fibers per batch.
+         */
+        size_t m_fibersPerBatch;
+
+        /**
+         * The batch being filled, or NULL.
+         */
+        Batch* m_batch;
+    };
+
+    /**
+     * Constructor.
+     *
+     * \param notifyInterval The change condition is notified whenever the number of fibers crosses a multiple of
+     * this value. Zero disables the notification.
+     */
+    explicit WFiberBuilder( size_t notifyInterval = 0 );
+
+    /**
+     * Destructor.
+     */
+    ~WFiberBuilder();
+
+    /**
+     * The number of fibers appended so far.
+     *
+     * \return the number of fibers
+     */
+    size_t getNumFibers() const;
+
+    /**
+     * The number of vertices appended so far.
+     *
+     * \return the number of vertices
+     */
+    size_t getNumVertices() const;
+
+    /**
+     * Builds a dataset of all fibers appended so far. The builder keeps its fibers. This may be called while other
+     * threads are appending fibers.
+     *
+     * \return The fibers.
+     */
+    boost::shared_ptr< WDataSetFibers > buildDataSet() const;
+
+    /**
+     * Removes all fibers. Must not be called while fibers are appended.
+     */
+    void clear();
+
+    /**
+     * A condition that gets notified as configured by the notify interval.
+     *
+     * \return the condition
+     */
+    boost::shared_ptr< WCondition > getChangeCondition() const;
+
+private:
+    /**
+     * Not copyable.
+     *
+     * \param other the builder
+     */
+    explicit WFiberBuilder( WFiberBuilder const& other );
+
+    /**
+     * Not copyable.
+     *
+     * \param other the builder
+     *
+     * \return this builder
+     */
+    WFiberBuilder& operator=( WFiberBuilder const& other );
+
+    /**
+     * Appends a batch, the builder takes ownership.
+     *
+     * \param batch The batch.
+     */
+    void append( Batch* batch );
+
+    /**
+     * The most recently appended batch.
+     */
+    boost::atomic< Batch* > m_head;
+
+    /**
+     * The number of fibers.
+     */
+    boost::atomic< size_t > m_numFibers;
+
+    /**
+     * The number of vertices.
+     */
+    boost::atomic< size_t > m_numVertices;
+
+    /**
+     * The number of fibers between two notifications.
+     */
+    size_t m_notifyInterval;
+
+    /**
+     * Notified as configured by m_notifyInterval.
+     */
+    boost::shared_ptr< WCondition > m_changeCondition;
+};
+
+#endif  // WFIBERBUILDER_H
@@ -0,0 +1,283 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "../common/WFlag.h"
+#include "../common/WThreadedFunction.h"
+#include "WFiberDirectionArrays.h"
+
+/**
+ * Fills the tangents and colors of a contiguous range of fibers per thread. The start indices of the fibers are the
+ * prefix sum of their lengths, so every thread knows where its fibers are without looking at the others.
+ */
+class WFiberDirectionArrays::Filler // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param arrays the arrays to fill, already sized
+     */
+    explicit Filler( WFiberDirectionArrays const& arrays ):
+        m_vertices( arrays.m_vertices ),
+        m_starts( arrays.m_lineStartIndexes ),
+        m_lengths( arrays.m_lineLengths ),
+        m_tangents( arrays.m_tangents ),
+        m_globalColors( arrays.m_globalColors ),
+        m_localColors( arrays.m_localColors )
+    {
+    }
+
+    /**
+     * Fills the arrays for this thread's part of the fibers.
+     *
+     * \param id the thread id
+     * \param numThreads the number of threads
+     * \param shutdown not used, the arrays are always completed
+     */
+    void operator()( size_t id, size_t numThreads, WBoolFlag const& /* shutdown */ )
+    {
+        std::pair< size_t, size_t > const range = getThreadRange( m_starts->size(), id, numThreads );
+        for( size_t fidx = range.first; fidx < range.second; ++fidx )
+        {
+            fillFiber( 3 * ( *m_starts )[ fidx ], ( *m_lengths )[ fidx ] );
+        }
+    }
+
+private:
+    /**
+     * Normalizes a vector in place. Null vectors stay null.
+     *
+     * \param v the three components
+     */
+    static void normalize( float* v )
+    {
+        float norm = std::sqrt( v[ 0 ] * v[ 0 ] + v[ 1 ] * v[ 1 ] + v[ 2 ] * v[ 2 ] );
+        if( norm == 0.0f )
+        {
+            norm = 1.0f;
+        }
+        v[ 0 ] /= norm;
+        v[ 1 ] /= norm;
+        v[ 2 ] /= norm;
+    }
+
+    /**
+     * Fills the arrays of one fiber.
+     *
+     * \param first the index of the first float of the fiber
+     * \param length the number of vertices
+     */
+    void fillFiber( size_t first, size_t length )
+    {
+        if( length == 0 )
+        {
+            return;
+        }
+        std::vector< float > const& v = *m_vertices;
+
+        size_t const last = first + 3 * ( length - 1 );
+        float global[ 3 ] = { std::abs( v[ first ] - v[ last ] ), std::abs( v[ first + 1 ] - v[ last + 1 ] ), // NOLINT
+                              std::abs( v[ first + 2 ] - v[ last + 2 ] ) };
+        normalize( global );
+
+        for( size_t k = 0; k < length; ++k )
+        {
+            size_t const i = first + 3 * k;
+            float tangent[ 3 ] = { 0.0f, 0.0f, 0.0f }; // NOLINT
+            if( k > 0 )
+            {
+                for( size_t c = 0; c < 3; ++c )
+                {
+                    tangent[ c ] = v[ i - 3 + c ] - v[ i + c ];
+                }
+            }
+            else if( length > 1 )
+            {
+                for( size_t c = 0; c < 3; ++c )
+                {
+                    tangent[ c ] = v[ i + c ] - v[ i + 3 + c ];
+                }
+            }
+            normalize( tangent );
+
+            for( size_t c = 0; c < 3; ++c )
+            {
+                ( *m_tangents )[ i + c ] = tangent[ c ];
+                ( *m_localColors )[ i + c ] = std::abs( tangent[ c ] );
+                ( *m_globalColors )[ i + c ] = global[ c ];
+            }
+        }
+    }
+
+    /**
+     * The vertices.
+     */
+    boost::shared_ptr< std::vector< float > const > m_vertices;
+
+    /**
+     * The index of the first vertex of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_starts;
+
+    /**
+     * The number of vertices of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_lengths;
+
+    /**
+     * The tangents.
+     */
+    boost::shared_ptr< std::vector< float > > m_tangents;
+
+    /**
+     * The global colors.
+     */
+    boost::shared_ptr< std::vector< float > > m_globalColors;
+
+    /**
+     * The local colors.
+     */
+    boost::shared_ptr< std::vector< float > > m_localColors;
+};
+
+WFiberDirectionArrays::WFiberDirectionArrays( boost::shared_ptr< std::vector< float > const > vertices,
+                                              boost::shared_ptr< std::vector< size_t > const > lineStartIndexes,
+                                              boost::shared_ptr< std::vector< size_t > const > lineLengths,
+                                              size_t numThreads ):
+    m_vertices( vertices ),
+    m_lineStartIndexes( lineStartIndexes ),
+    m_lineLengths( lineLengths ),
+    m_numThreads( numThreads ),
+    m_reservation( new WMemoryReservation( getArraySize(), "fiber colors" ) ),
+    m_cacheReservation( new WMemoryReservation( 3 * getArraySize(), "fiber directions" ) )
+{
+    m_evictionConnection = WMemoryBudget::getMemoryBudget()->subscribeEviction( boost::bind( &WFiberDirectionArrays::evict, this ) );
+}
+
+WFiberDirectionArrays::~WFiberDirectionArrays()
+{
+    WMemoryBudget::getMemoryBudget()->unsubscribeEviction( m_evictionConnection );
+}
+
+boost::shared_ptr< std::vector< float > > WFiberDirectionArrays::getTangents()
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    compute();
+    return m_tangents;
+}
+
+boost::shared_ptr< std::vector< float > > WFiberDirectionArrays::getGlobalColors()
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    compute();
+    return m_globalColors;
+}
+
+boost::shared_ptr< std::vector< float > > WFiberDirectionArrays::getLocalColors()
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    compute();
+    return m_localColors;
+}
+
+boost::shared_ptr< std::vector< float > > WFiberDirectionArrays::getCustomColors()
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    compute();
+    return m_customColors;
+}
+
+bool WFiberDirectionArrays::isComputed() const
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    return m_tangents != NULL;
+}
+
+size_t WFiberDirectionArrays::getMemoryUsage() const
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    size_t usage = m_customColors ? m_customColors->capacity() * sizeof( float ) : 0;
+    if( m_tangents )
+    {
+        usage += ( m_tangents->capacity() + m_globalColors->capacity() + m_localColors->capacity() ) * sizeof( float );
+    }
+    return usage;
+}
+
+void WFiberDirectionArrays::evict()
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex, boost::try_to_lock );
+    if( !lock.owns_lock() || ( m_tangents && ( !m_tangents.unique() || !m_globalColors.unique() || !m_localColors.unique() ) ) )
+    {
+        return;
+    }
+    m_tangents.reset();
+    m_globalColors.reset();
+    m_localColors.reset();
+    m_cacheReservation.reset();
+}
+
+size_t WFiberDirectionArrays::getArraySize() const
+{
+    return m_vertices->size() * sizeof( float );
+}
+
+void WFiberDirectionArrays::compute()
+{
+    if( m_tangents )
+    {
+        return;
+    }
+
+    if( !m_cacheReservation )
+    {
+        // the caller cannot handle a refusal, see the class description
+        m_cacheReservation.reset( new WMemoryReservation( 3 * getArraySize(), "fiber directions", false ) );
+    }
+
+    size_t const size = m_vertices->size();
+    m_tangents.reset( new std::vector< float >( size ) );
+    m_globalColors.reset( new std::vector< float >( size ) );
+    m_localColors.reset( new std::vector< float >( size ) );
+
+    if( !m_lineStartIndexes->empty() )
+    {
+        boost::shared_ptr< Filler > filler( new Filler( *this ) );
+        WThreadedFunction< Filler > pool( std::min( m_numThreads, m_lineStartIndexes->size() ), filler );
+        pool.run();
+        pool.wait();
+    }
+
+    if( !m_customColors )
+    {
+        m_customColors.reset( new std::vector< float >( *m_globalColors ) );
+    }
+}
@@ -0,0 +1,220 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERDIRECTIONARRAYS_H
+#define WFIBERDIRECTIONARRAYS_H
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/signals2/connection.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../common/WMemoryReservation.h"
+
+/**
+ * The tangents and the direction colors of a fiber dataset. The arrays are computed in parallel on the first access
+ * of any of them, so datasets whose colors are never shown do not pay for them. Their memory is reserved in the memory
+ * budget on construction though, as the first access usually happens on the render thread, which cannot handle a
+ * WOutOfMemoryBudget. If the budget is exceeded, the tangents and the global and local colors are evicted as long as
+ * nobody else uses them, and computed again on the next access. The custom colors may have been modified, so they are
+ * kept. All methods are thread-safe.
+ *
+ * The tangent at a vertex is the normalized difference of the previous and the vertex itself, the first vertex uses
+ * the difference to the second one. The local color is the absolute tangent, the global color of all vertices of a
+ * fiber is the absolute normalized difference of its first and last vertex.
+ */
+class WFiberDirectionArrays // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFiberDirectionArrays > SPtr;
+
+    /**
+     * Creates the arrays for the given fibers without computing them, but reserves their memory.
+     *
+     * \param vertices the vertices, x1, y1, z1, x2, ...
+     * \param lineStartIndexes the index of the first vertex of each fiber
+     * \param lineLengths the number of vertices of each fiber
+     * \param numThreads the number of threads, 0 to choose automatically
+     *
+     * \throw WOutOfMemoryBudget if the arrays do not fit into the memory budget
+     */
+    WFiberDirectionArrays( boost::shared_ptr< std::vector< float > const > vertices,
+                           boost::shared_ptr< std::vector< size_t > const > lineStartIndexes,
+                           boost::shared_ptr< std::vector< size_t > const > lineLengths,
+                           size_t numThreads = 0 );
+
+    /**
+     * Destructor.
+     */
+    ~WFiberDirectionArrays();
+
+    /**
+     * The normalized tangents, three floats per vertex.
+     *
+     * \return the tangents
+     */
+    boost::shared_ptr< std::vector< float > > getTangents();
+
+    /**
+     * The RGB colors of the direction of each fiber.
+     *
+     * \return the colors
+     */
+    boost::shared_ptr< std::vector< float > > getGlobalColors();
+
+    /**
+     * The RGB colors of the direction of each segment.
+     *
+     * \return the colors
+     */
+    boost::shared_ptr< std::vector< float > > getLocalColors();
+
+    /**
+     * A copy of the global colors meant to be modified, e.g. for bundle coloring.
+     *
+     * \return the colors
+     */
+    boost::shared_ptr< std::vector< float > > getCustomColors();
+
+    /**
+     * Whether the arrays were computed and not evicted since.
+     *
+     * \return true if the arrays exist
+     */
+    bool isComputed() const;
+
+    /**
+     * The memory held by the arrays.
+     *
+     * \return the memory in bytes, 0 as long as the arrays were not computed
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Releases the tangents and the global and local colors if nobody else uses them. Called by the memory budget.
+     * Does nothing if the arrays are in use by another thread.
+     */
+    void evict();
+
+private:
+    /**
+     * Fills the arrays for a range of fibers, to be run by a WThreadedFunction.
+     */
+    class Filler;
+
+    /**
+     * Not copyable.
+     *
+     * \param other the arrays
+     */
+    explicit WFiberDirectionArrays( WFiberDirectionArrays const& other );
+
+    /**
+     * Not copyable.
+     *
+     * \param other the arrays
+     *
+     * \return this
+     */
+    WFiberDirectionArrays& operator=( WFiberDirectionArrays const& other );
+
+    /**
+     * Computes the arrays if that did not happen yet or they were evicted. Needs m_mutex.
+     */
+    void compute();
+
+    /**
+     * Size of one array.
+     *
+     * \return the size in bytes
+     */
+    size_t getArraySize() const;
+
+    /**
+     * The vertices.
+     */
+    boost::shared_ptr< std::vector< float > const > m_vertices;
+
+    /**
+     * The index of the first vertex of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_lineStartIndexes;
+
+    /**
+     * The number of vertices of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_lineLengths;
+
+    /**
+     * The number of threads used to compute the arrays.
+     */
+    size_t m_numThreads;
+
+    /**
+     * Protects the arrays.
+     */
+    mutable boost::mutex m_mutex;
+
+    /**
+     * The tangents, NULL until computed.
+     */
+    boost::shared_ptr< std::vector< float > > m_tangents;
+
+    /**
+     * The global colors, NULL until computed.
+     */
+    boost::shared_ptr< std::vector< float > > m_globalColors;
+
+    /**
+     * The local colors, NULL until computed.
+     */
+    boost::shared_ptr< std::vector< float > > m_localColors;
+
+    /**
+     * The custom colors, NULL until computed.
+     */
+    boost::shared_ptr< std::vector< float > > m_customColors;
+
+    /**
+     * The memory of the custom colors reserved in the global memory budget, taken on construction.
+     */
+    WMemoryReservation::SPtr m_reservation;
+
+    /**
+     * The memory of the other arrays reserved in the global memory budget. Taken on construction, released on
+     * eviction and taken again when computing them again.
+     */
+    WMemoryReservation::SPtr m_cacheReservation;
+
+    /**
+     * The subscription to the evictions of the memory budget.
+     */
+    boost::signals2::connection m_evictionConnection;
+};
+
+#endif  // WFIBERDIRECTIONARRAYS_H
@@ -0,0 +1,377 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../common/datastructures/WFiber.h"
+#include "../common/WFlag.h"
+#include "../common/WThreadedFunction.h"
+#include "io/WWriterMatrixSymVTK.h"
+#include "WFiberDistanceMatrix.h"
+
+const std::size_t WFiberDistanceMatrix::TileSize;
+
+namespace
+{
+    /**
+     * The position of the first element of a row in the elements of a WMatrixSym.
+     *
+     * \param row the row
+     * \param n the number of rows
+     *
+     * \return the index of the element ( row, row + 1 )
+     */
+    std::size_t rowOffset( std::size_t row, std::size_t n )
+    {
+        return row * n - row * ( row + 1 ) / 2;
+    }
+
+    /**
+     * The number of rows written to a file at once. Together with the number of fibers, this bounds the memory used by
+     * WFiberDistanceMatrix::write().
+     */
+    const std::size_t RowsPerBlock = 4 * WFiberDistanceMatrix::TileSize;
+}
+
+/**
+ * Computes the tiles of a block of rows, to be run by a WThreadedFunction. A tile consists of up to TileSize rows and
+ * columns, so the points of both sets of fibers stay in the cache while all their pairs are computed. The threads take
+ * the next tile from a shared counter, which balances the different lengths of the rows.
+ */
+class WFiberDistanceMatrix::TileWorker // NOLINT
+{
+public:
+    /**
+     * Lists the tiles of the rows.
+     *
+     * \param matrix the distance matrix
+     * \param begin the first row
+     * \param end the row behind the last row
+     * \param elements receives the distances of the rows
+     */
+    TileWorker( WFiberDistanceMatrix const& matrix, std::size_t begin, std::size_t end, float* elements ):
+        m_matrix( matrix ),
+        m_begin( begin ),
+        m_elements( elements ),
+        m_nextTile( 0 )
+    {
+        std::size_t const n = matrix.size();
+        for( std::size_t row = begin; row < end; row += TileSize )
+        {
+            for( std::size_t column = row + 1; column < n; column += TileSize )
+            {
+                Tile tile = { row, std::min( end, row + TileSize ), column, std::min( n, column + TileSize ) }; // NOLINT
+                m_tiles.push_back( tile );
+            }
+        }
+    }
+
+    /**
+     * Computes tiles until there are none left.
+     *
+     * \param shutdown stops the computation when set
+     */
+    void operator()( std::size_t /* id */, std::size_t /* numThreads */, WBoolFlag const& shutdown )
+    {
+        std::size_t const n = m_matrix.size();
+        std::size_t const first = rowOffset( m_begin, n );
+        std::vector< float > columnMin;
+
+        Tile const* tile;
+        while( !shutdown() && ( tile = nextTile() ) )
+        {
+            for( std::size_t i = tile->m_rowBegin; i < tile->m_rowEnd; ++i )
+            {
+                // the element ( i, i + 1 ) of the row
+                float* row = m_elements + ( rowOffset( i, n ) - first );
+                for( std::size_t j = std::max( i + 1, tile->m_columnBegin ); j < tile->m_columnEnd; ++j )
+                {
+                    row[ j - i - 1 ] = m_matrix.isPruned( i, j ) ? std::numeric_limits< float >::infinity() :
+                                                                    m_matrix.pairDistance( i, j, &columnMin );
+                }
+            }
+        }
+    }
+
+private:
+    /**
+     * A rectangle of fiber pairs.
+     */
+    struct Tile
+    {
+        std::size_t m_rowBegin; //!< the first row
+        std::size_t m_rowEnd; //!< the row behind the last row
+        std::size_t m_columnBegin; //!< the first column
+        std::size_t m_columnEnd; //!< the column behind the last column
+    };
+
+    /**
+     * Takes the next tile.
+     *
+     * \return the tile, or NULL if all tiles are taken
+     */
+    Tile const* nextTile()
+    {
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        return m_nextTile < m_tiles.size() ? &m_tiles[ m_nextTile++ ] : NULL;
+    }
+
+    /**
+     * The distance matrix.
+     */
+    WFiberDistanceMatrix const& m_matrix;
+
+    /**
+     * The first row.
+     */
+    std::size_t m_begin;
+
+    /**
+     * The distances of the rows.
+     */
+    float* m_elements;
+
+    /**
+     * All tiles of the rows.
+     */
+    std::vector< Tile > m_tiles;
+
+    /**
+     * The index of the next tile to compute.
+     */
+    std::size_t m_nextTile;
+
+    /**
+     * Protects m_nextTile.
+     */
+    boost::mutex m_mutex;
+};
+
+WFiberDistanceMatrix::WFiberDistanceMatrix( WDataSetFibers::ConstSPtr fibers, Measure measure, double proximityThreshold, double maxDistance,
+                                            std::size_t numPoints, std::size_t numThreads ):
+    m_measure( measure ),
+    m_thresholdSquare( static_cast< float >( proximityThreshold * proximityThreshold ) ),
+    m_maxDistance( maxDistance ),
+    m_numThreads( numThreads )
+{
+    std::vector< float > const& vertices = *fibers->getVertices();
+    std::vector< std::size_t > const& starts = *fibers->getLineStartIndexes();
+    std::vector< std::size_t > const& lengths = *fibers->getLineLengths();
+
+    m_starts.reserve( starts.size() + 1 );
+    m_boxes.reserve( 6 * starts.size() );
+    WFiber fiber;
+    for( std::size_t fidx = 0; fidx < starts.size(); ++fidx )
+    {
+        m_starts.push_back( m_x.size() );
+
+        fiber.clear();
+        for( std::size_t k = 0; k < lengths[ fidx ]; ++k )
+        {
+            std::size_t const v = 3 * ( starts[ fidx ] + k );
+            fiber.push_back( WPosition( vertices[ v ], vertices[ v + 1 ], vertices[ v + 2 ] ) );
+        }
+        if( numPoints > 0 )
+        {
+            fiber.resampleByNumberOfPoints( numPoints );
+        }
+
+        float box[] = { std::numeric_limits< float >::max(), std::numeric_limits< float >::max(), std::numeric_limits< float >::max(), // NOLINT
+                        -std::numeric_limits< float >::max(), -std::numeric_limits< float >::max(), -std::numeric_limits< float >::max() };
+        for( std::size_t k = 0; k < fiber.size(); ++k )
+        {
+            float const p[] = { static_cast< float >( fiber[ k ][ 0 ] ), static_cast< float >( fiber[ k ][ 1 ] ), // NOLINT
+                                static_cast< float >( fiber[ k ][ 2 ] ) };
+            m_x.push_back( p[ 0 ] );
+            m_y.push_back( p[ 1 ] );
+            m_z.push_back( p[ 2 ] );
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                box[ c ] = std::min( box[ c ], p[ c ] );
+                box[ c + 3 ] = std::max( box[ c + 3 ], p[ c ] );
+            }
+        }
+        m_boxes.insert( m_boxes.end(), box, box + 6 );
+    }
+    m_starts.push_back( m_x.size() );
+}
+
+std::size_t WFiberDistanceMatrix::size() const
+{
+    return m_starts.size() - 1;
+}
+
+float WFiberDistanceMatrix::getDistance( std::size_t i, std::size_t j ) const
+{
+    std::vector< float > columnMin;
+    return pairDistance( i, j, &columnMin );
+}
+
+void WFiberDistanceMatrix::computeRows( std::size_t begin, std::size_t end, float* elements ) const
+{
+    boost::shared_ptr< TileWorker > worker( new TileWorker( *this, begin, end, elements ) );
+    WThreadedFunction< TileWorker > pool( m_numThreads, worker );
+    pool.run();
+    pool.wait();
+}
+
+WMatrixSym< float >::SPtr WFiberDistanceMatrix::compute( WProgress::SPtr progress ) const
+{
+    std::size_t const n = size();
+    WMatrixSym< float >::SPtr matrix( new WMatrixSym< float >( n ) );
+
+    // the rows of a block are stored one after another, so they are written in place
+    for( std::size_t begin = 0; begin + 1 < n; begin += RowsPerBlock )
+    {
+        std::size_t const end = std::min( n - 1, begin + RowsPerBlock );
+        computeRows( begin, end, &matrix->operator()( begin, begin + 1 ) );
+        if( progress )
+        {
+            progress->increment( end - begin );
+        }
+    }
+    return matrix;
+}
+
+void WFiberDistanceMatrix::write( std::string const& fileName, WProgress::SPtr progress ) const
+{
+    std::size_t nextRow = 0;
+    WWriterMatrixSymVTK writer( fileName, true );
+    writer.writeTable( size(), boost::bind( &WFiberDistanceMatrix::nextBlock, this, &nextRow, progress, _1 ) );
+}
+
+void WFiberDistanceMatrix::nextBlock( std::size_t* nextRow, WProgress::SPtr progress, std::vector< float >* elements ) const
+{
+    std::size_t const n = size();
+    std::size_t const begin = *nextRow;
+    std::size_t const end = std::min( n - 1, begin + RowsPerBlock );
+    elements->resize( rowOffset( end, n ) - rowOffset( begin, n ) );
+    computeRows( begin, end, &( *elements )[ 0 ] );
+    *nextRow = end;
+    if( progress )
+    {
+        progress->increment( end - begin );
+    }
+}
+
+bool WFiberDistanceMatrix::isPruned( std::size_t q, std::size_t r ) const
+{
+    if( m_maxDistance == std::numeric_limits< double >::infinity() )
+    {
+        return false;
+    }
+
+    // the distance of the boxes is a lower bound of all closest point distances
+    float const* a = &m_boxes[ 6 * q ];
+    float const* b = &m_boxes[ 6 * r ];
+    double gapSquare = 0.0;
+    for( std::size_t c = 0; c < 3; ++c )
+    {
+        double const gap = std::max( 0.0f, std::max( a[ c ] - b[ c + 3 ], b[ c ] - a[ c + 3 ] ) );
+        gapSquare += gap * gap;
+    }
+
+    // closest point distances below the threshold count as zero, so the bound only holds above it
+    return gapSquare > m_maxDistance * m_maxDistance && gapSquare > m_thresholdSquare;
+}
+
+float WFiberDistanceMatrix::pairDistance( std::size_t q, std::size_t r, std::vector< float >* columnMin ) const
+{
+    std::size_t const qBegin = m_starts[ q ];
+    std::size_t const qSize = m_starts[ q + 1 ] - qBegin;
+    std::size_t const rBegin = m_starts[ r ];
+    std::size_t const rSize = m_starts[ r + 1 ] - rBegin;
+    if( qSize == 0 || rSize == 0 )
+    {
+        return 0.0f;
+    }
+
+    float const* rx = &m_x[ rBegin ];
+    float const* ry = &m_y[ rBegin ];
+    float const* rz = &m_z[ rBegin ];
+    columnMin->assign( rSize, std::numeric_limits< float >::max() );
+    float* cm = &( *columnMin )[ 0 ];
+
+    // the closest point of r to every point of q, and of q to every point of r in the same sweep
+    double qr = 0.0;
+    for( std::size_t i = 0; i < qSize; ++i )
+    {
+        float const px = m_x[ qBegin + i ];
+        float const py = m_y[ qBegin + i ];
+        float const pz = m_z[ qBegin + i ];
+
+        // the row minimum is kept in several lanes, so the loop has no dependency from one point to the next
+        float lanes[ 8 ]; // NOLINT
+        std::fill( lanes, lanes + 8, std::numeric_limits< float >::max() );
+        std::size_t j = 0;
+        for( ; j + 8 <= rSize; j += 8 )
+        {
+            for( std::size_t k = 0; k < 8; ++k )
+            {
+                float const dx = px - rx[ j + k ];
+                float const dy = py - ry[ j + k ];
+                float const dz = pz - rz[ j + k ];
+                float const d = dx * dx + dy * dy + dz * dz;
+                lanes[ k ] = d < lanes[ k ] ? d : lanes[ k ];
+                cm[ j + k ] = d < cm[ j + k ] ? d : cm[ j + k ];
+            }
+        }
+        for( ; j < rSize; ++j )
+        {
+            float const dx = px - rx[ j ];
+            float const dy = py - ry[ j ];
+            float const dz = pz - rz[ j ];
+            float const d = dx * dx + dy * dy + dz * dz;
+            lanes[ 0 ] = d < lanes[ 0 ] ? d : lanes[ 0 ];
+            cm[ j ] = d < cm[ j ] ? d : cm[ j ];
+        }
+
+        float const rowMin = *std::min_element( lanes, lanes + 8 );
+        if( rowMin > m_thresholdSquare )
+        {
+            qr += std::sqrt( rowMin );
+        }
+    }
+
+    double rq = 0.0;
+    for( std::size_t j = 0; j < rSize; ++j )
+    {
+        if( cm[ j ] > m_thresholdSquare )
+        {
+            rq += std::sqrt( cm[ j ] );
+        }
+    }
+
+    qr /= qSize;
+    rq /= rSize;
+    return static_cast< float >( m_measure == SMALLER_THRESHOLDED ? std::min( qr, rq ) : std::max( qr, rq ) );
+}
@@ -0,0 +1,231 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERDISTANCEMATRIX_H
+#define WFIBERDISTANCEMATRIX_H
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../common/math/WMatrixSym.h"
+#include "../common/WProgress.h"
+#include "WDataSetFibers.h"
+
+/**
+ * Computes the distances of all pairs of fibers of a dataset, using the thresholded distances of Zhang
+ * ( http://dx.doi.org/10.1109/TVCG.2008.52 ) like WFiber::distDST() and WFiber::distDLT().
+ *
+ * The fibers are resampled to the same number of points and stored as separate coordinate arrays, so the closest point
+ * search runs over contiguous floats and is vectorized by the compiler. The symmetric matrix is split into square tiles
+ * of fiber pairs, which the threads take one after another. Pairs whose bounding boxes are farther apart than the
+ * largest distance of interest are not computed at all, as their distance can only be larger.
+ */
+class WFiberDistanceMatrix // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFiberDistanceMatrix > SPtr;
+
+    /**
+     * The distance measures. Both are based on the mean distance of the points of one fiber to their closest point on
+     * the other fiber, ignoring closest point distances below the proximity threshold.
+     */
+    typedef enum
+    {
+        SMALLER_THRESHOLDED,    //!< dST, the smaller of both directed mean distances
+        LARGER_THRESHOLDED      //!< dLT, the larger of both directed mean distances
+    }
+    Measure;
+
+    /**
+     * Prepares the fibers for the distance computation.
+     *
+     * \param fibers the fibers
+     * \param measure the distance measure
+     * \param proximityThreshold closest point distances up to this are ignored
+     * \param maxDistance pairs of fibers that are certainly farther apart than this get infinity as distance
+     * \param numPoints the number of points every fiber is resampled to, 0 to use the vertices as they are
+     * \param numThreads the number of threads, 0 to choose automatically
+     */
+    WFiberDistanceMatrix( WDataSetFibers::ConstSPtr fibers, Measure measure = LARGER_THRESHOLDED, double proximityThreshold = 0.0,
+                          double maxDistance = std::numeric_limits< double >::infinity(), std::size_t numPoints = 20,
+                          std::size_t numThreads = 0 );
+
+    /**
+     * The number of fibers, i.e. rows and columns of the matrix.
+     *
+     * \return the number of fibers
+     */
+    std::size_t size() const;
+
+    /**
+     * The distance of a single pair of fibers, without pruning.
+     *
+     * \param i the first fiber
+     * \param j the second fiber
+     *
+     * \return the distance
+     */
+    float getDistance( std::size_t i, std::size_t j ) const;
+
+    /**
+     * Computes the distances of the fibers of some rows to all fibers with a larger index, in parallel.
+     *
+     * \param begin the first row
+     * \param end the row behind the last row
+     * \param elements receives the distances of the rows in the order of WMatrixSym, i.e. the distances of row i to the
+     * fibers i + 1 to size() - 1, followed by row i + 1 and so on
+     */
+    void computeRows( std::size_t begin, std::size_t end, float* elements ) const;
+
+    /**
+     * Computes the whole matrix.
+     *
+     * \param progress if given, incremented by the number of finished rows
+     *
+     * \return the matrix
+     */
+    WMatrixSym< float >::SPtr compute( WProgress::SPtr progress = WProgress::SPtr() ) const;
+
+    /**
+     * Computes the whole matrix and writes it to a file in the format of WWriterMatrixSymVTK. Only a block of rows is
+     * kept in memory, so this also works for matrices that do not fit into memory.
+     *
+     * \param fileName the file, overwritten if it exists
+     * \param progress if given, incremented by the number of finished rows
+     *
+     * \throw WDHIOFailure if the file cannot be written
+     */
+    void write( std::string const& fileName, WProgress::SPtr progress = WProgress::SPtr() ) const;
+
+    /**
+     * The number of fibers in the rows and columns of a tile.
+     */
+    static const std::size_t TileSize = 64;
+
+private:
+    /**
+     * Computes the tiles of a block of rows, to be run by a WThreadedFunction.
+     */
+    class TileWorker;
+
+    /**
+     * Disallow copy.
+     *
+     * \param other the other instance
+     */
+    explicit WFiberDistanceMatrix( WFiberDistanceMatrix const& other );
+
+    /**
+     * Disallow copy.
+     *
+     * \param other the other instance
+     *
+     * \return this
+     */
+    WFiberDistanceMatrix& operator=( WFiberDistanceMatrix const& other );
+
+    /**
+     * The distance of a pair of fibers.
+     *
+     * \param q the first fiber
+     * \param r the second fiber
+     * \param columnMin scratch memory, resized as needed
+     *
+     * \return the distance
+     */
+    float pairDistance( std::size_t q, std::size_t r, std::vector< float >* columnMin ) const;
+
+    /**
+     * Whether the distance of a pair of fibers certainly is larger than the maximal distance.
+     *
+     * \param q the first fiber
+     * \param r the second fiber
+     *
+     * \return true if the pair can be skipped
+     */
+    bool isPruned( std::size_t q, std::size_t r ) const;
+
+    /**
+     * Computes the next block of rows for write().
+     *
+     * \param nextRow the first row of the block, advanced to the next block
+     * \param progress if given, incremented by the number of rows
+     * \param elements receives the distances
+     */
+    void nextBlock( std::size_t* nextRow, WProgress::SPtr progress, std::vector< float >* elements ) const;
+
+    /**
+     * The distance measure.
+     */
+    Measure m_measure;
+
+    /**
+     * The square of the proximity threshold.
+     */
+    float m_thresholdSquare;
+
+    /**
+     * Pairs farther apart than this are pruned.
+     */
+    double m_maxDistance;
+
+    /**
+     * The number of threads, 0 for automatic.
+     */
+    std::size_t m_numThreads;
+
+    /**
+     * The x coordinates of the points of all fibers.
+     */
+    std::vector< float > m_x;
+
+    /**
+     * The y coordinates of the points of all fibers.
+     */
+    std::vector< float > m_y;
+
+    /**
+     * The z coordinates of the points of all fibers.
+     */
+    std::vector< float > m_z;
+
+    /**
+     * The index of the first point of every fiber, and the number of points at the end.
+     */
+    std::vector< std::size_t > m_starts;
+
+    /**
+     * The bounding box of the points of every fiber, as minimum x, y, z and maximum x, y, z.
+     */
+    std::vector< float > m_boxes;
+};
+
+#endif  // WFIBERDISTANCEMATRIX_H
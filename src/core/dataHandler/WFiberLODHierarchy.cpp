@@ -0,0 +1,342 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "../common/datastructures/WFiber.h"
+#include "../common/WLogger.h"
+#include "../common/WMemoryBudget.h"
+#include "WFiberLODHierarchy.h"
+
+namespace
+{
+    /**
+     * Builds a hierarchy and logs errors, as the caller of startBuild() does not wait for them. The hierarchy joins the
+     * thread before it is destroyed, so the thread holds no reference that would keep it and its dataset alive.
+     *
+     * \param hierarchy the hierarchy
+     */
+    void buildInBackground( WFiberLODHierarchy* hierarchy )
+    {
+        try
+        {
+            hierarchy->build();
+        }
+        catch( std::exception const& e )
+        {
+            wlog::error( "WFiberLODHierarchy" ) << "Building the fiber hierarchy failed: " << e.what();
+        }
+    }
+}
+
+WFiberLODHierarchy::WFiberLODHierarchy( WDataSetFibers::ConstSPtr fibers, std::size_t numLevels, double cellSize, Decimation decimation ):
+    m_fibers( fibers ),
+    m_numLevels( std::max< std::size_t >( numLevels, 1 ) ),
+    m_cellSize( cellSize ),
+    m_decimation( decimation ),
+    m_levels( m_numLevels ),
+    m_sourceFibers( m_numLevels ),
+    m_levelReady( new WCondition() ),
+    m_stop( false )
+{
+    if( !m_decimation )
+    {
+        m_decimation = &WFiberLODHierarchy::resampleByMaxPoints;
+    }
+    m_levels[ 0 ] = m_fibers;
+    m_evictionConnection = WMemoryBudget::getMemoryBudget()->subscribeEviction( boost::bind( &WFiberLODHierarchy::evict, this ) );
+}
+
+WFiberLODHierarchy::~WFiberLODHierarchy()
+{
+    m_stop = true;
+    if( m_builder.joinable() )
+    {
+        m_builder.join();
+    }
+    WMemoryBudget::getMemoryBudget()->unsubscribeEviction( m_evictionConnection );
+}
+
+WFiberLODHierarchy::SPtr WFiberLODHierarchy::getHierarchy( WDataSetFibers::ConstSPtr fibers )
+{
+    static boost::mutex cacheMutex;
+    static std::map< WDataSetFibers const*, boost::weak_ptr< WFiberLODHierarchy > > cache;
+
+    boost::unique_lock< boost::mutex > lock( cacheMutex );
+
+    // a hierarchy keeps its dataset alive, so the address of a dataset with a living hierarchy is never reused
+    for( std::map< WDataSetFibers const*, boost::weak_ptr< WFiberLODHierarchy > >::iterator it = cache.begin(); it != cache.end(); )
+    {
+        if( it->second.expired() )
+        {
+            cache.erase( it++ );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    SPtr hierarchy = cache[ fibers.get() ].lock();
+    if( !hierarchy )
+    {
+        hierarchy = SPtr( new WFiberLODHierarchy( fibers ) );
+        cache[ fibers.get() ] = hierarchy;
+        hierarchy->startBuild();
+    }
+    return hierarchy;
+}
+
+void WFiberLODHierarchy::build()
+{
+    std::vector< std::size_t > const ranks = computeRanks();
+    for( std::size_t level = m_numLevels - 1; level > 0 && !m_stop; --level )
+    {
+        if( !isReady( level ) )
+        {
+            buildLevel( level, ranks );
+        }
+    }
+}
+
+void WFiberLODHierarchy::startBuild()
+{
+    if( m_builder.joinable() )
+    {
+        m_builder.join();
+    }
+    m_builder = boost::thread( boost::bind( &buildInBackground, this ) );
+}
+
+void WFiberLODHierarchy::evict()
+{
+    // destroyed after unlocking, as the datasets unsubscribe their own caches
+    std::vector< WDataSetFibers::ConstSPtr > evicted;
+    boost::unique_lock< boost::mutex > lock( m_mutex, boost::try_to_lock );
+    if( !lock.owns_lock() )
+    {
+        return;
+    }
+    for( std::size_t level = 1; level < m_numLevels; ++level )
+    {
+        if( m_levels[ level ] && m_levels[ level ].unique() )
+        {
+            evicted.push_back( m_levels[ level ] );
+            m_levels[ level ].reset();
+            m_sourceFibers[ level ].reset();
+        }
+    }
+    lock.unlock();
+    if( !evicted.empty() )
+    {
+        wlog::debug( "WFiberLODHierarchy" ) << "Evicted " << evicted.size() << " levels.";
+    }
+}
+
+std::size_t WFiberLODHierarchy::getNumLevels() const
+{
+    return m_numLevels;
+}
+
+bool WFiberLODHierarchy::isReady( std::size_t level ) const
+{
+    return getFibers( level ) != NULL;
+}
+
+WDataSetFibers::ConstSPtr WFiberLODHierarchy::getFibers( std::size_t level ) const
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    return level < m_numLevels ? m_levels[ level ] : WDataSetFibers::ConstSPtr();
+}
+
+WDataSetFibers::IndexArray WFiberLODHierarchy::getSourceFibers( std::size_t level ) const
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    return level < m_numLevels ? m_sourceFibers[ level ] : WDataSetFibers::IndexArray();
+}
+
+std::size_t WFiberLODHierarchy::findLevel( std::size_t maxVertices ) const
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    std::size_t coarsest = 0;
+    for( std::size_t level = 0; level < m_numLevels; ++level )
+    {
+        if( !m_levels[ level ] )
+        {
+            continue;
+        }
+        if( m_levels[ level ]->getVertices()->size() / 3 <= maxVertices )
+        {
+            return level;
+        }
+        coarsest = level;
+    }
+    return coarsest;
+}
+
+WDataSetFibers::ColorArray WFiberLODHierarchy::mapColors( std::size_t level, WDataSetFibers::ColorArray colors, std::size_t components ) const
+{
+    WDataSetFibers::ConstSPtr levelFibers = getFibers( level );
+    WDataSetFibers::IndexArray sources = getSourceFibers( level );
+    if( !levelFibers || !sources )
+    {
+        return colors;
+    }
+
+    WDataSetFibers::IndexArray const& starts = levelFibers->getLineStartIndexes();
+    WDataSetFibers::LengthArray const& lengths = levelFibers->getLineLengths();
+    WDataSetFibers::IndexArray const& sourceStarts = m_fibers->getLineStartIndexes();
+    WDataSetFibers::LengthArray const& sourceLengths = m_fibers->getLineLengths();
+
+    WDataSetFibers::ColorArray result( new std::vector< float >( components * levelFibers->getVertices()->size() / 3 ) );
+    for( std::size_t fidx = 0; fidx < starts->size(); ++fidx )
+    {
+        std::size_t const source = ( *sources )[ fidx ];
+        std::size_t const length = ( *lengths )[ fidx ];
+        std::size_t const sourceLength = ( *sourceLengths )[ source ];
+        for( std::size_t k = 0; k < length; ++k )
+        {
+            std::size_t sourceK = 0;
+            if( length > 1 )
+            {
+                sourceK = static_cast< std::size_t >( static_cast< double >( k * ( sourceLength - 1 ) ) / ( length - 1 ) + 0.5 );
+            }
+            std::size_t const from = components * ( ( *sourceStarts )[ source ] + sourceK );
+            std::size_t const to = components * ( ( *starts )[ fidx ] + k );
+            std::copy( colors->begin() + from, colors->begin() + from + components, result->begin() + to );
+        }
+    }
+    return result;
+}
+
+WCondition::SPtr WFiberLODHierarchy::getLevelReadyCondition() const
+{
+    return m_levelReady;
+}
+
+void WFiberLODHierarchy::resampleByMaxPoints( WFiber* fiber, std::size_t maxPoints )
+{
+    if( fiber->size() > maxPoints )
+    {
+        fiber->resampleByNumberOfPoints( maxPoints );
+    }
+}
+
+std::vector< std::size_t > WFiberLODHierarchy::computeRanks() const
+{
+    WDataSetFibers::VertexArray const& vertices = m_fibers->getVertices();
+    WDataSetFibers::IndexArray const& starts = m_fibers->getLineStartIndexes();
+    WDataSetFibers::LengthArray const& lengths = m_fibers->getLineLengths();
+    WBoundingBox const bb = m_fibers->getBoundingBox();
+
+    // the cell counts are only needed for the key, the grid covers the bounding box
+    std::size_t const nx = static_cast< std::size_t >( ( bb.xMax() - bb.xMin() ) / m_cellSize ) + 1;
+    std::size_t const ny = static_cast< std::size_t >( ( bb.yMax() - bb.yMin() ) / m_cellSize ) + 1;
+
+    boost::unordered_map< std::size_t, std::size_t > fibersInCell;
+    std::vector< std::size_t > ranks( starts->size(), 0 );
+    for( std::size_t fidx = 0; fidx < starts->size(); ++fidx )
+    {
+        if( ( *lengths )[ fidx ] == 0 )
+        {
+            continue;
+        }
+        std::size_t const middle = 3 * ( ( *starts )[ fidx ] + ( *lengths )[ fidx ] / 2 );
+        std::size_t const x = static_cast< std::size_t >( std::max( 0.0, ( ( *vertices )[ middle ] - bb.xMin() ) / m_cellSize ) );
+        std::size_t const y = static_cast< std::size_t >( std::max( 0.0, ( ( *vertices )[ middle + 1 ] - bb.yMin() ) / m_cellSize ) );
+        std::size_t const z = static_cast< std::size_t >( std::max( 0.0, ( ( *vertices )[ middle + 2 ] - bb.zMin() ) / m_cellSize ) );
+        ranks[ fidx ] = fibersInCell[ ( z * ny + y ) * nx + x ]++;
+    }
+    return ranks;
+}
+
+void WFiberLODHierarchy::buildLevel( std::size_t level, std::vector< std::size_t > const& ranks )
+{
+    WDataSetFibers::VertexArray const& sourceVertices = m_fibers->getVertices();
+    WDataSetFibers::IndexArray const& sourceStarts = m_fibers->getLineStartIndexes();
+    WDataSetFibers::LengthArray const& sourceLengths = m_fibers->getLineLengths();
+
+    std::size_t const stride = static_cast< std::size_t >( 1 ) << level;
+
+    WDataSetFibers::VertexArray vertices( new std::vector< float >() );
+    WDataSetFibers::IndexArray starts( new std::vector< std::size_t >() );
+    WDataSetFibers::LengthArray lengths( new std::vector< std::size_t >() );
+    WDataSetFibers::IndexArray reverse( new std::vector< std::size_t >() );
+    WDataSetFibers::IndexArray sources( new std::vector< std::size_t >() );
+    WBoundingBox bb;
+
+    std::vector< WPosition > points;
+    for( std::size_t fidx = 0; fidx < sourceStarts->size(); ++fidx )
+    {
+        if( m_stop )
+        {
+            return;
+        }
+
+        std::size_t const length = ( *sourceLengths )[ fidx ];
+        if( length == 0 || ranks[ fidx ] % stride != 0 )
+        {
+            continue;
+        }
+
+        std::size_t const first = 3 * ( *sourceStarts )[ fidx ];
+        points.resize( length );
+        for( std::size_t k = 0; k < length; ++k )
+        {
+            points[ k ] = WPosition( ( *sourceVertices )[ first + 3 * k ], ( *sourceVertices )[ first + 3 * k + 1 ],
+                                     ( *sourceVertices )[ first + 3 * k + 2 ] );
+        }
+        WFiber fiber( points );
+        m_decimation( &fiber, std::max< std::size_t >( 2, ( length + stride - 1 ) / stride ) );
+
+        starts->push_back( vertices->size() / 3 );
+        lengths->push_back( fiber.size() );
+        sources->push_back( fidx );
+        for( std::size_t k = 0; k < fiber.size(); ++k )
+        {
+            vertices->push_back( static_cast< float >( fiber[ k ][ 0 ] ) );
+            vertices->push_back( static_cast< float >( fiber[ k ][ 1 ] ) );
+            vertices->push_back( static_cast< float >( fiber[ k ][ 2 ] ) );
+            reverse->push_back( starts->size() - 1 );
+            bb.expandBy( fiber[ k ][ 0 ], fiber[ k ][ 1 ], fiber[ k ][ 2 ] );
+        }
+    }
+
+    WDataSetFibers::ConstSPtr levelFibers( new WDataSetFibers( vertices, starts, lengths, reverse, bb ) );
+    {
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        m_levels[ level ] = levelFibers;
+        m_sourceFibers[ level ] = sources;
+    }
+    wlog::debug( "WFiberLODHierarchy" ) << "Level " << level << ": " << starts->size() << " fibers, " << vertices->size() / 3 << " vertices.";
+    m_levelReady->notify();
+}
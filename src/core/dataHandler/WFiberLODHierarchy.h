@@ -0,0 +1,267 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERLODHIERARCHY_H
+#define WFIBERLODHIERARCHY_H
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/signals2/connection.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../common/WCondition.h"
+#include "WDataSetFibers.h"
+
+class WFiber;
+
+/**
+ * A multi-resolution hierarchy of a fiber dataset for interactive rendering. Level 0 is the dataset itself, every
+ * further level keeps about half of the fibers of the previous one and decimates each of them to about half of its
+ * vertices. The fibers of a level are stratified spatially: the fibers are binned into a grid by their middle vertex
+ * and every cell keeps every 2^level-th of its fibers, so sparse regions stay visible on coarse levels. The levels are
+ * nested, every fiber of a level is also part of all finer levels.
+ *
+ * The coarse levels are built in the background, coarsest first, by a thread the hierarchy owns. The destructor stops and
+ * joins it, so a dropped hierarchy releases its dataset. getHierarchy() shares one hierarchy per dataset. If the
+ * memory budget is exceeded, the coarse levels nobody else uses are evicted. They are not ready anymore until build()
+ * is called again, findLevel() falls back to the other levels meanwhile.
+ */
+class WFiberLODHierarchy // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFiberLODHierarchy > SPtr;
+
+    /**
+     * Decimates a fiber in place to at most the given number of vertices.
+     */
+    typedef boost::function< void ( WFiber*, std::size_t ) > Decimation;
+
+    /**
+     * Creates a hierarchy. The levels are only available after build().
+     *
+     * \param fibers the fibers
+     * \param numLevels the number of levels including level 0
+     * \param cellSize the edge length of the grid cells used for stratification
+     * \param decimation the decimation of single fibers, resampleByMaxPoints() if empty
+     */
+    WFiberLODHierarchy( WDataSetFibers::ConstSPtr fibers, std::size_t numLevels = 6, double cellSize = 8.0,
+                        Decimation decimation = Decimation() );
+
+    /**
+     * Destructor.
+     */
+    ~WFiberLODHierarchy();
+
+    /**
+     * Returns the hierarchy of the given fibers. There is only one hierarchy per dataset as long as anyone uses it. A new
+     * hierarchy is built by startBuild().
+     *
+     * \param fibers the fibers
+     *
+     * \return the hierarchy
+     */
+    static SPtr getHierarchy( WDataSetFibers::ConstSPtr fibers );
+
+    /**
+     * Builds all levels that are not ready, coarsest first. Notifies the level condition after each level.
+     */
+    void build();
+
+    /**
+     * Calls build() in a background thread. Waits for a previous background build to finish first. Errors are logged.
+     */
+    void startBuild();
+
+    /**
+     * Releases the coarse levels nobody else uses. Called by the memory budget.
+     */
+    void evict();
+
+    /**
+     * The number of levels including level 0.
+     *
+     * \return the number of levels
+     */
+    std::size_t getNumLevels() const;
+
+    /**
+     * Whether a level was built yet. Level 0 is always ready.
+     *
+     * \param level the level
+     *
+     * \return true if the level can be used
+     */
+    bool isReady( std::size_t level ) const;
+
+    /**
+     * The fibers of a level.
+     *
+     * \param level the level
+     *
+     * \return the fibers, NULL if the level is not ready yet
+     */
+    WDataSetFibers::ConstSPtr getFibers( std::size_t level ) const;
+
+    /**
+     * The fiber of the original dataset for every fiber of a level.
+     *
+     * \param level the level
+     *
+     * \return the indices into the original dataset, NULL for level 0 and levels that are not ready
+     */
+    WDataSetFibers::IndexArray getSourceFibers( std::size_t level ) const;
+
+    /**
+     * The finest ready level that has at most the given number of vertices. Returns the coarsest ready level if none is
+     * small enough.
+     *
+     * \param maxVertices the maximum number of vertices
+     *
+     * \return the level
+     */
+    std::size_t findLevel( std::size_t maxVertices ) const;
+
+    /**
+     * Maps a per vertex color array of the original dataset to a level. Each vertex of a decimated fiber takes the color
+     * of the original vertex at the same relative position.
+     *
+     * \param level the level, must be ready
+     * \param colors the colors of the original vertices
+     * \param components the number of floats per vertex
+     *
+     * \return the colors of the vertices of the level
+     */
+    WDataSetFibers::ColorArray mapColors( std::size_t level, WDataSetFibers::ColorArray colors, std::size_t components ) const;
+
+    /**
+     * Notified whenever a level is ready.
+     *
+     * \return the condition
+     */
+    WCondition::SPtr getLevelReadyCondition() const;
+
+    /**
+     * The default decimation. Resamples a fiber by number of points if it has more than the given number of vertices.
+     *
+     * \param fiber the fiber
+     * \param maxPoints the maximum number of vertices
+     */
+    static void resampleByMaxPoints( WFiber* fiber, std::size_t maxPoints );
+
+private:
+    /**
+     * Not copyable.
+     *
+     * \param other the hierarchy
+     */
+    explicit WFiberLODHierarchy( WFiberLODHierarchy const& other );
+
+    /**
+     * Not copyable.
+     *
+     * \param other the hierarchy
+     *
+     * \return this hierarchy
+     */
+    WFiberLODHierarchy& operator=( WFiberLODHierarchy const& other );
+
+    /**
+     * Computes the rank of every fiber within its grid cell.
+     *
+     * \return the ranks
+     */
+    std::vector< std::size_t > computeRanks() const;
+
+    /**
+     * Builds a coarse level.
+     *
+     * \param level the level, greater than 0
+     * \param ranks the rank of every fiber within its grid cell
+     */
+    void buildLevel( std::size_t level, std::vector< std::size_t > const& ranks );
+
+    /**
+     * The original fibers.
+     */
+    WDataSetFibers::ConstSPtr m_fibers;
+
+    /**
+     * The number of levels.
+     */
+    std::size_t m_numLevels;
+
+    /**
+     * The edge length of the grid cells.
+     */
+    double m_cellSize;
+
+    /**
+     * The decimation of single fibers.
+     */
+    Decimation m_decimation;
+
+    /**
+     * Protects the levels.
+     */
+    mutable boost::mutex m_mutex;
+
+    /**
+     * The fibers of each level, NULL while not built. Level 0 is m_fibers.
+     */
+    std::vector< WDataSetFibers::ConstSPtr > m_levels;
+
+    /**
+     * The original fiber of every fiber of each level.
+     */
+    std::vector< WDataSetFibers::IndexArray > m_sourceFibers;
+
+    /**
+     * Notified when a level is ready.
+     */
+    WCondition::SPtr m_levelReady;
+
+    /**
+     * The subscription to the evictions of the memory budget.
+     */
+    boost::signals2::connection m_evictionConnection;
+
+    /**
+     * Set by the destructor to stop building. Checked per level and per fiber.
+     */
+    boost::atomic< bool > m_stop;
+
+    /**
+     * The background thread started by startBuild().
+     */
+    boost::thread m_builder;
+};
+
+#endif  // WFIBERLODHIERARCHY_H
@@ -0,0 +1,519 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/move/utility.hpp>
+
+#include "WFiberSegmentIndex.h"
+
+namespace
+{
+    /**
+     * The average number of segments per cell if the cell size is chosen automatically.
+     */
+    const double SegmentsPerCell = 4.0;
+
+    /**
+     * Tests whether a segment intersects a box, by clipping it against the slabs of the box.
+     */
+    struct BoxTest
+    {
+        /**
+         * Tests a segment.
+         *
+         * \param a the first end point
+         * \param b the second end point
+         *
+         * \return true if the segment intersects the box
+         */
+        bool operator()( WPosition const& a, WPosition const& b ) const
+        {
+            double enter = 0.0;
+            double leave = 1.0;
+            for( size_t c = 0; c < 3; ++c )
+            {
+                double const d = b[ c ] - a[ c ];
+                if( d == 0.0 )
+                {
+                    if( a[ c ] < m_min[ c ] || a[ c ] > m_max[ c ] )
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                double t0 = ( m_min[ c ] - a[ c ] ) / d;
+                double t1 = ( m_max[ c ] - a[ c ] ) / d;
+                if( t0 > t1 )
+                {
+                    std::swap( t0, t1 );
+                }
+                enter = std::max( enter, t0 );
+                leave = std::min( leave, t1 );
+                if( enter > leave )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        WPosition m_min; //!< the corner of the box with the smallest coordinates
+        WPosition m_max; //!< the corner of the box with the largest coordinates
+    };
+
+    /**
+     * Tests whether a segment comes closer to a point than a radius.
+     */
+    struct PointTest
+    {
+        /**
+         * Tests a segment.
+         *
+         * \param a the first end point
+         * \param b the second end point
+         *
+         * \return true if the distance of the segment to the point is at most the radius
+         */
+        bool operator()( WPosition const& a, WPosition const& b ) const
+        {
+            WVector3d const d = b - a;
+            double const lengthSquare = dot( d, d );
+            double t = lengthSquare > 0.0 ? dot( m_point - a, d ) / lengthSquare : 0.0;
+            t = std::min( 1.0, std::max( 0.0, t ) );
+            WVector3d const offset = a + t * d - m_point;
+            return dot( offset, offset ) <= m_radiusSquare;
+        }
+
+        WPosition m_point; //!< the point
+        double m_radiusSquare; //!< the square of the radius
+    };
+
+    /**
+     * Tests whether a segment crosses or touches a plane.
+     */
+    struct PlaneTest
+    {
+        /**
+         * Tests a segment.
+         *
+         * \param a the first end point
+         * \param b the second end point
+         *
+         * \return true if the end points are not strictly on the same side of the plane
+         */
+        bool operator()( WPosition const& a, WPosition const& b ) const
+        {
+            double const sa = dot( m_normal, a - m_point );
+            double const sb = dot( m_normal, b - m_point );
+            return !( ( sa > 0.0 && sb > 0.0 ) || ( sa < 0.0 && sb < 0.0 ) );
+        }
+
+        WPosition m_point; //!< a point on the plane
+        WVector3d m_normal; //!< the normal of the plane
+    };
+
+    /**
+     * Sorts the fibers and removes duplicates.
+     *
+     * \param fibers the fibers
+     *
+     * \return the fibers
+     */
+    std::vector< size_t > unique( std::vector< size_t > fibers )
+    {
+        std::sort( fibers.begin(), fibers.end() );
+        fibers.erase( std::unique( fibers.begin(), fibers.end() ), fibers.end() );
+        return fibers;
+    }
+}
+
+WFiberSegmentIndex::WFiberSegmentIndex( boost::shared_ptr< std::vector< float > const > vertices,
+                                        boost::shared_ptr< std::vector< size_t > const > lineStartIndexes,
+                                        boost::shared_ptr< std::vector< size_t > const > lineLengths,
+                                        boost::shared_ptr< std::vector< size_t > const > verticesReverse,
+                                        double cellSize ):
+    m_vertices( vertices ),
+    m_lineStartIndexes( lineStartIndexes ),
+    m_lineLengths( lineLengths ),
+    m_verticesReverse( verticesReverse ),
+    m_requestedCellSize( cellSize ),
+    m_built( false ),
+    m_cellSize( 0.0 ),
+    m_margin( 0.0 )
+{
+    m_evictionConnection = WMemoryBudget::getMemoryBudget()->subscribeEviction( boost::bind( &WFiberSegmentIndex::evict, this ) );
+}
+
+WFiberSegmentIndex::~WFiberSegmentIndex()
+{
+    WMemoryBudget::getMemoryBudget()->unsubscribeEviction( m_evictionConnection );
+}
+
+std::vector< size_t > WFiberSegmentIndex::getFibersInBox( WBoundingBox const& box ) const
+{
+    boost::shared_lock< boost::shared_mutex > lock = lockBuilt();
+
+    std::vector< size_t > fibers;
+    if( !box.valid() || m_cellSegments.empty() )
+    {
+        return fibers;
+    }
+
+    BoxTest test;
+    size_t first[ 3 ];
+    size_t last[ 3 ];
+    for( size_t c = 0; c < 3; ++c )
+    {
+        test.m_min[ c ] = box.getMin()[ c ];
+        test.m_max[ c ] = box.getMax()[ c ];
+        first[ c ] = cellOf( c, test.m_min[ c ] - m_margin );
+        last[ c ] = cellOf( c, test.m_max[ c ] + m_margin );
+    }
+    collect( first, last, test, &fibers );
+    return unique( fibers );
+}
+
+std::vector< size_t > WFiberSegmentIndex::getFibersNearPoint( WPosition const& point, double radius ) const
+{
+    boost::shared_lock< boost::shared_mutex > lock = lockBuilt();
+
+    std::vector< size_t > fibers;
+    if( radius < 0.0 || m_cellSegments.empty() )
+    {
+        return fibers;
+    }
+
+    PointTest test;
+    test.m_point = point;
+    test.m_radiusSquare = radius * radius;
+    size_t first[ 3 ];
+    size_t last[ 3 ];
+    for( size_t c = 0; c < 3; ++c )
+    {
+        first[ c ] = cellOf( c, point[ c ] - radius - m_margin );
+        last[ c ] = cellOf( c, point[ c ] + radius + m_margin );
+    }
+    collect( first, last, test, &fibers );
+    return unique( fibers );
+}
+
+std::vector< size_t > WFiberSegmentIndex::getFibersOnPlane( WPosition const& point, WVector3d const& normal ) const
+{
+    boost::shared_lock< boost::shared_mutex > lock = lockBuilt();
+
+    std::vector< size_t > fibers;
+    if( m_cellSegments.empty() || dot( normal, normal ) == 0.0 )
+    {
+        return fibers;
+    }
+
+    PlaneTest test;
+    test.m_point = point;
+    test.m_normal = normal;
+
+    // walk the columns of cells along the axis the plane is most perpendicular to, each column is crossed by the plane
+    // in a range of cells given by the corners of the column, both enlarged by the margin of the short segments
+    size_t axis = 0;
+    for( size_t c = 1; c < 3; ++c )
+    {
+        if( std::abs( normal[ c ] ) > std::abs( normal[ axis ] ) )
+        {
+            axis = c;
+        }
+    }
+    size_t const u = ( axis + 1 ) % 3;
+    size_t const v = ( axis + 2 ) % 3;
+
+    size_t first[ 3 ];
+    size_t last[ 3 ];
+    for( size_t i = 0; i < m_dimensions[ u ]; ++i )
+    {
+        for( size_t j = 0; j < m_dimensions[ v ]; ++j )
+        {
+            double low = std::numeric_limits< double >::max();
+            double high = -std::numeric_limits< double >::max();
+            for( size_t corner = 0; corner < 4; ++corner )
+            {
+                double const x = m_origin[ u ] + ( i + corner % 2 ) * m_cellSize + ( corner % 2 ? m_margin : -m_margin );
+                double const y = m_origin[ v ] + ( j + corner / 2 ) * m_cellSize + ( corner / 2 ? m_margin : -m_margin );
+                double const z = point[ axis ] - ( normal[ u ] * ( x - point[ u ] ) + normal[ v ] * ( y - point[ v ] ) ) / normal[ axis ];
+                low = std::min( low, z );
+                high = std::max( high, z );
+            }
+            low -= m_margin;
+            high += m_margin;
+            double const gridEnd = m_origin[ axis ] + m_dimensions[ axis ] * m_cellSize;
+            if( high < m_origin[ axis ] || low > gridEnd )
+            {
+                continue;
+            }
+            first[ u ] = last[ u ] = i;
+            first[ v ] = last[ v ] = j;
+            first[ axis ] = cellOf( axis, low );
+            last[ axis ] = cellOf( axis, high );
+            collect( first, last, test, &fibers );
+        }
+    }
+    return unique( fibers );
+}
+
+double WFiberSegmentIndex::getCellSize() const
+{
+    boost::shared_lock< boost::shared_mutex > lock = lockBuilt();
+    return m_cellSize;
+}
+
+bool WFiberSegmentIndex::isBuilt() const
+{
+    boost::shared_lock< boost::shared_mutex > lock( m_mutex );
+    return m_built;
+}
+
+size_t WFiberSegmentIndex::getMemoryUsage() const
+{
+    boost::shared_lock< boost::shared_mutex > lock( m_mutex );
+    return ( m_cellStarts.capacity() + m_cellSegments.capacity() ) * sizeof( size_t );
+}
+
+void WFiberSegmentIndex::evict()
+{
+    boost::unique_lock< boost::shared_mutex > lock( m_mutex, boost::try_to_lock );
+    if( !lock.owns_lock() || !m_built )
+    {
+        return;
+    }
+    std::vector< size_t >().swap( m_cellStarts );
+    std::vector< size_t >().swap( m_cellSegments );
+    m_built = false;
+    m_reservation.reset();
+}
+
+boost::shared_lock< boost::shared_mutex > WFiberSegmentIndex::lockBuilt() const
+{
+    boost::shared_lock< boost::shared_mutex > lock( m_mutex );
+    // the grid may be evicted between building and locking it for reading
+    while( !m_built )
+    {
+        lock.unlock();
+        {
+            boost::unique_lock< boost::shared_mutex > buildLock( m_mutex );
+            build();
+        }
+        lock.lock();
+    }
+    return boost::move( lock );
+}
+
+void WFiberSegmentIndex::build() const
+{
+    if( m_built )
+    {
+        return;
+    }
+    m_built = true;
+
+    std::vector< float > const& vertices = *m_vertices;
+    std::vector< size_t > const& starts = *m_lineStartIndexes;
+    std::vector< size_t > const& lengths = *m_lineLengths;
+
+    double low[ 3 ] = { std::numeric_limits< double >::max(), std::numeric_limits< double >::max(), std::numeric_limits< double >::max() }; // NOLINT
+    double high[ 3 ] = { -low[ 0 ], -low[ 1 ], -low[ 2 ] }; // NOLINT
+    size_t numSegments = 0;
+    for( size_t fidx = 0; fidx < starts.size(); ++fidx )
+    {
+        if( lengths[ fidx ] == 0 )
+        {
+            continue;
+        }
+        numSegments += std::max< size_t >( lengths[ fidx ] - 1, 1 );
+        for( size_t k = 3 * starts[ fidx ]; k < 3 * ( starts[ fidx ] + lengths[ fidx ] ); k += 3 )
+        {
+            for( size_t c = 0; c < 3; ++c )
+            {
+                low[ c ] = std::min( low[ c ], static_cast< double >( vertices[ k + c ] ) );
+                high[ c ] = std::max( high[ c ], static_cast< double >( vertices[ k + c ] ) );
+            }
+        }
+    }
+
+    if( numSegments == 0 )
+    {
+        std::fill( m_origin, m_origin + 3, 0.0 );
+        std::fill( m_dimensions, m_dimensions + 3, 1 );
+        m_cellSize = std::max( m_requestedCellSize, 1.0 );
+        m_margin = 0.0;
+        m_cellStarts.assign( 2, 0 );
+        return;
+    }
+
+    // a few segments per cell, flat datasets get one layer of cells along their thin axes
+    double const largest = std::max( high[ 0 ] - low[ 0 ], std::max( high[ 1 ] - low[ 1 ], high[ 2 ] - low[ 2 ] ) );
+    m_cellSize = m_requestedCellSize;
+    if( m_cellSize <= 0.0 )
+    {
+        double volume = 1.0;
+        for( size_t c = 0; c < 3; ++c )
+        {
+            volume *= std::max( high[ c ] - low[ c ], largest * 1e-3 );
+        }
+        m_cellSize = largest > 0.0 ? std::cbrt( volume * SegmentsPerCell / numSegments ) : 1.0;
+    }
+    size_t numCells;
+    do
+    {
+        numCells = 1;
+        for( size_t c = 0; c < 3; ++c )
+        {
+            m_origin[ c ] = low[ c ];
+            m_dimensions[ c ] = static_cast< size_t >( ( high[ c ] - low[ c ] ) / m_cellSize ) + 1;
+            numCells *= m_dimensions[ c ];
+        }
+        // a requested cell size is only enlarged if the grid would be much larger than the data
+        if( numCells > 8 * numSegments + 8 )
+        {
+            m_cellSize *= 1.5;
+        }
+    }
+    while( numCells > 8 * numSegments + 8 );
+    m_margin = 0.5 * m_cellSize;
+
+    // count the entries of every cell, shifted by one to get the starts by a prefix sum
+    m_cellStarts.assign( numCells + 1, 0 );
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        std::vector< size_t > next;
+        if( pass == 1 )
+        {
+            for( size_t cell = 0; cell < numCells; ++cell )
+            {
+                m_cellStarts[ cell + 1 ] += m_cellStarts[ cell ];
+            }
+            // the querying thread cannot handle a refusal
+            m_reservation.reset( new WMemoryReservation( ( m_cellStarts.size() + m_cellStarts.back() ) * sizeof( size_t ), "fiber segment index",
+                                                         false ) );
+            m_cellSegments.resize( m_cellStarts.back() );
+            next.assign( m_cellStarts.begin(), m_cellStarts.end() - 1 );
+        }
+
+        for( size_t fidx = 0; fidx < starts.size(); ++fidx )
+        {
+            size_t const len = lengths[ fidx ];
+            for( size_t k = 0; k < len; ++k )
+            {
+                if( k + 1 == len && len > 1 )
+                {
+                    break;
+                }
+                size_t const segment = starts[ fidx ] + k;
+                size_t const a = 3 * segment;
+                size_t const b = 3 * ( len > 1 ? segment + 1 : segment );
+                // short segments are only listed in the cell of their center, the queries look a margin further
+                bool const isShort = std::abs( vertices[ a ] - vertices[ b ] ) <= 2.0 * m_margin &&
+                                     std::abs( vertices[ a + 1 ] - vertices[ b + 1 ] ) <= 2.0 * m_margin &&
+                                     std::abs( vertices[ a + 2 ] - vertices[ b + 2 ] ) <= 2.0 * m_margin;
+                size_t first[ 3 ];
+                size_t last[ 3 ];
+                for( size_t c = 0; c < 3; ++c )
+                {
+                    if( isShort )
+                    {
+                        first[ c ] = last[ c ] = cellOf( c, 0.5 * ( vertices[ a + c ] + vertices[ b + c ] ) );
+                    }
+                    else
+                    {
+                        first[ c ] = cellOf( c, std::min( vertices[ a + c ], vertices[ b + c ] ) );
+                        last[ c ] = cellOf( c, std::max( vertices[ a + c ], vertices[ b + c ] ) );
+                    }
+                }
+                for( size_t z = first[ 2 ]; z <= last[ 2 ]; ++z )
+                {
+                    for( size_t y = first[ 1 ]; y <= last[ 1 ]; ++y )
+                    {
+                        for( size_t x = first[ 0 ]; x <= last[ 0 ]; ++x )
+                        {
+                            size_t const cell = x + m_dimensions[ 0 ] * ( y + m_dimensions[ 1 ] * z );
+                            if( pass == 0 )
+                            {
+                                ++m_cellStarts[ cell + 1 ];
+                            }
+                            else
+                            {
+                                m_cellSegments[ next[ cell ]++ ] = segment;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+size_t WFiberSegmentIndex::cellOf( size_t axis, double coordinate ) const
+{
+    double const cell = std::floor( ( coordinate - m_origin[ axis ] ) / m_cellSize );
+    if( !( cell > 0.0 ) )
+    {
+        return 0;
+    }
+    return std::min( static_cast< size_t >( std::min( cell, 1e18 ) ), m_dimensions[ axis ] - 1 );
+}
+
+void WFiberSegmentIndex::getSegment( size_t segment, WPosition* a, WPosition* b ) const
+{
+    size_t const fidx = ( *m_verticesReverse )[ segment ];
+    size_t const lastVertex = ( *m_lineStartIndexes )[ fidx ] + ( *m_lineLengths )[ fidx ] - 1;
+    size_t const other = std::min( segment + 1, lastVertex );
+    std::vector< float > const& vertices = *m_vertices;
+    *a = WPosition( vertices[ 3 * segment ], vertices[ 3 * segment + 1 ], vertices[ 3 * segment + 2 ] );
+    *b = WPosition( vertices[ 3 * other ], vertices[ 3 * other + 1 ], vertices[ 3 * other + 2 ] );
+}
+
+template< typename Test >
+void WFiberSegmentIndex::collect( size_t const* first, size_t const* last, Test const& test, std::vector< size_t >* fibers ) const
+{
+    WPosition a;
+    WPosition b;
+    for( size_t z = first[ 2 ]; z <= last[ 2 ]; ++z )
+    {
+        for( size_t y = first[ 1 ]; y <= last[ 1 ]; ++y )
+        {
+            size_t const row = m_dimensions[ 0 ] * ( y + m_dimensions[ 1 ] * z );
+            for( size_t entry = m_cellStarts[ row + first[ 0 ] ]; entry < m_cellStarts[ row + last[ 0 ] + 1 ]; ++entry )
+            {
+                size_t const segment = m_cellSegments[ entry ];
+                getSegment( segment, &a, &b );
+                if( test( a, b ) )
+                {
+                    fibers->push_back( ( *m_verticesReverse )[ segment ] );
+                }
+            }
+        }
+    }
+}
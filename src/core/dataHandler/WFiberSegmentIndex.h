@@ -0,0 +1,273 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WFIBERSEGMENTINDEX_H
+#define WFIBERSEGMENTINDEX_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/signals2/connection.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "../common/math/linearAlgebra/WPosition.h"
+#include "../common/math/linearAlgebra/WVectorFixed.h"
+#include "../common/WBoundingBox.h"
+#include "../common/WMemoryReservation.h"
+
+/**
+ * A uniform grid over the segments of a fiber dataset, to find the fibers in a region without looking at all fibers.
+ * Segments shorter than a cell are listed in the cell of their center only, longer segments in all cells their
+ * bounding box overlaps, and the cells are stored as one contiguous array. The grid is built on the first query, so
+ * datasets that are never queried do not pay for it. If the memory budget is exceeded, the grid is evicted while no
+ * query runs and built again by the next query. All methods are thread-safe.
+ *
+ * The queries test the segments themselves, not only their cells, and return the indices of the matching fibers in
+ * ascending order. Fibers with a single vertex are treated as a segment of length zero.
+ */
+class WFiberSegmentIndex // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFiberSegmentIndex > SPtr;
+
+    /**
+     * Creates the index for the given fibers without building it.
+     *
+     * \param vertices the vertices, x1, y1, z1, x2, ...
+     * \param lineStartIndexes the index of the first vertex of each fiber
+     * \param lineLengths the number of vertices of each fiber
+     * \param verticesReverse the fiber of each vertex
+     * \param cellSize the edge length of the cells, 0 to choose it such that there are a few segments per cell
+     */
+    WFiberSegmentIndex( boost::shared_ptr< std::vector< float > const > vertices,
+                        boost::shared_ptr< std::vector< size_t > const > lineStartIndexes,
+                        boost::shared_ptr< std::vector< size_t > const > lineLengths,
+                        boost::shared_ptr< std::vector< size_t > const > verticesReverse,
+                        double cellSize = 0.0 );
+
+    /**
+     * Destructor.
+     */
+    ~WFiberSegmentIndex();
+
+    /**
+     * The fibers with at least one segment intersecting a box.
+     *
+     * \param box the box
+     *
+     * \return the fibers
+     */
+    std::vector< size_t > getFibersInBox( WBoundingBox const& box ) const;
+
+    /**
+     * The fibers that come closer to a point than a given radius.
+     *
+     * \param point the point
+     * \param radius the radius
+     *
+     * \return the fibers
+     */
+    std::vector< size_t > getFibersNearPoint( WPosition const& point, double radius ) const;
+
+    /**
+     * The fibers crossing or touching a plane.
+     *
+     * \param point a point on the plane
+     * \param normal the normal of the plane, need not be normalized
+     *
+     * \return the fibers
+     */
+    std::vector< size_t > getFibersOnPlane( WPosition const& point, WVector3d const& normal ) const;
+
+    /**
+     * The edge length of the cells. Builds the index.
+     *
+     * \return the cell size
+     */
+    double getCellSize() const;
+
+    /**
+     * Whether the index was built by a query.
+     *
+     * \return true if the grid exists
+     */
+    bool isBuilt() const;
+
+    /**
+     * The main memory held by the grid.
+     *
+     * \return the memory in bytes, 0 if not built
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Releases the grid. Called by the memory budget. Does nothing while the index is in use by another thread.
+     */
+    void evict();
+
+private:
+    /**
+     * Disallow copy.
+     *
+     * \param other the other instance
+     */
+    explicit WFiberSegmentIndex( WFiberSegmentIndex const& other );
+
+    /**
+     * Disallow copy.
+     *
+     * \param other the other instance
+     *
+     * \return this
+     */
+    WFiberSegmentIndex& operator=( WFiberSegmentIndex const& other );
+
+    /**
+     * Builds the grid if not yet done. Needs m_mutex exclusively.
+     */
+    void build() const;
+
+    /**
+     * Builds the grid if needed and locks it for reading.
+     *
+     * \return the shared lock of m_mutex, held while the grid is used
+     */
+    boost::shared_lock< boost::shared_mutex > lockBuilt() const;
+
+    /**
+     * The cell of a coordinate along an axis, clamped to the grid.
+     *
+     * \param axis the axis
+     * \param coordinate the coordinate
+     *
+     * \return the cell index along the axis
+     */
+    size_t cellOf( size_t axis, double coordinate ) const;
+
+    /**
+     * The end points of a segment.
+     *
+     * \param segment the index of the first vertex of the segment
+     * \param a receives the first end point
+     * \param b receives the second end point
+     */
+    void getSegment( size_t segment, WPosition* a, WPosition* b ) const;
+
+    /**
+     * Collects the fibers of the segments listed in the given cells that pass a test.
+     *
+     * \tparam Test a functor taking the two end points of a segment, returning true if it matches
+     * \param first the first cell in every axis
+     * \param last the last cell in every axis
+     * \param test the test
+     * \param fibers receives the fibers, possibly several times and unsorted
+     */
+    template< typename Test >
+    void collect( size_t const* first, size_t const* last, Test const& test, std::vector< size_t >* fibers ) const;
+
+    /**
+     * The vertices.
+     */
+    boost::shared_ptr< std::vector< float > const > m_vertices;
+
+    /**
+     * The index of the first vertex of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_lineStartIndexes;
+
+    /**
+     * The number of vertices of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_lineLengths;
+
+    /**
+     * The fiber of each vertex.
+     */
+    boost::shared_ptr< std::vector< size_t > const > m_verticesReverse;
+
+    /**
+     * The requested cell size, 0 for automatic.
+     */
+    double m_requestedCellSize;
+
+    /**
+     * Protects the lazy build and the eviction. Queries hold it shared.
+     */
+    mutable boost::shared_mutex m_mutex;
+
+    /**
+     * The memory of the grid reserved in the global memory budget, NULL while not built.
+     */
+    mutable WMemoryReservation::SPtr m_reservation;
+
+    /**
+     * The subscription to the evictions of the memory budget.
+     */
+    boost::signals2::connection m_evictionConnection;
+
+    /**
+     * Whether the grid was built.
+     */
+    mutable bool m_built;
+
+    /**
+     * The corner of the grid with the smallest coordinates.
+     */
+    mutable double m_origin[ 3 ];
+
+    /**
+     * The edge length of the cells.
+     */
+    mutable double m_cellSize;
+
+    /**
+     * Segments extending at most twice this along every axis are only listed in the cell of their center, so queries
+     * have to look this much beyond their region. Longer segments are listed in all cells their bounding box overlaps.
+     */
+    mutable double m_margin;
+
+    /**
+     * The number of cells along each axis.
+     */
+    mutable size_t m_dimensions[ 3 ];
+
+    /**
+     * The position of the first segment of each cell in m_cellSegments, and the number of entries at the end. The cells
+     * are ordered by x, then y, then z.
+     */
+    mutable std::vector< size_t > m_cellStarts;
+
+    /**
+     * The segments of all cells, each given by the index of its first vertex.
+     */
+    mutable std::vector< size_t > m_cellSegments;
+};
+
+#endif  // WFIBERSEGMENTINDEX_H
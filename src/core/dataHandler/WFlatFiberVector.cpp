@@ -0,0 +1,215 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "../common/WThreadedFunction.h"
+#include "WFlatFiberVector.h"
+
+namespace
+{
+    /**
+     * The number of points to process before the work is split over several threads. Smaller problems are not worth
+     * starting the threads.
+     */
+    const std::size_t ParallelPoints = 1 << 16;
+
+    /**
+     * Copies the vertices of a range of fibers of a dataset to positions.
+     *
+     * \param fibers the dataset
+     * \param starts the index of the first position of every fiber
+     * \param points the positions, already sized
+     * \param begin the first fiber
+     * \param end behind the last fiber
+     */
+    void readFibers( WDataSetFibers const* fibers, std::vector< std::size_t > const* starts, std::vector< WPosition >* points,
+                     std::size_t begin, std::size_t end )
+    {
+        std::vector< float > const& vertices = *fibers->getVertices();
+        std::vector< std::size_t > const& vertexStarts = *fibers->getLineStartIndexes();
+        std::vector< std::size_t > const& lengths = *fibers->getLineLengths();
+        for( std::size_t fidx = begin; fidx < end; ++fidx )
+        {
+            float const* vertex = &vertices[ 3 * vertexStarts[ fidx ] ];
+            WPosition* point = &( *points )[ ( *starts )[ fidx ] ];
+            for( std::size_t k = 0; k < lengths[ fidx ]; ++k, vertex += 3, ++point )
+            {
+                *point = WPosition( vertex[ 0 ], vertex[ 1 ], vertex[ 2 ] );
+            }
+        }
+    }
+
+    /**
+     * Copies the positions of a range of fibers to the vertex arrays of a dataset.
+     *
+     * \param points the positions
+     * \param starts the index of the first position of every fiber, also the index of its first vertex
+     * \param lengths the number of positions of every fiber
+     * \param vertices the vertices, already sized
+     * \param verticesReverse the fiber of every vertex, already sized
+     * \param begin the first fiber
+     * \param end behind the last fiber
+     */
+    void writeFibers( std::vector< WPosition > const* points, std::vector< std::size_t > const* starts, std::vector< std::size_t > const* lengths,
+                      std::vector< float >* vertices, std::vector< std::size_t >* verticesReverse, std::size_t begin, std::size_t end )
+    {
+        for( std::size_t fidx = begin; fidx < end; ++fidx )
+        {
+            std::size_t const first = ( *starts )[ fidx ];
+            for( std::size_t i = first; i < first + ( *lengths )[ fidx ]; ++i )
+            {
+                WPosition const& point = ( *points )[ i ];
+                ( *vertices )[ 3 * i ] = point[ 0 ];
+                ( *vertices )[ 3 * i + 1 ] = point[ 1 ];
+                ( *vertices )[ 3 * i + 2 ] = point[ 2 ];
+                ( *verticesReverse )[ i ] = fidx;
+            }
+        }
+    }
+}
+
+WFlatFiberVector::WFlatFiberVector()
+{
+}
+
+WFlatFiberVector::WFlatFiberVector( WDataSetFibers const& fibers, std::size_t numThreads ):
+    m_lengths( *fibers.getLineLengths() )
+{
+    m_starts.reserve( m_lengths.size() );
+    std::size_t numPoints = 0;
+    for( std::size_t fidx = 0; fidx < m_lengths.size(); ++fidx )
+    {
+        m_starts.push_back( numPoints );
+        numPoints += m_lengths[ fidx ];
+    }
+    m_points.resize( numPoints );
+
+    runThreadedRanges( size(), getNumThreads( numPoints, numThreads ), boost::bind( &readFibers, &fibers, &m_starts, &m_points, _1, _2 ) );
+}
+
+void WFlatFiberVector::reserve( std::size_t numFibers, std::size_t numPoints )
+{
+    m_starts.reserve( numFibers );
+    m_lengths.reserve( numFibers );
+    m_points.reserve( numPoints );
+}
+
+void WFlatFiberVector::push_back( WLine const& fiber )
+{
+    m_starts.push_back( m_points.size() );
+    m_lengths.push_back( fiber.size() );
+    m_points.insert( m_points.end(), fiber.begin(), fiber.end() );
+}
+
+std::size_t WFlatFiberVector::size() const
+{
+    return m_starts.size();
+}
+
+bool WFlatFiberVector::empty() const
+{
+    return m_starts.empty();
+}
+
+std::size_t WFlatFiberVector::getNumPoints() const
+{
+    return m_points.size();
+}
+
+WFiberView WFlatFiberVector::operator[]( std::size_t i ) const
+{
+    return WFiberView( m_points.data() + m_starts[ i ], m_lengths[ i ] );
+}
+
+void WFlatFiberVector::reverse( std::size_t i )
+{
+    std::vector< WPosition >::iterator first = m_points.begin() + m_starts[ i ];
+    std::reverse( first, first + m_lengths[ i ] );
+}
+
+WFlatFiberVector::SPtr WFlatFiberVector::resampleByNumberOfPoints( std::size_t numPoints, std::size_t numThreads ) const
+{
+    SPtr result( new WFlatFiberVector() );
+    result->m_starts.reserve( size() );
+    result->m_lengths.reserve( size() );
+    std::size_t total = 0;
+    for( std::size_t fidx = 0; fidx < size(); ++fidx )
+    {
+        std::size_t const length = m_lengths[ fidx ] == 0 ? 0 : numPoints;
+        result->m_starts.push_back( total );
+        result->m_lengths.push_back( length );
+        total += length;
+    }
+    result->m_points.resize( total );
+
+    runThreadedRanges( size(), getNumThreads( getNumPoints() + total, numThreads ),
+                       boost::bind( &WFlatFiberVector::resampleFibers, this, numPoints, result.get(), _1, _2 ) );
+    return result;
+}
+
+WDataSetFibers::SPtr WFlatFiberVector::toWDataSetFibers( std::size_t numThreads ) const
+{
+    boost::shared_ptr< std::vector< float > > vertices( new std::vector< float >( 3 * m_points.size() ) );
+    boost::shared_ptr< std::vector< std::size_t > > starts( new std::vector< std::size_t >( m_starts ) );
+    boost::shared_ptr< std::vector< std::size_t > > lengths( new std::vector< std::size_t >( m_lengths ) );
+    boost::shared_ptr< std::vector< std::size_t > > verticesReverse( new std::vector< std::size_t >( m_points.size() ) );
+
+    runThreadedRanges( size(), getNumThreads( getNumPoints(), numThreads ),
+                       boost::bind( &writeFibers, &m_points, &m_starts, &m_lengths, vertices.get(), verticesReverse.get(), _1, _2 ) );
+
+    return WDataSetFibers::SPtr( new WDataSetFibers( vertices, starts, lengths, verticesReverse ) );
+}
+
+void WFlatFiberVector::resampleFibers( std::size_t numPoints, WFlatFiberVector* result, std::size_t begin, std::size_t end ) const
+{
+    // reused for all fibers of the range, as the resampling may produce one point less than requested
+    std::vector< WPosition > resampled;
+    resampled.reserve( numPoints + 1 );
+    for( std::size_t fidx = begin; fidx < end; ++fidx )
+    {
+        if( result->m_lengths[ fidx ] == 0 )
+        {
+            continue;
+        }
+        WFiberView const fiber = ( *this )[ fidx ];
+        resampled.clear();
+        resampleLineByNumberOfPoints( fiber.begin(), fiber.end(), numPoints, std::back_inserter( resampled ) );
+
+        std::vector< WPosition >::iterator out = result->m_points.begin() + result->m_starts[ fidx ];
+        std::size_t const numCopied = std::min( resampled.size(), numPoints );
+        std::copy( resampled.begin(), resampled.begin() + numCopied, out );
+        std::fill( out + numCopied, out + numPoints, fiber.back() );
+    }
+}
+
+std::size_t WFlatFiberVector::getNumThreads( std::size_t numPoints, std::size_t numThreads )
+{
+    return numPoints < ParallelPoints ? 1 : numThreads;
+}
@@ -0,0 +1,283 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WFLATFIBERVECTOR_H
+#define WFLATFIBERVECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../common/math/WLine.h"
+#include "../common/math/linearAlgebra/WPosition.h"
+#include "WDataSetFibers.h"
+
+/**
+ * A read-only view on the points of a fiber stored elsewhere, e.g. in a WFlatFiberVector. It offers the parts of the
+ * WFiber interface needed to read a fiber, without owning or copying the points.
+ */
+class WFiberView
+{
+public:
+    /**
+     * Iterator type.
+     */
+    typedef WPosition const* const_iterator;
+
+    /**
+     * Creates a view on a range of points.
+     *
+     * \param points the first point
+     * \param size the number of points
+     */
+    WFiberView( WPosition const* points, std::size_t size ):
+        m_points( points ),
+        m_size( size )
+    {
+    }
+
+    /**
+     * The number of points.
+     *
+     * \return the number of points
+     */
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Whether the fiber has no points.
+     *
+     * \return true if there are no points
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * Access a point.
+     *
+     * \param i the index of the point
+     *
+     * \return the point
+     */
+    WPosition const& operator[]( std::size_t i ) const
+    {
+        return m_points[ i ];
+    }
+
+    /**
+     * The first point.
+     *
+     * \return the point
+     */
+    WPosition const& front() const
+    {
+        return m_points[ 0 ];
+    }
+
+    /**
+     * The last point.
+     *
+     * \return the point
+     */
+    WPosition const& back() const
+    {
+        return m_points[ m_size - 1 ];
+    }
+
+    /**
+     * Iterator to the first point.
+     *
+     * \return the iterator
+     */
+    const_iterator begin() const
+    {
+        return m_points;
+    }
+
+    /**
+     * Iterator behind the last point.
+     *
+     * \return the iterator
+     */
+    const_iterator end() const
+    {
+        return m_points + m_size;
+    }
+
+private:
+    /**
+     * The first point.
+     */
+    WPosition const* m_points;
+
+    /**
+     * The number of points.
+     */
+    std::size_t m_size;
+};
+
+/**
+ * A set of fibers whose points are stored one after another in a single array, as in WDataSetFibers but with double
+ * precision like WFiber. Adding fibers or resampling all of them only grows this array, instead of allocating a vector
+ * for every fiber as WDataSetFiberVector does, and the fibers are accessed through WFiberViews.
+ *
+ * Conversions from and to WDataSetFibers and resampling run in parallel if there are enough points.
+ */
+class WFlatFiberVector
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WFlatFiberVector > SPtr;
+
+    /**
+     * Creates an empty set of fibers.
+     */
+    WFlatFiberVector();
+
+    /**
+     * Copies the fibers of a dataset.
+     *
+     * \param fibers the fibers
+     * \param numThreads the number of threads, 0 to choose automatically
+     */
+    explicit WFlatFiberVector( WDataSetFibers const& fibers, std::size_t numThreads = 0 );
+
+    /**
+     * Reserves memory, so the given number of fibers and points can be added without reallocation.
+     *
+     * \param numFibers the number of fibers
+     * \param numPoints the total number of points
+     */
+    void reserve( std::size_t numFibers, std::size_t numPoints );
+
+    /**
+     * Appends a copy of a fiber.
+     *
+     * \param fiber the fiber
+     */
+    void push_back( WLine const& fiber );
+
+    /**
+     * The number of fibers.
+     *
+     * \return the number of fibers
+     */
+    std::size_t size() const;
+
+    /**
+     * Whether there are no fibers.
+     *
+     * \return true if there are no fibers
+     */
+    bool empty() const;
+
+    /**
+     * The number of points of all fibers.
+     *
+     * \return the number of points
+     */
+    std::size_t getNumPoints() const;
+
+    /**
+     * Access a fiber. The view is invalidated when fibers are added.
+     *
+     * \param i the index of the fiber
+     *
+     * \return a view on the points of the fiber
+     */
+    WFiberView operator[]( std::size_t i ) const;
+
+    /**
+     * Reverses the order of the points of a fiber.
+     *
+     * \param i the index of the fiber
+     */
+    void reverse( std::size_t i );
+
+    /**
+     * Resamples every fiber to the given number of points, as WLine::resampleByNumberOfPoints() does. Should rounding
+     * drop the last point of a fiber, the last point of the original fiber is used. Empty fibers stay empty.
+     *
+     * \param numPoints the number of points of every fiber
+     * \param numThreads the number of threads, 0 to choose automatically
+     *
+     * \return the resampled fibers
+     */
+    SPtr resampleByNumberOfPoints( std::size_t numPoints, std::size_t numThreads = 0 ) const;
+
+    /**
+     * Converts the fibers to a dataset.
+     *
+     * \param numThreads the number of threads, 0 to choose automatically
+     *
+     * \return the dataset
+     */
+    WDataSetFibers::SPtr toWDataSetFibers( std::size_t numThreads = 0 ) const;
+
+private:
+    /**
+     * Resamples a range of fibers into an already sized set of fibers.
+     *
+     * \param numPoints the number of points of every non-empty fiber
+     * \param result the resampled fibers
+     * \param begin the first fiber
+     * \param end behind the last fiber
+     */
+    void resampleFibers( std::size_t numPoints, WFlatFiberVector* result, std::size_t begin, std::size_t end ) const;
+
+    /**
+     * The number of threads to use for the given number of points. Small problems run in the calling thread.
+     *
+     * \param numPoints the number of points to process
+     * \param numThreads the requested number of threads, 0 to choose automatically
+     *
+     * \return the number of threads
+     */
+    static std::size_t getNumThreads( std::size_t numPoints, std::size_t numThreads );
+
+    /**
+     * The points of all fibers.
+     */
+    std::vector< WPosition > m_points;
+
+    /**
+     * The index of the first point of every fiber.
+     */
+    std::vector< std::size_t > m_starts;
+
+    /**
+     * The number of points of every fiber.
+     */
+    std::vector< std::size_t > m_lengths;
+};
+
+#endif  // WFLATFIBERVECTOR_H
@@ -0,0 +1,150 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/WException.h"
+#include "../common/WThreadedFunction.h"
+#include "../common/math/WEigenSystemBatch.h"
+#include "WDataHandlerEnums.h"
+#include "WThreadedEigenSystems.h"
+
+const std::size_t WThreadedEigenSystems::ChunkSize;
+
+WThreadedEigenSystems::WThreadedEigenSystems( boost::shared_ptr< WDataSetSingle const > tensors, OutputType output,
+                                              WProgress::SPtr progress ):
+    m_outputType( output ),
+    m_progress( progress )
+{
+    if( !tensors )
+    {
+        throw WException( std::string( "No input dataset." ) );
+    }
+    m_tensors = tensors->getValueSet();
+    m_grid = tensors->getGrid();
+    if( !m_tensors )
+    {
+        throw WException( std::string( "The input dataset has no valueset." ) );
+    }
+    if( !m_grid )
+    {
+        throw WException( std::string( "The input dataset has no grid." ) );
+    }
+    if( m_tensors->order() != 1 || m_tensors->dimension() != 6 )
+    {
+        throw WException( std::string( "The input dataset does not contain symmetric 3x3 tensors." ) );
+    }
+    if( m_tensors->getDataType() != W_DT_FLOAT && m_tensors->getDataType() != W_DT_DOUBLE )
+    {
+        throw WException( std::string( "The input dataset does not contain floating point values." ) );
+    }
+
+    m_output = boost::shared_ptr< std::vector< double > >( new std::vector< double >( m_tensors->size() * getNumValues( output ) ) );
+}
+
+WThreadedEigenSystems::~WThreadedEigenSystems()
+{
+}
+
+std::size_t WThreadedEigenSystems::getNumValues( OutputType output )
+{
+    return output == EIGEN_SYSTEMS ? 12 : 4;
+}
+
+void WThreadedEigenSystems::operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown )
+{
+    std::pair< std::size_t, std::size_t > const range = getThreadRange( m_tensors->size(), id, numThreads );
+
+    if( m_tensors->getDataType() == W_DT_DOUBLE )
+    {
+        computeRange< double >( range.first, range.second, shutdown );
+    }
+    else
+    {
+        computeRange< float >( range.first, range.second, shutdown );
+    }
+}
+
+template< typename T >
+void WThreadedEigenSystems::computeRange( std::size_t begin, std::size_t end, WBoolFlag const& shutdown )
+{
+    boost::shared_ptr< WValueSet< T > const > values = boost::dynamic_pointer_cast< WValueSet< T > const >( m_tensors );
+    WAssert( values, "Bug: the data type does not match the value set." );
+    std::size_t const numValues = getNumValues( m_outputType );
+    std::vector< double >& output = *m_output;
+
+    WEigenSystemBatch batch( ChunkSize );
+    for( std::size_t first = begin; first < end && !shutdown(); first += ChunkSize )
+    {
+        std::size_t const count = std::min( ChunkSize, end - first );
+        if( count != batch.size() )
+        {
+            batch.resize( count );
+        }
+        batch.setTensors( 0, values->rawData() + 6 * first, count );
+        batch.compute();
+
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            double* out = &output[ ( first + i ) * numValues ];
+            if( m_outputType == EIGEN_SYSTEMS )
+            {
+                for( std::size_t k = 0; k < 3; ++k )
+                {
+                    WVector3d const v = batch.getEigenvector( i, k );
+                    out[ 4 * k ] = batch.getEigenvalue( i, k );
+                    out[ 4 * k + 1 ] = v[ 0 ];
+                    out[ 4 * k + 2 ] = v[ 1 ];
+                    out[ 4 * k + 3 ] = v[ 2 ];
+                }
+            }
+            else
+            {
+                // the eigenvalues are sorted, so the one with the largest magnitude is either the first or the last
+                std::size_t const principal = std::fabs( batch.getEigenvalue( i, 0 ) ) > std::fabs( batch.getEigenvalue( i, 2 ) ) ? 0 : 2;
+                WVector3d const v = batch.getEigenvector( i, principal );
+                out[ 0 ] = v[ 0 ];
+                out[ 1 ] = v[ 1 ];
+                out[ 2 ] = v[ 2 ];
+                out[ 3 ] = batch.getFA( i );
+            }
+        }
+
+        if( m_progress )
+        {
+            m_progress->increment( count );
+        }
+    }
+}
+
+boost::shared_ptr< WDataSetSingle > WThreadedEigenSystems::getResult()
+{
+    std::size_t const numValues = getNumValues( m_outputType );
+    boost::shared_ptr< WValueSet< double > > values( new WValueSet< double >( 1, numValues, m_output, W_DT_DOUBLE ) );
+    return boost::shared_ptr< WDataSetSingle >( new WDataSetSingle( values, m_grid ) );
+}
@@ -0,0 +1,143 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDEIGENSYSTEMS_H
+#define WTHREADEDEIGENSYSTEMS_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../common/WFlag.h"
+#include "../common/WProgress.h"
+#include "WDataSetSingle.h"
+#include "WValueSet.h"
+
+/**
+ * Computes the eigen systems of all tensors of a dataset with six float or double components per voxel (like WDataSetDTI),
+ * to be run by a WThreadedFunction. Every thread takes a contiguous range of voxels and processes it in chunks: a chunk is
+ * converted to the structure of arrays layout of WEigenSystemBatch, decomposed as a whole and written to the output.
+ *
+ * Compared to a WThreadedPerVoxelOperation with a per-voxel solver, there is no function call and copy per voxel and the
+ * closed-form solver can work on whole blocks of tensors.
+ */
+class WThreadedEigenSystems // NOLINT
+{
+public:
+    /**
+     * What to store per voxel.
+     */
+    enum OutputType
+    {
+        EIGEN_SYSTEMS,              //!< 12 values: three times the eigenvalue followed by its eigenvector, ascending (like WMEigenSystem)
+        PRINCIPAL_DIRECTION_AND_FA  //!< 4 values: the eigenvector of the eigenvalue with the largest magnitude and the FA (used for tracking)
+    };
+
+    /**
+     * Number of voxels converted and decomposed together.
+     */
+    static const std::size_t ChunkSize = 4096;
+
+    /**
+     * Constructor.
+     *
+     * \param tensors the tensor dataset, must have six float or double components per voxel
+     * \param output what to compute per voxel
+     * \param progress if given, incremented by the number of processed voxels
+     *
+     * \throw WException if the dataset is not a valid tensor dataset
+     */
+    WThreadedEigenSystems( boost::shared_ptr< WDataSetSingle const > tensors, OutputType output = EIGEN_SYSTEMS,
+                           WProgress::SPtr progress = WProgress::SPtr() );
+
+    /**
+     * Destructor.
+     */
+    ~WThreadedEigenSystems();
+
+    /**
+     * Processes this thread's part of the voxels.
+     *
+     * \param id the id of the thread
+     * \param numThreads the number of threads
+     * \param shutdown stops the computation when set
+     */
+    void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown );
+
+    /**
+     * The number of values stored per voxel for the given output type.
+     *
+     * \param output the output type
+     *
+     * \return the number of values
+     */
+    static std::size_t getNumValues( OutputType output );
+
+    /**
+     * Creates the dataset of the results on the grid of the input. Call this after all threads finished.
+     *
+     * \return the result
+     */
+    boost::shared_ptr< WDataSetSingle > getResult();
+
+private:
+    /**
+     * Processes a range of voxels.
+     *
+     * \tparam T the component type of the tensors
+     * \param begin first voxel
+     * \param end behind the last voxel
+     * \param shutdown stops the computation when set
+     */
+    template< typename T >
+    void computeRange( std::size_t begin, std::size_t end, WBoolFlag const& shutdown );
+
+    /**
+     * The tensors.
+     */
+    boost::shared_ptr< WValueSetBase const > m_tensors;
+
+    /**
+     * The grid of the tensors.
+     */
+    boost::shared_ptr< WGrid > m_grid;
+
+    /**
+     * What to compute.
+     */
+    OutputType m_outputType;
+
+    /**
+     * The results.
+     */
+    boost::shared_ptr< std::vector< double > > m_output;
+
+    /**
+     * The progress, may be empty.
+     */
+    WProgress::SPtr m_progress;
+};
+
+#endif  // WTHREADEDEIGENSYSTEMS_H
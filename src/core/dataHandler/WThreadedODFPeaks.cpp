@@ -0,0 +1,166 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/exceptions/WPreconditionNotMet.h"
+#include "../common/WAssert.h"
+#include "../common/WThreadedFunction.h"
+#include "WDataHandlerEnums.h"
+#include "WThreadedODFPeaks.h"
+
+namespace
+{
+    /**
+     * Computes the order of a symmetric SH from its number of coefficients.
+     *
+     * \param numCoefficients the number of coefficients
+     *
+     * \return the order
+     */
+    std::size_t getOrder( std::size_t numCoefficients )
+    {
+        std::size_t const order = static_cast< std::size_t >( ( std::sqrt( 8.0 * numCoefficients + 1.0 ) - 3.0 ) / 2.0 + 0.5 );
+        if( ( order + 1 ) * ( order + 2 ) / 2 != numCoefficients || order % 2 != 0 )
+        {
+            throw WPreconditionNotMet( std::string( "The number of coefficients does not belong to a symmetric spherical harmonic." ) );
+        }
+        return order;
+    }
+}
+
+/**
+ * Calls computeRange() with the actual type of the value set.
+ */
+class WThreadedODFPeaks::RangeVisitor : public boost::static_visitor<>
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param peaks the functor
+     * \param begin first voxel
+     * \param end behind the last voxel
+     * \param shutdown stops the computation when set
+     */
+    RangeVisitor( WThreadedODFPeaks* peaks, std::size_t begin, std::size_t end, WBoolFlag const& shutdown ):
+        m_peaks( peaks ),
+        m_begin( begin ),
+        m_end( end ),
+        m_shutdown( shutdown )
+    {
+    }
+
+    /**
+     * Finds the peaks of the voxels.
+     *
+     * \tparam T the data type of the coefficients
+     * \param values the coefficients
+     */
+    template< typename T >
+    void operator()( WValueSet< T > const* values ) const
+    {
+        m_peaks->computeRange( values, m_begin, m_end, m_shutdown );
+    }
+
+private:
+    /**
+     * The functor.
+     */
+    WThreadedODFPeaks* m_peaks;
+
+    /**
+     * First voxel.
+     */
+    std::size_t m_begin;
+
+    /**
+     * Behind the last voxel.
+     */
+    std::size_t m_end;
+
+    /**
+     * Stops the computation when set.
+     */
+    WBoolFlag const& m_shutdown;
+};
+
+WThreadedODFPeaks::WThreadedODFPeaks( boost::shared_ptr< WDataSetSphericalHarmonics const > sh, std::size_t maxPeaks, double relativeThreshold,
+                                      double minSeparationAngle, WProgress::SPtr progress ):
+    m_values( sh->getValueSet() ),
+    m_grid( sh->getGrid() ),
+    m_finder( getOrder( sh->getValueSet()->dimension() ), maxPeaks, relativeThreshold, minSeparationAngle ),
+    m_output( new std::vector< float >( maxPeaks * WSphericalHarmonicsPeakFinder::ValuesPerPeak * sh->getValueSet()->size() ) ),
+    m_progress( progress )
+{
+}
+
+WThreadedODFPeaks::~WThreadedODFPeaks()
+{
+}
+
+void WThreadedODFPeaks::operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown )
+{
+    std::pair< std::size_t, std::size_t > const range = getThreadRange( m_values->size(), id, numThreads );
+
+    m_values->applyFunction( RangeVisitor( this, range.first, range.second, shutdown ) );
+}
+
+template< typename T >
+void WThreadedODFPeaks::computeRange( WValueSet< T > const* values, std::size_t begin, std::size_t end, WBoolFlag const& shutdown )
+{
+    std::size_t const numCoefficients = m_finder.getNumCoefficients();
+    std::size_t const peakValues = m_finder.getMaxPeaks() * WSphericalHarmonicsPeakFinder::ValuesPerPeak;
+    WAssert( values->dimension() == numCoefficients, "The number of coefficients does not match the peak finder." );
+
+    // the voxels are processed in chunks, which also is the step of the progress to keep the contention on it low
+    std::size_t const chunkSize = 1024;
+    std::vector< double > coefficients( chunkSize * numCoefficients );
+    for( std::size_t chunkBegin = begin; chunkBegin < end && !shutdown(); chunkBegin += chunkSize )
+    {
+        std::size_t const chunkVoxels = std::min( chunkSize, end - chunkBegin );
+        T const* raw = values->rawData() + chunkBegin * numCoefficients;
+        for( std::size_t i = 0; i < chunkVoxels * numCoefficients; ++i )
+        {
+            coefficients[ i ] = static_cast< double >( raw[ i ] );
+        }
+        m_finder.findPeaks( &coefficients[ 0 ], chunkVoxels, &( *m_output )[ chunkBegin * peakValues ] );
+
+        if( m_progress )
+        {
+            m_progress->increment( chunkVoxels );
+        }
+    }
+}
+
+boost::shared_ptr< WDataSetODFPeaks > WThreadedODFPeaks::getResult()
+{
+    std::size_t const peakValues = m_finder.getMaxPeaks() * WSphericalHarmonicsPeakFinder::ValuesPerPeak;
+    boost::shared_ptr< WValueSet< float > > values( new WValueSet< float >( 1, peakValues, m_output, W_DT_FLOAT ) );
+    return boost::shared_ptr< WDataSetODFPeaks >( new WDataSetODFPeaks( values, m_grid ) );
+}
@@ -0,0 +1,129 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDODFPEAKS_H
+#define WTHREADEDODFPEAKS_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/variant.hpp>
+
+#include "../common/math/WSphericalHarmonicsPeakFinder.h"
+#include "../common/WFlag.h"
+#include "../common/WProgress.h"
+#include "WDataSetODFPeaks.h"
+#include "WDataSetSphericalHarmonics.h"
+#include "WValueSet.h"
+
+/**
+ * Finds the peaks of the ODFs of all voxels of a spherical harmonics dataset, to be run by a WThreadedFunction. The
+ * tessellation and the basis values of the peak finder (see WSphericalHarmonicsPeakFinder) are set up once and shared
+ * by all threads. Every thread handles a contiguous range of voxels in chunks, reading the coefficients directly from
+ * the value set, whatever its data type.
+ */
+class WThreadedODFPeaks // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param sh the spherical harmonics dataset
+     * \param maxPeaks the maximum number of peaks per voxel
+     * \param relativeThreshold peaks with a value below this fraction of the largest peak of the voxel are dropped
+     * \param minSeparationAngle peaks closer than this angle (in radians) to a larger peak are dropped
+     * \param progress if given, incremented by the number of processed voxels
+     *
+     * \throw WPreconditionNotMet if the number of coefficients does not belong to a symmetric SH
+     */
+    WThreadedODFPeaks( boost::shared_ptr< WDataSetSphericalHarmonics const > sh, std::size_t maxPeaks, double relativeThreshold,
+                       double minSeparationAngle, WProgress::SPtr progress = WProgress::SPtr() );
+
+    /**
+     * Destructor.
+     */
+    ~WThreadedODFPeaks();
+
+    /**
+     * Processes this thread's part of the voxels.
+     *
+     * \param id the id of the thread
+     * \param numThreads the number of threads
+     * \param shutdown stops the computation when set
+     */
+    void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown );
+
+    /**
+     * Creates the peak dataset on the grid of the input. Call this after all threads finished.
+     *
+     * \return the peaks
+     */
+    boost::shared_ptr< WDataSetODFPeaks > getResult();
+
+private:
+    /**
+     * Calls computeRange() with the actual type of the value set.
+     */
+    class RangeVisitor;
+
+    /**
+     * Finds the peaks of a range of voxels.
+     *
+     * \tparam T the data type of the coefficients
+     * \param values the coefficients
+     * \param begin first voxel
+     * \param end behind the last voxel
+     * \param shutdown stops the computation when set
+     */
+    template< typename T >
+    void computeRange( WValueSet< T > const* values, std::size_t begin, std::size_t end, WBoolFlag const& shutdown );
+
+    /**
+     * The coefficients.
+     */
+    boost::shared_ptr< WValueSetBase const > m_values;
+
+    /**
+     * The grid of the coefficients.
+     */
+    boost::shared_ptr< WGrid > m_grid;
+
+    /**
+     * The precomputed peak finder.
+     */
+    WSphericalHarmonicsPeakFinder m_finder;
+
+    /**
+     * The peaks.
+     */
+    boost::shared_ptr< std::vector< float > > m_output;
+
+    /**
+     * The progress, may be empty.
+     */
+    WProgress::SPtr m_progress;
+};
+
+#endif  // WTHREADEDODFPEAKS_H
@@ -0,0 +1,184 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/random/seed_seq.hpp>
+#include <boost/ref.hpp>
+
+#include "../common/exceptions/WPreconditionNotMet.h"
+#include "WValueSet.h"
+#include "WThreadedProbabilisticTrackingFunction.h"
+
+namespace wtracking
+{
+    std::size_t const WThreadedProbabilisticTrackingFunction::JobsPerRequest;
+
+    WThreadedProbabilisticTrackingFunction::WThreadedProbabilisticTrackingFunction( DataSetPtr dataset, SampleDirFunc dirFunc,
+            std::size_t samplesPerSeed, std::size_t seedPositions,
+            std::vector< int > v0, std::vector< int > v1, uint32_t randomSeed )
+        : m_dataSet( dataset ),
+        m_grid(),
+        m_directionFunc( dirFunc ),
+        m_maxPoints(),
+        m_randomSeed( randomSeed ),
+        m_currentIndex(),
+        m_nextBatch( 0 ),
+        m_shards()
+    {
+        if( !m_dataSet )
+        {
+            throw WException( std::string( "Invalid input." ) );
+        }
+        m_grid = boost::dynamic_pointer_cast< WGridRegular3D >( m_dataSet->getGrid() );
+        if( !m_grid )
+        {
+            throw WException( std::string( "Cannot find WGridRegular3D. Are you sure the dataset has the correct grid type?" ) );
+        }
+        WPrecond( m_directionFunc, "Missing direction sampling function." );
+        WPrecond( samplesPerSeed > 0, "Need at least one sample per seed." );
+        WPrecond( seedPositions > 0, "Need at least one seed position per voxel." );
+
+        m_maxPoints = static_cast< std::size_t >( 5 * pow( static_cast< double >( m_grid->size() ), 1.0 / 3.0 ) );
+
+        m_currentIndex.getWriteTicket()->get() = WThreadedTrackingFunction::IndexType( m_grid, v0, v1, seedPositions, samplesPerSeed );
+    }
+
+    WThreadedProbabilisticTrackingFunction::~WThreadedProbabilisticTrackingFunction()
+    {
+    }
+
+    void WThreadedProbabilisticTrackingFunction::operator() ( std::size_t /* id */, std::size_t /* numThreads */, WBoolFlag const& shutdown )
+    {
+        // every thread gets its own volume, so the only shared state is the index
+        RandomEngine rng;
+        boost::shared_ptr< std::vector< CountType > > counts( new std::vector< CountType >( m_grid->size(), 0 ) );
+        std::vector< uint32_t > lastVisit( m_grid->size(), 0 );
+        uint32_t sample = 0;
+
+        std::vector< JobType > jobs;
+        jobs.reserve( JobsPerRequest );
+        while( !shutdown() )
+        {
+            jobs.clear();
+            uint64_t batch = 0;
+            {
+                WSharedObject< WThreadedTrackingFunction::IndexType >::WriteTicket t = m_currentIndex.getWriteTicket();
+                while( jobs.size() < JobsPerRequest && !t->get().done() )
+                {
+                    jobs.push_back( t->get().job() );
+                    ++t->get();
+                }
+                batch = m_nextBatch++;
+            }
+            if( jobs.empty() )
+            {
+                break;
+            }
+
+            // the batches always contain the same seeds, so seeding per batch makes the streamlines reproducible
+            uint32_t const seeds[] = { m_randomSeed, static_cast< uint32_t >( batch ), static_cast< uint32_t >( batch >> 32 ) }; // NOLINT
+            boost::random::seed_seq sequence( seeds, seeds + 3 );
+            rng.seed( sequence );
+
+            for( std::size_t k = 0; k < jobs.size() && !shutdown(); ++k )
+            {
+                ++sample;
+                if( sample == 0 )
+                {
+                    // the streamline numbers wrapped around
+                    std::fill( lastVisit.begin(), lastVisit.end(), 0 );
+                    sample = 1;
+                }
+                track( jobs[ k ], rng, *counts, lastVisit, sample );
+            }
+        }
+
+        m_shards.getWriteTicket()->get().push_back( counts );
+    }
+
+    void WThreadedProbabilisticTrackingFunction::track( JobType const& seed, RandomEngine& rng, std::vector< CountType >& counts,
+                                                        std::vector< uint32_t >& lastVisit, uint32_t sample ) const
+    {
+        WTrackingUtility::DirFunc dirFunc = boost::bind( m_directionFunc, _1, _2, boost::ref( rng ) );
+
+        WVector3d e = dirFunc( m_dataSet, seed );
+        if( fabs( length( e ) - 1.0 ) > TRACKING_EPS )
+        {
+            return;
+        }
+        visit( seed.first, counts, lastVisit, sample );
+
+        for( int side = 0; side < 2; ++side )
+        {
+            JobType j = seed;
+            j.second = side == 0 ? e : e * -1.0;
+            for( std::size_t k = 0; k < m_maxPoints; ++k )
+            {
+                if( !WTrackingUtility::followToNextVoxel( m_dataSet, j, dirFunc ) )
+                {
+                    break;
+                }
+                visit( j.first, counts, lastVisit, sample );
+            }
+        }
+    }
+
+    void WThreadedProbabilisticTrackingFunction::visit( WVector3d const& pos, std::vector< CountType >& counts,
+                                                        std::vector< uint32_t >& lastVisit, uint32_t sample ) const
+    {
+        int voxel = m_grid->getVoxelNum( pos );
+        if( voxel >= 0 && lastVisit[ voxel ] != sample )
+        {
+            lastVisit[ voxel ] = sample;
+            ++counts[ voxel ];
+        }
+    }
+
+    boost::shared_ptr< std::vector< WThreadedProbabilisticTrackingFunction::CountType > >
+    WThreadedProbabilisticTrackingFunction::getVisitCounts() const
+    {
+        boost::shared_ptr< std::vector< CountType > > result( new std::vector< CountType >( m_grid->size(), 0 ) );
+
+        WSharedObject< ShardList >::ReadTicket t = m_shards.getReadTicket();
+        for( ShardList::const_iterator it = t->get().begin(); it != t->get().end(); ++it )
+        {
+            std::vector< CountType > const& shard = **it;
+            for( std::size_t i = 0; i < shard.size(); ++i )
+            {
+                ( *result )[ i ] += shard[ i ];
+            }
+        }
+        return result;
+    }
+
+    boost::shared_ptr< WDataSetScalar > WThreadedProbabilisticTrackingFunction::getResult() const
+    {
+        boost::shared_ptr< WValueSet< CountType > > values( new WValueSet< CountType >( 0, 1, getVisitCounts() ) );
+        return boost::shared_ptr< WDataSetScalar >( new WDataSetScalar( values, m_grid ) );
+    }
+}  // namespace wtracking
@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDPROBABILISTICTRACKINGFUNCTION_H
+#define WTHREADEDPROBABILISTICTRACKINGFUNCTION_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../common/WFlag.h"
+#include "../common/WSharedObject.h"
+
+#include "WDataSetScalar.h"
+#include "WThreadedTrackingFunction.h"
+
+namespace wtracking
+{
+    /**
+     * \class WThreadedProbabilisticTrackingFunction
+     *
+     * A multithreaded probabilistic tracking algorithm. From every seed position, many streamlines are integrated
+     * with WTrackingUtility::followToNextVoxel, where the direction of every step is drawn from a distribution by a
+     * user provided sampling function. The result is the number of streamlines that visited each voxel.
+     *
+     * The seed positions are enumerated by the same index as in WThreadedTrackingFunction, with the samples per seed
+     * taking the place of the seeds per position. Threads fetch the seeds in batches of JobsPerRequest and count visits
+     * in their own volume, so they only synchronize when they fetch a batch. The volumes are summed up when the result
+     * is requested. The random generator is seeded from the random seed and the number of the batch at the start of
+     * every batch, so the result only depends on the random seed, not on the number of threads or their scheduling.
+     *
+     * Use with WThreadedFunction.
+     */
+    class WThreadedProbabilisticTrackingFunction
+    {
+    public:
+        //! the job type
+        typedef WTrackingUtility::JobType JobType;
+
+        //! a pointer to a dataset
+        typedef WTrackingUtility::DataSetPtr DataSetPtr;
+
+        //! the random number generator, seeded for every batch of seeds
+        typedef boost::random::mt19937 RandomEngine;
+
+        /**
+         * A function that draws the next direction. It gets the current position and the previous direction (or a
+         * zero vector for the first step) and has to return a normalized direction, or any other vector to stop the
+         * streamline. The returned direction should point into the same hemisphere as the previous direction.
+         */
+        typedef boost::function< WVector3d ( DataSetPtr, JobType const&, RandomEngine& ) > SampleDirFunc;
+
+        //! the type of the visitation counts
+        typedef uint32_t CountType;
+
+        //! the number of seeds a thread takes from the index at once
+        static std::size_t const JobsPerRequest = 64;
+
+        /**
+         * Constructor.
+         *
+         * \param dataset A pointer to a dataset with a WGridRegular3D.
+         * \param dirFunc A direction sampling function, must be callable from several threads.
+         * \param samplesPerSeed The number of streamlines started from every seed position.
+         * \param seedPositions The number of seed positions in every direction per voxel.
+         * \param v0 A vector of starting voxel indices for every direction.
+         * \param v1 A vector of target voxel indices for every direction.
+         * \param randomSeed The seed of the random number generators, each batch of seeds derives its own stream from it.
+         */
+        WThreadedProbabilisticTrackingFunction( DataSetPtr dataset, SampleDirFunc dirFunc, std::size_t samplesPerSeed,
+                std::size_t seedPositions = 1,
+                std::vector< int > v0 = std::vector< int >(),
+                std::vector< int > v1 = std::vector< int >(),
+                uint32_t randomSeed = 0 );
+
+        /**
+         * Destructor.
+         */
+        ~WThreadedProbabilisticTrackingFunction();
+
+        /**
+         * Tracks streamlines from seeds until all seeds are done or the shutdown flag is set.
+         *
+         * \param id The thread's ID.
+         * \param numThreads How many threads are working on the jobs.
+         * \param shutdown A shared flag indicating the thread should be stopped.
+         */
+        void operator() ( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown );
+
+        /**
+         * Sums up the visitation counts of all threads that finished so far. Every streamline counts at most once
+         * per voxel.
+         *
+         * \return The number of streamlines through every voxel.
+         */
+        boost::shared_ptr< std::vector< CountType > > getVisitCounts() const;
+
+        /**
+         * The visitation counts as a scalar dataset on the grid of the input.
+         *
+         * \return The visitation map.
+         */
+        boost::shared_ptr< WDataSetScalar > getResult() const;
+
+    private:
+        //! a pointer to the grid
+        typedef WTrackingUtility::Grid3DPtr GridPtr;
+
+        //! the per thread visitation counts
+        typedef std::vector< boost::shared_ptr< std::vector< CountType > > > ShardList;
+
+        /**
+         * Integrates one streamline in both directions and counts the voxels it visits.
+         *
+         * \param seed The seed position.
+         * \param rng The random number generator of this thread.
+         * \param counts The visitation counts of this thread.
+         * \param lastVisit The streamline that visited each voxel last, used to count a streamline only once per voxel.
+         * \param sample The number of the current streamline of this thread.
+         */
+        void track( JobType const& seed, RandomEngine& rng, std::vector< CountType >& counts,
+                    std::vector< uint32_t >& lastVisit, uint32_t sample ) const;
+
+        /**
+         * Counts a visit of a position, unless the streamline was already counted in that voxel.
+         *
+         * \param pos The position.
+         * \param counts The visitation counts of this thread.
+         * \param lastVisit The streamline that visited each voxel last.
+         * \param sample The number of the current streamline of this thread.
+         */
+        void visit( WVector3d const& pos, std::vector< CountType >& counts, std::vector< uint32_t >& lastVisit, uint32_t sample ) const;
+
+        //! the input dataset
+        DataSetPtr m_dataSet;
+
+        //! a pointer to the grid
+        GridPtr m_grid;
+
+        //! the direction sampling function
+        SampleDirFunc m_directionFunc;
+
+        //! the maximum number of points per forward/backward integration of a streamline
+        std::size_t m_maxPoints;
+
+        //! the seed of the random number generators
+        uint32_t m_randomSeed;
+
+        //! the current index/seed position
+        WSharedObject< WThreadedTrackingFunction::IndexType > m_currentIndex;
+
+        //! the number of the next batch of seeds, only changed while holding the write ticket of m_currentIndex
+        uint64_t m_nextBatch;
+
+        //! the visitation counts of the threads that are done
+        WSharedObject< ShardList > m_shards;
+    };
+} /* namespace wtracking */
+
+#endif  // WTHREADEDPROBABILISTICTRACKINGFUNCTION_H
@@ -0,0 +1,335 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/exceptions/WPreconditionNotMet.h"
+#include "../common/math/WGeometryFunctions.h"
+#include "../common/math/WSymmetricSphericalHarmonic.h"
+#include "../common/math/WTensorFunctions.h"
+#include "../common/WThreadedFunction.h"
+#include "WDataHandlerEnums.h"
+#include "WThreadedScalarMaps.h"
+
+const std::size_t WThreadedScalarMaps::NumMeasures;
+const std::size_t WThreadedScalarMaps::BlockSize;
+
+/**
+ * Calls computeTensorBlock() or computeGFABlock() with the actual type of the value set.
+ */
+class WThreadedScalarMaps::BlockVisitor : public boost::static_visitor<>
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param maps the functor
+     * \param gfa whether to compute the GFA or the tensor measures
+     * \param first the first voxel
+     * \param count the number of voxels
+     */
+    BlockVisitor( WThreadedScalarMaps* maps, bool gfa, std::size_t first, std::size_t count ):
+        m_maps( maps ),
+        m_gfa( gfa ),
+        m_first( first ),
+        m_count( count )
+    {
+    }
+
+    /**
+     * Computes the measures of the block.
+     *
+     * \tparam T the data type of the values
+     * \param values the tensors or coefficients
+     */
+    template< typename T >
+    void operator()( WValueSet< T > const* values ) const
+    {
+        if( m_gfa )
+        {
+            m_maps->computeGFABlock( values, m_first, m_count );
+        }
+        else
+        {
+            m_maps->computeTensorBlock( values, m_first, m_count );
+        }
+    }
+
+private:
+    /**
+     * The functor.
+     */
+    WThreadedScalarMaps* m_maps;
+
+    /**
+     * Whether to compute the GFA or the tensor measures.
+     */
+    bool m_gfa;
+
+    /**
+     * The first voxel.
+     */
+    std::size_t m_first;
+
+    /**
+     * The number of voxels.
+     */
+    std::size_t m_count;
+};
+
+WThreadedScalarMaps::WThreadedScalarMaps( unsigned int measures, boost::shared_ptr< WDataSetSingle const > tensors,
+                                          boost::shared_ptr< WDataSetSphericalHarmonics const > sh, WProgress::SPtr progress ):
+    m_measures( measures ),
+    m_numVoxels( 0 ),
+    m_numSamples( 0 ),
+    m_progress( progress )
+{
+    WPrecond( measures != 0 && measures < ( 1u << NumMeasures ), "Invalid measures." );
+    unsigned int const tensorMeasures = FA | MD | RD | AD | MODE;
+    if( measures & tensorMeasures )
+    {
+        WPrecond( tensors && tensors->getValueSet() && tensors->getGrid(), "The tensor measures need a tensor dataset." );
+        m_tensors = tensors->getValueSet();
+        m_grid = tensors->getGrid();
+        WPrecond( m_tensors->order() == 1 && m_tensors->dimension() == 6, "The input dataset does not contain symmetric 3x3 tensors." );
+        m_numVoxels = m_tensors->size();
+    }
+    if( measures & GFA )
+    {
+        WPrecond( sh && sh->getValueSet() && sh->getGrid(), "The GFA needs a spherical harmonics dataset." );
+        m_coefficients = sh->getValueSet();
+        WPrecond( !m_tensors || m_coefficients->size() == m_numVoxels, "The tensors and coefficients need the same grid." );
+        m_grid = m_grid ? m_grid : sh->getGrid();
+        m_numVoxels = m_coefficients->size();
+
+        std::size_t const numCoefficients = m_coefficients->dimension();
+        std::size_t order = 0;
+        while( ( order + 1 ) * ( order + 2 ) / 2 < numCoefficients )
+        {
+            order += 2;
+        }
+        WPrecond( ( order + 1 ) * ( order + 2 ) / 2 == numCoefficients,
+                  "The number of coefficients does not belong to a symmetric spherical harmonic." );
+
+        std::vector< WVector3d > vertices;
+        std::vector< unsigned int > triangles;
+        tesselateIcosahedron( &vertices, &triangles, 2 );
+        std::vector< WUnitSphereCoordinates< double > > orientations;
+        for( std::size_t k = 0; k < vertices.size(); ++k )
+        {
+            if( vertices[ k ][ 0 ] >= 0.0 )
+            {
+                orientations.push_back( WUnitSphereCoordinates< double >( vertices[ k ] ) );
+            }
+        }
+
+        WMatrix< double > const basis = WSymmetricSphericalHarmonic< double >::calcBaseMatrix( orientations, order );
+        m_numSamples = basis.getNbRows();
+        m_basis.resize( m_numSamples * numCoefficients );
+        for( std::size_t r = 0; r < m_numSamples; ++r )
+        {
+            for( std::size_t c = 0; c < numCoefficients; ++c )
+            {
+                m_basis[ r * numCoefficients + c ] = basis( r, c );
+            }
+        }
+    }
+
+    for( std::size_t k = 0; k < NumMeasures; ++k )
+    {
+        if( measures & ( 1u << k ) )
+        {
+            m_maps[ k ] = boost::shared_ptr< std::vector< float > >( new std::vector< float >( m_numVoxels ) );
+        }
+    }
+}
+
+WThreadedScalarMaps::~WThreadedScalarMaps()
+{
+}
+
+void WThreadedScalarMaps::operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown )
+{
+    std::pair< std::size_t, std::size_t > const range = getThreadRange( m_numVoxels, id, numThreads );
+    computeRange( range.first, range.second, shutdown );
+}
+
+void WThreadedScalarMaps::computeRange( std::size_t first, std::size_t last, WBoolFlag const& shutdown )
+{
+    for( ; first < last && !shutdown(); first += BlockSize )
+    {
+        std::size_t const count = std::min( BlockSize, last - first );
+        if( m_tensors )
+        {
+            m_tensors->applyFunction( BlockVisitor( this, false, first, count ) );
+        }
+        if( m_coefficients )
+        {
+            m_coefficients->applyFunction( BlockVisitor( this, true, first, count ) );
+        }
+
+        if( m_progress )
+        {
+            m_progress->increment( count );
+        }
+    }
+}
+
+std::size_t WThreadedScalarMaps::size() const
+{
+    return m_numVoxels;
+}
+
+unsigned int WThreadedScalarMaps::getMeasures() const
+{
+    return m_measures;
+}
+
+std::size_t WThreadedScalarMaps::getIndex( Measure measure )
+{
+    std::size_t index = 0;
+    while( ( 1u << index ) != static_cast< unsigned int >( measure ) )
+    {
+        ++index;
+    }
+    return index;
+}
+
+std::string WThreadedScalarMaps::getName( Measure measure )
+{
+    static char const* const names[ NumMeasures ] = { "FA", "MD", "RD", "AD", "Mode", "GFA" }; // NOLINT
+    return names[ getIndex( measure ) ];
+}
+
+boost::shared_ptr< WDataSetScalar > WThreadedScalarMaps::getResult( Measure measure ) const
+{
+    WPrecond( m_measures & measure, "This measure was not computed." );
+    boost::shared_ptr< WValueSet< float > > values( new WValueSet< float >( 0, 1, m_maps[ getIndex( measure ) ], W_DT_FLOAT ) );
+    return boost::shared_ptr< WDataSetScalar >( new WDataSetScalar( values, m_grid ) );
+}
+
+template< typename T >
+void WThreadedScalarMaps::computeTensorBlock( WValueSet< T > const* values, std::size_t first, std::size_t count )
+{
+    // the eigenvalues, largest first, are shared by all measures
+    double l0[ BlockSize ];
+    double l1[ BlockSize ];
+    double l2[ BlockSize ];
+    T const* raw = values->rawData() + 6 * first;
+    for( std::size_t i = 0; i < count; ++i )
+    {
+        T const* t = raw + 6 * i;
+        calcEigenvaluesCardano( t[ 0 ], t[ 1 ], t[ 2 ], t[ 3 ], t[ 4 ], t[ 5 ], &l0[ i ], &l1[ i ], &l2[ i ] );
+    }
+
+    // one tight loop per measure keeps the loops free of branches on the measure
+    if( m_measures & FA )
+    {
+        float* out = &( *m_maps[ getIndex( FA ) ] )[ first ];
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            double const mean = ( l0[ i ] + l1[ i ] + l2[ i ] ) / 3.0;
+            double const nom = ( l0[ i ] - mean ) * ( l0[ i ] - mean ) + ( l1[ i ] - mean ) * ( l1[ i ] - mean )
+                             + ( l2[ i ] - mean ) * ( l2[ i ] - mean );
+            double const denom = l0[ i ] * l0[ i ] + l1[ i ] * l1[ i ] + l2[ i ] * l2[ i ];
+            out[ i ] = denom > 0.0 ? static_cast< float >( std::sqrt( 1.5 * nom / denom ) ) : 0.0f;
+        }
+    }
+    if( m_measures & MD )
+    {
+        float* out = &( *m_maps[ getIndex( MD ) ] )[ first ];
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            out[ i ] = static_cast< float >( ( l0[ i ] + l1[ i ] + l2[ i ] ) / 3.0 );
+        }
+    }
+    if( m_measures & RD )
+    {
+        float* out = &( *m_maps[ getIndex( RD ) ] )[ first ];
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            out[ i ] = static_cast< float >( 0.5 * ( l1[ i ] + l2[ i ] ) );
+        }
+    }
+    if( m_measures & AD )
+    {
+        float* out = &( *m_maps[ getIndex( AD ) ] )[ first ];
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            out[ i ] = static_cast< float >( l0[ i ] );
+        }
+    }
+    if( m_measures & MODE )
+    {
+        // mode = 3 sqrt( 6 ) det( D / |D| ) of the deviatoric tensor D, whose eigenvalues are the deviations from the mean
+        float* out = &( *m_maps[ getIndex( MODE ) ] )[ first ];
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            double const mean = ( l0[ i ] + l1[ i ] + l2[ i ] ) / 3.0;
+            double const d0 = l0[ i ] - mean;
+            double const d1 = l1[ i ] - mean;
+            double const d2 = l2[ i ] - mean;
+            double const norm2 = d0 * d0 + d1 * d1 + d2 * d2;
+            double const mode = norm2 > 0.0 ? std::sqrt( 54.0 ) * d0 * d1 * d2 / ( norm2 * std::sqrt( norm2 ) ) : 0.0;
+            out[ i ] = static_cast< float >( std::max( -1.0, std::min( 1.0, mode ) ) );
+        }
+    }
+}
+
+template< typename T >
+void WThreadedScalarMaps::computeGFABlock( WValueSet< T > const* values, std::size_t first, std::size_t count )
+{
+    std::size_t const numCoefficients = values->dimension();
+    double const n = static_cast< double >( m_numSamples );
+    float* out = &( *m_maps[ getIndex( GFA ) ] )[ first ];
+    std::vector< double > coefficients( numCoefficients );
+    for( std::size_t i = 0; i < count; ++i )
+    {
+        T const* raw = values->rawData() + ( first + i ) * numCoefficients;
+        std::copy( raw, raw + numCoefficients, coefficients.begin() );
+
+        // the samples are only needed for their sum and sum of squares
+        double sum = 0.0;
+        double sumOfSquares = 0.0;
+        for( std::size_t s = 0; s < m_numSamples; ++s )
+        {
+            double const* row = &m_basis[ s * numCoefficients ];
+            double f = 0.0;
+            for( std::size_t c = 0; c < numCoefficients; ++c )
+            {
+                f += row[ c ] * coefficients[ c ];
+            }
+            sum += f;
+            sumOfSquares += f * f;
+        }
+
+        double const deviation = std::max( 0.0, sumOfSquares - sum * sum / n );
+        double const gfa = sumOfSquares > 0.0 && n > 1.0 ? std::sqrt( n * deviation / ( ( n - 1.0 ) * sumOfSquares ) ) : 0.0;
+        out[ i ] = static_cast< float >( std::min( 1.0, gfa ) );
+    }
+}
@@ -0,0 +1,230 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDSCALARMAPS_H
+#define WTHREADEDSCALARMAPS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../common/WFlag.h"
+#include "../common/WProgress.h"
+#include "WDataSetScalar.h"
+#include "WDataSetSingle.h"
+#include "WDataSetSphericalHarmonics.h"
+#include "WValueSet.h"
+
+/**
+ * Computes any combination of scalar maps of a tensor and a spherical harmonics dataset in a single pass, to be run by a
+ * WThreadedFunction. Every thread handles a contiguous range of voxels in blocks. For each block the tensors and
+ * coefficients are read once, the eigenvalues are computed once for all tensor measures and the ODF samples once for
+ * the GFA, and all requested maps are written as floats. Computing FA, MD, RD and AD this way costs about as much as
+ * computing one of them.
+ */
+class WThreadedScalarMaps // NOLINT
+{
+public:
+    /**
+     * The available measures. They are bit flags, so a combination is given by or-ing them.
+     */
+    enum Measure
+    {
+        FA = 1,     //!< fractional anisotropy of the tensor
+        MD = 2,     //!< mean diffusivity, the mean of the eigenvalues
+        RD = 4,     //!< radial diffusivity, the mean of the two smaller eigenvalues
+        AD = 8,     //!< axial diffusivity, the largest eigenvalue
+        MODE = 16,  //!< the mode of the tensor, between -1 (planar) and 1 (linear)
+        GFA = 32    //!< generalized fractional anisotropy of the ODF
+    };
+
+    /**
+     * The number of measures.
+     */
+    static const std::size_t NumMeasures = 6;
+
+    /**
+     * The number of voxels processed at once.
+     */
+    static const std::size_t BlockSize = 1024;
+
+    /**
+     * Constructor. The GFA is computed from ODF samples on the half of a twice subdivided icosahedron, like
+     * WSymmetricSphericalHarmonic::calcGFA() is used by the GFA module.
+     *
+     * \param measures the requested measures, or-ed Measure flags
+     * \param tensors the tensors, 6 floats or doubles per voxel, needed for all measures but GFA
+     * \param sh the spherical harmonics dataset, needed for the GFA
+     * \param progress if given, incremented by the number of processed voxels
+     *
+     * \throw WPreconditionNotMet if no measure was requested, the input of a measure is missing or invalid, or both
+     * inputs have a different number of voxels
+     */
+    WThreadedScalarMaps( unsigned int measures, boost::shared_ptr< WDataSetSingle const > tensors,
+                         boost::shared_ptr< WDataSetSphericalHarmonics const > sh = boost::shared_ptr< WDataSetSphericalHarmonics const >(),
+                         WProgress::SPtr progress = WProgress::SPtr() );
+
+    /**
+     * Destructor.
+     */
+    ~WThreadedScalarMaps();
+
+    /**
+     * Processes this thread's part of the voxels.
+     *
+     * \param id the id of the thread
+     * \param numThreads the number of threads
+     * \param shutdown stops the computation when set
+     */
+    void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown );
+
+    /**
+     * Processes a range of voxels, for callers that split the work themselves, e.g. with runThreadedRanges().
+     *
+     * \param first the first voxel
+     * \param last the voxel behind the last one
+     * \param shutdown stops the computation when set
+     */
+    void computeRange( std::size_t first, std::size_t last, WBoolFlag const& shutdown );
+
+    /**
+     * The number of voxels.
+     *
+     * \return the number of voxels
+     */
+    std::size_t size() const;
+
+    /**
+     * The requested measures.
+     *
+     * \return the or-ed Measure flags
+     */
+    unsigned int getMeasures() const;
+
+    /**
+     * The name of a measure, e.g. "FA".
+     *
+     * \param measure the measure
+     *
+     * \return the name
+     */
+    static std::string getName( Measure measure );
+
+    /**
+     * Creates the dataset of a measure on the grid of the input. Call this after all threads finished.
+     *
+     * \param measure a requested measure
+     *
+     * \return the scalar map
+     *
+     * \throw WPreconditionNotMet if the measure was not requested
+     */
+    boost::shared_ptr< WDataSetScalar > getResult( Measure measure ) const;
+
+private:
+    /**
+     * Calls computeTensorBlock() or computeGFABlock() with the actual type of the value set.
+     */
+    class BlockVisitor;
+
+    /**
+     * The index of a measure in m_maps.
+     *
+     * \param measure the measure
+     *
+     * \return the index
+     */
+    static std::size_t getIndex( Measure measure );
+
+    /**
+     * Computes the tensor measures of a block of voxels.
+     *
+     * \tparam T the data type of the tensors
+     * \param values the tensors
+     * \param first the first voxel
+     * \param count the number of voxels
+     */
+    template< typename T >
+    void computeTensorBlock( WValueSet< T > const* values, std::size_t first, std::size_t count );
+
+    /**
+     * Computes the GFA of a block of voxels.
+     *
+     * \tparam T the data type of the coefficients
+     * \param values the coefficients
+     * \param first the first voxel
+     * \param count the number of voxels
+     */
+    template< typename T >
+    void computeGFABlock( WValueSet< T > const* values, std::size_t first, std::size_t count );
+
+    /**
+     * The requested measures.
+     */
+    unsigned int m_measures;
+
+    /**
+     * The tensors, may be empty.
+     */
+    boost::shared_ptr< WValueSetBase const > m_tensors;
+
+    /**
+     * The coefficients, may be empty.
+     */
+    boost::shared_ptr< WValueSetBase const > m_coefficients;
+
+    /**
+     * The grid of the input.
+     */
+    boost::shared_ptr< WGrid > m_grid;
+
+    /**
+     * The number of voxels.
+     */
+    std::size_t m_numVoxels;
+
+    /**
+     * The SH basis functions at the GFA sample directions, one row of coefficients per direction.
+     */
+    std::vector< double > m_basis;
+
+    /**
+     * The number of GFA sample directions.
+     */
+    std::size_t m_numSamples;
+
+    /**
+     * The maps, empty for measures that were not requested.
+     */
+    boost::shared_ptr< std::vector< float > > m_maps[ NumMeasures ];
+
+    /**
+     * The progress, may be empty.
+     */
+    WProgress::SPtr m_progress;
+};
+
+#endif  // WTHREADEDSCALARMAPS_H
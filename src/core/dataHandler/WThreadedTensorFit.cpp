@@ -0,0 +1,177 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <utility>
+#include <vector>
+
+#include "../common/WAssert.h"
+#include "../common/WThreadedFunction.h"
+#include "WDataHandlerEnums.h"
+#include "WThreadedTensorFit.h"
+
+namespace
+{
+    /**
+     * Collects the gradients of a dataset.
+     *
+     * \param dwi the dataset
+     *
+     * \return the gradients
+     */
+    std::vector< WVector3d > getGradients( boost::shared_ptr< WDataSetRawHARDI const > dwi )
+    {
+        std::vector< WVector3d > gradients;
+        for( std::size_t i = 0; i < dwi->getNumberOfMeasurements(); ++i )
+        {
+            gradients.push_back( dwi->getGradient( i ) );
+        }
+        return gradients;
+    }
+
+    /**
+     * Collects the b-values of a dataset.
+     *
+     * \param dwi the dataset
+     *
+     * \return the b-values
+     */
+    std::vector< double > getBValues( boost::shared_ptr< WDataSetRawHARDI const > dwi )
+    {
+        boost::shared_ptr< std::vector< float > > bValues = dwi->getDiffusionBValues();
+        return std::vector< double >( bValues->begin(), bValues->end() );
+    }
+}
+
+/**
+ * Calls computeRange() with the actual type of the value set.
+ */
+class WThreadedTensorFit::RangeVisitor : public boost::static_visitor<>
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param fit the functor
+     * \param begin first voxel
+     * \param end behind the last voxel
+     * \param shutdown stops the computation when set
+     */
+    RangeVisitor( WThreadedTensorFit* fit, std::size_t begin, std::size_t end, WBoolFlag const& shutdown ):
+        m_fit( fit ),
+        m_begin( begin ),
+        m_end( end ),
+        m_shutdown( shutdown )
+    {
+    }
+
+    /**
+     * Fits the voxels.
+     *
+     * \tparam T the data type of the measurements
+     * \param values the measurements
+     */
+    template< typename T >
+    void operator()( WValueSet< T > const* values ) const
+    {
+        m_fit->computeRange( values, m_begin, m_end, m_shutdown );
+    }
+
+private:
+    /**
+     * The functor.
+     */
+    WThreadedTensorFit* m_fit;
+
+    /**
+     * First voxel.
+     */
+    std::size_t m_begin;
+
+    /**
+     * Behind the last voxel.
+     */
+    std::size_t m_end;
+
+    /**
+     * Stops the computation when set.
+     */
+    WBoolFlag const& m_shutdown;
+};
+
+WThreadedTensorFit::WThreadedTensorFit( boost::shared_ptr< WDataSetRawHARDI const > dwi, WDiffusionTensorFit::FitMethod method,
+                                        WProgress::SPtr progress ):
+    m_values( dwi->getValueSet() ),
+    m_grid( dwi->getGrid() ),
+    m_fit( getGradients( dwi ), getBValues( dwi ), method ),
+    m_output( new std::vector< double >( 6 * dwi->getValueSet()->size() ) ),
+    m_progress( progress )
+{
+}
+
+WThreadedTensorFit::~WThreadedTensorFit()
+{
+}
+
+void WThreadedTensorFit::operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown )
+{
+    std::pair< std::size_t, std::size_t > const range = getThreadRange( m_values->size(), id, numThreads );
+
+    m_values->applyFunction( RangeVisitor( this, range.first, range.second, shutdown ) );
+}
+
+template< typename T >
+void WThreadedTensorFit::computeRange( WValueSet< T > const* values, std::size_t begin, std::size_t end, WBoolFlag const& shutdown )
+{
+    std::size_t const numMeasurements = m_fit.getNumMeasurements();
+    WAssert( values->dimension() == numMeasurements, "The number of measurements does not match the number of gradients." );
+
+    // progress is reported in steps to keep the contention on the progress low
+    std::size_t const progressStep = 1024;
+    std::vector< double > signal( numMeasurements );
+    std::vector< double >& output = *m_output;
+    for( std::size_t voxel = begin; voxel < end && !shutdown(); ++voxel )
+    {
+        T const* raw = values->rawData() + voxel * numMeasurements;
+        for( std::size_t i = 0; i < numMeasurements; ++i )
+        {
+            signal[ i ] = static_cast< double >( raw[ i ] );
+        }
+        m_fit.fit( &signal[ 0 ], &output[ 6 * voxel ] );
+
+        if( m_progress && ( voxel - begin + 1 ) % progressStep == 0 )
+        {
+            m_progress->increment( progressStep );
+        }
+    }
+    if( m_progress && !shutdown() )
+    {
+        m_progress->increment( ( end - begin ) % progressStep );
+    }
+}
+
+boost::shared_ptr< WDataSetDTI > WThreadedTensorFit::getResult()
+{
+    boost::shared_ptr< WValueSet< double > > values( new WValueSet< double >( 1, 6, m_output, W_DT_DOUBLE ) );
+    return boost::shared_ptr< WDataSetDTI >( new WDataSetDTI( values, m_grid ) );
+}
@@ -0,0 +1,128 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDTENSORFIT_H
+#define WTHREADEDTENSORFIT_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/variant.hpp>
+
+#include "../common/math/WDiffusionTensorFit.h"
+#include "../common/WFlag.h"
+#include "../common/WProgress.h"
+#include "WDataSetDTI.h"
+#include "WDataSetRawHARDI.h"
+#include "WValueSet.h"
+
+/**
+ * Fits diffusion tensors to all voxels of a diffusion weighted dataset, to be run by a WThreadedFunction. The design
+ * matrix and its pseudo-inverse are set up once for the gradient scheme of the dataset (see WDiffusionTensorFit) and
+ * shared by all threads. Every thread fits a contiguous range of voxels, reading the measurements directly from the
+ * value set, whatever its data type.
+ */
+class WThreadedTensorFit // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param dwi the diffusion weighted dataset
+     * \param method the fitting method
+     * \param progress if given, incremented by the number of fitted voxels
+     *
+     * \throw WException if the gradient scheme does not determine the tensors
+     */
+    WThreadedTensorFit( boost::shared_ptr< WDataSetRawHARDI const > dwi,
+                        WDiffusionTensorFit::FitMethod method = WDiffusionTensorFit::LOG_LINEAR,
+                        WProgress::SPtr progress = WProgress::SPtr() );
+
+    /**
+     * Destructor.
+     */
+    ~WThreadedTensorFit();
+
+    /**
+     * Fits this thread's part of the voxels.
+     *
+     * \param id the id of the thread
+     * \param numThreads the number of threads
+     * \param shutdown stops the computation when set
+     */
+    void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown );
+
+    /**
+     * Creates the tensor dataset on the grid of the input. Call this after all threads finished.
+     *
+     * \return the tensors
+     */
+    boost::shared_ptr< WDataSetDTI > getResult();
+
+private:
+    /**
+     * Calls computeRange() with the actual type of the value set.
+     */
+    class RangeVisitor;
+
+    /**
+     * Fits a range of voxels.
+     *
+     * \tparam T the data type of the measurements
+     * \param values the measurements
+     * \param begin first voxel
+     * \param end behind the last voxel
+     * \param shutdown stops the computation when set
+     */
+    template< typename T >
+    void computeRange( WValueSet< T > const* values, std::size_t begin, std::size_t end, WBoolFlag const& shutdown );
+
+    /**
+     * The measurements.
+     */
+    boost::shared_ptr< WValueSetBase const > m_values;
+
+    /**
+     * The grid of the measurements.
+     */
+    boost::shared_ptr< WGrid > m_grid;
+
+    /**
+     * The precomputed fit.
+     */
+    WDiffusionTensorFit m_fit;
+
+    /**
+     * The fitted tensors.
+     */
+    boost::shared_ptr< std::vector< double > > m_output;
+
+    /**
+     * The progress, may be empty.
+     */
+    WProgress::SPtr m_progress;
+};
+
+#endif  // WTHREADEDTENSORFIT_H
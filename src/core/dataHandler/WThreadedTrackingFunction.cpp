@@ -163,7 +163,8 @@ namespace wtracking
             NextPositionFunc nextFunc,
             FiberVisitorFunc fiberVst, PointVisitorFunc pointVst,
             std::size_t seedPositions, std::size_t seedsPerPos,
-            std::vector< int > v0, std::vector< int > v1 )
+            std::vector< int > v0, std::vector< int > v1,
+            WFiberBuilder::SPtr fiberBuilder, std::size_t minPoints )
         : Base( dataset ),
         m_grid( boost::dynamic_pointer_cast< GridType >( dataset->getGrid() ) ),
         m_directionFunc( dirFunc ),
@@ -171,7 +172,9 @@ namespace wtracking
         m_fiberVisitor( fiberVst ),
         m_pointVisitor( pointVst ),
         m_maxPoints(),
-        m_currentIndex()
+        m_currentIndex(),
+        m_fiberBuilder( fiberBuilder ),
+        m_minPoints( minPoints )
     {
         // dataset != 0 is tested by the base constructor
         if( !m_grid )
@@ -203,19 +206,55 @@ namespace wtracking
         }
     }
 
-    void WThreadedTrackingFunction::compute( DataSetPtr input, JobType const& job )
+    void WThreadedTrackingFunction::operator() ( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown )
     {
-        WVector3d e = m_directionFunc( input, job );
-        JobType j = job;
-        j.second = e;
+        if( !m_fiberBuilder )
+        {
+            Base::operator()( id, numThreads, shutdown );
+            return;
+        }
 
+        // the fiber vector is reused, and the points only get copied into this thread's buffer, which reserves
+        // memory for fibers of a quarter of the maximum length
+        WFiberBuilder::Buffer buffer( m_fiberBuilder, m_maxPoints / 4 + 1 );
         std::vector< WVector3d > fiber;
-        if( fabs( length( e ) - 1.0 ) > TRACKING_EPS )
+        fiber.reserve( 2 * m_maxPoints + 1 );
+        JobType job;
+        while( getJob( job ) && !shutdown() )
         {
+            track( m_input, job, fiber );
+            if( !fiber.empty() && fiber.size() >= m_minPoints )
+            {
+                buffer.add( fiber );
+            }
             if( m_fiberVisitor )
             {
                 m_fiberVisitor( fiber );
             }
+        }
+        buffer.flush();
+    }
+
+    void WThreadedTrackingFunction::compute( DataSetPtr input, JobType const& job )
+    {
+        std::vector< WVector3d > fiber;
+        track( input, job, fiber );
+        if( m_fiberVisitor )
+        {
+            m_fiberVisitor( fiber );
+        }
+    }
+
+    void WThreadedTrackingFunction::track( DataSetPtr input, JobType const& job, std::vector< WVector3d >& fiber )
+    {
+        fiber.clear();
+
+        WVector3d e = m_directionFunc( input, job );
+        JobType j = job;
+        j.second = e;
+
+        if( fabs( length( e ) - 1.0 ) > TRACKING_EPS )
+        {
             return;
         }
 
@@ -263,12 +302,6 @@ namespace wtracking
                 m_pointVisitor( j.first );
             }
         }
-
-        // output result
-        if( m_fiberVisitor )
-        {
-            m_fiberVisitor( fiber );
-        }
     }
 
     WThreadedTrackingFunction::IndexType::IndexType()
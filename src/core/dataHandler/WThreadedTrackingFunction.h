@@ -37,6 +37,7 @@
 #include "../common/WThreadedJobs.h"
 
 #include "WDataSetSingle.h"
+#include "WFiberBuilder.h"
 
 class WThreadedTrackingFunctionTest; //! forward declaration
 
@@ -143,6 +144,9 @@ namespace wtracking // note that this is not final
      *
      * Note that voxels at the first (0) and last (grid->getNbCoords*()) position in any direction are
      * invalid seeding voxels as they are partially outside of the grid.
+     *
+     * Instead of collecting the fibers in the fiber visitor, a WFiberBuilder can be given. Then every thread
+     * stores its fibers in its own buffer, which is passed to the builder in batches.
      */
     class WThreadedTrackingFunction : public WThreadedJobs< WTrackingUtility::DataSetType, WTrackingUtility::JobType >
     {
@@ -195,18 +199,32 @@ namespace wtracking // note that this is not final
          * \param seedsPerPos The number of fibers startet from every seed position.
          * \param v0 A vector of starting voxel indices for every direction.
          * \param v1 A vector of target voxel indices for every direction.
+         * \param fiberBuilder An optional builder that receives all fibers with at least minPoints points.
+         * \param minPoints The minimum number of points of the fibers passed to the fiber builder.
          */
         WThreadedTrackingFunction( DataSetPtr dataset, DirFunc dirFunc, NextPositionFunc nextFunc,
                 FiberVisitorFunc fiberVst, PointVisitorFunc pointVst,
                 std::size_t seedPositions = 1, std::size_t seedsPerPos = 1,
                 std::vector< int > v0 = std::vector< int >(),
-                std::vector< int > v1 = std::vector< int >() );
+                std::vector< int > v1 = std::vector< int >(),
+                WFiberBuilder::SPtr fiberBuilder = WFiberBuilder::SPtr(),
+                std::size_t minPoints = 1 );
 
         /**
          * Destructor.
          */
         virtual ~WThreadedTrackingFunction();
 
+        /**
+         * The threaded function operation. Pulls jobs and tracks a fiber for each of them. Without a fiber
+         * builder, this is the same as WThreadedJobs::operator().
+         *
+         * \param id The thread's ID.
+         * \param numThreads How many threads are working on the jobs.
+         * \param shutdown A shared flag indicating the thread should be stopped.
+         */
+        void operator() ( std::size_t id, std::size_t numThreads, WBoolFlag const& shutdown );
+
         /**
          * The job generator.
          *
@@ -224,11 +242,10 @@ namespace wtracking // note that this is not final
          */
         virtual void compute( DataSetPtr input, JobType const& job );
 
-    private:
         /**
          * \class IndexType
          *
-         * An index for seed positions.
+         * An index for seed positions. It is also used by WThreadedProbabilisticTrackingFunction.
          */
         class IndexType
         {
@@ -293,6 +310,16 @@ namespace wtracking // note that this is not final
             double m_offset;
             };
 
+    private:
+            /**
+             * Integrates a fiber in both directions from the seed of a job.
+             *
+             * \param input The input dataset.
+             * \param job The job.
+             * \param fiber The points of the fiber (output), empty if the seed has no valid direction.
+             */
+            void track( DataSetPtr input, JobType const& job, std::vector< WVector3d >& fiber );
+
             //! a pointer to the grid
             GridPtr m_grid;
 
@@ -313,6 +340,12 @@ namespace wtracking // note that this is not final
 
             //! the current index/seed position
             WSharedObject< IndexType > m_currentIndex;
+
+            //! the optional fiber builder
+            WFiberBuilder::SPtr m_fiberBuilder;
+
+            //! the minimum number of points of fibers passed to the fiber builder
+            std::size_t m_minPoints;
         };
 
 } /* namespace wtracking */
@@ -0,0 +1,237 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/variant.hpp>
+
+#include "../common/exceptions/WPreconditionNotMet.h"
+#include "WTrackingDirectionField.h"
+#include "WValueSet.h"
+
+namespace
+{
+    /**
+     * Copies the directions and FA from a value set into the arrays of the field.
+     */
+    class CopyVisitor : public boost::static_visitor<>
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * \param direction The arrays of the direction components.
+         * \param fa The FA array.
+         * \param valid The validity flags.
+         */
+        CopyVisitor( wtracking::WTrackingDirectionField::FloatArray* direction, wtracking::WTrackingDirectionField::FloatArray* fa,
+                     std::vector< uint8_t >* valid ):
+            m_direction( direction ),
+            m_fa( fa ),
+            m_valid( valid )
+        {
+        }
+
+        /**
+         * Normalizes and copies the values.
+         *
+         * \tparam T the type of the values
+         * \param values the principal directions and FA
+         */
+        template< typename T >
+        void operator()( WValueSet< T > const* values ) const
+        {
+            T const* data = values->rawData();
+            for( size_t i = 0; i < m_valid->size(); ++i )
+            {
+                double x = static_cast< double >( data[ 4 * i + 0 ] );
+                double y = static_cast< double >( data[ 4 * i + 1 ] );
+                double z = static_cast< double >( data[ 4 * i + 2 ] );
+                double fa = static_cast< double >( data[ 4 * i + 3 ] );
+                double norm = std::sqrt( x * x + y * y + z * z );
+
+                // degenerate tensors have no direction, whatever the FA threshold
+                if( !( norm > 0.0 ) || !( norm < std::numeric_limits< double >::infinity() ) || !( fa == fa ) )
+                {
+                    continue;
+                }
+                m_direction[ 0 ][ i ] = static_cast< float >( x / norm );
+                m_direction[ 1 ][ i ] = static_cast< float >( y / norm );
+                m_direction[ 2 ][ i ] = static_cast< float >( z / norm );
+                ( *m_fa )[ i ] = static_cast< float >( fa );
+                ( *m_valid )[ i ] = 1;
+            }
+        }
+
+    private:
+        /**
+         * The arrays of the direction components.
+         */
+        wtracking::WTrackingDirectionField::FloatArray* m_direction;
+
+        /**
+         * The FA array.
+         */
+        wtracking::WTrackingDirectionField::FloatArray* m_fa;
+
+        /**
+         * The validity flags.
+         */
+        std::vector< uint8_t >* m_valid;
+    };
+}
+
+namespace wtracking
+{
+    WTrackingDirectionField::WTrackingDirectionField( boost::shared_ptr< WDataSetSingle const > eigenField )
+    {
+        WPrecond( eigenField, "Missing direction field." );
+        m_grid = boost::dynamic_pointer_cast< WGridRegular3D >( eigenField->getGrid() );
+        WPrecond( m_grid, "The direction field needs a regular grid." );
+        boost::shared_ptr< WValueSetBase > values = eigenField->getValueSet();
+        WPrecond( values && values->dimension() == 4 && values->size() == m_grid->size(),
+                  "Need a principal direction and the FA for every voxel." );
+
+        for( int k = 0; k < 3; ++k )
+        {
+            m_direction[ k ].assign( m_grid->size(), 0.0f );
+        }
+        m_fa.assign( m_grid->size(), 0.0f );
+        m_valid.assign( m_grid->size(), 0 );
+
+        values->applyFunction( CopyVisitor( m_direction, &m_fa, &m_valid ) );
+    }
+
+    WTrackingDirectionField::~WTrackingDirectionField()
+    {
+    }
+
+    boost::shared_ptr< WGridRegular3D > WTrackingDirectionField::getGrid() const
+    {
+        return m_grid;
+    }
+
+    size_t WTrackingDirectionField::size() const
+    {
+        return m_valid.size();
+    }
+
+    WTrackingDirectionField::FloatArray const& WTrackingDirectionField::getDirectionComponents( size_t component ) const
+    {
+        WAssert( component < 3, "Invalid component." );
+        return m_direction[ component ];
+    }
+
+    WTrackingDirectionField::FloatArray const& WTrackingDirectionField::getFAValues() const
+    {
+        return m_fa;
+    }
+
+    WVector3d WTrackingDirectionField::getDirection( WVector3d const& pos, WVector3d const& previous, double minFA, double minCos ) const
+    {
+        int i = m_grid->getVoxelNum( pos );
+        if( i < 0 || !isValid( i ) || m_fa[ i ] < minFA )
+        {
+            return WVector3d( 0.0, 0.0, 0.0 );
+        }
+
+        WVector3d v = getDirection( static_cast< size_t >( i ) );
+        if( length( previous ) == 0 )
+        {
+            return v;
+        }
+        else if( dot( v, previous ) > minCos )
+        {
+            return v;
+        }
+        else if( dot( previous, v * -1.0 ) > minCos )
+        {
+            return v * -1.0;
+        }
+        return WVector3d( 0.0, 0.0, 0.0 );
+    }
+
+    WVector3d WTrackingDirectionField::interpolateDirection( WVector3d const& pos, WVector3d const& previous,
+                                                             double minFA, double minCos ) const
+    {
+        bool inside = true;
+        size_t cellId = m_grid->getCellId( pos, &inside );
+        if( !inside )
+        {
+            return WVector3d( 0.0, 0.0, 0.0 );
+        }
+        WGridRegular3D::CellVertexArray ids = m_grid->getCellVertexIds( cellId );
+        WVector3d local = m_grid->getTransform().directionToGridSpace( pos - m_grid->getPosition( ids[ 0 ] ) );
+
+        // the vertex order of the cell is x fastest, then y, then z
+        boost::array< double, 8 > h;
+        for( int k = 0; k < 8; ++k )
+        {
+            h[ k ] = ( k & 1 ? local[ 0 ] : 1.0 - local[ 0 ] )
+                   * ( k & 2 ? local[ 1 ] : 1.0 - local[ 1 ] )
+                   * ( k & 4 ? local[ 2 ] : 1.0 - local[ 2 ] );
+        }
+
+        WVector3d reference = previous;
+        if( length( reference ) == 0 )
+        {
+            for( int k = 0; k < 8 && length( reference ) == 0; ++k )
+            {
+                if( isValid( ids[ k ] ) )
+                {
+                    reference = getDirection( ids[ k ] );
+                }
+            }
+        }
+
+        WVector3d dir( 0.0, 0.0, 0.0 );
+        double fa = 0.0;
+        double weight = 0.0;
+        for( int k = 0; k < 8; ++k )
+        {
+            if( !isValid( ids[ k ] ) )
+            {
+                continue;
+            }
+            WVector3d d = getDirection( ids[ k ] );
+            dir += ( dot( d, reference ) < 0.0 ? -h[ k ] : h[ k ] ) * d;
+            fa += h[ k ] * m_fa[ ids[ k ] ];
+            weight += h[ k ];
+        }
+        if( !( weight > 0.0 ) || fa / weight < minFA || length( dir ) == 0 )
+        {
+            return WVector3d( 0.0, 0.0, 0.0 );
+        }
+
+        dir = normalize( dir );
+        if( length( previous ) == 0 || dot( dir, previous ) > minCos )
+        {
+            return dir;
+        }
+        return WVector3d( 0.0, 0.0, 0.0 );
+    }
+}  // namespace wtracking
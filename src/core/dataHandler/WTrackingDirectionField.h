@@ -0,0 +1,198 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTRACKINGDIRECTIONFIELD_H
+#define WTRACKINGDIRECTIONFIELD_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../common/math/linearAlgebra/WVectorFixed.h"
+#include "WDataSetSingle.h"
+#include "WGridRegular3D.h"
+
+namespace wtracking
+{
+    /**
+     * \class WTrackingDirectionField
+     *
+     * The principal directions and the FA of a tensor field, prepared once for tracking. The directions are
+     * normalized and stored with the FA as separate, cache line aligned float arrays, and voxels without a usable
+     * direction are marked invalid. Trackers look up directions without any tensor math or dataset casts, so
+     * tracking again with other seeds or thresholds only costs the integration itself.
+     */
+    class WTrackingDirectionField
+    {
+    public:
+        /**
+         * Shared pointer abbreviation.
+         */
+        typedef boost::shared_ptr< WTrackingDirectionField > SPtr;
+
+        /**
+         * Shared pointer abbreviation.
+         */
+        typedef boost::shared_ptr< WTrackingDirectionField const > ConstSPtr;
+
+        /**
+         * An array of floats aligned to cache lines.
+         */
+        typedef std::vector< float, boost::alignment::aligned_allocator< float, 64 > > FloatArray;
+
+        /**
+         * Builds the field from the principal directions and FA computed by WThreadedEigenSystems with
+         * WThreadedEigenSystems::PRINCIPAL_DIRECTION_AND_FA, i.e. four values per voxel.
+         *
+         * \param eigenField The directions and FA on a WGridRegular3D.
+         *
+         * \throw WPreconditionNotMet if the dataset has no regular grid or not four values per voxel
+         */
+        explicit WTrackingDirectionField( boost::shared_ptr< WDataSetSingle const > eigenField );
+
+        /**
+         * Destructor.
+         */
+        ~WTrackingDirectionField();
+
+        /**
+         * The grid of the field.
+         *
+         * \return the grid
+         */
+        boost::shared_ptr< WGridRegular3D > getGrid() const;
+
+        /**
+         * The number of voxels.
+         *
+         * \return the number of voxels
+         */
+        size_t size() const;
+
+        /**
+         * Whether a voxel has a usable direction.
+         *
+         * \param voxel The voxel index.
+         *
+         * \return true if the direction is valid
+         */
+        bool isValid( size_t voxel ) const
+        {
+            return m_valid[ voxel ] != 0;
+        }
+
+        /**
+         * The normalized principal direction of a voxel.
+         *
+         * \param voxel The voxel index.
+         *
+         * \return the direction, zero for invalid voxels
+         */
+        WVector3d getDirection( size_t voxel ) const
+        {
+            return WVector3d( m_direction[ 0 ][ voxel ], m_direction[ 1 ][ voxel ], m_direction[ 2 ][ voxel ] );
+        }
+
+        /**
+         * The FA of a voxel.
+         *
+         * \param voxel The voxel index.
+         *
+         * \return the FA, zero for invalid voxels
+         */
+        float getFA( size_t voxel ) const
+        {
+            return m_fa[ voxel ];
+        }
+
+        /**
+         * The next direction of a Mori-style tracker: the direction of the voxel that contains the position, flipped
+         * to point along the previous direction.
+         *
+         * \param pos The position.
+         * \param previous The previous direction, or zero for the first step.
+         * \param minFA Voxels with a lower FA stop the fiber.
+         * \param minCos The minimum cosine of the angle between the previous and the next direction.
+         *
+         * \return the normalized direction, or zero if the fiber should stop
+         */
+        WVector3d getDirection( WVector3d const& pos, WVector3d const& previous, double minFA, double minCos ) const;
+
+        /**
+         * The next direction of an interpolating tracker: the trilinear interpolation of the directions of the
+         * surrounding voxels, each flipped to the previous direction (or to the first valid voxel for the first step).
+         * Invalid voxels are left out, and the FA is interpolated the same way.
+         *
+         * \param pos The position.
+         * \param previous The previous direction, or zero for the first step.
+         * \param minFA Positions with a lower interpolated FA stop the fiber.
+         * \param minCos The minimum cosine of the angle between the previous and the next direction.
+         *
+         * \return the normalized direction, or zero if the fiber should stop
+         */
+        WVector3d interpolateDirection( WVector3d const& pos, WVector3d const& previous, double minFA, double minCos ) const;
+
+        /**
+         * The x, y or z components of the directions of all voxels.
+         *
+         * \param component 0, 1 or 2
+         *
+         * \return the components
+         */
+        FloatArray const& getDirectionComponents( size_t component ) const;
+
+        /**
+         * The FA of all voxels.
+         *
+         * \return the FA values
+         */
+        FloatArray const& getFAValues() const;
+
+    private:
+        /**
+         * The grid.
+         */
+        boost::shared_ptr< WGridRegular3D > m_grid;
+
+        /**
+         * The x, y and z components of the normalized directions.
+         */
+        FloatArray m_direction[ 3 ];
+
+        /**
+         * The FA.
+         */
+        FloatArray m_fa;
+
+        /**
+         * Nonzero for voxels with a usable direction.
+         */
+        std::vector< uint8_t > m_valid;
+    };
+} /* namespace wtracking */
+
+#endif  // WTRACKINGDIRECTIONFIELD_H
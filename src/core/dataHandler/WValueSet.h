@@ -36,6 +36,7 @@
 #include "../common/math/WValue.h"
 #include "../common/WAssert.h"
 #include "../common/WLimits.h"
+#include "../common/WMemoryReservation.h"
 #include "WDataHandlerEnums.h"
 #include "WValueSetBase.h"
 
@@ -121,7 +122,8 @@ public:
      */
     WValueSet( size_t order, size_t dimension, const boost::shared_ptr< std::vector< T > > data, dataType inDataType )
         : WValueSetBase( order, dimension, inDataType ),
-          m_data( data )
+          m_data( data ),
+          m_reservation( new WMemoryReservation( data->size() * sizeof( T ), "value set" ) )
     {
         // calculate min and max
         // Calculating this once simply ensures that it does not need to be recalculated in textures, histograms ...
@@ -143,7 +145,8 @@ public:
      */
     WValueSet( size_t order, size_t dimension, const boost::shared_ptr< std::vector< T > > data )
         : WValueSetBase( order, dimension, DataType< T >::type ),
-          m_data( data )
+          m_data( data ),
+          m_reservation( new WMemoryReservation( data->size() * sizeof( T ), "value set" ) )
     {
         // calculate min and max
         // Calculating this once simply ensures that it does not need to be recalculated in textures, histograms ...
@@ -186,6 +189,16 @@ public:
         return (*m_data.get()).size();
     }
 
+    /**
+     * The main memory held by the values.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const
+    {
+        return m_data->capacity() * sizeof( T );
+    }
+
     /**
      * \param i id of the scalar to retrieve
      * \return The i-th scalar stored in this value set. There are rawSize() such scalars.
@@ -318,6 +331,11 @@ private:
      */
     const boost::shared_ptr< std::vector< T > > m_data;  // WARNING: don't remove constness since &m_data[0] won't work anymore!
 
+    /**
+     * The memory of m_data reserved in the global memory budget.
+     */
+    WMemoryReservation::SPtr m_reservation;
+
     /**
      * Get a variant reference to this valueset (the reference is stored in the variant).
      * \note Use this as a temporary object inside a function or something like that.
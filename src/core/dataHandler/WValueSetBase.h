@@ -155,6 +155,16 @@ public:
      */
     virtual double getMaximumValue() const = 0;
 
+    /**
+     * The main memory held by the values.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const
+    {
+        return 0;
+    }
+
     /**
      * Apply a function object to this valueset.
      *
@@ -164,7 +174,7 @@ public:
      * \return The result of the operation.
      */
     template< typename Func_T >
-    typename Func_T::result_type applyFunction( Func_T const& func )
+    typename Func_T::result_type applyFunction( Func_T const& func ) const
     {
         return boost::apply_visitor( func, getVariant() );
     }
@@ -0,0 +1,91 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../WDataSetFibers.h"
+#include "WHelixFibers.h"
+
+/**
+ * Measures the construction of a WDataSetFibers from raw arrays, i.e. the part of fiber loading which is independent of the file format. This
+ * includes the bounding box computation and the creation of the color arrays.
+ */
+class WDataSetFibersBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WDataSetFibersBenchmark():
+        WBenchmark( "WDataSetFibers::construct" )
+    {
+        addSize( 10000 );
+        addSize( 100000 );
+    }
+
+    /**
+     * Creates size random helix-shaped fibers with 50 to 150 vertices each.
+     *
+     * \param size number of fibers
+     */
+    virtual void setUp( size_t size )
+    {
+        m_fibers = WHelixFibers::create( size );
+    }
+
+    /**
+     * Copies the arrays and constructs the dataset. The copy mimics the loader handing over freshly filled arrays.
+     *
+     * \return number of vertices
+     */
+    virtual size_t run()
+    {
+        WDataSetFibers fibers( boost::shared_ptr< std::vector< float > >( new std::vector< float >( *m_fibers->getVertices() ) ),
+                               boost::shared_ptr< std::vector< size_t > >( new std::vector< size_t >( *m_fibers->getLineStartIndexes() ) ),
+                               boost::shared_ptr< std::vector< size_t > >( new std::vector< size_t >( *m_fibers->getLineLengths() ) ),
+                               boost::shared_ptr< std::vector< size_t > >( new std::vector< size_t >( *m_fibers->getVerticesReverse() ) ) );
+        consume( static_cast< double >( fibers.size() ) );
+        return m_fibers->getVerticesReverse()->size();
+    }
+
+    /**
+     * Frees the fibers.
+     */
+    virtual void tearDown()
+    {
+        m_fibers.reset();
+    }
+
+private:
+    /**
+     * The fibers whose arrays are copied.
+     */
+    WDataSetFibers::SPtr m_fibers;
+};
+
+W_REGISTER_BENCHMARK( WDataSetFibersBenchmark )
@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../WFiberAgglomerativeClustering.h"
+#include "WHelixFibers.h"
+
+/**
+ * Measures the agglomerative clustering of fibers resampled to 20 points each, from the prepared fibers to the tree.
+ */
+class WFiberAgglomerativeClusteringBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WFiberAgglomerativeClusteringBenchmark():
+        WBenchmark( "WFiberAgglomerativeClustering::compute" ),
+        m_shutdown( new WCondition(), false )
+    {
+        addSize( 1000 );
+        addSize( 4000 );
+    }
+
+    /**
+     * Creates size random helix-shaped fibers with 50 to 150 vertices each.
+     *
+     * \param size number of fibers
+     */
+    virtual void setUp( size_t size )
+    {
+        m_clustering.reset( new WFiberAgglomerativeClustering( WHelixFibers::create( size ) ) );
+    }
+
+    /**
+     * Builds the tree.
+     *
+     * \return number of merges
+     */
+    virtual size_t run()
+    {
+        boost::shared_ptr< WHierarchicalTreeFibers > tree = m_clustering->compute( m_shutdown );
+        consume( tree->getCustomData( tree->getClusterCount() - 1 ) );
+        return tree->getClusterCount() - tree->getLeafCount();
+    }
+
+    /**
+     * Frees the fibers.
+     */
+    virtual void tearDown()
+    {
+        m_clustering.reset();
+    }
+
+private:
+    /**
+     * Never set, the clustering always runs to the end.
+     */
+    WBoolFlag m_shutdown;
+
+    /**
+     * The prepared fibers.
+     */
+    WFiberAgglomerativeClustering::SPtr m_clustering;
+};
+
+W_REGISTER_BENCHMARK( WFiberAgglomerativeClusteringBenchmark )
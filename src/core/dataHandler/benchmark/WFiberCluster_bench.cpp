@@ -0,0 +1,113 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../datastructures/WFiberCluster.h"
+#include "../WDataSetFiberVector.h"
+#include "WHelixFibers.h"
+
+/**
+ * Measures the center line generation of a cluster containing all fibers of a bundle of helices. Every third fiber runs
+ * in the opposite direction, so the directions have to be unified.
+ */
+class WFiberClusterCenterLineBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WFiberClusterCenterLineBenchmark():
+        WBenchmark( "WFiberCluster::generateCenterLine" )
+    {
+        addSize( 10000 );
+        addSize( 100000 );
+    }
+
+    /**
+     * Creates a bundle of size helix-shaped fibers with 50 to 150 vertices each, all starting near the origin.
+     *
+     * \param size number of fibers
+     */
+    virtual void setUp( size_t size )
+    {
+        m_fibers.reset( new WDataSetFiberVector( WHelixFibers::create( size, WPosition( -3.0, -3.0, 0.0 ), WPosition( 3.0, 3.0, 0.0 ) ) ) );
+        m_indices.clear();
+        for( size_t fiber = 0; fiber < size; ++fiber )
+        {
+            if( fiber % 3 == 0 )
+            {
+                ( *m_fibers )[ fiber ].reverseOrder();
+            }
+            m_indices.push_back( fiber );
+        }
+    }
+
+    /**
+     * Generates the center line of a new cluster of all fibers.
+     *
+     * \return number of vertices of the fibers
+     */
+    virtual size_t run()
+    {
+        WFiberCluster cluster( m_indices );
+        cluster.setDataSetReference( m_fibers );
+        cluster.generateCenterLine();
+        consume( static_cast< double >( cluster.getCenterLine()->size() ) );
+
+        size_t numPoints = 0;
+        for( WDataSetFiberVector::const_iterator cit = m_fibers->begin(); cit != m_fibers->end(); ++cit )
+        {
+            numPoints += cit->size();
+        }
+        return numPoints;
+    }
+
+    /**
+     * Frees the fibers.
+     */
+    virtual void tearDown()
+    {
+        m_fibers.reset();
+        m_indices.clear();
+    }
+
+private:
+    /**
+     * The fibers.
+     */
+    boost::shared_ptr< WDataSetFiberVector > m_fibers;
+
+    /**
+     * The indices of all fibers.
+     */
+    WFiberCluster::IndexList m_indices;
+};
+
+W_REGISTER_BENCHMARK( WFiberClusterCenterLineBenchmark )
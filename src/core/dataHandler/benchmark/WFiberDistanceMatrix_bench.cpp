@@ -0,0 +1,88 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../WFiberDistanceMatrix.h"
+#include "WHelixFibers.h"
+
+/**
+ * Measures the computation of the dLt distances of all pairs of fibers, resampled to 20 points each. Half of the
+ * volume is out of reach of the maximal distance for most fibers, so pruning is part of the measurement.
+ */
+class WFiberDistanceMatrixBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WFiberDistanceMatrixBenchmark():
+        WBenchmark( "WFiberDistanceMatrix::compute" )
+    {
+        addSize( 1000 );
+        addSize( 4000 );
+    }
+
+    /**
+     * Creates size random helix-shaped fibers with 50 to 150 vertices each.
+     *
+     * \param size number of fibers
+     */
+    virtual void setUp( size_t size )
+    {
+        m_matrix.reset( new WFiberDistanceMatrix( WHelixFibers::create( size ), WFiberDistanceMatrix::LARGER_THRESHOLDED, 1.0, 80.0 ) );
+    }
+
+    /**
+     * Computes the matrix.
+     *
+     * \return number of fiber pairs
+     */
+    virtual size_t run()
+    {
+        WMatrixSym< float >::SPtr matrix = m_matrix->compute();
+        consume( matrix->getData()[ matrix->numElements() / 2 ] );
+        return matrix->numElements();
+    }
+
+    /**
+     * Frees the fibers.
+     */
+    virtual void tearDown()
+    {
+        m_matrix.reset();
+    }
+
+private:
+    /**
+     * The prepared fibers.
+     */
+    WFiberDistanceMatrix::SPtr m_matrix;
+};
+
+W_REGISTER_BENCHMARK( WFiberDistanceMatrixBenchmark )
@@ -0,0 +1,118 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../WFiberSegmentIndex.h"
+#include "WHelixFibers.h"
+
+/**
+ * Measures proximity queries of 5mm around random points, including building the index for the first query. The
+ * size is the number of fibers, the number of queries is fixed.
+ */
+class WFiberSegmentIndexBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WFiberSegmentIndexBenchmark():
+        WBenchmark( "WFiberSegmentIndex::getFibersNearPoint" )
+    {
+        addSize( 10000 );
+        addSize( 50000 );
+    }
+
+    /**
+     * Creates size random helix-shaped fibers with 50 to 150 vertices each.
+     *
+     * \param size number of fibers
+     */
+    virtual void setUp( size_t size )
+    {
+        WDataSetFibers::SPtr fibers = WHelixFibers::create( size );
+        m_vertices = fibers->getVertices();
+        m_starts = fibers->getLineStartIndexes();
+        m_lengths = fibers->getLineLengths();
+        m_reverse = fibers->getVerticesReverse();
+    }
+
+    /**
+     * Builds the index and runs the queries.
+     *
+     * \return number of queries
+     */
+    virtual size_t run()
+    {
+        WFiberSegmentIndex index( m_vertices, m_starts, m_lengths, m_reverse );
+        size_t const numQueries = 10000;
+        size_t found = 0;
+        for( size_t i = 0; i < numQueries; ++i )
+        {
+            WPosition const point( ( i * 37 ) % 160, ( i * 53 ) % 160, ( i * 11 ) % 160 );
+            found += index.getFibersNearPoint( point, 5.0 ).size();
+        }
+        consume( found );
+        return numQueries;
+    }
+
+    /**
+     * Frees the fibers.
+     */
+    virtual void tearDown()
+    {
+        m_vertices.reset();
+        m_starts.reset();
+        m_lengths.reset();
+        m_reverse.reset();
+    }
+
+private:
+    /**
+     * The vertices.
+     */
+    boost::shared_ptr< std::vector< float > > m_vertices;
+
+    /**
+     * The start of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > > m_starts;
+
+    /**
+     * The length of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > > m_lengths;
+
+    /**
+     * The fiber of each vertex.
+     */
+    boost::shared_ptr< std::vector< size_t > > m_reverse;
+};
+
+W_REGISTER_BENCHMARK( WFiberSegmentIndexBenchmark )
@@ -0,0 +1,175 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../WDataSetScalar.h"
+#include "../WGridRegular3D.h"
+#include "../WValueSet.h"
+
+/**
+ * Base for benchmarks which query a regular grid of size^3 voxels at random positions.
+ */
+class WGridQueryBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param name the name of the benchmark
+     */
+    explicit WGridQueryBenchmark( std::string name ):
+        WBenchmark( name )
+    {
+        addSize( 32 );
+        addSize( 128 );
+        addSize( 256 );
+    }
+
+    /**
+     * Creates a size^3 float dataset and 10^6 random positions inside.
+     *
+     * \param size voxels per dimension
+     */
+    virtual void setUp( size_t size )
+    {
+        m_grid = boost::shared_ptr< WGridRegular3D >( new WGridRegular3D( size, size, size, 1.5, 1.5, 2.0 ) );
+
+        boost::shared_ptr< std::vector< float > > data( new std::vector< float >( size * size * size ) );
+        for( size_t i = 0; i < data->size(); ++i )
+        {
+            ( *data )[ i ] = static_cast< float >( i % 251 );
+        }
+        boost::shared_ptr< WValueSet< float > > valueSet( new WValueSet< float >( 0, 1, data, W_DT_FLOAT ) );
+        m_dataSet = boost::shared_ptr< WDataSetScalar >( new WDataSetScalar( valueSet, m_grid ) );
+
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> x( 0.0, ( size - 1.001 ) * 1.5 );
+        boost::random::uniform_real_distribution<> z( 0.0, ( size - 1.001 ) * 2.0 );
+        m_positions.resize( 1000000 );
+        for( size_t i = 0; i < m_positions.size(); ++i )
+        {
+            m_positions[ i ] = WPosition( x( rng ), x( rng ), z( rng ) );
+        }
+    }
+
+    /**
+     * Frees the dataset.
+     */
+    virtual void tearDown()
+    {
+        m_dataSet.reset();
+        m_grid.reset();
+        m_positions.clear();
+    }
+
+protected:
+    /**
+     * The grid.
+     */
+    boost::shared_ptr< WGridRegular3D > m_grid;
+
+    /**
+     * A scalar dataset on the grid.
+     */
+    boost::shared_ptr< WDataSetScalar > m_dataSet;
+
+    /**
+     * The query positions.
+     */
+    std::vector< WPosition > m_positions;
+};
+
+/**
+ * Measures WGridRegular3D::getCellId.
+ */
+class WGridRegular3DCellIdBenchmark: public WGridQueryBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WGridRegular3DCellIdBenchmark():
+        WGridQueryBenchmark( "WGridRegular3D::getCellId" )
+    {
+    }
+
+    /**
+     * Queries the cell of each position.
+     *
+     * \return number of positions
+     */
+    virtual size_t run()
+    {
+        size_t sum = 0;
+        bool success = false;
+        for( size_t i = 0; i < m_positions.size(); ++i )
+        {
+            sum += m_grid->getCellId( m_positions[ i ], &success );
+        }
+        consume( static_cast< double >( sum ) );
+        return m_positions.size();
+    }
+};
+
+/**
+ * Measures trilinear interpolation in WDataSetScalar::interpolate.
+ */
+class WDataSetScalarInterpolateBenchmark: public WGridQueryBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WDataSetScalarInterpolateBenchmark():
+        WGridQueryBenchmark( "WDataSetScalar::interpolate" )
+    {
+    }
+
+    /**
+     * Interpolates at each position.
+     *
+     * \return number of positions
+     */
+    virtual size_t run()
+    {
+        double sum = 0.0;
+        bool success = false;
+        for( size_t i = 0; i < m_positions.size(); ++i )
+        {
+            sum += m_dataSet->interpolate( m_positions[ i ], &success );
+        }
+        consume( sum );
+        return m_positions.size();
+    }
+};
+
+W_REGISTER_BENCHMARK( WGridRegular3DCellIdBenchmark )
+W_REGISTER_BENCHMARK( WDataSetScalarInterpolateBenchmark )
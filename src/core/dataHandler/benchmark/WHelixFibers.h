@@ -0,0 +1,91 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WHELIXFIBERS_H
+#define WHELIXFIBERS_H
+
+#include <cmath>
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/math/linearAlgebra/WPosition.h"
+#include "../WDataSetFibers.h"
+
+/**
+ * The synthetic fibers of the fiber benchmarks, so all of them measure the same kind of data. The fibers are helices
+ * along the z-axis with a radius of 5, 50 to 150 vertices, 0.1 radians and 0.5 units per vertex. The random numbers
+ * have a fixed seed, so every run gets the same fibers.
+ */
+class WHelixFibers // NOLINT
+{
+public:
+    /**
+     * Creates the fibers. The start of every helix is drawn uniformly from a box, the default spreads them over a
+     * volume of typical brain size.
+     *
+     * \param numFibers the number of fibers
+     * \param boxMin the minimum corner of the box of the helix starts
+     * \param boxMax the maximum corner of the box of the helix starts
+     *
+     * \return the fibers
+     */
+    static WDataSetFibers::SPtr create( size_t numFibers, WPosition const& boxMin = WPosition( 0.0, 0.0, 0.0 ),
+                                        WPosition const& boxMax = WPosition( 160.0, 160.0, 160.0 ) )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution<> posX( boxMin[ 0 ], boxMax[ 0 ] );
+        boost::random::uniform_real_distribution<> posY( boxMin[ 1 ], boxMax[ 1 ] );
+        boost::random::uniform_real_distribution<> posZ( boxMin[ 2 ], boxMax[ 2 ] );
+        boost::random::uniform_real_distribution<> angle( 0.0, 6.283 );
+        boost::random::uniform_int_distribution<> length( 50, 150 );
+
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< size_t > > starts( new std::vector< size_t > );
+        boost::shared_ptr< std::vector< size_t > > lengths( new std::vector< size_t > );
+        boost::shared_ptr< std::vector< size_t > > reverse( new std::vector< size_t > );
+        for( size_t fiber = 0; fiber < numFibers; ++fiber )
+        {
+            size_t len = length( rng );
+            double x = posX( rng );
+            double y = posY( rng );
+            double z = posZ( rng );
+            double phase = angle( rng );
+            starts->push_back( reverse->size() );
+            lengths->push_back( len );
+            for( size_t i = 0; i < len; ++i )
+            {
+                double t = phase + 0.1 * i;
+                vertices->push_back( static_cast< float >( x + 5.0 * std::cos( t ) ) );
+                vertices->push_back( static_cast< float >( y + 5.0 * std::sin( t ) ) );
+                vertices->push_back( static_cast< float >( z + 0.5 * i ) );
+                reverse->push_back( fiber );
+            }
+        }
+        return WDataSetFibers::SPtr( new WDataSetFibers( vertices, starts, lengths, reverse ) );
+    }
+};
+
+#endif  // WHELIXFIBERS_H
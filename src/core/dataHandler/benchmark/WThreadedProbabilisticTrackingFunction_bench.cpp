@@ -0,0 +1,129 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../../common/WThreadedFunction.h"
+#include "../WDataSetScalar.h"
+#include "../WGridRegular3D.h"
+#include "../WThreadedProbabilisticTrackingFunction.h"
+#include "../WValueSet.h"
+
+/**
+ * Measures probabilistic tracking on a 64^3 grid. The size is the number of threads, so samples per second should
+ * grow linearly with it up to the number of cores.
+ */
+class WThreadedProbabilisticTrackingBenchmark: public WBenchmark
+{
+    //! the tracking function
+    typedef wtracking::WThreadedProbabilisticTrackingFunction TrackingType;
+
+public:
+    /**
+     * Constructor.
+     */
+    WThreadedProbabilisticTrackingBenchmark():
+        WBenchmark( "WThreadedProbabilisticTrackingFunction" ),
+        m_numThreads( 1 )
+    {
+        addSize( 1 );
+        addSize( 2 );
+        addSize( 4 );
+        addSize( 8 );
+    }
+
+    /**
+     * Creates the dataset.
+     *
+     * \param size the number of threads
+     */
+    virtual void setUp( size_t size )
+    {
+        m_numThreads = size;
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( 64, 64, 64 ) );
+        boost::shared_ptr< std::vector< float > > data( new std::vector< float >( grid->size(), 1.0f ) );
+        boost::shared_ptr< WValueSet< float > > valueSet( new WValueSet< float >( 0, 1, data, W_DT_FLOAT ) );
+        m_dataSet = boost::shared_ptr< WDataSetScalar >( new WDataSetScalar( valueSet, grid ) );
+    }
+
+    /**
+     * Tracks 100 streamlines from each of 4^3 seed voxels in the center.
+     *
+     * \return number of streamlines
+     */
+    virtual size_t run()
+    {
+        std::vector< int > v0( 3, 30 );
+        std::vector< int > v1( 3, 34 );
+        boost::shared_ptr< TrackingType > tracking( new TrackingType( m_dataSet, &sampleDirection, 100, 1, v0, v1, 42 ) );
+
+        WThreadedFunction< TrackingType > pool( m_numThreads, tracking );
+        pool.run();
+        pool.wait();
+
+        consume( static_cast< double >( ( *tracking->getVisitCounts() )[ 32 * 64 * 64 + 32 * 64 + 32 ] ) );
+        return 4 * 4 * 4 * 100;
+    }
+
+    /**
+     * Frees the dataset.
+     */
+    virtual void tearDown()
+    {
+        m_dataSet.reset();
+    }
+
+private:
+    /**
+     * Perturbs the previous direction, or the x-axis for the first step, by a normally distributed offset.
+     *
+     * \param job The current position and the previous direction.
+     * \param rng The random number generator.
+     *
+     * \return The next direction.
+     */
+    static WVector3d sampleDirection( TrackingType::DataSetPtr, TrackingType::JobType const& job, TrackingType::RandomEngine& rng )
+    {
+        boost::random::normal_distribution< double > normal( 0.0, 0.3 );
+        WVector3d dir = length( job.second ) > 0.0 ? job.second : WVector3d( 1.0, 0.0, 0.0 );
+        return normalize( dir + WVector3d( normal( rng ), normal( rng ), normal( rng ) ) );
+    }
+
+    /**
+     * The number of threads.
+     */
+    size_t m_numThreads;
+
+    /**
+     * The dataset.
+     */
+    boost::shared_ptr< WDataSetScalar > m_dataSet;
+};
+
+W_REGISTER_BENCHMARK( WThreadedProbabilisticTrackingBenchmark )
@@ -0,0 +1,258 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/math/WGeometryFunctions.h"
+#include "../../common/math/WSymmetricSphericalHarmonic.h"
+#include "../../common/math/WTensorSym.h"
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../../common/WThreadedFunction.h"
+#include "../WGridRegular3D.h"
+#include "../WThreadedEigenSystems.h"
+#include "../WThreadedScalarMaps.h"
+#include "../WValueSet.h"
+
+/**
+ * Base of the scalar map benchmarks: computes FA, MD, RD, AD and GFA of random float tensors and order 4 spherical
+ * harmonics. The size is the number of voxels in every direction.
+ */
+class WScalarMapsBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param name the name of the benchmark
+     */
+    explicit WScalarMapsBenchmark( std::string const& name ):
+        WBenchmark( name )
+    {
+        addSize( 32 );
+        addSize( 64 );
+    }
+
+    /**
+     * Creates the datasets.
+     *
+     * \param size the number of voxels in every direction
+     */
+    virtual void setUp( size_t size )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution< float > offDiagonal( -0.2f, 0.2f );
+        boost::random::uniform_real_distribution< float > diagonal( 0.5f, 2.0f );
+        boost::random::uniform_real_distribution< double > coefficient( -0.2, 0.2 );
+
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( size, size, size ) );
+        boost::shared_ptr< std::vector< float > > tensors( new std::vector< float >( 6 * grid->size() ) );
+        boost::shared_ptr< std::vector< double > > coefficients( new std::vector< double >( 15 * grid->size() ) );
+        for( size_t i = 0; i < grid->size(); ++i )
+        {
+            float* t = &( *tensors )[ 6 * i ];
+            t[ 0 ] = diagonal( rng );
+            t[ 1 ] = offDiagonal( rng );
+            t[ 2 ] = offDiagonal( rng );
+            t[ 3 ] = diagonal( rng );
+            t[ 4 ] = offDiagonal( rng );
+            t[ 5 ] = diagonal( rng );
+            ( *coefficients )[ 15 * i ] = 1.0;
+            for( size_t k = 1; k < 15; ++k )
+            {
+                ( *coefficients )[ 15 * i + k ] = coefficient( rng );
+            }
+        }
+        boost::shared_ptr< WValueSetBase > tensorValues( new WValueSet< float >( 1, 6, tensors, W_DT_FLOAT ) );
+        boost::shared_ptr< WValueSetBase > shValues( new WValueSet< double >( 1, 15, coefficients, W_DT_DOUBLE ) );
+        m_tensors = boost::shared_ptr< WDataSetSingle >( new WDataSetSingle( tensorValues, grid ) );
+        m_sh = boost::shared_ptr< WDataSetSphericalHarmonics >( new WDataSetSphericalHarmonics( shValues, grid ) );
+    }
+
+    /**
+     * Frees the datasets.
+     */
+    virtual void tearDown()
+    {
+        m_tensors.reset();
+        m_sh.reset();
+    }
+
+protected:
+    /**
+     * The tensors.
+     */
+    boost::shared_ptr< WDataSetSingle > m_tensors;
+
+    /**
+     * The spherical harmonics.
+     */
+    boost::shared_ptr< WDataSetSphericalHarmonics > m_sh;
+};
+
+/**
+ * Computes the maps like the modules do today: the eigen systems first (WMEigenSystem), one pass over tensors and
+ * eigenvalues per measure into a new double map (WMDiffTensorScalars), and a pass with per voxel ODF sampling for the
+ * GFA (WMCalculateGFA).
+ */
+class WSeparateScalarMapsBenchmark: public WScalarMapsBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WSeparateScalarMapsBenchmark():
+        WScalarMapsBenchmark( "Scalar maps, separate passes" )
+    {
+    }
+
+    /**
+     * Computes the maps.
+     *
+     * \return the number of voxels
+     */
+    virtual size_t run()
+    {
+        boost::shared_ptr< WThreadedEigenSystems > eigen( new WThreadedEigenSystems( m_tensors ) );
+        WThreadedFunction< WThreadedEigenSystems > pool( 1, eigen );
+        pool.run();
+        pool.wait();
+        boost::shared_ptr< WValueSet< double > > evals = boost::dynamic_pointer_cast< WValueSet< double > >( eigen->getResult()->getValueSet() );
+        boost::shared_ptr< WValueSet< float > > tensors = boost::dynamic_pointer_cast< WValueSet< float > >( m_tensors->getValueSet() );
+        size_t const numVoxels = tensors->size();
+
+        // the eigen systems are sorted ascending, the scalar strategies expect the largest eigenvalue first
+        for( int measure = 0; measure < 4; ++measure )
+        {
+            std::vector< double > map( numVoxels );
+            for( size_t i = 0; i < numVoxels; ++i )
+            {
+                WTensorSym< 2, 3, float > tensor( tensors->getWValue( i ) );
+                double const* es = evals->rawData() + 12 * i;
+                WVector3d l( es[ 8 ], es[ 4 ], es[ 0 ] );
+                map[ i ] = scalar( measure, l, tensor );
+            }
+            consume( map[ numVoxels / 2 ] );
+        }
+
+        std::vector< WVector3d > vertices;
+        std::vector< unsigned int > triangles;
+        tesselateIcosahedron( &vertices, &triangles, 2 );
+        std::vector< WUnitSphereCoordinates< double > > orientations;
+        for( size_t k = 0; k < vertices.size(); ++k )
+        {
+            if( vertices[ k ][ 0 ] >= 0.0 )
+            {
+                orientations.push_back( WUnitSphereCoordinates< double >( vertices[ k ] ) );
+            }
+        }
+        WMatrix< double > const basis = WSymmetricSphericalHarmonic< double >::calcBaseMatrix( orientations, 4 );
+        boost::shared_ptr< WValueSet< double > > sh = boost::dynamic_pointer_cast< WValueSet< double > >( m_sh->getValueSet() );
+        std::vector< double > gfa( numVoxels );
+        for( size_t i = 0; i < numVoxels; ++i )
+        {
+            WValue< double > w( 15 );
+            for( size_t k = 0; k < 15; ++k )
+            {
+                w[ k ] = sh->rawData()[ 15 * i + k ];
+            }
+            gfa[ i ] = WSymmetricSphericalHarmonic< double >( w ).calcGFA( basis );
+        }
+        consume( gfa[ numVoxels / 2 ] );
+
+        return numVoxels;
+    }
+
+private:
+    /**
+     * Computes FA, MD, RD or AD like the strategies of WMDiffTensorScalars.
+     *
+     * \param measure 0 for FA, 1 for MD, 2 for RD and 3 for AD
+     * \param l the eigenvalues, largest first
+     * \param tensor the tensor, which is passed to the strategies but not used by these measures
+     *
+     * \return the measure
+     */
+    static double scalar( int measure, WVector3d const& l, WTensorSym< 2, 3, float > const& /* tensor */ )
+    {
+        switch( measure )
+        {
+            case 0:
+            {
+                double mean = ( l[0] + l[1] + l[2] ) / 3.0;
+                double nom = ( l[0] - mean ) * ( l[0] - mean ) + ( l[1] - mean ) * ( l[1] - mean ) + ( l[2] - mean ) * ( l[2] - mean );
+                return std::sqrt( 1.5 * nom / ( l[0] * l[0] + l[1] * l[1] + l[2] * l[2] ) );
+            }
+            case 1:
+                return ( l[0] + l[1] + l[2] ) / 3.0;
+            case 2:
+                return 0.5 * ( l[1] + l[2] );
+            default:
+                return l[0];
+        }
+    }
+};
+
+/**
+ * Computes the same maps with WThreadedScalarMaps in a single pass.
+ */
+class WFusedScalarMapsBenchmark: public WScalarMapsBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WFusedScalarMapsBenchmark():
+        WScalarMapsBenchmark( "Scalar maps, fused (WThreadedScalarMaps)" )
+    {
+    }
+
+    /**
+     * Computes the maps.
+     *
+     * \return the number of voxels
+     */
+    virtual size_t run()
+    {
+        unsigned int const measures = WThreadedScalarMaps::FA | WThreadedScalarMaps::MD | WThreadedScalarMaps::RD
+                                      | WThreadedScalarMaps::AD | WThreadedScalarMaps::GFA;
+        boost::shared_ptr< WThreadedScalarMaps > maps( new WThreadedScalarMaps( measures, m_tensors, m_sh ) );
+        WThreadedFunction< WThreadedScalarMaps > pool( 1, maps );
+        pool.run();
+        pool.wait();
+
+        boost::shared_ptr< WValueSet< float > > gfa = boost::dynamic_pointer_cast< WValueSet< float > >(
+            maps->getResult( WThreadedScalarMaps::GFA )->getValueSet() );
+        consume( gfa->rawData()[ gfa->size() / 2 ] );
+        return gfa->size();
+    }
+};
+
+W_REGISTER_BENCHMARK( WSeparateScalarMapsBenchmark )
+W_REGISTER_BENCHMARK( WFusedScalarMapsBenchmark )
@@ -0,0 +1,93 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../datastructures/WValueSetHistogram.h"
+#include "../WValueSet.h"
+
+/**
+ * Measures building a histogram of a value set with size^3 values.
+ */
+class WValueSetHistogramBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WValueSetHistogramBenchmark():
+        WBenchmark( "WValueSetHistogram" )
+    {
+        addSize( 64 );
+        addSize( 128 );
+        addSize( 256 );
+    }
+
+    /**
+     * Creates the value set.
+     *
+     * \param size values per dimension
+     */
+    virtual void setUp( size_t size )
+    {
+        boost::shared_ptr< std::vector< float > > data( new std::vector< float >( size * size * size ) );
+        for( size_t i = 0; i < data->size(); ++i )
+        {
+            ( *data )[ i ] = static_cast< float >( ( i * 7919 ) % 4096 ) * 0.25f;
+        }
+        m_valueSet = boost::shared_ptr< WValueSet< float > >( new WValueSet< float >( 0, 1, data, W_DT_FLOAT ) );
+    }
+
+    /**
+     * Builds the histogram.
+     *
+     * \return number of values
+     */
+    virtual size_t run()
+    {
+        WValueSetHistogram histogram( m_valueSet, 1000 );
+        consume( static_cast< double >( histogram[ 500 ] ) );
+        return m_valueSet->size();
+    }
+
+    /**
+     * Frees the value set.
+     */
+    virtual void tearDown()
+    {
+        m_valueSet.reset();
+    }
+
+private:
+    /**
+     * The values.
+     */
+    boost::shared_ptr< WValueSet< float > > m_valueSet;
+};
+
+W_REGISTER_BENCHMARK( WValueSetHistogramBenchmark )
@@ -34,11 +34,46 @@
 #include "../../common/WLimits.h"
 #include "../../common/WTransferable.h"
 #include "../WDataSetFiberVector.h"
+#include "../WFlatFiberVector.h"
 #include "WFiberCluster.h"
 
 // The prototype as singleton. Created during first getPrototype() call
 boost::shared_ptr< WPrototyped > WFiberCluster::m_prototype = boost::shared_ptr< WPrototyped >();
 
+namespace
+{
+    /**
+     * Whether a fiber runs in the opposite direction of the fiber defining the direction of a cluster. Both are compared
+     * at their ends and at one and two thirds of their points.
+     *
+     * \tparam Fiber WFiber or WFiberView
+     * \param firstFib the fiber defining the direction
+     * \param other the fiber to test
+     *
+     * \return true if other should be reversed
+     */
+    template< typename Fiber >
+    bool hasInverseDirection( const Fiber& firstFib, const Fiber& other )
+    {
+        const WPosition start = firstFib.front();
+        const WPosition m1    = firstFib[ firstFib.size() * 1.0 / 3.0 ];
+        const WPosition m2    = firstFib[ firstFib.size() * 2.0 / 3.0 ];
+        const WPosition end   = firstFib.back();
+
+        double        distance = length2( start - other.front() ) +
+                                 length2( m1 - other[ other.size() * 1.0 / 3.0 ] ) +
+                                 length2( m2 - other[ other.size() * 2.0 / 3.0 ] ) +
+                                 length2( end - other.back() );
+        double inverseDistance = length2( start - other.back() ) +
+                                 length2( m1 - other[ other.size() * 2.0 / 3.0 ] ) +
+                                 length2( m2 - other[ other.size() * 1.0 / 3.0 ] ) +
+                                 length2( end - other.front() );
+        distance        /= 4.0;
+        inverseDistance /= 4.0;
+        return inverseDistance < distance;
+    }
+}
+
 WFiberCluster::WFiberCluster()
     : WTransferable(),
     m_centerLineCreationLock( new boost::shared_mutex() ),
@@ -165,33 +200,34 @@ void WFiberCluster::generateCenterLine() const
         return;
     }
 
-    // make copies of the fibers
-    boost::shared_ptr< WDataSetFiberVector > fibs( new WDataSetFiberVector() );
-    size_t avgFiberSize = 0;
+    // make copies of the fibers, all in one array
+    size_t numPoints = 0;
     for( WFiberCluster::IndexList::const_iterator cit = m_memberIndices.begin(); cit != m_memberIndices.end(); ++cit )
     {
-        fibs->push_back( m_fibs->at( *cit ) );
-        avgFiberSize += fibs->back().size();
+        numPoints += m_fibs->at( *cit ).size();
     }
-    avgFiberSize /= fibs->size();
-
-    unifyDirection( fibs );
-
-    for( WDataSetFiberVector::iterator cit = fibs->begin(); cit != fibs->end(); ++cit )
+    WFlatFiberVector fibs;
+    fibs.reserve( m_memberIndices.size(), numPoints );
+    for( WFiberCluster::IndexList::const_iterator cit = m_memberIndices.begin(); cit != m_memberIndices.end(); ++cit )
     {
-        cit->resampleByNumberOfPoints( avgFiberSize );
+        fibs.push_back( m_fibs->at( *cit ) );
     }
+    size_t avgFiberSize = numPoints / fibs.size();
+
+    unifyDirection( &fibs );
+
+    WFlatFiberVector::SPtr resampled = fibs.resampleByNumberOfPoints( avgFiberSize );
 
     m_centerLine = boost::shared_ptr< WFiber >( new WFiber() );
     m_centerLine->reserve( avgFiberSize );
     for( size_t i = 0; i < avgFiberSize; ++i )
     {
         WPosition avgPosition( 0, 0, 0 );
-        for( WDataSetFiberVector::const_iterator cit = fibs->begin(); cit != fibs->end(); ++cit )
+        for( size_t fiberID = 0; fiberID < resampled->size(); ++fiberID )
         {
-            avgPosition += cit->at( i );
+            avgPosition += ( *resampled )[ fiberID ][ i ];
         }
-        avgPosition /= static_cast< double >( fibs->size() );
+        avgPosition /= static_cast< double >( resampled->size() );
         m_centerLine->push_back( avgPosition );
     }
 
@@ -246,11 +282,12 @@ void WFiberCluster::elongateCenterLine() const
     boost::shared_ptr< WPosition > cutPoint( new WPosition( 0, 0, 0 ) );
     bool intersectionFound = true;
 
-    // in the beginning all fibers participate
-    boost::shared_ptr< WDataSetFiberVector > fibs( new WDataSetFiberVector() );
+    // in the beginning all fibers participate, they are only referenced as they are never modified
+    std::vector< const WFiber* > fibs;
+    fibs.reserve( m_memberIndices.size() );
     for( WFiberCluster::IndexList::const_iterator cit = m_memberIndices.begin(); cit != m_memberIndices.end(); ++cit )
     {
-        fibs->push_back( m_fibs->at( *cit ) );
+        fibs.push_back( &m_fibs->at( *cit ) );
     }
 
     while( intersectionFound )
@@ -258,27 +295,19 @@ void WFiberCluster::elongateCenterLine() const
         intersectionFound = false;
         size_t intersectingFibers = 0;
 //        WPosition avg( 0, 0, 0 );
-        for( WDataSetFiberVector::iterator cit = fibs->begin(); cit != fibs->end(); )
+        // keep the intersecting fibers in order, erasing the others at once
+        std::vector< const WFiber* >::iterator kept = fibs.begin();
+        for( std::vector< const WFiber* >::const_iterator cit = fibs.begin(); cit != fibs.end(); ++cit )
         {
-            if( intersectPlaneLineNearCP( p, *cit, cutPoint ) )
-            {
-                if( length( *cutPoint - p.getPosition() ) < 20 )
-                {
-//                    avg += *cutPoint;
-                    intersectingFibers++;
-                    intersectionFound = true;
-                    ++cit;
-                }
-                else
-                {
-                    cit = fibs->erase( cit );
-                }
-            }
-            else
+            if( intersectPlaneLineNearCP( p, **cit, cutPoint ) && length( *cutPoint - p.getPosition() ) < 20 )
             {
-                cit = fibs->erase( cit );
+//                avg += *cutPoint;
+                intersectingFibers++;
+                intersectionFound = true;
+                *kept++ = *cit;
             }
         }
+        fibs.erase( kept, fibs.end() );
         if( intersectingFibers > 10 )
         {
             cL.insert( cL.begin(), cL[0] + ( cL[0] - cL[1] ) );
@@ -296,10 +325,11 @@ void WFiberCluster::elongateCenterLine() const
         }
     }
     // second ending of the centerline
-    boost::shared_ptr< WDataSetFiberVector > fobs( new WDataSetFiberVector() );
+    std::vector< const WFiber* > fobs;
+    fobs.reserve( m_memberIndices.size() );
     for( WFiberCluster::IndexList::const_iterator cit = m_memberIndices.begin(); cit != m_memberIndices.end(); ++cit )
     {
-        fobs->push_back( m_fibs->at( *cit ) );
+        fobs.push_back( &m_fibs->at( *cit ) );
     }
 
     // try to discard other lines from other end
@@ -311,27 +341,19 @@ void WFiberCluster::elongateCenterLine() const
         intersectionFound = false;
         size_t intersectingFibers = 0;
 //        WPosition avg( 0, 0, 0 );
-        for( WDataSetFiberVector::iterator cit = fobs->begin(); cit != fobs->end(); )
+        // keep the intersecting fibers in order, erasing the others at once
+        std::vector< const WFiber* >::iterator kept = fobs.begin();
+        for( std::vector< const WFiber* >::const_iterator cit = fobs.begin(); cit != fobs.end(); ++cit )
         {
-            if( intersectPlaneLineNearCP( q, *cit, cutPoint ) )
-            {
-                if( length( *cutPoint - q.getPosition() ) < 20 )
-                {
-//                    avg += *cutPoint;
-                    intersectingFibers++;
-                    intersectionFound = true;
-                    ++cit;
-                }
-                else
-                {
-                    cit = fobs->erase( cit );
-                }
-            }
-            else
+            if( intersectPlaneLineNearCP( q, **cit, cutPoint ) && length( *cutPoint - q.getPosition() ) < 20 )
             {
-                cit = fobs->erase( cit );
+//                avg += *cutPoint;
+                intersectingFibers++;
+                intersectionFound = true;
+                *kept++ = *cit;
             }
         }
+        fobs.erase( kept, fobs.end() );
         if( intersectingFibers > 10 )
         {
             cL.push_back(  cL.back() + ( cL.back() - cL[ cL.size() - 2 ] ) );
@@ -362,31 +384,35 @@ void WFiberCluster::unifyDirection( boost::shared_ptr< WDataSetFiberVector > fib
 
     // first fiber defines direction
     const WFiber& firstFib = fibs->front();
-    const WPosition start = firstFib.front();
-    const WPosition m1    = firstFib.at( firstFib.size() * 1.0 / 3.0 );
-    const WPosition m2    = firstFib.at( firstFib.size() * 2.0 / 3.0 );
-    const WPosition end   = firstFib.back();
-
     for( WDataSetFiberVector::iterator cit = fibs->begin() + 1; cit != fibs->end(); ++cit )
     {
-        const WFiber& other = *cit;
-        double        distance = length2( start - other.front() ) +
-                                 length2( m1 - other.at( other.size() * 1.0 / 3.0 ) ) +
-                                 length2( m2 - other.at( other.size() * 2.0 / 3.0 ) ) +
-                                 length2( end - other.back() );
-        double inverseDistance = length2( start - other.back() ) +
-                                 length2( m1 - other.at( other.size() * 2.0 / 3.0 ) ) +
-                                 length2( m2 - other.at( other.size() * 1.0 / 3.0 ) ) +
-                                 length2( end - other.front() );
-        distance        /= 4.0;
-        inverseDistance /= 4.0;
-        if( inverseDistance < distance )
+        if( hasInverseDirection( firstFib, *cit ) )
         {
             cit->reverseOrder();
         }
     }
 }
 
+void WFiberCluster::unifyDirection( WFlatFiberVector* fibs ) const
+{
+    if( fibs->size() < 2 )
+    {
+        return;
+    }
+
+    assert( !( ( *fibs )[ 0 ].empty() ) && "WFiberCluster.unifyDirection: Empty fiber processed.. aborting" );
+
+    // first fiber defines direction, reversing the others does not move its points
+    const WFiberView firstFib = ( *fibs )[ 0 ];
+    for( size_t fiberID = 1; fiberID < fibs->size(); ++fiberID )
+    {
+        if( hasInverseDirection( firstFib, ( *fibs )[ fiberID ] ) )
+        {
+            fibs->reverse( fiberID );
+        }
+    }
+}
+
 boost::shared_ptr< WFiber > WFiberCluster::getCenterLine() const
 {
     if( !m_centerLine )
@@ -36,6 +36,7 @@
 #include "../../common/WTransferable.h"
 #include "../WDataSetFiberVector.h"
 
+class WFlatFiberVector;
 
 /**
  * Represents a cluster of indices of a WDataSetFiberVector.
@@ -326,6 +327,14 @@ protected:
      */
     void unifyDirection( boost::shared_ptr< WDataSetFiberVector > fibs ) const;
 
+    /**
+     * Alings all fibers like unifyDirection( boost::shared_ptr< WDataSetFiberVector > ), but reverses the fibers in place
+     * in their flat storage.
+     *
+     * \param fibs The fibers
+     */
+    void unifyDirection( WFlatFiberVector* fibs ) const;
+
 private:
     /**
      * The centerline may be shortened due to the averaging of outliers. To
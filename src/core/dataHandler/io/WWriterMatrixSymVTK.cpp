@@ -65,3 +65,40 @@ void WWriterMatrixSymVTK::writeTable( const std::vector< double > &table, size_t
     out << std::endl;
     out.close();
 }
+
+void WWriterMatrixSymVTK::writeTable( size_t dim, boost::function< void( std::vector< float >* ) > nextElements ) const
+{
+    using std::fstream;
+    fstream out( m_fname.c_str(), fstream::out | fstream::in | fstream::trunc );
+    if( !out || out.bad() )
+    {
+        throw WDHIOFailure( std::string( "Invalid file, or permission: " + m_fname ) );
+    }
+    out << "# vtk DataFile Version 3.0" << std::endl;
+    out << "WMatrixSym from OpenWalnut" << std::endl;
+    out << "BINARY" << std::endl;
+
+    out << "FIELD WMatrixSym 1" << std::endl;
+    size_t const numElements = ( dim * dim - dim ) / 2;
+    out << "ELEMENTS " << numElements + 1 << " 1 float" << std::endl;
+
+    std::vector< float > block;
+    size_t written = 0;
+    while( written < numElements )
+    {
+        nextElements( &block );
+        if( block.empty() || written + block.size() > numElements )
+        {
+            throw WDHIOFailure( std::string( "Wrong number of elements for: " + m_fname ) );
+        }
+        written += block.size();
+        switchByteOrderOfArray< float >( &block[ 0 ], block.size() );
+        out.write( reinterpret_cast< char* >( &block[ 0 ] ), sizeof( float ) * block.size() );
+    }
+
+    float last = static_cast< float >( dim );
+    switchByteOrderOfArray< float >( &last, 1 );
+    out.write( reinterpret_cast< char* >( &last ), sizeof( float ) );
+    out << std::endl;
+    out.close();
+}
@@ -28,9 +28,9 @@
 #include <string>
 #include <vector>
 
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 
-
 #include "WWriter.h"
 
 /**
@@ -55,6 +55,17 @@ public:
      */
     void writeTable( const std::vector< double > &table, size_t dim ) const;
 
+    /**
+     * Writes a table that is created block by block, so it never has to be kept in memory as a whole.
+     *
+     * \param dim the dimensionality of the table
+     * \param nextElements called until all (dim^2-dim)/2 elements are written, each time replacing the content of the given
+     * vector with the next elements in row major order
+     *
+     * \throw WDHIOFailure if the file cannot be written or nextElements gives no or too many elements
+     */
+    void writeTable( size_t dim, boost::function< void( std::vector< float >* ) > nextElements ) const;
+
 protected:
 private:
 };
@@ -68,6 +68,42 @@ public:
         WDataSetFiberVector d( m_somefibs );
         TS_ASSERT_EQUALS( d[2], expected );
     }
+
+    /**
+     * Converting a large WDataSetFibers in parallel and back gives the original arrays.
+     */
+    void testParallelConversion( void )
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< size_t > > starts( new std::vector< size_t > );
+        boost::shared_ptr< std::vector< size_t > > lengths( new std::vector< size_t > );
+        boost::shared_ptr< std::vector< size_t > > verticesReverse( new std::vector< size_t > );
+        for( size_t i = 0; i < 3000; ++i )
+        {
+            starts->push_back( verticesReverse->size() );
+            lengths->push_back( 20 + i % 17 );
+            for( size_t k = 0; k < lengths->back(); ++k )
+            {
+                vertices->push_back( 0.5 * k );
+                vertices->push_back( 0.1 * i );
+                vertices->push_back( 0.01 * k * i );
+                verticesReverse->push_back( i );
+            }
+        }
+        boost::shared_ptr< WDataSetFibers > fibers( new WDataSetFibers( vertices, starts, lengths, verticesReverse ) );
+
+        WDataSetFiberVector d( fibers, 4 );
+        TS_ASSERT_EQUALS( d.size(), 3000 );
+        TS_ASSERT_EQUALS( d[ 2999 ].size(), 20 + 2999 % 17 );
+        TS_ASSERT_EQUALS( d[ 2999 ][ 3 ], WPosition( ( *vertices )[ 3 * ( starts->back() + 3 ) ], ( *vertices )[ 3 * ( starts->back() + 3 ) + 1 ],
+                                                     ( *vertices )[ 3 * ( starts->back() + 3 ) + 2 ] ) );
+
+        boost::shared_ptr< WDataSetFibers > converted = d.toWDataSetFibers( 3 );
+        TS_ASSERT( *converted->getVertices() == *vertices );
+        TS_ASSERT( *converted->getLineStartIndexes() == *starts );
+        TS_ASSERT( *converted->getLineLengths() == *lengths );
+        TS_ASSERT( *converted->getVerticesReverse() == *verticesReverse );
+    }
 private:
     boost::shared_ptr< std::vector< WFiber > > m_somefibs; //!< Default fiber dataset
 };
@@ -0,0 +1,263 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WFIBERAGGLOMERATIVECLUSTERING_TEST_H
+#define WFIBERAGGLOMERATIVECLUSTERING_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/WLogger.h"
+#include "../WFiberAgglomerativeClustering.h"
+
+/**
+ * Test the agglomerative fiber clustering.
+ */
+class WFiberAgglomerativeClusteringTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Setup logger.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * Three separated bundles are the last three clusters, and cutting the tree gives them back.
+     */
+    void testBundles()
+    {
+        WDataSetFibers::SPtr fibers = buildBundles( 3, 10 );
+        WFiberAgglomerativeClustering clustering( fibers, 10 );
+        TS_ASSERT_EQUALS( clustering.size(), 30 );
+
+        WBoolFlag shutdown( new WCondition(), false );
+        boost::shared_ptr< WHierarchicalTreeFibers > tree = clustering.compute( shutdown );
+        TS_ASSERT( tree );
+        TS_ASSERT_EQUALS( tree->getLeafCount(), 30 );
+        TS_ASSERT_EQUALS( tree->getClusterCount(), 59 );
+        TS_ASSERT_EQUALS( tree->size( 58 ), 30 );
+
+        // the merge distances grow, every cluster is merged after its parts
+        for( std::size_t cluster = 30; cluster < 59; ++cluster )
+        {
+            std::pair< std::size_t, std::size_t > const children = tree->getChildren( cluster );
+            TS_ASSERT_LESS_THAN( children.first, cluster );
+            TS_ASSERT_LESS_THAN( children.second, cluster );
+            TS_ASSERT_EQUALS( tree->size( cluster ), tree->size( children.first ) + tree->size( children.second ) );
+            TS_ASSERT_LESS_THAN_EQUALS( tree->getCustomData( cluster - 1 ), tree->getCustomData( cluster ) );
+        }
+
+        WDataSetFiberClustering::SPtr cut = WFiberAgglomerativeClustering::cut( *tree, 3 );
+        TS_ASSERT_EQUALS( cut->size(), 3 );
+        for( std::size_t bundle = 0; bundle < 3; ++bundle )
+        {
+            WFiberCluster::IndexList const& indices = cut->getCluster( bundle )->getIndices();
+            TS_ASSERT_EQUALS( indices.size(), 10 );
+            for( WFiberCluster::IndexList::const_iterator it = indices.begin(); it != indices.end(); ++it )
+            {
+                TS_ASSERT_EQUALS( *it / 10, bundle );
+            }
+        }
+
+        TS_ASSERT_EQUALS( WFiberAgglomerativeClustering::cut( *tree, 1 )->size(), 1 );
+        TS_ASSERT_EQUALS( WFiberAgglomerativeClustering::cut( *tree, 100 )->size(), 30 );
+    }
+
+    /**
+     * The merge distances are those of the naive agglomeration with Ward's linkage.
+     */
+    void testSameAsNaiveWard()
+    {
+        WDataSetFibers::SPtr fibers = buildBundles( 4, 6 );
+        WFiberAgglomerativeClustering clustering( fibers, 5 );
+        WBoolFlag shutdown( new WCondition(), false );
+        boost::shared_ptr< WHierarchicalTreeFibers > tree = clustering.compute( shutdown );
+
+        // the fibers are straight lines with five points, so resampling does not change them, but every other fiber is
+        // reversed
+        std::vector< std::vector< double > > centroids( 24 );
+        std::vector< double > sizes( 24, 1.0 );
+        std::vector< float > const& vertices = *fibers->getVertices();
+        for( std::size_t fidx = 0; fidx < 24; ++fidx )
+        {
+            for( std::size_t k = 0; k < 5; ++k )
+            {
+                std::size_t const v = 15 * fidx + 3 * ( fidx % 2 ? 4 - k : k );
+                centroids[ fidx ].insert( centroids[ fidx ].end(), vertices.begin() + v, vertices.begin() + v + 3 );
+            }
+        }
+        std::vector< double > expected;
+        for( std::size_t merge = 0; merge < 23; ++merge )
+        {
+            double best = std::numeric_limits< double >::infinity();
+            std::size_t bestA = 0;
+            std::size_t bestB = 0;
+            for( std::size_t a = 0; a < 24; ++a )
+            {
+                for( std::size_t b = a + 1; b < 24 && sizes[ a ] > 0.0; ++b )
+                {
+                    if( sizes[ b ] == 0.0 )
+                    {
+                        continue;
+                    }
+                    double squares = 0.0;
+                    for( std::size_t c = 0; c < 15; ++c )
+                    {
+                        squares += ( centroids[ a ][ c ] - centroids[ b ][ c ] ) * ( centroids[ a ][ c ] - centroids[ b ][ c ] );
+                    }
+                    double const linkage = sizes[ a ] * sizes[ b ] / ( sizes[ a ] + sizes[ b ] ) * squares;
+                    if( linkage < best )
+                    {
+                        best = linkage;
+                        bestA = a;
+                        bestB = b;
+                    }
+                }
+            }
+            for( std::size_t c = 0; c < 15; ++c )
+            {
+                centroids[ bestA ][ c ] = ( sizes[ bestA ] * centroids[ bestA ][ c ] + sizes[ bestB ] * centroids[ bestB ][ c ] ) /
+                                          ( sizes[ bestA ] + sizes[ bestB ] );
+            }
+            sizes[ bestA ] += sizes[ bestB ];
+            sizes[ bestB ] = 0.0;
+            expected.push_back( std::sqrt( 2.0 * best / 5.0 ) );
+        }
+
+        for( std::size_t merge = 0; merge < 23; ++merge )
+        {
+            TS_ASSERT_DELTA( tree->getCustomData( 24 + merge ), expected[ merge ], 1e-3 );
+        }
+    }
+
+    /**
+     * A reversed copy of a fiber is merged with it at distance zero.
+     */
+    void testOrientation()
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< std::size_t > > starts( new std::vector< std::size_t > );
+        boost::shared_ptr< std::vector< std::size_t > > lengths( new std::vector< std::size_t > );
+        boost::shared_ptr< std::vector< std::size_t > > reverse( new std::vector< std::size_t > );
+        float const points[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.5f, 0.0f, 2.0f, 2.0f, 0.0f, // NOLINT
+                                 2.0f, 2.0f, 0.0f, 1.0f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
+                                 9.0f, 0.0f, 0.0f, 9.0f, 1.0f, 0.0f, 9.0f, 2.0f, 0.0f };
+        vertices->assign( points, points + 27 );
+        for( std::size_t fidx = 0; fidx < 3; ++fidx )
+        {
+            starts->push_back( 3 * fidx );
+            lengths->push_back( 3 );
+            reverse->insert( reverse->end(), 3, fidx );
+        }
+        WDataSetFibers::SPtr fibers( new WDataSetFibers( vertices, starts, lengths, reverse ) );
+
+        WBoolFlag shutdown( new WCondition(), false );
+        boost::shared_ptr< WHierarchicalTreeFibers > tree = WFiberAgglomerativeClustering( fibers, 7 ).compute( shutdown );
+        std::pair< std::size_t, std::size_t > const children = tree->getChildren( 3 );
+        TS_ASSERT_EQUALS( std::min( children.first, children.second ), 0 );
+        TS_ASSERT_EQUALS( std::max( children.first, children.second ), 1 );
+        TS_ASSERT_DELTA( tree->getCustomData( 3 ), 0.0, 1e-6 );
+    }
+
+    /**
+     * Splitting the nearest neighbor search over several threads gives the same tree.
+     */
+    void testMultithreaded()
+    {
+        WDataSetFibers::SPtr fibers = buildBundles( 5, 30 );
+
+        // enough points per fiber that the searches are split over the threads
+        WFiberAgglomerativeClustering serial( fibers, 2000, 1 );
+        WFiberAgglomerativeClustering parallel( fibers, 2000, 3 );
+        WBoolFlag shutdown( new WCondition(), false );
+        boost::shared_ptr< WHierarchicalTreeFibers > expected = serial.compute( shutdown );
+        boost::shared_ptr< WHierarchicalTreeFibers > tree = parallel.compute( shutdown );
+        TS_ASSERT_EQUALS( tree->getClusterCount(), expected->getClusterCount() );
+        for( std::size_t cluster = 150; cluster < tree->getClusterCount(); ++cluster )
+        {
+            TS_ASSERT_EQUALS( tree->getChildren( cluster ).first, expected->getChildren( cluster ).first );
+            TS_ASSERT_EQUALS( tree->getChildren( cluster ).second, expected->getChildren( cluster ).second );
+            TS_ASSERT_EQUALS( tree->getCustomData( cluster ), expected->getCustomData( cluster ) );
+        }
+    }
+
+    /**
+     * A set shutdown flag stops the clustering.
+     */
+    void testShutdown()
+    {
+        WFiberAgglomerativeClustering clustering( buildBundles( 2, 5 ) );
+        WBoolFlag shutdown( new WCondition(), true );
+        TS_ASSERT( !clustering.compute( shutdown ) );
+    }
+
+private:
+    /**
+     * Creates bundles of parallel straight fibers with five points each. The bundles are far apart at different distances,
+     * the fibers within a bundle have different distances to each other. Every other fiber runs in the opposite direction.
+     *
+     * \param numBundles the number of bundles
+     * \param bundleSize the number of fibers per bundle
+     *
+     * \return the fibers, bundle after bundle
+     */
+    WDataSetFibers::SPtr buildBundles( std::size_t numBundles, std::size_t bundleSize )
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< std::size_t > > starts( new std::vector< std::size_t > );
+        boost::shared_ptr< std::vector< std::size_t > > lengths( new std::vector< std::size_t > );
+        boost::shared_ptr< std::vector< std::size_t > > reverse( new std::vector< std::size_t > );
+        for( std::size_t bundle = 0; bundle < numBundles; ++bundle )
+        {
+            for( std::size_t i = 0; i < bundleSize; ++i )
+            {
+                std::size_t const fidx = bundle * bundleSize + i;
+                float const x = 50.0f * bundle * ( bundle + 1 ) + 0.3f * i + 0.01f * ( ( i * i ) % 7 );
+                float const y = 0.2f * ( ( i * 5 ) % 3 );
+                starts->push_back( reverse->size() );
+                lengths->push_back( 5 );
+                for( std::size_t k = 0; k < 5; ++k )
+                {
+                    float const z = 10.0f * ( i % 2 ? 4 - k : k );
+                    vertices->push_back( x );
+                    vertices->push_back( y );
+                    vertices->push_back( z );
+                    reverse->push_back( fidx );
+                }
+            }
+        }
+        return WDataSetFibers::SPtr( new WDataSetFibers( vertices, starts, lengths, reverse ) );
+    }
+};
+
+#endif  // WFIBERAGGLOMERATIVECLUSTERING_TEST_H
@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERBUILDER_TEST_H
+#define WFIBERBUILDER_TEST_H
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "../WFiberBuilder.h"
+
+/**
+ * Test the fiber builder.
+ */
+class WFiberBuilderTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * An empty builder yields an empty dataset.
+     */
+    void testEmpty()
+    {
+        WFiberBuilder builder;
+        boost::shared_ptr< WDataSetFibers > fibers = builder.buildDataSet();
+        TS_ASSERT( fibers );
+        TS_ASSERT_EQUALS( fibers->getVertices()->size(), 0 );
+        TS_ASSERT_EQUALS( fibers->getLineLengths()->size(), 0 );
+    }
+
+    /**
+     * Buffers pass full batches on and the rest when flushed, and the dataset arrays fit together.
+     */
+    void testBuffer()
+    {
+        WFiberBuilder::SPtr builder( new WFiberBuilder() );
+        {
+            WFiberBuilder::Buffer buffer( builder, 4, 2 );
+            for( size_t i = 0; i < 5; ++i )
+            {
+                buffer.add( makeFiber( i, i + 1 ) );
+            }
+            buffer.add( std::vector< WVector3d >() );
+            TS_ASSERT_EQUALS( builder->getNumFibers(), 4 );
+        }
+        TS_ASSERT_EQUALS( builder->getNumFibers(), 5 );
+        TS_ASSERT_EQUALS( builder->getNumVertices(), 15 );
+
+        boost::shared_ptr< WDataSetFibers > fibers = builder->buildDataSet();
+        TS_ASSERT_EQUALS( fibers->getVertices()->size(), 45 );
+        TS_ASSERT_EQUALS( fibers->getVerticesReverse()->size(), 15 );
+        size_t start = 0;
+        for( size_t i = 0; i < 5; ++i )
+        {
+            TS_ASSERT_EQUALS( ( *fibers->getLineLengths() )[ i ], i + 1 );
+            TS_ASSERT_EQUALS( ( *fibers->getLineStartIndexes() )[ i ], start );
+            for( size_t k = 0; k < i + 1; ++k )
+            {
+                TS_ASSERT_EQUALS( ( *fibers->getVerticesReverse() )[ start + k ], i );
+                TS_ASSERT_EQUALS( ( *fibers->getVertices() )[ 3 * ( start + k ) ], static_cast< float >( i ) );
+                TS_ASSERT_EQUALS( ( *fibers->getVertices() )[ 3 * ( start + k ) + 1 ], static_cast< float >( k ) );
+            }
+            start += i + 1;
+        }
+
+        builder->clear();
+        TS_ASSERT_EQUALS( builder->getNumFibers(), 0 );
+        TS_ASSERT_EQUALS( builder->buildDataSet()->getVertices()->size(), 0 );
+    }
+
+    /**
+     * Fibers appended by several threads must all arrive, and datasets built meanwhile must be consistent.
+     */
+    void testConcurrentAppend()
+    {
+        WFiberBuilder::SPtr builder( new WFiberBuilder() );
+        boost::thread_group threads;
+        for( size_t t = 0; t < 4; ++t )
+        {
+            threads.create_thread( boost::bind( &WFiberBuilderTest::addFibers, builder, t ) );
+        }
+        for( size_t i = 0; i < 20; ++i )
+        {
+            boost::shared_ptr< WDataSetFibers > partial = builder->buildDataSet();
+            TS_ASSERT_EQUALS( partial->getVertices()->size(), 3 * partial->getVerticesReverse()->size() );
+            TS_ASSERT_EQUALS( partial->getLineLengths()->size(), partial->getLineStartIndexes()->size() );
+        }
+        threads.join_all();
+
+        TS_ASSERT_EQUALS( builder->getNumFibers(), 4000 );
+        boost::shared_ptr< WDataSetFibers > fibers = builder->buildDataSet();
+        TS_ASSERT_EQUALS( fibers->getLineLengths()->size(), 4000 );
+        TS_ASSERT_EQUALS( fibers->getVertices()->size(), 3 * builder->getNumVertices() );
+    }
+
+private:
+    /**
+     * Creates a fiber.
+     *
+     * \param id The x coordinate of all points.
+     * \param length The number of points, the y coordinates are the point indices.
+     *
+     * \return The fiber.
+     */
+    static std::vector< WVector3d > makeFiber( size_t id, size_t length )
+    {
+        std::vector< WVector3d > fiber;
+        for( size_t k = 0; k < length; ++k )
+        {
+            fiber.push_back( WVector3d( static_cast< double >( id ), static_cast< double >( k ), 0.0 ) );
+        }
+        return fiber;
+    }
+
+    /**
+     * Adds 1000 fibers through a buffer.
+     *
+     * \param builder The builder.
+     * \param thread The number of the thread.
+     */
+    static void addFibers( WFiberBuilder::SPtr builder, size_t thread )
+    {
+        WFiberBuilder::Buffer buffer( builder, 8, 16 );
+        for( size_t i = 0; i < 1000; ++i )
+        {
+            buffer.add( makeFiber( thread, 1 + i % 13 ) );
+        }
+    }
+};
+
+#endif  // WFIBERBUILDER_TEST_H
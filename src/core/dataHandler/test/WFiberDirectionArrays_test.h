@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERDIRECTIONARRAYS_TEST_H
+#define WFIBERDIRECTIONARRAYS_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/exceptions/WOutOfMemoryBudget.h"
+#include "../../common/WLogger.h"
+#include "../../common/WMemoryBudget.h"
+#include "../../common/WMemoryReservation.h"
+#include "../WFiberDirectionArrays.h"
+
+/**
+ * Test the lazily computed tangents and direction colors of fibers.
+ */
+class WFiberDirectionArraysTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Starts the logger, which is used by the memory budget.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * Disables the memory budget after each test.
+     */
+    void tearDown()
+    {
+        WMemoryBudget::getMemoryBudget()->setBudget( 0 );
+    }
+
+    /**
+     * Nothing is computed before the first access.
+     */
+    void testLazy()
+    {
+        WFiberDirectionArrays::SPtr arrays = buildArrays( 1 );
+        TS_ASSERT( !arrays->isComputed() );
+        TS_ASSERT_EQUALS( arrays->getMemoryUsage(), 0 );
+
+        arrays->getLocalColors();
+        TS_ASSERT( arrays->isComputed() );
+        TS_ASSERT_EQUALS( arrays->getMemoryUsage(), 4 * 3 * 6 * sizeof( float ) );
+    }
+
+    /**
+     * The memory is reserved on construction, so only the construction fails for the budget and the first access
+     * does not, even if the budget is used up in between.
+     */
+    void testReservation()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        size_t const size = 4 * 18 * sizeof( float );
+
+        budget->setBudget( budget->getUsage() + size - 1 );
+        TS_ASSERT_THROWS( buildArrays( 1 ), WOutOfMemoryBudget );
+
+        budget->setBudget( budget->getUsage() + size );
+        WFiberDirectionArrays::SPtr arrays;
+        TS_ASSERT_THROWS_NOTHING( arrays = buildArrays( 1 ) );
+        TS_ASSERT_EQUALS( budget->getUsage(), budget->getBudget() );
+        TS_ASSERT_THROWS_NOTHING( arrays->getTangents() );
+        TS_ASSERT( arrays->isComputed() );
+
+        arrays.reset();
+        TS_ASSERT_EQUALS( budget->getUsage(), budget->getBudget() - size );
+    }
+
+    /**
+     * Arrays nobody else uses are evicted if the budget is exceeded, except for the custom colors. They are computed
+     * again on the next access.
+     */
+    void testEviction()
+    {
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        size_t const size = 18 * sizeof( float );
+
+        WFiberDirectionArrays::SPtr unused = buildArrays( 1 );
+        WFiberDirectionArrays::SPtr used = buildArrays( 1 );
+        ( *unused->getCustomColors() )[ 0 ] = 5.0f;
+        boost::shared_ptr< std::vector< float > > tangents = used->getTangents();
+
+        budget->setBudget( budget->getUsage() );
+        {
+            WMemoryReservation reservation( 3 * size, "test" );
+            TS_ASSERT( !unused->isComputed() );
+            TS_ASSERT( used->isComputed() );
+            TS_ASSERT_EQUALS( unused->getMemoryUsage(), size );
+            TS_ASSERT_THROWS( WMemoryReservation( 1, "test" ), WOutOfMemoryBudget );
+        }
+
+        TS_ASSERT_THROWS_NOTHING( unused->getLocalColors() );
+        TS_ASSERT( unused->isComputed() );
+        TS_ASSERT_EQUALS( ( *unused->getCustomColors() )[ 0 ], 5.0f );
+        TS_ASSERT_EQUALS( budget->getUsage(), budget->getBudget() );
+    }
+
+    /**
+     * The tangents, local and global colors of a fiber with an angle.
+     */
+    void testValues()
+    {
+        WFiberDirectionArrays::SPtr arrays = buildArrays( 1 );
+        std::vector< float > const& tangents = *arrays->getTangents();
+        std::vector< float > const& local = *arrays->getLocalColors();
+        std::vector< float > const& global = *arrays->getGlobalColors();
+        TS_ASSERT_EQUALS( tangents.size(), 18 );
+
+        // the first vertex uses the direction to the second one, the others the direction from the previous one
+        float const expectedTangents[] = { -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f }; // NOLINT
+        for( size_t i = 0; i < 9; ++i )
+        {
+            TS_ASSERT_DELTA( tangents[ i ], expectedTangents[ i ], 1e-6 );
+            TS_ASSERT_DELTA( local[ i ], std::abs( expectedTangents[ i ] ), 1e-6 );
+        }
+        for( size_t k = 0; k < 3; ++k )
+        {
+            TS_ASSERT_DELTA( global[ 3 * k + 0 ], 1.0 / std::sqrt( 2.0 ), 1e-6 );
+            TS_ASSERT_DELTA( global[ 3 * k + 1 ], 1.0 / std::sqrt( 2.0 ), 1e-6 );
+            TS_ASSERT_DELTA( global[ 3 * k + 2 ], 0.0, 1e-6 );
+        }
+
+        // the second fiber runs along z
+        for( size_t i = 9; i < 18; i += 3 )
+        {
+            TS_ASSERT_DELTA( tangents[ i + 2 ], -1.0, 1e-6 );
+            TS_ASSERT_DELTA( global[ i + 2 ], 1.0, 1e-6 );
+        }
+    }
+
+    /**
+     * The custom colors are a copy of the global colors.
+     */
+    void testCustomColors()
+    {
+        WFiberDirectionArrays::SPtr arrays = buildArrays( 1 );
+        TS_ASSERT( *arrays->getCustomColors() == *arrays->getGlobalColors() );
+        TS_ASSERT_DIFFERS( arrays->getCustomColors(), arrays->getGlobalColors() );
+    }
+
+    /**
+     * Fibers without vertices and with only one vertex do not break the computation.
+     */
+    void testDegenerateFibers()
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float >( 6, 1.0f ) );
+        ( *vertices )[ 3 ] = 2.0f;
+        boost::shared_ptr< std::vector< size_t > > starts( new std::vector< size_t >( 3, 0 ) );
+        boost::shared_ptr< std::vector< size_t > > lengths( new std::vector< size_t >( 3, 0 ) );
+        ( *starts )[ 2 ] = 1;
+        ( *lengths )[ 1 ] = 1;
+        ( *lengths )[ 2 ] = 1;
+
+        WFiberDirectionArrays::SPtr arrays( new WFiberDirectionArrays( vertices, starts, lengths, 2 ) );
+        std::vector< float > const& tangents = *arrays->getTangents();
+        for( size_t i = 0; i < 6; ++i )
+        {
+            TS_ASSERT_EQUALS( tangents[ i ], 0.0f );
+        }
+        TS_ASSERT_DELTA( ( *arrays->getGlobalColors() )[ 0 ], 0.0, 1e-6 );
+    }
+
+    /**
+     * The result does not depend on the number of threads.
+     */
+    void testThreads()
+    {
+        WFiberDirectionArrays::SPtr single = buildArrays( 1 );
+        WFiberDirectionArrays::SPtr multi = buildArrays( 3 );
+        TS_ASSERT( *single->getTangents() == *multi->getTangents() );
+        TS_ASSERT( *single->getLocalColors() == *multi->getLocalColors() );
+        TS_ASSERT( *single->getGlobalColors() == *multi->getGlobalColors() );
+    }
+
+private:
+    /**
+     * Creates the arrays for two fibers with three vertices each: ( 0, 0, 0 ), ( 1, 0, 0 ), ( 1, 1, 0 ) and
+     * ( 0, 0, 0 ), ( 0, 0, 1 ), ( 0, 0, 2 ).
+     *
+     * \param numThreads the number of threads
+     *
+     * \return the arrays, not computed yet
+     */
+    WFiberDirectionArrays::SPtr buildArrays( size_t numThreads )
+    {
+        float const v[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, // NOLINT
+                            0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 2.0f };
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float >( v, v + 18 ) );
+        boost::shared_ptr< std::vector< size_t > > starts( new std::vector< size_t >( 2, 0 ) );
+        boost::shared_ptr< std::vector< size_t > > lengths( new std::vector< size_t >( 2, 3 ) );
+        ( *starts )[ 1 ] = 3;
+        return WFiberDirectionArrays::SPtr( new WFiberDirectionArrays( vertices, starts, lengths, numThreads ) );
+    }
+};
+
+#endif  // WFIBERDIRECTIONARRAYS_TEST_H
@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERDISTANCEMATRIX_TEST_H
+#define WFIBERDISTANCEMATRIX_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/datastructures/WFiber.h"
+#include "../../common/WIOTools.h"
+#include "../../common/WLogger.h"
+#include "../io/WReaderMatrixSymVTK.h"
+#include "../WFiberDistanceMatrix.h"
+
+/**
+ * Test the fiber distance matrix.
+ */
+class WFiberDistanceMatrixTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Setup logger and the fibers.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+        buildFibers( 150 );
+    }
+
+    /**
+     * The distances are those of WFiber, with and without threshold.
+     */
+    void testSameAsWFiber()
+    {
+        WFiberDistanceMatrix dlt( m_fibers, WFiberDistanceMatrix::LARGER_THRESHOLDED, 0.0, std::numeric_limits< double >::infinity(), 0 );
+        WFiberDistanceMatrix dst( m_fibers, WFiberDistanceMatrix::SMALLER_THRESHOLDED, 2.0, std::numeric_limits< double >::infinity(), 0 );
+        TS_ASSERT_EQUALS( dlt.size(), 150 );
+        for( std::size_t i = 0; i < 150; i += 7 )
+        {
+            for( std::size_t j = 0; j < 150; j += 11 )
+            {
+                TS_ASSERT_DELTA( dlt.getDistance( i, j ), WFiber::distDLT( 0.0, m_lines[ i ], m_lines[ j ] ), 1e-3 );
+                TS_ASSERT_DELTA( dst.getDistance( i, j ), WFiber::distDST( 4.0, m_lines[ i ], m_lines[ j ] ), 1e-3 );
+            }
+        }
+    }
+
+    /**
+     * The fibers are resampled before the distances are computed.
+     */
+    void testResampling()
+    {
+        WFiberDistanceMatrix matrix( m_fibers, WFiberDistanceMatrix::LARGER_THRESHOLDED, 0.0, std::numeric_limits< double >::infinity(), 12 );
+        WFiber q = m_lines[ 3 ];
+        WFiber r = m_lines[ 40 ];
+        q.resampleByNumberOfPoints( 12 );
+        r.resampleByNumberOfPoints( 12 );
+        TS_ASSERT_DELTA( matrix.getDistance( 3, 40 ), WFiber::distDLT( 0.0, q, r ), 1e-3 );
+    }
+
+    /**
+     * The whole matrix is the same as the single distances, computed tile by tile on several threads.
+     */
+    void testCompute()
+    {
+        WFiberDistanceMatrix matrix( m_fibers, WFiberDistanceMatrix::LARGER_THRESHOLDED, 0.5, std::numeric_limits< double >::infinity(), 10, 3 );
+        WMatrixSym< float >::SPtr result = matrix.compute();
+        TS_ASSERT_EQUALS( result->size(), 150 );
+        for( std::size_t i = 0; i < 150; ++i )
+        {
+            for( std::size_t j = i + 1; j < 150; ++j )
+            {
+                TS_ASSERT_EQUALS( ( *result )( i, j ), matrix.getDistance( i, j ) );
+            }
+        }
+    }
+
+    /**
+     * Pairs farther apart than the maximal distance are infinite, all others are computed.
+     */
+    void testPruning()
+    {
+        double const maxDistance = 20.0;
+        WFiberDistanceMatrix matrix( m_fibers, WFiberDistanceMatrix::LARGER_THRESHOLDED, 0.0, maxDistance, 10 );
+        WMatrixSym< float >::SPtr result = matrix.compute();
+        std::size_t pruned = 0;
+        for( std::size_t i = 0; i < 150; ++i )
+        {
+            for( std::size_t j = i + 1; j < 150; ++j )
+            {
+                if( ( *result )( i, j ) == std::numeric_limits< float >::infinity() )
+                {
+                    ++pruned;
+                    TS_ASSERT_LESS_THAN( maxDistance, matrix.getDistance( i, j ) );
+                }
+                else
+                {
+                    TS_ASSERT_EQUALS( ( *result )( i, j ), matrix.getDistance( i, j ) );
+                }
+            }
+        }
+        TS_ASSERT_LESS_THAN( 0, pruned );
+    }
+
+    /**
+     * The written file can be read and has the same distances.
+     */
+    void testWrite()
+    {
+        WFiberDistanceMatrix matrix( m_fibers, WFiberDistanceMatrix::LARGER_THRESHOLDED, 0.0, std::numeric_limits< double >::infinity(), 8 );
+        boost::filesystem::path file = tempFilename();
+        matrix.write( file.string() );
+
+        boost::shared_ptr< std::vector< double > > table( new std::vector< double >() );
+        WReaderMatrixSymVTK( file.string() ).readTable( table );
+        boost::filesystem::remove( file );
+
+        // the dimension is stored as last element
+        WMatrixSym< float >::SPtr expected = matrix.compute();
+        TS_ASSERT_EQUALS( table->size(), expected->numElements() + 1 );
+        TS_ASSERT_EQUALS( table->back(), 150.0 );
+        for( std::size_t i = 0; i < std::min( table->size(), expected->numElements() ); ++i )
+        {
+            TS_ASSERT_EQUALS( ( *table )[ i ], expected->getData()[ i ] );
+        }
+    }
+
+private:
+    /**
+     * Creates helix shaped fibers spread over a large volume, with 5 to 24 vertices.
+     *
+     * \param numFibers the number of fibers
+     */
+    void buildFibers( std::size_t numFibers )
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< std::size_t > > starts( new std::vector< std::size_t > );
+        boost::shared_ptr< std::vector< std::size_t > > lengths( new std::vector< std::size_t > );
+        boost::shared_ptr< std::vector< std::size_t > > reverse( new std::vector< std::size_t > );
+        m_lines.clear();
+        for( std::size_t fidx = 0; fidx < numFibers; ++fidx )
+        {
+            std::size_t const length = 5 + ( fidx * 7 ) % 20;
+            starts->push_back( reverse->size() );
+            lengths->push_back( length );
+            WFiber line;
+            for( std::size_t k = 0; k < length; ++k )
+            {
+                double const t = 0.3 * k + fidx;
+                float const p[] = { static_cast< float >( ( fidx * 37 ) % 100 + 3.0 * std::cos( t ) ), // NOLINT
+                                    static_cast< float >( ( fidx * 53 ) % 100 + 3.0 * std::sin( t ) ),
+                                    static_cast< float >( ( fidx * 11 ) % 30 + 0.7 * k ) };
+                vertices->insert( vertices->end(), p, p + 3 );
+                reverse->push_back( fidx );
+                line.push_back( WPosition( p[ 0 ], p[ 1 ], p[ 2 ] ) );
+            }
+            m_lines.push_back( line );
+        }
+        m_fibers.reset( new WDataSetFibers( vertices, starts, lengths, reverse ) );
+    }
+
+    /**
+     * The fibers.
+     */
+    WDataSetFibers::SPtr m_fibers;
+
+    /**
+     * The same fibers as lines.
+     */
+    std::vector< WFiber > m_lines;
+};
+
+#endif  // WFIBERDISTANCEMATRIX_TEST_H
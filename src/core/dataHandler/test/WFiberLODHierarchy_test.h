@@ -0,0 +1,237 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WFIBERLODHIERARCHY_TEST_H
+#define WFIBERLODHIERARCHY_TEST_H
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/WLogger.h"
+#include "../../common/WMemoryBudget.h"
+#include "../../common/WMemoryReservation.h"
+#include "../WFiberLODHierarchy.h"
+
+/**
+ * Test the fiber level-of-detail hierarchy.
+ */
+class WFiberLODHierarchyTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Creates 60 straight fibers in one grid cell and 4 in another one, each with 9 vertices.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+
+        WDataSetFibers::VertexArray vertices( new std::vector< float >() );
+        WDataSetFibers::IndexArray starts( new std::vector< size_t >() );
+        WDataSetFibers::LengthArray lengths( new std::vector< size_t >() );
+        WDataSetFibers::IndexArray reverse( new std::vector< size_t >() );
+        WBoundingBox bb;
+        for( size_t fidx = 0; fidx < 64; ++fidx )
+        {
+            float const x = fidx < 60 ? 0.1f * fidx : 100.0f;
+            starts->push_back( vertices->size() / 3 );
+            lengths->push_back( 9 );
+            for( size_t k = 0; k < 9; ++k )
+            {
+                vertices->push_back( x );
+                vertices->push_back( 0.5f * k );
+                vertices->push_back( 0.0f );
+                reverse->push_back( fidx );
+                bb.expandBy( x, 0.5f * k, 0.0f );
+            }
+        }
+        m_fibers = WDataSetFibers::SPtr( new WDataSetFibers( vertices, starts, lengths, reverse, bb ) );
+    }
+
+    /**
+     * Every level keeps about every second fiber of each cell, so the sparse cell stays represented, and decimates the
+     * fibers.
+     */
+    void testLevels()
+    {
+        WFiberLODHierarchy hierarchy( m_fibers, 4 );
+        TS_ASSERT_EQUALS( hierarchy.getNumLevels(), 4 );
+        TS_ASSERT( hierarchy.isReady( 0 ) );
+        TS_ASSERT( !hierarchy.isReady( 1 ) );
+        TS_ASSERT_EQUALS( hierarchy.getFibers( 0 ), m_fibers );
+
+        hierarchy.build();
+
+        size_t const expectedFibers[] = { 64, 32, 16, 9 };
+        size_t const expectedLength[] = { 9, 5, 3, 2 };
+        for( size_t level = 1; level < 4; ++level )
+        {
+            TS_ASSERT( hierarchy.isReady( level ) );
+            WDataSetFibers::ConstSPtr fibers = hierarchy.getFibers( level );
+            TS_ASSERT_EQUALS( fibers->getLineLengths()->size(), expectedFibers[ level ] );
+            TS_ASSERT_EQUALS( fibers->getVertices()->size(), 3 * expectedFibers[ level ] * expectedLength[ level ] );
+            WDataSetFibers::IndexArray sources = hierarchy.getSourceFibers( level );
+            TS_ASSERT_EQUALS( sources->size(), expectedFibers[ level ] );
+            TS_ASSERT( std::find( sources->begin(), sources->end(), 60 ) != sources->end() );
+
+            // decimation keeps the end points
+            TS_ASSERT_DELTA( ( *fibers->getVertices() )[ 1 ], 0.0, 1e-5 );
+            TS_ASSERT_DELTA( ( *fibers->getVertices() )[ 3 * expectedLength[ level ] - 2 ], 4.0, 1e-5 );
+        }
+        TS_ASSERT( !hierarchy.getSourceFibers( 0 ) );
+    }
+
+    /**
+     * The levels are nested.
+     */
+    void testNested()
+    {
+        WFiberLODHierarchy hierarchy( m_fibers, 4 );
+        hierarchy.build();
+        for( size_t level = 2; level < 4; ++level )
+        {
+            WDataSetFibers::IndexArray coarse = hierarchy.getSourceFibers( level );
+            WDataSetFibers::IndexArray fine = hierarchy.getSourceFibers( level - 1 );
+            TS_ASSERT( std::includes( fine->begin(), fine->end(), coarse->begin(), coarse->end() ) );
+        }
+    }
+
+    /**
+     * The finest ready level within the budget is found.
+     */
+    void testFindLevel()
+    {
+        WFiberLODHierarchy hierarchy( m_fibers, 4 );
+        TS_ASSERT_EQUALS( hierarchy.findLevel( 10 ), 0 );
+
+        hierarchy.build();
+        TS_ASSERT_EQUALS( hierarchy.findLevel( 1000 ), 0 );
+        TS_ASSERT_EQUALS( hierarchy.findLevel( 200 ), 1 );
+        TS_ASSERT_EQUALS( hierarchy.findLevel( 48 ), 2 );
+        TS_ASSERT_EQUALS( hierarchy.findLevel( 10 ), 3 );
+    }
+
+    /**
+     * Colors are taken from the original vertex at the same relative position.
+     */
+    void testMapColors()
+    {
+        WFiberLODHierarchy hierarchy( m_fibers, 4 );
+        hierarchy.build();
+
+        WDataSetFibers::ColorArray colors( new std::vector< float >( m_fibers->getVertices()->size() / 3 ) );
+        for( size_t v = 0; v < colors->size(); ++v )
+        {
+            ( *colors )[ v ] = static_cast< float >( v );
+        }
+
+        WDataSetFibers::ColorArray mapped = hierarchy.mapColors( 2, colors, 1 );
+        TS_ASSERT_EQUALS( mapped->size(), 16 * 3 );
+        // the first fiber of level 2 is fiber 0 and its vertices are 0, 4 and 8
+        TS_ASSERT_EQUALS( ( *mapped )[ 0 ], 0.0f );
+        TS_ASSERT_EQUALS( ( *mapped )[ 1 ], 4.0f );
+        TS_ASSERT_EQUALS( ( *mapped )[ 2 ], 8.0f );
+        // the last one is fiber 60
+        TS_ASSERT_EQUALS( ( *mapped )[ 45 ], 540.0f );
+        TS_ASSERT_EQUALS( ( *mapped )[ 47 ], 548.0f );
+    }
+
+    /**
+     * The levels nobody else uses are evicted if the memory budget is exceeded and built again by build().
+     */
+    void testEviction()
+    {
+        WFiberLODHierarchy hierarchy( m_fibers, 4 );
+        hierarchy.build();
+        WDataSetFibers::ConstSPtr used = hierarchy.getFibers( 2 );
+
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        budget->setBudget( budget->getUsage() + 1 );
+        WMemoryReservation( 2, "test", false );
+        budget->setBudget( 0 );
+
+        TS_ASSERT( hierarchy.isReady( 0 ) );
+        TS_ASSERT( !hierarchy.isReady( 1 ) );
+        TS_ASSERT( hierarchy.isReady( 2 ) );
+        TS_ASSERT( !hierarchy.isReady( 3 ) );
+        TS_ASSERT_EQUALS( hierarchy.findLevel( 10 ), 2 );
+
+        hierarchy.build();
+        TS_ASSERT( hierarchy.isReady( 1 ) );
+        TS_ASSERT( hierarchy.isReady( 3 ) );
+        TS_ASSERT_EQUALS( hierarchy.getFibers( 2 ), used );
+    }
+
+    /**
+     * There is one shared hierarchy per dataset and it gets built in the background.
+     */
+    void testGetHierarchy()
+    {
+        WFiberLODHierarchy::SPtr hierarchy = WFiberLODHierarchy::getHierarchy( m_fibers );
+        TS_ASSERT_EQUALS( hierarchy, WFiberLODHierarchy::getHierarchy( m_fibers ) );
+
+        for( size_t i = 0; i < 500 && !hierarchy->isReady( 1 ); ++i )
+        {
+            boost::this_thread::sleep( boost::posix_time::milliseconds( 10 ) );
+        }
+        TS_ASSERT( hierarchy->isReady( 1 ) );
+    }
+
+    /**
+     * Dropping a hierarchy stops its background build and releases the dataset.
+     */
+    void testStopBuild()
+    {
+        WFiberLODHierarchy::SPtr hierarchy( new WFiberLODHierarchy( m_fibers, 6, 8.0, &WFiberLODHierarchyTest::slowDecimation ) );
+        hierarchy->startBuild();
+        boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+
+        boost::posix_time::ptime const start = boost::posix_time::microsec_clock::universal_time();
+        hierarchy.reset();
+        TS_ASSERT_LESS_THAN( ( boost::posix_time::microsec_clock::universal_time() - start ).total_milliseconds(), 500 );
+        TS_ASSERT_EQUALS( m_fibers.use_count(), 1 );
+    }
+
+private:
+    /**
+     * A decimation taking 10ms per fiber, so building all levels takes seconds.
+     *
+     * \param fiber the fiber
+     * \param maxPoints the maximum number of vertices
+     */
+    static void slowDecimation( WFiber* fiber, std::size_t maxPoints )
+    {
+        boost::this_thread::sleep( boost::posix_time::milliseconds( 10 ) );
+        WFiberLODHierarchy::resampleByMaxPoints( fiber, maxPoints );
+    }
+
+    /**
+     * The fibers.
+     */
+    WDataSetFibers::SPtr m_fibers;
+};
+
+#endif  // WFIBERLODHIERARCHY_TEST_H
@@ -0,0 +1,308 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WFIBERSEGMENTINDEX_TEST_H
+#define WFIBERSEGMENTINDEX_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/WLogger.h"
+#include "../../common/WMemoryBudget.h"
+#include "../../common/WMemoryReservation.h"
+#include "../WFiberSegmentIndex.h"
+
+/**
+ * Test the fiber segment index.
+ */
+class WFiberSegmentIndexTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Setup the fibers.
+     */
+    void setUp()
+    {
+        buildFibers( 200 );
+    }
+
+    /**
+     * The index is only built by the first query.
+     */
+    void testLazyBuild()
+    {
+        WFiberSegmentIndex index( m_vertices, m_starts, m_lengths, m_reverse );
+        TS_ASSERT( !index.isBuilt() );
+        TS_ASSERT_EQUALS( index.getMemoryUsage(), 0 );
+        index.getFibersNearPoint( WPosition( 50.0, 50.0, 10.0 ), 5.0 );
+        TS_ASSERT( index.isBuilt() );
+        TS_ASSERT_LESS_THAN( 0, index.getMemoryUsage() );
+        TS_ASSERT_LESS_THAN( 0.0, index.getCellSize() );
+    }
+
+    /**
+     * The grid is evicted if the memory budget is exceeded and built again by the next query.
+     */
+    void testEviction()
+    {
+        WLogger::startup();
+        WMemoryBudget::SPtr budget = WMemoryBudget::getMemoryBudget();
+        WFiberSegmentIndex index( m_vertices, m_starts, m_lengths, m_reverse );
+        std::vector< size_t > const expected = index.getFibersNearPoint( WPosition( 50.0, 50.0, 10.0 ), 5.0 );
+        size_t const usage = budget->getUsage();
+
+        budget->setBudget( usage );
+        TS_ASSERT_THROWS_NOTHING( WMemoryReservation( 1, "test" ) );
+        TS_ASSERT( !index.isBuilt() );
+        TS_ASSERT_EQUALS( index.getMemoryUsage(), 0 );
+        TS_ASSERT_LESS_THAN( budget->getUsage(), usage );
+
+        TS_ASSERT( index.getFibersNearPoint( WPosition( 50.0, 50.0, 10.0 ), 5.0 ) == expected );
+        TS_ASSERT( index.isBuilt() );
+        TS_ASSERT_EQUALS( budget->getUsage(), usage );
+        budget->setBudget( 0 );
+    }
+
+    /**
+     * Box queries find the same fibers as testing all segments.
+     */
+    void testBox()
+    {
+        WFiberSegmentIndex automatic( m_vertices, m_starts, m_lengths, m_reverse );
+        WFiberSegmentIndex coarse( m_vertices, m_starts, m_lengths, m_reverse, 40.0 );
+        for( size_t i = 0; i < 40; ++i )
+        {
+            WPosition const corner( ( i * 37 ) % 110 - 5.0, ( i * 23 ) % 110 - 5.0, ( i * 7 ) % 50 - 5.0 );
+            WPosition const size( 5.0 + i % 15, 5.0 + ( i * 3 ) % 20, 0.5 * i );
+            WBoundingBox const box( corner, corner + size );
+
+            std::vector< size_t > expected;
+            for( size_t fidx = 0; fidx < m_lines.size(); ++fidx )
+            {
+                for( size_t k = 0; k < m_lines[ fidx ].size(); ++k )
+                {
+                    WPosition const& a = m_lines[ fidx ][ k ];
+                    WPosition const& b = m_lines[ fidx ][ std::min( k + 1, m_lines[ fidx ].size() - 1 ) ];
+                    if( segmentInBox( a, b, box ) )
+                    {
+                        expected.push_back( fidx );
+                        break;
+                    }
+                }
+            }
+            TS_ASSERT( automatic.getFibersInBox( box ) == expected );
+            TS_ASSERT( coarse.getFibersInBox( box ) == expected );
+        }
+    }
+
+    /**
+     * Point queries find the same fibers as testing all segments.
+     */
+    void testNearPoint()
+    {
+        WFiberSegmentIndex index( m_vertices, m_starts, m_lengths, m_reverse );
+        for( size_t i = 0; i < 40; ++i )
+        {
+            WPosition const point( ( i * 41 ) % 100, ( i * 17 ) % 100, ( i * 3 ) % 40 );
+            double const radius = 2.0 + 0.7 * ( i % 10 );
+
+            std::vector< size_t > expected;
+            for( size_t fidx = 0; fidx < m_lines.size(); ++fidx )
+            {
+                for( size_t k = 0; k < m_lines[ fidx ].size(); ++k )
+                {
+                    WPosition const& a = m_lines[ fidx ][ k ];
+                    WPosition const& b = m_lines[ fidx ][ std::min( k + 1, m_lines[ fidx ].size() - 1 ) ];
+                    if( distance( a, b, point ) <= radius )
+                    {
+                        expected.push_back( fidx );
+                        break;
+                    }
+                }
+            }
+            TS_ASSERT( index.getFibersNearPoint( point, radius ) == expected );
+        }
+    }
+
+    /**
+     * Plane queries find the fibers having vertices on both sides of the plane.
+     */
+    void testPlane()
+    {
+        WFiberSegmentIndex index( m_vertices, m_starts, m_lengths, m_reverse );
+        for( size_t i = 0; i < 20; ++i )
+        {
+            WPosition const point( ( i * 41 ) % 100, ( i * 17 ) % 100, ( i * 3 ) % 40 );
+            WVector3d const normal( std::cos( 0.7 * i ), std::sin( 0.7 * i ), 0.3 * ( i % 5 ) - 0.6 );
+
+            std::vector< size_t > expected;
+            for( size_t fidx = 0; fidx < m_lines.size(); ++fidx )
+            {
+                bool below = false;
+                bool above = false;
+                for( size_t k = 0; k < m_lines[ fidx ].size(); ++k )
+                {
+                    double const side = dot( normal, m_lines[ fidx ][ k ] - point );
+                    below = below || side <= 0.0;
+                    above = above || side >= 0.0;
+                }
+                if( below && above )
+                {
+                    expected.push_back( fidx );
+                }
+            }
+            TS_ASSERT( index.getFibersOnPlane( point, normal ) == expected );
+        }
+    }
+
+    /**
+     * Fibers with a single vertex are found, empty datasets have no fibers.
+     */
+    void testSingleVertexAndEmpty()
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float >( 3, 2.0f ) );
+        boost::shared_ptr< std::vector< size_t > > starts( new std::vector< size_t >( 1, 0 ) );
+        boost::shared_ptr< std::vector< size_t > > lengths( new std::vector< size_t >( 1, 1 ) );
+        boost::shared_ptr< std::vector< size_t > > reverse( new std::vector< size_t >( 1, 0 ) );
+        WFiberSegmentIndex single( vertices, starts, lengths, reverse );
+        TS_ASSERT_EQUALS( single.getFibersNearPoint( WPosition( 2.0, 2.0, 2.5 ), 1.0 ).size(), 1 );
+        TS_ASSERT_EQUALS( single.getFibersNearPoint( WPosition( 2.0, 2.0, 3.5 ), 1.0 ).size(), 0 );
+        TS_ASSERT_EQUALS( single.getFibersInBox( WBoundingBox( 1.0, 1.0, 1.0, 3.0, 3.0, 3.0 ) ).size(), 1 );
+
+        boost::shared_ptr< std::vector< float > > noVertices( new std::vector< float >() );
+        boost::shared_ptr< std::vector< size_t > > noFibers( new std::vector< size_t >() );
+        WFiberSegmentIndex empty( noVertices, noFibers, noFibers, noFibers );
+        TS_ASSERT_EQUALS( empty.getFibersInBox( WBoundingBox( 1.0, 1.0, 1.0, 3.0, 3.0, 3.0 ) ).size(), 0 );
+        TS_ASSERT_EQUALS( empty.getFibersOnPlane( WPosition(), WVector3d( 0.0, 0.0, 1.0 ) ).size(), 0 );
+    }
+
+private:
+    /**
+     * Whether a segment intersects a box, tested by sampling the segment densely.
+     *
+     * \param a the first end point
+     * \param b the second end point
+     * \param box the box
+     *
+     * \return true if a sample is inside the box
+     */
+    bool segmentInBox( WPosition const& a, WPosition const& b, WBoundingBox const& box ) const
+    {
+        for( size_t s = 0; s <= 1000; ++s )
+        {
+            WPosition const p = a + ( s / 1000.0 ) * ( b - a );
+            bool inside = true;
+            for( size_t c = 0; c < 3; ++c )
+            {
+                inside = inside && p[ c ] >= box.getMin()[ c ] && p[ c ] <= box.getMax()[ c ];
+            }
+            if( inside )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * The distance of a point to a segment.
+     *
+     * \param a the first end point
+     * \param b the second end point
+     * \param p the point
+     *
+     * \return the distance
+     */
+    double distance( WPosition const& a, WPosition const& b, WPosition const& p ) const
+    {
+        WVector3d const d = b - a;
+        double t = dot( d, d ) > 0.0 ? dot( p - a, d ) / dot( d, d ) : 0.0;
+        t = std::min( 1.0, std::max( 0.0, t ) );
+        return length( a + t * d - p );
+    }
+
+    /**
+     * Creates helix shaped fibers spread over a volume, with 1 to 20 vertices.
+     *
+     * \param numFibers the number of fibers
+     */
+    void buildFibers( size_t numFibers )
+    {
+        m_vertices.reset( new std::vector< float > );
+        m_starts.reset( new std::vector< size_t > );
+        m_lengths.reset( new std::vector< size_t > );
+        m_reverse.reset( new std::vector< size_t > );
+        m_lines.clear();
+        for( size_t fidx = 0; fidx < numFibers; ++fidx )
+        {
+            size_t const length = 1 + ( fidx * 7 ) % 20;
+            m_starts->push_back( m_reverse->size() );
+            m_lengths->push_back( length );
+            m_lines.push_back( std::vector< WPosition >() );
+            for( size_t k = 0; k < length; ++k )
+            {
+                double const t = 0.3 * k + fidx;
+                float const p[] = { static_cast< float >( ( fidx * 37 ) % 100 + 3.0 * std::cos( t ) ), // NOLINT
+                                    static_cast< float >( ( fidx * 53 ) % 100 + 3.0 * std::sin( t ) ),
+                                    static_cast< float >( ( fidx * 11 ) % 30 + 0.7 * k ) };
+                m_vertices->insert( m_vertices->end(), p, p + 3 );
+                m_reverse->push_back( fidx );
+                m_lines.back().push_back( WPosition( p[ 0 ], p[ 1 ], p[ 2 ] ) );
+            }
+        }
+    }
+
+    /**
+     * The vertices.
+     */
+    boost::shared_ptr< std::vector< float > > m_vertices;
+
+    /**
+     * The start of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > > m_starts;
+
+    /**
+     * The length of each fiber.
+     */
+    boost::shared_ptr< std::vector< size_t > > m_lengths;
+
+    /**
+     * The fiber of each vertex.
+     */
+    boost::shared_ptr< std::vector< size_t > > m_reverse;
+
+    /**
+     * The same fibers as point lists.
+     */
+    std::vector< std::vector< WPosition > > m_lines;
+};
+
+#endif  // WFIBERSEGMENTINDEX_TEST_H
@@ -0,0 +1,231 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WFLATFIBERVECTOR_TEST_H
+#define WFLATFIBERVECTOR_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/math/WLine.h"
+#include "../WFlatFiberVector.h"
+
+/**
+ * Tests the fibers stored in a single array.
+ */
+class WFlatFiberVectorTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Added fibers are stored one after another and are accessed by views.
+     */
+    void testPushBack()
+    {
+        WFlatFiberVector fibers;
+        TS_ASSERT( fibers.empty() );
+        fibers.reserve( 3, 5 );
+        fibers.push_back( buildLine( 3, 0.0 ) );
+        fibers.push_back( WLine() );
+        fibers.push_back( buildLine( 2, 1.0 ) );
+
+        TS_ASSERT_EQUALS( fibers.size(), 3 );
+        TS_ASSERT_EQUALS( fibers.getNumPoints(), 5 );
+        TS_ASSERT_EQUALS( fibers[ 0 ].size(), 3 );
+        TS_ASSERT( fibers[ 1 ].empty() );
+        TS_ASSERT_EQUALS( fibers[ 2 ].size(), 2 );
+        TS_ASSERT_EQUALS( fibers[ 0 ][ 2 ], WPosition( 2.0, 0.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 2 ].front(), WPosition( 0.0, 1.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 2 ].back(), WPosition( 1.0, 1.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 2 ].end() - fibers[ 0 ].begin(), 5 );
+    }
+
+    /**
+     * Reversing a fiber does not touch the others.
+     */
+    void testReverse()
+    {
+        WFlatFiberVector fibers;
+        fibers.push_back( buildLine( 2, 0.0 ) );
+        fibers.push_back( buildLine( 3, 1.0 ) );
+        fibers.push_back( buildLine( 2, 2.0 ) );
+        fibers.reverse( 1 );
+
+        TS_ASSERT_EQUALS( fibers[ 0 ].front(), WPosition( 0.0, 0.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 1 ][ 0 ], WPosition( 2.0, 1.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 1 ][ 1 ], WPosition( 1.0, 1.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 1 ][ 2 ], WPosition( 0.0, 1.0, 0.0 ) );
+        TS_ASSERT_EQUALS( fibers[ 2 ].front(), WPosition( 0.0, 2.0, 0.0 ) );
+    }
+
+    /**
+     * Resampling gives the same points as resampling every fiber as WLine. Empty fibers stay empty.
+     */
+    void testResampleLikeWLine()
+    {
+        std::vector< WLine > lines;
+        lines.push_back( buildCurve( 17, 0.3 ) );
+        lines.push_back( buildCurve( 4, 1.7 ) );
+        lines.push_back( buildLine( 1, 2.0 ) );
+        lines.push_back( WLine() );
+        lines.push_back( buildCurve( 10, 0.9 ) );
+
+        WFlatFiberVector fibers;
+        for( size_t i = 0; i < lines.size(); ++i )
+        {
+            fibers.push_back( lines[ i ] );
+        }
+        WFlatFiberVector::SPtr resampled = fibers.resampleByNumberOfPoints( 10 );
+
+        TS_ASSERT_EQUALS( resampled->size(), lines.size() );
+        TS_ASSERT_EQUALS( resampled->getNumPoints(), 40 );
+        TS_ASSERT( ( *resampled )[ 3 ].empty() );
+        for( size_t i = 0; i < lines.size(); ++i )
+        {
+            lines[ i ].resampleByNumberOfPoints( 10 );
+            TS_ASSERT_EQUALS( ( *resampled )[ i ].size(), lines[ i ].size() );
+            for( size_t k = 0; k < lines[ i ].size(); ++k )
+            {
+                TS_ASSERT_DELTA( length( ( *resampled )[ i ][ k ] - lines[ i ][ k ] ), 0.0, 1e-12 );
+            }
+        }
+    }
+
+    /**
+     * Converting a dataset in parallel and back gives the original arrays.
+     */
+    void testDataSetConversion()
+    {
+        WDataSetFibers::SPtr dataSet = buildDataSet( 2000, 40 );
+        WFlatFiberVector serial( *dataSet, 1 );
+        WFlatFiberVector parallel( *dataSet, 4 );
+        TS_ASSERT_EQUALS( parallel.size(), 2000 );
+        TS_ASSERT_EQUALS( parallel.getNumPoints(), 80000 );
+        TS_ASSERT_EQUALS( parallel[ 1999 ].back(), serial[ 1999 ].back() );
+
+        std::vector< float > const& vertices = *dataSet->getVertices();
+        TS_ASSERT_EQUALS( parallel[ 3 ][ 5 ], WPosition( vertices[ 3 * 125 ], vertices[ 3 * 125 + 1 ], vertices[ 3 * 125 + 2 ] ) );
+
+        WDataSetFibers::SPtr converted = parallel.toWDataSetFibers( 3 );
+        TS_ASSERT( *converted->getVertices() == vertices );
+        TS_ASSERT( *converted->getLineStartIndexes() == *dataSet->getLineStartIndexes() );
+        TS_ASSERT( *converted->getLineLengths() == *dataSet->getLineLengths() );
+        TS_ASSERT( *converted->getVerticesReverse() == *dataSet->getVerticesReverse() );
+    }
+
+    /**
+     * Resampling in parallel gives the same points as on a single thread.
+     */
+    void testParallelResampling()
+    {
+        WFlatFiberVector fibers( *buildDataSet( 2000, 40 ) );
+        WFlatFiberVector::SPtr serial = fibers.resampleByNumberOfPoints( 25, 1 );
+        WFlatFiberVector::SPtr parallel = fibers.resampleByNumberOfPoints( 25, 5 );
+        TS_ASSERT_EQUALS( parallel->getNumPoints(), 2000 * 25 );
+
+        size_t differences = 0;
+        for( size_t i = 0; i < fibers.size(); ++i )
+        {
+            for( size_t k = 0; k < 25; ++k )
+            {
+                differences += ( *serial )[ i ][ k ] != ( *parallel )[ i ][ k ];
+            }
+        }
+        TS_ASSERT_EQUALS( differences, 0 );
+    }
+
+private:
+    /**
+     * A straight line along x.
+     *
+     * \param numPoints the number of points
+     * \param y the y coordinate of all points
+     *
+     * \return the line
+     */
+    WLine buildLine( size_t numPoints, double y ) const
+    {
+        WLine line;
+        for( size_t i = 0; i < numPoints; ++i )
+        {
+            line.push_back( WPosition( static_cast< double >( i ), y, 0.0 ) );
+        }
+        return line;
+    }
+
+    /**
+     * A helix with unevenly spaced points.
+     *
+     * \param numPoints the number of points
+     * \param phase the start angle
+     *
+     * \return the line
+     */
+    WLine buildCurve( size_t numPoints, double phase ) const
+    {
+        WLine line;
+        for( size_t i = 0; i < numPoints; ++i )
+        {
+            double const t = phase + 0.4 * i + 0.05 * i * i;
+            line.push_back( WPosition( std::cos( t ), std::sin( t ), 0.3 * t ) );
+        }
+        return line;
+    }
+
+    /**
+     * A dataset of helices.
+     *
+     * \param numFibers the number of fibers
+     * \param numPoints the number of points of every fiber
+     *
+     * \return the dataset
+     */
+    WDataSetFibers::SPtr buildDataSet( size_t numFibers, size_t numPoints ) const
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< size_t > > starts( new std::vector< size_t > );
+        boost::shared_ptr< std::vector< size_t > > lengths( new std::vector< size_t > );
+        boost::shared_ptr< std::vector< size_t > > verticesReverse( new std::vector< size_t > );
+        for( size_t i = 0; i < numFibers; ++i )
+        {
+            starts->push_back( i * numPoints );
+            lengths->push_back( numPoints );
+            WLine const curve = buildCurve( numPoints, 0.01 * i );
+            for( size_t k = 0; k < numPoints; ++k )
+            {
+                vertices->push_back( curve[ k ][ 0 ] );
+                vertices->push_back( curve[ k ][ 1 ] );
+                vertices->push_back( curve[ k ][ 2 ] );
+                verticesReverse->push_back( i );
+            }
+        }
+        return WDataSetFibers::SPtr( new WDataSetFibers( vertices, starts, lengths, verticesReverse ) );
+    }
+};
+
+#endif  // WFLATFIBERVECTOR_TEST_H
@@ -0,0 +1,222 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDPROBABILISTICTRACKINGFUNCTION_TEST_H
+#define WTHREADEDPROBABILISTICTRACKINGFUNCTION_TEST_H
+
+#include <vector>
+
+#include <boost/random/uniform_on_sphere.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/exceptions/WPreconditionNotMet.h"
+#include "../../common/WConditionOneShot.h"
+#include "../../common/WLogger.h"
+#include "../../common/WThreadedFunction.h"
+#include "../WThreadedProbabilisticTrackingFunction.h"
+
+/**
+ * \class WThreadedProbabilisticTrackingFunctionTest
+ *
+ * Test the probabilistic tracking.
+ */
+class WThreadedProbabilisticTrackingFunctionTest : public CxxTest::TestSuite
+{
+    //! the tested type
+    typedef wtracking::WThreadedProbabilisticTrackingFunction TrackingType;
+
+public:
+    /**
+     * Setup logger and other stuff for each test.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * Invalid parameters should be rejected.
+     */
+    void testInstantiation()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( 5 );
+
+        TS_ASSERT_THROWS_NOTHING( TrackingType( ds, &This::xDirection, 10 ) );
+        TS_ASSERT_THROWS( TrackingType( ds, &This::xDirection, 0 ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( TrackingType( ds, TrackingType::SampleDirFunc(), 10 ), WPreconditionNotMet );
+    }
+
+    /**
+     * A sampling function without randomness yields the same streamline for every sample, so every voxel on it
+     * is visited exactly once per sample.
+     */
+    void testSingleSeed()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( 5 );
+        boost::shared_ptr< WGridRegular3D > g = boost::dynamic_pointer_cast< WGridRegular3D >( ds->getGrid() );
+
+        std::vector< int > v0( 3, 2 );
+        std::vector< int > v1( 3, 3 );
+        TrackingType t( ds, &This::xDirection, 50, 1, v0, v1 );
+
+        WBoolFlag shutdown( new WConditionOneShot(), false );
+        t( 0, 1, shutdown );
+
+        boost::shared_ptr< std::vector< TrackingType::CountType > > counts = t.getVisitCounts();
+        TS_ASSERT_EQUALS( counts->size(), g->size() );
+        for( std::size_t i = 0; i < counts->size(); ++i )
+        {
+            bool onLine = i / 5 == 2 * 5 + 2;
+            TS_ASSERT_EQUALS( ( *counts )[ i ], onLine ? 50u : 0u );
+        }
+    }
+
+    /**
+     * Threads must not lose or duplicate seeds, and their counts must be merged.
+     */
+    void testMultipleThreads()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( 5 );
+        boost::shared_ptr< TrackingType > t( new TrackingType( ds, &This::xDirection, 20 ) );
+
+        WThreadedFunction< TrackingType > f( 4, t );
+        f.run();
+        f.wait();
+        TS_ASSERT_EQUALS( f.status(), W_THREADS_FINISHED );
+
+        // the 3 seeds on every x-line of the inner voxels pass through all voxels of that line
+        boost::shared_ptr< std::vector< TrackingType::CountType > > counts = t->getVisitCounts();
+        for( std::size_t i = 0; i < counts->size(); ++i )
+        {
+            std::size_t y = ( i / 5 ) % 5;
+            std::size_t z = i / 25;
+            bool inner = y >= 1 && y <= 3 && z >= 1 && z <= 3;
+            TS_ASSERT_EQUALS( ( *counts )[ i ], inner ? 60u : 0u );
+        }
+    }
+
+    /**
+     * The same random seed yields the same result, different seeds yield different results.
+     */
+    void testRandomStreams()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( 9 );
+        WBoolFlag shutdown( new WConditionOneShot(), false );
+
+        std::vector< int > v0( 3, 4 );
+        std::vector< int > v1( 3, 5 );
+        TrackingType t0( ds, &This::randomDirection, 200, 1, v0, v1, 7 );
+        TrackingType t1( ds, &This::randomDirection, 200, 1, v0, v1, 7 );
+        TrackingType t2( ds, &This::randomDirection, 200, 1, v0, v1, 8 );
+        t0( 0, 1, shutdown );
+        t1( 0, 1, shutdown );
+        t2( 0, 1, shutdown );
+
+        boost::shared_ptr< std::vector< TrackingType::CountType > > c0 = t0.getVisitCounts();
+        boost::shared_ptr< std::vector< TrackingType::CountType > > c1 = t1.getVisitCounts();
+        boost::shared_ptr< std::vector< TrackingType::CountType > > c2 = t2.getVisitCounts();
+        TS_ASSERT( *c0 == *c1 );
+        TS_ASSERT( *c0 != *c2 );
+
+        // every streamline visits its seed voxel, and the walks spread out
+        TS_ASSERT_EQUALS( ( *c0 )[ 4 * 81 + 4 * 9 + 4 ], 200u );
+        std::size_t visited = 0;
+        for( std::size_t i = 0; i < c0->size(); ++i )
+        {
+            TS_ASSERT( ( *c0 )[ i ] <= 200u );
+            visited += ( *c0 )[ i ] > 0;
+        }
+        TS_ASSERT( visited > 27 );
+    }
+
+    /**
+     * The result does not depend on the number of threads.
+     */
+    void testReproducibleWithThreads()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( 9 );
+        WBoolFlag shutdown( new WConditionOneShot(), false );
+
+        TrackingType single( ds, &This::randomDirection, 30, 1, std::vector< int >(), std::vector< int >(), 3 );
+        single( 0, 1, shutdown );
+
+        boost::shared_ptr< TrackingType > multi( new TrackingType( ds, &This::randomDirection, 30, 1, std::vector< int >(),
+                                                                   std::vector< int >(), 3 ) );
+        WThreadedFunction< TrackingType > f( 4, multi );
+        f.run();
+        f.wait();
+        TS_ASSERT_EQUALS( f.status(), W_THREADS_FINISHED );
+        TS_ASSERT( *single.getVisitCounts() == *multi->getVisitCounts() );
+    }
+
+private:
+    //! an abbreviation
+    typedef WThreadedProbabilisticTrackingFunctionTest This;
+
+    /**
+     * Build a dataset with a unit grid of n^3 voxels.
+     *
+     * \param n The number of voxels in every direction.
+     *
+     * \return The dataset.
+     */
+    boost::shared_ptr< WDataSetSingle > buildTestData( int n )
+    {
+        boost::shared_ptr< WGrid > g( new WGridRegular3D( n, n, n ) );
+        boost::shared_ptr< std::vector< double > > v( new std::vector< double >( n * n * n, 1.0 ) );
+        boost::shared_ptr< WValueSetBase > vs( new WValueSet< double >( 0, 1, v, W_DT_DOUBLE ) );
+        return boost::shared_ptr< WDataSetSingle >( new WDataSetSingle( vs, g ) );
+    }
+
+    /**
+     * A direction function that always returns the x-axis, pointing into the hemisphere of the previous direction.
+     *
+     * \param job The current position and the previous direction.
+     *
+     * \return The next direction.
+     */
+    static WVector3d xDirection( TrackingType::DataSetPtr, TrackingType::JobType const& job, TrackingType::RandomEngine& )
+    {
+        return WVector3d( job.second[ 0 ] < 0.0 ? -1.0 : 1.0, 0.0, 0.0 );
+    }
+
+    /**
+     * A direction function that returns uniformly distributed directions, flipped into the hemisphere of the
+     * previous direction.
+     *
+     * \param job The current position and the previous direction.
+     * \param rng The random number generator.
+     *
+     * \return The next direction.
+     */
+    static WVector3d randomDirection( TrackingType::DataSetPtr, TrackingType::JobType const& job, TrackingType::RandomEngine& rng )
+    {
+        boost::random::uniform_on_sphere< double > sphere( 3 );
+        std::vector< double > d = sphere( rng );
+        WVector3d dir( d[ 0 ], d[ 1 ], d[ 2 ] );
+        return normalize( dot( dir, job.second ) < 0.0 ? dir * -1.0 : dir );
+    }
+};
+
+#endif  // WTHREADEDPROBABILISTICTRACKINGFUNCTION_TEST_H
@@ -0,0 +1,265 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADEDSCALARMAPS_TEST_H
+#define WTHREADEDSCALARMAPS_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/random.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/exceptions/WPreconditionNotMet.h"
+#include "../../common/math/WGeometryFunctions.h"
+#include "../../common/math/WSymmetricSphericalHarmonic.h"
+#include "../../common/WConditionOneShot.h"
+#include "../../common/WThreadedFunction.h"
+#include "../WThreadedScalarMaps.h"
+
+/**
+ * Test the fused scalar map computation.
+ */
+class WThreadedScalarMapsTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Missing inputs and invalid measures should be rejected.
+     */
+    void testPreconditions()
+    {
+        boost::shared_ptr< WDataSetSingle > tensors = buildTensors( 3 );
+        boost::shared_ptr< WDataSetSphericalHarmonics > sh = buildSH( 3, 15 );
+        boost::shared_ptr< WDataSetSingle > none;
+
+        TS_ASSERT_THROWS( WThreadedScalarMaps m( 0, tensors ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( WThreadedScalarMaps m( WThreadedScalarMaps::FA, none ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( WThreadedScalarMaps m( WThreadedScalarMaps::GFA, tensors ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( WThreadedScalarMaps m( WThreadedScalarMaps::FA | WThreadedScalarMaps::GFA, tensors, buildSH( 2, 15 ) ),
+                          WPreconditionNotMet );
+        TS_ASSERT_THROWS( WThreadedScalarMaps m( WThreadedScalarMaps::GFA, none, buildSH( 3, 14 ) ), WPreconditionNotMet );
+        TS_ASSERT_THROWS_NOTHING( WThreadedScalarMaps m( WThreadedScalarMaps::GFA, none, sh ) );
+
+        WThreadedScalarMaps maps( WThreadedScalarMaps::FA | WThreadedScalarMaps::MD, tensors );
+        TS_ASSERT_EQUALS( maps.getMeasures(), static_cast< unsigned int >( WThreadedScalarMaps::FA | WThreadedScalarMaps::MD ) );
+        TS_ASSERT_THROWS( maps.getResult( WThreadedScalarMaps::AD ), WPreconditionNotMet );
+        TS_ASSERT_EQUALS( WThreadedScalarMaps::getName( WThreadedScalarMaps::MODE ), "Mode" );
+    }
+
+    /**
+     * The tensor measures of known tensors.
+     */
+    void testTensorMeasures()
+    {
+        boost::shared_ptr< WDataSetSingle > tensors = buildTensors( 2 );
+        boost::shared_ptr< WValueSet< double > > vs = boost::dynamic_pointer_cast< WValueSet< double > >( tensors->getValueSet() );
+        double* data = const_cast< double* >( vs->rawData() );
+        // a linear tensor diag( 3, 1, 1 ), a planar tensor diag( 2, 2, 1 ) and a zero tensor
+        setTensor( data, 0, 3.0, 1.0, 1.0 );
+        setTensor( data, 1, 2.0, 2.0, 1.0 );
+        setTensor( data, 2, 0.0, 0.0, 0.0 );
+
+        unsigned int const all = WThreadedScalarMaps::FA | WThreadedScalarMaps::MD | WThreadedScalarMaps::RD
+                                 | WThreadedScalarMaps::AD | WThreadedScalarMaps::MODE;
+        boost::shared_ptr< WThreadedScalarMaps > maps( new WThreadedScalarMaps( all, tensors ) );
+        WThreadedFunction< WThreadedScalarMaps > pool( 1, maps );
+        pool.run();
+        pool.wait();
+
+        std::vector< float > const fa = getValues( maps, WThreadedScalarMaps::FA );
+        std::vector< float > const md = getValues( maps, WThreadedScalarMaps::MD );
+        std::vector< float > const rd = getValues( maps, WThreadedScalarMaps::RD );
+        std::vector< float > const ad = getValues( maps, WThreadedScalarMaps::AD );
+        std::vector< float > const mode = getValues( maps, WThreadedScalarMaps::MODE );
+
+        TS_ASSERT_DELTA( fa[ 0 ], std::sqrt( 1.5 * ( 8.0 / 3.0 ) / 11.0 ), 1e-5 );
+        TS_ASSERT_DELTA( md[ 0 ], 5.0 / 3.0, 1e-5 );
+        TS_ASSERT_DELTA( rd[ 0 ], 1.0, 1e-5 );
+        TS_ASSERT_DELTA( ad[ 0 ], 3.0, 1e-5 );
+        TS_ASSERT_DELTA( mode[ 0 ], 1.0, 1e-4 );
+
+        TS_ASSERT_DELTA( ad[ 1 ], 2.0, 1e-5 );
+        TS_ASSERT_DELTA( rd[ 1 ], 1.5, 1e-5 );
+        TS_ASSERT_DELTA( mode[ 1 ], -1.0, 1e-4 );
+
+        TS_ASSERT_EQUALS( fa[ 2 ], 0.0f );
+        TS_ASSERT_EQUALS( mode[ 2 ], 0.0f );
+    }
+
+    /**
+     * The GFA should match WSymmetricSphericalHarmonic::calcGFA() with the same sample directions.
+     */
+    void testGFA()
+    {
+        boost::shared_ptr< WDataSetSphericalHarmonics > sh = buildSH( 4, 15 );
+        boost::shared_ptr< WValueSet< double > > vs = boost::dynamic_pointer_cast< WValueSet< double > >( sh->getValueSet() );
+        double* data = const_cast< double* >( vs->rawData() );
+        // an isotropic ODF
+        data[ 0 ] = 1.0;
+        std::fill( data + 1, data + 15, 0.0 );
+
+        boost::shared_ptr< WThreadedScalarMaps > maps( new WThreadedScalarMaps( WThreadedScalarMaps::GFA,
+                                                                                boost::shared_ptr< WDataSetSingle >(), sh ) );
+        WThreadedFunction< WThreadedScalarMaps > pool( 1, maps );
+        pool.run();
+        pool.wait();
+        std::vector< float > const gfa = getValues( maps, WThreadedScalarMaps::GFA );
+
+        std::vector< WVector3d > vertices;
+        std::vector< unsigned int > triangles;
+        tesselateIcosahedron( &vertices, &triangles, 2 );
+        std::vector< WUnitSphereCoordinates< double > > orientations;
+        for( std::size_t k = 0; k < vertices.size(); ++k )
+        {
+            if( vertices[ k ][ 0 ] >= 0.0 )
+            {
+                orientations.push_back( WUnitSphereCoordinates< double >( vertices[ k ] ) );
+            }
+        }
+        WMatrix< double > const basis = WSymmetricSphericalHarmonic< double >::calcBaseMatrix( orientations, 4 );
+
+        TS_ASSERT_DELTA( gfa[ 0 ], 0.0, 1e-5 );
+        for( std::size_t i = 1; i < gfa.size(); ++i )
+        {
+            WValue< double > coefficients( 15 );
+            for( std::size_t c = 0; c < 15; ++c )
+            {
+                coefficients[ c ] = data[ 15 * i + c ];
+            }
+            TS_ASSERT_DELTA( gfa[ i ], WSymmetricSphericalHarmonic< double >( coefficients ).calcGFA( basis ), 1e-5 );
+        }
+    }
+
+    /**
+     * The result should not depend on the number of threads.
+     */
+    void testThreads()
+    {
+        // 10^3 voxels are more than one block
+        boost::shared_ptr< WDataSetSingle > tensors = buildTensors( 10 );
+        boost::shared_ptr< WDataSetSphericalHarmonics > sh = buildSH( 10, 6 );
+        unsigned int const measures = WThreadedScalarMaps::FA | WThreadedScalarMaps::GFA;
+
+        boost::shared_ptr< WThreadedScalarMaps > single( new WThreadedScalarMaps( measures, tensors, sh ) );
+        WThreadedFunction< WThreadedScalarMaps > singlePool( 1, single );
+        singlePool.run();
+        singlePool.wait();
+
+        boost::shared_ptr< WThreadedScalarMaps > multi( new WThreadedScalarMaps( measures, tensors, sh ) );
+        WThreadedFunction< WThreadedScalarMaps > multiPool( 3, multi );
+        multiPool.run();
+        multiPool.wait();
+
+        TS_ASSERT( getValues( single, WThreadedScalarMaps::FA ) == getValues( multi, WThreadedScalarMaps::FA ) );
+        TS_ASSERT( getValues( single, WThreadedScalarMaps::GFA ) == getValues( multi, WThreadedScalarMaps::GFA ) );
+
+        // split by the caller
+        boost::shared_ptr< WThreadedScalarMaps > ranges( new WThreadedScalarMaps( measures, tensors, sh ) );
+        WBoolFlag shutdown( new WConditionOneShot(), false );
+        TS_ASSERT_EQUALS( ranges->size(), 1000 );
+        runThreadedRanges( ranges->size(), 4, boost::bind( &WThreadedScalarMaps::computeRange, ranges, _1, _2, boost::cref( shutdown ) ) );
+        TS_ASSERT( getValues( single, WThreadedScalarMaps::FA ) == getValues( ranges, WThreadedScalarMaps::FA ) );
+        TS_ASSERT( getValues( single, WThreadedScalarMaps::GFA ) == getValues( ranges, WThreadedScalarMaps::GFA ) );
+    }
+
+private:
+    /**
+     * Build a dataset of random positive definite tensors.
+     *
+     * \param n The number of voxels in every direction.
+     *
+     * \return the tensors
+     */
+    boost::shared_ptr< WDataSetSingle > buildTensors( std::size_t n )
+    {
+        boost::random::mt19937 rng( 7 );
+        boost::random::uniform_real_distribution< double > dist( 0.1, 1.0 );
+        boost::shared_ptr< WGrid > g( new WGridRegular3D( n, n, n ) );
+        boost::shared_ptr< std::vector< double > > v( new std::vector< double >( 6 * g->size() ) );
+        for( std::size_t k = 0; k < g->size(); ++k )
+        {
+            setTensor( &( *v )[ 0 ], k, 1.0 + dist( rng ), dist( rng ), dist( rng ) );
+            ( *v )[ 6 * k + 1 ] = 0.1 * dist( rng );
+        }
+        boost::shared_ptr< WValueSetBase > vs( new WValueSet< double >( 1, 6, v, W_DT_DOUBLE ) );
+        return boost::shared_ptr< WDataSetSingle >( new WDataSetSingle( vs, g ) );
+    }
+
+    /**
+     * Build a dataset of random spherical harmonics.
+     *
+     * \param n The number of voxels in every direction.
+     * \param numCoefficients The number of coefficients per voxel.
+     *
+     * \return the coefficients
+     */
+    boost::shared_ptr< WDataSetSphericalHarmonics > buildSH( std::size_t n, std::size_t numCoefficients )
+    {
+        boost::random::mt19937 rng( 11 );
+        boost::random::uniform_real_distribution< double > dist( -0.2, 0.2 );
+        boost::shared_ptr< WGrid > g( new WGridRegular3D( n, n, n ) );
+        boost::shared_ptr< std::vector< double > > v( new std::vector< double >( numCoefficients * g->size() ) );
+        for( std::size_t k = 0; k < v->size(); ++k )
+        {
+            ( *v )[ k ] = k % numCoefficients == 0 ? 1.0 : dist( rng );
+        }
+        boost::shared_ptr< WValueSetBase > vs( new WValueSet< double >( 1, numCoefficients, v, W_DT_DOUBLE ) );
+        return boost::shared_ptr< WDataSetSphericalHarmonics >( new WDataSetSphericalHarmonics( vs, g ) );
+    }
+
+    /**
+     * Set a diagonal tensor.
+     *
+     * \param data The tensor components.
+     * \param i The voxel.
+     * \param xx The first diagonal element.
+     * \param yy The second diagonal element.
+     * \param zz The third diagonal element.
+     */
+    void setTensor( double* data, std::size_t i, double xx, double yy, double zz )
+    {
+        double const tensor[] = { xx, 0.0, 0.0, yy, 0.0, zz }; // NOLINT
+        std::copy( tensor, tensor + 6, data + 6 * i );
+    }
+
+    /**
+     * The values of a computed map.
+     *
+     * \param maps The computed maps.
+     * \param measure The measure.
+     *
+     * \return the values
+     */
+    std::vector< float > getValues( boost::shared_ptr< WThreadedScalarMaps > maps, WThreadedScalarMaps::Measure measure )
+    {
+        boost::shared_ptr< WValueSet< float > > vs = boost::dynamic_pointer_cast< WValueSet< float > >( maps->getResult( measure )->getValueSet() );
+        TS_ASSERT( vs );
+        return std::vector< float >( vs->rawData(), vs->rawData() + vs->size() );
+    }
+};
+
+#endif  // WTHREADEDSCALARMAPS_TEST_H
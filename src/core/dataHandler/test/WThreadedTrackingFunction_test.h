@@ -30,6 +30,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include "../../common/WLogger.h"
+#include "../../common/WThreadedFunction.h"
 #include "../WThreadedTrackingFunction.h"
 
 /**
@@ -565,6 +566,47 @@ public:
         }
     }
 
+    /**
+     * Fibers tracked by several threads should all arrive in the fiber builder.
+     */
+    void testFiberBuilder()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( WVector3d( 1.0, 0.0, 0.0 ), 7 );
+        WVector3d x = normalize( WVector3d( 0.707, 0.707, 0.0 ) );
+        {
+            WFiberBuilder::SPtr builder( new WFiberBuilder() );
+            boost::shared_ptr< wtracking::WThreadedTrackingFunction > w(
+                    new wtracking::WThreadedTrackingFunction( ds, boost::bind( &This::dirFunc, this, _1, _2, x ),
+                                                              boost::bind( &wtracking::WTrackingUtility::followToNextVoxel, _1, _2, _3 ),
+                                                              boost::bind( &This::fibVis, this, _1 ),
+                                                              boost::bind( &This::pntVis, this, _1 ),
+                                                              1, 1, std::vector< int >(), std::vector< int >(), builder, 1 ) );
+            m_points.getWriteTicket()->get() = 0;
+            WThreadedFunction< wtracking::WThreadedTrackingFunction > f( 3, w );
+            f.run();
+            f.wait();
+
+            TS_ASSERT_EQUALS( builder->getNumFibers(), 125 );
+            TS_ASSERT_EQUALS( builder->getNumVertices(), m_points.getReadTicket()->get() );
+            TS_ASSERT_EQUALS( builder->buildDataSet()->getVertices()->size(), 3 * m_points.getReadTicket()->get() );
+        }
+        {
+            // all fibers are shorter than the minimum
+            WFiberBuilder::SPtr builder( new WFiberBuilder() );
+            boost::shared_ptr< wtracking::WThreadedTrackingFunction > w(
+                    new wtracking::WThreadedTrackingFunction( ds, boost::bind( &This::dirFunc, this, _1, _2, x ),
+                                                              boost::bind( &wtracking::WTrackingUtility::followToNextVoxel, _1, _2, _3 ),
+                                                              boost::bind( &This::fibVis, this, _1 ),
+                                                              boost::bind( &This::pntVis, this, _1 ),
+                                                              1, 1, std::vector< int >(), std::vector< int >(), builder, 8 ) );
+            WThreadedFunction< wtracking::WThreadedTrackingFunction > f( 2, w );
+            f.run();
+            f.wait();
+
+            TS_ASSERT_EQUALS( builder->getNumFibers(), 0 );
+        }
+    }
+
 private:
     /**
      * Build a test dataset.
@@ -0,0 +1,148 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTRACKINGDIRECTIONFIELD_TEST_H
+#define WTRACKINGDIRECTIONFIELD_TEST_H
+
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/exceptions/WPreconditionNotMet.h"
+#include "../WTrackingDirectionField.h"
+#include "../WValueSet.h"
+
+/**
+ * Test the direction field for tracking.
+ */
+class WTrackingDirectionFieldTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Invalid input datasets should be rejected.
+     */
+    void testPreconditions()
+    {
+        boost::shared_ptr< WGrid > g( new WGridRegular3D( 3, 3, 3 ) );
+        boost::shared_ptr< std::vector< double > > v( new std::vector< double >( 3 * 27, 1.0 ) );
+        boost::shared_ptr< WValueSetBase > vs( new WValueSet< double >( 1, 3, v, W_DT_DOUBLE ) );
+        boost::shared_ptr< WDataSetSingle > ds( new WDataSetSingle( vs, g ) );
+
+        boost::shared_ptr< WDataSetSingle > none;
+        TS_ASSERT_THROWS( wtracking::WTrackingDirectionField f( none ), WPreconditionNotMet );
+        TS_ASSERT_THROWS( wtracking::WTrackingDirectionField f( ds ), WPreconditionNotMet );
+        TS_ASSERT_THROWS_NOTHING( wtracking::WTrackingDirectionField f( buildTestData( WVector3d( 1.0, 0.0, 0.0 ), 0.5 ) ) );
+    }
+
+    /**
+     * The directions should be normalized, and degenerate voxels should be invalid.
+     */
+    void testCopy()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( WVector3d( 0.0, 3.0, 4.0 ), 0.5 );
+        boost::shared_ptr< WValueSet< double > > vs = boost::dynamic_pointer_cast< WValueSet< double > >( ds->getValueSet() );
+        const_cast< double* >( vs->rawData() )[ 4 * 13 + 0 ] = 0.0;
+        const_cast< double* >( vs->rawData() )[ 4 * 13 + 1 ] = 0.0;
+        const_cast< double* >( vs->rawData() )[ 4 * 13 + 2 ] = 0.0;
+
+        wtracking::WTrackingDirectionField f( ds );
+        TS_ASSERT_EQUALS( f.size(), 27 );
+        TS_ASSERT( f.isValid( 0 ) );
+        TS_ASSERT( !f.isValid( 13 ) );
+        TS_ASSERT_DELTA( f.getDirection( 0 )[ 1 ], 0.6, 1e-6 );
+        TS_ASSERT_DELTA( f.getDirection( 0 )[ 2 ], 0.8, 1e-6 );
+        TS_ASSERT_DELTA( f.getFA( 0 ), 0.5, 1e-6 );
+        TS_ASSERT_EQUALS( f.getFA( 13 ), 0.0f );
+        TS_ASSERT_EQUALS( f.getDirectionComponents( 2 ).size(), 27 );
+    }
+
+    /**
+     * The Mori-style lookup should flip the direction and apply the thresholds.
+     */
+    void testVoxelDirection()
+    {
+        wtracking::WTrackingDirectionField f( buildTestData( WVector3d( 1.0, 0.0, 0.0 ), 0.5 ) );
+        WVector3d pos( 1.2, 0.9, 1.1 );
+        WVector3d zero( 0.0, 0.0, 0.0 );
+
+        TS_ASSERT_DELTA( f.getDirection( pos, zero, 0.2, 0.8 )[ 0 ], 1.0, 1e-6 );
+        TS_ASSERT_DELTA( f.getDirection( pos, WVector3d( -1.0, 0.0, 0.0 ), 0.2, 0.8 )[ 0 ], -1.0, 1e-6 );
+        TS_ASSERT_EQUALS( length( f.getDirection( pos, WVector3d( 0.0, 1.0, 0.0 ), 0.2, 0.8 ) ), 0.0 );
+        TS_ASSERT_EQUALS( length( f.getDirection( pos, zero, 0.6, 0.8 ) ), 0.0 );
+        TS_ASSERT_EQUALS( length( f.getDirection( WVector3d( 5.0, 1.0, 1.0 ), zero, 0.2, 0.8 ) ), 0.0 );
+    }
+
+    /**
+     * Interpolation should reproduce a uniform field, ignore invalid voxels and align opposite directions.
+     */
+    void testInterpolation()
+    {
+        boost::shared_ptr< WDataSetSingle > ds = buildTestData( WVector3d( 1.0, 0.0, 0.0 ), 0.5 );
+        boost::shared_ptr< WValueSet< double > > vs = boost::dynamic_pointer_cast< WValueSet< double > >( ds->getValueSet() );
+        double* data = const_cast< double* >( vs->rawData() );
+        // voxel 0 points the other way, voxel 1 has no direction
+        data[ 0 ] = -1.0;
+        data[ 4 + 0 ] = 0.0;
+
+        wtracking::WTrackingDirectionField f( ds );
+        WVector3d zero( 0.0, 0.0, 0.0 );
+        WVector3d d = f.interpolateDirection( WVector3d( 0.5, 0.5, 0.5 ), WVector3d( 1.0, 0.0, 0.0 ), 0.2, 0.8 );
+        TS_ASSERT_DELTA( d[ 0 ], 1.0, 1e-6 );
+        TS_ASSERT_DELTA( d[ 1 ], 0.0, 1e-6 );
+        TS_ASSERT_DELTA( d[ 2 ], 0.0, 1e-6 );
+
+        d = f.interpolateDirection( WVector3d( 0.25, 0.5, 0.5 ), zero, 0.2, 0.8 );
+        TS_ASSERT_DELTA( std::abs( d[ 0 ] ), 1.0, 1e-6 );
+
+        TS_ASSERT_EQUALS( length( f.interpolateDirection( WVector3d( 0.5, 0.5, 0.5 ), zero, 0.6, 0.8 ) ), 0.0 );
+        TS_ASSERT_EQUALS( length( f.interpolateDirection( WVector3d( 0.5, 0.5, 0.5 ), WVector3d( 0.0, 0.0, 1.0 ), 0.2, 0.8 ) ), 0.0 );
+        TS_ASSERT_EQUALS( length( f.interpolateDirection( WVector3d( -1.0, 0.5, 0.5 ), zero, 0.2, 0.8 ) ), 0.0 );
+    }
+
+private:
+    /**
+     * Build a 3x3x3 dataset of principal directions and FA.
+     *
+     * \param dir The direction of every voxel.
+     * \param fa The FA of every voxel.
+     *
+     * \return the test dataset
+     */
+    boost::shared_ptr< WDataSetSingle > buildTestData( WVector3d const& dir, double fa )
+    {
+        boost::shared_ptr< WGrid > g( new WGridRegular3D( 3, 3, 3 ) );
+        boost::shared_ptr< std::vector< double > > v( new std::vector< double >( 4 * 27 ) );
+        for( std::size_t k = 0; k < 27; ++k )
+        {
+            v->at( 4 * k + 0 ) = dir[ 0 ];
+            v->at( 4 * k + 1 ) = dir[ 1 ];
+            v->at( 4 * k + 2 ) = dir[ 2 ];
+            v->at( 4 * k + 3 ) = fa;
+        }
+        boost::shared_ptr< WValueSetBase > vs( new WValueSet< double >( 1, 4, v, W_DT_DOUBLE ) );
+        return boost::shared_ptr< WDataSetSingle >( new WDataSetSingle( vs, g ) );
+    }
+};
+
+#endif  // WTRACKINGDIRECTIONFIELD_TEST_H
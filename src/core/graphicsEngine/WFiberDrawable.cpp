@@ -27,6 +27,7 @@
 #include "../kernel/WKernel.h"
 
 #include "WFiberDrawable.h"
+#include "WGEFiberGeometryBuilder.h"
 
 // The constructor here does nothing. One thing that may be necessary is
 // disabling display lists. This can be done by calling
@@ -35,7 +36,10 @@
 // time (that is, the vertices drawn change from time to time).
 WFiberDrawable::WFiberDrawable():
     osg::Drawable(),
-    m_useTubes( false )
+    m_useTubes( false ),
+    m_indicesDirty( true ),
+    m_indicesForTubes( false ),
+    m_tubesDirty( true )
 {
     setSupportsDisplayList( false );
     // This contructor intentionally left blank. Duh.
@@ -44,7 +48,11 @@ WFiberDrawable::WFiberDrawable():
 // I can't say much about the methods below, but OSG seems to expect
 // that we implement them.
 WFiberDrawable::WFiberDrawable( const WFiberDrawable& /*pg*/, const osg::CopyOp& /*copyop*/ ):
-    osg::Drawable()
+    osg::Drawable(),
+    m_useTubes( false ),
+    m_indicesDirty( true ),
+    m_indicesForTubes( false ),
+    m_tubesDirty( true )
 {
 }
 
@@ -73,7 +81,7 @@ void WFiberDrawable::drawImplementation( osg::RenderInfo& renderInfo ) const //N
 {
     if( m_useTubes )
     {
-        drawTubes();
+        drawTubes( renderInfo );
     }
     else
     {
@@ -84,47 +92,87 @@ void WFiberDrawable::drawImplementation( osg::RenderInfo& renderInfo ) const //N
 void WFiberDrawable::drawFibers( osg::RenderInfo& renderInfo ) const //NOLINT
 {
     osg::State& state = *renderInfo.getState();
+    boost::unique_lock< boost::mutex > lock( m_cacheLock );
+    updateIndices( false );
+    if( m_indices.empty() )
+    {
+        return;
+    }
 
+    // all active fibers are drawn with one call instead of one per fiber
     state.disableAllVertexArrays();
     state.setVertexPointer( 3, GL_FLOAT , 0, &( *m_verts )[0] );
     state.setColorPointer( 3 , GL_FLOAT , 0, &( *m_colors )[0] );
-    //state.setNormalPointer( GL_FLOAT , 0, &( *m_tangents )[0] );
-    for( size_t i = 0; i < m_active->size(); ++i )
+    glDrawElements( GL_LINES, m_indices.size(), GL_UNSIGNED_INT, &m_indices[0] );
+
+    state.disableVertexPointer();
+    state.disableColorPointer();
+}
+
+void WFiberDrawable::drawTubes( osg::RenderInfo& renderInfo ) const //NOLINT
+{
+    osg::State& state = *renderInfo.getState();
+    boost::unique_lock< boost::mutex > lock( m_cacheLock );
+    updateTubeArrays();
+    updateIndices( true );
+    if( m_indices.empty() )
     {
-        if( (*m_active)[i] )
-        {
-            state.glDrawArraysInstanced( GL_LINE_STRIP, (*m_startIndexes)[i], (*m_pointsPerLine)[i], 1);
-        }
+        return;
     }
 
+    state.disableAllVertexArrays();
+    state.setVertexPointer( 3, GL_FLOAT, 0, &m_tubeVerts[0] );
+    state.setColorPointer( 3, GL_FLOAT, 0, &m_tubeColors[0] );
+    state.setNormalPointer( GL_FLOAT, 0, &m_tubeTangents[0] );
+    state.setTexCoordPointer( 0, 1, GL_FLOAT, 0, &m_tubeTexCoords[0] );
+    glDrawElements( GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, &m_indices[0] );
+
     state.disableVertexPointer();
     state.disableColorPointer();
+    state.disableNormalPointer();
+    state.disableTexCoordPointer( 0 );
+}
+
+void WFiberDrawable::updateIndices( bool tubes ) const
+{
+    if( !m_indicesDirty && m_indicesForTubes == tubes && m_indexedActive == *m_active )
+    {
+        return;
+    }
+
+    m_indices.clear();
+    WGEFiberGeometryBuilder::appendFiberIndices( *m_startIndexes, *m_pointsPerLine, m_active.get(), tubes, &m_indices );
+    m_indexedActive = *m_active;
+    m_indicesForTubes = tubes;
+    m_indicesDirty = false;
 }
 
-void WFiberDrawable::drawTubes() const
+void WFiberDrawable::updateTubeArrays() const
 {
-    // This does not work if GLES is used
-    #ifndef GL_ES_VERSION_2_0
-    for( size_t i = 0; i < m_active->size(); ++i )
+    if( !m_tubesDirty )
+    {
+        return;
+    }
+
+    // every vertex is doubled, the copies are moved to both sides of the tube by the shader
+    std::size_t const numValues = 2 * m_verts->size();
+    m_tubeVerts.resize( numValues );
+    m_tubeTangents.resize( numValues );
+    m_tubeColors.resize( numValues );
+    m_tubeTexCoords.resize( numValues / 3 );
+    for( std::size_t v = 0; v < m_verts->size() / 3; ++v )
     {
-        if( (*m_active)[i] )
+        for( std::size_t copy = 0; copy < 2; ++copy )
         {
-            glBegin( GL_QUAD_STRIP );
-            int idx = m_startIndexes->at( i ) * 3;
-            for( size_t k = 0; k < m_pointsPerLine->at( i ); ++k )
+            std::size_t const out = 2 * v + copy;
+            for( std::size_t c = 0; c < 3; ++c )
             {
-                glNormal3f( m_tangents->at( idx ), m_tangents->at( idx + 1 ), m_tangents->at( idx + 2 ) );
-                glColor3f( m_colors->at( idx ), m_colors->at( idx + 1 ), m_colors->at( idx + 2 ) );
-                glTexCoord1f( -1.0f );
-                glVertex3f( m_verts->at( idx ), m_verts->at( idx + 1 ), m_verts->at( idx + 2 ) );
-                glTexCoord1f( 1.0f );
-                glVertex3f( m_verts->at( idx ), m_verts->at( idx + 1 ), m_verts->at( idx + 2 ) );
-                idx += 3;
-                //
+                m_tubeVerts[ 3 * out + c ] = ( *m_verts )[ 3 * v + c ];
+                m_tubeTangents[ 3 * out + c ] = ( *m_tangents )[ 3 * v + c ];
+                m_tubeColors[ 3 * out + c ] = ( *m_colors )[ 3 * v + c ];
             }
-            glEnd();
+            m_tubeTexCoords[ out ] = copy == 0 ? -1.0f : 1.0f;
         }
     }
-    #endif
+    m_tubesDirty = false;
 }
-
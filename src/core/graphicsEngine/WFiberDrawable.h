@@ -32,6 +32,7 @@
 #include <boost/thread/thread.hpp>
 
 #include <osg/Drawable>
+#include <osg/GL>
 
 
 
@@ -147,8 +148,22 @@ private:
 
     /**
      * Draw fibers as fake tubes.
+     *
+     * \param renderInfo
+     */
+    void drawTubes( osg::RenderInfo& renderInfo ) const; //NOLINT
+
+    /**
+     * Rebuilds the cached indices of the active fibers if the bitfield, the fibers or the mode changed. Needs m_cacheLock.
+     *
+     * \param tubes whether to build tube triangles or lines
      */
-    void drawTubes() const;
+    void updateIndices( bool tubes ) const;
+
+    /**
+     * Rebuilds the cached tube vertex arrays if the fibers changed. Needs m_cacheLock.
+     */
+    void updateTubeArrays() const;
 
     boost::shared_mutex m_recalcLock; //!< lock
 
@@ -161,6 +176,17 @@ private:
     boost::shared_ptr< std::vector< float > > m_verts; //!< pointer to the field of vertexes
     boost::shared_ptr< std::vector< float > > m_tangents; //!< pointer to the field of line tangents
     boost::shared_ptr< std::vector< float > > m_colors; //!< pointer to the field of colors per vertex
+
+    mutable boost::mutex m_cacheLock; //!< protects the cached arrays below, drawing may happen in several threads
+    mutable std::vector< GLuint > m_indices; //!< the segments of the active fibers, drawn with one call
+    mutable std::vector< bool > m_indexedActive; //!< the bitfield m_indices was built for
+    mutable bool m_indicesDirty; //!< true if the fibers changed since m_indices was built
+    mutable bool m_indicesForTubes; //!< whether m_indices contains tube triangles or lines
+    mutable std::vector< float > m_tubeVerts; //!< the doubled vertexes for tubes
+    mutable std::vector< float > m_tubeTangents; //!< the doubled tangents for tubes
+    mutable std::vector< float > m_tubeColors; //!< the doubled colors for tubes
+    mutable std::vector< float > m_tubeTexCoords; //!< the side of the tube of every doubled vertex
+    mutable bool m_tubesDirty; //!< true if the fibers changed since the tube arrays were built
 };
 
 inline void WFiberDrawable::setUseTubes( bool flag )
@@ -176,26 +202,33 @@ inline void WFiberDrawable::setBitfield( boost::shared_ptr< std::vector< bool >
 inline void WFiberDrawable::setStartIndexes( boost::shared_ptr< std::vector< size_t > > idx )
 {
     m_startIndexes = idx;
+    m_indicesDirty = true;
+    m_tubesDirty = true;
 }
 
 inline void WFiberDrawable::setPointsPerLine( boost::shared_ptr< std::vector< size_t > > ppl )
 {
     m_pointsPerLine = ppl;
+    m_indicesDirty = true;
+    m_tubesDirty = true;
 }
 
 inline void WFiberDrawable::setVerts( boost::shared_ptr< std::vector< float > > verts )
 {
     m_verts = verts;
+    m_tubesDirty = true;
 }
 
 inline void WFiberDrawable::setTangents( boost::shared_ptr< std::vector< float > > tangents )
 {
     m_tangents = tangents;
+    m_tubesDirty = true;
 }
 
 inline void WFiberDrawable::setColor( boost::shared_ptr< std::vector< float > > color )
 {
     m_colors = color;
+    m_tubesDirty = true;
 }
 
 #endif  // WFIBERDRAWABLE_H
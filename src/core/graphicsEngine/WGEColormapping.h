@@ -37,6 +37,7 @@
 #include <osg/Node>
 
 #include "../common/WBoundingBox.h"
+#include "../common/WSharedObjectRCU.h"
 #include "../common/WSharedSequenceContainer.h"
 #include "../common/WSharedAssociativeContainer.h"
 
@@ -55,9 +56,11 @@ class WGEColormapping // NOLINT
 {
 public:
     /**
-     * The alias for a shared container.
+     * The alias for a shared container. The textures are read for every colormapped node in each frame but rarely change, so readers use
+     * read-copy-update snapshots instead of a lock.
      */
-    typedef WSharedSequenceContainer< std::vector< osg::ref_ptr< WGETexture3D > > > TextureContainerType;
+    typedef WSharedSequenceContainer< std::vector< osg::ref_ptr< WGETexture3D > >,
+                                      WSharedObjectRCU< std::vector< osg::ref_ptr< WGETexture3D > > > > TextureContainerType;
 
     /**
      * Iterator to access the texture list.
@@ -0,0 +1,434 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/ref.hpp>
+
+#include "../common/exceptions/WPreconditionNotMet.h"
+#include "../common/WThreadedFunction.h"
+#include "WGEFiberGeometryBuilder.h"
+
+/**
+ * Fills the vertex arrays of a range of fibers, to be run by runThreadedRanges(). Every fiber is written to the vertices
+ * starting at its start index, doubled for tubes, so the threads never write the same elements.
+ */
+class WGEFiberGeometryBuilder::ArrayFiller // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param fibers the fibers
+     * \param tubes whether to double the vertices for tubes
+     * \param usePlainColor whether to use the plain color
+     * \param plainColor the plain color
+     * \param progress if given, incremented by the number of processed fibers
+     * \param colorScheme the colors of the vertices
+     */
+    ArrayFiller( boost::shared_ptr< WDataSetFibers const > fibers, bool tubes, bool usePlainColor, WColor const& plainColor,
+                 WProgress::SPtr progress, boost::shared_ptr< WDataSetFibers::ColorScheme const > colorScheme ):
+        m_starts( fibers->getLineStartIndexes() ),
+        m_lengths( fibers->getLineLengths() ),
+        m_vertices( fibers->getVertices() ),
+        m_tangents( fibers->getTangents() ),
+        m_colors( colorScheme->getColor() ),
+        m_colorMode( colorScheme->getMode() ),
+        m_tubes( tubes ),
+        m_usePlainColor( usePlainColor ),
+        m_plainColor( plainColor ),
+        m_progress( progress )
+    {
+        std::size_t const copies = tubes ? 2 : 1;
+        std::size_t const numVertices = copies * m_vertices->size() / 3;
+        m_outVertices = new osg::Vec3Array( numVertices );
+        m_outColors = new osg::Vec4Array( numVertices );
+        m_outTangents = new osg::Vec3Array( numVertices );
+        if( tubes )
+        {
+            m_outTexCoords = new osg::FloatArray( numVertices );
+            m_startVertices = new osg::Vec3Array( m_starts->size() );
+            m_startColors = new osg::Vec4Array( m_starts->size() );
+            m_startTangents = new osg::Vec3Array( m_starts->size() );
+            m_endVertices = new osg::Vec3Array( m_starts->size() );
+            m_endColors = new osg::Vec4Array( m_starts->size() );
+            m_endTangents = new osg::Vec3Array( m_starts->size() );
+        }
+    }
+
+    /**
+     * Fills the arrays for a range of fibers.
+     *
+     * \param first the first fiber
+     * \param last the fiber behind the last one
+     */
+    void operator()( std::size_t first, std::size_t last )
+    {
+        // the fibers are processed in chunks, which also is the step of the progress to keep the contention on it low
+        std::size_t const chunkSize = 4096;
+        for( std::size_t chunkBegin = first; chunkBegin < last; chunkBegin += chunkSize )
+        {
+            std::size_t const chunkEnd = std::min( last, chunkBegin + chunkSize );
+            for( std::size_t fidx = chunkBegin; fidx < chunkEnd; ++fidx )
+            {
+                fillFiber( fidx );
+            }
+            if( m_progress )
+            {
+                m_progress->increment( chunkEnd - chunkBegin );
+            }
+        }
+    }
+
+    /**
+     * The vertices.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_outVertices;
+
+    /**
+     * The colors.
+     */
+    osg::ref_ptr< osg::Vec4Array > m_outColors;
+
+    /**
+     * The normalized tangents.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_outTangents;
+
+    /**
+     * The texture coordinates of the tube vertices.
+     */
+    osg::ref_ptr< osg::FloatArray > m_outTexCoords;
+
+    /**
+     * The first vertex of every fiber.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_startVertices;
+
+    /**
+     * The color of the first vertex of every fiber.
+     */
+    osg::ref_ptr< osg::Vec4Array > m_startColors;
+
+    /**
+     * The outward direction at the first vertex of every fiber.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_startTangents;
+
+    /**
+     * The last vertex of every fiber.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_endVertices;
+
+    /**
+     * The color of the last vertex of every fiber.
+     */
+    osg::ref_ptr< osg::Vec4Array > m_endColors;
+
+    /**
+     * The outward direction at the last vertex of every fiber.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_endTangents;
+
+private:
+    /**
+     * Fills the arrays of one fiber.
+     *
+     * \param fidx the fiber
+     */
+    void fillFiber( std::size_t fidx )
+    {
+        std::vector< float > const& verts = *m_vertices;
+        std::vector< float > const& tangents = *m_tangents;
+        std::size_t const start = ( *m_starts )[ fidx ];
+        std::size_t const len = ( *m_lengths )[ fidx ];
+        std::size_t const copies = m_tubes ? 2 : 1;
+        std::size_t const mode = m_colorMode;
+
+        for( std::size_t k = 0; k < len; ++k )
+        {
+            std::size_t const v = start + k;
+            osg::Vec3 const vert( verts[ 3 * v ], verts[ 3 * v + 1 ], verts[ 3 * v + 2 ] );
+            osg::Vec3 tangent( tangents[ 3 * v ], tangents[ 3 * v + 1 ], tangents[ 3 * v + 2 ] );
+            tangent.normalize();
+
+            osg::Vec4 color = m_plainColor;
+            if( !m_usePlainColor )
+            {
+                float const* c = &( *m_colors )[ mode * v ];
+                color = osg::Vec4( c[ 0 % mode ], c[ 1 % mode ], c[ 2 % mode ],
+                                   mode == WDataSetFibers::ColorScheme::RGBA ? c[ 3 ] : 1.0f );
+            }
+
+            for( std::size_t copy = 0; copy < copies; ++copy )
+            {
+                std::size_t const out = copies * v + copy;
+                ( *m_outVertices )[ out ] = vert;
+                ( *m_outColors )[ out ] = color;
+                ( *m_outTangents )[ out ] = tangent;
+            }
+            if( m_tubes )
+            {
+                // the sign tells the vertex shader on which side of the tube the vertex lies
+                ( *m_outTexCoords )[ 2 * v ] = 1.0f;
+                ( *m_outTexCoords )[ 2 * v + 1 ] = -1.0f;
+            }
+        }
+
+        if( m_tubes && len >= 2 )
+        {
+            // NOTE: the stored tangents are not guaranteed to point outwards, so the caps use the first and last segment
+            std::size_t const first = copies * start;
+            std::size_t const last = copies * ( start + len - 1 );
+            ( *m_startVertices )[ fidx ] = ( *m_outVertices )[ first ];
+            ( *m_startColors )[ fidx ] = ( *m_outColors )[ first ];
+            ( *m_startTangents )[ fidx ] = ( *m_outVertices )[ first ] - ( *m_outVertices )[ first + copies ];
+            ( *m_endVertices )[ fidx ] = ( *m_outVertices )[ last ];
+            ( *m_endColors )[ fidx ] = ( *m_outColors )[ last ];
+            ( *m_endTangents )[ fidx ] = ( *m_outVertices )[ last ] - ( *m_outVertices )[ last - copies ];
+        }
+    }
+
+    /**
+     * The index of the first vertex of every fiber.
+     */
+    WDataSetFibers::IndexArray m_starts;
+
+    /**
+     * The number of vertices of every fiber.
+     */
+    WDataSetFibers::LengthArray m_lengths;
+
+    /**
+     * The fiber vertices.
+     */
+    WDataSetFibers::VertexArray m_vertices;
+
+    /**
+     * The fiber tangents.
+     */
+    WDataSetFibers::TangentArray m_tangents;
+
+    /**
+     * The colors of the current color scheme.
+     */
+    WDataSetFibers::ColorArray m_colors;
+
+    /**
+     * The number of floats per color.
+     */
+    WDataSetFibers::ColorScheme::ColorMode m_colorMode;
+
+    /**
+     * Whether the vertices are doubled for tubes.
+     */
+    bool m_tubes;
+
+    /**
+     * Whether to use the plain color.
+     */
+    bool m_usePlainColor;
+
+    /**
+     * The plain color.
+     */
+    WColor m_plainColor;
+
+    /**
+     * The progress, may be empty.
+     */
+    WProgress::SPtr m_progress;
+};
+
+WGEFiberGeometryBuilder::WGEFiberGeometryBuilder( boost::shared_ptr< WDataSetFibers const > fibers, bool tubes, bool usePlainColor,
+                                                  WColor const& plainColor, WProgress::SPtr progress, std::size_t numThreads,
+                                                  boost::shared_ptr< WDataSetFibers::ColorScheme const > colorScheme ):
+    m_fibers( fibers ),
+    m_tubes( tubes ),
+    m_numSelected( 0 )
+{
+    WPrecond( fibers, "Missing fibers." );
+
+    if( !colorScheme )
+    {
+        colorScheme = fibers->getColorScheme();
+    }
+    boost::shared_ptr< ArrayFiller > filler( new ArrayFiller( fibers, tubes, usePlainColor, plainColor, progress, colorScheme ) );
+    // rethrows the first exception of the workers, a geometry with missing fibers is never built
+    runThreadedRanges( fibers->getLineStartIndexes()->size(), numThreads, boost::ref( *filler ) );
+
+    std::size_t const numFibers = fibers->getLineStartIndexes()->size();
+    m_roiColors.assign( numFibers, osg::Vec3( 0.0f, 0.0f, 0.0f ) );
+    m_fiberColors = m_roiColors;
+    m_secondaryColors = new osg::Vec3Array( filler->m_outVertices->size() );
+
+    m_geometry = new osg::Geometry();
+    m_geometry->setVertexArray( filler->m_outVertices );
+    m_geometry->setColorArray( filler->m_outColors );
+    m_geometry->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
+    m_geometry->setNormalArray( filler->m_outTangents );
+    m_geometry->setNormalBinding( osg::Geometry::BIND_PER_VERTEX );
+    m_geometry->setSecondaryColorArray( m_secondaryColors );
+    m_geometry->setSecondaryColorBinding( osg::Geometry::BIND_PER_VERTEX );
+    m_indices = new osg::DrawElementsUInt( tubes ? osg::PrimitiveSet::TRIANGLES : osg::PrimitiveSet::LINES );
+    m_geometry->addPrimitiveSet( m_indices );
+    m_geometry->setUseDisplayList( false );
+    m_geometry->setUseVertexBufferObjects( true );
+
+    if( tubes )
+    {
+        m_geometry->setTexCoordArray( 0, filler->m_outTexCoords );
+
+        m_capSecondaryColors = new osg::Vec3Array( numFibers );
+        m_startCapIndices = new osg::DrawElementsUInt( osg::PrimitiveSet::POINTS );
+        m_endCapIndices = new osg::DrawElementsUInt( osg::PrimitiveSet::POINTS );
+
+        m_startCaps = new osg::Geometry();
+        m_startCaps->setVertexArray( filler->m_startVertices );
+        m_startCaps->setColorArray( filler->m_startColors );
+        m_startCaps->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
+        m_startCaps->setNormalArray( filler->m_startTangents );
+        m_startCaps->setNormalBinding( osg::Geometry::BIND_PER_VERTEX );
+        m_startCaps->setSecondaryColorArray( m_capSecondaryColors );
+        m_startCaps->setSecondaryColorBinding( osg::Geometry::BIND_PER_VERTEX );
+        m_startCaps->addPrimitiveSet( m_startCapIndices );
+        m_startCaps->setUseDisplayList( false );
+        m_startCaps->setUseVertexBufferObjects( true );
+
+        m_endCaps = new osg::Geometry();
+        m_endCaps->setVertexArray( filler->m_endVertices );
+        m_endCaps->setColorArray( filler->m_endColors );
+        m_endCaps->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
+        m_endCaps->setNormalArray( filler->m_endTangents );
+        m_endCaps->setNormalBinding( osg::Geometry::BIND_PER_VERTEX );
+        m_endCaps->setSecondaryColorArray( m_capSecondaryColors );
+        m_endCaps->setSecondaryColorBinding( osg::Geometry::BIND_PER_VERTEX );
+        m_endCaps->addPrimitiveSet( m_endCapIndices );
+        m_endCaps->setUseDisplayList( false );
+        m_endCaps->setUseVertexBufferObjects( true );
+    }
+
+    select( std::vector< bool >(), true );
+}
+
+WGEFiberGeometryBuilder::~WGEFiberGeometryBuilder()
+{
+}
+
+osg::ref_ptr< osg::Geometry > WGEFiberGeometryBuilder::getGeometry() const
+{
+    return m_geometry;
+}
+
+osg::ref_ptr< osg::Geometry > WGEFiberGeometryBuilder::getStartCapGeometry() const
+{
+    return m_startCaps;
+}
+
+osg::ref_ptr< osg::Geometry > WGEFiberGeometryBuilder::getEndCapGeometry() const
+{
+    return m_endCaps;
+}
+
+void WGEFiberGeometryBuilder::select( std::vector< bool > const& selection, bool all )
+{
+    std::vector< std::size_t > const& starts = *m_fibers->getLineStartIndexes();
+    std::vector< std::size_t > const& lengths = *m_fibers->getLineLengths();
+    WPrecond( all || selection.size() == starts.size(), "Need one flag per fiber." );
+
+    // clear() keeps the memory, so selecting again does not reallocate
+    m_indices->clear();
+    m_numSelected = appendFiberIndices( starts, lengths, all ? NULL : &selection, m_tubes, m_indices.get() );
+    m_indices->dirty();
+
+    if( m_tubes )
+    {
+        m_startCapIndices->clear();
+        m_endCapIndices->clear();
+        for( std::size_t fidx = 0; fidx < starts.size(); ++fidx )
+        {
+            if( lengths[ fidx ] >= 2 && ( all || selection[ fidx ] ) )
+            {
+                m_startCapIndices->push_back( fidx );
+                m_endCapIndices->push_back( fidx );
+            }
+        }
+        m_startCapIndices->dirty();
+        m_endCapIndices->dirty();
+    }
+}
+
+std::size_t WGEFiberGeometryBuilder::getNumSelectedFibers() const
+{
+    return m_numSelected;
+}
+
+void WGEFiberGeometryBuilder::setFiberColors( std::vector< osg::Vec3 > const& colors )
+{
+    WPrecond( colors.size() == m_roiColors.size(), "Need one color per fiber." );
+    m_roiColors = colors;
+    updateSecondaryColors();
+}
+
+void WGEFiberGeometryBuilder::setClusterColors( std::vector< osg::Vec3 > const& colors )
+{
+    WPrecond( colors.empty() || colors.size() == m_roiColors.size(), "Need one color per fiber." );
+    m_clusterColors = colors;
+    updateSecondaryColors();
+}
+
+void WGEFiberGeometryBuilder::updateSecondaryColors()
+{
+    std::vector< std::size_t > const& starts = *m_fibers->getLineStartIndexes();
+    std::vector< std::size_t > const& lengths = *m_fibers->getLineLengths();
+    std::vector< osg::Vec3 > const& colors = m_clusterColors.empty() ? m_roiColors : m_clusterColors;
+
+    std::size_t const copies = m_tubes ? 2 : 1;
+    bool changed = false;
+    for( std::size_t fidx = 0; fidx < starts.size(); ++fidx )
+    {
+        if( colors[ fidx ] == m_fiberColors[ fidx ] )
+        {
+            continue;
+        }
+        changed = true;
+        m_fiberColors[ fidx ] = colors[ fidx ];
+        std::fill( m_secondaryColors->begin() + copies * starts[ fidx ],
+                   m_secondaryColors->begin() + copies * ( starts[ fidx ] + lengths[ fidx ] ), colors[ fidx ] );
+        if( m_capSecondaryColors )
+        {
+            ( *m_capSecondaryColors )[ fidx ] = colors[ fidx ];
+        }
+    }
+
+    if( changed )
+    {
+        m_secondaryColors->dirty();
+        if( m_capSecondaryColors )
+        {
+            m_capSecondaryColors->dirty();
+        }
+    }
+}
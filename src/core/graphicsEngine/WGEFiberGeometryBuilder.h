@@ -0,0 +1,277 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WGEFIBERGEOMETRYBUILDER_H
+#define WGEFIBERGEOMETRYBUILDER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <osg/Array>
+#include <osg/Geometry>
+#include <osg/PrimitiveSet>
+
+#include "../common/WColor.h"
+#include "../common/WProgress.h"
+#include "../dataHandler/WDataSetFibers.h"
+
+/**
+ * Builds the geometry of a fiber dataset as a single indexed primitive set, no matter how many fibers there are. The
+ * vertex arrays are filled in parallel, each thread writing the fibers of its own range. Lines are drawn as GL_LINES and
+ * tubes as GL_TRIANGLES of the doubled vertices, so the fibers do not need to be separated by restart indices or
+ * primitive sets. Selecting fibers only rebuilds the index buffer; the vertex arrays are never touched again, except
+ * for the per fiber secondary colors.
+ *
+ * Per fiber attributes are stored per vertex as there is only one primitive set. The optional cap geometries have
+ * one point per fiber, at its start or end, and are filtered the same way.
+ */
+class WGEFiberGeometryBuilder // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WGEFiberGeometryBuilder > SPtr;
+
+    /**
+     * Builds the vertex arrays and selects all fibers.
+     *
+     * \param fibers the fibers
+     * \param tubes whether to build tubes, i.e. two vertices per fiber vertex with the texture coordinates -1 and 1, and the
+     * cap geometries, or lines
+     * \param usePlainColor if true, all vertices get the plain color instead of the color of the current color scheme
+     * \param plainColor the plain color
+     * \param progress if given, incremented by the number of processed fibers
+     * \param numThreads the number of threads, 0 to choose automatically
+     * \param colorScheme if given, the per vertex colors to use instead of the current color scheme of the fibers
+     */
+    WGEFiberGeometryBuilder( boost::shared_ptr< WDataSetFibers const > fibers, bool tubes, bool usePlainColor, WColor const& plainColor,
+                             WProgress::SPtr progress = WProgress::SPtr(), std::size_t numThreads = 0,
+                             boost::shared_ptr< WDataSetFibers::ColorScheme const > colorScheme =
+                                 boost::shared_ptr< WDataSetFibers::ColorScheme const >() );
+
+    /**
+     * Destructor.
+     */
+    ~WGEFiberGeometryBuilder();
+
+    /**
+     * The geometry of the lines or tubes, with vertices, colors, normals (the tangents), secondary colors and, for tubes,
+     * texture coordinates in unit 0.
+     *
+     * \return the geometry
+     */
+    osg::ref_ptr< osg::Geometry > getGeometry() const;
+
+    /**
+     * The start points of the fibers, with the outward tangents as normals. Only available for tubes.
+     *
+     * \return the geometry, or NULL for lines
+     */
+    osg::ref_ptr< osg::Geometry > getStartCapGeometry() const;
+
+    /**
+     * The end points of the fibers, with the outward tangents as normals. Only available for tubes.
+     *
+     * \return the geometry, or NULL for lines
+     */
+    osg::ref_ptr< osg::Geometry > getEndCapGeometry() const;
+
+    /**
+     * Shows only the selected fibers by rebuilding the index buffers. Call this from an update callback of the
+     * geometry, like all other changes to a geometry that is being drawn.
+     *
+     * \param selection one flag per fiber
+     * \param all if true, all fibers are shown regardless of the selection
+     */
+    void select( std::vector< bool > const& selection, bool all = false );
+
+    /**
+     * The number of fibers that are currently drawn, i.e. the selected fibers with at least two vertices.
+     *
+     * \return the number of fibers
+     */
+    std::size_t getNumSelectedFibers() const;
+
+    /**
+     * Sets the ROI color of every fiber, which is its secondary color as long as no cluster colors are set. Only the
+     * vertices of fibers whose secondary color changed are rewritten. Call this from an update callback of the geometry.
+     *
+     * \param colors one color per fiber
+     */
+    void setFiberColors( std::vector< osg::Vec3 > const& colors );
+
+    /**
+     * Sets the cluster color of every fiber. While set, these are the secondary colors, and setFiberColors() only
+     * updates the ROI colors shown once the cluster colors are removed. Call this from an update callback of the geometry.
+     *
+     * \param colors one color per fiber, or none to show the ROI colors again
+     */
+    void setClusterColors( std::vector< osg::Vec3 > const& colors );
+
+    /**
+     * Appends the indices of the segments of the selected fibers, as GL_LINES of the fiber vertices or as GL_TRIANGLES of
+     * the doubled tube vertices. Fibers with less than two vertices are skipped.
+     *
+     * \tparam Indices a container of integers with push_back(), like osg::DrawElementsUInt
+     * \param starts the index of the first vertex of every fiber
+     * \param lengths the number of vertices of every fiber
+     * \param selection one flag per fiber, or NULL to add all fibers
+     * \param tubes whether to add tube triangles or lines
+     * \param indices the indices are appended here
+     *
+     * \return the number of added fibers
+     */
+    template< typename Indices >
+    static std::size_t appendFiberIndices( std::vector< std::size_t > const& starts, std::vector< std::size_t > const& lengths,
+                                           std::vector< bool > const* selection, bool tubes, Indices* indices );
+
+private:
+    /**
+     * Fills the vertex arrays of a range of fibers, to be run by a WThreadedFunction.
+     */
+    class ArrayFiller;
+
+    /**
+     * Writes the cluster colors, or the ROI colors if there are none, to the secondary colors of the fibers whose color
+     * changed.
+     */
+    void updateSecondaryColors();
+
+    /**
+     * The fibers.
+     */
+    boost::shared_ptr< WDataSetFibers const > m_fibers;
+
+    /**
+     * Whether tubes or lines are built.
+     */
+    bool m_tubes;
+
+    /**
+     * The geometry of the lines or tubes.
+     */
+    osg::ref_ptr< osg::Geometry > m_geometry;
+
+    /**
+     * The indices of the segments of the selected fibers.
+     */
+    osg::ref_ptr< osg::DrawElementsUInt > m_indices;
+
+    /**
+     * The per vertex secondary colors.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_secondaryColors;
+
+    /**
+     * The ROI color of every fiber.
+     */
+    std::vector< osg::Vec3 > m_roiColors;
+
+    /**
+     * The cluster color of every fiber, empty if there is no clustering.
+     */
+    std::vector< osg::Vec3 > m_clusterColors;
+
+    /**
+     * The current secondary color of every fiber.
+     */
+    std::vector< osg::Vec3 > m_fiberColors;
+
+    /**
+     * The start caps, NULL for lines.
+     */
+    osg::ref_ptr< osg::Geometry > m_startCaps;
+
+    /**
+     * The end caps, NULL for lines.
+     */
+    osg::ref_ptr< osg::Geometry > m_endCaps;
+
+    /**
+     * The secondary colors of the caps, one per fiber.
+     */
+    osg::ref_ptr< osg::Vec3Array > m_capSecondaryColors;
+
+    /**
+     * The indices of the start caps of the selected fibers.
+     */
+    osg::ref_ptr< osg::DrawElementsUInt > m_startCapIndices;
+
+    /**
+     * The indices of the end caps of the selected fibers.
+     */
+    osg::ref_ptr< osg::DrawElementsUInt > m_endCapIndices;
+
+    /**
+     * The number of fibers that are currently drawn.
+     */
+    std::size_t m_numSelected;
+};
+
+template< typename Indices >
+std::size_t WGEFiberGeometryBuilder::appendFiberIndices( std::vector< std::size_t > const& starts, std::vector< std::size_t > const& lengths,
+                                                         std::vector< bool > const* selection, bool tubes, Indices* indices )
+{
+    std::size_t added = 0;
+    for( std::size_t fidx = 0; fidx < starts.size(); ++fidx )
+    {
+        std::size_t const len = lengths[ fidx ];
+        if( len < 2 || ( selection && !( *selection )[ fidx ] ) )
+        {
+            continue;
+        }
+        ++added;
+
+        if( tubes )
+        {
+            // the quad strip of vertex k consists of the vertices 2k and 2k + 1
+            std::size_t const first = 2 * starts[ fidx ];
+            for( std::size_t k = 0; k + 1 < len; ++k )
+            {
+                std::size_t const v = first + 2 * k;
+                indices->push_back( v );
+                indices->push_back( v + 1 );
+                indices->push_back( v + 2 );
+                indices->push_back( v + 1 );
+                indices->push_back( v + 3 );
+                indices->push_back( v + 2 );
+            }
+        }
+        else
+        {
+            std::size_t const first = starts[ fidx ];
+            for( std::size_t k = 0; k + 1 < len; ++k )
+            {
+                indices->push_back( first + k );
+                indices->push_back( first + k + 1 );
+            }
+        }
+    }
+    return added;
+}
+
+#endif  // WGEFIBERGEOMETRYBUILDER_H
@@ -43,6 +43,21 @@
 #include "../common/datastructures/WUnionFind.h"
 #include "WTriangleMesh.h"
 
+namespace
+{
+    /**
+     * The main memory held by an OSG array.
+     *
+     * \param array the array, can be NULL
+     *
+     * \return the memory in bytes
+     */
+    size_t getArrayMemoryUsage( const osg::ref_ptr< osg::Array >& array )
+    {
+        return array ? array->getTotalDataSize() : 0;
+    }
+}
+
 // init _static_ member variable and provide a linker reference to it
 boost::shared_ptr< WPrototyped > WTriangleMesh::m_prototype = boost::shared_ptr< WPrototyped >();
 
@@ -356,6 +371,32 @@ size_t WTriangleMesh::triangleSize() const
     return m_countTriangles;
 }
 
+size_t WTriangleMesh::getMemoryUsage() const
+{
+    size_t usage = getArrayMemoryUsage( m_verts ) + getArrayMemoryUsage( m_textureCoordinates ) + getArrayMemoryUsage( m_vertNormals ) +
+                   getArrayMemoryUsage( m_vertFlatNormals ) + getArrayMemoryUsage( m_vertColors ) + getArrayMemoryUsage( m_triangleNormals ) +
+                   getArrayMemoryUsage( m_triangleColors ) + getArrayMemoryUsage( m_mainCurvaturePrincipalDirection ) +
+                   getArrayMemoryUsage( m_secondaryCurvaturePrincipalDirection );
+    usage += m_triangles.capacity() * sizeof( size_t );
+    for( size_t i = 0; i < m_vertexIsInTriangle.size(); ++i )
+    {
+        usage += m_vertexIsInTriangle[ i ].capacity() * sizeof( size_t );
+    }
+    for( size_t i = 0; i < m_triangleNeighbors.size(); ++i )
+    {
+        usage += m_triangleNeighbors[ i ].capacity() * sizeof( size_t );
+    }
+    if( m_mainNormalCurvature )
+    {
+        usage += m_mainNormalCurvature->capacity() * sizeof( float );
+    }
+    if( m_secondaryNormalCurvature )
+    {
+        usage += m_secondaryNormalCurvature->capacity() * sizeof( float );
+    }
+    return usage;
+}
+
 void WTriangleMesh::calcNeighbors()
 {
     std::vector<size_t> v( 3, -1 );
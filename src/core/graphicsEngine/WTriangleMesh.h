@@ -341,6 +341,14 @@ public:
      */
     size_t triangleSize() const;
 
+    /**
+     * The main memory held by the vertex, triangle and attribute arrays. The mesh grows incrementally and thus is not reserved in the memory
+     * budget.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const;
+
     /**
      * performs a loop subdivision on the triangle mesh
      */
@@ -0,0 +1,165 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WGEFIBERGEOMETRYBUILDER_TEST_H
+#define WGEFIBERGEOMETRYBUILDER_TEST_H
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WGEFiberGeometryBuilder.h"
+
+/**
+ * Tests for the index generation and the secondary colors of the WGEFiberGeometryBuilder.
+ */
+class WGEFiberGeometryBuilderTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Sets up three fibers with 3, 1 and 2 vertices.
+     */
+    void setUp( void )
+    {
+        m_starts.clear();
+        m_lengths.clear();
+        m_starts.push_back( 0 );
+        m_lengths.push_back( 3 );
+        m_starts.push_back( 3 );
+        m_lengths.push_back( 1 );
+        m_starts.push_back( 4 );
+        m_lengths.push_back( 2 );
+    }
+
+    /**
+     * Lines become one pair of indices per segment, fibers with a single vertex are skipped.
+     */
+    void testLineIndices( void )
+    {
+        std::vector< unsigned int > indices;
+        TS_ASSERT_EQUALS( WGEFiberGeometryBuilder::appendFiberIndices( m_starts, m_lengths, NULL, false, &indices ), 2 );
+
+        unsigned int const expected[] = { 0, 1, 1, 2, 4, 5 };
+        TS_ASSERT( indices == std::vector< unsigned int >( expected, expected + 6 ) );
+    }
+
+    /**
+     * Tubes become two triangles per segment on the doubled vertices.
+     */
+    void testTubeIndices( void )
+    {
+        std::vector< unsigned int > indices;
+        TS_ASSERT_EQUALS( WGEFiberGeometryBuilder::appendFiberIndices( m_starts, m_lengths, NULL, true, &indices ), 2 );
+        TS_ASSERT_EQUALS( indices.size(), 3 * 6 );
+
+        // the last segment connects the doubled vertices 4 and 5, i.e. 8, 9 and 10, 11
+        unsigned int const expected[] = { 8, 9, 10, 9, 11, 10 };
+        TS_ASSERT( std::vector< unsigned int >( indices.begin() + 12, indices.end() ) == std::vector< unsigned int >( expected, expected + 6 ) );
+    }
+
+    /**
+     * Only selected fibers get indices and the indices are appended.
+     */
+    void testSelection( void )
+    {
+        std::vector< bool > selection( 3, false );
+        selection[ 2 ] = true;
+
+        std::vector< unsigned int > indices( 1, 42 );
+        TS_ASSERT_EQUALS( WGEFiberGeometryBuilder::appendFiberIndices( m_starts, m_lengths, &selection, false, &indices ), 1 );
+
+        unsigned int const expected[] = { 42, 4, 5 };
+        TS_ASSERT( indices == std::vector< unsigned int >( expected, expected + 3 ) );
+    }
+
+    /**
+     * The cluster colors are kept apart from the ROI colors, so an ROI change does not overwrite them, and the ROI
+     * colors are shown again once the cluster colors are removed.
+     */
+    void testClusterColors( void )
+    {
+        WGEFiberGeometryBuilder builder( buildFibers(), false, true, WColor( 1.0, 1.0, 1.0, 1.0 ), WProgress::SPtr(), 1 );
+        osg::Vec3Array const& secondary = *static_cast< osg::Vec3Array const* >( builder.getGeometry()->getSecondaryColorArray() );
+        TS_ASSERT_EQUALS( secondary.size(), 6 );
+
+        osg::Vec3 const clusterColor( 0.0f, 1.0f, 0.0f );
+        builder.setClusterColors( std::vector< osg::Vec3 >( 3, clusterColor ) );
+
+        // an ROI change updates the selection and the ROI colors
+        std::vector< bool > selection( 3, true );
+        selection[ 1 ] = false;
+        osg::Vec3 const roiColor( 1.0f, 0.0f, 0.0f );
+        builder.select( selection );
+        builder.setFiberColors( std::vector< osg::Vec3 >( 3, roiColor ) );
+        for( std::size_t v = 0; v < secondary.size(); ++v )
+        {
+            TS_ASSERT( secondary[ v ] == clusterColor );
+        }
+
+        builder.setClusterColors( std::vector< osg::Vec3 >() );
+        for( std::size_t v = 0; v < secondary.size(); ++v )
+        {
+            TS_ASSERT( secondary[ v ] == roiColor );
+        }
+    }
+
+private:
+    /**
+     * Creates fibers with the vertex counts of m_starts and m_lengths along the x axis.
+     *
+     * \return the fibers
+     */
+    boost::shared_ptr< WDataSetFibers > buildFibers()
+    {
+        boost::shared_ptr< std::vector< float > > vertices( new std::vector< float > );
+        boost::shared_ptr< std::vector< std::size_t > > starts( new std::vector< std::size_t >( m_starts ) );
+        boost::shared_ptr< std::vector< std::size_t > > lengths( new std::vector< std::size_t >( m_lengths ) );
+        boost::shared_ptr< std::vector< std::size_t > > verticesReverse( new std::vector< std::size_t > );
+        for( std::size_t fidx = 0; fidx < m_starts.size(); ++fidx )
+        {
+            for( std::size_t k = 0; k < m_lengths[ fidx ]; ++k )
+            {
+                vertices->push_back( static_cast< float >( k ) );
+                vertices->push_back( static_cast< float >( fidx ) );
+                vertices->push_back( 0.0f );
+                verticesReverse->push_back( fidx );
+            }
+        }
+        return boost::shared_ptr< WDataSetFibers >( new WDataSetFibers( vertices, starts, lengths, verticesReverse ) );
+    }
+
+    /**
+     * The start index of every fiber.
+     */
+    std::vector< std::size_t > m_starts;
+
+    /**
+     * The number of vertices of every fiber.
+     */
+    std::vector< std::size_t > m_lengths;
+};
+
+#endif  // WGEFIBERGEOMETRYBUILDER_TEST_H
@@ -55,6 +55,7 @@
 #include "../common/WPathHelper.h"
 #include "../common/WProgressCombiner.h"
 #include "../common/WPredicateHelper.h"
+#include "../common/WTraceScope.h"
 
 #include "WModule.h"
 
@@ -93,6 +94,7 @@ WModule::WModule():
 
     m_container = boost::shared_ptr< WModuleContainer >();
     m_progress = boost::shared_ptr< WProgressCombiner >( new WProgressCombiner() );
+    m_profile = WModuleProfile::SPtr( new WModuleProfile() );
 
     // add a progress indicator which finishes on "ready()"
     m_progress->addSubProgress( m_readyProgress );
@@ -491,6 +493,25 @@ boost::shared_ptr< WProgressCombiner > WModule::getRootProgressCombiner()
     return m_progress;
 }
 
+WModuleProfile::SPtr WModule::getProfile() const
+{
+    return m_profile;
+}
+
+size_t WModule::getMemoryUsage() const
+{
+    size_t usage = 0;
+    for( OutputConnectorList::const_iterator i = m_outputConnectors.begin(); i != m_outputConnectors.end(); ++i )
+    {
+        boost::shared_ptr< WTransferable > data = ( *i )->getRawData();
+        if( data )
+        {
+            usage += data->getMemoryUsage();
+        }
+    }
+    return usage;
+}
+
 const char** WModule::getXPMIcon() const
 {
     // return empty 1x1 icon by default.
@@ -537,7 +558,12 @@ void WModule::threadMain()
 
     // call main thread function
     m_isRunning( true );
-    moduleMain();
+    m_profile->start();
+    {
+        WTRACE_SCOPE( "module", "moduleMain" );
+        moduleMain();
+    }
+    m_profile->finish();
 
     // NOTE: if there is any exception in the module thread, WThreadedRunner calls onThreadException for us. We can then disconnect the
     // module and call our own error notification mechanism.
@@ -557,6 +583,7 @@ void WModule::onThreadException( const WException& e )
     disconnect();
 
     // module is not running anymore.
+    m_profile->finish();
     m_isRunning( false );
 
     // let WThreadedRunner do the remaining tasks.
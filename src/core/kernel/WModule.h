@@ -53,6 +53,7 @@
 #include "WModuleSignals.h"
 #include "WModuleTypes.h"
 #include "WModuleMetaInformation.h"
+#include "WModuleProfile.h"
 
 class WModuleConnector;
 class WModuleContainer;
@@ -324,6 +325,21 @@ public:
      */
     virtual boost::shared_ptr< WProgressCombiner > getRootProgressCombiner();
 
+    /**
+     * Gets the timing and memory profile of this module. It gets filled while the module is running.
+     *
+     * \return the profile
+     */
+    WModuleProfile::SPtr getProfile() const;
+
+    /**
+     * The main memory held by the data this module currently provides at its outputs. Data at the inputs is accounted at the module providing
+     * it.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const;
+
     /**
      * Get the icon for this module in XPM format.
      * \return The icon.
@@ -653,6 +669,11 @@ protected:
      */
     boost::shared_ptr< WProgressCombiner > m_progress;
 
+    /**
+     * Where the module spends its time.
+     */
+    WModuleProfile::SPtr m_profile;
+
     /**
      * True if everything is initialized and ready to be used.
      */
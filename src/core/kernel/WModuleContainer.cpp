@@ -521,6 +521,17 @@ WModuleContainer::ModuleSharedContainerType::ReadTicket WModuleContainer::getMod
     return m_modules.getReadTicket();
 }
 
+size_t WModuleContainer::getMemoryUsage() const
+{
+    size_t usage = WModule::getMemoryUsage();
+    ModuleSharedContainerType::ReadTicket lock = m_modules.getReadTicket();
+    for( ModuleConstIterator i = lock->get().begin(); i != lock->get().end(); ++i )
+    {
+        usage += ( *i )->getMemoryUsage();
+    }
+    return usage;
+}
+
 WModuleContainer::ModuleVectorType WModuleContainer::getModules( std::string name ) const
 {
     // get the list of all first.
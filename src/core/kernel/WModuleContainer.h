@@ -282,6 +282,13 @@ public:
      */
     ModuleSharedContainerType::ReadTicket getModules() const;
 
+    /**
+     * The main memory held by the outputs of all modules in this container, including nested containers.
+     *
+     * \return the memory in bytes
+     */
+    virtual size_t getMemoryUsage() const;
+
     /**
      * Queries the container to find all modules with a given name. This can be useful to check for existence of certain modules inside the
      * container.
@@ -62,7 +62,7 @@ void WModuleFactory::load()
     // load modules
     WLogger::getLogger()->addLogMessage( "Loading Modules", "ModuleFactory", LL_INFO );
 
-    // operation must be exclusive
+    // operation must be exclusive. The loaded prototypes get published when the ticket is released, readers see the old set until then.
     PrototypeSharedContainerType::WriteTicket l = m_prototypes.getWriteTicket();
 
     // Load the dynamic modules here:
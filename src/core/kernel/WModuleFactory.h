@@ -35,6 +35,7 @@
 #include <boost/weak_ptr.hpp>
 
 #include "../common/WSharedAssociativeContainer.h"
+#include "../common/WSharedObjectRCU.h"
 #include "WModuleCombinerTypes.h"
 #include "WModule.h"
 #include "WDataModule.h"
@@ -73,9 +74,9 @@ public:
     typedef std::set< boost::shared_ptr< WModule > >::iterator PrototypeContainerIteratorType;
 
     /**
-     * The alias for a shared container.
+     * The alias for a shared container. The prototypes are read very often but only written on load. Readers do not need to lock.
      */
-    typedef WSharedAssociativeContainer< PrototypeContainerType > PrototypeSharedContainerType;
+    typedef WSharedObjectRCU< PrototypeContainerType > PrototypeSharedContainerType;
 
     /**
      * Destructor.
@@ -84,6 +85,10 @@ public:
 
     /**
      * Loads the modules and creates prototypes.
+     *
+     * \note The prototypes are published at once when loading is complete. Readers do not block during loading, as they did with a locked
+     * container. They see the previous prototype set instead, which is empty at startup. The kernel loads the modules before it starts any
+     * thread that uses the factory, so this only matters for other callers.
      */
     void load();
 
@@ -25,6 +25,7 @@
 #include <string>
 
 #include "../common/WCondition.h"
+#include "WModule.h"
 #include "WModuleConnectorSignals.h"
 #include "WModuleOutputConnector.h"
 
@@ -107,6 +108,12 @@ void WModuleInputConnector::notifyDataChange( boost::shared_ptr<WModuleConnector
 {
     setUpdated();
 
+    boost::shared_ptr< WModule > module = m_module.lock();
+    if( module )
+    {
+        module->getProfile()->inputChanged();
+    }
+
     // since the output connector is not able to fill the parameter "input" we need to forward this message and fill it with the
     // proper information
     signal_DataChanged( shared_from_this(), output );
@@ -32,7 +32,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/shared_ptr.hpp>
 
-#include "../common/WSharedAssociativeContainer.h"
+#include "../common/WSharedObjectRCU.h"
 #include "../common/WSharedLib.h"
 
 #include "WModule.h"
@@ -69,7 +69,7 @@ public:
      *
      * \param ticket A write ticket to a shared container.
      */
-    void load( WSharedAssociativeContainer< std::set< boost::shared_ptr< WModule > > >::WriteTicket ticket );
+    void load( WSharedObjectRCU< std::set< boost::shared_ptr< WModule > > >::WriteTicket ticket );
 
     /**
      * Returns the prefix of a shared module library filename.
@@ -98,7 +98,7 @@ private:
      * \param dir the directory to load
      * \param level the traversion level
      */
-    void load( WSharedAssociativeContainer< std::set< boost::shared_ptr< WModule > > >::WriteTicket ticket, boost::filesystem::path dir,
+    void load( WSharedObjectRCU< std::set< boost::shared_ptr< WModule > > >::WriteTicket ticket, boost::filesystem::path dir,
                unsigned int level = 0 );
 
     /**
@@ -28,6 +28,7 @@
 #include <boost/signals2/connection.hpp>
 
 #include "../common/WCondition.h"
+#include "WModule.h"
 #include "WModuleConnectorSignals.h"
 #include "WModuleInputConnector.h"
 
@@ -80,6 +81,12 @@ boost::signals2::connection WModuleOutputConnector::subscribeSignal( MODULE_CONN
 
 void WModuleOutputConnector::propagateDataChange()
 {
+    boost::shared_ptr< WModule > module = m_module.lock();
+    if( module )
+    {
+        module->getProfile()->outputUpdated( getName() );
+    }
+
     signal_DataChanged( boost::shared_ptr<WModuleConnector>(), shared_from_this() );
     m_dataChangedCondition->notify();
 }
@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <string>
+
+#include "WModuleProfile.h"
+
+WModuleProfile::ConnectorStatistics::ConnectorStatistics():
+    m_updates( 0 ),
+    m_wallTime( 0.0 ),
+    m_maxWallTime( 0.0 ),
+    m_cpuTime( 0.0 )
+{
+    // initialize
+}
+
+WModuleProfile::WModuleProfile():
+    m_started( false ),
+    m_finished( false ),
+    m_wallTime( 0.0 ),
+    m_startCPU( 0.0 ),
+    m_lastCPU( 0.0 ),
+    m_lastMark( 0.0 ),
+    m_startPeak( 0 ),
+    m_lastPeak( 0 )
+{
+    // initialize
+}
+
+WModuleProfile::~WModuleProfile()
+{
+    // cleanup
+}
+
+void WModuleProfile::start()
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    m_timer.reset();
+    m_cpuClock = WThreadCPUClock();
+    m_started = true;
+    m_finished = false;
+    m_wallTime = 0.0;
+    m_startCPU = std::max( m_cpuClock.getTime(), 0.0 );
+    m_lastCPU = m_startCPU;
+    m_lastMark = 0.0;
+    m_startPeak = getPeakMemoryUsage();
+    m_lastPeak = m_startPeak;
+    m_connectors.clear();
+}
+
+void WModuleProfile::finish()
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    if( !m_started || m_finished )
+    {
+        return;
+    }
+
+    m_finished = true;
+    m_wallTime = m_timer.elapsed();
+    double threadCPU = m_cpuClock.getTime();
+    if( threadCPU >= 0.0 )
+    {
+        m_lastCPU = threadCPU;
+    }
+    m_lastPeak = getPeakMemoryUsage();
+}
+
+void WModuleProfile::inputChanged()
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    m_lastMark = m_timer.elapsed();
+}
+
+void WModuleProfile::outputUpdated( const std::string& connector )
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    if( !m_started || m_finished )
+    {
+        return;
+    }
+
+    double now = m_timer.elapsed();
+    double wall = now - m_lastMark;
+    m_lastMark = now;
+
+    double cpu = 0.0;
+    double threadCPU = m_cpuClock.getTime();
+    if( threadCPU >= 0.0 )
+    {
+        cpu = threadCPU - m_lastCPU;
+        m_lastCPU = threadCPU;
+    }
+    m_lastPeak = getPeakMemoryUsage();
+
+    ConnectorStatistics& stats = m_connectors[ connector ];
+    stats.m_updates++;
+    stats.m_wallTime += wall;
+    stats.m_cpuTime += cpu;
+    stats.m_maxWallTime = std::max( stats.m_maxWallTime, wall );
+}
+
+bool WModuleProfile::isRunning() const
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    return m_started && !m_finished;
+}
+
+double WModuleProfile::getWallTime() const
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    if( !m_started )
+    {
+        return 0.0;
+    }
+    return m_finished ? m_wallTime : m_timer.elapsed();
+}
+
+double WModuleProfile::getCPUTime() const
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    if( m_started && !m_finished )
+    {
+        // the module thread is alive, so its clock can be read
+        double threadCPU = m_cpuClock.getTime();
+        if( threadCPU >= 0.0 )
+        {
+            return threadCPU - m_startCPU;
+        }
+    }
+    return m_lastCPU - m_startCPU;
+}
+
+size_t WModuleProfile::getProcessPeakMemory() const
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    return m_lastPeak;
+}
+
+size_t WModuleProfile::getProcessPeakMemoryIncrease() const
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    return m_lastPeak - m_startPeak;
+}
+
+WModuleProfile::ConnectorStatisticsMap WModuleProfile::getConnectorStatistics() const
+{
+    boost::lock_guard< boost::mutex > lock( m_mutex );
+    return m_connectors;
+}
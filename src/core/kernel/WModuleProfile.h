@@ -0,0 +1,236 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMODULEPROFILE_H
+#define WMODULEPROFILE_H
+
+#include <map>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "../common/WRealtimeTimer.h"
+#include "../common/WResourceUsage.h"
+
+/**
+ * Records where a module spends its time. It measures wall time and CPU time of the module thread as well as statistics for each update of
+ * the output connectors. It is filled by \ref WModule and \ref WModuleOutputConnector automatically. All methods are thread-safe.
+ *
+ * \note CPU times only cover the module thread, not the worker threads a module starts. Memory cannot be measured per thread, so the
+ * memory values describe the whole process and include all modules running at the same time.
+ */
+class WModuleProfile
+{
+public:
+    /**
+     * Convenience typedef for a boost::shared_ptr< WModuleProfile >.
+     */
+    typedef boost::shared_ptr< WModuleProfile > SPtr;
+
+    /**
+     * Convenience typedef for a boost::shared_ptr< const WModuleProfile >.
+     */
+    typedef boost::shared_ptr< const WModuleProfile > ConstSPtr;
+
+    /**
+     * Statistics of the updates of a single output connector.
+     */
+    struct ConnectorStatistics
+    {
+        /**
+         * Constructor. Initializes everything with zero.
+         */
+        ConnectorStatistics();
+
+        /**
+         * How often the connector was updated.
+         */
+        size_t m_updates;
+
+        /**
+         * The summed wall time of all updates. The time of an update is measured from the last input change (or the previous output update)
+         * to the output update.
+         */
+        double m_wallTime;
+
+        /**
+         * The longest wall time of a single update.
+         */
+        double m_maxWallTime;
+
+        /**
+         * The summed CPU time the module thread consumed for all updates. Each update counts the CPU time since the previous update of any
+         * connector of the module.
+         */
+        double m_cpuTime;
+    };
+
+    /**
+     * Maps the connector name to its statistics.
+     */
+    typedef std::map< std::string, ConnectorStatistics > ConnectorStatisticsMap;
+
+    /**
+     * Constructor.
+     */
+    WModuleProfile();
+
+    /**
+     * Destructor.
+     */
+    virtual ~WModuleProfile();
+
+    /**
+     * Marks the start of the module thread. Needs to be called by the module thread.
+     */
+    void start();
+
+    /**
+     * Marks the end of the module thread. Needs to be called by the module thread.
+     */
+    void finish();
+
+    /**
+     * Notifies the profile about new data at one of the inputs. Can be called by any thread.
+     */
+    void inputChanged();
+
+    /**
+     * Notifies the profile about an update of an output connector. Can be called by any thread, the CPU time is read from the clock of the
+     * module thread. On platforms which cannot read the clock of another thread, CPU time is only accounted if this is called by the
+     * module thread.
+     *
+     * \param connector the name of the updated connector
+     */
+    void outputUpdated( const std::string& connector );
+
+    /**
+     * True if the module thread has been started and is not yet finished.
+     *
+     * \return true if running
+     */
+    bool isRunning() const;
+
+    /**
+     * The wall time of the module thread. If it is still running, this is the time since its start.
+     *
+     * \return the time in seconds
+     */
+    double getWallTime() const;
+
+    /**
+     * The CPU time of the module thread. If it is still running, this is the CPU time until now, or until the last output update on
+     * platforms which cannot read the clock of another thread.
+     *
+     * \return the time in seconds
+     */
+    double getCPUTime() const;
+
+    /**
+     * The peak memory usage of the whole process when the module finished, or at the last output update if still running. This is a
+     * process-level value, not the memory of this module.
+     *
+     * \return the memory in bytes
+     */
+    size_t getProcessPeakMemory() const;
+
+    /**
+     * How much the peak memory usage of the whole process grew while the module was running. This is a process-level value: it includes
+     * the allocations of all modules running at the same time and it is 0 if the module stays below an earlier peak of the process.
+     *
+     * \return the memory in bytes
+     */
+    size_t getProcessPeakMemoryIncrease() const;
+
+    /**
+     * The statistics of all output connectors updated so far.
+     *
+     * \return a copy of the statistics.
+     */
+    ConnectorStatisticsMap getConnectorStatistics() const;
+
+private:
+    /**
+     * Protects all members.
+     */
+    mutable boost::mutex m_mutex;
+
+    /**
+     * Measures wall time since start.
+     */
+    WRealtimeTimer m_timer;
+
+    /**
+     * The CPU time clock of the module thread.
+     */
+    WThreadCPUClock m_cpuClock;
+
+    /**
+     * True after start().
+     */
+    bool m_started;
+
+    /**
+     * True after finish().
+     */
+    bool m_finished;
+
+    /**
+     * Wall time when finish() was called.
+     */
+    double m_wallTime;
+
+    /**
+     * Thread CPU time when start() was called.
+     */
+    double m_startCPU;
+
+    /**
+     * Thread CPU time at the last start(), output update or finish(). Output updates measure their CPU time from here.
+     */
+    double m_lastCPU;
+
+    /**
+     * Wall time at the last input change or output update. The next output update is measured from here.
+     */
+    double m_lastMark;
+
+    /**
+     * Process peak memory at start().
+     */
+    size_t m_startPeak;
+
+    /**
+     * Process peak memory at the last output update or finish().
+     */
+    size_t m_lastPeak;
+
+    /**
+     * Statistics of each output connector.
+     */
+    ConnectorStatisticsMap m_connectors;
+};
+
+#endif  // WMODULEPROFILE_H
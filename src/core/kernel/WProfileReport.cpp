@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/WResourceUsage.h"
+#include "WModule.h"
+#include "WModuleContainer.h"
+
+#include "core/WVersion.h"   // NOTE: this file is auto-generated by CMAKE
+
+#include "WProfileReport.h"
+
+namespace
+{
+    /**
+     * Quotes and escapes a string for use in JSON.
+     *
+     * \param s the string
+     *
+     * \return the quoted string
+     */
+    std::string quote( const std::string& s )
+    {
+        std::ostringstream out;
+        out << "\"";
+        for( std::string::const_iterator i = s.begin(); i != s.end(); ++i )
+        {
+            switch( *i )
+            {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                case '\t':
+                    out << "\\t";
+                    break;
+                default:
+                    if( static_cast< unsigned char >( *i ) < 0x20 )
+                    {
+                        out << "\\u" << std::hex << std::setw( 4 ) << std::setfill( '0' ) << static_cast< int >( *i ) << std::dec;
+                    }
+                    else
+                    {
+                        out << *i;
+                    }
+            }
+        }
+        out << "\"";
+        return out.str();
+    }
+}
+
+WProfileReport::ModuleRecord::ModuleRecord():
+    m_running( false ),
+    m_wallTime( 0.0 ),
+    m_cpuTime( 0.0 ),
+    m_processPeakMemory( 0 ),
+    m_processPeakMemoryIncrease( 0 ),
+    m_dataMemory( 0 )
+{
+    // initialize
+}
+
+WProfileReport::WProfileReport()
+{
+    // initialize
+}
+
+WProfileReport::~WProfileReport()
+{
+    // cleanup
+}
+
+void WProfileReport::addRun( const std::string& subject, double wallTime, double cpuTime, boost::shared_ptr< WModuleContainer > container )
+{
+    std::vector< ModuleRecord > modules;
+    WModuleContainer::ModuleSharedContainerType::ReadTicket r = container->getModules();
+    for( WModuleContainer::ModuleConstIterator iter = r->get().begin(); iter != r->get().end(); ++iter )
+    {
+        if( m_recorded.count( ( *iter )->getUUID() ) )
+        {
+            continue;
+        }
+        m_recorded.insert( ( *iter )->getUUID() );
+
+        WModuleProfile::SPtr profile = ( *iter )->getProfile();
+        ModuleRecord module;
+        module.m_name = ( *iter )->getName();
+        module.m_uuid = ( *iter )->getUUID();
+        module.m_running = profile->isRunning();
+        module.m_wallTime = profile->getWallTime();
+        module.m_cpuTime = profile->getCPUTime();
+        module.m_processPeakMemory = profile->getProcessPeakMemory();
+        module.m_processPeakMemoryIncrease = profile->getProcessPeakMemoryIncrease();
+        module.m_dataMemory = ( *iter )->getMemoryUsage();
+        module.m_connectors = profile->getConnectorStatistics();
+        modules.push_back( module );
+    }
+    r.reset();
+
+    addRun( subject, wallTime, cpuTime, modules );
+}
+
+void WProfileReport::addRun( const std::string& subject, double wallTime, double cpuTime, const std::vector< ModuleRecord >& modules )
+{
+    RunRecord run;
+    run.m_subject = subject;
+    run.m_wallTime = wallTime;
+    run.m_cpuTime = cpuTime;
+    run.m_processPeakMemory = getPeakMemoryUsage();
+    run.m_modules = modules;
+    m_runs.push_back( run );
+}
+
+void WProfileReport::write( std::ostream& out ) const // NOLINT non-const reference
+{
+    out << "{" << std::endl;
+    out << "  \"version\": " << quote( W_VERSION ) << "," << std::endl;
+    out << "  \"runs\": [";
+    for( size_t r = 0; r < m_runs.size(); ++r )
+    {
+        const RunRecord& run = m_runs[ r ];
+        out << ( r ? "," : "" ) << std::endl;
+        out << "    {" << std::endl;
+        out << "      \"subject\": " << quote( run.m_subject ) << "," << std::endl;
+        out << "      \"wallTime\": " << run.m_wallTime << "," << std::endl;
+        out << "      \"cpuTime\": " << run.m_cpuTime << "," << std::endl;
+        out << "      \"processPeakMemory\": " << run.m_processPeakMemory << "," << std::endl;
+        out << "      \"modules\": [";
+        for( size_t m = 0; m < run.m_modules.size(); ++m )
+        {
+            const ModuleRecord& module = run.m_modules[ m ];
+            out << ( m ? "," : "" ) << std::endl;
+            out << "        {" << std::endl;
+            out << "          \"name\": " << quote( module.m_name ) << "," << std::endl;
+            out << "          \"uuid\": " << quote( module.m_uuid ) << "," << std::endl;
+            out << "          \"running\": " << ( module.m_running ? "true" : "false" ) << "," << std::endl;
+            out << "          \"wallTime\": " << module.m_wallTime << "," << std::endl;
+            out << "          \"cpuTime\": " << module.m_cpuTime << "," << std::endl;
+            out << "          \"processPeakMemory\": " << module.m_processPeakMemory << "," << std::endl;
+            out << "          \"processPeakMemoryIncrease\": " << module.m_processPeakMemoryIncrease << "," << std::endl;
+            out << "          \"dataMemory\": " << module.m_dataMemory << "," << std::endl;
+            out << "          \"connectorUpdates\": [";
+            size_t c = 0;
+            for( WModuleProfile::ConnectorStatisticsMap::const_iterator iter = module.m_connectors.begin(); iter != module.m_connectors.end();
+                 ++iter, ++c )
+            {
+                out << ( c ? "," : "" ) << std::endl;
+                out << "            { \"connector\": " << quote( iter->first )
+                    << ", \"updates\": " << iter->second.m_updates
+                    << ", \"wallTime\": " << iter->second.m_wallTime
+                    << ", \"maxWallTime\": " << iter->second.m_maxWallTime
+                    << ", \"cpuTime\": " << iter->second.m_cpuTime << " }";
+            }
+            out << ( c ? "\n          " : "" ) << "]" << std::endl;
+            out << "        }";
+        }
+        out << ( run.m_modules.empty() ? "" : "\n      " ) << "]" << std::endl;
+        out << "    }";
+    }
+    out << ( m_runs.empty() ? "" : "\n  " ) << "]" << std::endl;
+    out << "}" << std::endl;
+}
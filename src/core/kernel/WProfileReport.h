@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WPROFILEREPORT_H
+#define WPROFILEREPORT_H
+
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "WModuleProfile.h"
+
+class WModuleContainer;
+
+/**
+ * Collects the module profiles of batch runs and writes them as machine-readable JSON report. Each run (usually one input subject) is recorded
+ * with its total wall time, process CPU time and peak memory as well as the profiles of all modules created during the run.
+ */
+class WProfileReport
+{
+public:
+    /**
+     * The profile of a single module.
+     */
+    struct ModuleRecord
+    {
+        /**
+         * Constructor. Initializes all values with zero.
+         */
+        ModuleRecord();
+
+        /**
+         * The module's name.
+         */
+        std::string m_name;
+
+        /**
+         * The module's UUID.
+         */
+        std::string m_uuid;
+
+        /**
+         * True if the module was still running when recorded.
+         */
+        bool m_running;
+
+        /**
+         * Wall time of the module thread.
+         */
+        double m_wallTime;
+
+        /**
+         * CPU time of the module thread.
+         */
+        double m_cpuTime;
+
+        /**
+         * Peak memory of the whole process when the module finished. See WModuleProfile::getProcessPeakMemory.
+         */
+        size_t m_processPeakMemory;
+
+        /**
+         * Growth of the peak memory of the whole process while the module was running. See WModuleProfile::getProcessPeakMemoryIncrease.
+         */
+        size_t m_processPeakMemoryIncrease;
+
+        /**
+         * Memory held by the module's outputs at the end of the run. See WModule::getMemoryUsage.
+         */
+        size_t m_dataMemory;
+
+        /**
+         * Statistics of each output connector.
+         */
+        WModuleProfile::ConnectorStatisticsMap m_connectors;
+    };
+
+    /**
+     * Constructor.
+     */
+    WProfileReport();
+
+    /**
+     * Destructor.
+     */
+    virtual ~WProfileReport();
+
+    /**
+     * Records a finished run. All modules of the container which have not been recorded by a previous run are assigned to this run.
+     *
+     * \param subject the name of the run, usually the input subject
+     * \param wallTime the wall time of the run in seconds
+     * \param cpuTime the CPU time of the whole process during the run in seconds
+     * \param container the container whose modules should be recorded
+     */
+    void addRun( const std::string& subject, double wallTime, double cpuTime, boost::shared_ptr< WModuleContainer > container );
+
+    /**
+     * Records a finished run with the given module profiles.
+     *
+     * \param subject the name of the run, usually the input subject
+     * \param wallTime the wall time of the run in seconds
+     * \param cpuTime the CPU time of the whole process during the run in seconds
+     * \param modules the profiles of the modules of this run
+     */
+    void addRun( const std::string& subject, double wallTime, double cpuTime, const std::vector< ModuleRecord >& modules );
+
+    /**
+     * Writes the report as JSON.
+     *
+     * \param out the stream to write to
+     */
+    void write( std::ostream& out ) const; // NOLINT non-const reference
+
+private:
+    /**
+     * A run with all its modules.
+     */
+    struct RunRecord
+    {
+        /**
+         * The name of the run.
+         */
+        std::string m_subject;
+
+        /**
+         * Wall time of the run.
+         */
+        double m_wallTime;
+
+        /**
+         * Process CPU time during the run.
+         */
+        double m_cpuTime;
+
+        /**
+         * Process peak memory after the run.
+         */
+        size_t m_processPeakMemory;
+
+        /**
+         * The modules created during the run.
+         */
+        std::vector< ModuleRecord > m_modules;
+    };
+
+    /**
+     * All recorded runs.
+     */
+    std::vector< RunRecord > m_runs;
+
+    /**
+     * UUIDs of all modules already assigned to a run.
+     */
+    std::set< std::string > m_recorded;
+};
+
+#endif  // WPROFILEREPORT_H
@@ -22,6 +22,7 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <list>
 #include <string>
 #include <vector>
@@ -90,56 +91,55 @@ void WRMBranch::addRoi( osg::ref_ptr< WROI > roi )
 
 bool WRMBranch::contains( osg::ref_ptr< WROI > roi )
 {
-    for( std::vector< osg::ref_ptr< WROI > >::iterator iter = m_rois.begin(); iter != m_rois.end(); ++iter )
-    {
-        if( ( *iter ) == roi )
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_rois.count( roi ) > 0;
 }
 
 void WRMBranch::removeRoi( osg::ref_ptr< WROI > roi )
 {
     roi->removeROIChangeNotifier( m_changeRoiSignal );
-    for( std::vector< osg::ref_ptr< WROI > >::iterator iter = m_rois.begin(); iter != m_rois.end(); ++iter )
+    bool removed = false;
     {
-        if( ( *iter ) == roi )
+        ROIList::WriteTicket w = m_rois.getWriteTicket();
+        std::vector< osg::ref_ptr< WROI > >::iterator iter = std::find( w->get().begin(), w->get().end(), roi );
+        if( iter != w->get().end() )
         {
-            m_rois.erase( iter );
-            setDirty();
-            break;
+            w->get().erase( iter );
+            removed = true;
+        }
+        else
+        {
+            w->suppressUnlockCondition();
         }
     }
+
+    // notify after publishing, the notifiers might read the ROIs
+    if( removed )
+    {
+        setDirty();
+    }
 }
 
 void WRMBranch::getRois( std::vector< osg::ref_ptr< WROI > >& roiVec ) // NOLINT
 {
-    for( std::vector< osg::ref_ptr< WROI > >::iterator iter = m_rois.begin(); iter != m_rois.end(); ++iter )
-    {
-        roiVec.push_back( ( *iter ) );
-    }
+    ROIList::ReadTicket r = m_rois.getReadTicket();
+    roiVec.insert( roiVec.end(), r->get().begin(), r->get().end() );
 }
 
 WROIManager::ROIs WRMBranch::getRois() const
 {
-    WROIManager::ROIs ret;
-    for( std::vector< osg::ref_ptr< WROI > >::const_iterator iter = m_rois.begin(); iter != m_rois.end(); ++iter )
-    {
-        ret.push_back( ( *iter ) );
-    }
-    return ret;
+    ROIList::ReadTicket r = m_rois.getReadTicket();
+    return WROIManager::ROIs( r->get().begin(), r->get().end() );
 }
 
 void WRMBranch::removeAllRois()
 {
-    for( std::vector< osg::ref_ptr< WROI > >::iterator iter = m_rois.begin(); iter != m_rois.end(); ++iter )
+    std::vector< osg::ref_ptr< WROI > > removed;
+    m_rois.getWriteTicket()->get().swap( removed );
+
+    for( std::vector< osg::ref_ptr< WROI > >::iterator iter = removed.begin(); iter != removed.end(); ++iter )
     {
         WGraphicsEngine::getGraphicsEngine()->getScene()->remove( ( *iter ) );
     }
-
-    m_rois.clear();
 }
 
 void WRMBranch::setDirty()
@@ -156,7 +156,7 @@ void WRMBranch::setDirty()
 
 osg::ref_ptr< WROI > WRMBranch::getFirstRoi()
 {
-    return m_rois.front();
+    return m_rois.getReadTicket()->get().front();
 }
 
 boost::shared_ptr< WROIManager > WRMBranch::getRoiManager()
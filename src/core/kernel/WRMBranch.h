@@ -33,6 +33,8 @@
 #include <boost/enable_shared_from_this.hpp>
 
 #include "../common/WProperties.h"
+#include "../common/WSharedObjectRCU.h"
+#include "../common/WSharedSequenceContainer.h"
 
 #include "../graphicsEngine/WROI.h"
 
@@ -218,8 +220,13 @@ protected:
 private:
     boost::shared_ptr< WROIManager > m_roiManager; //!< stores a pointer to the roi manager
 
-    std::vector< osg::ref_ptr< WROI > > m_rois; //!< list of rois in this this branch,
-                                                  // first in the list is the master roi
+    /**
+     * The ROI list. It is read by the fiber selection for every update but changes rarely, so readers use read-copy-update snapshots.
+     */
+    typedef WSharedSequenceContainer< std::vector< osg::ref_ptr< WROI > >, WSharedObjectRCU< std::vector< osg::ref_ptr< WROI > > > > ROIList;
+
+    ROIList m_rois; //!< list of rois in this this branch,
+                    // first in the list is the master roi
     /**
      * the property object for the module
      */
@@ -257,7 +264,7 @@ private:
 
 inline bool WRMBranch::empty()
 {
-    return m_rois.empty();
+    return m_rois.getReadTicket()->get().empty();
 }
 
 inline bool WRMBranch::dirty( bool reset )
@@ -279,7 +286,7 @@ template < typename Comparator >
 void WRMBranch::sort( Comparator comp )
 {
     // NOTE: technically, we need not setDirty here as the order of the ROIs has no influence
-    return std::sort( m_rois.begin(), m_rois.end(), comp );
+    m_rois.sort( comp );
 }
 
 #endif  // WRMBRANCH_H
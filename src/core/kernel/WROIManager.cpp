@@ -72,14 +72,7 @@ boost::shared_ptr< WRMBranch > WROIManager::addBranch()
 void WROIManager::addRoi( osg::ref_ptr< WROI > newRoi, osg::ref_ptr< WROI > parentRoi )
 {
     // find branch
-    boost::shared_ptr< WRMBranch > branch;
-    for( std::list< boost::shared_ptr< WRMBranch > >::iterator iter = m_branches.begin(); iter != m_branches.end(); ++iter )
-    {
-        if( ( *iter ).get()->contains( parentRoi ) )
-        {
-            branch = ( *iter );
-        }
-    }
+    boost::shared_ptr< WRMBranch > branch = getBranch( parentRoi );
     // add roi to branch
     branch->addRoi( newRoi );
 
@@ -94,23 +87,24 @@ void WROIManager::removeRoi( osg::ref_ptr< WROI > roi )
 {
     WGraphicsEngine::getGraphicsEngine()->getScene()->remove( roi );
 
-    for( std::list< boost::shared_ptr< WRMBranch > >::iterator iter = m_branches.begin(); iter != m_branches.end(); ++iter )
+    boost::shared_ptr< WRMBranch > emptyBranch;
     {
-        ( *iter )->removeRoi( roi );
-
-        if( ( *iter )->empty() )
+        BranchList::ReadTicket r = m_branches.getReadTicket();
+        for( BranchList::ConstIterator iter = r->get().begin(); iter != r->get().end(); ++iter )
         {
-            for( std::list< boost::shared_ptr< boost::function< void( boost::shared_ptr< WRMBranch > ) > > >::iterator iter2
-                      = m_removeBranchNotifiers.begin();
-                  iter2 != m_removeBranchNotifiers.end();
-                  ++iter2 )
+            ( *iter )->removeRoi( roi );
+
+            if( ( *iter )->empty() )
             {
-                ( **iter2 )( *iter );
+                emptyBranch = *iter;
+                break;
             }
-            m_branches.erase( iter );
-            break;
         }
     }
+    if( emptyBranch )
+    {
+        removeEmptyBranch( emptyBranch );
+    }
     setDirty();
 
     for( std::list< boost::shared_ptr< boost::function< void( osg::ref_ptr< WROI > ) > > >::iterator iter
@@ -124,34 +118,49 @@ void WROIManager::removeRoi( osg::ref_ptr< WROI > roi )
 
 void WROIManager::removeBranch( osg::ref_ptr< WROI > roi )
 {
-    for( std::list< boost::shared_ptr< WRMBranch > >::iterator iter = m_branches.begin(); iter != m_branches.end(); ++iter )
+    boost::shared_ptr< WRMBranch > emptyBranch;
     {
-        if( roi == ( *iter )->getFirstRoi() )
+        BranchList::ReadTicket r = m_branches.getReadTicket();
+        for( BranchList::ConstIterator iter = r->get().begin(); iter != r->get().end(); ++iter )
         {
-            ( *iter )->removeAllRois();
-        }
+            if( roi == ( *iter )->getFirstRoi() )
+            {
+                ( *iter )->removeAllRois();
+            }
 
-        if( ( *iter )->empty() )
-        {
-            for( std::list< boost::shared_ptr< boost::function< void( boost::shared_ptr< WRMBranch > ) > > >::iterator iter2
-                      = m_removeBranchNotifiers.begin();
-                  iter2 != m_removeBranchNotifiers.end();
-                  ++iter2 )
+            if( ( *iter )->empty() )
             {
-                ( **iter2 )( *iter );
+                emptyBranch = *iter;
+                break;
             }
-            m_branches.erase( iter );
-            break;
         }
     }
+    if( emptyBranch )
+    {
+        removeEmptyBranch( emptyBranch );
+    }
     setDirty();
 }
 
+void WROIManager::removeEmptyBranch( boost::shared_ptr< WRMBranch > branch )
+{
+    // the notifiers get the branch while it is still in the list
+    for( std::list< boost::shared_ptr< boost::function< void( boost::shared_ptr< WRMBranch > ) > > >::iterator iter
+              = m_removeBranchNotifiers.begin();
+          iter != m_removeBranchNotifiers.end();
+          ++iter )
+    {
+        ( **iter )( branch );
+    }
+    m_branches.remove( branch );
+}
+
 boost::shared_ptr< WRMBranch> WROIManager::getBranch( osg::ref_ptr< WROI > roi )
 {
     boost::shared_ptr< WRMBranch> branch;
 
-    for( std::list< boost::shared_ptr< WRMBranch > >::iterator iter = m_branches.begin(); iter != m_branches.end(); ++iter )
+    BranchList::ReadTicket r = m_branches.getReadTicket();
+    for( BranchList::ConstIterator iter = r->get().begin(); iter != r->get().end(); ++iter )
     {
         if( ( *iter )->contains( roi ) )
         {
@@ -243,7 +252,8 @@ WROIManager::ROIs WROIManager::getRois() const
 {
     ROIs returnVec;
 
-    for( std::list< boost::shared_ptr< WRMBranch > >::const_iterator iter = m_branches.begin(); iter != m_branches.end(); ++iter )
+    BranchList::ReadTicket r = m_branches.getReadTicket();
+    for( BranchList::ConstIterator iter = r->get().begin(); iter != r->get().end(); ++iter )
     {
         ( *iter )->getRois( returnVec );
     }
@@ -252,14 +262,8 @@ WROIManager::ROIs WROIManager::getRois() const
 
 WROIManager::Branches WROIManager::getBranches() const
 {
-    // copy to this vec
-    Branches returnVec;
-
-    // copy
-    for( std::list< boost::shared_ptr< WRMBranch > >::const_iterator iter = m_branches.begin(); iter != m_branches.end(); ++iter )
-    {
-        returnVec.push_back( *iter );
-    }
-    return returnVec;
+    // copy the snapshot to this vec
+    BranchList::ReadTicket r = m_branches.getReadTicket();
+    return Branches( r->get().begin(), r->get().end() );
 }
 
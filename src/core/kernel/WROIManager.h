@@ -30,6 +30,9 @@
 
 #include <boost/enable_shared_from_this.hpp>
 
+#include "../common/WSharedObjectRCU.h"
+#include "../common/WSharedSequenceContainer.h"
+
 #include "WRMBranch.h"
 
 /**
@@ -201,7 +204,20 @@ public:
 
 protected:
 private:
-    std::list< boost::shared_ptr< WRMBranch > > m_branches; //!< list of branches in the logical tree structure
+    /**
+     * Calls the branch removal notifiers and removes the branch from the list.
+     *
+     * \param branch the empty branch
+     */
+    void removeEmptyBranch( boost::shared_ptr< WRMBranch > branch );
+
+    /**
+     * The branch list. It is read for every fiber selection update but changes rarely, so readers use read-copy-update snapshots.
+     */
+    typedef WSharedSequenceContainer< std::list< boost::shared_ptr< WRMBranch > >,
+                                      WSharedObjectRCU< std::list< boost::shared_ptr< WRMBranch > > > > BranchList;
+
+    BranchList m_branches; //!< list of branches in the logical tree structure
 
     /**
      * Lock for associated notifiers set.
@@ -0,0 +1,244 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../../common/WBenchmark.h"
+#include "../../common/WBenchmarkRunner.h"
+#include "../WKdTree.h"
+
+/**
+ * Base for the kd-tree benchmarks. Creates size random points in a 160mm^3 box.
+ */
+class WKdTreePointsBenchmark: public WBenchmark
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param name the name of the benchmark
+     */
+    explicit WKdTreePointsBenchmark( std::string name ):
+        WBenchmark( name )
+    {
+        addSize( 100000 );
+        addSize( 1000000 );
+        addSize( 5000000 );
+    }
+
+    /**
+     * Creates the points.
+     *
+     * \param size number of points
+     */
+    virtual void setUp( size_t size )
+    {
+        boost::random::mt19937 rng( 42 );
+        boost::random::uniform_real_distribution< float > pos( 0.0f, 160.0f );
+        m_points.resize( size * 3 );
+        for( size_t i = 0; i < m_points.size(); ++i )
+        {
+            m_points[ i ] = pos( rng );
+        }
+    }
+
+    /**
+     * Frees the points.
+     */
+    virtual void tearDown()
+    {
+        m_points.clear();
+    }
+
+protected:
+    /**
+     * The point coordinates.
+     */
+    std::vector< float > m_points;
+};
+
+/**
+ * Measures the construction of a WKdTree.
+ */
+class WKdTreeBuildBenchmark: public WKdTreePointsBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WKdTreeBuildBenchmark():
+        WKdTreePointsBenchmark( "WKdTree::build" )
+    {
+    }
+
+    /**
+     * Builds the tree.
+     *
+     * \return number of points
+     */
+    virtual size_t run()
+    {
+        WKdTree tree( m_points.size() / 3, &m_points[ 0 ] );
+        consume( tree.m_tree[ 0 ] );
+        return m_points.size() / 3;
+    }
+};
+
+/**
+ * Measures box queries on a WKdTree like done by the fiber selection with box ROIs.
+ */
+class WKdTreeBoxQueryBenchmark: public WKdTreePointsBenchmark
+{
+public:
+    /**
+     * Constructor.
+     */
+    WKdTreeBoxQueryBenchmark():
+        WKdTreePointsBenchmark( "WKdTree::boxQuery" ),
+        m_hits( 0 )
+    {
+    }
+
+    /**
+     * Creates the points, the tree and 1000 random boxes with 10mm edge length.
+     *
+     * \param size number of points
+     */
+    virtual void setUp( size_t size )
+    {
+        WKdTreePointsBenchmark::setUp( size );
+        m_tree = boost::shared_ptr< WKdTree >( new WKdTree( size, &m_points[ 0 ] ) );
+
+        boost::random::mt19937 rng( 23 );
+        boost::random::uniform_real_distribution< float > pos( 0.0f, 150.0f );
+        m_boxes.resize( 1000 * 3 );
+        for( size_t i = 0; i < m_boxes.size(); ++i )
+        {
+            m_boxes[ i ] = pos( rng );
+        }
+    }
+
+    /**
+     * Queries all boxes.
+     *
+     * \return number of queries
+     */
+    virtual size_t run()
+    {
+        m_hits = 0;
+        for( size_t i = 0; i < m_boxes.size(); i += 3 )
+        {
+            for( size_t axis = 0; axis < 3; ++axis )
+            {
+                m_boxMin[ axis ] = m_boxes[ i + axis ];
+                m_boxMax[ axis ] = m_boxes[ i + axis ] + 10.0f;
+            }
+            boxTest( 0, m_points.size() / 3 - 1, 0 );
+        }
+        consume( static_cast< double >( m_hits ) );
+        return m_boxes.size() / 3;
+    }
+
+    /**
+     * Frees the tree.
+     */
+    virtual void tearDown()
+    {
+        m_tree.reset();
+        m_boxes.clear();
+        WKdTreePointsBenchmark::tearDown();
+    }
+
+private:
+    /**
+     * Recursive box test, see WSelectorRoi::boxTest.
+     *
+     * \param left first tree index
+     * \param right last tree index
+     * \param axis the splitting axis
+     */
+    void boxTest( int left, int right, int axis )
+    {
+        if( left > right )
+        {
+            return;
+        }
+
+        int root = left + ( ( right - left ) / 2 );
+        int axis1 = ( axis + 1 ) % 3;
+        int pointIndex = m_tree->m_tree[ root ] * 3;
+
+        if( m_points[ pointIndex + axis ] < m_boxMin[ axis ] )
+        {
+            boxTest( root + 1, right, axis1 );
+        }
+        else if( m_points[ pointIndex + axis ] > m_boxMax[ axis ] )
+        {
+            boxTest( left, root - 1, axis1 );
+        }
+        else
+        {
+            int axis2 = ( axis + 2 ) % 3;
+            if( m_points[ pointIndex + axis1 ] <= m_boxMax[ axis1 ] && m_points[ pointIndex + axis1 ] >= m_boxMin[ axis1 ] &&
+                m_points[ pointIndex + axis2 ] <= m_boxMax[ axis2 ] && m_points[ pointIndex + axis2 ] >= m_boxMin[ axis2 ] )
+            {
+                ++m_hits;
+            }
+            boxTest( left, root - 1, axis1 );
+            boxTest( root + 1, right, axis1 );
+        }
+    }
+
+    /**
+     * The tree.
+     */
+    boost::shared_ptr< WKdTree > m_tree;
+
+    /**
+     * Lower corners of the query boxes.
+     */
+    std::vector< float > m_boxes;
+
+    /**
+     * Lower corner of the current box.
+     */
+    float m_boxMin[ 3 ];
+
+    /**
+     * Upper corner of the current box.
+     */
+    float m_boxMax[ 3 ];
+
+    /**
+     * Number of points found.
+     */
+    size_t m_hits;
+};
+
+W_REGISTER_BENCHMARK( WKdTreeBuildBenchmark )
+W_REGISTER_BENCHMARK( WKdTreeBoxQueryBenchmark )
@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WMODULEPROFILE_TEST_H
+#define WMODULEPROFILE_TEST_H
+
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../../common/WResourceUsage.h"
+#include "../WModuleProfile.h"
+
+/**
+ * Tests the WModuleProfile class.
+ */
+class WModuleProfileTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * A profile which has not been started reports nothing.
+     */
+    void testNotStarted()
+    {
+        WModuleProfile profile;
+        TS_ASSERT( !profile.isRunning() );
+        TS_ASSERT_EQUALS( profile.getWallTime(), 0.0 );
+        TS_ASSERT_EQUALS( profile.getCPUTime(), 0.0 );
+
+        // updates before the start are ignored
+        profile.outputUpdated( "out" );
+        TS_ASSERT( profile.getConnectorStatistics().empty() );
+    }
+
+    /**
+     * Each output update is counted for its connector. Updates after the end of the module thread are ignored.
+     */
+    void testConnectorStatistics()
+    {
+        WModuleProfile profile;
+        profile.start();
+        TS_ASSERT( profile.isRunning() );
+
+        profile.inputChanged();
+        profile.outputUpdated( "out" );
+        profile.outputUpdated( "out" );
+        profile.outputUpdated( "other" );
+        profile.finish();
+        profile.outputUpdated( "other" );
+
+        TS_ASSERT( !profile.isRunning() );
+        WModuleProfile::ConnectorStatisticsMap stats = profile.getConnectorStatistics();
+        TS_ASSERT_EQUALS( stats.size(), 2 );
+        TS_ASSERT_EQUALS( stats[ "out" ].m_updates, 2 );
+        TS_ASSERT_EQUALS( stats[ "other" ].m_updates, 1 );
+        TS_ASSERT_LESS_THAN_EQUALS( stats[ "out" ].m_maxWallTime, stats[ "out" ].m_wallTime );
+        TS_ASSERT_LESS_THAN_EQUALS( stats[ "out" ].m_wallTime + stats[ "other" ].m_wallTime, profile.getWallTime() );
+
+        // the wall time is frozen after finish()
+        double wallTime = profile.getWallTime();
+        boost::this_thread::sleep( boost::posix_time::milliseconds( 5 ) );
+        TS_ASSERT_EQUALS( profile.getWallTime(), wallTime );
+    }
+
+    /**
+     * The CPU time of the module thread is accounted even if another thread updates the outputs.
+     */
+    void testCPUTimeOfModuleThread()
+    {
+        WModuleProfile profile;
+        boost::barrier started( 2 );
+        boost::barrier updated( 2 );
+        boost::thread module( boost::bind( &WModuleProfileTest::moduleThread, this, &profile, &started, &updated ) );
+
+        started.wait();
+        profile.outputUpdated( "out" );
+#ifdef __linux__
+        // reading the clock of another thread is only supported on Linux
+        TS_ASSERT_LESS_THAN( 0.0, profile.getCPUTime() );
+        TS_ASSERT_LESS_THAN( 0.0, profile.getConnectorStatistics()[ "out" ].m_cpuTime );
+#endif
+        updated.wait();
+        module.join();
+
+        // finish() was called by the module thread, which then burnt no more CPU time
+        TS_ASSERT_LESS_THAN( 0.0, profile.getCPUTime() );
+        TS_ASSERT_LESS_THAN_EQUALS( profile.getConnectorStatistics()[ "out" ].m_cpuTime, profile.getCPUTime() );
+    }
+
+    /**
+     * The memory values describe the whole process.
+     */
+    void testProcessPeakMemory()
+    {
+        WModuleProfile profile;
+        profile.start();
+        profile.finish();
+
+        TS_ASSERT_EQUALS( profile.getProcessPeakMemory(), getPeakMemoryUsage() );
+        TS_ASSERT_LESS_THAN_EQUALS( profile.getProcessPeakMemoryIncrease(), profile.getProcessPeakMemory() );
+    }
+
+private:
+    /**
+     * Simulates a module thread which burns some CPU time before another thread updates its output.
+     *
+     * \param profile the profile of the module
+     * \param started passed after burning CPU time
+     * \param updated passed after the output update
+     */
+    void moduleThread( WModuleProfile* profile, boost::barrier* started, boost::barrier* updated )
+    {
+        profile->start();
+        double const begin = getThreadCPUTime();
+        volatile double sum = 0.0;
+        while( getThreadCPUTime() - begin < 0.02 )
+        {
+            for( int i = 0; i < 10000; ++i )
+            {
+                sum += i;
+            }
+        }
+        started->wait();
+        updated->wait();
+        profile->finish();
+    }
+};
+
+#endif  // WMODULEPROFILE_TEST_H
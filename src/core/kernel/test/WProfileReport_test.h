@@ -0,0 +1,120 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WPROFILEREPORT_TEST_H
+#define WPROFILEREPORT_TEST_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WProfileReport.h"
+
+/**
+ * Tests the WProfileReport class.
+ */
+class WProfileReportTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * A report without runs is a valid JSON object with an empty list of runs.
+     */
+    void testEmptyReport()
+    {
+        WProfileReport report;
+        std::string json = write( report );
+
+        TS_ASSERT_EQUALS( json.find( "\"version\": " ), 4 );
+        TS_ASSERT_DIFFERS( json.find( "\"runs\": []" ), std::string::npos );
+        TS_ASSERT_EQUALS( json[ 0 ], '{' );
+        TS_ASSERT_EQUALS( json.substr( json.size() - 2 ), "}\n" );
+    }
+
+    /**
+     * All runs, modules and connectors are written with their values. The memory fields are labeled as process-level values.
+     */
+    void testRuns()
+    {
+        WProfileReport::ModuleRecord module;
+        module.m_name = "Fiber Display";
+        module.m_uuid = "1234";
+        module.m_running = true;
+        module.m_wallTime = 2.5;
+        module.m_cpuTime = 1.5;
+        module.m_processPeakMemory = 4096;
+        module.m_processPeakMemoryIncrease = 1024;
+        module.m_dataMemory = 512;
+        module.m_connectors[ "out" ].m_updates = 3;
+
+        WProfileReport report;
+        report.addRun( "subject1", 10.0, 20.0, std::vector< WProfileReport::ModuleRecord >( 1, module ) );
+        report.addRun( "subject2", 1.0, 2.0, std::vector< WProfileReport::ModuleRecord >() );
+        std::string json = write( report );
+
+        TS_ASSERT_DIFFERS( json.find( "\"subject\": \"subject1\"" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"subject\": \"subject2\"" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"wallTime\": 10," ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"name\": \"Fiber Display\"" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"running\": true" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"processPeakMemory\": 4096" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"processPeakMemoryIncrease\": 1024" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "\"dataMemory\": 512" ), std::string::npos );
+        TS_ASSERT_DIFFERS( json.find( "{ \"connector\": \"out\", \"updates\": 3," ), std::string::npos );
+        TS_ASSERT_EQUALS( json.find( "\"peakMemory\"" ), std::string::npos );
+
+        // the second run has no modules
+        TS_ASSERT_DIFFERS( json.find( "\"modules\": []" ), std::string::npos );
+    }
+
+    /**
+     * Strings are escaped.
+     */
+    void testEscaping()
+    {
+        WProfileReport report;
+        report.addRun( "a \"b\"\\c\n\x01", 0.0, 0.0, std::vector< WProfileReport::ModuleRecord >() );
+
+        TS_ASSERT_DIFFERS( write( report ).find( "\"subject\": \"a \\\"b\\\"\\\\c\\n\\u0001\"" ), std::string::npos );
+    }
+
+private:
+    /**
+     * Writes a report to a string.
+     *
+     * \param report the report
+     *
+     * \return the JSON
+     */
+    std::string write( const WProfileReport& report )
+    {
+        std::ostringstream out;
+        report.write( out );
+        return out.str();
+    }
+};
+
+#endif  // WPROFILEREPORT_TEST_H
@@ -121,7 +121,8 @@ void WScriptInterpreterPython::initBindings()
     m_pyMainNamespace[ "WModuleContainer" ] = pb::class_< WModuleContainerWrapper >( "WModuleContainer", pb::no_init )
                                               .def( "create", &WModuleContainerWrapper::create )
                                               .def( "remove", &WModuleContainerWrapper::remove )
-                                              .def( "createDataModule", &WModuleContainerWrapper::createDataModule );
+                                              .def( "createDataModule", &WModuleContainerWrapper::createDataModule )
+                                              .def( "getMemoryUsage", &WModuleContainerWrapper::getMemoryUsage );
 
     m_pyMainNamespace[ "WOutputConnector" ] = pb::class_< WOutputConnectorWrapper >( "WOutputConnectorWrapper", pb::no_init )
                                              .def( "disconnect", &WOutputConnectorWrapper::disconnect );
@@ -134,6 +135,7 @@ void WScriptInterpreterPython::initBindings()
     m_pyMainNamespace[ "WModule" ] = pb::class_< WModuleWrapper >( "WModule", pb::no_init )
                                      .def( "getName", &WModuleWrapper::getName )
                                      .def( "getDescription", &WModuleWrapper::getDescription )
+                                     .def( "getMemoryUsage", &WModuleWrapper::getMemoryUsage )
                                      .def( "getProperties", &WModuleWrapper::getProperties )
                                      .def( "getInformationProperties", &WModuleWrapper::getInformationProperties )
                                      .def( "getInputConnector", &WModuleWrapper::getInputConnector )
@@ -155,6 +157,9 @@ void WScriptInterpreterPython::initBindings()
 
     m_pyMainNamespace[ "screenshot" ] = pb::make_function( &screenshot );
     m_pyMainNamespace[ "initCamera" ] = pb::make_function( &initCamera );
+    m_pyMainNamespace[ "getMemoryBudgetUsage" ] = pb::make_function( &getMemoryBudgetUsage );
+    m_pyMainNamespace[ "getMemoryBudget" ] = pb::make_function( &getMemoryBudget );
+    m_pyMainNamespace[ "setMemoryBudget" ] = pb::make_function( &setMemoryBudget );
 
     m_logger = WLoggerWrapper( WLogger::getLogger() );
     m_pyMainNamespace[ "logger" ] = &m_logger;
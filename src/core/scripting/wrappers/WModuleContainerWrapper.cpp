@@ -68,3 +68,8 @@ void WModuleContainerWrapper::remove( WModuleWrapper module )
     module.getModulePtr()->wait( true );
     m_mc->remove( module.getModulePtr() );
 }
+
+std::size_t WModuleContainerWrapper::getMemoryUsage() const
+{
+    return m_mc->getMemoryUsage();
+}
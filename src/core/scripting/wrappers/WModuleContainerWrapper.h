@@ -81,6 +81,13 @@ public:
      */
     void remove( WModuleWrapper module );
 
+    /**
+     * Get the main memory held by the data at the outputs of all modules in the container.
+     *
+     * \return The memory in bytes.
+     */
+    std::size_t getMemoryUsage() const;
+
 private:
     //! The module container.
     boost::shared_ptr< WModuleContainer > m_mc;
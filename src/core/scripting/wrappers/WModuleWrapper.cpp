@@ -43,6 +43,11 @@ std::string WModuleWrapper::getName() const
     return m_module->getName();
 }
 
+std::size_t WModuleWrapper::getMemoryUsage() const
+{
+    return m_module->getMemoryUsage();
+}
+
 std::string WModuleWrapper::getDescription() const
 {
     return m_module->getDescription();
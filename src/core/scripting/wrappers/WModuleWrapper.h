@@ -70,6 +70,13 @@ public:
      */
     std::string getDescription() const;
 
+    /**
+     * Get the main memory held by the data at the module's outputs.
+     *
+     * \return The memory in bytes.
+     */
+    std::size_t getMemoryUsage() const;
+
     /**
      * Returns the module pointer. Useful to other wrapper classes.
      *
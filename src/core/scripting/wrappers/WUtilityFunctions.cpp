@@ -26,6 +26,7 @@
 #include <osgGA/TrackballManipulator>
 
 #include "../../common/WLogger.h"
+#include "../../common/WMemoryBudget.h"
 
 #include "../../graphicsEngine/WGraphicsEngine.h"
 
@@ -98,3 +99,18 @@ void initCamera( std::string const& view )
         wlog::error( "Script" ) << "No graphics engine! Cannot set camera preset!";
     }
 }
+
+std::size_t getMemoryBudgetUsage()
+{
+    return WMemoryBudget::getMemoryBudget()->getUsage();
+}
+
+std::size_t getMemoryBudget()
+{
+    return WMemoryBudget::getMemoryBudget()->getBudget();
+}
+
+void setMemoryBudget( std::size_t bytes )
+{
+    WMemoryBudget::getMemoryBudget()->setBudget( bytes );
+}
@@ -39,4 +39,25 @@ void screenshot();
  */
 void initCamera( std::string const& view );
 
+/**
+ * Get the memory reserved by all data objects in the global memory budget.
+ *
+ * \return The memory in bytes.
+ */
+std::size_t getMemoryBudgetUsage();
+
+/**
+ * Get the global memory budget.
+ *
+ * \return The budget in bytes, 0 if disabled.
+ */
+std::size_t getMemoryBudget();
+
+/**
+ * Set the global memory budget. Creating data exceeding the budget lets the creating module fail.
+ *
+ * \param bytes The budget in bytes, 0 disables it.
+ */
+void setMemoryBudget( std::size_t bytes );
+
 #endif  // WUTILITYFUNCTIONS_H_
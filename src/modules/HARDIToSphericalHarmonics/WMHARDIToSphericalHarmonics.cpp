@@ -38,6 +38,7 @@
 #include "core/common/WProgress.h"
 #include "core/common/math/WUnitSphereCoordinates.h"
 #include "core/common/math/WMatrix.h"
+#include "core/common/math/WSphericalHarmonicsFitPlan.h"
 #include "core/common/math/WSymmetricSphericalHarmonic.h"
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
 #include "core/common/math/WLinearAlgebraFunctions.h"
@@ -208,11 +209,8 @@ void WMHARDIToSphericalHarmonics::moduleMain()
             parameter.m_normalize = m_doNormalisation->get( true );
             parameter.m_csa = ( reconstructionType == CSA );
             parameter.m_doFunkRadonTransformation = m_doFunkRadonTransformation->get( true );
-            WMatrix< double > transformMatrix(
-                WSymmetricSphericalHarmonic< double >::getSHFittingMatrix( gradients,
-                                                                           order,
-                                                                           m_regularisationFactorLambda->get( true ),
-                                                                           parameter.m_doFunkRadonTransformation ) );
+            WSphericalHarmonicsFitPlan::FitType fitType = parameter.m_doFunkRadonTransformation ? WSphericalHarmonicsFitPlan::FUNK_RADON
+                                                                                                 : WSphericalHarmonicsFitPlan::DEFAULT;
             if( reconstructionType == CSA )
             {
                 parameter.m_doResidualCalculation = false;
@@ -221,12 +219,10 @@ void WMHARDIToSphericalHarmonics::moduleMain()
                 parameter.m_doFunkRadonTransformation = false;
                 parameter.m_CSADelta1 = m_CSADelta1->get( true );
                 parameter.m_CSADelta2 = m_CSADelta2->get( true );
-                transformMatrix = WSymmetricSphericalHarmonic< double >::getSHFittingMatrixForConstantSolidAngle(
-                    gradients,
-                    order,
-                    m_regularisationFactorLambda->get( true ) );
+                fitType = WSphericalHarmonicsFitPlan::CONSTANT_SOLID_ANGLE;
             }
-            parameter.m_TransformMatrix = boost::shared_ptr< WMatrix< double > >( new WMatrix< double >( transformMatrix ) );
+            // the plans are cached, so a change of lambda or the order does not need to evaluate the basis again
+            parameter.m_fitPlan = WSphericalHarmonicsFitPlan::get( gradients, order, m_regularisationFactorLambda->get( true ), fitType );
 
             //to show progess
             parameter.m_progress = boost::shared_ptr< WProgress >( new WProgress( "Creating Spherical Harmonics",
@@ -234,7 +230,7 @@ void WMHARDIToSphericalHarmonics::moduleMain()
             m_progress->addSubProgress( parameter.m_progress );
 
             debugLog() << "Starting calculation.";
-/*
+
             HARDICalculation hc( parameter, m_multiThreaded->get( true ), m_dataSet->getGrid(), gradients );
             HARDICalculation::result_type res = m_dataSet->getValueSet()->applyFunction( hc );
 
@@ -248,7 +244,6 @@ void WMHARDIToSphericalHarmonics::moduleMain()
             {
                 m_outputResiduals->updateData( res.second );
             }
-            */
         }
     }
 
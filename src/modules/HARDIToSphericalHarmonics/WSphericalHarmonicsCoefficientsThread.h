@@ -25,6 +25,7 @@
 #ifndef WSPHERICALHARMONICSCOEFFICIENTSTHREAD_H
 #define WSPHERICALHARMONICSCOEFFICIENTSTHREAD_H
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -40,7 +41,9 @@
 #include "core/common/WAssert.h"
 #include "core/common/WProgress.h"
 #include "core/common/WThreadedRunner.h"
+#include "core/common/math/WMath.h"
 #include "core/common/math/WMatrix.h"
+#include "core/common/math/WSphericalHarmonicsFitPlan.h"
 
 #include "core/dataHandler/WDataSetRawHARDI.h"
 #include "core/dataHandler/WDataSetSphericalHarmonics.h"
@@ -100,10 +103,10 @@ public:
         int m_order;
 
         /**
-         * Transformation-Matrix for conversion from HARDI measurements to spherical harmonics coefficients
+         * The plan for the conversion from HARDI measurements to spherical harmonics coefficients
          * (see Descoteaux dissertation)
          */
-        boost::shared_ptr< WMatrix< double > > m_TransformMatrix;
+        boost::shared_ptr< WSphericalHarmonicsFitPlan const > m_fitPlan;
 
         /**
          * Gradients of all measurements (including )
@@ -217,117 +220,133 @@ void WSphericalHarmonicsCoefficientsThread< T >::threadMain()
     m_errorCount = 0;
     m_overallError = 0.0;
 
-    WMatrix<double> transformMatrix( *m_parameter.m_TransformMatrix );
-    size_t l = ( m_parameter.m_order + 1 ) * ( m_parameter.m_order + 2 ) / 2;
+    WSphericalHarmonicsFitPlan const& plan = *m_parameter.m_fitPlan;
+    std::size_t const l = plan.getNumCoefficients();
+    std::size_t const numMeasurements = m_parameter.m_validIndices.size();
+    std::size_t const blockSize = WSphericalHarmonicsFitPlan::BlockSize;
+    WAssert( plan.getNumMeasurements() == numMeasurements, "The fit plan does not match the gradients." );
 
-    for( size_t i = m_range.first; i < m_range.second; i++ )
+    boost::shared_ptr< WValueSet< T > > vs = boost::dynamic_pointer_cast< WValueSet< T > >( m_parameter.m_valueSet );
+    if( !vs )
+    {
+        throw WException( "Valueset pointer not valid." );
+    }
+
+    // the measurements of a block of voxels are fitted together, the buffers are reused for all blocks
+    std::vector< double > measures( blockSize * numMeasurements );
+    std::vector< double > coefficients( blockSize * l );
+    std::vector< double > fittedMeasures;
+    if( m_parameter.m_doResidualCalculation || m_parameter.m_doErrorCalculation )
+    {
+        fittedMeasures.resize( blockSize * numMeasurements );
+    }
+
+    for( size_t blockBegin = m_range.first; blockBegin < m_range.second; blockBegin += blockSize )
     {
         if( m_parameter.m_shutdownFlag() )
         {
             break;
         }
+        size_t const blockVoxels = std::min( blockSize, m_range.second - blockBegin );
 
-        // get measure vector
-        boost::shared_ptr< WValueSet< T > > vs = boost::dynamic_pointer_cast< WValueSet< T > >( m_parameter.m_valueSet );
-        if( !vs )
+        for( size_t v = 0; v < blockVoxels; ++v )
         {
-            throw WException( "Valueset pointer not valid." );
-        }
-
-        WValue< T > allMeasures( vs->getWValue( i ) );
+            // get measure vector
+            T const* allMeasures = vs->rawData() + ( blockBegin + v ) * vs->dimension();
+            double* voxelMeasures = &measures[ v * numMeasurements ];
 
-        // extract measures for gradients != 0
-        WValue< double > measures( m_parameter.m_validIndices.size() );
-        unsigned int idx = 0;
-
-        // find max S0 value
-        double S0avg = 0.0;
-        for( std::vector< size_t >::const_iterator it = m_parameter.m_S0Indexes.begin(); it != m_parameter.m_S0Indexes.end(); it++ )
-        {
-            S0avg += static_cast< double >( allMeasures[ *it ] );
-        }
-        S0avg /= m_parameter.m_S0Indexes.size();
+            // find max S0 value
+            double S0avg = 0.0;
+            for( std::vector< size_t >::const_iterator it = m_parameter.m_S0Indexes.begin(); it != m_parameter.m_S0Indexes.end(); it++ )
+            {
+                S0avg += static_cast< double >( allMeasures[ *it ] );
+            }
+            S0avg /= m_parameter.m_S0Indexes.size();
 
-        // to have a valid value for the average S0 signal
-        if( S0avg <= 0.01 )
-        {
-            S0avg = 0.01;
-        }
+            // to have a valid value for the average S0 signal
+            if( S0avg <= 0.01 )
+            {
+                S0avg = 0.01;
+            }
 
-        // double minVal = 1e99;
-        // double maxVal = -1e99;
-        for( std::vector< size_t >::const_iterator it = m_parameter.m_validIndices.begin(); it != m_parameter.m_validIndices.end(); it++, idx++ )
-        {
-            if( m_parameter.m_csa )
+            // extract measures for gradients != 0
+            unsigned int idx = 0;
+            for( std::vector< size_t >::const_iterator it = m_parameter.m_validIndices.begin(); it != m_parameter.m_validIndices.end();
+                 it++, idx++ )
             {
-                double val = static_cast< double >( allMeasures[ *it ] ) / S0avg;
-                if( val < 0.0 )
+                if( m_parameter.m_csa )
                 {
-                    val = m_parameter.m_CSADelta1 / 2.0;
+                    double val = static_cast< double >( allMeasures[ *it ] ) / S0avg;
+                    if( val < 0.0 )
+                    {
+                        val = m_parameter.m_CSADelta1 / 2.0;
+                    }
+                    else if( val < m_parameter.m_CSADelta1 )
+                    {
+                        val = m_parameter.m_CSADelta1 / 2.0 + val * val / ( 2.0 * m_parameter.m_CSADelta1 );
+                    }
+                    else if( val > 1.0 - m_parameter.m_CSADelta2 && val < 1.0 )
+                    {
+                        val = 1.0 - m_parameter.m_CSADelta2 / 2.0 - std::pow( 1.0 - val, 2 ) / ( 2.0 * m_parameter.m_CSADelta2 );
+                    }
+                    else if( val >= 1.0 )
+                    {
+                        val = 1.0 - m_parameter.m_CSADelta2 / 2.0;
+                    }
+                    voxelMeasures[ idx ] = std::log( -std::log( val  ) );
                 }
-                else if( val < m_parameter.m_CSADelta1 )
+                else
                 {
-                    val = m_parameter.m_CSADelta1 / 2.0 + val * val / ( 2.0 * m_parameter.m_CSADelta1 );
+                    voxelMeasures[ idx ] = static_cast< double >( allMeasures[ *it ] ) / S0avg;
                 }
-                else if( val > 1.0 - m_parameter.m_CSADelta2 && val < 1.0 )
-                {
-                    val = 1.0 - m_parameter.m_CSADelta2 / 2.0 - std::pow( 1.0 - val, 2 ) / ( 2.0 * m_parameter.m_CSADelta2 );
-                }
-                else if( val >= 1.0 )
-                {
-                    val = 1.0 - m_parameter.m_CSADelta2 / 2.0;
-                }
-                measures[ idx ] = std::log( -std::log( val  ) );
-            }
-            else
-            {
-                measures[ idx ] = static_cast< double >( allMeasures[ *it ] ) / S0avg;
             }
         }
 
-        WValue< double > coefficients( *m_parameter.m_TransformMatrix * measures );
+        plan.fit( &measures[ 0 ], blockVoxels, &coefficients[ 0 ] );
 
         if( m_parameter.m_doResidualCalculation || m_parameter.m_doErrorCalculation )
         {
-            WSymmetricSphericalHarmonic< double > currentSphericalHarmonic( coefficients );
-            for( idx = 0; idx < m_parameter.m_validIndices.size(); idx++ )
+            plan.reproject( &coefficients[ 0 ], blockVoxels, &fittedMeasures[ 0 ] );
+            for( size_t v = 0; v < blockVoxels; ++v )
             {
-                double error = static_cast< double >( measures[ idx ] )
-                              - currentSphericalHarmonic.getValue( WUnitSphereCoordinates< double >( m_parameter.m_gradients[ idx ] ) );
-
-                if( m_parameter.m_doResidualCalculation )
-                {
-                    m_parameter.m_dataResiduals->operator[]( m_parameter.m_validIndices.size() * i + idx ) = error;
-                }
-                if( m_parameter.m_doErrorCalculation )
+                for( size_t idx = 0; idx < numMeasurements; idx++ )
                 {
-                    m_overallError += fabs( error );
-                    m_errorCount++;
+                    double error = measures[ v * numMeasurements + idx ] - fittedMeasures[ v * numMeasurements + idx ];
+
+                    if( m_parameter.m_doResidualCalculation )
+                    {
+                        m_parameter.m_dataResiduals->operator[]( numMeasurements * ( blockBegin + v ) + idx ) = error;
+                    }
+                    if( m_parameter.m_doErrorCalculation )
+                    {
+                        m_overallError += fabs( error );
+                        m_errorCount++;
+                    }
                 }
             }
         }
 
         // show progress
-        ++( *( m_parameter.m_progress ) );
+        m_parameter.m_progress->increment( blockVoxels );
 
         // copy coefficients to output "data"
-
-        // normalization
-        double scale = 1.0;
-        if( m_parameter.m_normalize )
+        for( size_t v = 0; v < blockVoxels; ++v )
         {
-            scale *= std::sqrt( 4.0 * pi() ) / coefficients[ 0 ];
-        }
+            double* voxelCoefficients = &coefficients[ v * l ];
 
-        if( m_parameter.m_csa )
-        {
-            coefficients[ 0 ] = 1.0 / ( 2.0 * std::sqrt( pi() ) );
-        }
+            // normalization
+            double scale = 1.0;
+            if( m_parameter.m_normalize )
+            {
+                scale *= std::sqrt( 4.0 * pi() ) / voxelCoefficients[ 0 ];
+            }
 
-        for( std::size_t j = 0; j < l; j++ )
-        {
-            m_parameter.m_data->operator[]( l * i + j ) = coefficients[ j ];
-            // wlog::debug( "WSphericalHarmonicsCoefficientsThread" ) << "coefficients[" << j << "]: " << coefficients[ j ];
+            if( m_parameter.m_csa )
+            {
+                voxelCoefficients[ 0 ] = 1.0 / ( 2.0 * std::sqrt( pi() ) );
+            }
+
+            std::copy( voxelCoefficients, voxelCoefficients + l, m_parameter.m_data->begin() + l * ( blockBegin + v ) );
         }
     }
 }
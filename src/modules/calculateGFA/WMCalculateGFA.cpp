@@ -23,12 +23,8 @@
 //---------------------------------------------------------------------------
 
 #include <string>
-#include <vector>
 
-#include "core/common/math/WSymmetricSphericalHarmonic.h"
 #include "core/common/WLimits.h"
-#include "core/common/math/linearAlgebra/WVectorFixed.h"
-#include "core/common/math/WGeometryFunctions.h"
 #include "core/kernel/WKernel.h"
 #include "WMCalculateGFA.xpm"
 
@@ -38,8 +34,7 @@
 W_LOADABLE_MODULE( WMCalculateGFA )
 
 WMCalculateGFA::WMCalculateGFA():
-    WModule(),
-    m_BMat( 1, 1 )
+    WModule()
 {
 }
 
@@ -97,26 +92,6 @@ void WMCalculateGFA::moduleMain()
     m_moduleState.add( m_input->getDataChangedCondition() );
     m_moduleState.add( m_exceptionCondition );
 
-    std::vector< unsigned int > temp;
-    std::vector< WVector3d > grad;
-
-    tesselateIcosahedron( &grad, &temp, 2 );
-
-    temp.clear();
-
-    std::vector< WUnitSphereCoordinates< double > > ori;
-    for( std::size_t k = 0; k < grad.size(); ++k )
-    {
-        if( grad[ k ][ 0 ] >= 0.0 )
-        {
-            ori.push_back( WUnitSphereCoordinates< double >( grad[ k ] ) );
-        }
-    }
-    grad.clear();
-
-    m_BMat = WSymmetricSphericalHarmonic< double >::calcBaseMatrix( ori, 4 );
-    ori.clear();
-
     ready();
 
     while( !m_shutdownFlag() )
@@ -140,7 +115,7 @@ void WMCalculateGFA::moduleMain()
         {
             debugLog() << "Computation finished.";
             m_currentProgress->finish();
-            m_result = boost::dynamic_pointer_cast< WDataSetScalar >( m_gfaFunc->getResult() );
+            m_result = m_gfaFunc->getResult( WThreadedScalarMaps::GFA );
             m_gfaPool = boost::shared_ptr< GFAPoolType >();
             m_gfaFunc = boost::shared_ptr< GFAFuncType >();
 
@@ -186,7 +161,8 @@ void WMCalculateGFA::resetGFAPool()
     resetProgress( g->getNbCoordsX() * g->getNbCoordsY() * g->getNbCoordsZ() );
 
     // create a new one
-    m_gfaFunc = boost::shared_ptr< GFAFuncType >( new GFAFuncType( m_dataSet, boost::bind( &This::perVoxelGFAFunc, this, _1 ) ) );
+    m_gfaFunc = boost::shared_ptr< GFAFuncType >( new GFAFuncType( WThreadedScalarMaps::GFA, boost::shared_ptr< WDataSetSingle >(),
+                                                                   m_dataSet, m_currentProgress ) );
     m_gfaPool = boost::shared_ptr< GFAPoolType >( new GFAPoolType( 0, m_gfaFunc ) );
     m_gfaPool->subscribeExceptionSignal( boost::bind( &This::handleException, this, _1 ) );
     m_moduleState.add( m_gfaPool->getThreadsDoneCondition() );
@@ -207,18 +183,3 @@ void WMCalculateGFA::resetProgress( std::size_t todo )
     m_currentProgress = boost::shared_ptr< WProgress >( new WProgress( "calculate gfa", todo ) );
     m_progress->addSubProgress( m_currentProgress );
 }
-
-boost::array< double, 1 > WMCalculateGFA::perVoxelGFAFunc( WValueSet< double >::SubArray const& s )
-{
-    ++*m_currentProgress;
-    boost::array< double, 1 > a;
-    WValue<double> w( 15 );
-    for( int i = 0; i < 15; ++i )
-    {
-        w[ i ] = s[ i ];
-    }
-    WSymmetricSphericalHarmonic< double > h( w );
-    a[ 0 ] = h.calcGFA( m_BMat );
-
-    return a;
-}
@@ -32,10 +32,9 @@
 #include "core/kernel/WModuleInputData.h"
 #include "core/kernel/WModuleOutputData.h"
 #include "core/common/WThreadedFunction.h"
-#include "core/common/math/WMatrix.h"
-#include "core/dataHandler/WThreadedPerVoxelOperation.h"
 #include "core/dataHandler/WDataSetSphericalHarmonics.h"
 #include "core/dataHandler/WDataSetScalar.h"
+#include "core/dataHandler/WThreadedScalarMaps.h"
 
 /**
  * \class WMCalculateGFA
@@ -104,20 +103,11 @@ protected:
 
 private:
     //! the threaded function type for gfa computation
-    typedef WThreadedPerVoxelOperation< double, 15, double, 1 > GFAFuncType;
+    typedef WThreadedScalarMaps GFAFuncType;
 
     //! the threadpool
     typedef WThreadedFunction< GFAFuncType > GFAPoolType;
 
-    /**
-     * A function that gets called for every voxel in the input SH-dataset. Calculates a
-     * fractional anisotropy measure.
-     *
-     * \param s An array of SH-coefficients.
-     * \return A boost::array of size 1 that contains the result for the given voxel.
-     */
-    boost::array< double, 1 > perVoxelGFAFunc( WValueSet< double >::SubArray const& s );
-
     /**
      * Reset the threaded functions.
      */
@@ -163,9 +153,6 @@ private:
 
     //! The threadpool.
     boost::shared_ptr< GFAPoolType > m_gfaPool;
-
-    //! A matrix of SH base function values for various gradients.
-    WMatrix<double> m_BMat;
 };
 
 #endif  // WMCALCULATEGFA_H
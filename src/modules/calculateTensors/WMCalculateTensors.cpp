@@ -29,6 +29,7 @@
 #include "core/common/math/WMatrix.h"
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
 #include "core/common/WLimits.h"
+#include "core/common/WPropertyHelper.h"
 #include "core/kernel/WKernel.h"
 
 #include "WMCalculateTensors.h"
@@ -62,7 +63,7 @@ const std::string WMCalculateTensors::getName() const
 
 const std::string WMCalculateTensors::getDescription() const
 {
-    return "Calculates diffusion tensors from an input sh dataset.";
+    return "Calculates diffusion tensors from an input sh dataset or fits them to a diffusion weighted dataset.";
 }
 
 void WMCalculateTensors::connectors()
@@ -76,7 +77,13 @@ void WMCalculateTensors::connectors()
                 "dtiOutput", "The diffusion tensor image." )
             );
 
+    m_dwiInput = boost::shared_ptr< WModuleInputData< WDataSetRawHARDI > >(
+                            new WModuleInputData< WDataSetRawHARDI >( shared_from_this(),
+                                "dwiInput", "A diffusion weighted dataset with at least one unweighted measurement." )
+            );
+
     addConnector( m_input );
+    addConnector( m_dwiInput );
     addConnector( m_output );
 
     // call WModules initialization
@@ -87,6 +94,16 @@ void WMCalculateTensors::properties()
 {
     m_exceptionCondition = boost::shared_ptr< WCondition >( new WCondition() );
 
+    // the order matches WDiffusionTensorFit::FitMethod
+    m_fitMethods = boost::shared_ptr< WItemSelection >( new WItemSelection() );
+    m_fitMethods->addItem( "Log-linear", "Least squares fit of the logarithm of the signal." );
+    m_fitMethods->addItem( "Weighted linear", "Weighted least squares fit of the logarithm of the signal, more robust to noise." );
+    m_fitMethods->addItem( "Constrained nonlinear", "Nonlinear least squares fit of the signal yielding positive semi-definite tensors." );
+    m_fitMethod = m_properties->addProperty( "Fitting method", "How tensors are fitted to diffusion weighted data.",
+                                             m_fitMethods->getSelector( 1 ) );
+    WPropertyHelper::PC_SELECTONLYONE::addTo( m_fitMethod );
+    WPropertyHelper::PC_NOTEMPTY::addTo( m_fitMethod );
+
     WModule::properties();
 }
 
@@ -94,6 +111,8 @@ void WMCalculateTensors::moduleMain()
 {
     m_moduleState.setResetable( true, true );
     m_moduleState.add( m_input->getDataChangedCondition() );
+    m_moduleState.add( m_dwiInput->getDataChangedCondition() );
+    m_moduleState.add( m_fitMethod->getCondition() );
     m_moduleState.add( m_exceptionCondition );
 
     // calc sh->tensor conversion matrix
@@ -141,6 +160,29 @@ void WMCalculateTensors::moduleMain()
             // forward result
             m_output->updateData( m_result );
         }
+        else if( m_dwiInput->getData() && ( m_dwiInput->getData() != m_dwiDataSet || m_fitMethod->changed() ) )
+        {
+            m_dwiDataSet = m_dwiInput->getData();
+
+            // start the fit
+            resetFitPool();
+            if( m_fitPool )
+            {
+                m_fitPool->run();
+            }
+            debugLog() << "Running fit.";
+        }
+        else if( m_fitPool && ( m_fitPool->status() == W_THREADS_FINISHED || m_fitPool->status() == W_THREADS_ABORTED ) )
+        {
+            debugLog() << "Fit finished.";
+            m_currentProgress->finish();
+            m_result = m_fitFunc->getResult();
+            m_fitPool = boost::shared_ptr< FitPoolType >();
+            m_fitFunc = boost::shared_ptr< WThreadedTensorFit >();
+
+            // forward result
+            m_output->updateData( m_result );
+        }
         else if( m_lastException )
         {
             throw WException( *m_lastException );
@@ -157,6 +199,14 @@ void WMCalculateTensors::moduleMain()
             m_tensorPool->wait();
         }
     }
+    if( m_fitPool )
+    {
+        if( m_fitPool->status() == W_THREADS_RUNNING || m_fitPool->status() == W_THREADS_STOP_REQUESTED )
+        {
+            m_fitPool->stop();
+            m_fitPool->wait();
+        }
+    }
 }
 
 void WMCalculateTensors::resetTensorPool()
@@ -193,6 +243,43 @@ void WMCalculateTensors::resetTensorPool()
     }
 }
 
+void WMCalculateTensors::resetFitPool()
+{
+    if( m_fitPool )
+    {
+        WThreadedFunctionStatus s = m_fitPool->status();
+        if( s != W_THREADS_FINISHED && s != W_THREADS_ABORTED )
+        {
+            m_fitPool->stop();
+            m_fitPool->wait();
+            s = m_fitPool->status();
+            WAssert( s == W_THREADS_FINISHED || s == W_THREADS_ABORTED, "" );
+        }
+        m_moduleState.remove( m_fitPool->getThreadsDoneCondition() );
+        m_fitPool = boost::shared_ptr< FitPoolType >();
+    }
+    // the threadpool should have finished computing by now
+
+    WDiffusionTensorFit::FitMethod method = static_cast< WDiffusionTensorFit::FitMethod >( m_fitMethod->get( true ).getItemIndexOfSelected( 0 ) );
+    try
+    {
+        resetProgress( m_dwiDataSet->getValueSet()->size() );
+        m_fitFunc = boost::shared_ptr< WThreadedTensorFit >( new WThreadedTensorFit( m_dwiDataSet, method, m_currentProgress ) );
+    }
+    catch( WException const& e )
+    {
+        errorLog() << "Cannot fit tensors: " << e.what();
+        m_currentProgress->finish();
+        m_fitFunc = boost::shared_ptr< WThreadedTensorFit >();
+        return;
+    }
+
+    // create a new one
+    m_fitPool = boost::shared_ptr< FitPoolType >( new FitPoolType( 0, m_fitFunc ) );
+    m_fitPool->subscribeExceptionSignal( boost::bind( &This::handleException, this, _1 ) );
+    m_moduleState.add( m_fitPool->getThreadsDoneCondition() );
+}
+
 void WMCalculateTensors::handleException( WException const& e )
 {
     m_lastException = boost::shared_ptr< WException >( new WException( e ) );
@@ -34,13 +34,15 @@
 #include "core/common/WThreadedFunction.h"
 #include "core/common/math/WMatrix.h"
 #include "core/dataHandler/WThreadedPerVoxelOperation.h"
+#include "core/dataHandler/WThreadedTensorFit.h"
 #include "core/dataHandler/WDataSetSphericalHarmonics.h"
 #include "core/dataHandler/WDataSetDTI.h"
+#include "core/dataHandler/WDataSetRawHARDI.h"
 
 /**
  * \class WMCalculateTensors
  *
- * A module that calculates tensors from the input SH dataset.
+ * A module that calculates tensors from the input SH dataset or fits them to the measurements of a diffusion weighted dataset.
  *
  * \ingroup modules
  */
@@ -109,6 +111,9 @@ private:
     //! the threadpool
     typedef WThreadedFunction< TensorFuncType > TensorPoolType;
 
+    //! the threadpool for fitting tensors to diffusion weighted data
+    typedef WThreadedFunction< WThreadedTensorFit > FitPoolType;
+
     /**
      * A function that gets called for every voxel in the input SH-dataset. Calculates a
      * diffusion tensor.
@@ -123,6 +128,11 @@ private:
      */
     void resetTensorPool();
 
+    /**
+     * Reset the threaded tensor fit of the diffusion weighted data.
+     */
+    void resetFitPool();
+
     /**
      * Handle an exception thrown by a worker thread.
      *
@@ -149,6 +159,18 @@ private:
     //! The input Connector for the SH data.
     boost::shared_ptr< WModuleInputData< WDataSetSphericalHarmonics > > m_input;
 
+    //! The input Connector for the diffusion weighted data.
+    boost::shared_ptr< WModuleInputData< WDataSetRawHARDI > > m_dwiInput;
+
+    //! A pointer to the diffusion weighted input dataset.
+    boost::shared_ptr< WDataSetRawHARDI > m_dwiDataSet;
+
+    //! The selectable methods for fitting tensors to diffusion weighted data.
+    boost::shared_ptr< WItemSelection > m_fitMethods;
+
+    //! The method for fitting tensors to diffusion weighted data.
+    WPropSelection m_fitMethod;
+
     //! The object that keeps track of the current progress.
     boost::shared_ptr< WProgress > m_currentProgress;
 
@@ -164,6 +186,12 @@ private:
     //! The threadpool.
     boost::shared_ptr< TensorPoolType > m_tensorPool;
 
+    //! The threaded tensor fit.
+    boost::shared_ptr< WThreadedTensorFit > m_fitFunc;
+
+    //! The threadpool for the tensor fit.
+    boost::shared_ptr< FitPoolType > m_fitPool;
+
     //! The sh->tensor conversion.
     WMatrix<double> m_SHToTensorMat;
 };
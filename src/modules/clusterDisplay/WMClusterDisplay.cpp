@@ -40,6 +40,7 @@
 #include "core/common/WStringUtils.h"
 #include "core/common/WPathHelper.h"
 #include "core/common/WPropertyHelper.h"
+#include "core/dataHandler/WFiberAgglomerativeClustering.h"
 #include "core/graphicsEngine/WGEUtils.h"
 #include "core/kernel/WKernel.h"
 #include "core/kernel/WROIManager.h"
@@ -234,6 +235,27 @@ bool WMClusterDisplay::loadTreeAscii( std::string fileName )
     return false;
 }
 
+bool WMClusterDisplay::clusterFibers()
+{
+    debugLog() << "start clustering fibers...";
+
+    WFiberAgglomerativeClustering clustering( m_dataSet, m_propClusterPoints->get( true ) );
+    boost::shared_ptr< WProgress > progress( new WProgress( "Clustering fibers", clustering.size() ) );
+    m_progress->addSubProgress( progress );
+    boost::shared_ptr< WHierarchicalTreeFibers > tree = clustering.compute( m_shutdownFlag, progress );
+    progress->finish();
+
+    if( !tree )
+    {
+        return false;
+    }
+    m_tree = *tree;
+    debugLog() << m_tree.getClusterCount() << " clusters created.";
+
+    debugLog() << "finished clustering fibers...";
+    return true;
+}
+
 void WMClusterDisplay::initWidgets()
 {
     osg::ref_ptr<osgViewer::View> viewer = WKernel::getRunningKernel()->getGraphicsEngine()->getViewer()->getView();
@@ -382,6 +404,13 @@ void WMClusterDisplay::properties()
     m_readTriggerProp = m_properties->addProperty( "Do read",  "Press!", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
     WPropertyHelper::PC_PATHEXISTS::addTo( m_propTreeFile );
 
+    m_propClusterPoints = m_properties->addProperty( "Resampling points", "Number of points the fibers are resampled to for clustering",
+                                                     20, m_propCondition );
+    m_propClusterPoints->setMin( 2 );
+    m_propClusterPoints->setMax( 100 );
+    m_clusterTriggerProp = m_properties->addProperty( "Do cluster", "Builds the tree from the fibers instead of reading it.",
+                                                      WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+
     WModule::properties();
 }
 
@@ -436,6 +465,16 @@ void WMClusterDisplay::moduleMain()
                 break;
             }
         }
+
+        if( m_clusterTriggerProp->get( true ) == WPVBaseTypes::PV_TRIGGER_TRIGGERED && m_dataSet )
+        {
+            treeLoaded = clusterFibers();
+            m_clusterTriggerProp->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+            if( treeLoaded )
+            {
+                break;
+            }
+        }
     }
 
     m_fiberSelector = boost::shared_ptr<WFiberSelector>( new WFiberSelector( m_dataSet ) );
@@ -443,6 +482,8 @@ void WMClusterDisplay::moduleMain()
 
     m_propTreeFile->setHidden( true );
     m_readTriggerProp->setHidden( true );
+    m_propClusterPoints->setHidden( true );
+    m_clusterTriggerProp->setHidden( true );
 
     m_propSelectedCluster->setMin( m_tree.getLeafCount() );
     m_propSelectedCluster->setMax( m_tree.getClusterCount() - 1 );
@@ -157,6 +157,13 @@ private:
      */
     bool loadTreeAscii( std::string fileName );
 
+    /**
+     * builds the tree from the current fibers with an agglomerative clustering, the tree is stored in the member variable m_tree
+     *
+     * \return true if successful, false if the module was shut down meanwhile
+     */
+    bool clusterFibers();
+
     /**
      * inits the cluster navigation widgets
      */
@@ -323,6 +330,8 @@ private:
 
     WPropTrigger  m_readTriggerProp; //!< This property triggers the actual reading,
     WPropFilename m_propTreeFile; //!< The tree will be read from this file, i hope we will get a real load button some time
+    WPropInt m_propClusterPoints; //!< The number of points the fibers are resampled to for clustering
+    WPropTrigger m_clusterTriggerProp; //!< This property triggers building the tree from the fibers
 
     /**
      * stores the tree object
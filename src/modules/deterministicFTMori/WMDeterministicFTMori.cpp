@@ -27,8 +27,6 @@
 #include <vector>
 
 #include "core/common/math/WLinearAlgebraFunctions.h"
-#include "core/common/math/WTensorFunctions.h"
-#include "core/common/math/WTensorSym.h"
 #include "core/common/WAssert.h"
 #include "core/dataHandler/io/WWriterFiberVTK.h"
 #include "core/dataHandler/WDataSetFiberVector.h"
@@ -49,8 +47,8 @@ WMDeterministicFTMori::WMDeterministicFTMori()
       m_dataSet(),
       m_fiberSet(),
       m_eigenField(),
-      m_eigenOperationFloat(),
-      m_eigenOperationDouble(),
+      m_directionField(),
+      m_eigenOperation(),
       m_eigenPool()
 {
 }
@@ -98,14 +96,20 @@ void WMDeterministicFTMori::moduleMain()
 
         if( m_trackingPool && m_trackingPool->status() == W_THREADS_FINISHED )
         {
-            m_fiberSet = m_fiberAccu.buildDataSet();
-            m_fiberAccu.clear();
+            m_fiberSet = m_fiberBuilder->buildDataSet();
+            m_fiberBuilder->clear();
             m_currentProgress->finish();
             debugLog() << "Tracking done.";
             // forward result
             m_output->updateData( m_fiberSet );
             m_trackingPool = boost::shared_ptr< TrackingFuncType >();
         }
+        else if( m_trackingPool && m_trackingPool->status() == W_THREADS_RUNNING && m_partialResultTimer.elapsed() > 1.0 )
+        {
+            // forward the fibers tracked so far, at most once per second
+            m_partialResultTimer.reset();
+            m_output->updateData( m_fiberBuilder->buildDataSet() );
+        }
 
         boost::shared_ptr< WDataSetSingle > inData = m_input->getData();
         bool dataChanged = ( m_dataSet != inData );
@@ -120,11 +124,16 @@ void WMDeterministicFTMori::moduleMain()
 
         if( dataChanged && m_dataSet )
         {
+            resetProgress( m_dataSet->getValueSet()->size() );
             resetEigenFunction();
+            if( !m_eigenPool )
+            {
+                m_currentProgress->finish();
+                continue;
+            }
             // start the eigenvector computation
             // when the computation finishes, we'll be notified by the threadspool's
             // threadsDoneCondition
-            resetProgress( m_dataSet->getValueSet()->size() );
             m_eigenPool->run();
             debugLog() << "Running computation of eigenvectors.";
         }
@@ -133,16 +142,10 @@ void WMDeterministicFTMori::moduleMain()
             // the computation of the eigenvectors has finished
             // we have a new eigenvectorfield
             m_currentProgress->finish();
-            WAssert( m_eigenOperationFloat || m_eigenOperationDouble, "" );
+            WAssert( m_eigenOperation, "" );
 
-            if( m_dataSet->getValueSet()->getDataType() == W_DT_DOUBLE )
-            {
-                m_eigenField = m_eigenOperationDouble->getResult();
-            }
-            else
-            {
-                m_eigenField = m_eigenOperationFloat->getResult();
-            }
+            m_eigenField = m_eigenOperation->getResult();
+            m_directionField = wtracking::WTrackingDirectionField::SPtr( new wtracking::WTrackingDirectionField( m_eigenField ) );
 
             m_eigenPool = boost::shared_ptr< WThreadedFunctionBase >();
             debugLog() << "Eigenvectors computed.";
@@ -150,6 +153,7 @@ void WMDeterministicFTMori::moduleMain()
             m_currentMinFA = m_minFA->get( true );
             m_currentMinPoints = static_cast< std::size_t >( m_minPoints->get( true ) );
             m_currentMinCos = m_minCos->get( true );
+            m_currentInterpolate = m_interpolate->get( true );
 
             // perform the actual tracking
             resetTracking();
@@ -157,14 +161,17 @@ void WMDeterministicFTMori::moduleMain()
             m_trackingPool->run();
             debugLog() << "Running tracking function.";
         }
-        else if( !m_eigenPool && ( m_minFA->changed() || m_minPoints->changed() || m_minCos->changed() ) )
+        else if( !m_eigenPool && m_directionField &&
+                 ( m_minFA->changed() || m_minPoints->changed() || m_minCos->changed() || m_interpolate->changed() ) )
         {
             m_currentMinFA = m_minFA->get( true );
             m_currentMinPoints = static_cast< std::size_t >( m_minPoints->get( true ) );
             m_currentMinCos = m_minCos->get( true );
+            m_currentInterpolate = m_interpolate->get( true );
 
             // if there are no new eigenvectors or datasets,
             // restart the tracking, as there are changes to the parameters
+            // the direction field is reused, so no tensor math is repeated
             resetTracking();
             boost::shared_ptr< WGridRegular3D > g( boost::dynamic_pointer_cast< WGridRegular3D >( m_eigenField->getGrid() ) );
             std::size_t todo = ( g->getNbCoordsX() - 2 ) * ( g->getNbCoordsY() - 2 ) * ( g->getNbCoordsZ() - 2 );
@@ -230,6 +237,9 @@ void WMDeterministicFTMori::properties()
     m_minCos->setMax( 1.0 );
     m_minCos->setMin( 0.0 );
 
+    m_interpolate = m_properties->addProperty( "Interpolate", "Interpolate the directions trilinearly instead of using the "
+                                                "direction of the current voxel.", false, m_propCondition );
+
     WModule::properties();
 }
 
@@ -256,22 +266,15 @@ void WMDeterministicFTMori::resetEigenFunction()
     }
     // the threadpool should have finished computing by now
 
-    m_eigenOperationFloat = boost::shared_ptr< TPVOFloat >();
-    m_eigenOperationDouble = boost::shared_ptr< TPVODouble >();
+    m_eigenOperation = boost::shared_ptr< WThreadedEigenSystems >();
 
     // create a new one
-    if( m_dataSet->getValueSet()->getDataType() == W_DT_DOUBLE )
-    {
-        m_eigenOperationDouble = boost::shared_ptr< TPVODouble >( new TPVODouble( m_dataSet,
-                                                boost::bind( &WMDeterministicFTMori::eigenFuncDouble, this, _1 ) ) );
-        m_eigenPool = boost::shared_ptr< WThreadedFunctionBase >( new EigenFunctionTypeDouble( WM_MORI_NUM_CORES, m_eigenOperationDouble ) );
-        m_moduleState.add( m_eigenPool->getThreadsDoneCondition() );
-    }
-    else if( m_dataSet->getValueSet()->getDataType() == W_DT_FLOAT )
+    WDataType dataType = m_dataSet->getValueSet()->getDataType();
+    if( dataType == W_DT_DOUBLE || dataType == W_DT_FLOAT )
     {
-        m_eigenOperationFloat = boost::shared_ptr< TPVOFloat >( new TPVOFloat( m_dataSet,
-                                                boost::bind( &WMDeterministicFTMori::eigenFuncFloat, this, _1 ) ) );
-        m_eigenPool = boost::shared_ptr< WThreadedFunctionBase >( new EigenFunctionTypeFloat( WM_MORI_NUM_CORES, m_eigenOperationFloat ) );
+        m_eigenOperation = boost::shared_ptr< WThreadedEigenSystems >( new WThreadedEigenSystems( m_dataSet,
+                                                WThreadedEigenSystems::PRINCIPAL_DIRECTION_AND_FA, m_currentProgress ) );
+        m_eigenPool = boost::shared_ptr< WThreadedFunctionBase >( new EigenFunctionType( WM_MORI_NUM_CORES, m_eigenOperation ) );
         m_moduleState.add( m_eigenPool->getThreadsDoneCondition() );
     }
     else
@@ -299,65 +302,39 @@ void WMDeterministicFTMori::resetTracking()
     }
     // the threadpool should have finished computing by now
 
-    m_fiberAccu.clear();
+    if( m_fiberBuilder )
+    {
+        m_moduleState.remove( m_fiberBuilder->getChangeCondition() );
+    }
+    m_fiberBuilder = WFiberBuilder::SPtr( new WFiberBuilder( 1000 ) );
+    m_moduleState.add( m_fiberBuilder->getChangeCondition() );
+    m_partialResultTimer.reset();
 
     // create a new one
     boost::shared_ptr< Tracking > t( new Tracking( m_eigenField,
-                                                   boost::bind( &This::getEigenDirection, this, _1, _2 ),
+                                                   boost::bind( &This::getDirection, this, _1, _2 ),
                                                    boost::bind( &wtracking::WTrackingUtility::followToNextVoxel, _1, _2, _3 ),
                                                    boost::bind( &This::fiberVis, this, _1 ),
-                                                   boost::bind( &This::pointVis, this, _1 ) ) );
+                                                   boost::bind( &This::pointVis, this, _1 ),
+                                                   1, 1, std::vector< int >(), std::vector< int >(),
+                                                   m_fiberBuilder, m_currentMinPoints ) );
     m_trackingPool = boost::shared_ptr< TrackingFuncType >( new TrackingFuncType( WM_MORI_NUM_CORES, t ) );
     m_moduleState.add( m_trackingPool->getThreadsDoneCondition() );
 }
 
-WVector3d WMDeterministicFTMori::getEigenDirection( boost::shared_ptr< WDataSetSingle const > ds,
-                                                           wtracking::WTrackingUtility::JobType const& j )
+WVector3d WMDeterministicFTMori::getDirection( boost::shared_ptr< WDataSetSingle const >,
+                                               wtracking::WTrackingUtility::JobType const& j )
 {
-    WAssert( ds, "" );
-    WAssert( ds->getGrid(), "" );
-    WAssert( ds->getValueSet(), "" );
-    boost::shared_ptr< WGridRegular3D > g = boost::dynamic_pointer_cast< WGridRegular3D >( ds->getGrid() );
-    int i = g->getVoxelNum( j.first );
-    WAssert( i != -1, "" );
-    boost::shared_ptr< WValueSet< double > > vs = boost::dynamic_pointer_cast< WValueSet< double > >( ds->getValueSet() );
-    WAssert( vs, "" );
-    if( vs->rawData()[ 4 * i + 3 ] < m_currentMinFA )
+    WAssert( m_directionField, "" );
+    if( m_currentInterpolate )
     {
-        return WVector3d( 0.0, 0.0, 0.0 );
-    }
-    else
-    {
-        WVector3d v;
-        v[ 0 ] = vs->rawData()[ 4 * i + 0 ];
-        v[ 1 ] = vs->rawData()[ 4 * i + 1 ];
-        v[ 2 ] = vs->rawData()[ 4 * i + 2 ];
-        v = normalize( v );
-        if( length( j.second ) == 0 )
-        {
-            return v;
-        }
-        else if( dot( v, j.second ) > m_currentMinCos )
-        {
-            return v;
-        }
-        else if( dot( j.second, v * -1.0 ) > m_currentMinCos )
-        {
-            return v * -1.0;
-        }
-        else
-        {
-            return WVector3d( 0.0, 0.0, 0.0 );
-        }
+        return m_directionField->interpolateDirection( j.first, j.second, m_currentMinFA, m_currentMinCos );
     }
+    return m_directionField->getDirection( j.first, j.second, m_currentMinFA, m_currentMinCos );
 }
 
-void WMDeterministicFTMori::fiberVis( FiberType const& f )
+void WMDeterministicFTMori::fiberVis( FiberType const& )
 {
-    if( f.size() >= m_currentMinPoints )
-    {
-        m_fiberAccu.add( f );
-    }
     ++*m_currentProgress;
 }
 
@@ -365,81 +342,6 @@ void WMDeterministicFTMori::pointVis( WVector3d const& )
 {
 }
 
-boost::array< double, 4 > const WMDeterministicFTMori::computeFaAndEigenVec( WTensorSym< 2, 3, double > const& m ) const
-{
-    boost::array< double, 4 > a;
-
-    RealEigenSystem eigenSys;
-    std::vector< double > ev( 3 );
-    std::vector< WVector3d > t( 3 );
-
-    // calc eigenvectors
-    jacobiEigenvector3D( m, &eigenSys );
-
-    // find the eigenvector with largest absolute eigenvalue
-    int u = 0;
-    double h = 0.0;
-    for( int n = 0; n < 3; ++n )
-    {
-        if( fabs( eigenSys[ n ].first ) > h )
-        {
-            h = fabs( eigenSys[ n ].first );
-            u = n;
-        }
-    }
-
-    // copy them to the output
-    a[ 0 ] = eigenSys[ u ].second[ 0 ];
-    a[ 1 ] = eigenSys[ u ].second[ 1 ];
-    a[ 2 ] = eigenSys[ u ].second[ 2 ];
-
-    // calc fa
-    double d = eigenSys[ 0 ].first * eigenSys[ 0 ].first + eigenSys[ 1 ].first * eigenSys[ 1 ].first + eigenSys[ 2 ].first * eigenSys[ 2 ].first;
-    if( fabs( d ) == 0.0 )
-    {
-        a[ 3 ] = 0.0;
-    }
-    else
-    {
-        double trace = ( eigenSys[ 0 ].first + eigenSys[ 1 ].first + eigenSys[ 2 ].first ) / 3;
-        a[ 3 ] = sqrt( 1.5 * ( ( eigenSys[ 0 ].first - trace ) * ( eigenSys[ 0 ].first - trace )
-                             + ( eigenSys[ 1 ].first - trace ) * ( eigenSys[ 1 ].first - trace )
-                             + ( eigenSys[ 2 ].first - trace ) * ( eigenSys[ 2 ].first - trace ) ) / d );
-    }
-
-    return a;
-}
-
-WMDeterministicFTMori::TPVOFloat::OutTransmitType const WMDeterministicFTMori::eigenFuncFloat( TPVOFloat::TransmitType const& input )
-{
-    WTensorSym< 2, 3, double > m;
-    m( 0, 0 ) = static_cast< double >( input[ 0 ] );
-    m( 0, 1 ) = static_cast< double >( input[ 1 ] );
-    m( 0, 2 ) = static_cast< double >( input[ 2 ] );
-    m( 1, 1 ) = static_cast< double >( input[ 3 ] );
-    m( 1, 2 ) = static_cast< double >( input[ 4 ] );
-    m( 2, 2 ) = static_cast< double >( input[ 5 ] );
-
-    ++*m_currentProgress;
-
-    return computeFaAndEigenVec( m );
-}
-
-WMDeterministicFTMori::TPVODouble::OutTransmitType const WMDeterministicFTMori::eigenFuncDouble( TPVODouble::TransmitType const& input )
-{
-    WTensorSym< 2, 3, double > m;
-    m( 0, 0 ) = static_cast< double >( input[ 0 ] );
-    m( 0, 1 ) = static_cast< double >( input[ 1 ] );
-    m( 0, 2 ) = static_cast< double >( input[ 2 ] );
-    m( 1, 1 ) = static_cast< double >( input[ 3 ] );
-    m( 1, 2 ) = static_cast< double >( input[ 4 ] );
-    m( 2, 2 ) = static_cast< double >( input[ 5 ] );
-
-    ++*m_currentProgress;
-
-    return computeFaAndEigenVec( m );
-}
-
 void WMDeterministicFTMori::resetProgress( std::size_t todo )
 {
     if( m_currentProgress )
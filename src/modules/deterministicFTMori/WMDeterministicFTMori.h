@@ -33,10 +33,12 @@
 
 #include "core/kernel/WModule.h"
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
+#include "core/common/WRealtimeTimer.h"
 #include "core/common/WThreadedFunction.h"
-#include "core/dataHandler/WThreadedPerVoxelOperation.h"
+#include "core/dataHandler/WThreadedEigenSystems.h"
 #include "core/dataHandler/WThreadedTrackingFunction.h"
-#include "core/dataHandler/WFiberAccumulator.h"
+#include "core/dataHandler/WTrackingDirectionField.h"
+#include "core/dataHandler/WFiberBuilder.h"
 
 // forward delcarations
 class WDataSetFiberVector;
@@ -122,17 +124,8 @@ protected:
     virtual void activate();
 
 private:
-    //! the threaded per-voxel function for the eigenvector computation (float input)
-    typedef WThreadedPerVoxelOperation< float, 6, double, 4 > TPVOFloat;
-
-    //! the threaded per-voxel function for the eigenvector computation (double input)
-    typedef WThreadedPerVoxelOperation< double, 6, double, 4 > TPVODouble;
-
-    //! the thread pool type for the eigencomputation (float input)
-    typedef WThreadedFunction< TPVOFloat > EigenFunctionTypeFloat;
-
-    //! the thread pool type for the eigencomputation (double input)
-    typedef WThreadedFunction< TPVODouble > EigenFunctionTypeDouble;
+    //! the thread pool type for the eigencomputation
+    typedef WThreadedFunction< WThreadedEigenSystems > EigenFunctionType;
 
     //! the valueset type
     typedef WValueSet< double > FloatValueSetType;
@@ -147,46 +140,18 @@ private:
     typedef WThreadedFunction< Tracking > TrackingFuncType;
 
     /**
-     * The function that computes the eigenvectors from the input tensor field.
-     *
-     * \param input A subarray of a valueset that consists of the 6 floats that make up the tensor.
-     * \return The components of the largest eigenvector and the fa value in a 4-double array.
-     */
-    TPVOFloat::OutTransmitType const eigenFuncFloat( TPVOFloat::TransmitType const& input );
-
-    /**
-     * The function that computes the eigenvectors from the input tensor field.
-     *
-     * \param input A subarray of a valueset that consists of the 6 floats that make up the tensor.
-     * \return The components of the largest eigenvector and the fa value in a 4-double array.
-     */
-    TPVODouble::OutTransmitType const eigenFuncDouble( TPVODouble::TransmitType const& input );
-
-    /**
-     * The function that does the actual fa and eigenvector computations.
-     *
-     * \param m The tensor to calculate the fa and largest eigenvector from.
-     * \return The largest eigenvector and fa (in this order).
-     */
-    boost::array< double, 4 > const computeFaAndEigenVec( WTensorSym< 2, 3, double > const& m ) const;
-
-    /**
-     * Calculate the direction of the eigenvector with largest magnitude.
+     * Looks up the next direction in the direction field, either of the current voxel or interpolated.
      *
-     * \param ds The dataset.
      * \param j The job, that means the current position and direction of the last fiber segment.
      *
      * \return The direction to follow.
      */
-    WVector3d getEigenDirection( boost::shared_ptr< WDataSetSingle const > ds,
-                                        wtracking::WTrackingUtility::JobType const& j );
+    WVector3d getDirection( boost::shared_ptr< WDataSetSingle const >, wtracking::WTrackingUtility::JobType const& j );
 
     /**
-     * The fiber visitor. Adds a fiber to the result data and increment the progress.
-     *
-     * \param f The fiber.
+     * The fiber visitor. Increments the progress, the fibers are collected by the fiber builder.
      */
-    void fiberVis( FiberType const& f );
+    void fiberVis( FiberType const& );
 
     /**
      * The point visitor. Does nothing.
@@ -228,11 +193,11 @@ private:
     //! Stores eigenvectors and fractional anisotropy of the input dataset.
     boost::shared_ptr< WDataSetSingle > m_eigenField;
 
-    //! the functor used for the calculation of the eigenvectors
-    boost::shared_ptr< TPVOFloat > m_eigenOperationFloat;
+    //! The principal directions and FA prepared for tracking.
+    wtracking::WTrackingDirectionField::SPtr m_directionField;
 
     //! the functor used for the calculation of the eigenvectors
-    boost::shared_ptr< TPVODouble > m_eigenOperationDouble;
+    boost::shared_ptr< WThreadedEigenSystems > m_eigenOperation;
 
     //! the object that keeps track of the current progress
     boost::shared_ptr< WProgress > m_currentProgress;
@@ -243,8 +208,11 @@ private:
     //! The threadpool for the tracking
     boost::shared_ptr< TrackingFuncType > m_trackingPool;
 
-    //! The fiber accumulator
-    WFiberAccumulator m_fiberAccu;
+    //! Collects the fibers of all tracking threads.
+    WFiberBuilder::SPtr m_fiberBuilder;
+
+    //! The time since the partial result was last forwarded.
+    WRealtimeTimer m_partialResultTimer;
 
     //! The minimum FA property.
     WPropDouble m_minFA;
@@ -255,6 +223,9 @@ private:
     //! The minimum cosine property.
     WPropDouble m_minCos;
 
+    //! Whether the directions are interpolated.
+    WPropBool m_interpolate;
+
     //! The current minimum FA property.
     double m_currentMinFA;
 
@@ -263,6 +234,9 @@ private:
 
     //! The current minimum cosine property.
     double m_currentMinCos;
+
+    //! The current interpolation property.
+    bool m_currentInterpolate;
 };
 
 #endif  // WMDETERMINISTICFTMORI_H
@@ -22,6 +22,8 @@
 //
 //---------------------------------------------------------------------------
 
+#include "core/dataHandler/WThreadedScalarMaps.h"
+
 #include "WAD.h"
 
 WAD::WAD()
@@ -33,3 +35,8 @@ double WAD::tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, floa
 {
     return evals[0];
 }
+
+unsigned int WAD::getFusedMeasure() const
+{
+    return WThreadedScalarMaps::AD;
+}
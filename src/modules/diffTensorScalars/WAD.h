@@ -55,6 +55,13 @@ protected:
      * \return The AD of the tensor.
      */
     virtual double tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, float >& tensor );
+
+    /**
+     * The AD is computed by WThreadedScalarMaps directly from the tensors.
+     *
+     * \return WThreadedScalarMaps::AD
+     */
+    virtual unsigned int getFusedMeasure() const;
 };
 
 #endif  // WAD_H
@@ -24,22 +24,50 @@
 
 #include <vector>
 
+#include <boost/bind.hpp>
+
 #include "core/common/WFlag.h"
 #include "core/common/WLogger.h"
 #include "core/common/WProgress.h"
+#include "core/common/WThreadedFunction.h"
 #include "core/dataHandler/WDataSetDTI.h"
 #include "core/dataHandler/WDataSetScalar.h"
 #include "core/dataHandler/WDataSetVector.h"
+#include "core/dataHandler/WThreadedScalarMaps.h"
 #include "WDataSetDTIToScalar_I.h"
 
 WDataSetDTIToScalar_I::~WDataSetDTIToScalar_I()
 {
 }
 
+bool WDataSetDTIToScalar_I::needsEigenvalues() const
+{
+    return getFusedMeasure() == 0;
+}
+
+unsigned int WDataSetDTIToScalar_I::getFusedMeasure() const
+{
+    return 0;
+}
+
 WDataSetScalar::SPtr WDataSetDTIToScalar_I::operator()( WProgress::SPtr progress, WBoolFlag const &shutdown,
     WDataSetDTI::SPtr tensors, WDataSetVector::SPtr evals )
 {
     wlog::debug( "WDataSetDTIToScalar_I" ) << "Start computation";
+    if( !needsEigenvalues() )
+    {
+        WThreadedScalarMaps::Measure const measure = static_cast< WThreadedScalarMaps::Measure >( getFusedMeasure() );
+        WThreadedScalarMaps maps( measure, tensors, WDataSetSphericalHarmonics::SPtr(), progress );
+        runThreadedRanges( maps.size(), W_AUTOMATIC_NB_THREADS,
+                           boost::bind( &WThreadedScalarMaps::computeRange, &maps, _1, _2, boost::cref( shutdown ) ) );
+        if( shutdown )
+        {
+            return WDataSetScalar::SPtr( new WDataSetScalar() ); // incase we had to abort due to shutdown, empty result
+        }
+        wlog::debug( "WDataSetDTIToScalar_I" ) << "Computation done.";
+        return maps.getResult( measure );
+    }
+
     typedef double ValueType;
     typedef WValueSet< ValueType > ValueSetType;
     boost::shared_ptr< WGrid > grid( evals->getGrid() );
@@ -43,12 +43,13 @@ class WDataSetDTIToScalar_I
 {
 public:
     /**
-     * This runs the given strategy on the given dataset.
+     * This runs the given strategy on the given dataset. Measures of WThreadedScalarMaps are computed by it from the
+     * tensors with all threads, without the eigenvalues.
      *
      * \param progress the progress instance you should increment each time you fill the value for one voxel.
      * \param shutdown Possibility to abort in case of shutdown.
      * \param tensors The tensor components
-     * \param evals The Eigenvalues
+     * \param evals The Eigenvalues, may be empty if needsEigenvalues() is false.
      *
      * \return The scalar dataset, for which each tensor a scalar value is derived according to the subclass implementation.
      */
@@ -60,7 +61,21 @@ public:
      */
     virtual ~WDataSetDTIToScalar_I();
 
+    /**
+     * Whether operator() needs the eigenvalues.
+     *
+     * \return false for the measures computed by WThreadedScalarMaps
+     */
+    bool needsEigenvalues() const;
+
 protected:
+    /**
+     * The WThreadedScalarMaps::Measure computing the same scalar as tensorToScalar(), if there is one.
+     *
+     * \return the measure, 0 if there is none
+     */
+    virtual unsigned int getFusedMeasure() const;
+
     /**
      * Actual scalar computation.
      *
@@ -23,6 +23,9 @@
 //---------------------------------------------------------------------------
 
 #include <cmath>
+
+#include "core/dataHandler/WThreadedScalarMaps.h"
+
 #include "WFA.h"
 
 WFA::WFA()
@@ -39,3 +42,8 @@ double WFA::tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, floa
 
     return std::sqrt( 1.5 * nom / denom );
 }
+
+unsigned int WFA::getFusedMeasure() const
+{
+    return WThreadedScalarMaps::FA;
+}
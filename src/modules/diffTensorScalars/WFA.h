@@ -63,6 +63,13 @@ protected:
      * \return The FA of the tensor.
      */
     virtual double tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, float >& tensor );
+
+    /**
+     * The FA is computed by WThreadedScalarMaps directly from the tensors.
+     *
+     * \return WThreadedScalarMaps::FA
+     */
+    virtual unsigned int getFusedMeasure() const;
 };
 
 #endif  // WFA_H
@@ -23,6 +23,8 @@
 //---------------------------------------------------------------------------
 
 #include <cmath>
+#include "core/dataHandler/WThreadedScalarMaps.h"
+
 #include "WMD.h"
 
 WMD::WMD()
@@ -34,3 +36,8 @@ double WMD::tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, floa
 {
     return 1.0/3.0 * ( evals[0] + evals[1] + evals[2] );
 }
+
+unsigned int WMD::getFusedMeasure() const
+{
+    return WThreadedScalarMaps::MD;
+}
@@ -55,6 +55,13 @@ protected:
      * \return The MD of the tensor.
      */
     virtual double tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, float >& tensor );
+
+    /**
+     * The MD is computed by WThreadedScalarMaps directly from the tensors.
+     *
+     * \return WThreadedScalarMaps::MD
+     */
+    virtual unsigned int getFusedMeasure() const;
 };
 
 #endif  // WMD_H
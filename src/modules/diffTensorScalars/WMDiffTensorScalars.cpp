@@ -33,6 +33,7 @@
 #include "WRD.h"
 #include "WMD.h"
 #include "WAD.h"
+#include "WMode.h"
 
 W_LOADABLE_MODULE( WMDiffTensorScalars )
 
@@ -45,6 +46,7 @@ WMDiffTensorScalars::WMDiffTensorScalars()
     m_strategy.addStrategy( WTensorTrace::SPtr( new WAD() ) );
     m_strategy.addStrategy( WTensorTrace::SPtr( new WMD() ) );
     m_strategy.addStrategy( WTensorTrace::SPtr( new WRD() ) );
+    m_strategy.addStrategy( WTensorTrace::SPtr( new WMode() ) );
     m_strategy.addStrategy( WTensorTrace::SPtr( new WTensorTrace() ) );
 }
 
@@ -105,10 +107,19 @@ void WMDiffTensorScalars::moduleMain()
         if( evalsOC )
         {
             m_evals = evalsOC->getData();
-            m_tensors = m_tensorsIC->getData();
         }
+        m_tensors = m_tensorsIC->getData();
 
-        if( !m_tensors || !m_evals )
+        // FA, MD, RD, AD and mode are computed from the tensors and do not wait for the eigenvalues
+        WObjectNDIP< WDataSetDTIToScalar_I >::SPtr strategy = m_strategy();
+        bool needsEvals = strategy->needsEigenvalues();
+        if( !m_tensors || ( needsEvals && !m_evals ) )
+        {
+            continue;
+        }
+
+        // for them, the eigenvalues arriving later change nothing
+        if( !needsEvals && m_tensors == m_lastTensors && strategy == m_lastStrategy )
         {
             continue;
         }
@@ -116,10 +127,12 @@ void WMDiffTensorScalars::moduleMain()
         // Strategy anwenden
         debugLog() << "Start computing scalars...";
 
-        WProgress::SPtr progress( new WProgress( "Creating Dataset", m_evals->getGrid()->size() ) );
+        WProgress::SPtr progress( new WProgress( "Creating Dataset", m_tensors->getGrid()->size() ) );
         m_progress->addSubProgress( progress );
 
-        m_scalarOC->updateData( m_strategy()->operator()( progress, m_shutdownFlag, m_tensors, m_evals ) );
+        m_scalarOC->updateData( strategy->operator()( progress, m_shutdownFlag, m_tensors, m_evals ) );
+        m_lastTensors = m_tensors;
+        m_lastStrategy = strategy;
 
         progress->finish();
         m_progress->removeSubProgress( progress );
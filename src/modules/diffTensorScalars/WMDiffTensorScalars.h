@@ -109,6 +109,16 @@ private:
      */
     boost::shared_ptr< WDataSetDTI > m_tensors;
 
+    /**
+     * The tensors of the last computation.
+     */
+    boost::shared_ptr< WDataSetDTI > m_lastTensors;
+
+    /**
+     * The strategy of the last computation.
+     */
+    WObjectNDIP< WDataSetDTIToScalar_I >::SPtr m_lastStrategy;
+
     /**
      * Output connector for the computed scalars.
      */
@@ -0,0 +1,54 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/dataHandler/WThreadedScalarMaps.h"
+
+#include "WMode.h"
+
+WMode::WMode()
+    : WObjectNDIP< WDataSetDTIToScalar_I >( "Mode", "Computes the mode of the tensor" )
+{
+}
+
+double WMode::tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, float >& /* tensor */ )
+{
+    const WVector3d& l = evals; // shorthand (name) for lambda_1,...
+    double mean = ( l[0] + l[1] + l[2] ) / 3.0;
+    double norm2 = ( l[0] - mean ) * ( l[0] - mean ) + ( l[1] - mean ) * ( l[1] - mean ) + ( l[2] - mean ) * ( l[2] - mean );
+    if( norm2 <= 0.0 )
+    {
+        return 0.0;
+    }
+
+    double mode = std::sqrt( 54.0 ) * ( l[0] - mean ) * ( l[1] - mean ) * ( l[2] - mean ) / ( norm2 * std::sqrt( norm2 ) );
+    return std::max( -1.0, std::min( 1.0, mode ) );
+}
+
+unsigned int WMode::getFusedMeasure() const
+{
+    return WThreadedScalarMaps::MODE;
+}
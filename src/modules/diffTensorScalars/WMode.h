@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMODE_H
+#define WMODE_H
+
+#include "core/common/math/linearAlgebra/WVectorFixed.h"
+#include "core/common/math/WTensorSym.h"
+#include "core/common/WObjectNDIP.h"
+
+#include "WDataSetDTIToScalar_I.h"
+
+/**
+ * Computes the mode of a given Tensor, between -1 for planar and 1 for linear tensors.
+ * \f[
+ *   \hat{\lambda} = \frac{1}{3} \sum \lambda_i, \quad d_i = \lambda_i - \hat{\lambda}
+ * \f]
+ *
+ * \f[
+ *   mode = \sqrt{54} \frac{ d_1 d_2 d_3 }{ \left( d_1^2 + d_2^2 + d_3^2 \right)^{3/2} }
+ * \f]
+ */
+class WMode : public WObjectNDIP< WDataSetDTIToScalar_I >
+{
+public:
+    /**
+     * Creates an object to perform the computation.
+     */
+    WMode();
+
+protected:
+    /**
+     * Actual mode computation takes place inhere.
+     *
+     * \param evals With the three given Eigenvalues, we may compute the mode. See above for the formula.
+     * \param tensor Although not needed for mode computation, the API requires us to use the signature.
+     *
+     * \return The mode of the tensor.
+     */
+    virtual double tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, float >& tensor );
+
+    /**
+     * The mode is computed by WThreadedScalarMaps directly from the tensors.
+     *
+     * \return WThreadedScalarMaps::MODE
+     */
+    virtual unsigned int getFusedMeasure() const;
+};
+
+#endif  // WMODE_H
@@ -23,6 +23,8 @@
 //---------------------------------------------------------------------------
 
 #include <cmath>
+#include "core/dataHandler/WThreadedScalarMaps.h"
+
 #include "WRD.h"
 
 WRD::WRD()
@@ -34,3 +36,8 @@ double WRD::tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, floa
 {
     return  0.5 * ( evals[1] + evals[2] );
 }
+
+unsigned int WRD::getFusedMeasure() const
+{
+    return WThreadedScalarMaps::RD;
+}
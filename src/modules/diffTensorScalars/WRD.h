@@ -55,6 +55,13 @@ protected:
      * \return The RD of the tensor.
      */
     virtual double tensorToScalar( const WVector3d& evals, const WTensorSym< 2, 3, float >& tensor );
+
+    /**
+     * The RD is computed by WThreadedScalarMaps directly from the tensors.
+     *
+     * \return WThreadedScalarMaps::RD
+     */
+    virtual unsigned int getFusedMeasure() const;
 };
 
 #endif  // WRD_H
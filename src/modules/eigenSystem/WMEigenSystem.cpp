@@ -92,8 +92,9 @@ void WMEigenSystem::properties()
     boost::shared_ptr< WItemSelection > strategies( new WItemSelection() );
     strategies->addItem( "LibEigen", "Eigensystem is computed via libEigen and its SelfAdjointEigenSolver" );
     strategies->addItem( "Jacobi", "Self implemented Jacobi iterative eigen decomposition" );
+    strategies->addItem( "Cardano", "Closed-form decomposition of whole blocks of tensors, using Jacobi only for (nearly) degenerate ones" );
     m_strategySelector = m_properties->addProperty( "Strategy", "How the eigen system should be computed",
-            strategies->getSelectorFirst() );
+            strategies->getSelectorLast() );
 
     WPropertyHelper::PC_SELECTONLYONE::addTo( m_strategySelector );
     WPropertyHelper::PC_NOTEMPTY::addTo( m_strategySelector );
@@ -130,12 +131,13 @@ void WMEigenSystem::moduleMain()
         {
             // start the eigenvector computation if input is DTI double or float otherwise continue
             // when the computation finishes, we'll be notified by the threadspool's threadsDoneCondition
+            resetProgress( tensors->getValueSet()->size(), "Compute eigen system" );
             resetEigenFunction( tensors );
             if( !m_eigenPool )
             {
+                m_currentProgress->finish();
                 continue;
             }
-            resetProgress( tensors->getValueSet()->size(), "Compute eigen system" );
             m_eigenPool->run();
             infoLog() << "Computing eigen systems...";
         }
@@ -143,9 +145,14 @@ void WMEigenSystem::moduleMain()
         {
             // the computation of the eigenvectors has finished we have a new field of eigen systems
             m_currentProgress->finish();
-            WAssert( m_eigenOperationFloat || m_eigenOperationDouble, "Bug: No result is available. Checked double and float!" );
+            WAssert( m_eigenOperationFloat || m_eigenOperationDouble || m_eigenOperationBatched,
+                     "Bug: No result is available. Checked double, float and batched!" );
 
-            if( tensors->getValueSet()->getDataType() == W_DT_DOUBLE )
+            if( m_eigenOperationBatched )
+            {
+                updateOCs( m_eigenOperationBatched->getResult() );
+            }
+            else if( tensors->getValueSet()->getDataType() == W_DT_DOUBLE )
             {
                 updateOCs( m_eigenOperationDouble->getResult() );
             }
@@ -328,9 +335,18 @@ void WMEigenSystem::resetEigenFunction( boost::shared_ptr< WDataSetDTI > tensors
 
     m_eigenOperationFloat = boost::shared_ptr< TPVOFloat >();
     m_eigenOperationDouble = boost::shared_ptr< TPVODouble >();
+    m_eigenOperationBatched = boost::shared_ptr< WThreadedEigenSystems >();
 
     // create a new one
-    if( tensors->getValueSet()->getDataType() == W_DT_DOUBLE )
+    WDataType dataType = tensors->getValueSet()->getDataType();
+    if( m_strategySelector->get().at( 0 )->getName() == "Cardano" && ( dataType == W_DT_DOUBLE || dataType == W_DT_FLOAT ) )
+    {
+        m_eigenOperationBatched = boost::shared_ptr< WThreadedEigenSystems >(
+            new WThreadedEigenSystems( tensors, WThreadedEigenSystems::EIGEN_SYSTEMS, m_currentProgress ) );
+        m_eigenPool = boost::shared_ptr< WThreadedFunctionBase >( new EigenFunctionTypeBatched( W_AUTOMATIC_NB_THREADS, m_eigenOperationBatched ) );
+        m_moduleState.add( m_eigenPool->getThreadsDoneCondition() );
+    }
+    else if( dataType == W_DT_DOUBLE )
     {
         if( m_strategySelector->get().at( 0 )->getName() == "LibEigen" )
         {
@@ -347,7 +363,7 @@ void WMEigenSystem::resetEigenFunction( boost::shared_ptr< WDataSetDTI > tensors
         m_eigenPool = boost::shared_ptr< WThreadedFunctionBase >( new EigenFunctionTypeDouble( W_AUTOMATIC_NB_THREADS, m_eigenOperationDouble ) );
         m_moduleState.add( m_eigenPool->getThreadsDoneCondition() );
     }
-    else if( tensors->getValueSet()->getDataType() == W_DT_FLOAT )
+    else if( dataType == W_DT_FLOAT )
     {
         if( m_strategySelector->get().at( 0 )->getName() == "LibEigen" )
         {
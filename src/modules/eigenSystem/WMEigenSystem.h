@@ -35,6 +35,7 @@
 
 #include "core/common/math/WTensorFunctions.h"
 #include "core/common/WThreadedFunction.h"
+#include "core/dataHandler/WThreadedEigenSystems.h"
 #include "core/dataHandler/WThreadedPerVoxelOperation.h"
 #include "core/dataHandler/WThreadedTrackingFunction.h"
 #include "core/kernel/WModule.h"
@@ -124,6 +125,9 @@ private:
     //! the thread pool type for the eigencomputation (double input)
     typedef WThreadedFunction< TPVODouble > EigenFunctionTypeDouble;
 
+    //! the thread pool type for the batched eigencomputation (float and double input)
+    typedef WThreadedFunction< WThreadedEigenSystems > EigenFunctionTypeBatched;
+
     //! the valueset type
     typedef WValueSet< double > FloatValueSetType;
 
@@ -236,6 +240,9 @@ private:
     //! the functor used for the calculation of the eigenvectors
     boost::shared_ptr< TPVODouble > m_eigenOperationDouble;
 
+    //! the functor used for the batched calculation of the eigenvectors
+    boost::shared_ptr< WThreadedEigenSystems > m_eigenOperationBatched;
+
     /**
      * Indicating current work progress.
      */
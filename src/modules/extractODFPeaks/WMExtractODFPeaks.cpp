@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <string>
+
+#include "core/common/math/WMath.h"
+#include "core/kernel/WKernel.h"
+#include "WMExtractODFPeaks.xpm"
+
+#include "WMExtractODFPeaks.h"
+
+// This line is needed by the module loader to actually find your module. Do not remove. Do NOT add a ";" here.
+W_LOADABLE_MODULE( WMExtractODFPeaks )
+
+WMExtractODFPeaks::WMExtractODFPeaks():
+    WModule()
+{
+}
+
+WMExtractODFPeaks::~WMExtractODFPeaks()
+{
+}
+
+boost::shared_ptr< WModule > WMExtractODFPeaks::factory() const
+{
+    return boost::shared_ptr< WModule >( new WMExtractODFPeaks() );
+}
+
+const char** WMExtractODFPeaks::getXPMIcon() const
+{
+    return WMExtractODFPeaks_xpm;
+}
+
+const std::string WMExtractODFPeaks::getName() const
+{
+    return "Extract ODF Peaks";
+}
+
+const std::string WMExtractODFPeaks::getDescription() const
+{
+    return "Finds the peak directions and values of the ODFs of a spherical harmonics dataset.";
+}
+
+void WMExtractODFPeaks::connectors()
+{
+    m_input = boost::shared_ptr< WModuleInputData< WDataSetSphericalHarmonics > >(
+                            new WModuleInputData< WDataSetSphericalHarmonics >( shared_from_this(),
+                                "inSH", "A spherical harmonics dataset." )
+            );
+
+    m_output = boost::shared_ptr< WModuleOutputData< WDataSetODFPeaks > >( new WModuleOutputData< WDataSetODFPeaks >( shared_from_this(),
+                "outPeaks", "The peak directions and values of every voxel." )
+            );
+
+    addConnector( m_input );
+    addConnector( m_output );
+
+    // call WModules initialization
+    WModule::connectors();
+}
+
+void WMExtractODFPeaks::properties()
+{
+    m_propCondition = boost::shared_ptr< WCondition >( new WCondition() );
+    m_exceptionCondition = boost::shared_ptr< WCondition >( new WCondition() );
+
+    m_maxPeaks = m_properties->addProperty( "Maximum peaks", "The maximum number of peaks per voxel.", 3, m_propCondition );
+    m_maxPeaks->setMin( 1 );
+    m_maxPeaks->setMax( 8 );
+
+    m_relativeThreshold = m_properties->addProperty( "Relative threshold",
+                                                     "Peaks below this fraction of the largest peak of a voxel are dropped.",
+                                                     0.5, m_propCondition );
+    m_relativeThreshold->setMin( 0.0 );
+    m_relativeThreshold->setMax( 1.0 );
+
+    m_minSeparationAngle = m_properties->addProperty( "Minimum separation angle",
+                                                      "Peaks closer than this angle (in degrees) to a larger peak are dropped.",
+                                                      20.0, m_propCondition );
+    m_minSeparationAngle->setMin( 0.0 );
+    m_minSeparationAngle->setMax( 90.0 );
+
+    WModule::properties();
+}
+
+void WMExtractODFPeaks::moduleMain()
+{
+    m_moduleState.setResetable( true, true );
+    m_moduleState.add( m_input->getDataChangedCondition() );
+    m_moduleState.add( m_propCondition );
+    m_moduleState.add( m_exceptionCondition );
+
+    ready();
+
+    while( !m_shutdownFlag() )
+    {
+        debugLog() << "Waiting.";
+        m_moduleState.wait();
+
+        boost::shared_ptr< WDataSetSphericalHarmonics > inData = m_input->getData();
+        bool dataChanged = ( m_dataSet != inData );
+        bool propertiesChanged = m_maxPeaks->changed() || m_relativeThreshold->changed() || m_minSeparationAngle->changed();
+
+        if( inData && ( dataChanged || propertiesChanged ) )
+        {
+            m_dataSet = inData;
+
+            // start computation
+            resetPeakPool();
+            if( m_peakPool )
+            {
+                m_peakPool->run();
+            }
+            debugLog() << "Running computation.";
+        }
+        else if( m_peakPool && ( m_peakPool->status() == W_THREADS_FINISHED || m_peakPool->status() == W_THREADS_ABORTED ) )
+        {
+            debugLog() << "Computation finished.";
+            m_currentProgress->finish();
+            if( m_peakPool->status() == W_THREADS_FINISHED )
+            {
+                // forward result
+                m_output->updateData( m_peakFunc->getResult() );
+            }
+            m_peakPool = boost::shared_ptr< PeakPoolType >();
+            m_peakFunc = boost::shared_ptr< WThreadedODFPeaks >();
+        }
+        else if( m_lastException )
+        {
+            throw WException( *m_lastException );
+        }
+    }
+
+    // module shutdown
+    debugLog() << "Shutting down module.";
+    if( m_peakPool )
+    {
+        if( m_peakPool->status() == W_THREADS_RUNNING || m_peakPool->status() == W_THREADS_STOP_REQUESTED )
+        {
+            m_peakPool->stop();
+            m_peakPool->wait();
+        }
+    }
+}
+
+void WMExtractODFPeaks::resetPeakPool()
+{
+    if( m_peakPool )
+    {
+        WThreadedFunctionStatus s = m_peakPool->status();
+        if( s != W_THREADS_FINISHED && s != W_THREADS_ABORTED )
+        {
+            m_peakPool->stop();
+            m_peakPool->wait();
+            s = m_peakPool->status();
+            WAssert( s == W_THREADS_FINISHED || s == W_THREADS_ABORTED, "" );
+        }
+        m_moduleState.remove( m_peakPool->getThreadsDoneCondition() );
+        m_peakPool = boost::shared_ptr< PeakPoolType >();
+    }
+    // the threadpool should have finished computing by now
+
+    try
+    {
+        resetProgress( m_dataSet->getValueSet()->size() );
+        m_peakFunc = boost::shared_ptr< WThreadedODFPeaks >( new WThreadedODFPeaks( m_dataSet,
+                                                                                    static_cast< std::size_t >( m_maxPeaks->get( true ) ),
+                                                                                    m_relativeThreshold->get( true ),
+                                                                                    m_minSeparationAngle->get( true ) * pi() / 180.0,
+                                                                                    m_currentProgress ) );
+    }
+    catch( WException const& e )
+    {
+        errorLog() << "Cannot extract peaks: " << e.what();
+        m_currentProgress->finish();
+        m_peakFunc = boost::shared_ptr< WThreadedODFPeaks >();
+        return;
+    }
+
+    // create a new one
+    m_peakPool = boost::shared_ptr< PeakPoolType >( new PeakPoolType( 0, m_peakFunc ) );
+    m_peakPool->subscribeExceptionSignal( boost::bind( &This::handleException, this, _1 ) );
+    m_moduleState.add( m_peakPool->getThreadsDoneCondition() );
+}
+
+void WMExtractODFPeaks::handleException( WException const& e )
+{
+    m_lastException = boost::shared_ptr< WException >( new WException( e ) );
+    m_exceptionCondition->notify();
+}
+
+void WMExtractODFPeaks::resetProgress( std::size_t todo )
+{
+    if( m_currentProgress )
+    {
+        m_currentProgress->finish();
+    }
+    m_currentProgress = boost::shared_ptr< WProgress >( new WProgress( "extract odf peaks", todo ) );
+    m_progress->addSubProgress( m_currentProgress );
+}
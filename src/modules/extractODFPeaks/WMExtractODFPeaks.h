@@ -0,0 +1,165 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMEXTRACTODFPEAKS_H
+#define WMEXTRACTODFPEAKS_H
+
+#include <string>
+
+#include "core/kernel/WModule.h"
+#include "core/kernel/WModuleInputData.h"
+#include "core/kernel/WModuleOutputData.h"
+#include "core/common/WThreadedFunction.h"
+#include "core/dataHandler/WDataSetODFPeaks.h"
+#include "core/dataHandler/WDataSetSphericalHarmonics.h"
+#include "core/dataHandler/WThreadedODFPeaks.h"
+
+/**
+ * \class WMExtractODFPeaks
+ *
+ * A module that finds the peak directions of the ODFs of all voxels of a spherical harmonics dataset, using all
+ * available cores. The result is a compact dataset that tracking and glyph modules can use instead of evaluating
+ * the ODFs again.
+ *
+ * \ingroup modules
+ */
+class WMExtractODFPeaks: public WModule
+{
+    //! a conveniance typedef
+    typedef WMExtractODFPeaks This;
+
+public:
+    /**
+     * Standard constructor.
+     */
+    WMExtractODFPeaks();
+
+    /**
+     * Destructor.
+     */
+    virtual ~WMExtractODFPeaks();
+
+    /**
+     * Gives back the name of this module.
+     * \return the module's name.
+     */
+    virtual const std::string getName() const;
+
+    /**
+     * Gives back a description of this module.
+     * \return description to module.
+     */
+    virtual const std::string getDescription() const;
+
+    /**
+     * Due to the prototype design pattern used to build modules, this method returns a new instance of this method. NOTE: it
+     * should never be initialized or modified in some other way. A simple new instance is required.
+     *
+     * \return the prototype used to create every module in OpenWalnut.
+     */
+    virtual boost::shared_ptr< WModule > factory() const;
+
+    /**
+     * Get the icon for this module in XPM format.
+     * \return The icon.
+     */
+    virtual const char** getXPMIcon() const;
+
+protected:
+    /**
+     * Entry point after loading the module. Runs in separate thread.
+     */
+    virtual void moduleMain();
+
+    /**
+     * Initialize the connectors this module is using.
+     */
+    virtual void connectors();
+
+    /**
+     * Initialize the properties for this module.
+     */
+    virtual void properties();
+
+private:
+    //! the threadpool
+    typedef WThreadedFunction< WThreadedODFPeaks > PeakPoolType;
+
+    /**
+     * Stops a running computation and starts a new one for the current dataset and properties.
+     */
+    void resetPeakPool();
+
+    /**
+     * Handle an exception thrown by a worker thread.
+     *
+     * \param e The exception that was thrown during multithreaded computation.
+     */
+    void handleException( WException const& e );
+
+    /**
+     * Reset the progress indicator in the ui.
+     *
+     * \param todo The number of steps needed to complete the job.
+     */
+    void resetProgress( std::size_t todo );
+
+    //! A pointer to the input dataset.
+    boost::shared_ptr< WDataSetSphericalHarmonics > m_dataSet;
+
+    //! The input Connector for the SH data.
+    boost::shared_ptr< WModuleInputData< WDataSetSphericalHarmonics > > m_input;
+
+    //! The output Connector.
+    boost::shared_ptr< WModuleOutputData< WDataSetODFPeaks > > m_output;
+
+    //! The maximum number of peaks per voxel.
+    WPropInt m_maxPeaks;
+
+    //! Peaks below this fraction of the largest peak of a voxel are dropped.
+    WPropDouble m_relativeThreshold;
+
+    //! Peaks closer than this angle in degrees to a larger peak are dropped.
+    WPropDouble m_minSeparationAngle;
+
+    //! Condition notified when a property changed.
+    boost::shared_ptr< WCondition > m_propCondition;
+
+    //! The object that keeps track of the current progress.
+    boost::shared_ptr< WProgress > m_currentProgress;
+
+    //! The last exception thrown by any worker thread.
+    boost::shared_ptr< WException > m_lastException;
+
+    //! Condition indicating if any exception was thrown.
+    boost::shared_ptr< WCondition > m_exceptionCondition;
+
+    //! The threaded function object.
+    boost::shared_ptr< WThreadedODFPeaks > m_peakFunc;
+
+    //! The threadpool.
+    boost::shared_ptr< PeakPoolType > m_peakPool;
+};
+
+#endif  // WMEXTRACTODFPEAKS_H
@@ -22,6 +22,7 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <vector>
 #include <string>
 
@@ -59,7 +60,8 @@
 W_LOADABLE_MODULE( WMFiberDisplay )
 
 WMFiberDisplay::WMFiberDisplay():
-    WModule()
+    WModule(),
+    m_framesWithoutMotion( 0 )
 {
 }
 
@@ -139,6 +141,13 @@ void WMFiberDisplay::properties()
     m_tubeSize->setMin( 0.10 );
     m_tubeSize->setMax( 25.0 );
 
+    m_lodGroup = m_properties->addPropertyGroup( "Level of Detail", "Draw fewer and simplified fibers while the camera moves." );
+    m_lodEnable = m_lodGroup->addProperty( "Enable", "If set, a coarse version of the fibers is drawn while the camera moves. The coarse "
+                                                     "versions are computed in the background.", true, m_propCondition );
+    m_lodVertexBudget = m_lodGroup->addProperty( "Vertex budget", "The maximum number of vertices drawn while the camera moves.", 1000000 );
+    m_lodVertexBudget->setMin( 1000 );
+    m_lodVertexBudget->setMax( 100000000 );
+
     // call WModule's initialization
     WModule::properties();
 }
@@ -333,11 +342,15 @@ void WMFiberDisplay::moduleMain()
             // remove the fib's properties from my props
             m_coloringGroup->removeProperty( m_fibProps );
             m_fibProps.reset();
+
+            resetDetailLevels();
         }
 
         // something happened we are interested in?
         if( !( dataValid && ( propertiesUpdated || dataPropertiesUpdated || fibersUpdated || clusteringUpdated ) ) )
         {
+            // the hierarchy might have finished further levels or the level of detail was switched on
+            buildDetailLevels();
             debugLog() << "Nothing to do.";
             continue;
         }
@@ -395,27 +408,30 @@ void WMFiberDisplay::moduleMain()
             // we force the module to check if we need to enable normal colormapping even if ROI coloring is set
             roiUpdate();
 
-            // create the fiber geode
-            osg::ref_ptr< osg::Geode > geode = new osg::Geode();
-            osg::ref_ptr< osg::Geode > endCapGeode = new osg::Geode();
+            // the coarse levels of the new fibers or for the new rendering mode are built again
+            resetDetailLevels();
+
+            // create the fiber lineSwitch
+            osg::ref_ptr< osg::Switch > lineSwitch = new osg::Switch();
+            osg::ref_ptr< osg::Switch > endCapSwitch = new osg::Switch();
 
             // this avoids that the pick handler tries to pick in millions if lines and quads
-            geode->setName( "_Line Geode" );
-            endCapGeode->setName( "_Tube Cap Geode" );
-            geode->setNodeMask( 0x0000000F );
-            endCapGeode->setNodeMask( 0x0000000F );
+            lineSwitch->setName( "_Line Geode" );
+            endCapSwitch->setName( "_Tube Cap Geode" );
+            lineSwitch->setNodeMask( 0x0000000F );
+            endCapSwitch->setNodeMask( 0x0000000F );
 
-            createFiberGeode( fibers, geode, endCapGeode );
+            createFiberGeode( fibers, lineSwitch, endCapSwitch );
 
             // Apply the shader. This is for clipping.
-            m_shader->apply( geode );
-            m_endCapShader->apply( endCapGeode );
+            m_shader->apply( lineSwitch );
+            m_endCapShader->apply( endCapSwitch );
             // apply colormapping
-            WGEColormapping::apply( geode, m_shader );
-            WGEColormapping::apply( endCapGeode, m_endCapShader );
+            WGEColormapping::apply( lineSwitch, m_shader );
+            WGEColormapping::apply( endCapSwitch, m_endCapShader );
 
             // for line smoothing and width features
-            geode->getOrCreateStateSet()->setUpdateCallback( new WGEFunctorCallback< osg::StateSet >(
+            lineSwitch->getOrCreateStateSet()->setUpdateCallback( new WGEFunctorCallback< osg::StateSet >(
                 boost::bind( &WMFiberDisplay::lineGeodeStateCallback, this, _1 ) )
             );
 
@@ -423,11 +439,15 @@ void WMFiberDisplay::moduleMain()
             WKernel::getRunningKernel()->getGraphicsEngine()->getScene()->insert( m_plane );
 
             m_fiberClusteringUpdate = true;
-            postNode->insert( geode, m_shader );
-            postNode->insert( endCapGeode, m_endCapShader );
+            postNode->insert( lineSwitch, m_shader );
+            postNode->insert( endCapSwitch, m_endCapShader );
         }
+
+        buildDetailLevels();
     }
 
+    resetDetailLevels();
+
     // At this point, the container managing this module signalled to shutdown. The main loop has ended and you should clean up. Always remove
     // allocated memory and remove all OSG nodes.
     WKernel::getRunningKernel()->getGraphicsEngine()->getScene()->remove( postNode );
@@ -489,51 +509,19 @@ osg::ref_ptr< osg::Node > WMFiberDisplay::createClipPlane() const
     return planeTransform;
 }
 
-void WMFiberDisplay::createFiberGeode( boost::shared_ptr< WDataSetFibers > fibers, osg::ref_ptr< osg::Geode > fibGeode,
-                                                                                         osg::ref_ptr< osg::Geode > endCapGeode )
+void WMFiberDisplay::createFiberGeode( boost::shared_ptr< WDataSetFibers > fibers, osg::ref_ptr< osg::Switch > fibSwitch,
+                                                                                         osg::ref_ptr< osg::Switch > endCapSwitch )
 {
-    // geode and geometry
-    osg::StateSet* state = fibGeode->getOrCreateStateSet();
-    osg::StateSet* endState = endCapGeode->getOrCreateStateSet();
+    // the state is shared by all detail levels
+    osg::StateSet* state = fibSwitch->getOrCreateStateSet();
+    osg::StateSet* endState = endCapSwitch->getOrCreateStateSet();
 
     // disable light for this geode as lines can't be lit properly
     state->setMode( GL_LIGHTING, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED );
 
-    // create everything needed for the line_strip drawable
-    osg::ref_ptr< osg::Vec3Array > vertices = osg::ref_ptr< osg::Vec3Array >( new osg::Vec3Array );
-    osg::ref_ptr< osg::Vec4Array > colors = osg::ref_ptr< osg::Vec4Array >( new osg::Vec4Array );
-    osg::ref_ptr< osg::Vec3Array > tangents = osg::ref_ptr< osg::Vec3Array >( new osg::Vec3Array );
-    osg::ref_ptr< osg::FloatArray > texcoords = osg::ref_ptr< osg::FloatArray >( new osg::FloatArray );
-    osg::ref_ptr< osg::Geometry > geometry = osg::ref_ptr< osg::Geometry >( new osg::Geometry );
-
-    // new attribute array
-    m_bitfieldAttribs = new osg::FloatArray( m_fibers->getLineStartIndexes()->size() );
-    m_secondaryColor = new osg::Vec3Array( m_fibers->getLineStartIndexes()->size() );
-
-    // this is needed for the end- sprites
-    osg::ref_ptr< osg::Vec3Array > endVertices = osg::ref_ptr< osg::Vec3Array >( new osg::Vec3Array );
-    osg::ref_ptr< osg::Vec4Array > endColors = osg::ref_ptr< osg::Vec4Array >( new osg::Vec4Array );
-    osg::ref_ptr< osg::Vec3Array > endTangents = osg::ref_ptr< osg::Vec3Array >( new osg::Vec3Array );
-    osg::ref_ptr< osg::Geometry > endGeometry = osg::ref_ptr< osg::Geometry >( new osg::Geometry );
-
-    // this is needed for the end- sprites
-    // NOTE: we handle start caps and end caps separately here since the vertex attributes are per line so we need to have one cap per line.
-    osg::ref_ptr< osg::Vec3Array > startVertices = osg::ref_ptr< osg::Vec3Array >( new osg::Vec3Array );
-    osg::ref_ptr< osg::Vec4Array > startColors = osg::ref_ptr< osg::Vec4Array >( new osg::Vec4Array );
-    osg::ref_ptr< osg::Vec3Array > startTangents = osg::ref_ptr< osg::Vec3Array >( new osg::Vec3Array );
-    osg::ref_ptr< osg::Geometry > startGeometry = osg::ref_ptr< osg::Geometry >( new osg::Geometry );
-
-
-    // needed arrays for iterating the fibers
-    WDataSetFibers::IndexArray  fibStart = fibers->getLineStartIndexes();
-    WDataSetFibers::LengthArray fibLen   = fibers->getLineLengths();
-    WDataSetFibers::VertexArray fibVerts = fibers->getVertices();
-    WDataSetFibers::TangentArray fibTangents = fibers->getTangents();
-
     // get current color scheme - the mode is important as it defines the number of floats in the color array per vertex.
     WDataSetFibers::ColorScheme::ColorMode fibColorMode = fibers->getColorScheme()->getMode();
     debugLog() << "Color mode is " << fibColorMode << ".";
-    WDataSetFibers::ColorArray  fibColors = fibers->getColorScheme()->getColor();
     bool usePlainColor = m_plainColorMode->get( true );
     WColor plainColor = m_plainColor->get( true );
 
@@ -556,249 +544,295 @@ void WMFiberDisplay::createFiberGeode( boost::shared_ptr< WDataSetFibers > fiber
     endState->setMode( GL_BLEND, osg::StateAttribute::ON );
 
     // progress indication
-    boost::shared_ptr< WProgress > progress1( new WProgress( "Adding fibers to geode", fibStart->size() ) );
+    boost::shared_ptr< WProgress > progress1( new WProgress( "Adding fibers to geode", fibers->getLineStartIndexes()->size() ) );
     m_progress->addSubProgress( progress1 );
 
-    // for each fiber:
-    debugLog() << "Iterating over " << fibStart->size() << " fibers.";
-    debugLog() << "Number of vertices: " << fibVerts->size() / 3;
-    size_t currentStart = 0;
+    // build all fibers as one primitive set, the arrays are filled in parallel
+    debugLog() << "Building " << fibers->getLineStartIndexes()->size() << " fibers.";
+    debugLog() << "Number of vertices: " << fibers->getVertices()->size() / 3;
     bool tubeMode = m_tubeEnable->get( true );
-    for( size_t fidx = 0; fidx < fibStart->size() ; ++fidx )
-    {
-        ++*progress1;
+    WGEFiberGeometryBuilder::SPtr builder( new WGEFiberGeometryBuilder( fibers, tubeMode, usePlainColor, plainColor, progress1 ) );
+
+    // the shaders discard unselected fibers by this attribute, but the index buffers only contain selected fibers
+    m_bitfieldAttribs = new osg::FloatArray( 1 );
+    ( *m_bitfieldAttribs )[ 0 ] = 1.0f;
 
-        // the start vertex index
-        size_t sidx = fibStart->at( fidx ) * 3;
-        size_t csidx = fibStart->at( fidx ) * fibColorMode;
+    if( tubeMode )
+    {
+        endState->setAttribute( new osg::Point( 1.0f ), osg::StateAttribute::ON );
+    }
 
-        // the length of the fiber
-        size_t len = fibLen->at( fidx );
+    // the full resolution is level 0, it gets attached to the switches together with the ROI filter and colors by the update callback
+    {
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        m_lodBuilders.assign( 1, builder );
+        m_lodAttached.clear();
+        m_lineSwitch = fibSwitch;
+        m_endCapSwitch = endCapSwitch;
+    }
 
-        // also initialize the ROI filter bitfield
-        ( *m_bitfieldAttribs )[ fidx ] = m_fiberSelector->getBitfield()->at( fidx );
-        // NOTE: secondary color arrays only support RGB colors
-        WColor c = m_fiberSelector->getFiberColor( fidx );
-        ( *m_secondaryColor )[ fidx ] = osg::Vec3( c.r(), c.g(), c.b() );
+    // add an update callback which later handles several things like the filter, the cluster colors and the detail level
+    fibSwitch->setUpdateCallback( new WGEFunctorCallback< osg::Node >( boost::bind( &WMFiberDisplay::geometryUpdate, this, _1 ) ) );
 
-        // a line needs 2 verts at least
-        if( len < 2 )
-        {
-            continue;
-        }
+    debugLog() << "Building all fibers: done!";
+    progress1->finish();
+}
 
-        // provide tangents and vertices for the end-caps
-        if( tubeMode )
-        {
-            // NOTE: we could also use the tangents stored in the tangents array but we cannot ensure they are oriented always outwards.
-            // grab first and second vertex.
-            osg::Vec3 firstVert = osg::Vec3( fibVerts->at( ( 3 * 0 ) + sidx ),
-                                             fibVerts->at( ( 3 * 0 ) + sidx + 1 ),
-                                             fibVerts->at( ( 3 * 0 ) + sidx + 2 ) );
-            osg::Vec3 secondVert = osg::Vec3( fibVerts->at( ( 3 * 1 ) + sidx ),
-                                              fibVerts->at( ( 3 * 1 ) + sidx + 1 ),
-                                              fibVerts->at( ( 3 * 1 ) + sidx + 2 ) );
-            osg::Vec3 lastVert = osg::Vec3( fibVerts->at( ( 3 * ( len - 1 ) ) + sidx ),
-                                            fibVerts->at( ( 3 * ( len - 1 ) ) + sidx + 1 ),
-                                            fibVerts->at( ( 3 * ( len - 1 ) ) + sidx + 2 ) );
-            osg::Vec3 secondLastVert = osg::Vec3( fibVerts->at( ( 3 * ( len - 2 ) ) + sidx ),
-                                                  fibVerts->at( ( 3 * ( len - 2 ) ) + sidx + 1 ),
-                                                  fibVerts->at( ( 3 * ( len - 2 ) ) + sidx + 2 ) );
-            osg::Vec3 startNormal = firstVert - secondVert;
-            osg::Vec3 endNormal = lastVert - secondLastVert;
-            startTangents->push_back( startNormal );
-            startVertices->push_back( firstVert );
-            endTangents->push_back( endNormal );
-            endVertices->push_back( lastVert );
-        }
+void WMFiberDisplay::geometryUpdate( osg::Node* node )
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
 
-        // walk along the fiber
-        for( size_t k = 0; k < len; ++k )
-        {
-            osg::Vec3 vert = osg::Vec3( fibVerts->at( ( 3 * k ) + sidx ),
-                                        fibVerts->at( ( 3 * k ) + sidx + 1 ),
-                                        fibVerts->at( ( 3 * k ) + sidx + 2 ) );
+    // a replaced switch still gets updated until it is removed from the scene
+    if( node != m_lineSwitch.get() )
+    {
+        return;
+    }
+    m_lodAttached.resize( m_lodBuilders.size(), false );
 
-            osg::Vec3 tangent = osg::Vec3( fibTangents->at( ( 3 * k ) + sidx ),
-                                           fibTangents->at( ( 3 * k ) + sidx + 1 ),
-                                           fibTangents->at( ( 3 * k ) + sidx + 2 ) );
-            tangent.normalize();
+    if( m_fiberSelectorChanged )
+    {
+        bool overrideROIFiltering = m_fiberSelector->isNothingFiltered();
+        m_roiFilterColorsOverride->set( overrideROIFiltering ? 1.0f : 0.0f );
 
-            osg::Vec4 color = plainColor;
-            if( !usePlainColor )
+        m_fiberSelectorChanged = false;
+        // only the index buffers are rebuilt, the vertex arrays stay untouched
+        for( std::size_t level = 0; level < m_lodBuilders.size(); ++level )
+        {
+            if( m_lodAttached[ level ] )
             {
-                color = osg::Vec4( fibColors->at( ( fibColorMode * k ) + csidx + ( 0 % fibColorMode ) ),
-                                   fibColors->at( ( fibColorMode * k ) + csidx + ( 1 % fibColorMode ) ),
-                                   fibColors->at( ( fibColorMode * k ) + csidx + ( 2 % fibColorMode ) ),
-                                     ( fibColorMode == WDataSetFibers::ColorScheme::RGBA ) ?
-                                       fibColors->at( ( fibColorMode * k ) + csidx + ( 3 % fibColorMode ) ) : 1.0 );
+                updateSelection( level );
             }
+        }
+    }
 
-            vertices->push_back( vert );
-            colors->push_back( color );
-            tangents->push_back( tangent );
-
-            if( tubeMode )
+    // also handles a removed clustering, whose colors are dropped
+    if( m_fiberClusteringUpdate )
+    {
+        m_fiberClusteringUpdate = false;
+        for( std::size_t level = 0; level < m_lodBuilders.size(); ++level )
+        {
+            if( m_lodAttached[ level ] )
             {
-                // if in tube-mode, some final sprites are needed to provide some kind of ending for the tube
-                if( k == 0 )
-                {
-                    startColors->push_back( color );
-                }
-                if( k == len - 1 )
-                {
-                    endColors->push_back( color );
-                }
-
-                vertices->push_back( vert );
-                colors->push_back( color );
-                tangents->push_back( tangent );
-
-                // tex coords are only needed for fake-tubes
-                // NOTE: another possibility to transport the information of top and bottom vertex is to use the sign of tangent.x for example.
-                // This saves some mem.
-                texcoords->push_back( 1.0 );
-                texcoords->push_back( -1.0 );
+                updateClusterColors( level );
             }
         }
+    }
 
-        // add the above line-strip
-        if( m_tubeEnable->get() )
+    // add the geometry of new detail levels, child i of the switches is level i
+    for( std::size_t level = 0; level < m_lodBuilders.size(); ++level )
+    {
+        if( !m_lodBuilders[ level ] || m_lodAttached[ level ] )
         {
-            geometry->addPrimitiveSet( new osg::DrawArrays( osg::PrimitiveSet::QUAD_STRIP, 2 * currentStart, 2 * len ) );
-            }
-        else
+            continue;
+        }
+        while( m_lineSwitch->getNumChildren() <= level )
         {
-            geometry->addPrimitiveSet( new osg::DrawArrays( osg::PrimitiveSet::LINE_STRIP, currentStart, len ) );
+            osg::ref_ptr< osg::Geode > geode = new osg::Geode();
+            osg::ref_ptr< osg::Geode > endCapGeode = new osg::Geode();
+            geode->setName( "_Line Geode" );
+            endCapGeode->setName( "_Tube Cap Geode" );
+            m_lineSwitch->addChild( geode, false );
+            m_endCapSwitch->addChild( endCapGeode, false );
         }
 
-        currentStart += len;
+        osg::ref_ptr< osg::Geometry > geometry = m_lodBuilders[ level ]->getGeometry();
+        geometry->setVertexAttribArray( 6, m_bitfieldAttribs );
+        geometry->setVertexAttribBinding( 6, osg::Geometry::BIND_OVERALL );
+        static_cast< osg::Geode* >( m_lineSwitch->getChild( level ) )->addDrawable( geometry );
+
+        if( m_lodBuilders[ level ]->getStartCapGeometry() )
+        {
+            osg::ref_ptr< osg::Geometry > startGeometry = m_lodBuilders[ level ]->getStartCapGeometry();
+            osg::ref_ptr< osg::Geometry > endGeometry = m_lodBuilders[ level ]->getEndCapGeometry();
+            startGeometry->setVertexAttribArray( 6, m_bitfieldAttribs );
+            startGeometry->setVertexAttribBinding( 6, osg::Geometry::BIND_OVERALL );
+            endGeometry->setVertexAttribArray( 6, m_bitfieldAttribs );
+            endGeometry->setVertexAttribBinding( 6, osg::Geometry::BIND_OVERALL );
+            static_cast< osg::Geode* >( m_endCapSwitch->getChild( level ) )->addDrawable( startGeometry );
+            static_cast< osg::Geode* >( m_endCapSwitch->getChild( level ) )->addDrawable( endGeometry );
+        }
+
+        updateSelection( level );
+        if( m_fiberClustering )
+        {
+            updateClusterColors( level );
+        }
+        m_lodAttached[ level ] = true;
     }
 
-    // combine these arrays to the geometry
-    geometry->setVertexArray( vertices );
-    geometry->setColorArray( colors );
-    geometry->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
-    geometry->setNormalArray( tangents );
-    geometry->setNormalBinding( osg::Geometry::BIND_PER_VERTEX );
-    if( tubeMode )    // tex coords are only needed for fake-tubes
+    std::size_t level = chooseDetailLevel();
+    if( level < m_lineSwitch->getNumChildren() )
     {
-        geometry->setTexCoordArray( 0, texcoords );
-
-        // also create the end-sprite geometry
-        endGeometry->addPrimitiveSet( new osg::DrawArrays( osg::PrimitiveSet::POINTS, 0, endVertices->size() ) );
-        endGeometry->setVertexArray( endVertices );
-        endGeometry->setColorArray( endColors );
-        endGeometry->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
-        endGeometry->setNormalArray( endTangents );
-        endGeometry->setNormalBinding( osg::Geometry::BIND_PER_VERTEX );
-
-        startGeometry->addPrimitiveSet( new osg::DrawArrays( osg::PrimitiveSet::POINTS, 0, startVertices->size() ) );
-        startGeometry->setVertexArray( startVertices );
-        startGeometry->setColorArray( startColors );
-        startGeometry->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
-        startGeometry->setNormalArray( startTangents );
-        startGeometry->setNormalBinding( osg::Geometry::BIND_PER_VERTEX );
-
-        endCapGeode->addDrawable( startGeometry );
-        endCapGeode->addDrawable( endGeometry );
+        m_lineSwitch->setSingleChildOn( level );
+        m_endCapSwitch->setSingleChildOn( level );
+    }
+}
 
-        endState->setAttribute( new osg::Point( 1.0f ), osg::StateAttribute::ON );
+void WMFiberDisplay::updateSelection( std::size_t level )
+{
+    // coarse levels contain a subset of the fibers, these are mapped to the original fiber indices
+    WDataSetFibers::IndexArray sources;
+    if( level > 0 )
+    {
+        sources = m_lodHierarchy->getSourceFibers( level );
     }
-    // enable VBO
-    geometry->setUseDisplayList( false );
-    geometry->setUseVertexBufferObjects( true );
-    startGeometry->setUseDisplayList( false );
-    startGeometry->setUseVertexBufferObjects( true );
-    endGeometry->setUseDisplayList( false );
-    endGeometry->setUseVertexBufferObjects( true );
-
-    // bind the attribute
-    geometry->setVertexAttribArray( 6, m_bitfieldAttribs );
-    geometry->setSecondaryColorArray( m_secondaryColor );
-    // the attributes are define per line strip, thus we bind the array accordingly
-    geometry->setVertexAttribBinding( 6, osg::Geometry::BIND_PER_PRIMITIVE_SET );
-    geometry->setSecondaryColorBinding( osg::Geometry::BIND_PER_PRIMITIVE_SET );
 
-    if( tubeMode )
+    std::size_t numFibers = sources ? sources->size() : m_fibers->getLineStartIndexes()->size();
+    boost::shared_ptr< std::vector< bool > > bitfield = m_fiberSelector->getBitfield();
+    std::vector< bool > selection( numFibers );
+    std::vector< osg::Vec3 > roiColors( numFibers );
+    for( size_t fidx = 0; fidx < numFibers; ++fidx )
     {
-        // we have one vertex per line, so bind the attribute array per vertex
-        startGeometry->setVertexAttribArray( 6, m_bitfieldAttribs );
-        startGeometry->setVertexAttribBinding( 6, osg::Geometry::BIND_PER_PRIMITIVE_SET );
-        endGeometry->setVertexAttribArray( 6, m_bitfieldAttribs );
-        endGeometry->setVertexAttribBinding( 6, osg::Geometry::BIND_PER_PRIMITIVE_SET );
-
-        startGeometry->setSecondaryColorArray( m_secondaryColor );
-        startGeometry->setSecondaryColorBinding( osg::Geometry::BIND_PER_PRIMITIVE_SET );
-        endGeometry->setSecondaryColorArray( m_secondaryColor );
-        endGeometry->setSecondaryColorBinding( osg::Geometry::BIND_PER_PRIMITIVE_SET );
+        size_t source = sources ? ( *sources )[ fidx ] : fidx;
+        selection[ fidx ] = ( *bitfield )[ source ];
+        // NOTE: secondary color arrays only support RGB colors
+        WColor c = m_fiberSelector->getFiberColor( source );
+        roiColors[ fidx ] = osg::Vec3( c.r(), c.g(), c.b() );
     }
+    m_lodBuilders[ level ]->select( selection, m_fiberSelector->isNothingFiltered() );
+    m_lodBuilders[ level ]->setFiberColors( roiColors );
+}
 
-    // add an update callback which later handles several things like the filter attribute array
-    geometry->setUpdateCallback( new WGEFunctorCallback< osg::Drawable >( boost::bind( &WMFiberDisplay::geometryUpdate, this, _1 ) ) );
+void WMFiberDisplay::updateClusterColors( std::size_t level )
+{
+    if( !m_fiberClustering )
+    {
+        m_lodBuilders[ level ]->setClusterColors( std::vector< osg::Vec3 >() );
+        return;
+    }
 
-    // set drawable
-    fibGeode->addDrawable( geometry );
+    size_t maxFibIdx = m_fibers->getLineStartIndexes()->size() - 1;
+    std::vector< osg::Vec3 > clusterColors( maxFibIdx + 1, osg::Vec3( 0.0, 0.0, 0.0 ) );
 
-    debugLog() << "Iterating over all fibers: done!";
-    progress1->finish();
+    // go through each of the clusters
+    for( WDataSetFiberClustering::ClusterMap::const_iterator iter = m_fiberClustering->begin(); iter != m_fiberClustering->end(); ++iter )
+    {
+        // for each of the fiber IDs:
+        const WFiberCluster::IndexList& ids = ( *iter ).second->getIndices();
+        for( WFiberCluster::IndexList::const_iterator fibIter = ids.begin(); fibIter != ids.end(); ++fibIter )
+        {
+            // be nice here. If the clustering contains some invalid IDs, ignore it.
+            if( *fibIter > maxFibIdx )
+            {
+                continue;
+            }
+            // set the color
+            clusterColors[ *fibIter ] = osg::Vec3(
+                    ( *iter ).second->getColor().r(),
+                    ( *iter ).second->getColor().g(),
+                    ( *iter ).second->getColor().b()
+            );
+        }
+    }
+
+    if( level > 0 )
+    {
+        WDataSetFibers::IndexArray sources = m_lodHierarchy->getSourceFibers( level );
+        std::vector< osg::Vec3 > levelColors( sources->size() );
+        for( size_t fidx = 0; fidx < sources->size(); ++fidx )
+        {
+            levelColors[ fidx ] = clusterColors[ ( *sources )[ fidx ] ];
+        }
+        clusterColors.swap( levelColors );
+    }
+    m_lodBuilders[ level ]->setClusterColors( clusterColors );
 }
 
-void WMFiberDisplay::geometryUpdate( osg::Drawable* geometry )
+void WMFiberDisplay::buildDetailLevels()
 {
-    if( m_fiberSelectorChanged )
+    WFiberLODHierarchy::SPtr hierarchy;
     {
         boost::unique_lock< boost::mutex > lock( m_mutex );
+        if( !m_lodEnable->get( true ) || m_lodBuilders.empty() )
+        {
+            return;
+        }
+        if( !m_lodHierarchy )
+        {
+            // the hierarchy is shared by all modules showing these fibers and it is built in the background
+            m_lodHierarchy = WFiberLODHierarchy::getHierarchy( m_fibers );
+            m_moduleState.add( m_lodHierarchy->getLevelReadyCondition() );
+        }
+        hierarchy = m_lodHierarchy;
+    }
 
-        bool overrideROIFiltering = m_fiberSelector->isNothingFiltered();
-        m_roiFilterColorsOverride->set( overrideROIFiltering ? 1.0f : 0.0f );
+    for( std::size_t level = 1; level < hierarchy->getNumLevels(); ++level )
+    {
+        WDataSetFibers::ConstSPtr levelFibers = hierarchy->getFibers( level );
+        {
+            boost::unique_lock< boost::mutex > lock( m_mutex );
+            if( !levelFibers || ( level < m_lodBuilders.size() && m_lodBuilders[ level ] ) )
+            {
+                continue;
+            }
+        }
 
-        m_fiberSelectorChanged = false;
-        // now initialize attribute array
-        for( size_t fidx = 0; fidx < m_fibers->getLineStartIndexes()->size() ; ++fidx )
+        // the colors of the current color scheme are mapped to the decimated fibers
+        boost::shared_ptr< WDataSetFibers::ColorScheme > scheme = m_fibers->getColorScheme();
+        boost::shared_ptr< WDataSetFibers::ColorScheme const > levelScheme( new WDataSetFibers::ColorScheme( scheme->getName(),
+            scheme->getDescription(), NULL, hierarchy->mapColors( level, scheme->getColor(), scheme->getMode() ), scheme->getMode() ) );
+        WGEFiberGeometryBuilder::SPtr builder( new WGEFiberGeometryBuilder( levelFibers, m_tubeEnable->get(), m_plainColorMode->get(),
+                                                                            m_plainColor->get(), WProgress::SPtr(), 0, levelScheme ) );
+        debugLog() << "Detail level " << level << " with " << levelFibers->getLineStartIndexes()->size() << " fibers is ready.";
+
+        boost::unique_lock< boost::mutex > lock( m_mutex );
+        // the fibers might have been replaced in the meantime
+        if( hierarchy != m_lodHierarchy || m_lodBuilders.empty() )
         {
-            ( *m_bitfieldAttribs )[ fidx ] = overrideROIFiltering | m_fiberSelector->getBitfield()->at( fidx );
-            WColor c = m_fiberSelector->getFiberColor( fidx );
-            ( *m_secondaryColor )[ fidx ] = osg::Vec3( c.r(), c.g(), c.b() );
+            return;
         }
-        m_bitfieldAttribs->dirty();
-        m_secondaryColor->dirty();
+        m_lodBuilders.resize( std::max( m_lodBuilders.size(), level + 1 ) );
+        m_lodBuilders[ level ] = builder;
     }
+}
 
-    if( m_fiberClusteringUpdate && m_fiberClustering )
+void WMFiberDisplay::resetDetailLevels()
+{
+    boost::unique_lock< boost::mutex > lock( m_mutex );
+    if( m_lodHierarchy )
     {
-        m_fiberClusteringUpdate = false;
-        size_t maxFibIdx = m_fibers->getLineStartIndexes()->size() - 1;
-        osg::ref_ptr< osg::Vec3Array > attribs = new osg::Vec3Array( maxFibIdx + 1 );
-        // now initialize attribute array
-        for( size_t fidx = 0; fidx < m_fibers->getLineStartIndexes()->size() ; ++fidx )
+        m_moduleState.remove( m_lodHierarchy->getLevelReadyCondition() );
+        m_lodHierarchy.reset();
+    }
+    m_lodBuilders.clear();
+    m_lodAttached.clear();
+}
+
+std::size_t WMFiberDisplay::chooseDetailLevel()
+{
+    osg::Matrixd view = WKernel::getRunningKernel()->getGraphicsEngine()->getViewer()->getCamera()->getViewMatrix();
+    if( view != m_lastViewMatrix )
+    {
+        m_lastViewMatrix = view;
+        m_framesWithoutMotion = 0;
+    }
+    else
+    {
+        ++m_framesWithoutMotion;
+    }
+
+    // the full resolution is drawn as soon as the camera stops
+    if( !m_lodEnable->get() || m_framesWithoutMotion > 0 )
+    {
+        return 0;
+    }
+
+    // the finest level within the budget, or the coarsest one available
+    std::size_t budget = static_cast< std::size_t >( m_lodVertexBudget->get() );
+    std::size_t coarsest = 0;
+    for( std::size_t level = 0; level < m_lodBuilders.size(); ++level )
+    {
+        if( !m_lodAttached[ level ] )
         {
-            ( *attribs)[ fidx ] = osg::Vec3( 0.0, 0.0, 0.0 );
+            continue;
         }
-
-        // go through each of the clusters
-        for( WDataSetFiberClustering::ClusterMap::const_iterator iter = m_fiberClustering->begin(); iter != m_fiberClustering->end(); ++iter )
+        if( m_lodBuilders[ level ]->getGeometry()->getVertexArray()->getNumElements() <= budget )
         {
-            // for each of the fiber IDs:
-            const WFiberCluster::IndexList& ids = ( *iter ).second->getIndices();
-            for( WFiberCluster::IndexList::const_iterator fibIter = ids.begin(); fibIter != ids.end(); ++fibIter )
-            {
-                // be nice here. If the clustering contains some invalid IDs, ignore it.
-                if( *fibIter > maxFibIdx )
-                {
-                    continue;
-                }
-                // set the color
-                ( *attribs)[ *fibIter ] = osg::Vec3(
-                        ( *iter ).second->getColor().r(),
-                        ( *iter ).second->getColor().g(),
-                        ( *iter ).second->getColor().b()
-                );
-            }
+            return level;
         }
-        static_cast< osg::Geometry* >( geometry )->setSecondaryColorArray( attribs );
-        static_cast< osg::Geometry* >( geometry )->setSecondaryColorBinding( osg::Geometry::BIND_PER_PRIMITIVE_SET );
+        coarsest = level;
     }
+    return coarsest;
 }
 
 void WMFiberDisplay::lineGeodeStateCallback( osg::StateSet* state )
@@ -26,15 +26,21 @@
 #define WMFIBERDISPLAY_H
 
 #include <string>
+#include <vector>
 
 #include <boost/thread.hpp>
 
+#include <osg/Matrixd>
+#include <osg/Switch>
+
 #include "core/kernel/WModule.h"
 #include "core/kernel/WModuleInputData.h"
 #include "core/kernel/WModuleOutputData.h"
 
 #include "core/dataHandler/WDataSetFiberClustering.h"
 #include "core/dataHandler/WDataSetFibers.h"
+#include "core/dataHandler/WFiberLODHierarchy.h"
+#include "core/graphicsEngine/WGEFiberGeometryBuilder.h"
 #include "core/kernel/WFiberSelector.h"
 
 // forward declarations
@@ -96,11 +102,45 @@ protected:
 
 private:
     /**
-     * Geometry update callback. Handles fiber cluster filtering
+     * Update callback of the line switch. Attaches newly built detail levels, handles ROI selection and fiber cluster
+     * filtering by updating the index buffers and the secondary colors of all levels, and chooses the level to draw.
      *
-     * \param geometry the geometry instance to handle
+     * \param node the line switch
      */
-    void geometryUpdate( osg::Drawable* geometry );
+    void geometryUpdate( osg::Node* node );
+
+    /**
+     * Applies the ROI selection and colors to the geometry of a detail level. Needs m_mutex.
+     *
+     * \param level the level
+     */
+    void updateSelection( std::size_t level );
+
+    /**
+     * Applies the cluster colors to the geometry of a detail level, or removes them if there is no clustering. The
+     * builder keeps them apart from the ROI colors of updateSelection(), so ROI changes do not overwrite them. Needs m_mutex.
+     *
+     * \param level the level
+     */
+    void updateClusterColors( std::size_t level );
+
+    /**
+     * Builds the geometry of all coarse detail levels that are ready in the hierarchy but have no geometry yet. The
+     * geometry gets attached to the scene by geometryUpdate().
+     */
+    void buildDetailLevels();
+
+    /**
+     * Drops the geometry of all detail levels and the hierarchy.
+     */
+    void resetDetailLevels();
+
+    /**
+     * Chooses the detail level to draw. Coarse levels are used while the camera moves. Needs m_mutex.
+     *
+     * \return the level
+     */
+    std::size_t chooseDetailLevel();
 
     /**
      * If true, the geometryUpdate() callback will upload a new filter attribute array.
@@ -283,14 +323,15 @@ private:
     osg::ref_ptr< osg::Node > createClipPlane() const;
 
     /**
-     * Creates a geode containing the fiber geometry
+     * Creates the fiber geometry. Both switches get one geode per detail level, the full resolution geometry is built
+     * right away.
      *
      * \param fibers the fiber data
-     * \param fibGeode the geode with the fibers as tube strip or lines
-     * \param endCapGeode the end cap sprites. Not used if not in tube mode.
+     * \param fibSwitch the switch with the fibers as tube strip or lines
+     * \param endCapSwitch the end cap sprites. Not used if not in tube mode.
      */
-    void createFiberGeode( boost::shared_ptr< WDataSetFibers > fibers, osg::ref_ptr< osg::Geode > fibGeode,
-                                                                                         osg::ref_ptr< osg::Geode > endCapGeode );
+    void createFiberGeode( boost::shared_ptr< WDataSetFibers > fibers, osg::ref_ptr< osg::Switch > fibSwitch,
+                                                                                         osg::ref_ptr< osg::Switch > endCapSwitch );
 
     /**
      * The plane node.
@@ -325,19 +366,64 @@ private:
     void roiUpdate();
 
     /**
-     * Contains the ROI bitfield
+     * The ROI filter attribute of the shaders. It is always 1 as only the selected fibers are in the index buffers.
      */
     osg::ref_ptr< osg::FloatArray > m_bitfieldAttribs;
 
     /**
-     * Contains the ROI color map for live branch coloring.
+     * Ratio between dataset color and ROI color.
      */
-    osg::ref_ptr< osg::Vec3Array > m_secondaryColor;
+    osg::ref_ptr< osg::Uniform > m_roiFilterColorsOverride;
 
     /**
-     * Ratio between dataset color and ROI color.
+     * Group of the level of detail properties.
      */
-    osg::ref_ptr< osg::Uniform > m_roiFilterColorsOverride;
+    WPropGroup m_lodGroup;
+
+    /**
+     * Enables coarse detail levels while the camera moves.
+     */
+    WPropBool m_lodEnable;
+
+    /**
+     * The maximum number of vertices drawn while the camera moves.
+     */
+    WPropInt m_lodVertexBudget;
+
+    /**
+     * The level of detail hierarchy of the current fibers.
+     */
+    WFiberLODHierarchy::SPtr m_lodHierarchy;
+
+    /**
+     * The geometry of each detail level, NULL while not built. Protected by m_mutex.
+     */
+    std::vector< WGEFiberGeometryBuilder::SPtr > m_lodBuilders;
+
+    /**
+     * Whether the geometry of a level was added to the scene. Only used by geometryUpdate().
+     */
+    std::vector< bool > m_lodAttached;
+
+    /**
+     * The lines or tubes of all detail levels, child i is level i.
+     */
+    osg::ref_ptr< osg::Switch > m_lineSwitch;
+
+    /**
+     * The end caps of all detail levels, child i is level i.
+     */
+    osg::ref_ptr< osg::Switch > m_endCapSwitch;
+
+    /**
+     * The view matrix of the last frame.
+     */
+    osg::Matrixd m_lastViewMatrix;
+
+    /**
+     * The number of frames since the camera moved.
+     */
+    std::size_t m_framesWithoutMotion;
 };
 
 #endif  // WMFIBERDISPLAY_H
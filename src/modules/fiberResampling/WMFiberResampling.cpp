@@ -119,7 +119,11 @@ void WMFiberResampling::moduleMain()
         WProgress::SPtr progress( new WProgress( "Resampling Fibers", fibers->size() ) );
         m_progress->addSubProgress( progress );
         debugLog() << "Start resampling";
-        m_fiberOC->updateData( m_strategy()->operator()( progress, m_shutdownFlag, fibers ) );
+        WDataSetFibers::SPtr resampled = m_strategy()->operator()( progress, m_shutdownFlag, fibers );
+        if( resampled )
+        {
+            m_fiberOC->updateData( resampled );
+        }
         progress->finish();
         m_progress->removeSubProgress( progress );
         debugLog() << "Finished resampling";
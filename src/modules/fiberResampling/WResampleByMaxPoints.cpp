@@ -22,6 +22,7 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
@@ -41,22 +42,25 @@ WResampleByMaxPoints::WResampleByMaxPoints()
     m_segLength->setMin( 0.0 );
 }
 
-WFiber WResampleByMaxPoints::resample( WFiber fib ) const
+void WResampleByMaxPoints::prepare()
 {
-    if( static_cast< int >( fib.size() ) > m_numPoints->get( true ) )
-    {
-        fib.resampleByNumberOfPoints( m_numPoints->get( true ) );
-    }
+    m_currentNumPoints = m_numPoints->get( true );
+    m_currentSegLength = m_segLength->get( true );
+}
 
-    WFiber test( fib );
-    if( m_segLength->get( true ) != 0.0 )
-    {
-        test.resampleBySegmentLength( m_segLength->get( true ) );
-    }
+void WResampleByMaxPoints::resample( float const* vertices, std::size_t length, Samples* samples ) const
+{
+    std::size_t const maxPoints = std::min( length, m_currentNumPoints );
 
-    if( static_cast< int >( test.size() ) < m_numPoints->get( true ) && test.size() < fib.size() )
+    // the segment length is only used if it gives less points
+    if( m_currentSegLength != 0.0 )
     {
-        return test;
+        sampleBySegmentLength( vertices, length, m_currentSegLength, false, samples );
+        if( samples->size() < maxPoints )
+        {
+            return;
+        }
+        samples->clear();
     }
-    return fib;
+    sampleByNumberOfPoints( vertices, length, maxPoints, samples );
 }
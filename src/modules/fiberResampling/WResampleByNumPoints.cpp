@@ -38,8 +38,12 @@ WResampleByNumPoints::WResampleByNumPoints()
     m_numPoints->setMin( 2 );
 }
 
-WFiber WResampleByNumPoints::resample( WFiber fib ) const
+void WResampleByNumPoints::prepare()
 {
-    fib.resampleByNumberOfPoints( m_numPoints->get( true ) );
-    return fib;
+    m_currentNumPoints = m_numPoints->get( true );
+}
+
+void WResampleByNumPoints::resample( float const* vertices, std::size_t length, Samples* samples ) const
+{
+    sampleByNumberOfPoints( vertices, length, m_currentNumPoints, samples );
 }
@@ -25,7 +25,8 @@
 #ifndef WRESAMPLEBYNUMPOINTS_H
 #define WRESAMPLEBYNUMPOINTS_H
 
-#include <core/common/datastructures/WFiber.h>
+#include <cstddef>
+
 #include <core/common/WObjectNDIP.h>
 
 #include "WResampling_I.h"
@@ -43,19 +44,29 @@ public:
 
 protected:
     /**
-     * The given fiber is resampled so it contains the number of points given by m_numPoints and a copy is returned.
-     *
-     * \param fib Fiber to resample.
+     * Reads the properties.
+     */
+    virtual void prepare();
+
+    /**
+     * The given fiber is resampled so it contains the number of points given by m_numPoints.
      *
-     * \return Copy of the resampled fiber.
+     * \param vertices the first vertex of the fiber, three floats per vertex
+     * \param length the number of vertices of the fiber
+     * \param samples the new points are appended here
      */
-    virtual WFiber resample( WFiber fib ) const;
+    virtual void resample( float const* vertices, std::size_t length, Samples* samples ) const;
 
     /**
      * Number of new sample points all tracts are resampled to.
      */
     WPropInt m_numPoints;
+
 private:
+    /**
+     * The value of m_numPoints during the current resampling.
+     */
+    std::size_t m_currentNumPoints;
 };
 
 #endif  // WRESAMPLEBYNUMPOINTS_H
@@ -39,8 +39,12 @@ WResampleBySegLength::WResampleBySegLength()
     m_segLength->setMin( 0.0 );
 }
 
-WFiber WResampleBySegLength::resample( WFiber fib ) const
+void WResampleBySegLength::prepare()
 {
-    fib.resampleBySegmentLength( m_segLength->get( true ) );
-    return fib;
+    m_currentSegLength = m_segLength->get( true );
+}
+
+void WResampleBySegLength::resample( float const* vertices, std::size_t length, Samples* samples ) const
+{
+    sampleBySegmentLength( vertices, length, m_currentSegLength, false, samples );
 }
@@ -38,8 +38,12 @@ WResampleBySegLengthKeepShortFibers::WResampleBySegLengthKeepShortFibers()
     m_segLength->setMin( 0.0 );
 }
 
-WFiber WResampleBySegLengthKeepShortFibers::resample( WFiber fib ) const
+void WResampleBySegLengthKeepShortFibers::prepare()
 {
-    fib.resampleBySegmentLengthKeepShortFibers( m_segLength->get( true ) );
-    return fib;
+    m_currentSegLength = m_segLength->get( true );
+}
+
+void WResampleBySegLengthKeepShortFibers::resample( float const* vertices, std::size_t length, Samples* samples ) const
+{
+    sampleBySegmentLength( vertices, length, m_currentSegLength, true, samples );
 }
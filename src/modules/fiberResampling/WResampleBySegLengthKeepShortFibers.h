@@ -25,7 +25,8 @@
 #ifndef WRESAMPLEBYSEGLENGTHKEEPSHORTFIBERS_H
 #define WRESAMPLEBYSEGLENGTHKEEPSHORTFIBERS_H
 
-#include <core/common/datastructures/WFiber.h>
+#include <cstddef>
+
 #include <core/common/WObjectNDIP.h>
 
 #include "WResampling_I.h"
@@ -44,19 +45,29 @@ public:
 
 protected:
     /**
-     * The given fiber is resampled by segment length and a copy is returned.
-     *
-     * \param fib Fiber to resample.
+     * Reads the properties.
+     */
+    virtual void prepare();
+
+    /**
+     * The given fiber is resampled by segment length.
      *
-     * \return Copy of the resampled fiber.
+     * \param vertices the first vertex of the fiber, three floats per vertex
+     * \param length the number of vertices of the fiber
+     * \param samples the new points are appended here
      */
-    virtual WFiber resample( WFiber fib ) const;
+    virtual void resample( float const* vertices, std::size_t length, Samples* samples ) const;
 
     /**
      * Number of new sample points all tracts are resampled to.
      */
     WPropDouble m_segLength;
+
 private:
+    /**
+     * The value of m_segLength during the current resampling.
+     */
+    double m_currentSegLength;
 };
 
 #endif  // WRESAMPLEBYSEGLENGTHKEEPSHORTFIBERS_H
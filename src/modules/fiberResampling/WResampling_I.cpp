@@ -22,26 +22,400 @@
 //
 //---------------------------------------------------------------------------
 
-#include <core/dataHandler/WDataSetFiberVector.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <utility>
+#include <vector>
+
+#include <boost/ref.hpp>
+
+#include <core/common/math/linearAlgebra/WPosition.h>
+#include <core/common/math/WPolynomialEquationSolvers.h>
+#include <core/common/WAssert.h>
+#include <core/common/WLimits.h>
+#include <core/common/WLogger.h>
+#include <core/common/WThreadedFunction.h>
 
 #include "WResampling_I.h"
 
+namespace
+{
+    /**
+     * The position of a vertex.
+     *
+     * \param vertices the vertices, three floats per vertex
+     * \param index the index of the vertex
+     *
+     * \return the position
+     */
+    WPosition vertexAt( float const* vertices, std::size_t index )
+    {
+        return WPosition( vertices[ 3 * index ], vertices[ 3 * index + 1 ], vertices[ 3 * index + 2 ] );
+    }
+
+    /**
+     * The index of the next vertex that differs from the given one. Used to skip adjacent duplicates.
+     *
+     * \param vertices the vertices, three floats per vertex
+     * \param size the number of vertices
+     * \param index the index of the vertex
+     *
+     * \return the index of the next different vertex, or size if there is none
+     */
+    std::size_t nextDistinct( float const* vertices, std::size_t size, std::size_t index )
+    {
+        WPosition const p = vertexAt( vertices, index );
+        std::size_t next = index + 1;
+        while( next < size && length( vertexAt( vertices, next ) - p ) <= wlimits::DBL_EPS )
+        {
+            ++next;
+        }
+        return next;
+    }
+
+    /**
+     * Creates a sample.
+     *
+     * \param from the vertex at the start of the segment
+     * \param to the vertex at the end of the segment
+     * \param t the position on the segment
+     *
+     * \return the sample
+     */
+    WResampling_I::Sample makeSample( std::size_t from, std::size_t to, double t )
+    {
+        WResampling_I::Sample s = { from, to, t }; // NOLINT
+        return s;
+    }
+}
+
+/**
+ * Counts or writes the points of a range of fibers, to be run by runThreadedRanges(). In the first pass only the number of
+ * points of every fiber is stored; once the output arrays are set, the second pass interpolates the points and their
+ * parameters and writes them starting at the start index of their fiber, so the threads never write the same elements.
+ */
+class WResampling_I::Pass // NOLINT
+{
+public:
+    /**
+     * Prepares the first pass.
+     *
+     * \param strategy the resampling strategy
+     * \param fibers the fibers to resample
+     * \param lengths receives the number of points of every resampled fiber
+     * \param shutdown aborts both passes when set
+     */
+    Pass( WResampling_I const& strategy, WDataSetFibers::SPtr fibers, WDataSetFibers::LengthArray lengths, WBoolFlag const& shutdown ):
+        m_strategy( strategy ),
+        m_fibers( fibers ),
+        m_lengths( lengths ),
+        m_shutdown( shutdown )
+    {
+    }
+
+    /**
+     * Prepares the second pass.
+     *
+     * \param starts the start index of every resampled fiber
+     * \param vertices the vertices of the resampled fibers
+     * \param verticesReverse the fiber of every vertex
+     * \param parameters the vertex parameters, NULL where the original fibers have none
+     * \param progress incremented by the number of written fibers
+     */
+    void setOutput( WDataSetFibers::IndexArray starts, WDataSetFibers::VertexArray vertices, WDataSetFibers::IndexArray verticesReverse,
+                    std::vector< WDataSetFibers::VertexParemeterArray > const& parameters, WProgress::SPtr progress )
+    {
+        m_starts = starts;
+        m_vertices = vertices;
+        m_verticesReverse = verticesReverse;
+        m_parameters = parameters;
+        m_progress = progress;
+    }
+
+    /**
+     * Runs the current pass on a range of fibers.
+     *
+     * \param firstFiber the first fiber
+     * \param lastFiber the fiber behind the last one
+     */
+    void operator()( std::size_t firstFiber, std::size_t lastFiber )
+    {
+        // the samples of one fiber, reused for all fibers of this range
+        Samples samples;
+
+        std::size_t const chunkSize = 4096;
+        for( std::size_t chunkBegin = firstFiber; chunkBegin < lastFiber && !m_shutdown(); chunkBegin += chunkSize )
+        {
+            std::size_t const chunkEnd = std::min( lastFiber, chunkBegin + chunkSize );
+            for( std::size_t fidx = chunkBegin; fidx < chunkEnd; ++fidx )
+            {
+                std::size_t const first = ( *m_fibers->getLineStartIndexes() )[ fidx ];
+                samples.clear();
+                m_strategy.resample( m_fibers->getVertices()->data() + 3 * first, ( *m_fibers->getLineLengths() )[ fidx ], &samples );
+                if( m_vertices )
+                {
+                    WAssert( samples.size() == ( *m_lengths )[ fidx ], "The strategy gave different results for the same fiber." );
+                    write( fidx, first, samples );
+                }
+                else
+                {
+                    ( *m_lengths )[ fidx ] = samples.size();
+                }
+            }
+            if( m_progress )
+            {
+                m_progress->increment( chunkEnd - chunkBegin );
+            }
+        }
+    }
+
+private:
+    /**
+     * Writes the interpolated points and parameters of a fiber.
+     *
+     * \param fidx the index of the fiber
+     * \param first the index of the first original vertex of the fiber
+     * \param samples the points of the resampled fiber
+     */
+    void write( std::size_t fidx, std::size_t first, Samples const& samples )
+    {
+        std::vector< float > const& in = *m_fibers->getVertices();
+        std::vector< float >& out = *m_vertices;
+        std::size_t const outFirst = ( *m_starts )[ fidx ];
+        for( std::size_t k = 0; k < samples.size(); ++k )
+        {
+            Sample const& s = samples[ k ];
+            std::size_t const from = first + s.m_from;
+            std::size_t const to = first + s.m_to;
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                double const a = in[ 3 * from + c ];
+                out[ 3 * ( outFirst + k ) + c ] = static_cast< float >( a + s.m_t * ( in[ 3 * to + c ] - a ) );
+            }
+            ( *m_verticesReverse )[ outFirst + k ] = fidx;
+
+            for( std::size_t p = 0; p < m_parameters.size(); ++p )
+            {
+                if( m_parameters[ p ] )
+                {
+                    std::vector< double > const& values = *m_fibers->getVertexParameters( p );
+                    ( *m_parameters[ p ] )[ outFirst + k ] = values[ from ] + s.m_t * ( values[ to ] - values[ from ] );
+                }
+            }
+        }
+    }
+
+    /**
+     * The resampling strategy.
+     */
+    WResampling_I const& m_strategy;
+
+    /**
+     * The fibers to resample.
+     */
+    WDataSetFibers::SPtr m_fibers;
+
+    /**
+     * The number of points of every resampled fiber.
+     */
+    WDataSetFibers::LengthArray m_lengths;
+
+    /**
+     * The start index of every resampled fiber. Only set in the second pass.
+     */
+    WDataSetFibers::IndexArray m_starts;
+
+    /**
+     * The vertices of the resampled fibers. Only set in the second pass.
+     */
+    WDataSetFibers::VertexArray m_vertices;
+
+    /**
+     * The fiber of every resampled vertex. Only set in the second pass.
+     */
+    WDataSetFibers::IndexArray m_verticesReverse;
+
+    /**
+     * The vertex parameters of the resampled fibers. Only set in the second pass.
+     */
+    std::vector< WDataSetFibers::VertexParemeterArray > m_parameters;
+
+    /**
+     * The progress of the second pass.
+     */
+    WProgress::SPtr m_progress;
+
+    /**
+     * The shutdown flag of the caller.
+     */
+    WBoolFlag const& m_shutdown;
+};
+
 WResampling_I::~WResampling_I()
 {
 }
 
+void WResampling_I::prepare()
+{
+}
+
 WDataSetFibers::SPtr WResampling_I::operator()( WProgress::SPtr progress, WBoolFlag const &shutdown, WDataSetFibers::SPtr fibers )
 {
-    wlog::debug( "WResampling_I" ) << "Start resampling: " << fibers->getLineStartIndexes()->size() << " fibers";
+    std::size_t const numFibers = fibers->getLineStartIndexes()->size();
+    wlog::debug( "WResampling_I" ) << "Start resampling: " << numFibers << " fibers";
+
+    prepare();
 
-    WDataSetFiberVector::SPtr newDS( new WDataSetFiberVector() );
+    // first pass: the number of points of every fiber
+    WDataSetFibers::LengthArray lengths( new std::vector< std::size_t >( numFibers ) );
+    Pass pass( *this, fibers, lengths, shutdown );
+    runThreadedRanges( numFibers, W_AUTOMATIC_NB_THREADS, boost::ref( pass ) );
+    if( shutdown() )
+    {
+        return WDataSetFibers::SPtr();
+    }
+
+    WDataSetFibers::IndexArray starts( new std::vector< std::size_t >( numFibers ) );
+    std::size_t numVertices = 0;
+    for( std::size_t fidx = 0; fidx < numFibers; ++fidx )
+    {
+        ( *starts )[ fidx ] = numVertices;
+        numVertices += ( *lengths )[ fidx ];
+    }
 
-    for( size_t fidx = 0; fidx < fibers->getLineStartIndexes()->size() && !shutdown; ++fidx )
+    // second pass: the points are written to their final place
+    WDataSetFibers::VertexArray vertices( new std::vector< float >( 3 * numVertices ) );
+    WDataSetFibers::IndexArray verticesReverse( new std::vector< std::size_t >( numVertices ) );
+    std::vector< WDataSetFibers::VertexParemeterArray > parameters( fibers->getVertexParametersSize() );
+    for( std::size_t p = 0; p < parameters.size(); ++p )
+    {
+        if( fibers->getVertexParameters( p ) )
+        {
+            parameters[ p ].reset( new std::vector< double >( numVertices ) );
+        }
+    }
+    pass.setOutput( starts, vertices, verticesReverse, parameters, progress );
+    runThreadedRanges( numFibers, W_AUTOMATIC_NB_THREADS, boost::ref( pass ) );
+    if( shutdown() )
     {
-        newDS->push_back( resample( (*fibers)[ fidx ] ) );
-        ++*progress;
+        return WDataSetFibers::SPtr();
     }
 
-    return newDS->toWDataSetFibers();
+    WDataSetFibers::SPtr result( new WDataSetFibers( vertices, starts, lengths, verticesReverse ) );
+    result->setVertexParameters( parameters );
+
+    // the fibers keep their order, so the line parameters stay valid
+    std::vector< WDataSetFibers::LineParemeterArray > lineParameters;
+    for( std::size_t p = 0; p < fibers->getLineParametersSize(); ++p )
+    {
+        lineParameters.push_back( fibers->getLineParameters( p ) );
+    }
+    result->setLineParameters( lineParameters );
+    return result;
 }
 
+void WResampling_I::sampleByNumberOfPoints( float const* vertices, std::size_t size, std::size_t numPoints, Samples* samples )
+{
+    if( size == numPoints )
+    {
+        for( std::size_t k = 0; k < size; ++k )
+        {
+            samples->push_back( makeSample( k, k, 0.0 ) );
+        }
+    }
+    else if( size > 1 && numPoints > 0 )
+    {
+        double pathLength = 0.0;
+        for( std::size_t i = 0; i + 1 < size; ++i )
+        {
+            pathLength += length( vertexAt( vertices, i ) - vertexAt( vertices, i + 1 ) );
+        }
+        double const newSegmentLength = pathLength / ( numPoints - 1 );
+        double const delta = newSegmentLength * 1.0e-10;
+        double remainingLength = 0.0;
+
+        samples->push_back( makeSample( 0, 0, 0.0 ) );
+        for( std::size_t i = 0; i + 1 < size; ++i )
+        {
+            double const segmentLength = length( vertexAt( vertices, i ) - vertexAt( vertices, i + 1 ) );
+            remainingLength += segmentLength;
+            while( ( remainingLength > newSegmentLength ) || std::abs( remainingLength - newSegmentLength ) < delta )
+            {
+                remainingLength -= newSegmentLength;
+                // the new point is remainingLength away from the end of the segment
+                double const t = segmentLength > 0.0 ? 1.0 - remainingLength / segmentLength : 1.0;
+                samples->push_back( makeSample( i, i + 1, t ) );
+            }
+        }
+    }
+    else if( size == 1 )
+    {
+        for( std::size_t k = 0; k < numPoints; ++k )
+        {
+            samples->push_back( makeSample( 0, 0, 0.0 ) );
+        }
+    }
+}
+
+void WResampling_I::sampleBySegmentLength( float const* vertices, std::size_t size, double segmentLength, bool keepShortFibers,
+                                           Samples* samples )
+{
+    if( size == 0 )
+    {
+        return;
+    }
+    samples->push_back( makeSample( 0, 0, 0.0 ) );
+
+    // the last point lies on the segment from pred to i
+    WPosition last = vertexAt( vertices, 0 );
+    std::size_t pred = 0;
+    std::size_t i = nextDistinct( vertices, size, 0 );
+    while( i < size )
+    {
+        // find the first vertex outside of a sphere of radius segmentLength around the last point
+        std::size_t k = i;
+        std::size_t kPred = pred;
+        while( k < size && length( last - vertexAt( vertices, k ) ) < segmentLength )
+        {
+            kPred = k;
+            k = nextDistinct( vertices, size, k );
+        }
+
+        if( k == size )
+        {
+            if( keepShortFibers && length( last - vertexAt( vertices, kPred ) ) > 0.001 )
+            {
+                samples->push_back( makeSample( kPred, kPred, 0.0 ) );
+            }
+            break;
+        }
+
+        WPosition const current = vertexAt( vertices, k );
+        WPosition const start = vertexAt( vertices, kPred );
+        WVector3d const lineDirection = current - start;
+        double t;
+        if( k == i )
+        {
+            // the last point already is on this segment, step along it
+            WPosition const next = last + normalize( current - last ) * segmentLength;
+            t = dot( next - start, lineDirection ) / dot( lineDirection, lineDirection );
+        }
+        else
+        {
+            // intersect the segment with the sphere
+            WVector3d const o_c = start - last;
+            double const alpha = dot( lineDirection, lineDirection );
+            double const beta = 2.0 * dot( lineDirection, o_c );
+            double const gamma = dot( o_c, o_c ) - segmentLength * segmentLength;
+
+            std::pair< std::complex< double >, std::complex< double > > solution = solveRealQuadraticEquation( alpha, beta, gamma );
+            WAssert( std::imag( solution.first ) == 0.0 && std::imag( solution.second ) == 0.0, "Imaginary solution detected." );
+            t = std::real( solution.first ) > 0.0 ? std::real( solution.first ) : std::real( solution.second );
+        }
+        samples->push_back( makeSample( kPred, k, t ) );
+        last = start + t * lineDirection;
+        pred = kPred;
+        i = k;
+    }
+}
@@ -25,12 +25,18 @@
 #ifndef WRESAMPLING_I_H
 #define WRESAMPLING_I_H
 
+#include <cstddef>
+#include <vector>
+
 #include <core/common/WProgress.h>
 #include <core/common/WFlag.h>
 #include <core/dataHandler/WDataSetFibers.h>
 
 /**
- * Interface for Resampling fibers.
+ * Interface for Resampling fibers. The fibers are resampled in parallel directly on the arrays of the fiber dataset: the
+ * strategies only place the new points on the original fibers, and the vertices and vertex parameters of the new dataset
+ * are interpolated from those in two passes, the first counting the points of every fiber and the second writing them to
+ * their final place.
  */
 class WResampling_I
 {
@@ -42,7 +48,7 @@ public:
      * \param shutdown Possibility to abort in case of shutdown.
      * \param fibers The fibers which should be resampled.
      *
-     * \return Colored fibers
+     * \return The resampled fibers, or NULL if aborted.
      */
     virtual WDataSetFibers::SPtr operator()( WProgress::SPtr progress, WBoolFlag const &shutdown, WDataSetFibers::SPtr fibers );
 
@@ -51,17 +57,79 @@ public:
      */
     virtual ~WResampling_I();
 
-protected:
     /**
-     * All overrided methods should resample the fiber in their specific way.
+     * A point of a resampled fiber. It lies on the segment between two vertices of the original fiber.
+     */
+    struct Sample
+    {
+        /**
+         * The index of the vertex at the start of the segment, counted from the first vertex of the fiber.
+         */
+        std::size_t m_from;
+
+        /**
+         * The index of the vertex at the end of the segment, counted from the first vertex of the fiber.
+         */
+        std::size_t m_to;
+
+        /**
+         * The position on the segment, 0 is the start and 1 the end.
+         */
+        double m_t;
+    };
+
+    /**
+     * The points of a resampled fiber.
+     */
+    typedef std::vector< Sample > Samples;
+
+    /**
+     * Places the given number of points with equal distances along the path of the fiber. Fibers that already have that
+     * number of points are kept and fibers with only one vertex get copies of it.
      *
-     * \param fib The fiber to resample.
+     * \param vertices the first vertex of the fiber, three floats per vertex
+     * \param size the number of vertices
+     * \param numPoints the number of points
+     * \param samples the points are appended here
+     */
+    static void sampleByNumberOfPoints( float const* vertices, std::size_t size, std::size_t numPoints, Samples* samples );
+
+    /**
+     * Places points along the fiber so that consecutive points have the given distance. Adjacent duplicate vertices are
+     * ignored. The rest of the fiber shorter than the distance is dropped unless keepShortFibers is set, in which case
+     * the last vertex is added.
      *
-     * \return Copy of the resampled fiber.
+     * \param vertices the first vertex of the fiber, three floats per vertex
+     * \param size the number of vertices
+     * \param segmentLength the distance of the points
+     * \param keepShortFibers whether to keep the last vertex
+     * \param samples the points are appended here
+     */
+    static void sampleBySegmentLength( float const* vertices, std::size_t size, double segmentLength, bool keepShortFibers,
+                                       Samples* samples );
+
+protected:
+    /**
+     * Called once before the fibers are resampled. As resample() is called from several threads, the overriding methods
+     * should read their properties here.
      */
-    virtual WFiber resample( WFiber fib ) const = 0;
+    virtual void prepare();
+
+    /**
+     * All overrided methods should resample the fiber in their specific way, by appending the new points to samples.
+     * This is called twice for every fiber and from several threads, so it must give the same result every time.
+     *
+     * \param vertices the first vertex of the fiber, three floats per vertex
+     * \param length the number of vertices of the fiber
+     * \param samples the new points are appended here, it is empty when called
+     */
+    virtual void resample( float const* vertices, std::size_t length, Samples* samples ) const = 0;
 
 private:
+    /**
+     * Counts or writes the points of a range of fibers, to be run by a WThreadedFunction.
+     */
+    class Pass;
 };
 
 #endif  // WRESAMPLING_I_H
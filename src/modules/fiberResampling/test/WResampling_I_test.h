@@ -0,0 +1,231 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WRESAMPLING_I_TEST_H
+#define WRESAMPLING_I_TEST_H
+
+#include <algorithm>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "core/common/math/WLine.h"
+#include "core/common/WLogger.h"
+#include "../WResampling_I.h"
+
+/**
+ * Resamples every fiber to its first and last vertex and the middle of its first segment.
+ */
+class WResampleEndsAndMiddle : public WResampling_I
+{
+protected:
+    /**
+     * Places the points.
+     *
+     * \param length the number of vertices of the fiber
+     * \param samples the new points are appended here
+     */
+    virtual void resample( float const* /* vertices */, std::size_t length, Samples* samples ) const
+    {
+        if( length > 1 )
+        {
+            Sample first = { 0, 0, 0.0 }; // NOLINT
+            Sample middle = { 0, 1, 0.5 }; // NOLINT
+            Sample last = { length - 1, length - 1, 0.0 }; // NOLINT
+            samples->push_back( first );
+            samples->push_back( middle );
+            samples->push_back( last );
+        }
+    }
+};
+
+/**
+ * Tests the fiber resampling.
+ */
+class WResampling_ITest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Setup logger and other stuff for each test.
+     */
+    void setUp()
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * The points placed by number of points are the same as those of WLine.
+     */
+    void testSampleByNumberOfPoints()
+    {
+        std::vector< float > vertices = buildZigZag();
+        for( std::size_t numPoints = 1; numPoints < 12; ++numPoints )
+        {
+            WLine line = toLine( vertices );
+            line.resampleByNumberOfPoints( numPoints );
+
+            WResampling_I::Samples samples;
+            WResampling_I::sampleByNumberOfPoints( &vertices[ 0 ], vertices.size() / 3, numPoints, &samples );
+            assertSameLine( line, vertices, samples );
+        }
+
+        // a single vertex is repeated
+        WResampling_I::Samples samples;
+        WResampling_I::sampleByNumberOfPoints( &vertices[ 0 ], 1, 4, &samples );
+        TS_ASSERT_EQUALS( samples.size(), 4 );
+    }
+
+    /**
+     * The points placed by segment length are the same as those of WLine, with and without the short rest of the fiber.
+     */
+    void testSampleBySegmentLength()
+    {
+        std::vector< float > vertices = buildZigZag();
+        double const lengths[] = { 0.3, 0.7, 1.0, 1.5, 2.5, 10.0 }; // NOLINT
+        for( std::size_t i = 0; i < 6; ++i )
+        {
+            WLine line = toLine( vertices );
+            line.resampleBySegmentLength( lengths[ i ] );
+            WResampling_I::Samples samples;
+            WResampling_I::sampleBySegmentLength( &vertices[ 0 ], vertices.size() / 3, lengths[ i ], false, &samples );
+            assertSameLine( line, vertices, samples );
+
+            line = toLine( vertices );
+            line.resampleBySegmentLengthKeepShortFibers( lengths[ i ] );
+            samples.clear();
+            WResampling_I::sampleBySegmentLength( &vertices[ 0 ], vertices.size() / 3, lengths[ i ], true, &samples );
+            assertSameLine( line, vertices, samples );
+        }
+
+        WResampling_I::Samples samples;
+        WResampling_I::sampleBySegmentLength( &vertices[ 0 ], 0, 1.0, false, &samples );
+        TS_ASSERT( samples.empty() );
+    }
+
+    /**
+     * The resampled dataset has the interpolated vertices and vertex parameters, and keeps the line parameters.
+     */
+    void testResampleDataSet()
+    {
+        std::vector< float > v = buildZigZag();
+        WDataSetFibers::VertexArray vertices( new std::vector< float >( v ) );
+        vertices->insert( vertices->end(), v.begin(), v.begin() + 3 );
+        std::size_t const numVertices = vertices->size() / 3;
+        WDataSetFibers::IndexArray starts( new std::vector< std::size_t >( 2, 0 ) );
+        WDataSetFibers::LengthArray lengths( new std::vector< std::size_t >( 2, numVertices - 1 ) );
+        ( *starts )[ 1 ] = numVertices - 1;
+        ( *lengths )[ 1 ] = 1;
+        WDataSetFibers::IndexArray reverse( new std::vector< std::size_t >( numVertices, 0 ) );
+        ( *reverse )[ numVertices - 1 ] = 1;
+
+        WDataSetFibers::SPtr fibers( new WDataSetFibers( vertices, starts, lengths, reverse ) );
+        std::vector< WDataSetFibers::VertexParemeterArray > parameters( 2 );
+        parameters[ 1 ].reset( new std::vector< double >( numVertices ) );
+        for( std::size_t i = 0; i < numVertices; ++i )
+        {
+            ( *parameters[ 1 ] )[ i ] = 2.0 * i;
+        }
+        fibers->setVertexParameters( parameters );
+        std::vector< WDataSetFibers::LineParemeterArray > lineParameters( 1, WDataSetFibers::LineParemeterArray( new std::vector< double >( 2 ) ) );
+        fibers->setLineParameters( lineParameters );
+
+        WBoolFlag shutdown( boost::shared_ptr< WCondition >( new WCondition() ), false );
+        WResampleEndsAndMiddle strategy;
+        WDataSetFibers::SPtr result = strategy( WProgress::SPtr( new WProgress( "test", 2 ) ), shutdown, fibers );
+
+        TS_ASSERT_EQUALS( result->getLineLengths()->size(), 2 );
+        TS_ASSERT_EQUALS( ( *result->getLineLengths() )[ 0 ], 3 );
+        TS_ASSERT_EQUALS( ( *result->getLineLengths() )[ 1 ], 0 );
+        TS_ASSERT_EQUALS( ( *result->getLineStartIndexes() )[ 1 ], 3 );
+        TS_ASSERT_EQUALS( result->getVertices()->size(), 9 );
+        TS_ASSERT_EQUALS( result->getVerticesReverse()->size(), 3 );
+
+        std::vector< float > const& out = *result->getVertices();
+        for( std::size_t c = 0; c < 3; ++c )
+        {
+            TS_ASSERT_DELTA( out[ c ], v[ c ], 1e-6 );
+            TS_ASSERT_DELTA( out[ 3 + c ], 0.5 * ( v[ c ] + v[ 3 + c ] ), 1e-6 );
+            TS_ASSERT_DELTA( out[ 6 + c ], v[ v.size() - 3 + c ], 1e-6 );
+        }
+
+        TS_ASSERT_EQUALS( result->getVertexParametersSize(), 2 );
+        TS_ASSERT( !result->getVertexParameters( 0 ) );
+        TS_ASSERT_DELTA( ( *result->getVertexParameters( 1 ) )[ 1 ], 1.0, 1e-9 );
+        TS_ASSERT_DELTA( ( *result->getVertexParameters( 1 ) )[ 2 ], 2.0 * ( numVertices - 2 ), 1e-9 );
+        TS_ASSERT_EQUALS( result->getLineParameters( 0 ), lineParameters[ 0 ] );
+    }
+
+private:
+    /**
+     * A fiber with segments of different lengths and a duplicate vertex.
+     *
+     * \return the vertices, three floats per vertex
+     */
+    std::vector< float > buildZigZag() const
+    {
+        float const v[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.5f, 0.0f, 1.0f, 0.5f, 0.0f, 2.0f, 0.0f, 0.5f, // NOLINT
+                            2.5f, 1.5f, 0.5f, 4.0f, 1.5f, 1.0f, 4.2f, 1.4f, 1.0f };
+        return std::vector< float >( v, v + 21 );
+    }
+
+    /**
+     * Converts vertices to a line.
+     *
+     * \param vertices the vertices, three floats per vertex
+     *
+     * \return the line
+     */
+    WLine toLine( std::vector< float > const& vertices ) const
+    {
+        WLine line;
+        for( std::size_t i = 0; i < vertices.size(); i += 3 )
+        {
+            line.push_back( WPosition( vertices[ i ], vertices[ i + 1 ], vertices[ i + 2 ] ) );
+        }
+        return line;
+    }
+
+    /**
+     * Checks that the samples are at the points of the line.
+     *
+     * \param line the expected points
+     * \param vertices the resampled vertices
+     * \param samples the samples
+     */
+    void assertSameLine( WLine const& line, std::vector< float > const& vertices, WResampling_I::Samples const& samples ) const
+    {
+        TS_ASSERT_EQUALS( line.size(), samples.size() );
+        for( std::size_t k = 0; k < std::min( line.size(), samples.size() ); ++k )
+        {
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                double const from = vertices[ 3 * samples[ k ].m_from + c ];
+                double const to = vertices[ 3 * samples[ k ].m_to + c ];
+                TS_ASSERT_DELTA( from + samples[ k ].m_t * ( to - from ), line[ k ][ c ], 1e-9 );
+            }
+        }
+    }
+};
+
+#endif  // WRESAMPLING_I_TEST_H
@@ -23,6 +23,8 @@
 //---------------------------------------------------------------------------
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <vector>
 #include <string>
 
@@ -238,20 +240,30 @@ void WMFiberSelection::moduleMain()
             // the list of fibers
             std::vector< boost::tuple< size_t, size_t, size_t > > matches;  // a match contains the fiber ID, the start vertex ID and the stop ID
 
+            // only fibers with segments in the regions of both VOIs can hit both, the segment index finds them without walking all fibers
+            std::vector< size_t > candidates1 = m_fibers->getSegmentIndex()->getFibersInBox( getVoiBoundingBox( m_voi1, voi1Threshold ) );
+            std::vector< size_t > candidates2 = m_fibers->getSegmentIndex()->getFibersInBox( getVoiBoundingBox( m_voi2, voi2Threshold ) );
+            std::vector< size_t > candidates;
+            std::set_intersection( candidates1.begin(), candidates1.end(), candidates2.begin(), candidates2.end(),
+                                   std::back_inserter( candidates ) );
+            debugLog() << candidates.size() << " of " << fibStart->size() << " fibers pass near VOI1 and VOI2.";
+
             // progress indication
-            boost::shared_ptr< WProgress > progress1( new WProgress( "Checking fibers against ", fibStart->size() ) );
+            boost::shared_ptr< WProgress > progress1( new WProgress( "Checking fibers against ", candidates.size() ) );
             m_progress->addSubProgress( progress1 );
 
             // there are several scenarios possible, how the VOIs can be. They can intersect each other, one being inside the other or they might
             // be spatial distinct. To handle all those scenarios, the fiber segments get interpreted as some kind of ray and a list of all hit
             // points with one of the VOIs is stored in a list and can be handled afterwards in several ways.
 
-            // for each fiber:
-            debugLog() << "Iterating over all fibers.";
-            for( size_t fidx = 0; fidx < fibStart->size() ; ++fidx )
+            // for each candidate fiber:
+            debugLog() << "Iterating over candidate fibers.";
+            for( size_t candidate = 0; candidate < candidates.size(); ++candidate )
             {
                 ++*progress1;
 
+                size_t fidx = candidates[ candidate ];
+
                 // the start vertex index
                 size_t sidx = fibStart->at( fidx ) * 3;
 
@@ -342,7 +354,7 @@ void WMFiberSelection::moduleMain()
                     }
                 }
             }
-            debugLog() << "Iterating over all fibers: done!";
+            debugLog() << "Iterating over candidate fibers: done!";
             progress1->finish();
 
             // give some feedback
@@ -442,3 +454,28 @@ void WMFiberSelection::activate()
     WModule::activate();
 }
 
+WBoundingBox WMFiberSelection::getVoiBoundingBox( boost::shared_ptr< WDataSetSingle > voi, double threshold ) const
+{
+    boost::shared_ptr< WGridRegular3D > grid = boost::dynamic_pointer_cast< WGridRegular3D >( voi->getGrid() );
+    WBoundingBox box;
+    if( !grid )
+    {
+        return box;
+    }
+
+    for( size_t voxel = 0; voxel < grid->size(); ++voxel )
+    {
+        if( voi->getSingleRawValue( voxel ) >= threshold )
+        {
+            WPosition const position = grid->getPosition( voxel );
+            box.expandBy( position[ 0 ], position[ 1 ], position[ 2 ] );
+        }
+    }
+    if( box.valid() )
+    {
+        double const d = std::sqrt( grid->getOffsetX() * grid->getOffsetX() + grid->getOffsetY() * grid->getOffsetY() +
+                                    grid->getOffsetZ() * grid->getOffsetZ() );
+        box = WBoundingBox( box.xMin() - d, box.yMin() - d, box.zMin() - d, box.xMax() + d, box.yMax() + d, box.zMax() + d );
+    }
+    return box;
+}
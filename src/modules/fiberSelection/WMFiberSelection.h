@@ -101,6 +101,17 @@ protected:
     virtual void activate();
 
 private:
+    /**
+     * The bounding box of all voxels of a VOI with a value of at least the threshold, enlarged by a voxel diagonal so it
+     * contains every position that is mapped to one of these voxels.
+     *
+     * \param voi the VOI
+     * \param threshold the threshold
+     *
+     * \return the bounding box, invalid if no voxel reaches the threshold
+     */
+    WBoundingBox getVoiBoundingBox( boost::shared_ptr< WDataSetSingle > voi, double threshold ) const;
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     // Input Data
     //////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,298 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "core/common/math/WMath.h"
+#include "core/common/WAssert.h"
+#include "core/dataHandler/WDataSetScalar.h"
+#include "core/dataHandler/WDataSetSingle.h"
+#include "core/kernel/WModuleInputData.h"
+#include "core/kernel/WModuleOutputData.h"
+
+#include "WMProbabilisticTracking.h"
+
+// This line is needed by the module loader to actually find your module.
+W_LOADABLE_MODULE( WMProbabilisticTracking )
+
+WMProbabilisticTracking::WMProbabilisticTracking()
+    : WModule(),
+      m_currentMinFA( 0.0 ),
+      m_currentMinCos( 0.0 ),
+      m_currentCosSpread( 1.0 ),
+      m_currentInterpolate( false )
+{
+}
+
+WMProbabilisticTracking::~WMProbabilisticTracking()
+{
+}
+
+boost::shared_ptr< WModule > WMProbabilisticTracking::factory() const
+{
+    return boost::shared_ptr< WModule >( new WMProbabilisticTracking() );
+}
+
+const std::string WMProbabilisticTracking::getName() const
+{
+    return "Probabilistic Tracking";
+}
+
+const std::string WMProbabilisticTracking::getDescription() const
+{
+    return "Tracks many streamlines with randomly perturbed principal directions from every voxel of a tensor field and "
+           "counts the streamlines through each voxel.";
+}
+
+void WMProbabilisticTracking::moduleMain()
+{
+    m_moduleState.setResetable( true, true );
+    m_moduleState.add( m_input->getDataChangedCondition() );
+    m_moduleState.add( m_propCondition );
+
+    ready();
+
+    while( !m_shutdownFlag() )
+    {
+        debugLog() << "Waiting.";
+        m_moduleState.wait();
+        if( m_shutdownFlag() )
+        {
+            break;
+        }
+
+        if( m_trackingPool && m_trackingPool->status() == W_THREADS_FINISHED )
+        {
+            m_currentProgress->finish();
+            m_output->updateData( m_tracking->getResult() );
+            stopPool( m_trackingPool );
+            m_trackingPool.reset();
+            m_tracking.reset();
+            debugLog() << "Tracking done.";
+        }
+        else if( m_trackingPool && m_trackingPool->status() == W_THREADS_ABORTED )
+        {
+            // pools stopped by this module are removed from the module state, so this one failed
+            m_currentProgress->finish();
+            errorLog() << "The tracking failed.";
+            stopPool( m_trackingPool );
+            m_trackingPool.reset();
+            m_tracking.reset();
+        }
+
+        boost::shared_ptr< WDataSetSingle > inData = m_input->getData();
+        if( inData != m_dataSet )
+        {
+            m_dataSet = inData;
+            stopPool( m_trackingPool );
+            m_trackingPool.reset();
+            m_tracking.reset();
+            m_directionField.reset();
+            m_eigenField.reset();
+            if( !m_dataSet )
+            {
+                continue;
+            }
+
+            // the tracking starts when the eigenvectors are computed
+            resetEigenFunction();
+            if( m_eigenPool )
+            {
+                m_eigenPool->run();
+                debugLog() << "Running computation of eigenvectors.";
+            }
+        }
+        else if( m_eigenPool && m_eigenPool->status() == W_THREADS_FINISHED )
+        {
+            m_currentProgress->finish();
+            WAssert( m_eigenOperation, "" );
+            m_eigenField = m_eigenOperation->getResult();
+            m_directionField = wtracking::WTrackingDirectionField::SPtr( new wtracking::WTrackingDirectionField( m_eigenField ) );
+            stopPool( m_eigenPool );
+            m_eigenPool.reset();
+            debugLog() << "Eigenvectors computed.";
+
+            resetTracking();
+        }
+        else if( m_directionField && !m_eigenPool &&
+                 ( m_minFA->changed() || m_minCos->changed() || m_spread->changed() || m_samplesPerSeed->changed() ||
+                   m_randomSeed->changed() || m_interpolate->changed() ) )
+        {
+            // the direction field is reused, so no tensor math is repeated
+            resetTracking();
+        }
+    }
+
+    debugLog() << "Shutting down module.";
+    stopPool( m_eigenPool );
+    stopPool( m_trackingPool );
+}
+
+void WMProbabilisticTracking::connectors()
+{
+    m_input = boost::shared_ptr< WModuleInputData< WDataSetSingle > >( new WModuleInputData< WDataSetSingle >( shared_from_this(),
+                "tensorInput", "An input set of 2nd-order tensors on a regular 3d-grid." )
+            );
+
+    m_output = boost::shared_ptr< WModuleOutputData< WDataSetScalar > >( new WModuleOutputData< WDataSetScalar >( shared_from_this(),
+                "visitationCounts", "The number of streamlines that visited each voxel." )
+            );
+
+    addConnector( m_input );
+    addConnector( m_output );
+
+    WModule::connectors();
+}
+
+void WMProbabilisticTracking::properties()
+{
+    m_propCondition = boost::shared_ptr< WCondition >( new WCondition() );
+
+    m_minFA = m_properties->addProperty( "Min. FA", "Streamlines stop in voxels with a lower fractional anisotropy.", 0.2, m_propCondition );
+    m_minFA->setMax( 1.0 );
+    m_minFA->setMin( 0.0 );
+
+    m_minCos = m_properties->addProperty( "Min. cosine", "Minimum cosine of the angle between the principal directions of"
+                                          " adjacent streamline segments.", 0.80, m_propCondition );
+    m_minCos->setMax( 1.0 );
+    m_minCos->setMin( 0.0 );
+
+    m_spread = m_properties->addProperty( "Spread", "The directions are drawn uniformly from a cone around the principal direction"
+                                          " with this half opening angle in degrees.", 10.0, m_propCondition );
+    m_spread->setMax( 90.0 );
+    m_spread->setMin( 0.0 );
+
+    m_samplesPerSeed = m_properties->addProperty( "Samples per seed", "The number of streamlines started in every voxel.", 100,
+                                                  m_propCondition );
+    m_samplesPerSeed->setMax( 10000 );
+    m_samplesPerSeed->setMin( 1 );
+
+    m_randomSeed = m_properties->addProperty( "Random seed", "The same seed yields the same result, regardless of the number of"
+                                              " threads.", 0, m_propCondition );
+    m_randomSeed->setMin( 0 );
+
+    m_interpolate = m_properties->addProperty( "Interpolate", "Interpolate the directions trilinearly instead of using the "
+                                                "direction of the current voxel.", false, m_propCondition );
+
+    WModule::properties();
+}
+
+WVector3d WMProbabilisticTracking::sampleDirection( Tracking::DataSetPtr, wtracking::WTrackingUtility::JobType const& j,
+                                                    Tracking::RandomEngine& rng )
+{
+    WAssert( m_directionField, "" );
+    WVector3d const dir = m_currentInterpolate ? m_directionField->interpolateDirection( j.first, j.second, m_currentMinFA, m_currentMinCos ) :
+                                                 m_directionField->getDirection( j.first, j.second, m_currentMinFA, m_currentMinCos );
+    if( length( dir ) == 0.0 || m_currentCosSpread >= 1.0 )
+    {
+        return dir;
+    }
+
+    // uniformly distributed on the spherical cap around the direction
+    boost::random::uniform_real_distribution< double > uniform( 0.0, 1.0 );
+    double const cosTheta = 1.0 - uniform( rng ) * ( 1.0 - m_currentCosSpread );
+    double const sinTheta = std::sqrt( std::max( 0.0, 1.0 - cosTheta * cosTheta ) );
+    double const phi = 2.0 * pi() * uniform( rng );
+
+    WVector3d const u = normalize( cross( dir, std::abs( dir[ 0 ] ) < 0.9 ? WVector3d( 1.0, 0.0, 0.0 ) : WVector3d( 0.0, 1.0, 0.0 ) ) );
+    WVector3d const v = cross( dir, u );
+    return normalize( dir * cosTheta + ( u * std::cos( phi ) + v * std::sin( phi ) ) * sinTheta );
+}
+
+void WMProbabilisticTracking::resetTracking()
+{
+    stopPool( m_trackingPool );
+    updateParameters();
+
+    m_tracking = boost::shared_ptr< Tracking >( new Tracking( m_eigenField, boost::bind( &This::sampleDirection, this, _1, _2, _3 ),
+                                                              static_cast< std::size_t >( m_samplesPerSeed->get( true ) ), 1,
+                                                              std::vector< int >(), std::vector< int >(),
+                                                              static_cast< uint32_t >( m_randomSeed->get( true ) ) ) );
+    m_trackingPool = boost::shared_ptr< TrackingFuncType >( new TrackingFuncType( W_AUTOMATIC_NB_THREADS, m_tracking ) );
+    m_moduleState.add( m_trackingPool->getThreadsDoneCondition() );
+
+    resetProgress( "Probabilistic tracking", 0 );
+    m_trackingPool->run();
+    debugLog() << "Running tracking function.";
+}
+
+void WMProbabilisticTracking::resetEigenFunction()
+{
+    stopPool( m_eigenPool );
+    m_eigenPool.reset();
+    m_eigenOperation.reset();
+
+    WDataType dataType = m_dataSet->getValueSet()->getDataType();
+    if( dataType != W_DT_DOUBLE && dataType != W_DT_FLOAT )
+    {
+        errorLog() << "Input data does not contain floating point values, skipping.";
+        return;
+    }
+
+    resetProgress( "Eigenvectors", m_dataSet->getValueSet()->size() );
+    m_eigenOperation = boost::shared_ptr< WThreadedEigenSystems >( new WThreadedEigenSystems( m_dataSet,
+                                            WThreadedEigenSystems::PRINCIPAL_DIRECTION_AND_FA, m_currentProgress ) );
+    m_eigenPool = boost::shared_ptr< EigenFunctionType >( new EigenFunctionType( W_AUTOMATIC_NB_THREADS, m_eigenOperation ) );
+    m_moduleState.add( m_eigenPool->getThreadsDoneCondition() );
+}
+
+void WMProbabilisticTracking::stopPool( boost::shared_ptr< WThreadedFunctionBase > pool )
+{
+    if( !pool )
+    {
+        return;
+    }
+    WThreadedFunctionStatus s = pool->status();
+    if( s == W_THREADS_RUNNING || s == W_THREADS_STOP_REQUESTED )
+    {
+        pool->stop();
+        pool->wait();
+    }
+    m_moduleState.remove( pool->getThreadsDoneCondition() );
+}
+
+void WMProbabilisticTracking::resetProgress( std::string const& name, std::size_t todo )
+{
+    if( m_currentProgress )
+    {
+        m_currentProgress->finish();
+    }
+    m_currentProgress = boost::shared_ptr< WProgress >( new WProgress( name, todo ) );
+    m_progress->addSubProgress( m_currentProgress );
+}
+
+void WMProbabilisticTracking::updateParameters()
+{
+    m_currentMinFA = m_minFA->get( true );
+    m_currentMinCos = m_minCos->get( true );
+    m_currentCosSpread = std::cos( m_spread->get( true ) * pi() / 180.0 );
+    m_currentInterpolate = m_interpolate->get( true );
+}
@@ -0,0 +1,222 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WMPROBABILISTICTRACKING_H
+#define WMPROBABILISTICTRACKING_H
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include "core/common/math/linearAlgebra/WVectorFixed.h"
+#include "core/common/WThreadedFunction.h"
+#include "core/dataHandler/WThreadedEigenSystems.h"
+#include "core/dataHandler/WThreadedProbabilisticTrackingFunction.h"
+#include "core/dataHandler/WTrackingDirectionField.h"
+#include "core/kernel/WModule.h"
+
+// forward declarations
+class WDataSetScalar;
+class WDataSetSingle;
+template< class T > class WModuleInputData;
+template< class T > class WModuleOutputData;
+
+/**
+ * \class WMProbabilisticTracking
+ *
+ * Probabilistic fiber tracking on a tensor field. Many streamlines are started from every voxel. Every step follows the
+ * principal direction like the deterministic tracking, perturbed by a random direction within a cone around it. The
+ * result is the number of streamlines that visited each voxel, which can be shown with the probabilistic tract display.
+ *
+ * \ingroup modules
+ */
+class WMProbabilisticTracking: public WModule
+{
+    //! the class itself
+    typedef WMProbabilisticTracking This;
+
+public:
+    /**
+     * Standard Constructor.
+     */
+    WMProbabilisticTracking();
+
+    /**
+     * Destructor.
+     */
+    virtual ~WMProbabilisticTracking();
+
+    /**
+     * Returns a new instance of this module.
+     *
+     * \return A new instance of this module.
+     */
+    virtual boost::shared_ptr< WModule > factory() const;
+
+    /**
+     * Return the name of this module.
+     *
+     * \return The name of this module.
+     */
+    virtual const std::string getName() const;
+
+    /**
+     * Return the description of this module.
+     *
+     * \return This module's description.
+     */
+    virtual const std::string getDescription() const;
+
+protected:
+    /**
+     * The worker function, runs in its own thread.
+     */
+    virtual void moduleMain();
+
+    /**
+     * Initialize the module's connectors.
+     */
+    virtual void connectors();
+
+    /**
+     * Initialize the module's properties.
+     */
+    virtual void properties();
+
+private:
+    //! the thread pool type for the eigencomputation
+    typedef WThreadedFunction< WThreadedEigenSystems > EigenFunctionType;
+
+    //! the threaded tracking functor
+    typedef wtracking::WThreadedProbabilisticTrackingFunction Tracking;
+
+    //! the tracking threadpool
+    typedef WThreadedFunction< Tracking > TrackingFuncType;
+
+    /**
+     * Draws the next direction: the direction of the direction field, perturbed uniformly within the spread cone.
+     *
+     * \param j The job, that means the current position and direction of the last fiber segment.
+     * \param rng The random number generator of the calling thread.
+     *
+     * \return The direction to follow, zero to stop.
+     */
+    WVector3d sampleDirection( Tracking::DataSetPtr, wtracking::WTrackingUtility::JobType const& j, Tracking::RandomEngine& rng );
+
+    /**
+     * Stops the running tracking, if any, and creates a new one with the current properties.
+     */
+    void resetTracking();
+
+    /**
+     * Stops the running eigencomputation, if any, and creates a new one for the current input.
+     */
+    void resetEigenFunction();
+
+    /**
+     * Stops a thread pool if it is running and removes its condition from the module state.
+     *
+     * \param pool The thread pool, may be NULL.
+     */
+    void stopPool( boost::shared_ptr< WThreadedFunctionBase > pool );
+
+    /**
+     * Finishes the current progress and starts a new one.
+     *
+     * \param name The name of the new progress.
+     * \param todo The number of operations of the new progress, 0 if unknown.
+     */
+    void resetProgress( std::string const& name, std::size_t todo );
+
+    /**
+     * Copies the properties to the values used by the tracking threads.
+     */
+    void updateParameters();
+
+    //! A condition for property changes.
+    boost::shared_ptr< WCondition > m_propCondition;
+
+    //! A pointer to the input tensor dataset.
+    boost::shared_ptr< WDataSetSingle > m_dataSet;
+
+    //! The input connector.
+    boost::shared_ptr< WModuleInputData< WDataSetSingle > > m_input;
+
+    //! The output connector for the visitation counts.
+    boost::shared_ptr< WModuleOutputData< WDataSetScalar > > m_output;
+
+    //! Stores eigenvectors and fractional anisotropy of the input dataset.
+    boost::shared_ptr< WDataSetSingle > m_eigenField;
+
+    //! The principal directions and FA prepared for tracking.
+    wtracking::WTrackingDirectionField::SPtr m_directionField;
+
+    //! the functor used for the calculation of the eigenvectors
+    boost::shared_ptr< WThreadedEigenSystems > m_eigenOperation;
+
+    //! The threadpool for the eigenvector and FA computations.
+    boost::shared_ptr< EigenFunctionType > m_eigenPool;
+
+    //! The current tracking function.
+    boost::shared_ptr< Tracking > m_tracking;
+
+    //! The threadpool for the tracking.
+    boost::shared_ptr< TrackingFuncType > m_trackingPool;
+
+    //! the object that keeps track of the current progress
+    boost::shared_ptr< WProgress > m_currentProgress;
+
+    //! The minimum FA property.
+    WPropDouble m_minFA;
+
+    //! The minimum cosine property.
+    WPropDouble m_minCos;
+
+    //! The half opening angle of the cone the directions are drawn from, in degrees.
+    WPropDouble m_spread;
+
+    //! The number of streamlines per seed.
+    WPropInt m_samplesPerSeed;
+
+    //! The seed of the random number generators.
+    WPropInt m_randomSeed;
+
+    //! Whether the directions are interpolated.
+    WPropBool m_interpolate;
+
+    //! The current minimum FA.
+    double m_currentMinFA;
+
+    //! The current minimum cosine.
+    double m_currentMinCos;
+
+    //! The cosine of the current spread angle.
+    double m_currentCosSpread;
+
+    //! The current interpolation setting.
+    bool m_currentInterpolate;
+};
+
+#endif  // WMPROBABILISTICTRACKING_H
@@ -0,0 +1,222 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "core/kernel/WKernel.h"
+#include "core/dataHandler/WDataHandler.h"
+#include "core/dataHandler/WGridRegular3D.h"
+
+#include "WMTrackDensity.h"
+#include "WTrackDensityMap.h"
+
+// This line is needed by the module loader to actually find your module. You need to add this to your module too. Do NOT add a ";" here.
+W_LOADABLE_MODULE( WMTrackDensity )
+
+/**
+ * The maximum number of voxels of the output. The density and the direction colors need 20 bytes per voxel, so this
+ * limits the output to about 5 GB.
+ */
+static const std::size_t MaxOutputVoxels = 1 << 28;
+
+WMTrackDensity::WMTrackDensity():
+    WModule()
+{
+}
+
+WMTrackDensity::~WMTrackDensity()
+{
+    // Cleanup!
+}
+
+boost::shared_ptr< WModule > WMTrackDensity::factory() const
+{
+    return boost::shared_ptr< WModule >( new WMTrackDensity() );
+}
+
+const char** WMTrackDensity::getXPMIcon() const
+{
+    return NULL;
+}
+
+const std::string WMTrackDensity::getName() const
+{
+    return "Track Density";
+}
+
+const std::string WMTrackDensity::getDescription() const
+{
+    return "Computes the track density image (the number of fibers per voxel) and its directionally encoded colors at arbitrary "
+           "resolution.";
+}
+
+void WMTrackDensity::connectors()
+{
+    m_fiberInput = boost::shared_ptr< WModuleInputData < WDataSetFibers > >(
+        new WModuleInputData< WDataSetFibers >( shared_from_this(), "fibers", "The fibers to map." )
+    );
+    addConnector( m_fiberInput );
+
+    m_referenceInput = boost::shared_ptr< WModuleInputData < WDataSetSingle > >(
+        new WModuleInputData< WDataSetSingle >( shared_from_this(), "reference", "Optional dataset whose grid gets subdivided for the maps." )
+    );
+    addConnector( m_referenceInput );
+
+    m_densityOutput = boost::shared_ptr< WModuleOutputData < WDataSetScalar > >(
+        new WModuleOutputData< WDataSetScalar >( shared_from_this(), "density", "The number of fibers passing through each voxel." )
+    );
+    addConnector( m_densityOutput );
+
+    m_directionOutput = boost::shared_ptr< WModuleOutputData < WDataSetVector > >(
+        new WModuleOutputData< WDataSetVector >( shared_from_this(), "directions",
+                                                 "The mean absolute direction of the fibers in each voxel, usable as RGB color." )
+    );
+    addConnector( m_directionOutput );
+
+    // call WModule's initialization
+    WModule::connectors();
+}
+
+void WMTrackDensity::properties()
+{
+    m_propCondition = boost::shared_ptr< WCondition >( new WCondition() );
+
+    m_voxelSize = m_properties->addProperty( "Voxel size", "The edge length of the voxels if there is no reference dataset. The grid then "
+                                                           "covers the bounding box of the fibers.", 1.0, m_propCondition );
+    m_voxelSize->setMin( 0.05 );
+    m_voxelSize->setMax( 10.0 );
+
+    m_subdivision = m_properties->addProperty( "Subdivision", "The number of voxels each voxel of the reference dataset is divided into "
+                                                              "along each axis.", 1, m_propCondition );
+    m_subdivision->setMin( 1 );
+    m_subdivision->setMax( 10 );
+
+    m_chunkSize = m_properties->addProperty( "Fibers per chunk", "The number of fibers mapped at once. The module can be stopped between "
+                                                                 "chunks.", 10000, m_propCondition );
+    m_chunkSize->setMin( 100 );
+    m_chunkSize->setMax( 1000000 );
+
+    // call WModule's initialization
+    WModule::properties();
+}
+
+void WMTrackDensity::moduleMain()
+{
+    m_moduleState.setResetable( true, true );
+    m_moduleState.add( m_fiberInput->getDataChangedCondition() );
+    m_moduleState.add( m_referenceInput->getDataChangedCondition() );
+    m_moduleState.add( m_propCondition );
+
+    ready();
+
+    while( !m_shutdownFlag() )
+    {
+        debugLog() << "Waiting ...";
+        m_moduleState.wait();
+
+        if( m_shutdownFlag() )
+        {
+            break;
+        }
+
+        bool dataUpdated = m_fiberInput->handledUpdate() | m_referenceInput->handledUpdate();
+        bool propUpdated = m_voxelSize->changed() || m_subdivision->changed() || m_chunkSize->changed();
+        WDataSetFibers::SPtr fibers = m_fiberInput->getData();
+        if( !fibers )
+        {
+            debugLog() << "Resetting output.";
+            m_densityOutput->reset();
+            m_directionOutput->reset();
+            continue;
+        }
+
+        if( dataUpdated || propUpdated )
+        {
+            update( fibers, m_referenceInput->getData() );
+        }
+    }
+}
+
+void WMTrackDensity::update( WDataSetFibers::SPtr fibers, WDataSetSingle::SPtr reference )
+{
+    boost::shared_ptr< WGridRegular3D > grid;
+    if( reference )
+    {
+        boost::shared_ptr< WGridRegular3D > referenceGrid = boost::dynamic_pointer_cast< WGridRegular3D >( reference->getGrid() );
+        if( !referenceGrid )
+        {
+            errorLog() << "The grid of the reference dataset is not regular.";
+            return;
+        }
+        grid = WTrackDensityMap::subdivideGrid( *referenceGrid, m_subdivision->get( true ) );
+    }
+    else
+    {
+        grid = WTrackDensityMap::createGrid( fibers->getBoundingBox(), m_voxelSize->get( true ) );
+    }
+    std::size_t const numVoxels = static_cast< std::size_t >( grid->getNbCoordsX() ) * grid->getNbCoordsY() * grid->getNbCoordsZ();
+    if( numVoxels > MaxOutputVoxels )
+    {
+        errorLog() << "A grid of " << grid->getNbCoordsX() << "x" << grid->getNbCoordsY() << "x" << grid->getNbCoordsZ()
+                   << " voxels exceeds the limit of " << MaxOutputVoxels << " voxels. Increase the voxel size or decrease the subdivision.";
+        m_densityOutput->reset();
+        m_directionOutput->reset();
+        return;
+    }
+    debugLog() << "Mapping " << fibers->size() << " fibers to a grid of " << grid->getNbCoordsX() << "x" << grid->getNbCoordsY() << "x"
+               << grid->getNbCoordsZ() << " voxels.";
+
+    std::size_t const numFibers = fibers->size();
+    std::size_t const chunkSize = m_chunkSize->get( true );
+    WProgress::SPtr progress( new WProgress( "Mapping fibers", numFibers ) );
+    m_progress->addSubProgress( progress );
+
+    WTrackDensityMap map( grid );
+    for( std::size_t begin = 0; begin < numFibers; begin += chunkSize )
+    {
+        if( m_shutdownFlag() )
+        {
+            progress->finish();
+            m_progress->removeSubProgress( progress );
+            return;
+        }
+        std::size_t const end = std::min( begin + chunkSize, numFibers );
+        map.add( fibers, begin, end );
+        *progress + ( end - begin );
+    }
+    debugLog() << "Allocated " << map.getNumAllocatedBlocks() << " of " << map.getNumBlocks() << " blocks.";
+
+    boost::shared_ptr< std::vector< double > > values = map.getDensity();
+    boost::shared_ptr< WValueSet< double > > density( new WValueSet< double >( 0, 1, values, W_DT_DOUBLE ) );
+    m_densityOutput->updateData( WDataSetScalar::SPtr( new WDataSetScalar( density, grid ) ) );
+
+    boost::shared_ptr< WValueSet< float > > directions( new WValueSet< float >( 1, 3, map.getDirectionColors( *values ), W_DT_FLOAT ) );
+    m_directionOutput->updateData( WDataSetVector::SPtr( new WDataSetVector( directions, grid ) ) );
+
+    progress->finish();
+    m_progress->removeSubProgress( progress );
+}
@@ -0,0 +1,151 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WMTRACKDENSITY_H
+#define WMTRACKDENSITY_H
+
+#include <string>
+
+#include "core/dataHandler/WDataSetFibers.h"
+#include "core/dataHandler/WDataSetScalar.h"
+#include "core/dataHandler/WDataSetSingle.h"
+#include "core/dataHandler/WDataSetVector.h"
+#include "core/kernel/WModule.h"
+#include "core/kernel/WModuleInputData.h"
+#include "core/kernel/WModuleOutputData.h"
+
+/**
+ * Computes track density images (TDI) and directionally encoded color TDI of a fiber dataset. The fibers are streamed in
+ * chunks into sparse per thread accumulation blocks, see WTrackDensityMap, so the output grid may be much finer than
+ * the data, e.g. a subdivision of the grid of a reference dataset.
+ *
+ * \ingroup modules
+ */
+class WMTrackDensity: public WModule
+{
+public:
+    /**
+     * Default constructor.
+     */
+    WMTrackDensity();
+
+    /**
+     * Destructor.
+     */
+    virtual ~WMTrackDensity();
+
+    /**
+     * Gives back the name of this module.
+     * \return the module's name.
+     */
+    virtual const std::string getName() const;
+
+    /**
+     * Gives back a description of this module.
+     * \return description to module.
+     */
+    virtual const std::string getDescription() const;
+
+    /**
+     * Due to the prototype design pattern used to build modules, this method returns a new instance of this method. NOTE: it
+     * should never be initialized or modified in some other way. A simple new instance is required.
+     *
+     * \return the prototype used to create every module in OpenWalnut.
+     */
+    virtual boost::shared_ptr< WModule > factory() const;
+
+    /**
+     * Get the icon for this module in XPM format.
+     * \return The icon.
+     */
+    virtual const char** getXPMIcon() const;
+
+protected:
+    /**
+     * Entry point after loading the module. Runs in separate thread.
+     */
+    virtual void moduleMain();
+
+    /**
+     * Initialize the connectors this module is using.
+     */
+    virtual void connectors();
+
+    /**
+     * Initialize the properties for this module.
+     */
+    virtual void properties();
+
+private:
+    /**
+     * Computes the maps of the fibers and updates the outputs.
+     *
+     * \param fibers the fibers
+     * \param reference the dataset whose grid gets subdivided, if NULL the grid covers the bounding box of the fibers
+     */
+    void update( WDataSetFibers::SPtr fibers, WDataSetSingle::SPtr reference );
+
+    /**
+     * The fiber dataset.
+     */
+    boost::shared_ptr< WModuleInputData< WDataSetFibers > > m_fiberInput;
+
+    /**
+     * The optional dataset whose grid is subdivided for the output.
+     */
+    boost::shared_ptr< WModuleInputData< WDataSetSingle > > m_referenceInput;
+
+    /**
+     * The track density.
+     */
+    boost::shared_ptr< WModuleOutputData< WDataSetScalar > > m_densityOutput;
+
+    /**
+     * The direction colors.
+     */
+    boost::shared_ptr< WModuleOutputData< WDataSetVector > > m_directionOutput;
+
+    /**
+     * A condition used to notify about changes in several properties.
+     */
+    boost::shared_ptr< WCondition > m_propCondition;
+
+    /**
+     * The voxel size if there is no reference dataset.
+     */
+    WPropDouble m_voxelSize;
+
+    /**
+     * The number of voxels each voxel of the reference dataset is divided into along each axis.
+     */
+    WPropInt m_subdivision;
+
+    /**
+     * The number of fibers added at once.
+     */
+    WPropInt m_chunkSize;
+};
+
+#endif  // WMTRACKDENSITY_H
@@ -0,0 +1,493 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/ref.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "core/common/WAssert.h"
+#include "core/common/WThreadedFunction.h"
+#include "core/common/math/WMatrix.h"
+#include "WTrackDensityMap.h"
+
+/**
+ * The number of voxels of a block.
+ */
+static const std::size_t BlockSize = WTrackDensityMap::BlockEdge * WTrackDensityMap::BlockEdge * WTrackDensityMap::BlockEdge;
+
+const std::size_t WTrackDensityMap::BlockEdge;
+
+class WTrackDensityMap::BlockStore // NOLINT
+{
+public:
+    /**
+     * The accumulated values of a voxel.
+     */
+    struct Voxel
+    {
+        double m_density; //!< The number of fibers.
+        double m_direction[ 3 ]; //!< The sum of the absolute unit directions of the fibers.
+    };
+
+    /**
+     * The allocated blocks by their index.
+     */
+    typedef boost::unordered_map< std::size_t, boost::shared_array< Voxel > > Blocks;
+
+    /**
+     * Creates a store without any blocks.
+     */
+    BlockStore()
+        : m_lastIndex( 0 ),
+          m_last( NULL )
+    {
+    }
+
+    /**
+     * Access a voxel. Allocates its block if needed.
+     *
+     * \param key the voxel, as index of its block times the block size plus its index in the block
+     *
+     * \return the voxel
+     */
+    Voxel& operator[]( std::size_t key )
+    {
+        // the voxels of a fiber are visited in order, so most of them are in the block of the previous one
+        std::size_t const index = key / BlockSize;
+        if( !m_last || index != m_lastIndex )
+        {
+            boost::shared_array< Voxel >& block = m_blocks[ index ];
+            if( !block )
+            {
+                block.reset( new Voxel[ BlockSize ]() );
+            }
+            m_lastIndex = index;
+            m_last = block.get();
+        }
+        return m_last[ key % BlockSize ];
+    }
+
+    /**
+     * The allocated blocks.
+     *
+     * \return the blocks
+     */
+    Blocks const& getBlocks() const
+    {
+        return m_blocks;
+    }
+
+private:
+    /**
+     * The allocated blocks. A dense directory of all blocks of the grid would need more memory than the voxels for fine
+     * grids.
+     */
+    Blocks m_blocks;
+
+    /**
+     * The index of the last accessed block.
+     */
+    std::size_t m_lastIndex;
+
+    /**
+     * The voxels of the last accessed block, NULL before the first access.
+     */
+    Voxel* m_last;
+};
+
+class WTrackDensityMap::Accumulator // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param map the map
+     * \param fibers the fibers
+     * \param begin the index of the first fiber to add
+     */
+    Accumulator( WTrackDensityMap* map, WDataSetFibers::ConstSPtr fibers, std::size_t begin )
+        : m_map( map ),
+          m_fibers( fibers ),
+          m_begin( begin )
+    {
+    }
+
+    /**
+     * Adds a range of the fibers to a store no other thread uses meanwhile.
+     *
+     * \param first the index of the first fiber of the range, relative to the first fiber to add
+     * \param last the index behind the last fiber of the range
+     */
+    void operator()( std::size_t first, std::size_t last )
+    {
+        BlockStore* store = m_map->acquireStore();
+        std::vector< float > const& vertices = *m_fibers->getVertices();
+        std::vector< std::size_t > const& starts = *m_fibers->getLineStartIndexes();
+        std::vector< std::size_t > const& lengths = *m_fibers->getLineLengths();
+
+        std::vector< Visit > visits;
+        for( std::size_t fidx = m_begin + first; fidx < m_begin + last; ++fidx )
+        {
+            m_map->addFiber( vertices, starts[ fidx ], lengths[ fidx ], store, &visits );
+        }
+        m_map->releaseStore( store );
+    }
+
+private:
+    /**
+     * The map.
+     */
+    WTrackDensityMap* m_map;
+
+    /**
+     * The fibers.
+     */
+    WDataSetFibers::ConstSPtr m_fibers;
+
+    /**
+     * The index of the first fiber to add.
+     */
+    std::size_t m_begin;
+};
+
+WTrackDensityMap::WTrackDensityMap( boost::shared_ptr< WGridRegular3D > grid, std::size_t numThreads )
+    : m_grid( grid ),
+      m_transform( grid->getTransform() ),
+      m_numThreads( numThreads )
+{
+    m_size[ 0 ] = grid->getNbCoordsX();
+    m_size[ 1 ] = grid->getNbCoordsY();
+    m_size[ 2 ] = grid->getNbCoordsZ();
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        m_numBlocks[ i ] = ( m_size[ i ] + BlockEdge - 1 ) / BlockEdge;
+    }
+}
+
+WTrackDensityMap::~WTrackDensityMap()
+{
+}
+
+void WTrackDensityMap::add( WDataSetFibers::ConstSPtr fibers, std::size_t begin, std::size_t end )
+{
+    if( begin >= end )
+    {
+        return;
+    }
+    Accumulator accumulator( this, fibers, begin );
+    runThreadedRanges( end - begin, m_numThreads, boost::ref( accumulator ) );
+}
+
+boost::shared_ptr< std::vector< double > > WTrackDensityMap::getDensity() const
+{
+    boost::shared_ptr< std::vector< double > > density( new std::vector< double >( m_grid->size(), 0.0 ) );
+    for( std::size_t s = 0; s < m_stores.size(); ++s )
+    {
+        BlockStore::Blocks const& blocks = m_stores[ s ]->getBlocks();
+        for( BlockStore::Blocks::const_iterator block = blocks.begin(); block != blocks.end(); ++block )
+        {
+            for( std::size_t k = 0; k < BlockSize; ++k )
+            {
+                // voxels outside of the grid are never touched
+                if( block->second[ k ].m_density != 0.0 )
+                {
+                    ( *density )[ voxelIndex( block->first * BlockSize + k ) ] += block->second[ k ].m_density;
+                }
+            }
+        }
+    }
+    return density;
+}
+
+boost::shared_ptr< std::vector< float > > WTrackDensityMap::getDirectionColors( std::vector< double > const& density ) const
+{
+    WAssert( density.size() == m_grid->size(), "The density does not belong to this map." );
+
+    boost::shared_ptr< std::vector< float > > colors( new std::vector< float >( 3 * m_grid->size(), 0.0f ) );
+    for( std::size_t s = 0; s < m_stores.size(); ++s )
+    {
+        BlockStore::Blocks const& blocks = m_stores[ s ]->getBlocks();
+        for( BlockStore::Blocks::const_iterator block = blocks.begin(); block != blocks.end(); ++block )
+        {
+            for( std::size_t k = 0; k < BlockSize; ++k )
+            {
+                BlockStore::Voxel const& voxel = block->second[ k ];
+                if( voxel.m_density != 0.0 )
+                {
+                    std::size_t const idx = voxelIndex( block->first * BlockSize + k );
+                    for( std::size_t i = 0; i < 3; ++i )
+                    {
+                        ( *colors )[ 3 * idx + i ] += voxel.m_direction[ i ] / density[ idx ];
+                    }
+                }
+            }
+        }
+    }
+    return colors;
+}
+
+boost::shared_ptr< WGridRegular3D > WTrackDensityMap::getGrid() const
+{
+    return m_grid;
+}
+
+std::size_t WTrackDensityMap::getNumAllocatedBlocks() const
+{
+    std::size_t result = 0;
+    for( std::size_t s = 0; s < m_stores.size(); ++s )
+    {
+        result += m_stores[ s ]->getBlocks().size();
+    }
+    return result;
+}
+
+std::size_t WTrackDensityMap::getNumBlocks() const
+{
+    return m_numBlocks[ 0 ] * m_numBlocks[ 1 ] * m_numBlocks[ 2 ];
+}
+
+boost::shared_ptr< WGridRegular3D > WTrackDensityMap::createGrid( WBoundingBox const& boundingBox, double voxelSize )
+{
+    WAssert( voxelSize > 0.0, "The voxel size must be positive." );
+
+    WMatrix< double > mat( 4, 4 );
+    mat.makeIdentity();
+    mat( 0, 0 ) = mat( 1, 1 ) = mat( 2, 2 ) = voxelSize;
+    mat( 0, 3 ) = boundingBox.xMin();
+    mat( 1, 3 ) = boundingBox.yMin();
+    mat( 2, 3 ) = boundingBox.zMin();
+
+    return boost::shared_ptr< WGridRegular3D >( new WGridRegular3D( std::ceil( ( boundingBox.xMax() - boundingBox.xMin() ) / voxelSize ) + 1,
+                                                                    std::ceil( ( boundingBox.yMax() - boundingBox.yMin() ) / voxelSize ) + 1,
+                                                                    std::ceil( ( boundingBox.zMax() - boundingBox.zMin() ) / voxelSize ) + 1,
+                                                                    WGridTransformOrtho( mat ) ) );
+}
+
+boost::shared_ptr< WGridRegular3D > WTrackDensityMap::subdivideGrid( WGridRegular3D const& grid, std::size_t factor )
+{
+    WAssert( factor > 0, "The subdivision factor must be positive." );
+
+    WGridTransformOrtho const transform = grid.getTransform();
+    WVector3d const axes[] = { transform.getDirectionX(), transform.getDirectionY(), transform.getDirectionZ() }; // NOLINT
+
+    // the first new voxel lies in the lower corner of the first old voxel
+    WVector3d const origin = transform.getOrigin() + ( 0.5 / factor - 0.5 ) * ( axes[ 0 ] + axes[ 1 ] + axes[ 2 ] );
+
+    WMatrix< double > mat( 4, 4 );
+    mat.makeIdentity();
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        for( std::size_t j = 0; j < 3; ++j )
+        {
+            mat( i, j ) = axes[ j ][ i ] / factor;
+        }
+        mat( i, 3 ) = origin[ i ];
+    }
+
+    return boost::shared_ptr< WGridRegular3D >( new WGridRegular3D( grid.getNbCoordsX() * factor, grid.getNbCoordsY() * factor,
+                                                                    grid.getNbCoordsZ() * factor, WGridTransformOrtho( mat ) ) );
+}
+
+void WTrackDensityMap::addFiber( std::vector< float > const& vertices, std::size_t start, std::size_t length, BlockStore* store,
+                                 std::vector< Visit >* visits ) const
+{
+    visits->clear();
+    for( std::size_t k = 1; k < length; ++k )
+    {
+        std::size_t const v = 3 * ( start + k );
+        WVector3d const from( vertices[ v - 3 ], vertices[ v - 2 ], vertices[ v - 1 ] );
+        WVector3d const to( vertices[ v ], vertices[ v + 1 ], vertices[ v + 2 ] );
+        double const segmentLength = ::length( to - from );
+        if( segmentLength == 0.0 )
+        {
+            continue;
+        }
+
+        double const direction[] = { std::abs( to[ 0 ] - from[ 0 ] ) / segmentLength, // NOLINT
+                                     std::abs( to[ 1 ] - from[ 1 ] ) / segmentLength,
+                                     std::abs( to[ 2 ] - from[ 2 ] ) / segmentLength };
+        WVector3d const shift( 0.5, 0.5, 0.5 );
+        traverseSegment( m_transform.positionToGridSpace( from ) + shift, m_transform.positionToGridSpace( to ) + shift,
+                         direction, segmentLength, visits );
+    }
+
+    // every fiber counts once per voxel, no matter how often it enters it
+    std::sort( visits->begin(), visits->end() );
+    for( std::size_t first = 0; first < visits->size(); )
+    {
+        double sum[] = { 0.0, 0.0, 0.0 }; // NOLINT
+        std::size_t last = first;
+        for( ; last < visits->size() && ( *visits )[ last ].m_key == ( *visits )[ first ].m_key; ++last )
+        {
+            for( std::size_t i = 0; i < 3; ++i )
+            {
+                sum[ i ] += ( *visits )[ last ].m_direction[ i ];
+            }
+        }
+
+        BlockStore::Voxel& voxel = ( *store )[ ( *visits )[ first ].m_key ];
+        voxel.m_density += 1.0;
+        double const norm = std::sqrt( sum[ 0 ] * sum[ 0 ] + sum[ 1 ] * sum[ 1 ] + sum[ 2 ] * sum[ 2 ] );
+        for( std::size_t i = 0; i < 3 && norm > 0.0; ++i )
+        {
+            voxel.m_direction[ i ] += sum[ i ] / norm;
+        }
+        first = last;
+    }
+}
+
+void WTrackDensityMap::traverseSegment( WVector3d const& from, WVector3d const& to, double const* direction, double length,
+                                        std::vector< Visit >* visits ) const
+{
+    WVector3d const delta = to - from;
+
+    // clip the segment to the grid
+    double tBegin = 0.0;
+    double tEnd = 1.0;
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        if( delta[ i ] == 0.0 )
+        {
+            if( from[ i ] < 0.0 || from[ i ] >= m_size[ i ] )
+            {
+                return;
+            }
+            continue;
+        }
+        double t0 = -from[ i ] / delta[ i ];
+        double t1 = ( m_size[ i ] - from[ i ] ) / delta[ i ];
+        if( t0 > t1 )
+        {
+            std::swap( t0, t1 );
+        }
+        tBegin = std::max( tBegin, t0 );
+        tEnd = std::min( tEnd, t1 );
+    }
+    if( tBegin >= tEnd )
+    {
+        return;
+    }
+
+    // the voxel and, for each axis, the parameter of the next voxel boundary and the parameter distance of the boundaries
+    int voxel[ 3 ];
+    int step[ 3 ];
+    double tNext[ 3 ];
+    double tDelta[ 3 ];
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        double const p = from[ i ] + tBegin * delta[ i ];
+        voxel[ i ] = static_cast< int >( std::floor( p ) );
+        if( delta[ i ] > 0.0 )
+        {
+            step[ i ] = 1;
+            tNext[ i ] = ( voxel[ i ] + 1 - from[ i ] ) / delta[ i ];
+            tDelta[ i ] = 1.0 / delta[ i ];
+        }
+        else if( delta[ i ] < 0.0 )
+        {
+            // leaving a boundary downwards enters the voxel below
+            if( voxel[ i ] == p )
+            {
+                --voxel[ i ];
+            }
+            step[ i ] = -1;
+            tNext[ i ] = ( voxel[ i ] - from[ i ] ) / delta[ i ];
+            tDelta[ i ] = -1.0 / delta[ i ];
+        }
+        else
+        {
+            step[ i ] = 0;
+            tNext[ i ] = std::numeric_limits< double >::infinity();
+            tDelta[ i ] = 0.0;
+        }
+    }
+
+    for( double t = tBegin; ; )
+    {
+        std::size_t axis = tNext[ 0 ] < tNext[ 1 ] ? 0 : 1;
+        axis = tNext[ 2 ] < tNext[ axis ] ? 2 : axis;
+
+        double const tExit = std::min( tNext[ axis ], tEnd );
+        if( tExit > t &&
+            voxel[ 0 ] >= 0 && voxel[ 0 ] < m_size[ 0 ] &&
+            voxel[ 1 ] >= 0 && voxel[ 1 ] < m_size[ 1 ] &&
+            voxel[ 2 ] >= 0 && voxel[ 2 ] < m_size[ 2 ] )
+        {
+            std::size_t const block = voxel[ 0 ] / BlockEdge +
+                                      m_numBlocks[ 0 ] * ( voxel[ 1 ] / BlockEdge + m_numBlocks[ 1 ] * ( voxel[ 2 ] / BlockEdge ) );
+            Visit visit;
+            visit.m_key = block * BlockSize + voxel[ 0 ] % BlockEdge +
+                          BlockEdge * ( voxel[ 1 ] % BlockEdge + BlockEdge * ( voxel[ 2 ] % BlockEdge ) );
+            for( std::size_t i = 0; i < 3; ++i )
+            {
+                visit.m_direction[ i ] = direction[ i ] * ( tExit - t ) * length;
+            }
+            visits->push_back( visit );
+        }
+
+        if( tNext[ axis ] >= tEnd )
+        {
+            break;
+        }
+        t = tNext[ axis ];
+        voxel[ axis ] += step[ axis ];
+        tNext[ axis ] += tDelta[ axis ];
+    }
+}
+
+std::size_t WTrackDensityMap::voxelIndex( std::size_t key ) const
+{
+    std::size_t const block = key / BlockSize;
+    std::size_t const local = key % BlockSize;
+    std::size_t const x = ( block % m_numBlocks[ 0 ] ) * BlockEdge + local % BlockEdge;
+    std::size_t const y = ( ( block / m_numBlocks[ 0 ] ) % m_numBlocks[ 1 ] ) * BlockEdge + ( local / BlockEdge ) % BlockEdge;
+    std::size_t const z = ( block / ( m_numBlocks[ 0 ] * m_numBlocks[ 1 ] ) ) * BlockEdge + local / ( BlockEdge * BlockEdge );
+    return x + m_size[ 0 ] * ( y + m_size[ 1 ] * z );
+}
+
+WTrackDensityMap::BlockStore* WTrackDensityMap::acquireStore()
+{
+    boost::lock_guard< boost::mutex > lock( m_storesMutex );
+    if( m_freeStores.empty() )
+    {
+        m_stores.push_back( boost::shared_ptr< BlockStore >( new BlockStore() ) );
+        return m_stores.back().get();
+    }
+    BlockStore* store = m_freeStores.back();
+    m_freeStores.pop_back();
+    return store;
+}
+
+void WTrackDensityMap::releaseStore( BlockStore* store )
+{
+    boost::lock_guard< boost::mutex > lock( m_storesMutex );
+    m_freeStores.push_back( store );
+}
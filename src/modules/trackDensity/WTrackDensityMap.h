@@ -0,0 +1,276 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WTRACKDENSITYMAP_H
+#define WTRACKDENSITYMAP_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "core/common/WBoundingBox.h"
+#include "core/dataHandler/WDataSetFibers.h"
+#include "core/dataHandler/WGridRegular3D.h"
+
+/**
+ * Computes a track density image (TDI) and a directionally encoded color TDI of fibers in a regular grid of arbitrary
+ * resolution. The density of a voxel is the number of fibers passing through it. Its direction color is the mean of
+ * the absolute directions of these fibers, each fiber direction being the length weighted mean of its segments in the
+ * voxel.
+ *
+ * Fibers are added in chunks, each chunk in parallel. Every thread accumulates into its own sparse block store which
+ * only allocates the blocks of voxels the fibers of the thread pass through, the stores are reused by the next chunk. So the memory needed while streaming a
+ * tractogram depends on the volume covered by the fibers, not on the size of the grid. The dense maps are only created
+ * on request.
+ */
+class WTrackDensityMap // NOLINT
+{
+public:
+    /**
+     * Shared pointer abbreviation.
+     */
+    typedef boost::shared_ptr< WTrackDensityMap > SPtr;
+
+    /**
+     * The number of voxels along each edge of a block.
+     */
+    static const std::size_t BlockEdge = 8;
+
+    /**
+     * Creates an empty map.
+     *
+     * \param grid the grid of the map, voxel i covers the grid space coordinates [ i - 0.5, i + 0.5 )
+     * \param numThreads the number of threads, 0 to choose automatically
+     */
+    explicit WTrackDensityMap( boost::shared_ptr< WGridRegular3D > grid, std::size_t numThreads = 0 );
+
+    /**
+     * Destructor.
+     */
+    ~WTrackDensityMap();
+
+    /**
+     * Adds a range of fibers to the map, in parallel. Must not be called concurrently with other member functions.
+     *
+     * \param fibers the fibers
+     * \param begin the index of the first fiber to add
+     * \param end the index behind the last fiber to add
+     */
+    void add( WDataSetFibers::ConstSPtr fibers, std::size_t begin, std::size_t end );
+
+    /**
+     * Creates the dense track density map.
+     *
+     * \return the number of fibers passing through each voxel
+     */
+    boost::shared_ptr< std::vector< double > > getDensity() const;
+
+    /**
+     * Creates the dense direction color map.
+     *
+     * \param density the track density map returned by getDensity(), used to average the directions
+     *
+     * \return three components per voxel, the mean absolute direction of the fibers passing through the voxel, zero for
+     * empty voxels
+     */
+    boost::shared_ptr< std::vector< float > > getDirectionColors( std::vector< double > const& density ) const;
+
+    /**
+     * The grid of the map.
+     *
+     * \return the grid
+     */
+    boost::shared_ptr< WGridRegular3D > getGrid() const;
+
+    /**
+     * The number of blocks allocated by all threads.
+     *
+     * \return the number of blocks
+     */
+    std::size_t getNumAllocatedBlocks() const;
+
+    /**
+     * The number of blocks of the grid, i.e. the number a single thread would allocate at most.
+     *
+     * \return the number of blocks
+     */
+    std::size_t getNumBlocks() const;
+
+    /**
+     * Creates an axis aligned grid covering a bounding box.
+     *
+     * \param boundingBox the box, the first voxel is centered at its minimum
+     * \param voxelSize the edge length of the voxels
+     *
+     * \return the grid
+     */
+    static boost::shared_ptr< WGridRegular3D > createGrid( WBoundingBox const& boundingBox, double voxelSize );
+
+    /**
+     * Creates a grid covering the same space as a given grid, with each voxel divided into factor^3 voxels.
+     *
+     * \param grid the grid to divide
+     * \param factor the number of voxels each voxel is divided into along each axis
+     *
+     * \return the grid
+     */
+    static boost::shared_ptr< WGridRegular3D > subdivideGrid( WGridRegular3D const& grid, std::size_t factor );
+
+private:
+    /**
+     * The sparse voxels of a thread, its blocks are kept in a hash map keyed by the block index.
+     */
+    class BlockStore;
+
+    /**
+     * Adds a range of fibers, to be run by runThreadedRanges().
+     */
+    class Accumulator;
+
+    /**
+     * A part of a fiber inside a voxel.
+     */
+    struct Visit
+    {
+        /**
+         * Orders the parts by voxel.
+         *
+         * \param other the other part
+         *
+         * \return true if the voxel of this part comes first
+         */
+        bool operator<( Visit const& other ) const
+        {
+            return m_key < other.m_key;
+        }
+
+        std::size_t m_key; //!< The voxel, as index of its block times the block size plus its index in the block.
+        double m_direction[ 3 ]; //!< The absolute direction of the part, scaled by its length.
+    };
+
+    /**
+     * Adds a fiber to the store of a thread.
+     *
+     * \param vertices the vertices of all fibers
+     * \param start the index of the first vertex of the fiber
+     * \param length the number of vertices of the fiber
+     * \param store the store
+     * \param visits temporary memory, reused for all fibers of a thread
+     */
+    void addFiber( std::vector< float > const& vertices, std::size_t start, std::size_t length, BlockStore* store,
+                   std::vector< Visit >* visits ) const;
+
+    /**
+     * Appends the parts of a segment in the voxels it passes through, by walking along the voxel boundaries it crosses.
+     * Parts outside the grid are skipped.
+     *
+     * \param from the start of the segment in grid space, shifted by 0.5 so that voxel i covers [ i, i + 1 )
+     * \param to the end of the segment in shifted grid space
+     * \param direction the absolute unit direction of the segment in world space
+     * \param length the length of the segment in world space
+     * \param visits the parts are appended here
+     */
+    void traverseSegment( WVector3d const& from, WVector3d const& to, double const* direction, double length,
+                          std::vector< Visit >* visits ) const;
+
+    /**
+     * The index of a voxel in the grid.
+     *
+     * \param key the voxel, as index of its block times the block size plus its index in the block
+     *
+     * \return the index, may be outside of the grid for the voxels of blocks at the upper borders
+     */
+    std::size_t voxelIndex( std::size_t key ) const;
+
+    /**
+     * Gets a store no other thread uses, creates one if all are in use.
+     *
+     * \return the store
+     */
+    BlockStore* acquireStore();
+
+    /**
+     * Lets other threads use a store again.
+     *
+     * \param store the store
+     */
+    void releaseStore( BlockStore* store );
+
+    /**
+     * Disallow copying.
+     */
+    WTrackDensityMap( WTrackDensityMap const& ); // NOLINT
+
+    /**
+     * Disallow copying.
+     *
+     * \return this map
+     */
+    WTrackDensityMap& operator=( WTrackDensityMap const& );
+
+    /**
+     * The grid.
+     */
+    boost::shared_ptr< WGridRegular3D > m_grid;
+
+    /**
+     * The transformation of the grid.
+     */
+    WGridTransformOrtho m_transform;
+
+    /**
+     * The number of threads.
+     */
+    std::size_t m_numThreads;
+
+    /**
+     * The number of voxels along each axis.
+     */
+    int m_size[ 3 ];
+
+    /**
+     * The number of blocks along each axis.
+     */
+    std::size_t m_numBlocks[ 3 ];
+
+    /**
+     * All stores.
+     */
+    std::vector< boost::shared_ptr< BlockStore > > m_stores;
+
+    /**
+     * The stores no thread uses.
+     */
+    std::vector< BlockStore* > m_freeStores;
+
+    /**
+     * Protects m_stores and m_freeStores while the threads get their stores.
+     */
+    boost::mutex m_storesMutex;
+};
+
+#endif  // WTRACKDENSITYMAP_H
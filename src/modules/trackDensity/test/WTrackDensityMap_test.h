@@ -0,0 +1,292 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WTRACKDENSITYMAP_TEST_H
+#define WTRACKDENSITYMAP_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cxxtest/TestSuite.h>
+
+#include "core/common/WLogger.h"
+#include "../WTrackDensityMap.h"
+
+/**
+ * Tests the track density map.
+ */
+class WTrackDensityMapTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Starts the logger.
+     */
+    void setUp( void )
+    {
+        WLogger::startup();
+    }
+
+    /**
+     * A straight fiber marks the voxels along it once, with its direction as color.
+     */
+    void testStraightFiber( void )
+    {
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( 10, 10, 10 ) );
+        WTrackDensityMap map( grid, 1 );
+
+        std::vector< float > fiber;
+        addVertex( &fiber, 0.0, 5.2, 4.9 );
+        addVertex( &fiber, 4.1, 5.2, 4.9 );
+        addVertex( &fiber, 9.0, 5.2, 4.9 );
+        WDataSetFibers::SPtr fibers = createFibers( std::vector< std::vector< float > >( 1, fiber ) );
+        map.add( fibers, 0, 1 );
+
+        boost::shared_ptr< std::vector< double > > density = map.getDensity();
+        boost::shared_ptr< std::vector< float > > colors = map.getDirectionColors( *density );
+        TS_ASSERT_EQUALS( density->size(), 1000 );
+        TS_ASSERT_EQUALS( colors->size(), 3000 );
+        for( size_t i = 0; i < 1000; ++i )
+        {
+            double expected = ( i / 10 == 5 + 10 * 5 ) ? 1.0 : 0.0;
+            TS_ASSERT_EQUALS( ( *density )[ i ], expected );
+            TS_ASSERT_DELTA( ( *colors )[ 3 * i ], expected, 1e-6 );
+            TS_ASSERT_DELTA( ( *colors )[ 3 * i + 1 ], 0.0, 1e-6 );
+            TS_ASSERT_DELTA( ( *colors )[ 3 * i + 2 ], 0.0, 1e-6 );
+        }
+    }
+
+    /**
+     * A fiber counts once per voxel, even if it enters it several times. Its direction is the length weighted mean of
+     * its parts in the voxel.
+     */
+    void testFiberCountsOncePerVoxel( void )
+    {
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( 3, 3, 3 ) );
+        WTrackDensityMap map( grid, 1 );
+
+        std::vector< float > fiber;
+        addVertex( &fiber, 1.0, 1.0, 1.0 );
+        addVertex( &fiber, 1.4, 1.0, 1.0 );
+        addVertex( &fiber, 1.4, 1.3, 1.0 );
+        addVertex( &fiber, 1.0, 1.3, 1.0 );
+        addVertex( &fiber, 1.0, 1.3, 2.0 );
+        addVertex( &fiber, 1.0, 1.3, 1.1 );
+        map.add( createFibers( std::vector< std::vector< float > >( 1, fiber ) ), 0, 1 );
+
+        boost::shared_ptr< std::vector< double > > density = map.getDensity();
+        boost::shared_ptr< std::vector< float > > colors = map.getDirectionColors( *density );
+        TS_ASSERT_EQUALS( ( *density )[ 13 ], 1.0 );
+        TS_ASSERT_EQUALS( ( *density )[ 22 ], 1.0 );
+        TS_ASSERT_EQUALS( ( *density )[ 4 ], 0.0 );
+
+        // in the center voxel: 0.4 + 0.4 along x, 0.3 along y and 0.5 + 0.4 along z
+        double const norm = std::sqrt( 0.8 * 0.8 + 0.3 * 0.3 + 0.9 * 0.9 );
+        TS_ASSERT_DELTA( ( *colors )[ 3 * 13 + 0 ], 0.8 / norm, 1e-6 );
+        TS_ASSERT_DELTA( ( *colors )[ 3 * 13 + 1 ], 0.3 / norm, 1e-6 );
+        TS_ASSERT_DELTA( ( *colors )[ 3 * 13 + 2 ], 0.9 / norm, 1e-6 );
+        TS_ASSERT_DELTA( ( *colors )[ 3 * 22 + 2 ], 1.0, 1e-6 );
+    }
+
+    /**
+     * Adding the fibers in chunks with several threads gives the same maps as adding them at once with one thread.
+     */
+    void testParallelChunks( void )
+    {
+        std::vector< std::vector< float > > fibers;
+        for( size_t i = 0; i < 50; ++i )
+        {
+            std::vector< float > fiber;
+            for( size_t k = 0; k < 12; ++k )
+            {
+                double t = 0.3 * i + 0.5 * k;
+                addVertex( &fiber, 5.0 + 5.0 * std::sin( t ), 4.0 + 5.0 * std::cos( 1.3 * t + i ), 3.0 + 3.0 * std::sin( 0.7 * t ) );
+            }
+            fibers.push_back( fiber );
+        }
+        WDataSetFibers::SPtr dataSet = createFibers( fibers );
+        boost::shared_ptr< WGridRegular3D > grid = WTrackDensityMap::subdivideGrid( WGridRegular3D( 10, 9, 7 ), 3 );
+
+        WTrackDensityMap serial( grid, 1 );
+        serial.add( dataSet, 0, fibers.size() );
+        WTrackDensityMap parallel( grid, 3 );
+        for( size_t begin = 0; begin < fibers.size(); begin += 7 )
+        {
+            parallel.add( dataSet, begin, std::min( begin + 7, fibers.size() ) );
+        }
+
+        boost::shared_ptr< std::vector< double > > serialDensity = serial.getDensity();
+        boost::shared_ptr< std::vector< double > > parallelDensity = parallel.getDensity();
+        boost::shared_ptr< std::vector< float > > serialColors = serial.getDirectionColors( *serialDensity );
+        boost::shared_ptr< std::vector< float > > parallelColors = parallel.getDirectionColors( *parallelDensity );
+        double total = 0.0;
+        for( size_t i = 0; i < serialDensity->size(); ++i )
+        {
+            TS_ASSERT_EQUALS( ( *serialDensity )[ i ], ( *parallelDensity )[ i ] );
+            total += ( *serialDensity )[ i ];
+        }
+        for( size_t i = 0; i < serialColors->size(); ++i )
+        {
+            TS_ASSERT_DELTA( ( *serialColors )[ i ], ( *parallelColors )[ i ], 1e-5 );
+        }
+        TS_ASSERT_LESS_THAN( 1000.0, total );
+    }
+
+    /**
+     * Only the blocks a fiber passes through are allocated.
+     */
+    void testSparseBlocks( void )
+    {
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( 256, 256, 256 ) );
+        WTrackDensityMap map( grid, 2 );
+        TS_ASSERT_EQUALS( map.getNumBlocks(), 32 * 32 * 32 );
+
+        std::vector< float > fiber;
+        addVertex( &fiber, 100.0, 100.0, 100.0 );
+        addVertex( &fiber, 115.0, 100.0, 100.0 );
+        map.add( createFibers( std::vector< std::vector< float > >( 1, fiber ) ), 0, 1 );
+        TS_ASSERT_EQUALS( map.getNumAllocatedBlocks(), 3 );
+    }
+
+    /**
+     * The memory of the stores does not depend on the number of blocks of the grid.
+     */
+    void testHugeGrid( void )
+    {
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( 65536, 65536, 65536 ) );
+        WTrackDensityMap map( grid, 2 );
+        TS_ASSERT_EQUALS( map.getNumBlocks(), static_cast< size_t >( 8192 ) * 8192 * 8192 );
+
+        std::vector< float > fiber;
+        addVertex( &fiber, 60004.0, 100.0, 30000.0 );
+        addVertex( &fiber, 60019.0, 100.0, 30000.0 );
+        map.add( createFibers( std::vector< std::vector< float > >( 1, fiber ) ), 0, 1 );
+        TS_ASSERT_EQUALS( map.getNumAllocatedBlocks(), 3 );
+    }
+
+    /**
+     * Parts of fibers outside of the grid are skipped.
+     */
+    void testFiberLeavingTheGrid( void )
+    {
+        boost::shared_ptr< WGridRegular3D > grid( new WGridRegular3D( 4, 4, 4 ) );
+        WTrackDensityMap map( grid, 1 );
+
+        std::vector< float > fiber;
+        addVertex( &fiber, -20.0, 2.0, 2.0 );
+        addVertex( &fiber, 20.0, 2.0, 2.0 );
+        addVertex( &fiber, 20.0, 40.0, 2.0 );
+        map.add( createFibers( std::vector< std::vector< float > >( 1, fiber ) ), 0, 1 );
+
+        boost::shared_ptr< std::vector< double > > density = map.getDensity();
+        double total = 0.0;
+        for( size_t i = 0; i < density->size(); ++i )
+        {
+            total += ( *density )[ i ];
+        }
+        TS_ASSERT_EQUALS( total, 4.0 );
+        TS_ASSERT_EQUALS( ( *density )[ 2 * 4 + 2 * 16 ], 1.0 );
+        TS_ASSERT_EQUALS( ( *density )[ 3 + 2 * 4 + 2 * 16 ], 1.0 );
+    }
+
+    /**
+     * A subdivided grid covers the same space with smaller voxels.
+     */
+    void testSubdivideGrid( void )
+    {
+        WGridRegular3D grid( 4, 5, 6, 2.0, 2.0, 2.0 );
+        boost::shared_ptr< WGridRegular3D > fine = WTrackDensityMap::subdivideGrid( grid, 4 );
+        TS_ASSERT_EQUALS( fine->getNbCoordsX(), 16 );
+        TS_ASSERT_EQUALS( fine->getNbCoordsY(), 20 );
+        TS_ASSERT_EQUALS( fine->getNbCoordsZ(), 24 );
+
+        // the old voxel 0 covers [ -1, 1 ), the new voxels have a size of 0.5
+        WPosition first = fine->getPosition( 0, 0, 0 );
+        TS_ASSERT_DELTA( first[ 0 ], -0.75, 1e-9 );
+        TS_ASSERT_DELTA( first[ 2 ], -0.75, 1e-9 );
+        WPosition last = fine->getPosition( 15, 19, 23 );
+        TS_ASSERT_DELTA( last[ 0 ], 6.75, 1e-9 );
+        TS_ASSERT_DELTA( last[ 1 ], 8.75, 1e-9 );
+        TS_ASSERT_DELTA( last[ 2 ], 10.75, 1e-9 );
+    }
+
+    /**
+     * A grid created for a bounding box covers it.
+     */
+    void testCreateGrid( void )
+    {
+        boost::shared_ptr< WGridRegular3D > grid = WTrackDensityMap::createGrid( WBoundingBox( 1.0, 2.0, 3.0, 11.0, 7.0, 4.0 ), 0.5 );
+        TS_ASSERT_EQUALS( grid->getNbCoordsX(), 21 );
+        TS_ASSERT_EQUALS( grid->getNbCoordsY(), 11 );
+        TS_ASSERT_EQUALS( grid->getNbCoordsZ(), 3 );
+        WPosition last = grid->getPosition( 20, 10, 2 );
+        TS_ASSERT_DELTA( last[ 0 ], 11.0, 1e-9 );
+        TS_ASSERT_DELTA( last[ 1 ], 7.0, 1e-9 );
+        TS_ASSERT_DELTA( last[ 2 ], 4.0, 1e-9 );
+    }
+
+private:
+    /**
+     * Appends a vertex to a fiber.
+     *
+     * \param fiber the fiber
+     * \param x the x coordinate
+     * \param y the y coordinate
+     * \param z the z coordinate
+     */
+    void addVertex( std::vector< float >* fiber, double x, double y, double z )
+    {
+        fiber->push_back( x );
+        fiber->push_back( y );
+        fiber->push_back( z );
+    }
+
+    /**
+     * Creates a fiber dataset.
+     *
+     * \param fibers the vertices of each fiber
+     *
+     * \return the dataset
+     */
+    WDataSetFibers::SPtr createFibers( std::vector< std::vector< float > > const& fibers )
+    {
+        WDataSetFibers::VertexArray vertices( new std::vector< float > );
+        WDataSetFibers::IndexArray starts( new std::vector< size_t > );
+        WDataSetFibers::LengthArray lengths( new std::vector< size_t > );
+        WDataSetFibers::IndexArray reverse( new std::vector< size_t > );
+        for( size_t i = 0; i < fibers.size(); ++i )
+        {
+            starts->push_back( vertices->size() / 3 );
+            lengths->push_back( fibers[ i ].size() / 3 );
+            vertices->insert( vertices->end(), fibers[ i ].begin(), fibers[ i ].end() );
+            reverse->resize( vertices->size() / 3, i );
+        }
+        return WDataSetFibers::SPtr( new WDataSetFibers( vertices, starts, lengths, reverse ) );
+    }
+};
+
+#endif  // WTRACKDENSITYMAP_TEST_H
@@ -42,10 +42,21 @@ WBresenham::WBresenham( boost::shared_ptr< WGridRegular3D > grid, bool antialias
 {
 }
 
+WBresenham::WBresenham( boost::shared_ptr< WGridRegular3D > grid, bool antialiased, bool tiled )
+    : WRasterAlgorithm( grid, tiled ),
+      m_antialiased( antialiased )
+{
+}
+
 WBresenham::~WBresenham()
 {
 }
 
+boost::shared_ptr< WRasterAlgorithm > WBresenham::createWorker() const
+{
+    return boost::shared_ptr< WRasterAlgorithm >( new WBresenham( m_grid, m_antialiased, true ) );
+}
+
 void WBresenham::raster( const WLine& line )
 {
     // lock the parameterization list for reading
@@ -204,13 +215,13 @@ void WBresenham::markVoxel( const WVector3i& voxel, const int axis, const WPosit
     if( m_antialiased )
     {
         distances = computeDistances( idx, start, end );
-        m_values[ idx ] = composeValue( filter( distances[0] ), m_values[ idx ] );
-        parameterizeVoxel( voxel, idx, axis, m_values[ idx ], start, end );
+        voxelValue( idx ) = composeValue( filter( distances[0] ), voxelValue( idx ) );
+        parameterizeVoxel( voxel, idx, axis, voxelValue( idx ), start, end );
     }
     else
     {
-        m_values[ idx ] = 1.0;
-        parameterizeVoxel( voxel, idx, axis, m_values[ idx ], start, end );
+        voxelValue( idx ) = 1.0;
+        parameterizeVoxel( voxel, idx, axis, voxelValue( idx ), start, end );
         return;
     }
 
@@ -239,38 +250,38 @@ void WBresenham::markVoxel( const WVector3i& voxel, const int axis, const WPosit
     switch( axis )
     {
         case 0 :
-                m_values[ idx + nbX ] = composeValue( filter( distances[3] ), m_values[ idx + nbX ] );
-                m_values[ idx - nbX ] = composeValue( filter( distances[4] ), m_values[ idx - nbX ] );
-                m_values[ idx + nbXY ] = composeValue( filter( distances[5] ), m_values[ idx + nbXY ] );
-                m_values[ idx - nbXY ] = composeValue( filter( distances[6] ), m_values[ idx - nbXY ] );
+                voxelValue( idx + nbX ) = composeValue( filter( distances[3] ), voxelValue( idx + nbX ) );
+                voxelValue( idx - nbX ) = composeValue( filter( distances[4] ), voxelValue( idx - nbX ) );
+                voxelValue( idx + nbXY ) = composeValue( filter( distances[5] ), voxelValue( idx + nbXY ) );
+                voxelValue( idx - nbXY ) = composeValue( filter( distances[6] ), voxelValue( idx - nbXY ) );
 
-                parameterizeVoxel( voxel, idx + nbX, axis, m_values[ idx + nbX ], start, end );
-                parameterizeVoxel( voxel, idx - nbX, axis, m_values[ idx - nbX ], start, end );
-                parameterizeVoxel( voxel, idx + nbXY, axis, m_values[ idx + nbXY ], start, end );
-                parameterizeVoxel( voxel, idx - nbXY, axis, m_values[ idx - nbXY ], start, end );
+                parameterizeVoxel( voxel, idx + nbX, axis, voxelValue( idx + nbX ), start, end );
+                parameterizeVoxel( voxel, idx - nbX, axis, voxelValue( idx - nbX ), start, end );
+                parameterizeVoxel( voxel, idx + nbXY, axis, voxelValue( idx + nbXY ), start, end );
+                parameterizeVoxel( voxel, idx - nbXY, axis, voxelValue( idx - nbXY ), start, end );
 
                 break;
         case 1 :
-                m_values[ idx + 1 ] = composeValue( filter( distances[1] ), m_values[ idx + 1 ] );
-                m_values[ idx - 1 ] = composeValue( filter( distances[2] ), m_values[ idx - 1 ] );
-                m_values[ idx + nbXY ] = composeValue( filter( distances[5] ), m_values[ idx + nbXY ] );
-                m_values[ idx - nbXY ] = composeValue( filter( distances[6] ), m_values[ idx - nbXY ] );
+                voxelValue( idx + 1 ) = composeValue( filter( distances[1] ), voxelValue( idx + 1 ) );
+                voxelValue( idx - 1 ) = composeValue( filter( distances[2] ), voxelValue( idx - 1 ) );
+                voxelValue( idx + nbXY ) = composeValue( filter( distances[5] ), voxelValue( idx + nbXY ) );
+                voxelValue( idx - nbXY ) = composeValue( filter( distances[6] ), voxelValue( idx - nbXY ) );
 
-                parameterizeVoxel( voxel, idx + 1, axis, m_values[ idx + 1 ], start, end );
-                parameterizeVoxel( voxel, idx - 1, axis, m_values[ idx - 1 ], start, end );
-                parameterizeVoxel( voxel, idx + nbXY, axis, m_values[ idx + nbXY ], start, end );
-                parameterizeVoxel( voxel, idx - nbXY, axis, m_values[ idx - nbXY ], start, end );
+                parameterizeVoxel( voxel, idx + 1, axis, voxelValue( idx + 1 ), start, end );
+                parameterizeVoxel( voxel, idx - 1, axis, voxelValue( idx - 1 ), start, end );
+                parameterizeVoxel( voxel, idx + nbXY, axis, voxelValue( idx + nbXY ), start, end );
+                parameterizeVoxel( voxel, idx - nbXY, axis, voxelValue( idx - nbXY ), start, end );
 
                 break;
         case 2 :
-                m_values[ idx + 1 ] = composeValue( filter( distances[1] ), m_values[ idx + 1 ] );
-                m_values[ idx - 1 ] = composeValue( filter( distances[2] ), m_values[ idx - 1 ] );
-                m_values[ idx + nbX ] = composeValue( filter( distances[3] ), m_values[ idx + nbX ] );
-                m_values[ idx - nbX ] = composeValue( filter( distances[4] ), m_values[ idx - nbX ] );
-                parameterizeVoxel( voxel, idx + 1, axis, m_values[ idx + 1 ], start, end );
-                parameterizeVoxel( voxel, idx - 1, axis, m_values[ idx - 1 ], start, end );
-                parameterizeVoxel( voxel, idx + nbX, axis, m_values[ idx + nbX ], start, end );
-                parameterizeVoxel( voxel, idx - nbX, axis, m_values[ idx - nbX ], start, end );
+                voxelValue( idx + 1 ) = composeValue( filter( distances[1] ), voxelValue( idx + 1 ) );
+                voxelValue( idx - 1 ) = composeValue( filter( distances[2] ), voxelValue( idx - 1 ) );
+                voxelValue( idx + nbX ) = composeValue( filter( distances[3] ), voxelValue( idx + nbX ) );
+                voxelValue( idx - nbX ) = composeValue( filter( distances[4] ), voxelValue( idx - nbX ) );
+                parameterizeVoxel( voxel, idx + 1, axis, voxelValue( idx + 1 ), start, end );
+                parameterizeVoxel( voxel, idx - 1, axis, voxelValue( idx - 1 ), start, end );
+                parameterizeVoxel( voxel, idx + nbX, axis, voxelValue( idx + nbX ), start, end );
+                parameterizeVoxel( voxel, idx - nbX, axis, voxelValue( idx - nbX ), start, end );
 
                 break;
         default : WAssert( 0, "Invalid axis selected for marking a voxel" );
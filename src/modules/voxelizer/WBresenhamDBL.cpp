@@ -34,10 +34,20 @@ WBresenhamDBL::WBresenhamDBL( boost::shared_ptr< WGridRegular3D > grid, bool ant
 {
 }
 
+WBresenhamDBL::WBresenhamDBL( boost::shared_ptr< WGridRegular3D > grid, bool antialiased, bool tiled )
+    : WBresenham( grid, antialiased, tiled )
+{
+}
+
 WBresenhamDBL::~WBresenhamDBL()
 {
 }
 
+boost::shared_ptr< WRasterAlgorithm > WBresenhamDBL::createWorker() const
+{
+    return boost::shared_ptr< WRasterAlgorithm >( new WBresenhamDBL( m_grid, m_antialiased, true ) );
+}
+
 void WBresenhamDBL::rasterSegment( const WPosition& start, const WPosition& end )
 {
     int i;
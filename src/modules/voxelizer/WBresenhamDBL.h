@@ -57,6 +57,23 @@ public:
     virtual ~WBresenhamDBL();
 
 protected:
+    /**
+     * Initializes a raster algo whose values are stored in tiles, used for workers.
+     *
+     * \param grid The grid which defines the voxels which should be marked.
+     * \param antialiased If true then all voxels of a line are supported with
+     * anti-aliasing voxels around
+     * \param tiled If true the values are stored sparsely in tiles.
+     */
+    WBresenhamDBL( boost::shared_ptr< WGridRegular3D > grid, bool antialiased, bool tiled );
+
+    /**
+     * Creates a rasterizer with the same settings for a single thread of rasterLines().
+     *
+     * \return the worker
+     */
+    virtual boost::shared_ptr< WRasterAlgorithm > createWorker() const;
+
     /**
      * Scans a line segment for voxels which are hit.
      *
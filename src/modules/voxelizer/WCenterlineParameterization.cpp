@@ -42,6 +42,23 @@ WCenterlineParameterization::WCenterlineParameterization( boost::shared_ptr< WGr
     // initialize members
 }
 
+WCenterlineParameterization::WCenterlineParameterization( boost::shared_ptr< WGridRegular3D > grid, boost::shared_ptr< WFiber > centerline,
+                                                          bool tiled ):
+    WRasterParameterization( grid ),
+    m_paramValues( tiled ? 0 : grid->size(), 0.0 ),
+    m_paramFinalValues( tiled ? 0 : grid->size(), 0.0 ),
+    m_paramSetValues( tiled ? 0 : grid->size(), false ),
+    m_centerline( centerline ),
+    m_currentStartParameter( 0.0 ),
+    m_currentEndParameter( 0.0 )
+{
+    if( tiled )
+    {
+        WorkerValue empty = { 0.0, -1.0, 1.0 }; // NOLINT
+        m_workerValues.reset( new WRasterTiles< WorkerValue >( grid->getNbCoordsX(), grid->getNbCoordsY(), grid->getNbCoordsZ(), empty ) );
+    }
+}
+
 WCenterlineParameterization::~WCenterlineParameterization()
 {
     // cleanup
@@ -132,6 +149,23 @@ void WCenterlineParameterization::parameterizeVoxel( const WVector3i& voxel, siz
     // now update the neighbourhood
     for( unsigned int i = 0; i < 27; ++i )
     {
+        if( m_workerValues )
+        {
+            WorkerValue& workerValue = ( *m_workerValues )[ n.indices[i] ];
+            if( workerValue.m_first >= 0.0 )
+            {
+                workerValue.m_value = 0.5 * ( workerValue.m_value + m_currentStartParameter );
+                workerValue.m_weight *= 0.5;
+            }
+            else
+            {
+                workerValue.m_value = m_currentStartParameter;
+                workerValue.m_first = m_currentStartParameter;
+                workerValue.m_weight = 0.5;
+            }
+            continue;
+        }
+
         if( m_paramSetValues[ n.indices[i] ] )
         {
             m_paramValues[ n.indices[i] ] = 0.5 * ( m_paramValues[ n.indices[i] ] + m_currentStartParameter );
@@ -221,3 +255,71 @@ void WCenterlineParameterization::finished()
     }
 }
 
+
+boost::shared_ptr< WRasterParameterization > WCenterlineParameterization::createWorker() const
+{
+    return boost::shared_ptr< WRasterParameterization >( new WCenterlineParameterization( m_grid, m_centerline, true ) );
+}
+
+namespace wcp
+{
+    /**
+     * Continues the running averages with the parameters of a worker.
+     */
+    class MergeParameters
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * \param values the running averages
+         * \param setValues whether a voxel has been set
+         */
+        MergeParameters( std::vector< double >* values, std::vector< bool >* setValues ):
+            m_values( values ),
+            m_setValues( setValues )
+        {
+        }
+
+        /**
+         * Merges the parameter of a voxel if the worker set it.
+         *
+         * \param voxelIdx the voxel index
+         * \param workerValue the parameter of the worker
+         */
+        template< typename WorkerValue >
+        void operator()( size_t voxelIdx, WorkerValue const& workerValue )
+        {
+            if( workerValue.m_first < 0.0 )
+            {
+                return;
+            }
+            if( ( *m_setValues )[ voxelIdx ] )
+            {
+                ( *m_values )[ voxelIdx ] = workerValue.m_value + ( ( *m_values )[ voxelIdx ] - workerValue.m_first ) * workerValue.m_weight;
+            }
+            else
+            {
+                ( *m_values )[ voxelIdx ] = workerValue.m_value;
+                ( *m_setValues )[ voxelIdx ] = true;
+            }
+        }
+
+    private:
+        /**
+         * The running averages.
+         */
+        std::vector< double >* m_values;
+
+        /**
+         * Whether a voxel has been set.
+         */
+        std::vector< bool >* m_setValues;
+    };
+}
+
+void WCenterlineParameterization::merge( const WRasterParameterization& worker )
+{
+    wcp::MergeParameters mergeParameters( &m_paramValues, &m_paramSetValues );
+    dynamic_cast< const WCenterlineParameterization& >( worker ).m_workerValues->visit( &mergeParameters );
+}
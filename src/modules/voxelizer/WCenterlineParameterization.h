@@ -30,6 +30,7 @@
 #include "core/common/datastructures/WFiber.h"
 
 #include "WRasterParameterization.h"
+#include "WRasterTiles.h"
 
 /**
  * Stores the direction if a line in a separate dataset for each voxel.
@@ -91,7 +92,42 @@ public:
      */
     virtual void finished();
 
+    /**
+     * Creates a parameterization storing its parameters in tiles, for a single thread of WRasterAlgorithm::rasterLines().
+     *
+     * \return the worker
+     */
+    virtual boost::shared_ptr< WRasterParameterization > createWorker() const;
+
+    /**
+     * Continues the running average of every voxel set by the worker with the parameters of the worker.
+     *
+     * \param worker a worker created by createWorker()
+     */
+    virtual void merge( const WRasterParameterization& worker );
+
 protected:
+    /**
+     * The parameter of a voxel set by a worker. The running average of the worker starts with its first parameter,
+     * whereas in serial rasterization it continues the average of the previous lines. Both differ by the difference of
+     * the previous average and the first parameter, halved once per parameter of the worker.
+     */
+    struct WorkerValue
+    {
+        double m_value; //!< The running average of the parameters of the worker.
+        double m_first; //!< The first parameter of the worker, negative if the voxel was not set.
+        double m_weight; //!< 0.5 to the power of the number of parameters of the worker.
+    };
+
+    /**
+     * Constructor of the workers.
+     *
+     * \param grid the grid used for the new dataset.
+     * \param centerline the centerline of the cluster
+     * \param tiled if true, the parameters are stored in m_workerValues instead of the dense arrays.
+     */
+    WCenterlineParameterization( boost::shared_ptr< WGridRegular3D > grid, boost::shared_ptr< WFiber > centerline, bool tiled );
+
     /**
      * Stores the current length of the centerline fiber at each voxel.
      */
@@ -107,6 +143,11 @@ protected:
      */
     std::vector< bool > m_paramSetValues;
 
+    /**
+     * Stores the parameters of the voxels set by a worker. NULL if not a worker.
+     */
+    boost::shared_ptr< WRasterTiles< WorkerValue > > m_workerValues;
+
     /**
      * The centerline of the cluster
      */
@@ -36,6 +36,17 @@ WIntegrationParameterization::WIntegrationParameterization( boost::shared_ptr< W
     // initialize members
 }
 
+WIntegrationParameterization::WIntegrationParameterization( boost::shared_ptr< WGridRegular3D > grid, bool tiled ):
+    WRasterParameterization( grid ),
+    m_lengthValues( tiled ? 0 : grid->size(), 0.0 ),
+    m_curLength( 0.0 )
+{
+    if( tiled )
+    {
+        m_lengthTiles.reset( new WRasterTiles< double >( grid->getNbCoordsX(), grid->getNbCoordsY(), grid->getNbCoordsZ(), -1.0 ) );
+    }
+}
+
 WIntegrationParameterization::~WIntegrationParameterization()
 {
     // cleanup
@@ -68,6 +79,43 @@ namespace wip //WIntegrationParameterization
         size_t nbXY = grid->getNbCoordsX() * grid->getNbCoordsY();
         return x + y * nbX + z * nbXY;
     }
+
+    /**
+     * Copies the lengths set by a worker.
+     */
+    class MergeLengths
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * \param lengths the lengths to overwrite
+         */
+        explicit MergeLengths( std::vector< double >* lengths ):
+            m_lengths( lengths )
+        {
+        }
+
+        /**
+         * Copies the length of a voxel if the worker set it.
+         *
+         * \param voxelIdx the voxel index
+         * \param length the length of the worker, negative if not set
+         */
+        void operator()( size_t voxelIdx, double length )
+        {
+            if( length >= 0.0 )
+            {
+                ( *m_lengths )[ voxelIdx ] = length;
+            }
+        }
+
+    private:
+        /**
+         * The lengths to overwrite.
+         */
+        std::vector< double >* m_lengths;
+    };
 }
 
 void WIntegrationParameterization::parameterizeVoxel( const WVector3i& voxel, size_t /*voxelIdx*/, const int /*axis*/,
@@ -76,35 +124,35 @@ void WIntegrationParameterization::parameterizeVoxel( const WVector3i& voxel, si
                                                       const WPosition& /*end*/ )
 {
     // ok, this looks ugly but setting the whole 27-neighborhood produces better results
-    m_lengthValues[ wip::index( voxel[0],   voxel[1]+1, voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1]+1, voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1]+1, voxel[2],   m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1]-1, voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1]-1, voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1]-1, voxel[2],   m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1],   voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1],   voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0],   voxel[1],   voxel[2],   m_grid ) ] = m_curLength;
-
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1]+1, voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1]+1, voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1]+1, voxel[2],   m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1]-1, voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1]-1, voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1]-1, voxel[2],   m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1],   voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1],   voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]+1, voxel[1],   voxel[2],   m_grid ) ] = m_curLength;
-
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1]+1, voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1]+1, voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1]+1, voxel[2],   m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1]-1, voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1]-1, voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1]-1, voxel[2],   m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1],   voxel[2]+1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1],   voxel[2]-1, m_grid ) ] = m_curLength;
-    m_lengthValues[ wip::index( voxel[0]-1, voxel[1],   voxel[2],   m_grid ) ] = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1]+1, voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1]+1, voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1]+1, voxel[2],   m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1]-1, voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1]-1, voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1]-1, voxel[2],   m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1],   voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1],   voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0],   voxel[1],   voxel[2],   m_grid ) ) = m_curLength;
+
+    lengthValue( wip::index( voxel[0]+1, voxel[1]+1, voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1]+1, voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1]+1, voxel[2],   m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1]-1, voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1]-1, voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1]-1, voxel[2],   m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1],   voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1],   voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]+1, voxel[1],   voxel[2],   m_grid ) ) = m_curLength;
+
+    lengthValue( wip::index( voxel[0]-1, voxel[1]+1, voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1]+1, voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1]+1, voxel[2],   m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1]-1, voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1]-1, voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1]-1, voxel[2],   m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1],   voxel[2]+1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1],   voxel[2]-1, m_grid ) ) = m_curLength;
+    lengthValue( wip::index( voxel[0]-1, voxel[1],   voxel[2],   m_grid ) ) = m_curLength;
 }
 
 void WIntegrationParameterization::newLine( const WLine& /*line*/ )
@@ -119,3 +167,14 @@ void WIntegrationParameterization::newSegment( const WPosition& start, const WPo
     m_curLength += length2( start - end );
 }
 
+
+boost::shared_ptr< WRasterParameterization > WIntegrationParameterization::createWorker() const
+{
+    return boost::shared_ptr< WRasterParameterization >( new WIntegrationParameterization( m_grid, true ) );
+}
+
+void WIntegrationParameterization::merge( const WRasterParameterization& worker )
+{
+    wip::MergeLengths mergeLengths( &m_lengthValues );
+    dynamic_cast< const WIntegrationParameterization& >( worker ).m_lengthTiles->visit( &mergeLengths );
+}
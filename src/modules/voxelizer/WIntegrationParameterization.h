@@ -30,6 +30,7 @@
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
 
 #include "WRasterParameterization.h"
+#include "WRasterTiles.h"
 
 /**
  * Stores the direction if a line in a separate dataset for each voxel.
@@ -85,12 +86,51 @@ public:
      */
     virtual void newSegment( const WPosition& start, const WPosition& end );
 
+    /**
+     * Creates a parameterization storing its lengths in tiles, for a single thread of WRasterAlgorithm::rasterLines().
+     *
+     * \return the worker
+     */
+    virtual boost::shared_ptr< WRasterParameterization > createWorker() const;
+
+    /**
+     * Overwrites the lengths of all voxels set by the worker, like the later lines do in serial rasterization.
+     *
+     * \param worker a worker created by createWorker()
+     */
+    virtual void merge( const WRasterParameterization& worker );
+
 protected:
+    /**
+     * Constructor of the workers.
+     *
+     * \param grid the grid used for the new dataset.
+     * \param tiled if true, the lengths are stored in m_lengthTiles instead of m_lengthValues.
+     */
+    WIntegrationParameterization( boost::shared_ptr< WGridRegular3D > grid, bool tiled );
+
+    /**
+     * Access the length of a voxel, in m_lengthValues or, for workers, in m_lengthTiles.
+     *
+     * \param voxelIdx the voxel index in the grid
+     *
+     * \return the length
+     */
+    double& lengthValue( size_t voxelIdx )
+    {
+        return m_lengthTiles ? ( *m_lengthTiles )[ voxelIdx ] : m_lengthValues[ voxelIdx ];
+    }
+
     /**
      * Stores the current length of the fiber at each voxel.
      */
     std::vector< double > m_lengthValues;
 
+    /**
+     * Stores the lengths of the voxels set by a worker, negative for voxels not set. NULL if not a worker.
+     */
+    boost::shared_ptr< WRasterTiles< double > > m_lengthTiles;
+
     /**
      * The current length of a line.
      */
@@ -323,27 +323,32 @@ boost::shared_ptr< WFiber > WMVoxelizer::centerLine( boost::shared_ptr< const WD
 void WMVoxelizer::raster( boost::shared_ptr< WRasterAlgorithm > algo, boost::shared_ptr< const WDataSetFibers > tracts,
         boost::shared_ptr< const WFiberCluster > cluster ) const
 {
-    // for each tract apply a call to algo->raster( tract );
-
+    // raster the tracts in parallel, each thread rasterizes a range of them into its own sparse buffers
+    std::vector< const WLine* > lines;
+    boost::shared_ptr< const WDataSetFiberVector > clusterTracts;
+    boost::shared_ptr< WDataSetFiberVector > allTracts;
     if( cluster )
     {
-        boost::shared_ptr< const WDataSetFiberVector > clusterTracts = cluster->getDataSetReference();
+        clusterTracts = cluster->getDataSetReference();
         const std::list< size_t >& tractIDs = cluster->getIndices();
-        std::list< size_t >::const_iterator cit = tractIDs.begin();
-        for( cit = tractIDs.begin(); cit != tractIDs.end(); ++cit )
+        lines.reserve( tractIDs.size() );
+        for( std::list< size_t >::const_iterator cit = tractIDs.begin(); cit != tractIDs.end(); ++cit )
         {
-            algo->raster( clusterTracts->at( *cit ) );
+            lines.push_back( &clusterTracts->at( *cit ) );
         }
     }
     else
     {
-        boost::shared_ptr< WDataSetFiberVector > allTracts( new WDataSetFiberVector( tracts ) );
+        allTracts.reset( new WDataSetFiberVector( tracts ) );
+        lines.reserve( allTracts->size() );
         for( WDataSetFiberVector::const_iterator cit = allTracts->begin(); cit != allTracts->end(); ++cit )
         {
-            algo->raster( *cit );
+            lines.push_back( &*cit );
         }
     }
 
+    algo->rasterLines( lines );
+
     algo->finished();
 }
 
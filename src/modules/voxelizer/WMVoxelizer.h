@@ -138,7 +138,8 @@ protected:
     osg::ref_ptr< osg::Node > genDataSetGeode( boost::shared_ptr< WDataSetScalar > dataset ) const;
 
     /**
-     * Performs rasterization with the given algorithm on either all tracts or only a subset if given.
+     * Performs rasterization with the given algorithm on either all tracts or only a subset if given. The tracts are
+     * rasterized in parallel if the algorithm supports it.
      *
      * \param algo The algorithm which actually rasters every fiber.
      * \param tracts Dataset of tracts.
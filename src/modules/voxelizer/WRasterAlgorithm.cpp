@@ -22,11 +22,14 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
 
 #include "core/common/WLogger.h"
+#include "core/common/WThreadedFunction.h"
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
 #include "core/dataHandler/WDataSetScalar.h"
 #include "core/dataHandler/WGridRegular3D.h"
@@ -41,10 +44,192 @@ WRasterAlgorithm::WRasterAlgorithm( boost::shared_ptr< WGridRegular3D > grid )
     wlog::debug( "Voxelizer" ) << "WRasterAlogrithm created " << m_values.size() << " values.";
 }
 
+WRasterAlgorithm::WRasterAlgorithm( boost::shared_ptr< WGridRegular3D > grid, bool tiled )
+    : m_grid( grid ),
+      m_values( tiled ? 0 : grid->size(), 0.0 )
+{
+    if( tiled )
+    {
+        m_tiles.reset( new WRasterTiles< double >( grid->getNbCoordsX(), grid->getNbCoordsY(), grid->getNbCoordsZ() ) );
+    }
+}
+
 WRasterAlgorithm::~WRasterAlgorithm()
 {
 }
 
+class WRasterAlgorithm::RasterThread // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param algorithm the algorithm rasterizing the first range, its workers raster the other ranges
+     * \param lines the lines to raster
+     */
+    RasterThread( WRasterAlgorithm* algorithm, std::vector< const WLine* > const& lines )
+        : m_algorithm( algorithm ),
+          m_lines( lines )
+    {
+    }
+
+    /**
+     * Rasterizes the range of lines of a thread. The first thread uses the algorithm itself, all others a new worker.
+     *
+     * \param id the id of the thread
+     * \param numThreads the number of threads
+     */
+    void operator()( std::size_t id, std::size_t numThreads, WBoolFlag const& /* shutdown */ )
+    {
+        WRasterAlgorithm* target = m_algorithm;
+        boost::shared_ptr< WRasterAlgorithm > worker;
+        if( id > 0 )
+        {
+            worker = m_algorithm->createWorker();
+            boost::shared_lock< boost::shared_mutex > lock( m_algorithm->m_parameterizationsLock );
+            for( size_t i = 0; i < m_algorithm->m_parameterizations.size(); ++i )
+            {
+                worker->m_parameterizations.push_back( m_algorithm->m_parameterizations[ i ]->createWorker() );
+            }
+            lock.unlock();
+            target = worker.get();
+        }
+
+        std::pair< std::size_t, std::size_t > const range = getThreadRange( m_lines.size(), id, numThreads );
+        for( std::size_t i = range.first; i < range.second; ++i )
+        {
+            target->raster( *m_lines[ i ] );
+        }
+
+        if( worker )
+        {
+            boost::lock_guard< boost::mutex > lock( m_workersMutex );
+            m_workers.resize( std::max( m_workers.size(), numThreads ) );
+            m_workers[ id ] = worker;
+        }
+    }
+
+    /**
+     * The workers of the threads, ordered by their ranges. The first one is NULL.
+     *
+     * \return the workers
+     */
+    std::vector< boost::shared_ptr< WRasterAlgorithm > > const& getWorkers() const
+    {
+        return m_workers;
+    }
+
+private:
+    /**
+     * The algorithm.
+     */
+    WRasterAlgorithm* m_algorithm;
+
+    /**
+     * The lines.
+     */
+    std::vector< const WLine* > const& m_lines;
+
+    /**
+     * The workers of the threads.
+     */
+    std::vector< boost::shared_ptr< WRasterAlgorithm > > m_workers;
+
+    /**
+     * Protects m_workers.
+     */
+    boost::mutex m_workersMutex;
+};
+
+class WRasterAlgorithm::MergeValues // NOLINT
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \param algorithm the algorithm receiving the values
+     */
+    explicit MergeValues( WRasterAlgorithm* algorithm )
+        : m_algorithm( algorithm )
+    {
+    }
+
+    /**
+     * Composes the value of a worker into the value of the algorithm.
+     *
+     * \param voxelIdx the voxel index
+     * \param value the value of the worker
+     */
+    void operator()( std::size_t voxelIdx, double value )
+    {
+        m_algorithm->m_values[ voxelIdx ] = m_algorithm->composeValue( value, m_algorithm->m_values[ voxelIdx ] );
+    }
+
+private:
+    /**
+     * The algorithm.
+     */
+    WRasterAlgorithm* m_algorithm;
+};
+
+void WRasterAlgorithm::rasterLines( std::vector< const WLine* > const& lines, std::size_t numThreads )
+{
+    // rasterizing in parallel needs workers of the algorithm and of every parameterization
+    bool parallel = numThreads != 1 && lines.size() > 1 && !m_tiles && createWorker();
+    boost::shared_lock< boost::shared_mutex > lock( m_parameterizationsLock );
+    for( size_t i = 0; parallel && i < m_parameterizations.size(); ++i )
+    {
+        parallel = static_cast< bool >( m_parameterizations[ i ]->createWorker() );
+    }
+    lock.unlock();
+
+    if( !parallel )
+    {
+        for( size_t i = 0; i < lines.size(); ++i )
+        {
+            raster( *lines[ i ] );
+        }
+        return;
+    }
+
+    boost::shared_ptr< RasterThread > rasterThread( new RasterThread( this, lines ) );
+    WThreadedFunction< RasterThread > pool( numThreads, rasterThread );
+    pool.run();
+    pool.wait();
+    if( pool.status() != W_THREADS_FINISHED )
+    {
+        wlog::error( "Voxelizer" ) << "Rasterization aborted, the result is incomplete.";
+    }
+
+    // merge in the order of the ranges, as order dependent parameterizations rely on it
+    std::vector< boost::shared_ptr< WRasterAlgorithm > > const& workers = rasterThread->getWorkers();
+    MergeValues mergeValues( this );
+    lock.lock();
+    for( size_t w = 1; w < workers.size(); ++w )
+    {
+        if( !workers[ w ] )
+        {
+            continue;
+        }
+        workers[ w ]->m_tiles->visit( &mergeValues );
+        for( size_t i = 0; i < m_parameterizations.size(); ++i )
+        {
+            m_parameterizations[ i ]->merge( *workers[ w ]->m_parameterizations[ i ] );
+        }
+    }
+    lock.unlock();
+}
+
+boost::shared_ptr< WRasterAlgorithm > WRasterAlgorithm::createWorker() const
+{
+    return boost::shared_ptr< WRasterAlgorithm >();
+}
+
+double WRasterAlgorithm::composeValue( double newValue, double existingValue ) const
+{
+    return std::max( newValue, existingValue );
+}
+
 boost::shared_ptr< WDataSetScalar > WRasterAlgorithm::generateDataSet() const
 {
     boost::shared_ptr< WValueSet< double > > valueSet( new WValueSet< double >( 0,
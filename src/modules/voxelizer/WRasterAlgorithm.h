@@ -25,6 +25,7 @@
 #ifndef WRASTERALGORITHM_H
 #define WRASTERALGORITHM_H
 
+#include <cstddef>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -36,6 +37,7 @@
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
 
 #include "WRasterParameterization.h"
+#include "WRasterTiles.h"
 
 /**
  * Base class for all rasterization algorithms. The interface will be as
@@ -68,6 +70,17 @@ public:
      */
     virtual void raster( const WLine& line ) = 0;
 
+    /**
+     * Rasterizes several lines, in parallel if this algorithm and all parameterizations provide workers. Each thread
+     * rasterizes a contiguous range of the lines with its own worker, whose values are stored in sparse tiles. The
+     * workers are merged in the order of their ranges afterwards, so the result equals rasterizing the lines one after
+     * another, apart from rounding in order dependent parameterizations.
+     *
+     * \param lines the lines to raster
+     * \param numThreads the number of threads, 0 to choose automatically
+     */
+    void rasterLines( std::vector< const WLine* > const& lines, std::size_t numThreads = 0 );
+
     /**
      * Computes a dataset out of our voxel values and the previously given
      * grid. Note this may take some time.
@@ -91,6 +104,46 @@ public:
     virtual void finished();
 
 protected:
+    /**
+     * Creates a raster algorithm whose values are stored either densely in m_values or sparsely in m_tiles.
+     *
+     * \param grid The grid specifying the voxels.
+     * \param tiled if true, m_values stays empty and the values are stored in m_tiles, as needed by workers.
+     */
+    WRasterAlgorithm( boost::shared_ptr< WGridRegular3D > grid, bool tiled );
+
+    /**
+     * Creates an instance of this algorithm with the same settings for a single thread of rasterLines(). The worker
+     * stores its values in m_tiles and has no parameterizations, rasterLines() adds their workers. The default returns
+     * NULL, so the lines are rasterized serially.
+     *
+     * \return the worker
+     */
+    virtual boost::shared_ptr< WRasterAlgorithm > createWorker() const;
+
+    /**
+     * Compose the new value for a voxel out of a new computed value and the already existing marking. Also used to merge
+     * the values of the workers. The default is the maximum.
+     *
+     * \param newValue Newly computed value
+     * \param existingValue The mark already existing for the voxel
+     *
+     * \return The new mark for that voxel
+     */
+    virtual double composeValue( double newValue, double existingValue ) const;
+
+    /**
+     * Access the value of a voxel, in m_values or, for workers, in m_tiles.
+     *
+     * \param voxelIdx the voxel index in the grid
+     *
+     * \return the value
+     */
+    double& voxelValue( size_t voxelIdx )
+    {
+        return m_tiles ? ( *m_tiles )[ voxelIdx ] : m_values[ voxelIdx ];
+    }
+
     /**
      * All the parameterization algorithms to apply while rasterizing a line.
      */
@@ -116,6 +169,11 @@ protected:
      */
     std::vector< double > m_values;
 
+    /**
+     * Stores the values of the voxels hit by the lines of a worker, NULL for the dense instances.
+     */
+    boost::shared_ptr< WRasterTiles< double > > m_tiles;
+
     /**
      * This method allows all registered parameterization algorithms to update. This basically simply calls all parameterizeVoxel methods in
      * m_parameterizations vector.
@@ -148,5 +206,14 @@ protected:
     virtual void newSegment( const WPosition& start, const WPosition& end );
 
 private:
+    /**
+     * Rasterizes a range of the lines with a worker, to be run by a WThreadedFunction.
+     */
+    class RasterThread;
+
+    /**
+     * Composes the values of a worker into m_values.
+     */
+    class MergeValues;
 };
 #endif  // WRASTERALGORITHM_H
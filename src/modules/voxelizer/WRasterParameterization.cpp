@@ -53,3 +53,15 @@ void WRasterParameterization::finished()
     // Overwrite in your class if you need to handle this.
 }
 
+
+boost::shared_ptr< WRasterParameterization > WRasterParameterization::createWorker() const
+{
+    // not supported by default
+    return boost::shared_ptr< WRasterParameterization >();
+}
+
+void WRasterParameterization::merge( const WRasterParameterization& /*worker*/ )
+{
+    // do nothing here
+    // Overwrite in your class if you need to handle this.
+}
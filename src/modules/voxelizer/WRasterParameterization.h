@@ -92,6 +92,23 @@ public:
      */
     virtual void finished();
 
+    /**
+     * Creates an instance of this parameterization with the same settings for a single thread of
+     * WRasterAlgorithm::rasterLines(). Workers should store their values sparsely, e.g. in WRasterTiles. The default
+     * returns NULL, so lines are only rasterized in parallel if all parameterizations provide workers.
+     *
+     * \return the worker
+     */
+    virtual boost::shared_ptr< WRasterParameterization > createWorker() const;
+
+    /**
+     * Merges the values of a worker into this parameterization, as if the lines of the worker were rasterized by this
+     * parameterization after all lines rasterized so far. Overwrite in your class together with createWorker().
+     *
+     * \param worker a worker created by createWorker() of this parameterization
+     */
+    virtual void merge( const WRasterParameterization& worker );
+
 protected:
     /**
      * The grid, which needs to be used for the created dataset and to which the parameterizeVoxel method is relating to.
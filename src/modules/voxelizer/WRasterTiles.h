@@ -0,0 +1,205 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WRASTERTILES_H
+#define WRASTERTILES_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_array.hpp>
+
+/**
+ * A sparse voxel buffer for rasterizing into a part of a large grid. The grid is divided into cubic tiles that are
+ * allocated on first access, so a buffer only needs memory for the neighborhood of the rasterized lines. Voxels are
+ * addressed by their index in the grid, like in the dense value arrays of the rasterization algorithms.
+ *
+ * \tparam T the voxel type, must be copyable
+ */
+template< typename T >
+class WRasterTiles
+{
+public:
+    /**
+     * The number of voxels along each edge of a tile.
+     */
+    static const std::size_t TileEdge = 8;
+
+    /**
+     * Creates an empty buffer. No memory is allocated for the voxels yet.
+     *
+     * \param nbX the number of voxels in x direction
+     * \param nbY the number of voxels in y direction
+     * \param nbZ the number of voxels in z direction
+     * \param empty the value of all voxels that were never written
+     */
+    WRasterTiles( std::size_t nbX, std::size_t nbY, std::size_t nbZ, T const& empty = T() );
+
+    /**
+     * Access a voxel. Allocates its tile if needed.
+     *
+     * \param voxelIdx the index of the voxel in the grid
+     *
+     * \return the voxel
+     */
+    T& operator[]( std::size_t voxelIdx );
+
+    /**
+     * Calls the visitor with the voxel index and the value of every voxel of the allocated tiles, including voxels that
+     * were not written but share a tile with written ones. Voxels of different tiles are visited in the order of the tiles.
+     *
+     * \tparam Visitor a function object taking the voxel index and the value
+     * \param visitor the visitor
+     */
+    template< typename Visitor >
+    void visit( Visitor* visitor ) const;
+
+    /**
+     * The number of tiles that have been allocated.
+     *
+     * \return the number of tiles
+     */
+    std::size_t getNumAllocatedTiles() const;
+
+private:
+    /**
+     * The number of voxels of a tile.
+     */
+    static const std::size_t TileSize = TileEdge * TileEdge * TileEdge;
+
+    /**
+     * The number of voxels in x direction.
+     */
+    std::size_t m_nbX;
+
+    /**
+     * The number of voxels in y direction.
+     */
+    std::size_t m_nbY;
+
+    /**
+     * The number of voxels in z direction.
+     */
+    std::size_t m_nbZ;
+
+    /**
+     * The number of tiles in x direction.
+     */
+    std::size_t m_tilesX;
+
+    /**
+     * The number of tiles in y direction.
+     */
+    std::size_t m_tilesY;
+
+    /**
+     * The value of voxels that were never written.
+     */
+    T m_empty;
+
+    /**
+     * The tiles in x, y, z order, NULL where not allocated.
+     */
+    std::vector< boost::shared_array< T > > m_tiles;
+
+    /**
+     * The number of allocated tiles.
+     */
+    std::size_t m_numAllocated;
+};
+
+template< typename T >
+const std::size_t WRasterTiles< T >::TileEdge;
+
+template< typename T >
+const std::size_t WRasterTiles< T >::TileSize;
+
+template< typename T >
+WRasterTiles< T >::WRasterTiles( std::size_t nbX, std::size_t nbY, std::size_t nbZ, T const& empty ):
+    m_nbX( nbX ),
+    m_nbY( nbY ),
+    m_nbZ( nbZ ),
+    m_tilesX( ( nbX + TileEdge - 1 ) / TileEdge ),
+    m_tilesY( ( nbY + TileEdge - 1 ) / TileEdge ),
+    m_empty( empty ),
+    m_tiles( m_tilesX * m_tilesY * ( ( nbZ + TileEdge - 1 ) / TileEdge ) ),
+    m_numAllocated( 0 )
+{
+}
+
+template< typename T >
+T& WRasterTiles< T >::operator[]( std::size_t voxelIdx )
+{
+    std::size_t const x = voxelIdx % m_nbX;
+    std::size_t const y = ( voxelIdx / m_nbX ) % m_nbY;
+    std::size_t const z = voxelIdx / ( m_nbX * m_nbY );
+
+    boost::shared_array< T >& tile = m_tiles[ x / TileEdge + m_tilesX * ( y / TileEdge + m_tilesY * ( z / TileEdge ) ) ];
+    if( !tile )
+    {
+        tile.reset( new T[ TileSize ] );
+        std::fill( tile.get(), tile.get() + TileSize, m_empty );
+        ++m_numAllocated;
+    }
+    return tile[ x % TileEdge + TileEdge * ( y % TileEdge + TileEdge * ( z % TileEdge ) ) ];
+}
+
+template< typename T >
+template< typename Visitor >
+void WRasterTiles< T >::visit( Visitor* visitor ) const
+{
+    for( std::size_t t = 0; t < m_tiles.size(); ++t )
+    {
+        if( !m_tiles[ t ] )
+        {
+            continue;
+        }
+        std::size_t const x0 = ( t % m_tilesX ) * TileEdge;
+        std::size_t const y0 = ( ( t / m_tilesX ) % m_tilesY ) * TileEdge;
+        std::size_t const z0 = ( t / ( m_tilesX * m_tilesY ) ) * TileEdge;
+
+        // tiles at the upper borders may reach beyond the grid
+        for( std::size_t z = z0; z < z0 + TileEdge && z < m_nbZ; ++z )
+        {
+            for( std::size_t y = y0; y < y0 + TileEdge && y < m_nbY; ++y )
+            {
+                for( std::size_t x = x0; x < x0 + TileEdge && x < m_nbX; ++x )
+                {
+                    ( *visitor )( x + m_nbX * ( y + m_nbY * z ),
+                             m_tiles[ t ][ ( x - x0 ) + TileEdge * ( ( y - y0 ) + TileEdge * ( z - z0 ) ) ] );
+                }
+            }
+        }
+    }
+}
+
+template< typename T >
+std::size_t WRasterTiles< T >::getNumAllocatedTiles() const
+{
+    return m_numAllocated;
+}
+
+#endif  // WRASTERTILES_H
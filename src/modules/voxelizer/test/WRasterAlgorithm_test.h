@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WRASTERALGORITHM_TEST_H
+#define WRASTERALGORITHM_TEST_H
+
+#include <cmath>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "core/common/WLogger.h"
+#include "core/common/datastructures/WFiber.h"
+#include "../WBresenham.h"
+#include "../WBresenhamDBL.h"
+#include "../WCenterlineParameterization.h"
+#include "../WIntegrationParameterization.h"
+
+/**
+ * Tests parallel rasterization of several lines.
+ */
+class WRasterAlgorithmTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Creates the grid and some crossing lines in it.
+     */
+    void setUp( void )
+    {
+        WLogger::startup();
+
+        m_grid.reset( new WGridRegular3D( 24, 20, 16 ) );
+        m_lines.clear();
+        for( size_t i = 0; i < 60; ++i )
+        {
+            WLine line;
+            for( size_t k = 0; k < 8; ++k )
+            {
+                double t = 0.7 * i + 0.4 * k;
+                line.push_back( WPosition( 1.5 + 10.0 * ( 1.0 + std::sin( 1.3 * t ) ),
+                                           1.5 + 8.0 * ( 1.0 + std::cos( 0.9 * t + i ) ),
+                                           1.5 + 6.0 * ( 1.0 + std::sin( 0.5 * t + 2.0 * i ) ) ) );
+            }
+            m_lines.push_back( line );
+        }
+    }
+
+    /**
+     * Clean up after each test
+     */
+    void tearDown( void )
+    {
+        m_lines.clear();
+        m_grid.reset();
+    }
+
+    /**
+     * Rasterizing with several threads gives the same antialiased values as rasterizing line by line.
+     */
+    void testParallelValuesEqualSerialValues( void )
+    {
+        WBresenham serial( m_grid, true );
+        WBresenham parallel( m_grid, true );
+        rasterBoth( &serial, &parallel, 4 );
+        assertEqual( serial.generateDataSet(), parallel.generateDataSet(), 0.0 );
+    }
+
+    /**
+     * The modified Bresenham algorithm without antialiasing works in parallel, too. One thread per line is fine.
+     */
+    void testParallelBresenhamDBL( void )
+    {
+        WBresenhamDBL serial( m_grid, false );
+        WBresenhamDBL parallel( m_grid, false );
+        rasterBoth( &serial, &parallel, m_lines.size() );
+        assertEqual( serial.generateDataSet(), parallel.generateDataSet(), 0.0 );
+    }
+
+    /**
+     * The lengths of the integration parameterization are overwritten in the order of the lines, like in serial
+     * rasterization.
+     */
+    void testParallelIntegrationParameterization( void )
+    {
+        boost::shared_ptr< WIntegrationParameterization > serialParam( new WIntegrationParameterization( m_grid ) );
+        boost::shared_ptr< WIntegrationParameterization > parallelParam( new WIntegrationParameterization( m_grid ) );
+        WBresenham serial( m_grid, true );
+        WBresenham parallel( m_grid, true );
+        serial.addParameterizationAlgorithm( serialParam );
+        parallel.addParameterizationAlgorithm( parallelParam );
+        rasterBoth( &serial, &parallel, 3 );
+        assertEqual( serialParam->getDataSet(), parallelParam->getDataSet(), 0.0 );
+    }
+
+    /**
+     * The running averages of the centerline parameterization continue across the ranges of the threads.
+     */
+    void testParallelCenterlineParameterization( void )
+    {
+        boost::shared_ptr< WFiber > centerline( new WFiber( std::vector< WPosition >( m_lines[ 0 ].begin(), m_lines[ 0 ].end() ) ) );
+        boost::shared_ptr< WCenterlineParameterization > serialParam( new WCenterlineParameterization( m_grid, centerline ) );
+        boost::shared_ptr< WCenterlineParameterization > parallelParam( new WCenterlineParameterization( m_grid, centerline ) );
+        WBresenham serial( m_grid, true );
+        WBresenham parallel( m_grid, true );
+        serial.addParameterizationAlgorithm( serialParam );
+        parallel.addParameterizationAlgorithm( parallelParam );
+        rasterBoth( &serial, &parallel, 5 );
+        assertEqual( serialParam->getDataSet(), parallelParam->getDataSet(), 1e-9 );
+    }
+
+private:
+    /**
+     * Rasterizes the lines one by one with the first algorithm and in parallel with the second one.
+     *
+     * \param serial the algorithm for serial rasterization
+     * \param parallel the algorithm for parallel rasterization
+     * \param numThreads the number of threads
+     */
+    void rasterBoth( WRasterAlgorithm* serial, WRasterAlgorithm* parallel, size_t numThreads )
+    {
+        std::vector< const WLine* > lines;
+        for( size_t i = 0; i < m_lines.size(); ++i )
+        {
+            serial->raster( m_lines[ i ] );
+            lines.push_back( &m_lines[ i ] );
+        }
+        serial->finished();
+        parallel->rasterLines( lines, numThreads );
+        parallel->finished();
+    }
+
+    /**
+     * Compares the values of two datasets.
+     *
+     * \param expected the expected values
+     * \param actual the actual values
+     * \param delta the allowed difference
+     */
+    void assertEqual( boost::shared_ptr< WDataSetScalar > expected, boost::shared_ptr< WDataSetScalar > actual, double delta )
+    {
+        size_t numSet = 0;
+        TS_ASSERT_EQUALS( expected->getValueSet()->size(), actual->getValueSet()->size() );
+        for( size_t i = 0; i < expected->getValueSet()->size(); ++i )
+        {
+            TS_ASSERT_DELTA( expected->getValueSet()->getScalarDouble( i ), actual->getValueSet()->getScalarDouble( i ), delta );
+            numSet += expected->getValueSet()->getScalarDouble( i ) != 0.0;
+        }
+        // make sure the lines hit a good part of the grid
+        TS_ASSERT_LESS_THAN( 500, numSet );
+    }
+
+    /**
+     * The grid to raster into.
+     */
+    boost::shared_ptr< WGridRegular3D > m_grid;
+
+    /**
+     * The lines to raster.
+     */
+    std::vector< WLine > m_lines;
+};
+
+#endif  // WRASTERALGORITHM_TEST_H
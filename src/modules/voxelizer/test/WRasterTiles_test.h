@@ -0,0 +1,113 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV@Uni-Leipzig and CNCF@MPI-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+
+#ifndef WRASTERTILES_TEST_H
+#define WRASTERTILES_TEST_H
+
+#include <cxxtest/TestSuite.h>
+
+#include "../WRasterTiles.h"
+
+/**
+ * Unit tests the sparse voxel buffer.
+ */
+class WRasterTilesTest : public CxxTest::TestSuite
+{
+public:
+    /**
+     * Tiles are only allocated for written voxels, unwritten voxels of a tile have the empty value.
+     */
+    void testTilesAreAllocatedOnAccess( void )
+    {
+        WRasterTiles< double > tiles( 20, 10, 9, -1.0 );
+        TS_ASSERT_EQUALS( tiles.getNumAllocatedTiles(), 0 );
+
+        tiles[ 0 ] = 2.0;
+        tiles[ 7 + 20 * 7 ] = 3.0;
+        TS_ASSERT_EQUALS( tiles.getNumAllocatedTiles(), 1 );
+        TS_ASSERT_EQUALS( tiles[ 0 ], 2.0 );
+        TS_ASSERT_EQUALS( tiles[ 1 ], -1.0 );
+        TS_ASSERT_EQUALS( tiles[ 7 + 20 * 7 ], 3.0 );
+
+        // the last voxel is in the last, partial tile
+        tiles[ 20 * 10 * 9 - 1 ] = 4.0;
+        TS_ASSERT_EQUALS( tiles.getNumAllocatedTiles(), 2 );
+        TS_ASSERT_EQUALS( tiles[ 20 * 10 * 9 - 1 ], 4.0 );
+    }
+
+    /**
+     * Every voxel of the allocated tiles inside the grid is visited exactly once.
+     */
+    void testVisitPartialTiles( void )
+    {
+        WRasterTiles< double > tiles( 20, 10, 9 );
+        tiles[ 20 * 10 * 9 - 1 ] = 4.0;
+        tiles[ 5 ] = 1.0;
+
+        Visitor visitor;
+        tiles.visit( &visitor );
+
+        // a full tile and the partial tile with x in [16,20), y in [8,10) and z == 8
+        TS_ASSERT_EQUALS( visitor.m_count, 8 * 8 * 8 + 4 * 2 * 1 );
+        TS_ASSERT_EQUALS( visitor.m_sum, 5.0 );
+        TS_ASSERT_EQUALS( visitor.m_indexSum, 8 * 8 * 8 * ( 3.5 + 20 * 3.5 + 200 * 3.5 ) + 8 * ( 17.5 + 20 * 8.5 + 200 * 8 ) );
+    }
+
+private:
+    /**
+     * Counts the visited voxels.
+     */
+    struct Visitor
+    {
+        /**
+         * Constructor.
+         */
+        Visitor():
+            m_count( 0 ),
+            m_sum( 0.0 ),
+            m_indexSum( 0.0 )
+        {
+        }
+
+        /**
+         * Counts a voxel.
+         *
+         * \param voxelIdx the voxel index
+         * \param value the value
+         */
+        void operator()( size_t voxelIdx, double value )
+        {
+            ++m_count;
+            m_sum += value;
+            m_indexSum += voxelIdx;
+        }
+
+        size_t m_count; //!< The number of visited voxels.
+        double m_sum; //!< The sum of their values.
+        double m_indexSum; //!< The sum of their indices.
+    };
+};
+
+#endif  // WRASTERTILES_TEST_H
@@ -58,6 +58,7 @@
 #include "core/common/WIOTools.h"
 #include "core/common/WPathHelper.h"
 #include "core/common/WProjectFileIO.h"
+#include "core/common/WTrace.h"
 #include "core/dataHandler/WDataHandler.h"
 #include "core/dataHandler/WDataSetFibers.h"
 #include "core/dataHandler/WDataSetSingle.h"
@@ -333,6 +334,11 @@ void WMainWindow::setupGUI()
     // saveMenu->addAction( "Save ROIs Only", this, SLOT( projectSaveROIOnly() ) );
     m_saveAction->setMenu( m_saveMenu );
 
+    fileMenu->addSeparator();
+    QAction* exportTraceAction = fileMenu->addAction( "Export Trace", this, SLOT( exportTrace() ) );
+    exportTraceAction->setEnabled( WTrace::isEnabled() );
+    exportTraceAction->setToolTip( "Export the recorded module, job, wait and lock spans as Chrome trace. Needs a build with OW_TRACING." );
+
     fileMenu->addSeparator();
     m_quitAction = fileMenu->addAction( m_iconManager.getIcon( "quit" ), "Quit", this, SLOT( close() ), QKeySequence( QKeySequence::Quit ) );
 
@@ -656,6 +662,32 @@ bool WMainWindow::projectSaveModuleOnly()
     return projectSave( w );
 }
 
+void WMainWindow::exportTrace()
+{
+    QString lastPath = WQtGui::getSettings().value( "LastTraceExportPath", "" ).toString();
+    QString selected = QFileDialog::getSaveFileName( this, "Export Trace as", lastPath, "Chrome Trace (*.json)" );
+    if( selected == "" )
+    {
+        return;
+    }
+
+    // extract path and save to settings
+    boost::filesystem::path p( selected.toStdString() );
+    WQtGui::getSettings().setValue( "LastTraceExportPath", QString::fromStdString( p.parent_path().string() ) );
+
+    try
+    {
+        WTrace::write( selected.toStdString() );
+    }
+    catch( const std::exception& e )
+    {
+        QString title = "Problem while exporting trace.";
+        QString message = "<b>Problem while exporting trace.</b><br/><br/><b>File:  </b>" + selected +
+                          "<br/><b>Message:  </b>" + QString::fromStdString( e.what() );
+        QMessageBox::critical( this, title, message );
+    }
+}
+
 void WMainWindow::newProject()
 {
     WKernel::getRunningKernel()->getRootContainer()->removeAll();
@@ -385,6 +385,11 @@ public slots:
      */
     bool projectSaveModuleOnly();
 
+    /**
+     * Asks for a file and exports the spans recorded by \ref WTrace as Chrome trace.
+     */
+    void exportTrace();
+
     /**
      * Is able to handle updates in the log-level setting.
      *
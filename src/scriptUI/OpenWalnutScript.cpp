@@ -106,7 +106,15 @@ int main( int argc, char** argv )
         ( "log,l", po::value< std::string >(), ( std::string( "The log-file to use. If not specified, \"" ) + logFile +
                                                  std::string( "\" is used in the current directory." ) ).c_str() )
         ( "interp,i", po::value< std::string >(), "The interpreter to use." )
-        ( "file,f", po::value< std::vector< std::string > >()->multitoken(), "The script file to load and its parameters." );
+        ( "file,f", po::value< std::vector< std::string > >()->multitoken(), "The script file to load and its parameters." )
+        ( "batch,b", po::value< std::vector< std::string > >()->multitoken(), "Execute the script file once for each of the given subjects. "
+                                                                               "The subject is passed as first script parameter." )
+        ( "profile,p", po::value< std::string >(), "Write a JSON report with wall time, CPU time and peak memory per module and per connector "
+                                                    "update to the given file." )
+        ( "trace,t", po::value< std::string >(), "Write the recorded module, job, wait and lock spans as Chrome trace-event JSON to the given "
+                                                  "file. Needs a build with OW_TRACING enabled." )
+        ( "memory-budget,m", po::value< size_t >(), "Limit the memory of datasets to the given number of MB. Modules creating data exceeding "
+                                                    "the budget fail." );
 
     boost::program_options::variables_map optionsMap;
     try
@@ -135,6 +143,8 @@ int main( int argc, char** argv )
                   << "Examples:" << std::endl
                   << "  openwalnut-script -i lua \t\tStartup OpenWalnut in lua interpreter mode." << std::endl
                   << "  openwalnut-script -f doSth.py\t\tStart OpenWalnut and execute the doSth.py python script." << std::endl
+                  << "  openwalnut-script -f doSth.py -b s1.nii s2.nii -p report.json" << std::endl
+                  << "  \t\t\t\t\tExecute doSth.py for both subjects and write a timing report." << std::endl
                   << std::endl;
         return 0;
     }
@@ -29,16 +29,25 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/thread.hpp>
 
 #include "core/common/WLogger.h"
 #include "core/common/WIOTools.h"
 #include "core/common/WLogStream.h"
+#include "core/common/WMemoryBudget.h"
 #include "core/common/WThreadedRunner.h"
 #include "core/common/WSegmentationFault.h"
 #include "core/common/WPathHelper.h"
+#include "core/common/WProgressCombiner.h"
+#include "core/common/WRealtimeTimer.h"
+#include "core/common/WResourceUsage.h"
+#include "core/common/WTrace.h"
 
 #include "core/kernel/WKernel.h"
+#include "core/kernel/WModule.h"
+#include "core/kernel/WModuleContainer.h"
 #include "core/kernel/WModuleFactory.h"
+#include "core/kernel/WProfileReport.h"
 
 #include "WScriptUI.h"
 
@@ -83,6 +92,13 @@ int WScriptUI::run()
 
     loadToolboxes( WPathHelper::getHomePath() / "config.script" );
 
+    if( m_programOptions.count( "memory-budget" ) )
+    {
+        size_t budget = m_programOptions[ "memory-budget" ].as< size_t >();
+        WMemoryBudget::getMemoryBudget()->setBudget( budget * 1024 * 1024 );
+        wlog::info( "Walnut" ) << "Memory budget set to " << budget << " MB.";
+    }
+
     //----------------------------
     // startup
     //----------------------------
@@ -146,8 +162,7 @@ int WScriptUI::run()
     // execute
     if( executeScriptFile )
     {
-        // execute provided script file
-        scriptInterpreter->executeFile( m_programOptions[ "file" ].as< std::vector< std::string > >()[ 0 ] );
+        executeBatch( scriptInterpreter );
     }
     else
     {
@@ -186,6 +201,11 @@ int WScriptUI::run()
     // delete interpreter pointer
     scriptInterpreter.reset();
 
+    if( m_programOptions.count( "trace" ) )
+    {
+        writeTrace( m_programOptions[ "trace" ].as< std::string >() );
+    }
+
     // signal everybody to shut down properly.
     WKernel::getRunningKernel()->wait( true );
 
@@ -195,6 +215,121 @@ int WScriptUI::run()
     return 0;
 }
 
+void WScriptUI::executeBatch( boost::shared_ptr< WScriptInterpreter > scriptInterpreter )
+{
+    std::vector< std::string > parameters = m_programOptions[ "file" ].as< std::vector< std::string > >();
+
+    // without batch, the script runs once with its parameters
+    std::vector< std::string > subjects;
+    bool batch = m_programOptions.count( "batch" );
+    if( batch )
+    {
+        subjects = m_programOptions[ "batch" ].as< std::vector< std::string > >();
+    }
+    else
+    {
+        subjects.push_back( parameters[ 0 ] );
+    }
+
+    WProfileReport report;
+    for( std::vector< std::string >::const_iterator subject = subjects.begin(); subject != subjects.end(); ++subject )
+    {
+        // the subject is the first parameter after the script name
+        std::vector< std::string > subjectParameters = parameters;
+        if( batch )
+        {
+            wlog::info( "Walnut" ) << "Processing subject \"" << *subject << "\".";
+            subjectParameters.insert( subjectParameters.begin() + 1, *subject );
+        }
+
+        WRealtimeTimer timer;
+        double cpuStart = getProcessCPUTime();
+
+        scriptInterpreter->setParameters( subjectParameters );
+        scriptInterpreter->executeFile( parameters[ 0 ] );
+
+        // the modules started by the script keep working in their own threads after the script returned
+        double wallTime = 0.0;
+        double cpuEnd = 0.0;
+        waitForModules( timer, &wallTime, &cpuEnd );
+
+        report.addRun( *subject, wallTime, cpuEnd - cpuStart, WKernel::getRunningKernel()->getRootContainer() );
+    }
+
+    if( m_programOptions.count( "profile" ) )
+    {
+        std::string reportFile = m_programOptions[ "profile" ].as< std::string >();
+        std::ofstream out( reportFile.c_str() );
+        if( !out.is_open() )
+        {
+            wlog::error( "Walnut" ) << "Could not write profile report to \"" << reportFile << "\".";
+            return;
+        }
+        report.write( out );
+        wlog::info( "Walnut" ) << "Wrote profile report to \"" << reportFile << "\".";
+    }
+}
+
+void WScriptUI::waitForModules( const WRealtimeTimer& timer, double* wallTime, double* cpuTime ) const
+{
+    // how long the modules need to be idle and how often to check
+    double const settleTime = 0.5;
+    boost::posix_time::milliseconds const interval( 50 );
+
+    bool idle = false;
+    double idleSince = 0.0;
+    while( true )
+    {
+        bool allIdle = true;
+        {
+            WModuleContainer::ModuleSharedContainerType::ReadTicket r = WKernel::getRunningKernel()->getRootContainer()->getModules();
+            for( WModuleContainer::ModuleContainerType::const_iterator iter = r->get().begin(); allIdle && ( iter != r->get().end() ); ++iter )
+            {
+                if( ( *iter )->isRunning().get() &&
+                    ( !( *iter )->isReadyOrCrashed().get() || ( *iter )->getRootProgressCombiner()->isPending() ) )
+                {
+                    allIdle = false;
+                }
+            }
+        }
+
+        if( !allIdle )
+        {
+            idle = false;
+        }
+        else if( !idle )
+        {
+            // the run ends when the modules became idle, not after the settle time
+            idle = true;
+            idleSince = timer.elapsed();
+            *wallTime = idleSince;
+            *cpuTime = getProcessCPUTime();
+        }
+        else if( timer.elapsed() - idleSince >= settleTime )
+        {
+            return;
+        }
+        boost::this_thread::sleep( interval );
+    }
+}
+
+void WScriptUI::writeTrace( const std::string& traceFile ) const
+{
+    if( !WTrace::isEnabled() )
+    {
+        wlog::warn( "Walnut" ) << "Tracing is not compiled in. Enable OW_TRACING to record spans.";
+    }
+
+    std::ofstream out( traceFile.c_str() );
+    if( !out.is_open() )
+    {
+        wlog::error( "Walnut" ) << "Could not write trace to \"" << traceFile << "\".";
+        return;
+    }
+    WTrace::write( out );
+    wlog::info( "Walnut" ) << "Wrote trace to \"" << traceFile << "\".";
+}
+
 void WScriptUI::loadToolboxes( boost::filesystem::path configPath )
 {
     // add additional module paths to the PathHelper, the rest will be done by module loader
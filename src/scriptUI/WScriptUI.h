@@ -29,6 +29,8 @@
 
 #include <boost/program_options.hpp>
 
+#include "core/common/WRealtimeTimer.h"
+#include "core/scripting/WScriptInterpreter.h"
 #include "core/ui/WUI.h"
 
 /**
@@ -81,6 +83,31 @@ protected:
      */
     virtual void loadToolboxes( boost::filesystem::path configPath );
 
+    /**
+     * Executes the script file given on the command line. In batch mode, it is executed once per subject and the subject is passed as first
+     * parameter. If requested, a profile report of all modules gets written afterwards.
+     *
+     * \param scriptInterpreter the interpreter to use
+     */
+    virtual void executeBatch( boost::shared_ptr< WScriptInterpreter > scriptInterpreter );
+
+    /**
+     * Waits until all modules of the root container are idle, i.e. ready, crashed or finished and without pending progress. Modules trigger
+     * each other through their connectors, so they need to stay idle for a short while before this returns.
+     *
+     * \param timer the timer of the current run
+     * \param wallTime the elapsed time of the timer when the modules became idle
+     * \param cpuTime the CPU time of the process when the modules became idle
+     */
+    void waitForModules( const WRealtimeTimer& timer, double* wallTime, double* cpuTime ) const;
+
+    /**
+     * Writes the spans recorded by \ref WTrace as Chrome trace-event JSON.
+     *
+     * \param traceFile the file to write
+     */
+    void writeTrace( const std::string& traceFile ) const;
+
     //! The programm options.
     boost::program_options::variables_map const& m_programOptions;
 };
@@ -487,6 +487,35 @@ IF( CMAKE_HOST_SYSTEM MATCHES "Windows" )
     SETUP_COMMON_DOC( "." "COMMON_DOC_ON_WINDOWS" )
 ENDIF()
 
+# ---------------------------------------------------------------------------------------------------------------------------------------------------
+#
+# Tracing
+#
+#  - Record spans of module main loops, progress stages, threaded jobs and lock/condition waits. See WTrace.
+#
+# ---------------------------------------------------------------------------------------------------------------------------------------------------
+
+OPTION( OW_TRACING "Compile in tracing of threads. The traces can be exported as Chrome trace-event JSON in the GUI and openwalnut-script." OFF )
+IF( OW_TRACING )
+  ADD_DEFINITIONS( -DOW_TRACING )
+ENDIF()
+
+# ---------------------------------------------------------------------------------------------------------------------------------------------------
+#
+# Benchmarks
+#
+#  - Measure the hot paths of the libraries using synthetic data. See SETUP_BENCHMARKS.
+#
+# ---------------------------------------------------------------------------------------------------------------------------------------------------
+
+OPTION( OW_COMPILE_BENCHMARKS "This enables compilation of the benchmarks. Use the \"benchmark\" target to run them." OFF )
+IF( OW_COMPILE_BENCHMARKS )
+  # the benchmark executables add themselves to this target
+  ADD_CUSTOM_TARGET( benchmark
+                     COMMENT "Runs all benchmarks"
+                   )
+ENDIF()
+
 # ---------------------------------------------------------------------------------------------------------------------------------------------------
 #
 # Style
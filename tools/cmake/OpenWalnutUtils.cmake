@@ -68,11 +68,16 @@ FUNCTION( COLLECT_COMPILE_FILES _DirString _CPPFiles _HFiles _TestFiles )
     FOREACH( file ${H_FILES} )
         # the test directories should be excluded from normal compilation completely
         STRING( REGEX MATCH "^.*\\/test\\/.*" IsTest "${file}" )
+        # the benchmarks are compiled into separate executables
+        STRING( REGEX MATCH "^.*\\/benchmark\\/.*" IsBenchmark "${file}" )
         # ext sources should be build seperatly 
         STRING( REGEX MATCH "^.*\\/ext\\/.*" IsExternal "${file}" )
         IF( IsTest )
             LIST( REMOVE_ITEM H_FILES ${file} )
         ENDIF()
+        IF( IsBenchmark )
+            LIST( REMOVE_ITEM H_FILES ${file} )
+        ENDIF()
         IF( IsExternal )
             LIST( REMOVE_ITEM H_FILES ${file} )
         ENDIF()
@@ -80,11 +85,16 @@ FUNCTION( COLLECT_COMPILE_FILES _DirString _CPPFiles _HFiles _TestFiles )
     FOREACH( file ${CPP_FILES} )
         # the test directories should be excluded from normal compilation completely
         STRING( REGEX MATCH "^.*\\/test\\/.*" IsTest "${file}" )
+        # the benchmarks are compiled into separate executables
+        STRING( REGEX MATCH "^.*\\/benchmark\\/.*" IsBenchmark "${file}" )
         # ext sources should be build seperatly 
         STRING( REGEX MATCH "^.*\\/ext\\/.*" IsExternal "${file}" )
         IF( IsTest )
             LIST( REMOVE_ITEM CPP_FILES ${file} )
         ENDIF()
+        IF( IsBenchmark )
+            LIST( REMOVE_ITEM CPP_FILES ${file} )
+        ENDIF()
         IF( IsExternal )
             LIST( REMOVE_ITEM CPP_FILES ${file} )
         ENDIF()
@@ -187,6 +197,51 @@ FUNCTION( SETUP_TESTS _TEST_FILES _TEST_TARGET )
     ENDIF( OW_COMPILE_TESTS )
 ENDFUNCTION( SETUP_TESTS )
 
+# This function sets up the benchmark executable of a target. All *_bench.cpp files in "benchmark" directories below the given directory get
+# compiled into one executable, called benchmark_<target>. The main function is generated. It also adds a target run_benchmark_<target> which
+# writes the JSON results to the build directory and adds itself to the "benchmark" target.
+# _BENCHMARK_DIR the directory to search for benchmarks
+# _BENCHMARK_TARGET for which target are the benchmarks? This is added as link library too.
+# Third, unnamed parameter: additional dependencies as list
+FUNCTION( SETUP_BENCHMARKS _BENCHMARK_DIR _BENCHMARK_TARGET )
+    # Only do something if needed
+    IF( OW_COMPILE_BENCHMARKS )
+        FILE( GLOB_RECURSE BENCHMARK_FILES ${_BENCHMARK_DIR}/*_bench.cpp )
+        FOREACH( file ${BENCHMARK_FILES} )
+            STRING( REGEX MATCH "^.*\\/benchmark\\/.*" IsBenchmark "${file}" )
+            IF( NOT IsBenchmark )
+                LIST( REMOVE_ITEM BENCHMARK_FILES ${file} )
+            ENDIF()
+        ENDFOREACH( file )
+
+        # Abort if no benchmarks are present
+        LIST( LENGTH BENCHMARK_FILES BenchmarkFileListLength )
+        IF( ${BenchmarkFileListLength} STREQUAL "0" )
+            RETURN()
+        ENDIF()
+
+        # the optional parameter is an additional dependencies list
+        SET( _DEPENDENCIES ${ARGV2} )
+
+        SET( BenchmarkName "benchmark_${_BENCHMARK_TARGET}" )
+
+        # generate the main function
+        SET( BenchmarkMain "${CMAKE_CURRENT_BINARY_DIR}/${BenchmarkName}.cc" )
+        FILE( WRITE ${BenchmarkMain} "#include \"core/common/WBenchmarkRunner.h\"\n"
+                                     "int main( int argc, char** argv ) { return WBenchmarkRunner::getBenchmarkRunner()->main( argc, argv ); }\n" )
+
+        ADD_EXECUTABLE( ${BenchmarkName} ${BenchmarkMain} ${BENCHMARK_FILES} )
+        TARGET_LINK_LIBRARIES( ${BenchmarkName} ${_BENCHMARK_TARGET} ${OW_LIB_OPENWALNUT} ${CMAKE_STANDARD_LIBRARIES} ${_DEPENDENCIES} )
+
+        ADD_CUSTOM_TARGET( run_${BenchmarkName}
+                           COMMAND ${BenchmarkName} --output "${CMAKE_BINARY_DIR}/${BenchmarkName}.json"
+                           DEPENDS ${BenchmarkName}
+                           COMMENT "Running benchmarks of ${_BENCHMARK_TARGET}. Results are written to ${CMAKE_BINARY_DIR}/${BenchmarkName}.json"
+        )
+        ADD_DEPENDENCIES( benchmark run_${BenchmarkName} )
+    ENDIF( OW_COMPILE_BENCHMARKS )
+ENDFUNCTION( SETUP_BENCHMARKS )
+
 # This function sets up the build system to ensure that the specified list of shaders is available after build in the target directory. It
 # additionally setups the install targets. Since build and install structure are the same, specify only relative targets here which are used for
 # both.